@@ -143,6 +143,11 @@
 		#define KLAYGE_CXX17_LIBRARY_SIZE_AND_MORE_SUPPORT
 		#define KLAYGE_TS_LIBRARY_FILESYSTEM_SUPPORT
 	#endif
+	#if KLAYGE_COMPILER_VERSION >= 110
+		#if __cplusplus > 201402L
+			#define KLAYGE_CXX17_LIBRARY_CHARCONV_SUPPORT
+		#endif
+	#endif
 	#if KLAYGE_COMPILER_VERSION >= 60
 		#if __cplusplus > 201402L
 			#define KLAYGE_CXX17_CORE_STATIC_ASSERT_V2_SUPPORT
@@ -184,6 +189,9 @@
 		#define KLAYGE_CXX17_LIBRARY_ANY_SUPPORT
 		#define KLAYGE_CXX17_LIBRARY_OPTIONAL_SUPPORT
 		#define KLAYGE_CXX17_LIBRARY_STRING_VIEW_SUPPORT
+		#if _MSC_VER >= 1924
+			#define KLAYGE_CXX17_LIBRARY_CHARCONV_SUPPORT
+		#endif
 	#endif
 
 	#define KLAYGE_CXX17_LIBRARY_SIZE_AND_MORE_SUPPORT
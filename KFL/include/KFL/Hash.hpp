@@ -78,6 +78,16 @@ namespace KlayGE
 		return seed;
 	}
 
+	inline size_t RT_HASH(std::string_view str)
+	{
+		size_t seed = 0;
+		for (auto ch : str)
+		{
+			HashCombineImpl(seed, static_cast<size_t>(ch));
+		}
+		return seed;
+	}
+
 #undef PRIME_NUM
 
 	template <typename T>
@@ -33,11 +33,32 @@
 
 #pragma once
 
+#include <cstdint>
+
 namespace KlayGE
 {
+	enum LogLevel
+	{
+		LL_Info,
+		LL_Warn,
+		LL_Error
+	};
+
+	// Messages are formatted on the calling thread into a per-thread ring and written to the console
+	// (and KlayGE.log in debug builds) by a background thread. Errors are flushed synchronously.
 	void LogInfo(char const * fmt, ...);
 	void LogWarn(char const * fmt, ...);
 	void LogError(char const * fmt, ...);
+	void LogMessage(LogLevel level, char const * category, char const * fmt, ...);
+
+	// Messages below this level are discarded. Default is LL_Info.
+	void LogMinLevel(LogLevel level);
+	void LogCategoryEnabled(char const * category, bool enabled);
+	// At most max_per_second messages per second from the same format string are kept. The number of
+	// dropped ones is appended to the next message that passes. 0 disables the limit, which is the default.
+	void LogRateLimit(uint32_t max_per_second);
+	// Blocks until every message queued so far has been written.
+	void LogFlush();
 }
 
 #endif		// _KFL_LOG_HPP
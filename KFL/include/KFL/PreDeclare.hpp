@@ -47,6 +47,7 @@ namespace KlayGE
 	class ResIdentifier;
 	typedef std::shared_ptr<ResIdentifier> ResIdentifierPtr;
 	class DllLoader;
+	class MappedFile;
 
 	class XMLDocument;
 	typedef std::shared_ptr<XMLDocument> XMLDocumentPtr;
@@ -54,12 +55,16 @@ namespace KlayGE
 	typedef std::shared_ptr<XMLNode> XMLNodePtr;
 	class XMLAttribute;
 	typedef std::shared_ptr<XMLAttribute> XMLAttributePtr;
+	class XMLNodeView;
+	class XMLAttributeView;
 
 	class bad_join;
 	template <typename ResultType>
 	class joiner;
 	class threader;
 	class thread_pool;
+	class task_group;
+	class task_scheduler;
 
 	class half;
 	template <typename T, int N>
@@ -34,6 +34,8 @@
 #pragma once
 
 #include <KFL/PreDeclare.hpp>
+#include <KFL/ArrayRef.hpp>
+#include <KFL/CustomizedStreamBuf.hpp>
 #include <KFL/CXX17/string_view.hpp>
 #include <istream>
 #include <vector>
@@ -54,6 +56,15 @@ namespace KlayGE
 			: res_name_(name), timestamp_(timestamp), istream_(is), streambuf_(streambuf)
 		{
 		}
+		// A resource in contiguous memory, e.g. a file mapping or a decoded buffer. data_owner keeps it alive.
+		ResIdentifier(std::string_view name, uint64_t timestamp,
+				std::shared_ptr<void const> const & data_owner, ArrayRef<uint8_t> data)
+			: res_name_(name), timestamp_(timestamp),
+				streambuf_(MakeSharedPtr<MemStreamBuf>(data.begin(), data.end())),
+				data_owner_(data_owner), data_(data)
+		{
+			istream_ = MakeSharedPtr<std::istream>(streambuf_.get());
+		}
 
 		void ResName(std::string_view name)
 		{
@@ -113,11 +124,21 @@ namespace KlayGE
 			return *istream_;
 		}
 
+		// The whole resource as contiguous memory, if it's backed by one. Loaders can read from it directly instead
+		//  of copying through the stream. Empty if the resource is only a stream.
+		ArrayRef<uint8_t> MappedData() const
+		{
+			return data_;
+		}
+
 	private:
 		std::string res_name_;
 		uint64_t timestamp_;
 		std::shared_ptr<std::istream> istream_;
 		std::shared_ptr<std::streambuf> streambuf_;
+
+		std::shared_ptr<void const> data_owner_;
+		ArrayRef<uint8_t> data_;
 	};
 }
 
@@ -34,6 +34,7 @@
 #pragma once
 
 #include <KFL/PreDeclare.hpp>
+#include <KFL/Math.hpp>
 
 #if defined(KLAYGE_SSE_SUPPORT) && !defined(KLAYGE_COMPILER_CLANGC2)
 	#define SIMD_MATH_SSE
@@ -85,6 +86,7 @@ namespace KlayGE
 		void StoreVector2(float2& fs, SIMDVectorF4 const & v);
 		void StoreVector3(float3& fs, SIMDVectorF4 const & v);
 		void StoreVector4(float4& fs, SIMDVectorF4 const & v);
+		void StoreVector4(float* fs, SIMDVectorF4 const & v);
 		SIMDVectorF4 SetVector(float x, float y, float z, float w);
 		SIMDVectorF4 SetVector(float v);
 		float GetX(SIMDVectorF4 const & rhs);
@@ -256,6 +258,31 @@ namespace KlayGE
 		///////////////////////////////////////////////////////////////////////////////
 		SIMDVectorF4 NegativeColor(SIMDVectorF4 const & rhs);
 		SIMDVectorF4 ModulateColor(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs);
+
+		// Batch
+		// Kernels over whole arrays, with no alignment requirement. The frustum tests take SoA bounds and pick an
+		//  8-wide AVX path at runtime when the CPU has it.
+		///////////////////////////////////////////////////////////////////////////////
+		void IntersectAABBsFrustum(BoundOverlap* results, float const * min_x, float const * min_y, float const * min_z,
+			float const * max_x, float const * max_y, float const * max_z, size_t num, Frustum const & frustum);
+		void IntersectSpheresFrustum(BoundOverlap* results, float const * center_x, float const * center_y,
+			float const * center_z, float const * radius, size_t num, Frustum const & frustum);
+
+		// Matrices must be affine. The results are as tight as transforming all 8 corners.
+		void TransformAABBs(AABBox* results, AABBox const * aabbs, float4x4 const & mat, size_t num);
+		void TransformAABBs(AABBox* results, AABBox const & aabb, float4x4 const * mats, size_t num);
+
+		// results can be the same array as lhs
+		void MultiplyMatrices(float4x4* results, float4x4 const * lhs, float4x4 const & rhs, size_t num);
+
+		// Same as MathLib::mul_real and MathLib::mul_dual on each pair. results can be the same arrays as lhs or rhs.
+		void MultiplyDualQuaternions(Quaternion* results_real, Quaternion* results_dual,
+			Quaternion const * lhs_reals, Quaternion const * lhs_duals, Quaternion const * rhs_reals, Quaternion const * rhs_duals,
+			size_t num);
+		// Normalized (1 - factor) * dq0 + factor * dq1, with dq1 moved to the hemisphere of dq0 first
+		void BlendDualQuaternions(Quaternion* results_real, Quaternion* results_dual,
+			Quaternion const * reals0, Quaternion const * duals0, Quaternion const * reals1, Quaternion const * duals1,
+			float const * factors, size_t num);
 	}
 }
 
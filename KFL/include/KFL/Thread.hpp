@@ -34,12 +34,15 @@
 #pragma once
 
 #include <boost/assert.hpp>
+#include <atomic>
 #include <thread>
 #include <condition_variable>
 #include <mutex>
 #include <exception>
 #include <vector>
+#include <deque>
 #include <functional>
+#include <algorithm>
 
 #include <KFL/CXX17/optional.hpp>
 
@@ -612,6 +615,163 @@ namespace KlayGE
 	private:
 		std::shared_ptr<thread_pool_common_data_t> data_;
 	};
+
+
+	class task_scheduler;
+
+	// A set of tasks that can be waited on together. Waiting on a group lets the calling thread execute pending tasks
+	//  instead of blocking, so groups can be created and waited from inside other tasks.
+	class task_group
+	{
+		friend class task_scheduler;
+
+	public:
+		explicit task_group(task_scheduler& scheduler);
+		~task_group();
+
+		// Schedules a task in this group
+		template <typename Task>
+		void run(Task const & task);
+
+		// Schedules a continuation that runs after all tasks currently in this group are finished. The continuation
+		//  itself doesn't belong to this group.
+		template <typename Task>
+		void then(Task const & task);
+
+		// Waits until all tasks of this group are finished. Rethrows the first exception thrown by a task.
+		void wait();
+
+		bool done() const
+		{
+			return pending_ == 0;
+		}
+
+	private:
+		void wait_no_throw();
+		void task_finished();
+
+	private:
+		task_scheduler& scheduler_;
+		std::atomic<uint32_t> pending_;
+
+		std::mutex mutex_;
+		std::exception_ptr exception_;
+		std::vector<std::function<void()>> continuations_;
+	};
+
+	// A work-stealing task scheduler. Each worker owns a deque, it pushes and pops tasks at the back, while idle
+	//  workers steal from the front of others. Tasks scheduled from threads that are not workers go to a shared queue.
+	class task_scheduler
+	{
+		friend class task_group;
+
+		struct task_item
+		{
+			std::function<void()> func;
+			task_group* group;
+		};
+
+		struct work_queue
+		{
+			std::mutex mutex;
+			std::deque<task_item> tasks;
+		};
+
+	public:
+		// 0 means one worker per hardware thread, minus the calling thread
+		explicit task_scheduler(uint32_t num_workers);
+		~task_scheduler();
+
+		uint32_t num_workers() const
+		{
+			return static_cast<uint32_t>(workers_.size());
+		}
+
+		// Schedules a task without a group to wait on
+		template <typename Task>
+		void run(Task const & task)
+		{
+			this->schedule(std::function<void()>(task), nullptr);
+		}
+
+		// Splits [begin, end) into ranges of grain_size elements and calls func(range_begin, range_end) on them in
+		//  parallel. Returns after all ranges are processed. 0 grain_size means picking one from the number of workers.
+		template <typename Func>
+		void parallel_for(size_t begin, size_t end, size_t grain_size, Func const & func)
+		{
+			if (begin >= end)
+			{
+				return;
+			}
+
+			size_t const count = end - begin;
+			if (0 == grain_size)
+			{
+				grain_size = std::max<size_t>(count / ((this->num_workers() + 1) * 4), 1);
+			}
+			if ((count <= grain_size) || workers_.empty())
+			{
+				func(begin, end);
+				return;
+			}
+
+			task_group group(*this);
+			size_t range_begin = begin;
+			for (; range_begin + grain_size < end; range_begin += grain_size)
+			{
+				size_t const range_end = range_begin + grain_size;
+				group.run([&func, range_begin, range_end]()
+					{
+						func(range_begin, range_end);
+					});
+			}
+			// The calling thread processes the last range itself
+			func(range_begin, end);
+			group.wait();
+		}
+
+		// Index of the worker on current thread, or num_workers() if it's not a worker
+		uint32_t current_worker_index() const;
+
+	private:
+		void schedule(std::function<void()> const & func, task_group* group);
+		bool try_execute_one(uint32_t queue_index);
+		void execute(task_item& item);
+		void worker_func(uint32_t index);
+
+	private:
+		// One queue per worker, plus a shared one at the end for other threads
+		std::vector<std::unique_ptr<work_queue>> queues_;
+		std::vector<std::thread> workers_;
+		std::vector<thread_id> worker_ids_;
+
+		std::atomic<uint32_t> num_pending_;
+		std::atomic<bool> started_;
+		std::atomic<bool> quit_;
+		std::mutex sleep_mutex_;
+		std::condition_variable sleep_cond_;
+	};
+
+	template <typename Task>
+	void task_group::run(Task const & task)
+	{
+		scheduler_.schedule(std::function<void()>(task), this);
+	}
+
+	template <typename Task>
+	void task_group::then(Task const & task)
+	{
+		std::function<void()> func(task);
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (pending_ != 0)
+			{
+				continuations_.push_back(func);
+				return;
+			}
+		}
+		scheduler_.schedule(func, nullptr);
+	}
 }
 
 #endif		// _KFL_THREAD_HPP
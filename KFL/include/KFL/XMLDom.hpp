@@ -36,6 +36,8 @@
 #include <iosfwd>
 #include <vector>
 
+#include <KFL/CXX17/string_view.hpp>
+
 namespace KlayGE
 {
 	enum XMLNodeType
@@ -67,6 +69,7 @@ namespace KlayGE
 		XMLAttributePtr AllocAttribString(std::string_view name, std::string_view value);
 
 		void RootNode(XMLNodePtr const & new_node);
+		XMLNodeView RootView() const;
 
 	private:
 		std::shared_ptr<void> doc_;
@@ -78,6 +81,7 @@ namespace KlayGE
 	class XMLNode
 	{
 		friend class XMLDocument;
+		friend class XMLNodeView;
 
 	public:
 		explicit XMLNode(void* node);
@@ -143,6 +147,7 @@ namespace KlayGE
 	{
 		friend class XMLDocument;
 		friend class XMLNode;
+		friend class XMLAttributeView;
 
 	public:
 		explicit XMLAttribute(void* attr);
@@ -167,6 +172,122 @@ namespace KlayGE
 		std::string name_;
 		std::string value_;
 	};
+
+	// Non-owning views of the nodes and attributes in an XMLDocument. They point straight into the document's
+	// memory pool, so walking a tree with them never allocates. Strings are views of the parsed source and
+	// numbers are converted in place. A view is valid as long as its document is alive.
+	class XMLAttributeView
+	{
+	public:
+		XMLAttributeView() noexcept
+			: attr_(nullptr)
+		{
+		}
+		explicit XMLAttributeView(void* attr) noexcept
+			: attr_(attr)
+		{
+		}
+		explicit XMLAttributeView(XMLAttribute const & attr) noexcept
+			: attr_(attr.attr_)
+		{
+		}
+
+		explicit operator bool() const noexcept
+		{
+			return attr_ != nullptr;
+		}
+
+		std::string_view Name() const;
+
+		XMLAttributeView NextAttrib(std::string_view name) const;
+		XMLAttributeView NextAttrib() const;
+
+		bool TryConvert(int32_t& val) const;
+		bool TryConvert(uint32_t& val) const;
+		bool TryConvert(float& val) const;
+
+		int32_t ValueInt() const;
+		uint32_t ValueUInt() const;
+		float ValueFloat() const;
+		std::string_view ValueString() const;
+
+		// Parses a list separated by commas or white spaces. Returns the number of values parsed.
+		uint32_t ValueInts(int32_t* vals, uint32_t num) const;
+		uint32_t ValueUInts(uint32_t* vals, uint32_t num) const;
+		uint32_t ValueFloats(float* vals, uint32_t num) const;
+
+	private:
+		void* attr_;
+	};
+
+	class XMLNodeView
+	{
+	public:
+		XMLNodeView() noexcept
+			: node_(nullptr)
+		{
+		}
+		explicit XMLNodeView(void* node) noexcept
+			: node_(node)
+		{
+		}
+		explicit XMLNodeView(XMLNode const & node) noexcept
+			: node_(node.node_)
+		{
+		}
+
+		explicit operator bool() const noexcept
+		{
+			return node_ != nullptr;
+		}
+
+		std::string_view Name() const;
+		XMLNodeType Type() const;
+
+		XMLNodeView Parent() const;
+
+		XMLAttributeView FirstAttrib(std::string_view name) const;
+		XMLAttributeView LastAttrib(std::string_view name) const;
+		XMLAttributeView FirstAttrib() const;
+		XMLAttributeView LastAttrib() const;
+
+		XMLAttributeView Attrib(std::string_view name) const;
+
+		bool TryConvertAttrib(std::string_view name, int32_t& val, int32_t default_val) const;
+		bool TryConvertAttrib(std::string_view name, uint32_t& val, uint32_t default_val) const;
+		bool TryConvertAttrib(std::string_view name, float& val, float default_val) const;
+
+		int32_t AttribInt(std::string_view name, int32_t default_val) const;
+		uint32_t AttribUInt(std::string_view name, uint32_t default_val) const;
+		float AttribFloat(std::string_view name, float default_val) const;
+		std::string_view AttribString(std::string_view name, std::string_view default_val) const;
+
+		XMLNodeView FirstNode(std::string_view name) const;
+		XMLNodeView LastNode(std::string_view name) const;
+		XMLNodeView FirstNode() const;
+		XMLNodeView LastNode() const;
+
+		XMLNodeView PrevSibling(std::string_view name) const;
+		XMLNodeView NextSibling(std::string_view name) const;
+		XMLNodeView PrevSibling() const;
+		XMLNodeView NextSibling() const;
+
+		bool TryConvert(int32_t& val) const;
+		bool TryConvert(uint32_t& val) const;
+		bool TryConvert(float& val) const;
+
+		int32_t ValueInt() const;
+		uint32_t ValueUInt() const;
+		float ValueFloat() const;
+		std::string_view ValueString() const;
+
+		uint32_t ValueInts(int32_t* vals, uint32_t num) const;
+		uint32_t ValueUInts(uint32_t* vals, uint32_t num) const;
+		uint32_t ValueFloats(float* vals, uint32_t num) const;
+
+	private:
+		void* node_;
+	};
 }
 
 #endif		// _KFL_XMLDOM_HPP
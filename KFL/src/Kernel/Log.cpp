@@ -30,66 +30,654 @@
 
 #include <KFL/KFL.hpp>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdarg>
 #include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
 
 #ifdef KLAYGE_PLATFORM_ANDROID
 #include <android/log.h>
 #else
+#include <condition_variable>
+#include <csignal>
+#include <cstdlib>
+#include <exception>
 #include <iostream>
 #include <fstream>
+#include <memory>
+#include <thread>
+
+#ifdef KLAYGE_PLATFORM_WINDOWS
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 #endif
 
 #include <KFL/Log.hpp>
 
-#ifdef KLAYGE_DEBUG
-#ifndef KLAYGE_PLATFORM_ANDROID
 namespace
 {
-	std::ofstream log_file("KlayGE.log");
-}
-#endif
-#endif
+	using namespace KlayGE;
 
-namespace KlayGE
-{
-	void LogInfo(char const * fmt, ...)
+	size_t const MAX_MESSAGE_LENGTH = 1024;
+	size_t const MAX_CATEGORY_LENGTH = 32;
+	uint32_t const NUM_RATE_SLOTS = 256;
+
+	char const * const DEFAULT_CATEGORY = "KlayGE";
+
+	uint64_t HashString(char const * str)
 	{
-		va_list args;
-		va_start(args, fmt);
+		uint64_t hash = 0xCBF29CE484222325ULL;
+		while (*str)
+		{
+			hash = (hash ^ static_cast<uint8_t>(*str)) * 0x100000001B3ULL;
+			++ str;
+		}
+		return hash;
+	}
+
+	// Filtering and rate limiting are checked on the calling thread before anything is formatted. Only
+	// LogCategoryEnabled and the rare case of a category that hits the disabled mask take the lock.
+	class LogFilter
+	{
+		struct RateSlot
+		{
+			std::atomic<char const *> fmt{nullptr};
+			std::atomic<uint32_t> second{0};
+			std::atomic<uint32_t> count{0};
+			std::atomic<uint32_t> suppressed{0};
+		};
+
+	public:
+		LogFilter()
+			: min_level_(LL_Info), rate_limit_(0), disabled_mask_(0),
+				start_time_(std::chrono::steady_clock::now())
+		{
+		}
+
+		void MinLevel(LogLevel level)
+		{
+			min_level_.store(level, std::memory_order_relaxed);
+		}
+
+		void CategoryEnabled(char const * category, bool enabled)
+		{
+			std::lock_guard<std::mutex> lock(categories_mutex_);
+
+			auto iter = std::find(disabled_categories_.begin(), disabled_categories_.end(), category);
+			if (enabled)
+			{
+				if (iter != disabled_categories_.end())
+				{
+					disabled_categories_.erase(iter);
+				}
+			}
+			else
+			{
+				if (iter == disabled_categories_.end())
+				{
+					disabled_categories_.emplace_back(category);
+				}
+			}
+
+			uint64_t mask = 0;
+			for (auto const & cat : disabled_categories_)
+			{
+				mask |= CategoryBit(cat.c_str());
+			}
+			disabled_mask_.store(mask, std::memory_order_release);
+		}
+
+		void RateLimit(uint32_t max_per_second)
+		{
+			rate_limit_.store(max_per_second, std::memory_order_relaxed);
+		}
+
+		// Returns false if the message should be dropped. suppressed receives the number of messages from
+		// the same call site dropped in earlier seconds.
+		bool Accept(LogLevel level, char const * category, char const * fmt, uint32_t& suppressed)
+		{
+			suppressed = 0;
+
+			if (level < min_level_.load(std::memory_order_relaxed))
+			{
+				return false;
+			}
+
+			uint64_t const mask = disabled_mask_.load(std::memory_order_acquire);
+			if ((mask != 0) && (mask & CategoryBit(category)))
+			{
+				std::lock_guard<std::mutex> lock(categories_mutex_);
+				if (std::find(disabled_categories_.begin(), disabled_categories_.end(), category)
+					!= disabled_categories_.end())
+				{
+					return false;
+				}
+			}
+
+			uint32_t const limit = rate_limit_.load(std::memory_order_relaxed);
+			if (limit == 0)
+			{
+				return true;
+			}
+
+			// Racing callers can let a few extra messages through. That's fine for a log.
+			auto& slot = rate_slots_[(reinterpret_cast<uintptr_t>(fmt) >> 2) % NUM_RATE_SLOTS];
+			uint32_t const now = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(
+				std::chrono::steady_clock::now() - start_time_).count());
+			if (slot.fmt.load(std::memory_order_relaxed) != fmt)
+			{
+				slot.fmt.store(fmt, std::memory_order_relaxed);
+				slot.second.store(now, std::memory_order_relaxed);
+				slot.count.store(0, std::memory_order_relaxed);
+				slot.suppressed.store(0, std::memory_order_relaxed);
+			}
+			else if (slot.second.load(std::memory_order_relaxed) != now)
+			{
+				slot.second.store(now, std::memory_order_relaxed);
+				slot.count.store(0, std::memory_order_relaxed);
+			}
+
+			if (slot.count.fetch_add(1, std::memory_order_relaxed) >= limit)
+			{
+				slot.suppressed.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+
+			suppressed = slot.suppressed.exchange(0, std::memory_order_relaxed);
+			return true;
+		}
+
+	private:
+		static uint64_t CategoryBit(char const * category)
+		{
+			return 1ULL << (HashString(category) & 63);
+		}
+
+	private:
+		std::atomic<int> min_level_;
+		std::atomic<uint32_t> rate_limit_;
+
+		std::atomic<uint64_t> disabled_mask_;
+		std::mutex categories_mutex_;
+		std::vector<std::string> disabled_categories_;
+
+		std::chrono::steady_clock::time_point start_time_;
+		std::array<RateSlot, NUM_RATE_SLOTS> rate_slots_;
+	};
+
+	// Leaked, like the logger, so static destructors can still log
+	LogFilter& Filter()
+	{
+		static LogFilter* filter = new LogFilter;
+		return *filter;
+	}
+
+	char const * LevelName(LogLevel level)
+	{
+		switch (level)
+		{
+		case LL_Info:
+			return "INFO";
+
+		case LL_Warn:
+			return "WARN";
+
+		default:
+			return "ERROR";
+		}
+	}
 
 #ifdef KLAYGE_PLATFORM_ANDROID
-		__android_log_vprint(ANDROID_LOG_INFO, "KlayGE", fmt, args);
+	void LogV(LogLevel level, char const * category, char const * fmt, va_list args)
+	{
+		uint32_t suppressed;
+		if (!Filter().Accept(level, category, fmt, suppressed))
+		{
+			return;
+		}
+
+		int prio;
+		switch (level)
+		{
+		case LL_Info:
+			prio = ANDROID_LOG_INFO;
+			break;
+
+		case LL_Warn:
+			prio = ANDROID_LOG_WARN;
+			break;
+
+		default:
+			prio = ANDROID_LOG_ERROR;
+			break;
+		}
+
+		if (suppressed > 0)
+		{
+			__android_log_print(prio, category, "(%u similar messages suppressed)", suppressed);
+		}
+		__android_log_vprint(prio, category, fmt, args);
+	}
+#else
+	struct LogRecord
+	{
+		uint64_t seq;
+		LogLevel level;
+		char category[MAX_CATEGORY_LENGTH];
+		char text[MAX_MESSAGE_LENGTH];
+	};
+
+	// Single producer (the owning thread), single consumer (whoever holds the drain lock).
+	struct LogRing
+	{
+		static uint32_t const SIZE = 128;
+
+		std::array<LogRecord, SIZE> records;
+		std::atomic<uint32_t> head{0};
+		std::atomic<uint32_t> tail{0};
+		std::atomic<bool> orphaned{false};
+	};
+
+	struct LogRingHolder
+	{
+		std::shared_ptr<LogRing> ring;
+
+		~LogRingHolder()
+		{
+			if (ring)
+			{
+				ring->orphaned.store(true, std::memory_order_release);
+			}
+		}
+	};
+
+	thread_local LogRingHolder tls_ring;
+
+	std::array<int, 4> const CRASH_SIGNALS = { { SIGABRT, SIGSEGV, SIGFPE, SIGILL } };
+
+	// Rings beyond this many live threads are still logged, but not dumped by the crash handler
+	uint32_t const MAX_CRASH_RINGS = 64;
+
+	// Helpers for the signal handler, which may only use async-signal-safe calls
+	size_t AppendString(char* buf, size_t pos, size_t size, char const * str)
+	{
+		while ((pos < size) && (*str != '\0'))
+		{
+			buf[pos] = *str;
+			++ pos;
+			++ str;
+		}
+		return pos;
+	}
+
+	void WriteStdErr(char const * buf, size_t size)
+	{
+#ifdef KLAYGE_PLATFORM_WINDOWS
+		_write(2, buf, static_cast<unsigned int>(size));
 #else
-		std::array<char, 1024> buffer;
-		vsprintf(&buffer[0], fmt, args);
+		while (size > 0)
+		{
+			ssize_t const written = write(STDERR_FILENO, buf, size);
+			if (written <= 0)
+			{
+				break;
+			}
+			buf += written;
+			size -= written;
+		}
+#endif
+	}
+
+	class Logger
+	{
+	public:
+		// Intentionally never destroyed. The writer thread is detached and may outlive static destruction, and
+		// logging from other static destructors stays valid. Pending messages are flushed by an atexit handler.
+		static Logger& Instance()
+		{
+			static Logger* logger = new Logger;
+			return *logger;
+		}
+
+		void Push(LogLevel level, char const * category, uint32_t suppressed, char const * fmt, va_list args)
+		{
+			LogRing& ring = this->ThreadRing();
+
+			uint32_t const head = ring.head.load(std::memory_order_relaxed);
+			if (head - ring.tail.load(std::memory_order_acquire) == LogRing::SIZE)
+			{
+				// The writer can't keep up. Drain on this thread instead of dropping messages.
+				this->Flush();
+			}
+
+			LogRecord& record = ring.records[head % LogRing::SIZE];
+			record.seq = seq_.fetch_add(1, std::memory_order_relaxed);
+			record.level = level;
+			std::strncpy(record.category, category, MAX_CATEGORY_LENGTH - 1);
+			record.category[MAX_CATEGORY_LENGTH - 1] = '\0';
+
+			int len = vsnprintf(record.text, MAX_MESSAGE_LENGTH, fmt, args);
+			if (len < 0)
+			{
+				record.text[0] = '\0';
+				len = 0;
+			}
+			if ((suppressed > 0) && (static_cast<size_t>(len) < MAX_MESSAGE_LENGTH - 1))
+			{
+				snprintf(record.text + len, MAX_MESSAGE_LENGTH - len, " (%u similar messages suppressed)", suppressed);
+			}
+
+			ring.head.store(head + 1, std::memory_order_release);
+
+			if (level >= LL_Error)
+			{
+				this->Flush();
+			}
+			else if (head + 1 - ring.tail.load(std::memory_order_relaxed) == LogRing::SIZE / 2)
+			{
+				this->Wake();
+			}
+		}
+
+		void Flush()
+		{
+			std::lock_guard<std::mutex> lock(drain_mutex_);
+			this->Drain();
+		}
 
-		std::clog << "(INFO) KlayGE: " << &buffer[0] << std::endl;
+		// Called from the terminate handler. Gives up instead of deadlocking if the crash happened mid-drain.
+		void TryFlush()
+		{
+			std::unique_lock<std::mutex> lock(drain_mutex_, std::try_to_lock);
+			if (lock.owns_lock())
+			{
+				this->Drain();
+			}
+		}
+
+	private:
+		Logger()
+			: seq_(0), wake_requested_(false)
 #ifdef KLAYGE_DEBUG
-		log_file << "(INFO) KlayGE: " << &buffer[0] << std::endl;
+				, log_file_("KlayGE.log")
 #endif
+		{
+			for (auto& slot : crash_rings_)
+			{
+				slot.store(nullptr, std::memory_order_relaxed);
+			}
+
+			std::atexit(AtExit);
+			prev_terminate_ = std::set_terminate(OnTerminate);
+			for (size_t i = 0; i < CRASH_SIGNALS.size(); ++ i)
+			{
+				prev_signal_handlers_[i] = std::signal(CRASH_SIGNALS[i], OnSignal);
+			}
+
+			std::thread(&Logger::WriterFunc, this).detach();
+		}
+
+		LogRing& ThreadRing()
+		{
+			if (!tls_ring.ring)
+			{
+				tls_ring.ring = std::make_shared<LogRing>();
+
+				std::lock_guard<std::mutex> lock(rings_mutex_);
+				rings_.push_back(tls_ring.ring);
+				for (auto& slot : crash_rings_)
+				{
+					if (!slot.load(std::memory_order_relaxed))
+					{
+						slot.store(tls_ring.ring.get(), std::memory_order_release);
+						break;
+					}
+				}
+			}
+			return *tls_ring.ring;
+		}
+
+		void Wake()
+		{
+			{
+				std::lock_guard<std::mutex> lock(wake_mutex_);
+				wake_requested_ = true;
+			}
+			wake_cv_.notify_one();
+		}
+
+		void WriterFunc()
+		{
+			for (;;)
+			{
+				{
+					std::unique_lock<std::mutex> lock(wake_mutex_);
+					wake_cv_.wait_for(lock, std::chrono::milliseconds(100), [this] { return wake_requested_; });
+					wake_requested_ = false;
+				}
+
+				this->Flush();
+			}
+		}
+
+		// Requires drain_mutex_. Records from all threads are merged by sequence number, so the output keeps
+		// the order in which messages were submitted.
+		void Drain()
+		{
+			{
+				std::lock_guard<std::mutex> lock(rings_mutex_);
+				drain_rings_ = rings_;
+			}
+
+			batch_.clear();
+			heads_.resize(drain_rings_.size());
+			for (size_t i = 0; i < drain_rings_.size(); ++ i)
+			{
+				LogRing& ring = *drain_rings_[i];
+				uint32_t const head = ring.head.load(std::memory_order_acquire);
+				for (uint32_t j = ring.tail.load(std::memory_order_relaxed); j != head; ++ j)
+				{
+					batch_.push_back(&ring.records[j % LogRing::SIZE]);
+				}
+				heads_[i] = head;
+			}
+
+			if (!batch_.empty())
+			{
+				std::sort(batch_.begin(), batch_.end(),
+					[](LogRecord const * lhs, LogRecord const * rhs)
+					{
+						return lhs->seq < rhs->seq;
+					});
+
+				for (auto const * record : batch_)
+				{
+					std::clog << '(' << LevelName(record->level) << ") " << record->category << ": " << record->text << '\n';
+#ifdef KLAYGE_DEBUG
+					log_file_ << '(' << LevelName(record->level) << ") " << record->category << ": " << record->text << '\n';
+#endif
+				}
+				std::clog.flush();
+#ifdef KLAYGE_DEBUG
+				log_file_.flush();
 #endif
+			}
 
-		va_end(args);
-	}
+			bool any_orphaned = false;
+			for (size_t i = 0; i < drain_rings_.size(); ++ i)
+			{
+				drain_rings_[i]->tail.store(heads_[i], std::memory_order_release);
+				any_orphaned |= drain_rings_[i]->orphaned.load(std::memory_order_acquire);
+			}
+			drain_rings_.clear();
 
-	void LogWarn(char const * fmt, ...)
-	{
-		va_list args;
-		va_start(args, fmt);
+			if (any_orphaned)
+			{
+				std::lock_guard<std::mutex> lock(rings_mutex_);
+				rings_.erase(std::remove_if(rings_.begin(), rings_.end(),
+					[this](std::shared_ptr<LogRing> const & ring)
+					{
+						bool const removed = ring->orphaned.load(std::memory_order_acquire)
+							&& (ring->head.load(std::memory_order_acquire) == ring->tail.load(std::memory_order_relaxed));
+						if (removed)
+						{
+							for (auto& slot : crash_rings_)
+							{
+								LogRing* expected = ring.get();
+								slot.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel);
+							}
+						}
+						return removed;
+					}), rings_.end());
+			}
+		}
 
-#ifdef KLAYGE_PLATFORM_ANDROID
-		__android_log_vprint(ANDROID_LOG_WARN, "KlayGE", fmt, args);
-#else
-		std::array<char, 1024> buffer;
-		vsprintf(&buffer[0], fmt, args);
+		// Called from signal handlers, so it takes no locks, allocates nothing and writes with write(2) only. Pending
+		//  records of every registered ring go to stderr in submission order. A drain interrupted by the signal can
+		//  make a few lines show up twice.
+		void CrashDump()
+		{
+			std::array<uint32_t, MAX_CRASH_RINGS> tails;
+			std::array<uint32_t, MAX_CRASH_RINGS> heads;
+			std::array<LogRing*, MAX_CRASH_RINGS> rings;
+			for (uint32_t i = 0; i < MAX_CRASH_RINGS; ++ i)
+			{
+				rings[i] = crash_rings_[i].load(std::memory_order_acquire);
+				if (rings[i])
+				{
+					heads[i] = rings[i]->head.load(std::memory_order_acquire);
+					tails[i] = rings[i]->tail.load(std::memory_order_acquire);
+				}
+			}
+
+			for (;;)
+			{
+				LogRecord const * next = nullptr;
+				uint32_t next_ring = 0;
+				for (uint32_t i = 0; i < MAX_CRASH_RINGS; ++ i)
+				{
+					if (rings[i] && (tails[i] != heads[i]))
+					{
+						LogRecord const & record = rings[i]->records[tails[i] % LogRing::SIZE];
+						if (!next || (record.seq < next->seq))
+						{
+							next = &record;
+							next_ring = i;
+						}
+					}
+				}
+				if (!next)
+				{
+					break;
+				}
+				++ tails[next_ring];
+
+				char line[MAX_CATEGORY_LENGTH + MAX_MESSAGE_LENGTH + 16];
+				size_t len = AppendString(line, 0, sizeof(line) - 1, "(");
+				len = AppendString(line, len, sizeof(line) - 1, LevelName(next->level));
+				len = AppendString(line, len, sizeof(line) - 1, ") ");
+				len = AppendString(line, len, sizeof(line) - 1, next->category);
+				len = AppendString(line, len, sizeof(line) - 1, ": ");
+				len = AppendString(line, len, sizeof(line) - 1, next->text);
+				line[len] = '\n';
+				WriteStdErr(line, len + 1);
+			}
+		}
+
+		static void AtExit()
+		{
+			Logger::Instance().Flush();
+		}
+
+		static void OnTerminate()
+		{
+			Logger& logger = Logger::Instance();
+			logger.TryFlush();
+			if (logger.prev_terminate_)
+			{
+				logger.prev_terminate_();
+			}
+			std::abort();
+		}
+
+		static void OnSignal(int sig)
+		{
+			Logger& logger = Logger::Instance();
+			logger.CrashDump();
+
+			// An ignored crash signal would return into the faulting code, so the default action is used instead
+			auto handler = SIG_DFL;
+			for (size_t i = 0; i < CRASH_SIGNALS.size(); ++ i)
+			{
+				if ((CRASH_SIGNALS[i] == sig) && (logger.prev_signal_handlers_[i] != SIG_ERR)
+					&& (logger.prev_signal_handlers_[i] != SIG_IGN))
+				{
+					handler = logger.prev_signal_handlers_[i];
+				}
+			}
+			std::signal(sig, handler);
+			std::raise(sig);
+		}
+
+	private:
+		std::atomic<uint64_t> seq_;
+
+		std::mutex rings_mutex_;
+		std::vector<std::shared_ptr<LogRing>> rings_;
+
+		std::array<std::atomic<LogRing*>, MAX_CRASH_RINGS> crash_rings_;
+
+		std::mutex drain_mutex_;
+		std::vector<std::shared_ptr<LogRing>> drain_rings_;
+		std::vector<uint32_t> heads_;
+		std::vector<LogRecord const *> batch_;
+
+		std::mutex wake_mutex_;
+		std::condition_variable wake_cv_;
+		bool wake_requested_;
+
+		std::terminate_handler prev_terminate_;
+		std::array<void (*)(int), 4> prev_signal_handlers_;
 
-		std::clog << "(WARN) KlayGE: " << &buffer[0] << std::endl;
 #ifdef KLAYGE_DEBUG
-		log_file << "(WARN) KlayGE: " << &buffer[0] << std::endl;
+		std::ofstream log_file_;
 #endif
+	};
+
+	void LogV(LogLevel level, char const * category, char const * fmt, va_list args)
+	{
+		uint32_t suppressed;
+		if (Filter().Accept(level, category, fmt, suppressed))
+		{
+			Logger::Instance().Push(level, category, suppressed, fmt, args);
+		}
+	}
 #endif
+}
 
+namespace KlayGE
+{
+	void LogInfo(char const * fmt, ...)
+	{
+		va_list args;
+		va_start(args, fmt);
+		LogV(LL_Info, DEFAULT_CATEGORY, fmt, args);
+		va_end(args);
+	}
+
+	void LogWarn(char const * fmt, ...)
+	{
+		va_list args;
+		va_start(args, fmt);
+		LogV(LL_Warn, DEFAULT_CATEGORY, fmt, args);
 		va_end(args);
 	}
 
@@ -97,19 +685,37 @@ namespace KlayGE
 	{
 		va_list args;
 		va_start(args, fmt);
+		LogV(LL_Error, DEFAULT_CATEGORY, fmt, args);
+		va_end(args);
+	}
 
-#ifdef KLAYGE_PLATFORM_ANDROID
-		__android_log_vprint(ANDROID_LOG_ERROR, "KlayGE", fmt, args);
-#else
-		std::array<char, 1024> buffer;
-		vsprintf(&buffer[0], fmt, args);
+	void LogMessage(LogLevel level, char const * category, char const * fmt, ...)
+	{
+		va_list args;
+		va_start(args, fmt);
+		LogV(level, category, fmt, args);
+		va_end(args);
+	}
 
-		std::clog << "(ERROR) KlayGE: " << &buffer[0] << std::endl;
-#ifdef KLAYGE_DEBUG
-		log_file << "(ERROR) KlayGE: " << &buffer[0] << std::endl;
-#endif
-#endif
+	void LogMinLevel(LogLevel level)
+	{
+		Filter().MinLevel(level);
+	}
 
-		va_end(args);
+	void LogCategoryEnabled(char const * category, bool enabled)
+	{
+		Filter().CategoryEnabled(category, enabled);
+	}
+
+	void LogRateLimit(uint32_t max_per_second)
+	{
+		Filter().RateLimit(max_per_second);
+	}
+
+	void LogFlush()
+	{
+#ifndef KLAYGE_PLATFORM_ANDROID
+		Logger::Instance().Flush();
+#endif
 	}
 }
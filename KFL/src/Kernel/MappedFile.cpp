@@ -0,0 +1,163 @@
+/**
+ * @file MappedFile.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KFL, a subproject of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KFL/KFL.hpp>
+
+#ifdef KLAYGE_PLATFORM_WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <KFL/MappedFile.hpp>
+
+namespace KlayGE
+{
+	MappedFile::MappedFile()
+		: data_(nullptr), size_(0)
+#ifdef KLAYGE_PLATFORM_WINDOWS
+			, file_(INVALID_HANDLE_VALUE), mapping_(nullptr)
+#endif
+	{
+	}
+
+	MappedFile::~MappedFile()
+	{
+		this->Unmap();
+	}
+
+	bool MappedFile::Map(std::string const & file_name)
+	{
+		this->Unmap();
+
+#ifdef KLAYGE_PLATFORM_WINDOWS
+		std::wstring wname;
+		Convert(wname, file_name);
+
+#ifdef KLAYGE_PLATFORM_WINDOWS_DESKTOP
+		file_ = ::CreateFileW(wname.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+#else
+		file_ = ::CreateFile2(wname.c_str(), GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, nullptr);
+#endif
+		if (INVALID_HANDLE_VALUE == file_)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER file_size;
+		if (!::GetFileSizeEx(file_, &file_size) || (0 == file_size.QuadPart))
+		{
+			this->Unmap();
+			return false;
+		}
+		size_ = static_cast<uint64_t>(file_size.QuadPart);
+
+#ifdef KLAYGE_PLATFORM_WINDOWS_DESKTOP
+		mapping_ = ::CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+#else
+		mapping_ = ::CreateFileMappingFromApp(file_, nullptr, PAGE_READONLY, 0, nullptr);
+#endif
+		if (nullptr == mapping_)
+		{
+			this->Unmap();
+			return false;
+		}
+
+#ifdef KLAYGE_PLATFORM_WINDOWS_DESKTOP
+		data_ = static_cast<uint8_t const *>(::MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+#else
+		data_ = static_cast<uint8_t const *>(::MapViewOfFileFromApp(mapping_, FILE_MAP_READ, 0, 0));
+#endif
+		if (nullptr == data_)
+		{
+			this->Unmap();
+			return false;
+		}
+#else
+		int const fd = ::open(file_name.c_str(), O_RDONLY);
+		if (fd < 0)
+		{
+			return false;
+		}
+
+		struct stat file_stat;
+		if ((::fstat(fd, &file_stat) != 0) || (0 == file_stat.st_size))
+		{
+			::close(fd);
+			return false;
+		}
+		size_ = static_cast<uint64_t>(file_stat.st_size);
+
+		void* data = ::mmap(nullptr, static_cast<size_t>(size_), PROT_READ, MAP_PRIVATE, fd, 0);
+		// The mapping keeps its own reference to the file
+		::close(fd);
+		if (MAP_FAILED == data)
+		{
+			size_ = 0;
+			return false;
+		}
+		data_ = static_cast<uint8_t const *>(data);
+#endif
+
+		return true;
+	}
+
+	void MappedFile::Unmap()
+	{
+#ifdef KLAYGE_PLATFORM_WINDOWS
+		if (data_ != nullptr)
+		{
+			::UnmapViewOfFile(data_);
+		}
+		if (mapping_ != nullptr)
+		{
+			::CloseHandle(mapping_);
+			mapping_ = nullptr;
+		}
+		if (file_ != INVALID_HANDLE_VALUE)
+		{
+			::CloseHandle(file_);
+			file_ = INVALID_HANDLE_VALUE;
+		}
+#else
+		if (data_ != nullptr)
+		{
+			::munmap(const_cast<uint8_t*>(data_), static_cast<size_t>(size_));
+		}
+#endif
+
+		data_ = nullptr;
+		size_ = 0;
+	}
+}
@@ -248,4 +248,259 @@ namespace KlayGE
 	{
 		data_->kill_all();
 	}
+
+
+	task_group::task_group(task_scheduler& scheduler)
+		: scheduler_(scheduler), pending_(0)
+	{
+	}
+
+	task_group::~task_group()
+	{
+		this->wait_no_throw();
+	}
+
+	void task_group::wait()
+	{
+		this->wait_no_throw();
+
+		std::exception_ptr e;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			e = exception_;
+			exception_ = nullptr;
+		}
+		if (e)
+		{
+			std::rethrow_exception(e);
+		}
+	}
+
+	void task_group::wait_no_throw()
+	{
+		uint32_t const queue_index = scheduler_.current_worker_index();
+		while (pending_ != 0)
+		{
+			// Help executing tasks instead of sleeping. The tasks of this group are likely to be in our own queue.
+			if (!scheduler_.try_execute_one(queue_index))
+			{
+				// Nothing to help with, sleep until new tasks are scheduled or the group is done
+				std::unique_lock<std::mutex> lock(scheduler_.sleep_mutex_);
+				scheduler_.sleep_cond_.wait(lock, [this]
+					{
+						return (0 == pending_) || (scheduler_.num_pending_ != 0);
+					});
+			}
+		}
+
+		// Make sure the thread finishing the last task has released the mutex
+		std::lock_guard<std::mutex> lock(mutex_);
+	}
+
+	void task_group::task_finished()
+	{
+		// Once pending_ reaches 0, the waiter can return and destroy this group. Nothing but locals can be touched after that.
+		task_scheduler& scheduler = scheduler_;
+		std::vector<std::function<void()>> continuations;
+		bool done;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (1 == pending_)
+			{
+				continuations.swap(continuations_);
+			}
+			-- pending_;
+			done = (0 == pending_);
+		}
+
+		for (auto const & func : continuations)
+		{
+			scheduler.schedule(func, nullptr);
+		}
+
+		if (done)
+		{
+			{
+				std::lock_guard<std::mutex> lock(scheduler.sleep_mutex_);
+			}
+			scheduler.sleep_cond_.notify_all();
+		}
+	}
+
+
+	task_scheduler::task_scheduler(uint32_t num_workers)
+		: num_pending_(0), started_(false), quit_(false)
+	{
+		if (0 == num_workers)
+		{
+			num_workers = std::max(std::thread::hardware_concurrency(), 2U) - 1;
+		}
+
+		queues_.resize(num_workers + 1);
+		for (auto& queue : queues_)
+		{
+			queue = MakeUniquePtr<work_queue>();
+		}
+
+		workers_.reserve(num_workers);
+		worker_ids_.reserve(num_workers);
+		for (uint32_t i = 0; i < num_workers; ++ i)
+		{
+			workers_.emplace_back(std::bind(&task_scheduler::worker_func, this, i));
+			worker_ids_.push_back(workers_.back().get_id());
+		}
+
+		// worker_ids_ is complete, workers can start to look it up
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex_);
+			started_ = true;
+		}
+		sleep_cond_.notify_all();
+	}
+
+	task_scheduler::~task_scheduler()
+	{
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex_);
+			quit_ = true;
+		}
+		sleep_cond_.notify_all();
+
+		for (auto& worker : workers_)
+		{
+			worker.join();
+		}
+	}
+
+	uint32_t task_scheduler::current_worker_index() const
+	{
+		thread_id const id = threadof(0);
+		for (size_t i = 0; i < worker_ids_.size(); ++ i)
+		{
+			if (worker_ids_[i] == id)
+			{
+				return static_cast<uint32_t>(i);
+			}
+		}
+		return this->num_workers();
+	}
+
+	void task_scheduler::schedule(std::function<void()> const & func, task_group* group)
+	{
+		if (group)
+		{
+			++ group->pending_;
+		}
+
+		if (workers_.empty())
+		{
+			task_item item = { func, group };
+			this->execute(item);
+			return;
+		}
+
+		// Count it before it's visible to others, so num_pending_ never underflows
+		++ num_pending_;
+		auto& queue = *queues_[this->current_worker_index()];
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.tasks.push_back({ func, group });
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex_);
+		}
+		sleep_cond_.notify_one();
+	}
+
+	bool task_scheduler::try_execute_one(uint32_t queue_index)
+	{
+		uint32_t const num_queues = static_cast<uint32_t>(queues_.size());
+		for (uint32_t i = 0; i < num_queues; ++ i)
+		{
+			uint32_t const index = (queue_index + i) % num_queues;
+			auto& queue = *queues_[index];
+
+			task_item item;
+			{
+				std::lock_guard<std::mutex> lock(queue.mutex);
+				if (queue.tasks.empty())
+				{
+					continue;
+				}
+
+				if ((0 == i) && (queue_index < this->num_workers()))
+				{
+					// Our own queue, newest task first for cache locality
+					item = std::move(queue.tasks.back());
+					queue.tasks.pop_back();
+				}
+				else
+				{
+					// Steal the oldest task, which tends to be the largest piece of work
+					item = std::move(queue.tasks.front());
+					queue.tasks.pop_front();
+				}
+			}
+
+			-- num_pending_;
+			this->execute(item);
+			return true;
+		}
+
+		return false;
+	}
+
+	void task_scheduler::execute(task_item& item)
+	{
+		try
+		{
+			item.func();
+		}
+		catch (...)
+		{
+			if (item.group)
+			{
+				std::lock_guard<std::mutex> lock(item.group->mutex_);
+				if (!item.group->exception_)
+				{
+					item.group->exception_ = std::current_exception();
+				}
+			}
+		}
+
+		if (item.group)
+		{
+			item.group->task_finished();
+		}
+	}
+
+	void task_scheduler::worker_func(uint32_t index)
+	{
+		{
+			std::unique_lock<std::mutex> lock(sleep_mutex_);
+			sleep_cond_.wait(lock, [this]
+				{
+					return started_ || quit_;
+				});
+		}
+
+		for (;;)
+		{
+			if (this->try_execute_one(index))
+			{
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(sleep_mutex_);
+			sleep_cond_.wait(lock, [this]
+				{
+					return (num_pending_ != 0) || quit_;
+				});
+			if (quit_ && (0 == num_pending_))
+			{
+				return;
+			}
+		}
+	}
 }
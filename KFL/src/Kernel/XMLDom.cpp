@@ -29,6 +29,7 @@
  */
 
 #include <KFL/KFL.hpp>
+#include <KFL/ErrorHandling.hpp>
 #include <KFL/Util.hpp>
 #include <KFL/ResIdentifier.hpp>
 
@@ -44,8 +45,210 @@
 #include <rapidxml.hpp>
 #include <rapidxml_print.hpp>
 
+#include <cstdlib>
+#include <limits>
+#ifdef KLAYGE_CXX17_LIBRARY_CHARCONV_SUPPORT
+#include <charconv>
+#endif
+
 #include <KFL/XMLDom.hpp>
 
+namespace
+{
+	using namespace KlayGE;
+
+	bool IsSpace(char ch)
+	{
+		return (ch == ' ') || (ch == '\t') || (ch == '\r') || (ch == '\n');
+	}
+
+	bool IsSeparator(char ch)
+	{
+		return (ch == ',') || IsSpace(ch);
+	}
+
+	// Parses a number at the beginning of [first, last). Returns the end of the number, or nullptr on failure.
+#ifdef KLAYGE_CXX17_LIBRARY_CHARCONV_SUPPORT
+	template <typename T>
+	char const * ParseNumber(char const * first, char const * last, T& val)
+	{
+		if ((first != last) && (*first == '+'))
+		{
+			++ first;
+			if ((first != last) && (*first == '-'))
+			{
+				return nullptr;
+			}
+		}
+
+		auto const result = std::from_chars(first, last, val);
+		return (result.ec == std::errc()) ? result.ptr : nullptr;
+	}
+#else
+	// strto* need a null terminated string, which the values of allocated nodes and attributes aren't
+	template <typename T, typename Func>
+	char const * ParseNumber(char const * first, char const * last, T& val, Func func)
+	{
+		char buf[64];
+		size_t const len = std::min(static_cast<size_t>(last - first), sizeof(buf) - 1);
+		std::memcpy(buf, first, len);
+		buf[len] = '\0';
+
+		if ((len == 0) || IsSpace(buf[0]))
+		{
+			return nullptr;
+		}
+
+		char* end;
+		if (!func(buf, &end, val) || (end == buf))
+		{
+			return nullptr;
+		}
+		return first + (end - buf);
+	}
+
+	char const * ParseNumber(char const * first, char const * last, int32_t& val)
+	{
+		return ParseNumber(first, last, val,
+			[](char const * str, char** end, int32_t& v)
+			{
+				long long const ll = std::strtoll(str, end, 10);
+				v = static_cast<int32_t>(ll);
+				return (ll >= std::numeric_limits<int32_t>::min()) && (ll <= std::numeric_limits<int32_t>::max());
+			});
+	}
+
+	char const * ParseNumber(char const * first, char const * last, uint32_t& val)
+	{
+		return ParseNumber(first, last, val,
+			[](char const * str, char** end, uint32_t& v)
+			{
+				unsigned long long const ull = std::strtoull(str, end, 10);
+				v = static_cast<uint32_t>(ull);
+				return (str[0] != '-') && (ull <= std::numeric_limits<uint32_t>::max());
+			});
+	}
+
+	char const * ParseNumber(char const * first, char const * last, float& val)
+	{
+		return ParseNumber(first, last, val,
+			[](char const * str, char** end, float& v)
+			{
+				v = std::strtof(str, end);
+				return true;
+			});
+	}
+#endif
+
+	template <typename T>
+	bool ConvertValue(std::string_view str, T& val)
+	{
+		char const * first = str.data();
+		char const * last = first + str.size();
+		while ((first != last) && IsSpace(*first))
+		{
+			++ first;
+		}
+		while ((first != last) && IsSpace(*(last - 1)))
+		{
+			-- last;
+		}
+
+		T tmp;
+		if ((first != last) && (ParseNumber(first, last, tmp) == last))
+		{
+			val = tmp;
+			return true;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	template <typename T>
+	T ConvertValue(std::string_view str)
+	{
+		T val;
+		if (!ConvertValue(str, val))
+		{
+			TMSG("Invalid numeric value \"" + std::string(str.data(), str.size()) + "\"");
+		}
+		return val;
+	}
+
+	template <typename T>
+	uint32_t ConvertValues(std::string_view str, T* vals, uint32_t num)
+	{
+		char const * first = str.data();
+		char const * const last = first + str.size();
+
+		uint32_t n = 0;
+		while (n < num)
+		{
+			while ((first != last) && IsSeparator(*first))
+			{
+				++ first;
+			}
+			if (first == last)
+			{
+				break;
+			}
+
+			T val;
+			char const * next = ParseNumber(first, last, val);
+			if (!next || ((next != last) && !IsSeparator(*next)))
+			{
+				break;
+			}
+
+			vals[n] = val;
+			first = next;
+			++ n;
+		}
+
+		return n;
+	}
+
+	// rapidxml doesn't copy strings. Keep them in the document's pool, so they outlive the caller's buffer.
+	char* CopyString(void* doc, std::string_view str)
+	{
+		// allocate_string measures the source with strlen on a 0 size
+		return str.empty() ? nullptr : static_cast<rapidxml::xml_document<>*>(doc)->allocate_string(str.data(), str.size());
+	}
+
+	XMLNodeType ToXMLNodeType(rapidxml::node_type type)
+	{
+		switch (type)
+		{
+		case rapidxml::node_document:
+			return XNT_Document;
+
+		case rapidxml::node_element:
+			return XNT_Element;
+
+		case rapidxml::node_data:
+			return XNT_Data;
+
+		case rapidxml::node_cdata:
+			return XNT_CData;
+
+		case rapidxml::node_comment:
+			return XNT_Comment;
+
+		case rapidxml::node_declaration:
+			return XNT_Declaration;
+
+		case rapidxml::node_doctype:
+			return XNT_Doctype;
+
+		case rapidxml::node_pi:
+		default:
+			return XNT_PI;
+		}
+	}
+}
+
 namespace KlayGE
 {
 	XMLDocument::XMLDocument()
@@ -110,6 +313,11 @@ namespace KlayGE
 		root_ = new_node;
 	}
 
+	XMLNodeView XMLDocument::RootView() const
+	{
+		return XMLNodeView(root_ ? root_->node_ : nullptr);
+	}
+
 
 	XMLNode::XMLNode(void* node)
 		: node_(node)
@@ -161,7 +369,7 @@ namespace KlayGE
 			break;
 		}
 
-		node_ = static_cast<rapidxml::xml_document<>*>(doc)->allocate_node(xtype, name.data(), nullptr, name.size());
+		node_ = static_cast<rapidxml::xml_document<>*>(doc)->allocate_node(xtype, CopyString(doc, name), nullptr, name.size());
 	}
 
 	std::string const & XMLNode::Name() const
@@ -171,33 +379,7 @@ namespace KlayGE
 
 	XMLNodeType XMLNode::Type() const
 	{
-		switch (static_cast<rapidxml::xml_node<>*>(node_)->type())
-		{
-		case rapidxml::node_document:
-			return XNT_Document;
-
-		case rapidxml::node_element:
-			return XNT_Element;
-
-		case rapidxml::node_data:
-			return XNT_Data;
-
-		case rapidxml::node_cdata:
-			return XNT_CData;
-
-		case rapidxml::node_comment:
-			return XNT_Comment;
-
-		case rapidxml::node_declaration:
-			return XNT_Declaration;
-
-		case rapidxml::node_doctype:
-			return XNT_Doctype;
-
-		case rapidxml::node_pi:
-		default:
-			return XNT_PI;
-		}
+		return ToXMLNodeType(static_cast<rapidxml::xml_node<>*>(node_)->type());
 	}
 
 	XMLNodePtr XMLNode::Parent() const
@@ -490,32 +672,32 @@ namespace KlayGE
 
 	bool XMLNode::TryConvert(int32_t& val) const
 	{
-		return boost::conversion::try_lexical_convert(this->ValueString(), val);
+		return XMLNodeView(node_).TryConvert(val);
 	}
 
 	bool XMLNode::TryConvert(uint32_t& val) const
 	{
-		return boost::conversion::try_lexical_convert(this->ValueString(), val);
+		return XMLNodeView(node_).TryConvert(val);
 	}
 
 	bool XMLNode::TryConvert(float& val) const
 	{
-		return boost::conversion::try_lexical_convert(this->ValueString(), val);
+		return XMLNodeView(node_).TryConvert(val);
 	}
 
 	int32_t XMLNode::ValueInt() const
 	{
-		return boost::lexical_cast<int32_t>(this->ValueString());
+		return XMLNodeView(node_).ValueInt();
 	}
 
 	uint32_t XMLNode::ValueUInt() const
 	{
-		return boost::lexical_cast<uint32_t>(this->ValueString());
+		return XMLNodeView(node_).ValueUInt();
 	}
 
 	float XMLNode::ValueFloat() const
 	{
-		return boost::lexical_cast<float>(this->ValueString());
+		return XMLNodeView(node_).ValueFloat();
 	}
 
 	std::string XMLNode::ValueString() const
@@ -539,7 +721,8 @@ namespace KlayGE
 	XMLAttribute::XMLAttribute(void* doc, std::string_view name, std::string_view value)
 		: name_(name), value_(value)
 	{
-		attr_ = static_cast<rapidxml::xml_document<>*>(doc)->allocate_attribute(name.data(), value.data(), name.size(), value.size());
+		attr_ = static_cast<rapidxml::xml_document<>*>(doc)->allocate_attribute(CopyString(doc, name), CopyString(doc, value),
+			name.size(), value.size());
 	}
 
 	std::string const & XMLAttribute::Name() const
@@ -575,36 +758,285 @@ namespace KlayGE
 
 	bool XMLAttribute::TryConvert(int32_t& val) const
 	{
-		return boost::conversion::try_lexical_convert(value_, val);
+		return ConvertValue(value_, val);
 	}
 
 	bool XMLAttribute::TryConvert(uint32_t& val) const
 	{
-		return boost::conversion::try_lexical_convert(value_, val);
+		return ConvertValue(value_, val);
 	}
 
 	bool XMLAttribute::TryConvert(float& val) const
 	{
-		return boost::conversion::try_lexical_convert(value_, val);
+		return ConvertValue(value_, val);
 	}
 
 	int32_t XMLAttribute::ValueInt() const
 	{
-		return boost::lexical_cast<int32_t>(value_);
+		return ConvertValue<int32_t>(value_);
 	}
 
 	uint32_t XMLAttribute::ValueUInt() const
 	{
-		return boost::lexical_cast<uint32_t>(value_);
+		return ConvertValue<uint32_t>(value_);
 	}
 
 	float XMLAttribute::ValueFloat() const
 	{
-		return boost::lexical_cast<float>(value_);
+		return ConvertValue<float>(value_);
 	}
 
 	std::string const & XMLAttribute::ValueString() const
 	{
 		return value_;
 	}
+
+
+	std::string_view XMLAttributeView::Name() const
+	{
+		auto const xml_attr = static_cast<rapidxml::xml_attribute<>*>(attr_);
+		return std::string_view(xml_attr->name(), xml_attr->name_size());
+	}
+
+	XMLAttributeView XMLAttributeView::NextAttrib(std::string_view name) const
+	{
+		return XMLAttributeView(static_cast<rapidxml::xml_attribute<>*>(attr_)->next_attribute(name.data(), name.size()));
+	}
+
+	XMLAttributeView XMLAttributeView::NextAttrib() const
+	{
+		return XMLAttributeView(static_cast<rapidxml::xml_attribute<>*>(attr_)->next_attribute());
+	}
+
+	bool XMLAttributeView::TryConvert(int32_t& val) const
+	{
+		return ConvertValue(this->ValueString(), val);
+	}
+
+	bool XMLAttributeView::TryConvert(uint32_t& val) const
+	{
+		return ConvertValue(this->ValueString(), val);
+	}
+
+	bool XMLAttributeView::TryConvert(float& val) const
+	{
+		return ConvertValue(this->ValueString(), val);
+	}
+
+	int32_t XMLAttributeView::ValueInt() const
+	{
+		return ConvertValue<int32_t>(this->ValueString());
+	}
+
+	uint32_t XMLAttributeView::ValueUInt() const
+	{
+		return ConvertValue<uint32_t>(this->ValueString());
+	}
+
+	float XMLAttributeView::ValueFloat() const
+	{
+		return ConvertValue<float>(this->ValueString());
+	}
+
+	std::string_view XMLAttributeView::ValueString() const
+	{
+		auto const xml_attr = static_cast<rapidxml::xml_attribute<>*>(attr_);
+		return std::string_view(xml_attr->value(), xml_attr->value_size());
+	}
+
+	uint32_t XMLAttributeView::ValueInts(int32_t* vals, uint32_t num) const
+	{
+		return ConvertValues(this->ValueString(), vals, num);
+	}
+
+	uint32_t XMLAttributeView::ValueUInts(uint32_t* vals, uint32_t num) const
+	{
+		return ConvertValues(this->ValueString(), vals, num);
+	}
+
+	uint32_t XMLAttributeView::ValueFloats(float* vals, uint32_t num) const
+	{
+		return ConvertValues(this->ValueString(), vals, num);
+	}
+
+
+	std::string_view XMLNodeView::Name() const
+	{
+		auto const xml_node = static_cast<rapidxml::xml_node<>*>(node_);
+		return std::string_view(xml_node->name(), xml_node->name_size());
+	}
+
+	XMLNodeType XMLNodeView::Type() const
+	{
+		return ToXMLNodeType(static_cast<rapidxml::xml_node<>*>(node_)->type());
+	}
+
+	XMLNodeView XMLNodeView::Parent() const
+	{
+		return XMLNodeView(static_cast<rapidxml::xml_node<>*>(node_)->parent());
+	}
+
+	XMLAttributeView XMLNodeView::FirstAttrib(std::string_view name) const
+	{
+		return XMLAttributeView(static_cast<rapidxml::xml_node<>*>(node_)->first_attribute(name.data(), name.size()));
+	}
+
+	XMLAttributeView XMLNodeView::LastAttrib(std::string_view name) const
+	{
+		return XMLAttributeView(static_cast<rapidxml::xml_node<>*>(node_)->last_attribute(name.data(), name.size()));
+	}
+
+	XMLAttributeView XMLNodeView::FirstAttrib() const
+	{
+		return XMLAttributeView(static_cast<rapidxml::xml_node<>*>(node_)->first_attribute());
+	}
+
+	XMLAttributeView XMLNodeView::LastAttrib() const
+	{
+		return XMLAttributeView(static_cast<rapidxml::xml_node<>*>(node_)->last_attribute());
+	}
+
+	XMLAttributeView XMLNodeView::Attrib(std::string_view name) const
+	{
+		return this->FirstAttrib(name);
+	}
+
+	bool XMLNodeView::TryConvertAttrib(std::string_view name, int32_t& val, int32_t default_val) const
+	{
+		val = default_val;
+
+		XMLAttributeView const attr = this->Attrib(name);
+		return attr ? attr.TryConvert(val) : true;
+	}
+
+	bool XMLNodeView::TryConvertAttrib(std::string_view name, uint32_t& val, uint32_t default_val) const
+	{
+		val = default_val;
+
+		XMLAttributeView const attr = this->Attrib(name);
+		return attr ? attr.TryConvert(val) : true;
+	}
+
+	bool XMLNodeView::TryConvertAttrib(std::string_view name, float& val, float default_val) const
+	{
+		val = default_val;
+
+		XMLAttributeView const attr = this->Attrib(name);
+		return attr ? attr.TryConvert(val) : true;
+	}
+
+	int32_t XMLNodeView::AttribInt(std::string_view name, int32_t default_val) const
+	{
+		XMLAttributeView const attr = this->Attrib(name);
+		return attr ? attr.ValueInt() : default_val;
+	}
+
+	uint32_t XMLNodeView::AttribUInt(std::string_view name, uint32_t default_val) const
+	{
+		XMLAttributeView const attr = this->Attrib(name);
+		return attr ? attr.ValueUInt() : default_val;
+	}
+
+	float XMLNodeView::AttribFloat(std::string_view name, float default_val) const
+	{
+		XMLAttributeView const attr = this->Attrib(name);
+		return attr ? attr.ValueFloat() : default_val;
+	}
+
+	std::string_view XMLNodeView::AttribString(std::string_view name, std::string_view default_val) const
+	{
+		XMLAttributeView const attr = this->Attrib(name);
+		return attr ? attr.ValueString() : default_val;
+	}
+
+	XMLNodeView XMLNodeView::FirstNode(std::string_view name) const
+	{
+		return XMLNodeView(static_cast<rapidxml::xml_node<>*>(node_)->first_node(name.data(), name.size()));
+	}
+
+	XMLNodeView XMLNodeView::LastNode(std::string_view name) const
+	{
+		return XMLNodeView(static_cast<rapidxml::xml_node<>*>(node_)->last_node(name.data(), name.size()));
+	}
+
+	XMLNodeView XMLNodeView::FirstNode() const
+	{
+		return XMLNodeView(static_cast<rapidxml::xml_node<>*>(node_)->first_node());
+	}
+
+	XMLNodeView XMLNodeView::LastNode() const
+	{
+		return XMLNodeView(static_cast<rapidxml::xml_node<>*>(node_)->last_node());
+	}
+
+	XMLNodeView XMLNodeView::PrevSibling(std::string_view name) const
+	{
+		return XMLNodeView(static_cast<rapidxml::xml_node<>*>(node_)->previous_sibling(name.data(), name.size()));
+	}
+
+	XMLNodeView XMLNodeView::NextSibling(std::string_view name) const
+	{
+		return XMLNodeView(static_cast<rapidxml::xml_node<>*>(node_)->next_sibling(name.data(), name.size()));
+	}
+
+	XMLNodeView XMLNodeView::PrevSibling() const
+	{
+		return XMLNodeView(static_cast<rapidxml::xml_node<>*>(node_)->previous_sibling());
+	}
+
+	XMLNodeView XMLNodeView::NextSibling() const
+	{
+		return XMLNodeView(static_cast<rapidxml::xml_node<>*>(node_)->next_sibling());
+	}
+
+	bool XMLNodeView::TryConvert(int32_t& val) const
+	{
+		return ConvertValue(this->ValueString(), val);
+	}
+
+	bool XMLNodeView::TryConvert(uint32_t& val) const
+	{
+		return ConvertValue(this->ValueString(), val);
+	}
+
+	bool XMLNodeView::TryConvert(float& val) const
+	{
+		return ConvertValue(this->ValueString(), val);
+	}
+
+	int32_t XMLNodeView::ValueInt() const
+	{
+		return ConvertValue<int32_t>(this->ValueString());
+	}
+
+	uint32_t XMLNodeView::ValueUInt() const
+	{
+		return ConvertValue<uint32_t>(this->ValueString());
+	}
+
+	float XMLNodeView::ValueFloat() const
+	{
+		return ConvertValue<float>(this->ValueString());
+	}
+
+	std::string_view XMLNodeView::ValueString() const
+	{
+		auto const xml_node = static_cast<rapidxml::xml_node<>*>(node_);
+		return std::string_view(xml_node->value(), xml_node->value_size());
+	}
+
+	uint32_t XMLNodeView::ValueInts(int32_t* vals, uint32_t num) const
+	{
+		return ConvertValues(this->ValueString(), vals, num);
+	}
+
+	uint32_t XMLNodeView::ValueUInts(uint32_t* vals, uint32_t num) const
+	{
+		return ConvertValues(this->ValueString(), vals, num);
+	}
+
+	uint32_t XMLNodeView::ValueFloats(float* vals, uint32_t num) const
+	{
+		return ConvertValues(this->ValueString(), vals, num);
+	}
 }
@@ -2878,7 +2878,7 @@ namespace KlayGE
 				{
 					return BO_No;
 				}
-				if (d > sphere.Radius())
+				if (d < sphere.Radius())
 				{
 					intersect = true;
 				}
@@ -33,8 +33,345 @@
 
 #ifdef SIMD_MATH_SSE
 	#include <emmintrin.h>
+
+	// AVX code is compiled per function and only runs when CPUInfo reports it
+	#if defined(KLAYGE_CPU_X64)
+		#if defined(KLAYGE_COMPILER_MSVC)
+			#define SIMD_MATH_AVX_DISPATCH
+			#define SIMD_MATH_AVX_FUNC
+		#elif defined(KLAYGE_COMPILER_GCC) || defined(KLAYGE_COMPILER_CLANG)
+			#if defined(__has_attribute)
+				#if __has_attribute(target)
+					#define SIMD_MATH_AVX_DISPATCH
+					#define SIMD_MATH_AVX_FUNC __attribute__((target("avx")))
+				#endif
+			#endif
+		#endif
+	#endif
+#endif
+
+#ifdef SIMD_MATH_AVX_DISPATCH
+	#include <immintrin.h>
+	#include <KFL/CpuInfo.hpp>
 #endif
 
+namespace
+{
+	using namespace KlayGE;
+
+	void StoreOverlaps(BoundOverlap* results, int outside_mask, int intersect_mask, uint32_t num_lanes)
+	{
+		for (uint32_t lane = 0; lane < num_lanes; ++ lane)
+		{
+			if (outside_mask & (1 << lane))
+			{
+				results[lane] = BO_No;
+			}
+			else
+			{
+				results[lane] = (intersect_mask & (1 << lane)) ? BO_Partial : BO_Yes;
+			}
+		}
+	}
+
+#if defined(SIMD_MATH_SSE)
+	// bounds are min x/y/z and max x/y/z
+	void IntersectAABBsFrustumSSE(BoundOverlap* results, float const * const bounds[6], size_t num,
+		Frustum const & frustum)
+	{
+		__m128 plane_coeffs[6][4];
+		bool plane_negs[6][3];
+		for (int p = 0; p < 6; ++ p)
+		{
+			Plane const & plane = frustum.FrustumPlane(p);
+			for (int k = 0; k < 4; ++ k)
+			{
+				plane_coeffs[p][k] = _mm_set1_ps(plane[k]);
+			}
+			for (int k = 0; k < 3; ++ k)
+			{
+				plane_negs[p][k] = plane[k] < 0;
+			}
+		}
+
+		__m128 const zero = _mm_setzero_ps();
+		for (size_t i = 0; i < num; i += 4)
+		{
+			uint32_t const num_lanes = static_cast<uint32_t>(std::min<size_t>(num - i, 4));
+
+			__m128 b[6];
+			for (int j = 0; j < 6; ++ j)
+			{
+				if (4 == num_lanes)
+				{
+					b[j] = _mm_loadu_ps(bounds[j] + i);
+				}
+				else
+				{
+					float tail[4] = { 0, 0, 0, 0 };
+					std::copy(bounds[j] + i, bounds[j] + i + num_lanes, tail);
+					b[j] = _mm_loadu_ps(tail);
+				}
+			}
+
+			__m128 outside = zero;
+			__m128 intersect = zero;
+			for (int p = 0; p < 6; ++ p)
+			{
+				// v1 is diagonally opposed to v0
+				__m128 dist0 = plane_coeffs[p][3];
+				__m128 dist1 = plane_coeffs[p][3];
+				for (int k = 0; k < 3; ++ k)
+				{
+					__m128 const v0 = plane_negs[p][k] ? b[k] : b[k + 3];
+					__m128 const v1 = plane_negs[p][k] ? b[k + 3] : b[k];
+					dist0 = _mm_add_ps(dist0, _mm_mul_ps(plane_coeffs[p][k], v0));
+					dist1 = _mm_add_ps(dist1, _mm_mul_ps(plane_coeffs[p][k], v1));
+				}
+				outside = _mm_or_ps(outside, _mm_cmplt_ps(dist0, zero));
+				intersect = _mm_or_ps(intersect, _mm_cmplt_ps(dist1, zero));
+			}
+
+			StoreOverlaps(results + i, _mm_movemask_ps(outside), _mm_movemask_ps(intersect), num_lanes);
+		}
+	}
+
+	// spheres are center x/y/z and radius
+	void IntersectSpheresFrustumSSE(BoundOverlap* results, float const * const spheres[4], size_t num,
+		Frustum const & frustum)
+	{
+		__m128 plane_coeffs[6][4];
+		for (int p = 0; p < 6; ++ p)
+		{
+			Plane const & plane = frustum.FrustumPlane(p);
+			for (int k = 0; k < 4; ++ k)
+			{
+				plane_coeffs[p][k] = _mm_set1_ps(plane[k]);
+			}
+		}
+
+		__m128 const zero = _mm_setzero_ps();
+		for (size_t i = 0; i < num; i += 4)
+		{
+			uint32_t const num_lanes = static_cast<uint32_t>(std::min<size_t>(num - i, 4));
+
+			__m128 s[4];
+			for (int j = 0; j < 4; ++ j)
+			{
+				if (4 == num_lanes)
+				{
+					s[j] = _mm_loadu_ps(spheres[j] + i);
+				}
+				else
+				{
+					float tail[4] = { 0, 0, 0, 0 };
+					std::copy(spheres[j] + i, spheres[j] + i + num_lanes, tail);
+					s[j] = _mm_loadu_ps(tail);
+				}
+			}
+			__m128 const neg_radius = _mm_sub_ps(zero, s[3]);
+
+			__m128 outside = zero;
+			__m128 intersect = zero;
+			for (int p = 0; p < 6; ++ p)
+			{
+				__m128 const dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(plane_coeffs[p][0], s[0]),
+					_mm_mul_ps(plane_coeffs[p][1], s[1])),
+					_mm_add_ps(_mm_mul_ps(plane_coeffs[p][2], s[2]), plane_coeffs[p][3]));
+				outside = _mm_or_ps(outside, _mm_cmple_ps(dist, neg_radius));
+				intersect = _mm_or_ps(intersect, _mm_cmplt_ps(dist, s[3]));
+			}
+
+			StoreOverlaps(results + i, _mm_movemask_ps(outside), _mm_movemask_ps(intersect), num_lanes);
+		}
+	}
+
+	void LoadAffineRows(__m128 rows[4], __m128 abs_rows[3], float4x4 const & mat)
+	{
+		__m128 const zero = _mm_setzero_ps();
+		for (int i = 0; i < 4; ++ i)
+		{
+			rows[i] = _mm_loadu_ps(&mat(i, 0));
+		}
+		for (int i = 0; i < 3; ++ i)
+		{
+			abs_rows[i] = _mm_max_ps(rows[i], _mm_sub_ps(zero, rows[i]));
+		}
+	}
+
+	// Transforms the center, and projects the half size onto each axis with the absolute matrix
+	AABBox TransformAABBSSE(float3 const & center, float3 const & half_size, __m128 const rows[4],
+		__m128 const abs_rows[3])
+	{
+		__m128 const c = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(center.x()), rows[0]),
+			_mm_mul_ps(_mm_set1_ps(center.y()), rows[1])),
+			_mm_add_ps(_mm_mul_ps(_mm_set1_ps(center.z()), rows[2]), rows[3]));
+		__m128 const e = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(half_size.x()), abs_rows[0]),
+			_mm_mul_ps(_mm_set1_ps(half_size.y()), abs_rows[1])),
+			_mm_mul_ps(_mm_set1_ps(half_size.z()), abs_rows[2]));
+
+		float min_pt[4];
+		float max_pt[4];
+		_mm_storeu_ps(min_pt, _mm_sub_ps(c, e));
+		_mm_storeu_ps(max_pt, _mm_add_ps(c, e));
+		return AABBox(float3(min_pt[0], min_pt[1], min_pt[2]), float3(max_pt[0], max_pt[1], max_pt[2]));
+	}
+
+	__m128 MultiplyQuatSSE(__m128 const & lhs, __m128 const & rhs)
+	{
+		// Same terms as MathLib::mul, grouped by the component of lhs
+		__m128 const signs_x = _mm_setr_ps(0.0f, 0.0f, -0.0f, -0.0f);
+		__m128 const signs_y = _mm_setr_ps(-0.0f, 0.0f, 0.0f, -0.0f);
+		__m128 const signs_z = _mm_setr_ps(0.0f, -0.0f, 0.0f, -0.0f);
+
+		__m128 const term_x = _mm_mul_ps(_mm_shuffle_ps(lhs, lhs, _MM_SHUFFLE(0, 0, 0, 0)),
+			_mm_xor_ps(_mm_shuffle_ps(rhs, rhs, _MM_SHUFFLE(0, 1, 2, 3)), signs_x));
+		__m128 const term_y = _mm_mul_ps(_mm_shuffle_ps(lhs, lhs, _MM_SHUFFLE(1, 1, 1, 1)),
+			_mm_xor_ps(_mm_shuffle_ps(rhs, rhs, _MM_SHUFFLE(1, 0, 3, 2)), signs_y));
+		__m128 const term_z = _mm_mul_ps(_mm_shuffle_ps(lhs, lhs, _MM_SHUFFLE(2, 2, 2, 2)),
+			_mm_xor_ps(_mm_shuffle_ps(rhs, rhs, _MM_SHUFFLE(2, 3, 0, 1)), signs_z));
+		__m128 const term_w = _mm_mul_ps(_mm_shuffle_ps(lhs, lhs, _MM_SHUFFLE(3, 3, 3, 3)), rhs);
+		return _mm_add_ps(_mm_add_ps(term_x, term_y), _mm_add_ps(term_z, term_w));
+	}
+
+	__m128 Dot4SSE(__m128 const & lhs, __m128 const & rhs)
+	{
+		__m128 const m = _mm_mul_ps(lhs, rhs);
+		__m128 const s = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+		return _mm_add_ps(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 0, 3, 2)));
+	}
+#else
+	AABBox TransformAABBGeneral(float3 const & center, float3 const & half_size, float4x4 const & mat)
+	{
+		float3 c, e;
+		for (int i = 0; i < 3; ++ i)
+		{
+			c[i] = center.x() * mat(0, i) + center.y() * mat(1, i) + center.z() * mat(2, i) + mat(3, i);
+			e[i] = half_size.x() * std::abs(mat(0, i)) + half_size.y() * std::abs(mat(1, i))
+				+ half_size.z() * std::abs(mat(2, i));
+		}
+		return AABBox(c - e, c + e);
+	}
+#endif
+
+#if defined(SIMD_MATH_AVX_DISPATCH)
+	bool HasAVX()
+	{
+		static bool const has_avx = CPUInfo().IsFeatureSupport(CPUInfo::CF_AVX);
+		return has_avx;
+	}
+
+	SIMD_MATH_AVX_FUNC void IntersectAABBsFrustumAVX(BoundOverlap* results, float const * const bounds[6], size_t num,
+		Frustum const & frustum)
+	{
+		__m256 plane_coeffs[6][4];
+		bool plane_negs[6][3];
+		for (int p = 0; p < 6; ++ p)
+		{
+			Plane const & plane = frustum.FrustumPlane(p);
+			for (int k = 0; k < 4; ++ k)
+			{
+				plane_coeffs[p][k] = _mm256_set1_ps(plane[k]);
+			}
+			for (int k = 0; k < 3; ++ k)
+			{
+				plane_negs[p][k] = plane[k] < 0;
+			}
+		}
+
+		__m256 const zero = _mm256_setzero_ps();
+		for (size_t i = 0; i < num; i += 8)
+		{
+			uint32_t const num_lanes = static_cast<uint32_t>(std::min<size_t>(num - i, 8));
+
+			__m256 b[6];
+			for (int j = 0; j < 6; ++ j)
+			{
+				if (8 == num_lanes)
+				{
+					b[j] = _mm256_loadu_ps(bounds[j] + i);
+				}
+				else
+				{
+					float tail[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+					std::copy(bounds[j] + i, bounds[j] + i + num_lanes, tail);
+					b[j] = _mm256_loadu_ps(tail);
+				}
+			}
+
+			__m256 outside = zero;
+			__m256 intersect = zero;
+			for (int p = 0; p < 6; ++ p)
+			{
+				__m256 dist0 = plane_coeffs[p][3];
+				__m256 dist1 = plane_coeffs[p][3];
+				for (int k = 0; k < 3; ++ k)
+				{
+					__m256 const v0 = plane_negs[p][k] ? b[k] : b[k + 3];
+					__m256 const v1 = plane_negs[p][k] ? b[k + 3] : b[k];
+					dist0 = _mm256_add_ps(dist0, _mm256_mul_ps(plane_coeffs[p][k], v0));
+					dist1 = _mm256_add_ps(dist1, _mm256_mul_ps(plane_coeffs[p][k], v1));
+				}
+				outside = _mm256_or_ps(outside, _mm256_cmp_ps(dist0, zero, _CMP_LT_OQ));
+				intersect = _mm256_or_ps(intersect, _mm256_cmp_ps(dist1, zero, _CMP_LT_OQ));
+			}
+
+			StoreOverlaps(results + i, _mm256_movemask_ps(outside), _mm256_movemask_ps(intersect), num_lanes);
+		}
+	}
+
+	SIMD_MATH_AVX_FUNC void IntersectSpheresFrustumAVX(BoundOverlap* results, float const * const spheres[4], size_t num,
+		Frustum const & frustum)
+	{
+		__m256 plane_coeffs[6][4];
+		for (int p = 0; p < 6; ++ p)
+		{
+			Plane const & plane = frustum.FrustumPlane(p);
+			for (int k = 0; k < 4; ++ k)
+			{
+				plane_coeffs[p][k] = _mm256_set1_ps(plane[k]);
+			}
+		}
+
+		__m256 const zero = _mm256_setzero_ps();
+		for (size_t i = 0; i < num; i += 8)
+		{
+			uint32_t const num_lanes = static_cast<uint32_t>(std::min<size_t>(num - i, 8));
+
+			__m256 s[4];
+			for (int j = 0; j < 4; ++ j)
+			{
+				if (8 == num_lanes)
+				{
+					s[j] = _mm256_loadu_ps(spheres[j] + i);
+				}
+				else
+				{
+					float tail[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+					std::copy(spheres[j] + i, spheres[j] + i + num_lanes, tail);
+					s[j] = _mm256_loadu_ps(tail);
+				}
+			}
+			__m256 const neg_radius = _mm256_sub_ps(zero, s[3]);
+
+			__m256 outside = zero;
+			__m256 intersect = zero;
+			for (int p = 0; p < 6; ++ p)
+			{
+				__m256 const dist = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(plane_coeffs[p][0], s[0]),
+					_mm256_mul_ps(plane_coeffs[p][1], s[1])),
+					_mm256_add_ps(_mm256_mul_ps(plane_coeffs[p][2], s[2]), plane_coeffs[p][3]));
+				outside = _mm256_or_ps(outside, _mm256_cmp_ps(dist, neg_radius, _CMP_LE_OQ));
+				intersect = _mm256_or_ps(intersect, _mm256_cmp_ps(dist, s[3], _CMP_LT_OQ));
+			}
+
+			StoreOverlaps(results + i, _mm256_movemask_ps(outside), _mm256_movemask_ps(intersect), num_lanes);
+		}
+	}
+#endif
+}
+
+
 namespace KlayGE
 {
 	namespace SIMDMathLib
@@ -341,6 +678,11 @@ namespace KlayGE
 
 		void StoreVector4(float4& fs, SIMDVectorF4 const & v)
 		{
+			StoreVector4(&fs[0], v);
+		}
+
+		void StoreVector4(float* fs, SIMDVectorF4 const & v)
+		{
 #if defined(SIMD_MATH_SSE)
 			_mm_store_ps(&fs[0], v.Vec());
 #else
@@ -2169,5 +2511,181 @@ namespace KlayGE
 		{
 			return lhs * rhs;
 		}
+
+		// Batch
+		///////////////////////////////////////////////////////////////////////////////
+		void IntersectAABBsFrustum(BoundOverlap* results, float const * min_x, float const * min_y, float const * min_z,
+			float const * max_x, float const * max_y, float const * max_z, size_t num, Frustum const & frustum)
+		{
+			float const * const bounds[] = { min_x, min_y, min_z, max_x, max_y, max_z };
+#if defined(SIMD_MATH_AVX_DISPATCH)
+			if (HasAVX())
+			{
+				IntersectAABBsFrustumAVX(results, bounds, num, frustum);
+				return;
+			}
+#endif
+
+#if defined(SIMD_MATH_SSE)
+			IntersectAABBsFrustumSSE(results, bounds, num, frustum);
+#else
+			for (size_t i = 0; i < num; ++ i)
+			{
+				results[i] = MathLib::intersect_aabb_frustum(AABBox(float3(bounds[0][i], bounds[1][i], bounds[2][i]),
+					float3(bounds[3][i], bounds[4][i], bounds[5][i])), frustum);
+			}
+#endif
+		}
+
+		void IntersectSpheresFrustum(BoundOverlap* results, float const * center_x, float const * center_y,
+			float const * center_z, float const * radius, size_t num, Frustum const & frustum)
+		{
+			float const * const spheres[] = { center_x, center_y, center_z, radius };
+#if defined(SIMD_MATH_AVX_DISPATCH)
+			if (HasAVX())
+			{
+				IntersectSpheresFrustumAVX(results, spheres, num, frustum);
+				return;
+			}
+#endif
+
+#if defined(SIMD_MATH_SSE)
+			IntersectSpheresFrustumSSE(results, spheres, num, frustum);
+#else
+			for (size_t i = 0; i < num; ++ i)
+			{
+				results[i] = MathLib::intersect_sphere_frustum(Sphere(float3(spheres[0][i], spheres[1][i], spheres[2][i]),
+					spheres[3][i]), frustum);
+			}
+#endif
+		}
+
+		void TransformAABBs(AABBox* results, AABBox const * aabbs, float4x4 const & mat, size_t num)
+		{
+#if defined(SIMD_MATH_SSE)
+			__m128 rows[4];
+			__m128 abs_rows[3];
+			LoadAffineRows(rows, abs_rows, mat);
+			for (size_t i = 0; i < num; ++ i)
+			{
+				results[i] = TransformAABBSSE(aabbs[i].Center(), aabbs[i].HalfSize(), rows, abs_rows);
+			}
+#else
+			for (size_t i = 0; i < num; ++ i)
+			{
+				results[i] = TransformAABBGeneral(aabbs[i].Center(), aabbs[i].HalfSize(), mat);
+			}
+#endif
+		}
+
+		void TransformAABBs(AABBox* results, AABBox const & aabb, float4x4 const * mats, size_t num)
+		{
+			float3 const center = aabb.Center();
+			float3 const half_size = aabb.HalfSize();
+			for (size_t i = 0; i < num; ++ i)
+			{
+#if defined(SIMD_MATH_SSE)
+				__m128 rows[4];
+				__m128 abs_rows[3];
+				LoadAffineRows(rows, abs_rows, mats[i]);
+				results[i] = TransformAABBSSE(center, half_size, rows, abs_rows);
+#else
+				results[i] = TransformAABBGeneral(center, half_size, mats[i]);
+#endif
+			}
+		}
+
+		void MultiplyMatrices(float4x4* results, float4x4 const * lhs, float4x4 const & rhs, size_t num)
+		{
+#if defined(SIMD_MATH_SSE)
+			__m128 rhs_rows[4];
+			for (int i = 0; i < 4; ++ i)
+			{
+				rhs_rows[i] = _mm_loadu_ps(&rhs(i, 0));
+			}
+
+			for (size_t n = 0; n < num; ++ n)
+			{
+				float const * l = &lhs[n](0, 0);
+				__m128 rows[4];
+				for (int i = 0; i < 4; ++ i)
+				{
+					rows[i] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(l[i * 4 + 0]), rhs_rows[0]),
+						_mm_mul_ps(_mm_set1_ps(l[i * 4 + 1]), rhs_rows[1])),
+						_mm_add_ps(_mm_mul_ps(_mm_set1_ps(l[i * 4 + 2]), rhs_rows[2]),
+							_mm_mul_ps(_mm_set1_ps(l[i * 4 + 3]), rhs_rows[3])));
+				}
+				for (int i = 0; i < 4; ++ i)
+				{
+					_mm_storeu_ps(&results[n](i, 0), rows[i]);
+				}
+			}
+#else
+			for (size_t n = 0; n < num; ++ n)
+			{
+				results[n] = lhs[n] * rhs;
+			}
+#endif
+		}
+
+		void MultiplyDualQuaternions(Quaternion* results_real, Quaternion* results_dual,
+			Quaternion const * lhs_reals, Quaternion const * lhs_duals, Quaternion const * rhs_reals, Quaternion const * rhs_duals,
+			size_t num)
+		{
+			for (size_t i = 0; i < num; ++ i)
+			{
+#if defined(SIMD_MATH_SSE)
+				__m128 const lhs_real = _mm_loadu_ps(&lhs_reals[i][0]);
+				__m128 const lhs_dual = _mm_loadu_ps(&lhs_duals[i][0]);
+				__m128 const rhs_real = _mm_loadu_ps(&rhs_reals[i][0]);
+				__m128 const rhs_dual = _mm_loadu_ps(&rhs_duals[i][0]);
+				_mm_storeu_ps(&results_real[i][0], MultiplyQuatSSE(lhs_real, rhs_real));
+				_mm_storeu_ps(&results_dual[i][0], _mm_add_ps(MultiplyQuatSSE(lhs_real, rhs_dual),
+					MultiplyQuatSSE(lhs_dual, rhs_real)));
+#else
+				Quaternion const real = MathLib::mul_real(lhs_reals[i], rhs_reals[i]);
+				results_dual[i] = MathLib::mul_dual(lhs_reals[i], lhs_duals[i], rhs_reals[i], rhs_duals[i]);
+				results_real[i] = real;
+#endif
+			}
+		}
+
+		void BlendDualQuaternions(Quaternion* results_real, Quaternion* results_dual,
+			Quaternion const * reals0, Quaternion const * duals0, Quaternion const * reals1, Quaternion const * duals1,
+			float const * factors, size_t num)
+		{
+#if defined(SIMD_MATH_SSE)
+			__m128 const one = _mm_set1_ps(1);
+			__m128 const sign_mask = _mm_set1_ps(-0.0f);
+			for (size_t i = 0; i < num; ++ i)
+			{
+				__m128 const r0 = _mm_loadu_ps(&reals0[i][0]);
+				__m128 const d0 = _mm_loadu_ps(&duals0[i][0]);
+				__m128 const r1 = _mm_loadu_ps(&reals1[i][0]);
+				__m128 const d1 = _mm_loadu_ps(&duals1[i][0]);
+				__m128 const f = _mm_set1_ps(factors[i]);
+
+				// Takes the shorter path by flipping the sign of the second weight
+				__m128 const w0 = _mm_sub_ps(one, f);
+				__m128 const w1 = _mm_xor_ps(f, _mm_and_ps(Dot4SSE(r0, r1), sign_mask));
+				__m128 const real = _mm_add_ps(_mm_mul_ps(w0, r0), _mm_mul_ps(w1, r1));
+				__m128 const dual = _mm_add_ps(_mm_mul_ps(w0, d0), _mm_mul_ps(w1, d1));
+				__m128 const len = _mm_sqrt_ps(Dot4SSE(real, real));
+				_mm_storeu_ps(&results_real[i][0], _mm_div_ps(real, len));
+				_mm_storeu_ps(&results_dual[i][0], _mm_div_ps(dual, len));
+			}
+#else
+			for (size_t i = 0; i < num; ++ i)
+			{
+				float const w0 = 1 - factors[i];
+				float const w1 = (MathLib::dot(reals0[i], reals1[i]) < 0) ? -factors[i] : factors[i];
+				Quaternion const real = reals0[i] * w0 + reals1[i] * w1;
+				Quaternion const dual = duals0[i] * w0 + duals1[i] * w1;
+				float const inv_len = 1 / std::sqrt(MathLib::length_sq(real));
+				results_real[i] = real * inv_len;
+				results_dual[i] = dual * inv_len;
+			}
+#endif
+		}
 	}
 }
@@ -119,6 +119,8 @@ namespace KlayGE
 		void UpdateStats();
 
 	private:
+		void HeadlessRun();
+
 		virtual void OnCreate()
 		{
 		}
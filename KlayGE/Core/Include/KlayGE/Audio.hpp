@@ -35,8 +35,15 @@
 
 #include <KlayGE/PreDeclare.hpp>
 #include <KFL/Vector.hpp>
+#include <KFL/Thread.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <map>
+#include <mutex>
+#include <vector>
 
 #include <KlayGE/AudioDataSource.hpp>
 
@@ -92,6 +99,8 @@ namespace KlayGE
 
 	class KLAYGE_CORE_API MusicBuffer : public AudioBuffer
 	{
+		friend class AudioStreamingService;
+
 	public:
 		explicit MusicBuffer(AudioDataSourcePtr const & data_source);
 		~MusicBuffer() override;
@@ -102,12 +111,85 @@ namespace KlayGE
 
 		bool IsSound() const override;
 
+		uint32_t NumUnderruns() const;
+
 	protected:
 		virtual void DoReset() = 0;
 		virtual void DoPlay(bool loop) = 0;
 		virtual void DoStop() = 0;
 
+		// Called by the streaming service, from its workers while the stream is playing
+		virtual uint32_t FreeRefillSlots() = 0;
+		virtual bool Starved() = 0;
+		virtual void SubmitRefill(uint8_t const * data, uint32_t size) = 0;
+		virtual void EndOfStream() = 0;
+		// Called after each round of refills. Devices that stop by themselves when they run dry restart here.
+		virtual void ResumeIfStarved();
+
 		static uint32_t constexpr BUFFERS_PER_SECOND = 2;
+
+		bool loop_;
+		uint32_t refill_size_;
+
+	private:
+		// Set while a stream is registered. Cleared under the service's lock when the stream is dropped.
+		std::atomic<AudioStreamingService*> streaming_service_;
+		std::atomic<uint32_t> num_underruns_;
+	};
+
+	// Decodes every playing MusicBuffer on a small set of shared workers. Each stream is kept decoded
+	// PrefetchTime() seconds ahead of what its device queue holds, using pooled refill buffers.
+	class KLAYGE_CORE_API AudioStreamingService : boost::noncopyable
+	{
+	public:
+		explicit AudioStreamingService(uint32_t num_workers = 2);
+		~AudioStreamingService();
+
+		// Primes the device queue of the buffer on the calling thread, then hands it over to the workers
+		void AddStream(MusicBuffer& buffer);
+		// Blocks until no worker is touching the buffer any more. Returns false if the stream had already finished.
+		bool RemoveStream(MusicBuffer& buffer);
+		size_t NumStreams() const;
+
+		void PrefetchTime(float seconds);
+		float PrefetchTime() const;
+
+		uint32_t NumUnderruns() const;
+
+	private:
+		struct Stream
+		{
+			MusicBuffer* buffer;
+			std::deque<std::vector<uint8_t>> prefetched;
+			uint32_t prefetched_bytes;
+			bool end_of_stream;
+			bool busy;
+			std::chrono::steady_clock::time_point next_service;
+		};
+
+		void WorkerLoop();
+		bool ServiceStream(Stream& stream, bool prime);
+		void DecodeRefill(Stream& stream);
+		void ReleaseStream(Stream& stream);
+
+		std::vector<uint8_t> AllocRefillBuffer(uint32_t size);
+		void FreeRefillBuffer(std::vector<uint8_t>&& buff);
+
+	private:
+		uint32_t const num_workers_;
+		std::vector<joiner<void>> workers_;
+		bool quit_;
+
+		std::vector<std::unique_ptr<Stream>> streams_;
+		mutable std::mutex streams_mutex_;
+		std::condition_variable work_cond_;
+		std::condition_variable idle_cond_;
+
+		std::vector<std::vector<uint8_t>> refill_pool_;
+		std::mutex refill_pool_mutex_;
+
+		std::atomic<float> prefetch_time_;
+		std::atomic<uint32_t> num_underruns_;
 	};
 
 	class KLAYGE_CORE_API AudioEngine : boost::noncopyable
@@ -121,6 +203,8 @@ namespace KlayGE
 
 		virtual std::wstring const & Name() const = 0;
 
+		AudioStreamingService& StreamingService();
+
 		virtual void AddBuffer(size_t id, AudioBufferPtr const & buffer);
 
 		size_t NumBuffer() const;
@@ -148,6 +232,9 @@ namespace KlayGE
 		virtual void DoResume() = 0;
 
 	protected:
+		// Declared first so it outlives the buffers it streams
+		std::unique_ptr<AudioStreamingService> streaming_service_;
+
 		std::map<size_t, AudioBufferPtr> audio_buffs_;
 
 		float sound_vol_;
@@ -57,6 +57,14 @@ namespace KlayGE
 
 		bool perf_profiler;
 		bool location_sensor;
+
+		// Run without a window through NullRender, for a fixed number of frames, and dump the profile at exit.
+		// With headless_fixed_rate, frames are paced to headless_frame_time in real time instead of back to back.
+		bool headless;
+		uint32_t headless_frames;
+		float headless_frame_time;
+		bool headless_fixed_rate;
+		std::string headless_report;
 	};
 
 	class KLAYGE_CORE_API Context : boost::noncopyable
@@ -158,6 +166,11 @@ namespace KlayGE
 			return *gtp_instance_;
 		}
 
+		task_scheduler& TaskScheduler()
+		{
+			return *gts_instance_;
+		}
+
 	private:
 		void DestroyAll();
 
@@ -191,6 +204,7 @@ namespace KlayGE
 		DllLoader ads_loader_;
 
 		std::unique_ptr<thread_pool> gtp_instance_;
+		std::unique_ptr<task_scheduler> gts_instance_;
 	};
 }
 
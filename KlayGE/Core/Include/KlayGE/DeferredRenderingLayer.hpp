@@ -350,7 +350,7 @@ namespace KlayGE
 		void BuildLightList();
 		void BuildVisibleSceneObjList(bool& has_opaque_objs, bool& has_transparency_back_objs, bool& has_transparency_front_objs);
 		void BuildPassScanList(bool has_opaque_objs, bool has_transparency_back_objs, bool has_transparency_front_objs);
-		void CheckLightVisible(uint32_t vp_index, uint32_t light_index);
+		void CheckLightsVisible(uint32_t vp_index);
 		void AppendGBufferPassScanCode(uint32_t vp_index, PassTargetBuffer pass_tb);
 		void AppendShadowPassScanCode(uint32_t light_index);
 		void AppendCascadedShadowPassScanCode(uint32_t vp_index, uint32_t light_index);
@@ -45,6 +45,9 @@ namespace KlayGE
 
 	KLAYGE_CORE_API void ComputeDistance(std::vector<float> const & aa_2x_data, uint32_t input_width, uint32_t input_height,
 		std::vector<float>& dist_data);
+	// Distance in voxels from each voxel to the nearest non-zero one
+	KLAYGE_CORE_API void ComputeVolumeDistance(std::vector<uint8_t> const & volume, uint32_t width, uint32_t height,
+		uint32_t depth, std::vector<float>& dist_data);
 }
 
 #endif		// _KLAYGE_DISTANCE_FIELD_HPP
@@ -117,6 +117,7 @@ namespace KlayGE
 
 		virtual void CreateHWResource(void const * init_data) = 0;
 		virtual void DeleteHWResource() = 0;
+		virtual bool HWResourceReady() const = 0;
 
 		virtual void UpdateSubresource(uint32_t offset, uint32_t size, void const * data) = 0;
 
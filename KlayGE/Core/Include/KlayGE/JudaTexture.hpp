@@ -19,7 +19,9 @@
 #include <KlayGE/Texture.hpp>
 #include <KlayGE/RenderStateObject.hpp>
 #include <KlayGE/TexCompressionBC.hpp>
+#include <KFL/Thread.hpp>
 
+#include <array>
 #include <vector>
 #include <deque>
 #include <unordered_map>
@@ -62,8 +64,11 @@ namespace KlayGE
 
 		static uint32_t const LEVEL_SHIFT = 28;
 
+		static uint32_t const INVALID_SLOT = 0xFFFFFFFFU;
+
 	public:
 		JudaTexture(uint32_t num_tiles, uint32_t tile_size, ElementFormat format);
+		~JudaTexture();
 
 		uint32_t EncodeTileID(uint32_t level, uint32_t tile_x, uint32_t tile_y) const;
 		void DecodeTileID(uint32_t& level, uint32_t& tile_x, uint32_t& tile_y, uint32_t tile_id) const;
@@ -88,9 +93,30 @@ namespace KlayGE
 
 		void SetParams(RenderEffect const & effect);
 
+		// Makes all tiles resident before returning
 		void UpdateCache(std::vector<uint32_t> const & tile_ids);
+		// Returns without waiting. Missing tiles are decoded on worker threads and uploaded by later calls. Until then they are
+		//  drawn from a coarser resident level.
+		void ASyncUpdateCache(std::vector<uint32_t> const & tile_ids);
 
 	private:
+		struct TileRequest
+		{
+			// Corner tile of the requested area, and the area is (1 << level_delta) tiles wide
+			uint32_t tile_id;
+			uint32_t level_delta;
+			uint64_t tick;
+			bool in_flight;
+		};
+
+		struct CacheTileData
+		{
+			uint32_t shuff;
+			std::vector<std::vector<uint8_t>> mips;
+			std::vector<uint32_t> row_pitches;
+		};
+
+		void DecodeShuffs(std::vector<std::vector<uint8_t>>& data, std::vector<std::pair<uint32_t, uint32_t>>& shuffs, uint32_t mipmaps);
 		void DecodeATile(std::vector<uint8_t>* data, uint32_t shuff, uint32_t mipmaps);
 		uint32_t DecodeAAttr(uint32_t shuff);
 		uint8_t* RetriveATile(uint32_t data_index);
@@ -117,6 +143,23 @@ namespace KlayGE
 		uint32_t AllocateDataBlock();
 		void DeallocateDataBlock(uint32_t index);
 
+		uint32_t RequestShuff(TileRequest const & request) const;
+		uint32_t TileNeighbors(std::array<uint32_t, 9>& neighbor_shuffs, std::array<bool, 9>& in_same_image,
+			TileRequest const & request);
+		void BuildCacheTiles(std::vector<CacheTileData>& cache_tiles, std::vector<TileRequest> const & requests);
+		void BuildCacheTile(CacheTileData& cache_tile, uint32_t attr, std::array<uint32_t, 9> const & index_with_neighbors,
+			std::array<bool, 9> const & in_same_image, std::vector<std::vector<uint8_t>> const & neighbor_data,
+			TexCompression* codec);
+		bool UploadCacheTile(CacheTileData const & cache_tile, bool evict_in_use);
+		void RequestTiles(std::vector<uint32_t> const & tile_ids);
+		void CollectStreamedTiles();
+		void DispatchStreaming();
+		void WriteIndirect(uint32_t tile_id, uint32_t slot, uint32_t level_delta);
+
+		void UnlinkSlot(uint32_t s);
+		void LinkSlotToFront(uint32_t s);
+		void MoveSlotToFront(uint32_t s);
+
 	private:
 		quadtree_node_ptr root_;
 
@@ -192,15 +235,30 @@ namespace KlayGE
 		uint32_t cache_tile_size_;
 		std::unique_ptr<TexCompression> tex_codec_;
 
-		struct TileInfo
+		// Residency of cache slots, most recently used first
+		struct CacheSlot
 		{
-			uint32_t x, y, z;
-			uint32_t attr;
+			uint32_t shuff;
 			uint64_t tick;
+			uint32_t prev;
+			uint32_t next;
 		};
-		std::unordered_map<uint32_t, TileInfo> tile_info_map_;
-		std::deque<std::pair<uint32_t, uint32_t>> tile_free_list_;
+		std::vector<CacheSlot> cache_slots_;
+		uint32_t num_used_cache_slots_;
+		uint32_t lru_head_;
+		uint32_t lru_tail_;
+		uint32_t num_cache_tiles_a_row_;
+		uint32_t num_cache_tiles_a_layer_;
+		std::unordered_map<uint32_t, uint32_t> resident_tiles_;
+		std::unordered_map<uint32_t, uint32_t> indirect_entries_;
 		uint64_t tile_tick_;
+
+	private:
+		// Streaming. Requests are keyed by shuff, and the ones in flight are owned by the streaming task.
+		std::unordered_map<uint32_t, TileRequest> tile_requests_;
+		std::vector<TileRequest> streaming_requests_;
+		std::vector<CacheTileData> streamed_tiles_;
+		std::unique_ptr<task_group> streaming_tasks_;
 	};
 }
 
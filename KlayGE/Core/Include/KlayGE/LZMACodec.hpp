@@ -53,6 +53,20 @@ namespace KlayGE
 		void Decode(std::vector<uint8_t>& output, ResIdentifierPtr const & res, uint64_t len, uint64_t original_len);
 		void Decode(std::vector<uint8_t>& output, void const * input, uint64_t len, uint64_t original_len);
 		void Decode(void* output, void const * input, uint64_t len, uint64_t original_len);
+
+		// Chunked container: the input is split into independently compressed blocks with a block index in front,
+		//  so that blocks can be encoded/decoded in parallel and a sub-range can be decoded without touching the rest.
+		static uint32_t const DEFAULT_CHUNK_SIZE = 1UL << 20;
+
+		void EncodeChunked(std::vector<uint8_t>& output, void const * input, uint64_t len,
+			uint32_t chunk_size = DEFAULT_CHUNK_SIZE);
+		uint64_t EncodeChunked(std::ostream& os, void const * input, uint64_t len, uint32_t chunk_size = DEFAULT_CHUNK_SIZE);
+
+		uint64_t ChunkedOriginalLength(void const * input, uint64_t len);
+		void DecodeChunked(std::vector<uint8_t>& output, ResIdentifierPtr const & res, uint64_t len);
+		void DecodeChunked(std::vector<uint8_t>& output, void const * input, uint64_t len);
+		void DecodeChunked(void* output, void const * input, uint64_t len);
+		void DecodeChunkedRange(void* output, void const * input, uint64_t len, uint64_t offset, uint64_t size);
 	};
 }
 
@@ -31,6 +31,8 @@
 #include <KlayGE/Renderable.hpp>
 #include <KlayGE/RenderLayout.hpp>
 #include <KFL/Math.hpp>
+#include <KFL/Half.hpp>
+#include <KFL/ArrayRef.hpp>
 #include <KlayGE/SceneObject.hpp>
 
 #include <vector>
@@ -276,6 +278,10 @@ namespace KlayGE
 		std::vector<float> bind_scale;
 
 		std::pair<std::pair<Quaternion, Quaternion>, float> Frame(float frame) const;
+
+		// Finds the keys around frame and returns the factor between them. cursor is the key found last time. During
+		//  playback it is usually still right, or one key behind.
+		float FrameKeys(float frame, uint32_t& cursor, uint32_t& index0, uint32_t& index1) const;
 	};
 	typedef std::vector<KeyFrames> KeyFramesType;
 
@@ -296,6 +302,69 @@ namespace KlayGE
 	};
 	typedef std::vector<AnimationAction> AnimationActionsType;
 
+	// Key frames of all joints in [start_frame, end_frame), quantized into flat arrays. Rotations are 16-bit normalized
+	//  quaternions, translations 16-bit steps over the range of their track, and scales half floats. SkinnedModel
+	//  samples the keys in place. A model has one clip per action, so clips can be attached and dropped one by one.
+	class KLAYGE_CORE_API AnimationClip
+	{
+	public:
+		AnimationClip();
+		AnimationClip(KeyFramesType const & kfs, uint32_t start_frame, uint32_t end_frame);
+
+		uint32_t StartFrame() const
+		{
+			return start_frame_;
+		}
+		uint32_t EndFrame() const
+		{
+			return end_frame_;
+		}
+		uint32_t NumTracks() const
+		{
+			return static_cast<uint32_t>(tracks_.size());
+		}
+		uint32_t NumKeys(uint32_t track) const
+		{
+			return tracks_[track].num_keys;
+		}
+		uint32_t KeyFrameId(uint32_t track, uint32_t index) const
+		{
+			return frame_ids_[tracks_[track].first_key + index];
+		}
+
+		// Same as KeyFrames::FrameKeys, but frames out of the clip are clamped to its first or last key
+		float FrameKeys(uint32_t track, float frame, uint32_t& cursor, uint32_t& index0, uint32_t& index1) const;
+		void DecodeKey(uint32_t track, uint32_t index, Quaternion& real, Quaternion& dual, float& scale) const;
+
+		// Decodes the keys back to KeyFrames, after the keys already in kfs
+		void AppendKeyFrames(KeyFramesType& kfs) const;
+
+		void Read(ResIdentifier& res);
+		void Write(std::ostream& os) const;
+
+	private:
+		struct Track
+		{
+			uint32_t first_key;
+			uint32_t num_keys;
+			float3 trans_min;
+			float3 trans_step;
+		};
+
+		struct Key
+		{
+			int16_t real[4];
+			uint16_t trans[3];
+			half scale;
+		};
+
+		uint32_t start_frame_;
+		uint32_t end_frame_;
+		std::vector<Track> tracks_;
+		std::vector<uint32_t> frame_ids_;
+		std::vector<Key> keys_;
+	};
+
 	class KLAYGE_CORE_API SkinnedModel : public RenderModel
 	{
 	public:
@@ -340,14 +409,20 @@ namespace KlayGE
 		{
 			return bind_duals_;
 		}
-		void AttachKeyFrames(std::shared_ptr<KeyFramesType> const & kf)
-		{
-			key_frames_ = kf;
-		}
-		std::shared_ptr<KeyFramesType> const & GetKeyFrames() const
+		// Compresses the key frames into one clip per action. Actions and the number of frames should be set first.
+		void AttachKeyFrames(std::shared_ptr<KeyFramesType> const & kf);
+		// Decodes the attached clips. Meant for tools, the model itself samples the clips.
+		std::shared_ptr<KeyFramesType> GetKeyFrames() const;
+
+		// Clips are indexed by action. A clip can be attached later than the others, or dropped, when it's streamed.
+		//  Frames of an action without a clip keep the last pose.
+		void AttachAnimationClips(std::vector<AnimationClipPtr> const & clips);
+		void AttachAnimationClip(uint32_t action, AnimationClipPtr const & clip);
+		std::vector<AnimationClipPtr> const & GetAnimationClips() const
 		{
-			return key_frames_;
+			return clips_;
 		}
+
 		uint32_t NumFrames() const
 		{
 			return num_frames_;
@@ -368,6 +443,9 @@ namespace KlayGE
 		float GetFrame() const;
 		void SetFrame(float frame);
 
+		// Sets the frames of many models on the task scheduler. A model can appear only once.
+		static void SetFrames(ArrayRef<SkinnedModel*> models, ArrayRef<float> frames);
+
 		void RebindJoints();
 		void UnbindJoints();
 
@@ -384,15 +462,24 @@ namespace KlayGE
 	protected:
 		void BuildBones(float frame);
 		void UpdateBinds();
+		void ResizeJointScratch();
+		uint32_t ActionOfFrame(float frame) const;
 
 	protected:
 		JointsType joints_;
 		RotationsType bind_reals_;
 		RotationsType bind_duals_;
 
-		std::shared_ptr<KeyFramesType> key_frames_;
+		std::vector<AnimationClipPtr> clips_;
 		float last_frame_;
 
+		// Per joint scratch for BuildBones and UpdateBinds, so evaluating a frame doesn't allocate
+		std::vector<uint32_t> key_cursors_;
+		std::vector<Quaternion> joint_reals_[2];
+		std::vector<Quaternion> joint_duals_[2];
+		std::vector<float> joint_factors_;
+		std::vector<float> joint_scales_;
+
 		uint32_t num_frames_;
 		uint32_t frame_rate_;
 
@@ -454,7 +541,7 @@ namespace KlayGE
 		std::vector<uint32_t>& mesh_num_vertices, std::vector<uint32_t>& mesh_base_vertices,
 		std::vector<uint32_t>& mesh_num_indices, std::vector<uint32_t>& mesh_base_indices,
 		std::vector<Joint>& joints, std::shared_ptr<AnimationActionsType>& actions,
-		std::shared_ptr<KeyFramesType>& kfs, uint32_t& num_frames, uint32_t& frame_rate,
+		std::vector<AnimationClipPtr>& clips, uint32_t& num_frames, uint32_t& frame_rate,
 		std::vector<std::shared_ptr<AABBKeyFrames>>& frame_pos_bbs);
 	KLAYGE_CORE_API RenderModelPtr SyncLoadModel(std::string const & meshml_name, uint32_t access_hint,
 		std::function<RenderModelPtr(std::wstring const &)> CreateModelFactoryFunc = CreateModelFactory<RenderModel>(),
@@ -36,6 +36,7 @@
 #include <KlayGE/PreDeclare.hpp>
 #include <KFL/Math.hpp>
 #include <KFL/Thread.hpp>
+#include <KFL/AlignedAllocator.hpp>
 #include <KlayGE/SceneObjectHelper.hpp>
 
 #include <vector>
@@ -55,6 +56,56 @@ namespace KlayGE
 		float init_life;
 	};
 
+	// A run of particles in the structure-of-arrays storage of a particle system. Element i of every array belongs to
+	//  particle i of the span. The arrays of a particle system start on 16-byte boundaries.
+	struct ParticleSpan
+	{
+		float* pos_x;
+		float* pos_y;
+		float* pos_z;
+		float* vel_x;
+		float* vel_y;
+		float* vel_z;
+		float* life;
+		float* spin;
+		float* size;
+		float* alpha;
+		float* init_life;
+
+		uint32_t num;
+
+		Particle Get(uint32_t i) const
+		{
+			BOOST_ASSERT(i < num);
+
+			Particle par;
+			par.pos = float3(pos_x[i], pos_y[i], pos_z[i]);
+			par.vel = float3(vel_x[i], vel_y[i], vel_z[i]);
+			par.life = life[i];
+			par.spin = spin[i];
+			par.size = size[i];
+			par.alpha = alpha[i];
+			par.init_life = init_life[i];
+			return par;
+		}
+		void Set(uint32_t i, Particle const & par) const
+		{
+			BOOST_ASSERT(i < num);
+
+			pos_x[i] = par.pos.x();
+			pos_y[i] = par.pos.y();
+			pos_z[i] = par.pos.z();
+			vel_x[i] = par.vel.x();
+			vel_y[i] = par.vel.y();
+			vel_z[i] = par.vel.z();
+			life[i] = par.life;
+			spin[i] = par.spin;
+			size[i] = par.size;
+			alpha[i] = par.alpha;
+			init_life[i] = par.init_life;
+		}
+	};
+
 	class KLAYGE_CORE_API ParticleEmitter
 	{
 	public:
@@ -216,6 +267,9 @@ namespace KlayGE
 		virtual ParticleUpdaterPtr Clone() = 0;
 
 		virtual void Update(Particle& par, float elapse_time) = 0;
+		// Updates all particles in a span. The default one calls Update on every particle. Override it to process the
+		//  arrays in batches.
+		virtual void BatchUpdate(ParticleSpan const & span, float elapse_time);
 
 	protected:
 		void DoClone(ParticleUpdaterPtr const & rhs);
@@ -290,7 +344,7 @@ namespace KlayGE
 
 		uint32_t NumParticles() const
 		{
-			return static_cast<uint32_t>(particles_.size());
+			return max_num_particles_;
 		}
 		uint32_t NumActiveParticles() const
 		{
@@ -298,17 +352,17 @@ namespace KlayGE
 		}
 		uint32_t GetActiveParticleIndex(uint32_t i) const
 		{
-			return active_particles_[i].first;
+			return active_particles_[i];
 		}
-		Particle const & GetParticle(uint32_t i) const
+		Particle GetParticle(uint32_t i) const
 		{
-			BOOST_ASSERT(i < particles_.size());
-			return particles_[i];
+			BOOST_ASSERT(i < max_num_particles_);
+			return this->MakeSpan(0, max_num_particles_).Get(i);
 		}
-		Particle& GetParticle(uint32_t i)
+		void SetParticle(uint32_t i, Particle const & par)
 		{
-			BOOST_ASSERT(i < particles_.size());
-			return particles_[i];
+			BOOST_ASSERT(i < max_num_particles_);
+			this->MakeSpan(0, max_num_particles_).Set(i, par);
 		}
 		void ClearParticles();
 
@@ -335,12 +389,29 @@ namespace KlayGE
 
 		void SceneDepthTexture(TexturePtr const & depth_tex);
 
+	protected:
+		ParticleSpan MakeSpan(uint32_t begin, uint32_t end) const;
+		void RemoveDeadParticles();
+		void EmitParticles(float elapsed_time);
+		void SortActiveParticles(float4x4 const & view_mat);
+
 	protected:
 		std::vector<ParticleEmitterPtr> emitters_;
 		std::vector<ParticleUpdaterPtr> updaters_;
 
-		std::vector<Particle> particles_;
-		std::vector<std::pair<uint32_t, float>> active_particles_;
+		// Particles are stored as a structure of arrays, one array of attrib_stride_ floats per attribute. Live
+		//  particles are packed in [0, num_alive_particles_).
+		uint32_t max_num_particles_;
+		uint32_t attrib_stride_;
+		uint32_t num_alive_particles_;
+		std::vector<float, aligned_allocator<float, 16>> particle_attribs_;
+
+		// Indices of live particles, back to front
+		std::vector<uint32_t> active_particles_;
+		std::vector<float, aligned_allocator<float, 16>> sort_depths_;
+		std::vector<uint32_t> sort_keys_;
+		std::vector<uint32_t> sort_tmp_keys_;
+		std::vector<uint32_t> sort_tmp_indices_;
 
 		float gravity_;
 		float3 force_;
@@ -417,6 +488,10 @@ namespace KlayGE
 		}
 
 		virtual void Update(Particle& par, float elapse_time) override;
+		virtual void BatchUpdate(ParticleSpan const & span, float elapse_time) override;
+
+	private:
+		void DoUpdate(Particle& par, float elapse_time);
 
 	private:
 		std::mutex update_mutex_;
@@ -36,12 +36,28 @@
 #include <KlayGE/PreDeclare.hpp>
 #include <KFL/Timer.hpp>
 
+#include <atomic>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <tuple>
+#include <vector>
 
 namespace KlayGE
 {
+	// A scoped CPU zone. Cheap enough for hot paths, one relaxed load when the profiler is off.
+	class KLAYGE_CORE_API PerfZone : boost::noncopyable
+	{
+	public:
+		// name must outlive the capture, a string literal in practice
+		explicit PerfZone(char const * name);
+		~PerfZone();
+
+	private:
+		char const * name_;
+	};
+
 	class KLAYGE_CORE_API PerfRange : boost::noncopyable
 	{
 	public:
@@ -82,13 +98,56 @@ namespace KlayGE
 
 		void ExportToCSV(std::string const & file_name) const;
 
+		// Zones, counters and frame markers are recorded per thread and only read back on export
+		static bool ZonesEnabled()
+		{
+			return zones_enabled_.load(std::memory_order_relaxed);
+		}
+		static void ZonesEnabled(bool enabled);
+
+		void BeginZone(char const * name);
+		void EndZone(char const * name);
+		void Counter(char const * name, double value);
+		void FrameMarker();
+		void ThreadName(std::string const & name);
+
+		void ExportToChromeTrace(std::string const & file_name) const;
+
+	private:
+		struct ThreadEvents;
+
+		ThreadEvents& CurrentThreadEvents();
+		void PushEvent(uint32_t type, char const * name, double value);
+
 	private:
 		static std::unique_ptr<PerfProfiler> perf_profiler_instance_;
+		static std::atomic<bool> zones_enabled_;
 
 		std::vector<std::tuple<int, std::string, PerfRangePtr,
 			std::vector<std::tuple<uint32_t, double, double>>>> perf_ranges_;
 		uint32_t frame_id_;
+
+		uint32_t generation_;
+		Timer timer_;
+
+		mutable std::mutex thread_events_mutex_;
+		std::vector<std::unique_ptr<ThreadEvents>> thread_events_;
 	};
 }
 
+#ifndef KLAYGE_SHIP
+#define KLAYGE_PERF_ZONE(name) KlayGE::PerfZone KFL_JOIN(perf_zone_, __LINE__)(name)
+#define KLAYGE_PERF_COUNTER(name, value)							\
+	do																\
+	{																\
+		if (KlayGE::PerfProfiler::ZonesEnabled())					\
+		{															\
+			KlayGE::PerfProfiler::Instance().Counter(name, value);	\
+		}															\
+	} while (false)
+#else
+#define KLAYGE_PERF_ZONE(name)
+#define KLAYGE_PERF_COUNTER(name, value)
+#endif
+
 #endif			// _KLAYGE_PERFPROFILER_HPP
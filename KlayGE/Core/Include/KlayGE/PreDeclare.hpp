@@ -39,7 +39,11 @@ namespace KlayGE
 	class Context;
 	class ResLoadingDesc;
 	typedef std::shared_ptr<ResLoadingDesc> ResLoadingDescPtr;
+	class ResLoadingToken;
+	typedef std::shared_ptr<ResLoadingToken> ResLoadingTokenPtr;
 	class ResLoader;
+	class StoredPackage;
+	typedef std::shared_ptr<StoredPackage> StoredPackagePtr;
 	class PerfRange;
 	typedef std::shared_ptr<PerfRange> PerfRangePtr;
 	class PerfProfiler;
@@ -146,6 +150,8 @@ namespace KlayGE
 	typedef std::shared_ptr<TexCompressionETC2RGB8> TexCompressionETC2RGB8Ptr;
 	class TexCompressionETC2RGB8A1;
 	typedef std::shared_ptr<TexCompressionETC2RGB8A1> TexCompressionETC2RGB8A1Ptr;
+	class TexCompressionETC2RGBA8;
+	typedef std::shared_ptr<TexCompressionETC2RGBA8> TexCompressionETC2RGBA8Ptr;
 	class TexCompressionETC2R11;
 	typedef std::shared_ptr<TexCompressionETC2R11> TexCompressionETC2R11Ptr;
 	class TexCompressionETC2RG11;
@@ -175,6 +181,8 @@ namespace KlayGE
 	typedef std::shared_ptr<SkinnedModel> SkinnedModelPtr;
 	class SkinnedMesh;
 	typedef std::shared_ptr<SkinnedMesh> SkinnedMeshPtr;
+	class AnimationClip;
+	typedef std::shared_ptr<AnimationClip> AnimationClipPtr;
 	class RenderableLightSourceProxy;
 	typedef std::shared_ptr<RenderableLightSourceProxy> RenderableLightSourceProxyPtr;
 	class RenderableCameraProxy;
@@ -341,6 +349,7 @@ namespace KlayGE
 	typedef std::shared_ptr<AudioBuffer> AudioBufferPtr;
 	class SoundBuffer;
 	class MusicBuffer;
+	class AudioStreamingService;
 	class AudioDataSource;
 	typedef std::shared_ptr<AudioDataSource> AudioDataSourcePtr;
 	class AudioFactory;
@@ -125,6 +125,7 @@ namespace KlayGE
 		uint32_t num_levels;
 
 		TextureSubresource()
+			: first_array_index(0), num_items(0), first_level(0), num_levels(0)
 		{
 		}
 
@@ -226,6 +227,15 @@ namespace KlayGE
 		{
 			return 0;
 		}
+
+		// Increased every time the value changes. Starts from 1, so 0 can be used as "never seen".
+		uint32_t Version() const
+		{
+			return version_;
+		}
+
+	protected:
+		uint32_t version_;
 	};
 
 	template <typename T>
@@ -272,11 +282,17 @@ namespace KlayGE
 				{
 					val_in_cbuff = value;
 					data_.cbuff_desc.cbuff->Dirty(true);
+					++ this->version_;
 				}
 			}
 			else
 			{
-				this->RetriveT() = value;
+				T& val = this->RetriveT();
+				if (val != value)
+				{
+					val = value;
+					++ this->version_;
+				}
 			}
 			return *this;
 		}
@@ -410,10 +426,16 @@ namespace KlayGE
 				}
 
 				this->data_.cbuff_desc.cbuff->Dirty(true);
+				++ this->version_;
 			}
 			else
 			{
-				this->RetriveT() = value;
+				std::vector<T>& val = this->RetriveT();
+				if (val != value)
+				{
+					val = value;
+					++ this->version_;
+				}
 			}
 			return *this;
 		}
@@ -1101,6 +1123,10 @@ namespace KlayGE
 		{
 			return type_;
 		}
+		uint32_t Version() const
+		{
+			return var_->Version();
+		}
 
 		RenderVariable const & Var() const
 		{
@@ -113,6 +113,14 @@ namespace KlayGE
 		uint32_t NumVerticesJustRendered();
 		uint32_t NumDrawsJustCalled();
 		uint32_t NumDispatchesJustCalled();
+		// Shader parameter bindings applied or skipped as unchanged by ShaderObject::Bind
+		uint32_t NumParamBindsJustApplied();
+		uint32_t NumParamBindsJustSkipped();
+		void AddParamBinds(uint32_t num_applied, uint32_t num_skipped)
+		{
+			num_param_binds_just_applied_ += num_applied;
+			num_param_binds_just_skipped_ += num_skipped;
+		}
 
 		void CreateRenderWindow(std::string const & name, RenderSettings& settings);
 		void DestroyRenderWindow();
@@ -309,6 +317,8 @@ namespace KlayGE
 		uint32_t num_vertices_just_rendered_;
 		uint32_t num_draws_just_called_;
 		uint32_t num_dispatches_just_called_;
+		uint32_t num_param_binds_just_applied_;
+		uint32_t num_param_binds_just_skipped_;
 
 		RenderDeviceCaps caps_;
 
@@ -359,6 +369,7 @@ namespace KlayGE
 		std::string_view native_shader_platform_name_;
 
 #ifndef KLAYGE_SHIP
+		PerfRangePtr frame_perf_;
 		PerfRangePtr hdr_pp_perf_;
 		PerfRangePtr smaa_pp_perf_;
 		PerfRangePtr post_tone_mapping_pp_perf_;
@@ -34,22 +34,14 @@
 #pragma once
 
 #include <KlayGE/PreDeclare.hpp>
+#include <array>
+#include <atomic>
+#include <condition_variable>
 #include <istream>
+#include <mutex>
 #include <vector>
 #include <string>
-#if defined(KLAYGE_COMPILER_MSVC)
-#pragma warning(push)
-#pragma warning(disable: 4512) // consume_via_copy in lockfree doesn't have assignment operator.
-#elif defined(KLAYGE_COMPILER_CLANG)
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wunused-parameter" // Ignore unused parameter 'x', 'alloc'
-#endif
-#include <boost/lockfree/spsc_queue.hpp>
-#if defined(KLAYGE_COMPILER_MSVC)
-#pragma warning(pop)
-#elif defined(KLAYGE_COMPILER_CLANG)
-#pragma clang diagnostic pop
-#endif
+#include <unordered_map>
 
 #include <KFL/ResIdentifier.hpp>
 #include <KFL/Thread.hpp>
@@ -80,6 +72,9 @@ namespace KlayGE
 
 		virtual bool HasSubThreadStage() const = 0;
 
+		// Content key of the resource, computed from type, name and access hints. Descs with same key are likely,
+		//  but not guaranteed, to Match.
+		virtual size_t Key() const = 0;
 		virtual bool Match(ResLoadingDesc const & rhs) const = 0;
 		virtual void CopyDataFrom(ResLoadingDesc const & rhs) = 0;
 		virtual std::shared_ptr<void> CloneResourceFrom(std::shared_ptr<void> const & resource) = 0;
@@ -87,8 +82,90 @@ namespace KlayGE
 		virtual std::shared_ptr<void> Resource() const = 0;
 	};
 
+	// Shared between the caller and the loading pipeline of an asynchronous query. Streaming code can change the
+	//  priority while the resource is queued, e.g. from the distance to camera, or cancel it if it's not needed anymore.
+	class KLAYGE_CORE_API ResLoadingToken : boost::noncopyable
+	{
+	public:
+		explicit ResLoadingToken(float priority = 0)
+			: priority_(priority), cancelled_(false)
+		{
+		}
+
+		// Higher priority is loaded first
+		void Priority(float priority)
+		{
+			priority_ = priority;
+		}
+		float Priority() const
+		{
+			return priority_;
+		}
+
+		// A cancelled request is dropped if its sub thread stage hasn't started yet
+		void Cancel()
+		{
+			cancelled_ = true;
+		}
+		bool Cancelled() const
+		{
+			return cancelled_;
+		}
+
+	private:
+		std::atomic<float> priority_;
+		std::atomic<bool> cancelled_;
+	};
+
+	struct ResCacheStats
+	{
+		uint64_t loaded_lookups;
+		uint64_t loaded_hits;
+		uint64_t loading_lookups;
+		uint64_t loading_hits;
+		uint64_t reclaimed;
+	};
+
 	class KLAYGE_CORE_API ResLoader : boost::noncopyable
 	{
+		static uint32_t constexpr NUM_LOADED_RES_SHARDS = 16;
+
+		enum LoadingStatus
+		{
+			LS_Loading,
+			LS_Complete,
+			LS_Cancelled,
+			LS_CanBeRemoved
+		};
+
+		// Every caller joining a request keeps its own token. The request is loaded at the highest priority still
+		//  asked for, and only dropped once all of them have cancelled.
+		class LoadingTokens : boost::noncopyable
+		{
+		public:
+			// Fails if the request has already been dropped
+			bool Join(ResLoadingTokenPtr const & token);
+
+			float Priority() const;
+			bool Cancelled() const;
+
+			// Marks the request as dropped if all tokens are cancelled. No one can join it afterwards.
+			bool TryDrop();
+
+		private:
+			mutable std::mutex mutex_;
+			std::vector<ResLoadingTokenPtr> tokens_;
+			bool dropped_ = false;
+		};
+
+		struct LoadingRes
+		{
+			ResLoadingDescPtr res_desc;
+			std::shared_ptr<volatile LoadingStatus> status;
+			ResLoadingTokenPtr token;
+			std::shared_ptr<LoadingTokens> tokens;
+		};
+
 	public:
 		ResLoader();
 		~ResLoader();
@@ -112,8 +189,12 @@ namespace KlayGE
 
 		std::shared_ptr<void> SyncQuery(ResLoadingDescPtr const & res_desc);
 		std::shared_ptr<void> ASyncQuery(ResLoadingDescPtr const & res_desc);
+		std::shared_ptr<void> ASyncQuery(ResLoadingDescPtr const & res_desc, ResLoadingTokenPtr const & token);
 		void Unload(std::shared_ptr<void> const & res);
 
+		// Token of a resource that is still being loaded asynchronously, or nullptr
+		ResLoadingTokenPtr LoadingToken(std::shared_ptr<void> const & res);
+
 		template <typename T>
 		std::shared_ptr<T> SyncQueryT(ResLoadingDescPtr const & res_desc)
 		{
@@ -134,17 +215,39 @@ namespace KlayGE
 
 		void Update();
 
+		// Time budget in seconds for running main thread stages in each Update(). 0 means unlimited.
+		void MainThreadStageBudget(float budget)
+		{
+			main_thread_stage_budget_ = budget;
+		}
+		float MainThreadStageBudget() const
+		{
+			return main_thread_stage_budget_;
+		}
+
+		uint32_t NumLoadingThreads() const
+		{
+			return static_cast<uint32_t>(loading_threads_.size());
+		}
+
+		ResCacheStats CacheStats() const;
+		void ResetCacheStats();
+
 	private:
 		std::string RealPath(std::string const & path);
 
 		void AddLoadedResource(ResLoadingDescPtr const & res_desc, std::shared_ptr<void> const & res);
 		std::shared_ptr<void> FindMatchLoadedResource(ResLoadingDescPtr const & res_desc);
 		void RemoveUnrefResources();
+		bool FindMatchLoadingResource(ResLoadingDescPtr const & res_desc, ResLoadingTokenPtr const & token,
+			std::shared_ptr<void>& res, LoadingRes& loading_res);
 
+		bool PopLoadingRequest(LoadingRes& request);
 		void LoadingThreadFunc();
 
 		ResIdentifierPtr LocatePkt(std::string const & name, std::string const & res_name,
 			std::string& password, std::string& internal_name);
+		ResIdentifierPtr OpenStoredPkt(std::string const & name, std::string const & res_name);
 #if defined(KLAYGE_PLATFORM_ANDROID)
 		AAsset* LocateFileAndroid(std::string const & name);
 #elif defined(KLAYGE_PLATFORM_IOS)
@@ -156,26 +259,40 @@ namespace KlayGE
 	private:
 		static std::unique_ptr<ResLoader> res_loader_instance_;
 
-		enum LoadingStatus
-		{
-			LS_Loading,
-			LS_Complete,
-			LS_CanBeRemoved
-		};
-
 		std::string exe_path_;
 		std::string local_path_;
 		std::vector<std::string> paths_;
 		std::mutex paths_mutex_;
 
-		std::mutex loaded_mutex_;
+		// Mapped stored packages by file name, nullptr if the file is not a stored package
+		std::unordered_map<std::string, StoredPackagePtr> stored_pkgs_;
+		std::mutex stored_pkgs_mutex_;
+
+		// Loaded resources, hashed by ResLoadingDesc::Key() and sharded to reduce lock contention
+		struct LoadedResShard
+		{
+			std::mutex mutex;
+			std::unordered_multimap<size_t, std::pair<ResLoadingDescPtr, std::weak_ptr<void>>> res;
+		};
+		std::array<LoadedResShard, NUM_LOADED_RES_SHARDS> loaded_res_shards_;
+		std::atomic<uint32_t> reclaim_shard_;
+
 		std::mutex loading_mutex_;
-		std::vector<std::pair<ResLoadingDescPtr, std::weak_ptr<void>>> loaded_res_;
-		std::vector<std::pair<ResLoadingDescPtr, std::shared_ptr<volatile LoadingStatus>>> loading_res_;
-		boost::lockfree::spsc_queue<std::pair<ResLoadingDescPtr, std::shared_ptr<volatile LoadingStatus>>,
-			boost::lockfree::capacity<1024>> loading_res_queue_;
+		std::unordered_multimap<size_t, LoadingRes> loading_res_;
+
+		std::atomic<uint64_t> stat_loaded_lookups_;
+		std::atomic<uint64_t> stat_loaded_hits_;
+		std::atomic<uint64_t> stat_loading_lookups_;
+		std::atomic<uint64_t> stat_loading_hits_;
+		std::atomic<uint64_t> stat_reclaimed_;
+
+		// Requests waiting for a loading thread. Pushed from any thread, popped by priority from all loading threads.
+		std::vector<LoadingRes> loading_res_queue_;
+		std::mutex loading_res_queue_mutex_;
+		std::condition_variable loading_res_queue_cond_;
 
-		std::unique_ptr<joiner<void>> loading_thread_;
+		std::vector<std::unique_ptr<joiner<void>>> loading_threads_;
+		float main_thread_stage_budget_;
 		volatile bool quit_;
 	};
 }
@@ -65,6 +65,10 @@ namespace KlayGE
 		void DelSceneObjectLocked(SceneObjectPtr const & obj);
 		void AddRenderable(Renderable* obj);
 
+		// Poses a skinned model at frame. The bones of all the models posed during a frame are built together on the
+		//  task scheduler, at the start of the next Update. Main thread only.
+		void PoseSkinnedModel(SkinnedModelPtr const & model, float frame);
+
 		uint32_t NumSceneObjects() const;
 		SceneObjectPtr& GetSceneObject(uint32_t index);
 		SceneObjectPtr const & GetSceneObject(uint32_t index) const;
@@ -86,6 +90,9 @@ namespace KlayGE
 		uint32_t NumVerticesRendered() const;
 		uint32_t NumDrawCalls() const;
 		uint32_t NumDispatchCalls() const;
+		// Only counted while the profiler is recording
+		uint32_t NumStateChanges() const;
+		uint32_t NumStateChangesSaved() const;
 
 	protected:
 		void Flush(uint32_t urt);
@@ -100,29 +107,68 @@ namespace KlayGE
 		virtual void DoResume() = 0;
 
 		void UpdateThreadFunc();
+		void SubThreadUpdateObjects(std::vector<SceneObjectPtr> const & objs, float app_time, float elapsed_time);
 
 		BoundOverlap VisibleTestFromParent(SceneObject* obj, float3 const & view_dir, float3 const & eye_pos,
 			float4x4 const & view_proj);
 
+		void UpdateObjectStoreBound(size_t index, AABBox const & aabb_ws);
+
 	protected:
+		// Flat copy of what the visibility pass reads every frame, indexed like scene_objs_. Walking these instead of
+		//  the SceneObjects keeps a model matrix and a heap allocated AABBox per object out of the cache.
+		struct SceneObjectStore
+		{
+			std::vector<float> min_x, min_y, min_z;
+			std::vector<float> max_x, max_y, max_z;
+			std::vector<uint32_t> attribs;
+			std::vector<uint8_t> has_parent;
+			std::vector<uint8_t> visible_marks;
+		};
+
 		std::vector<CameraPtr> cameras_;
 		Frustum const * frustum_;
 		std::vector<LightSourcePtr> lights_;
 		std::vector<SceneObjectPtr> scene_objs_;
 		std::vector<SceneObjectPtr> overlay_scene_objs_;
+		SceneObjectStore scene_obj_store_;
 
-		std::unordered_map<size_t, std::shared_ptr<std::vector<BoundOverlap>>> visible_marks_map_;
+		std::unordered_map<size_t, std::shared_ptr<std::vector<uint8_t>>> visible_marks_map_;
 
 		float small_obj_threshold_;
 		float update_elapse_;
 
 	private:
 		void FlushScene();
+		void PoseSkinnedModels();
+		void SyncObjectStore();
+		void AddToObjectStore(SceneObject const & obj);
+		void DelFromObjectStore(size_t index);
+		void SortRenderQueue(Camera const & camera);
 
 	private:
 		uint32_t urt_;
 
-		std::vector<std::pair<RenderTechnique const *, std::vector<Renderable*>>> render_queue_;
+		// Sort key and renderable. From high to low bits the key has the technique's order by weight, the material,
+		//  the render layout and the depth.
+		std::vector<std::pair<uint64_t, Renderable*>> render_queue_;
+		std::vector<std::pair<uint64_t, Renderable*>> render_queue_sort_buff_;
+		std::unordered_map<RenderTechnique const *, uint32_t> queue_tech_ids_;
+		std::unordered_map<RenderMaterial const *, uint32_t> queue_mtl_ids_;
+		std::unordered_map<RenderLayout const *, uint32_t> queue_layout_ids_;
+		std::vector<SceneObject*> visible_leaf_objs_;
+
+		// Bumped on every change to scene_objs_, so the update thread knows when to copy it again
+		uint32_t scene_objs_version_;
+		uint32_t sub_thread_objs_version_;
+		std::vector<SceneObjectPtr> sub_thread_objs_;
+		std::vector<SceneObjectPtr> sub_thread_overlay_objs_;
+		std::vector<std::vector<SceneObject*>> sub_thread_levels_;
+
+		// Latest frame of every model posed since the last Update, and scratch to hand them to SkinnedModel::SetFrames
+		std::unordered_map<SkinnedModelPtr, float> posed_models_;
+		std::vector<SkinnedModel*> pose_batch_models_;
+		std::vector<float> pose_batch_frames_;
 
 		uint32_t num_objects_rendered_;
 		uint32_t num_renderables_rendered_;
@@ -130,6 +176,8 @@ namespace KlayGE
 		uint32_t num_vertices_rendered_;
 		uint32_t num_draw_calls_;
 		uint32_t num_dispatch_calls_;
+		uint32_t num_state_changes_;
+		uint32_t num_state_changes_saved_;
 
 		std::mutex update_mutex_;
 		std::unique_ptr<joiner<void>> update_thread_;
@@ -23,6 +23,8 @@
 #include <KlayGE/RenderLayout.hpp>
 #include <KlayGE/Renderable.hpp>
 
+#include <atomic>
+
 namespace KlayGE
 {
 	class KLAYGE_CORE_API SceneObject : boost::noncopyable, public std::enable_shared_from_this<SceneObject>
@@ -70,6 +72,17 @@ namespace KlayGE
 		virtual void SubThreadUpdate(float app_time, float elapsed_time);
 		virtual bool MainThreadUpdate(float app_time, float elapsed_time);
 
+		// The scene manager brackets SubThreadUpdate with these. In between, ModelMatrix and Visible called from the
+		//  updating thread, on this object or any other, work on copies owned by the update thread, which
+		//  EndSubThreadUpdate hands over without locking. The main thread picks them up in AcquireSubThreadState, but
+		//  only the fields the update thread has written since the last pickup, so what the main thread set on the
+		//  other fields stays. PrepareSubThreadUpdate seeds the copies from the object, it's called by the update
+		//  thread with the scene manager's lock held.
+		void PrepareSubThreadUpdate();
+		void BeginSubThreadUpdate();
+		void EndSubThreadUpdate();
+		void AcquireSubThreadState();
+
 		uint32_t Attrib() const;
 		bool Visible() const;
 		void Visible(bool vis);
@@ -109,6 +122,34 @@ namespace KlayGE
 
 		std::function<void(SceneObject&, float, float)> sub_thread_update_func_;
 		std::function<void(SceneObject&, float, float)> main_thread_update_func_;
+
+	private:
+		static bool InSubThreadUpdate();
+		void InitSubThreadStates();
+
+	private:
+		static uint32_t const SUB_THREAD_STATE_FRESH = 0x80000000UL;
+
+		// The versions count the update thread's writes to each field. A published state can be dropped when the
+		//  update thread publishes again before the main thread picks it up, so comparing versions, rather than
+		//  carrying per-publish dirty bits, is what tells the main thread which fields are new.
+		struct SubThreadState
+		{
+			float4x4 model;
+			bool visible;
+			uint32_t model_version;
+			uint32_t visible_version;
+		};
+
+		// Allocated in PrepareSubThreadUpdate. [0] is the update thread's working copy, the other 3 form a triple
+		//  buffer with the main thread.
+		std::unique_ptr<SubThreadState[]> sub_thread_states_;
+		std::atomic<uint32_t> sub_thread_middle_;
+		uint32_t sub_thread_back_;
+		uint32_t main_thread_front_;
+		uint32_t main_thread_model_version_;
+		uint32_t main_thread_visible_version_;
+		bool sub_thread_dirty_;
 	};
 }
 
@@ -0,0 +1,81 @@
+/**
+ * @file StoredPackage.hpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#ifndef _KLAYGE_STOREDPACKAGE_HPP
+#define _KLAYGE_STOREDPACKAGE_HPP
+
+#pragma once
+
+#include <KlayGE/PreDeclare.hpp>
+#include <KFL/ArrayRef.hpp>
+#include <KFL/CXX17/string_view.hpp>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace KlayGE
+{
+	// A package of uncompressed files. It's mapped as a whole, and files in it are returned as slices of the mapping
+	//  without any copy. Used the same way as 7z packages, with a "package//file" path.
+	//
+	// Layout, little endian:
+	//   uint32_t fourcc 'KPKG', uint32_t version, uint32_t num_files
+	//   num_files * { uint32_t name_len, char name[name_len], uint64_t offset, uint64_t size }
+	//   file data, each file aligned to 16 bytes
+	class KLAYGE_CORE_API StoredPackage : boost::noncopyable
+	{
+	public:
+		explicit StoredPackage(std::string const & pkg_name);
+
+		bool Valid() const
+		{
+			return valid_;
+		}
+
+		std::shared_ptr<MappedFile> const & Mapping() const
+		{
+			return mapping_;
+		}
+
+		// Empty if the file is not in the package
+		ArrayRef<uint8_t> Find(std::string_view name) const;
+
+		static void Save(std::string const & pkg_name, std::vector<std::string> const & internal_names,
+			std::vector<std::string> const & file_names);
+
+	private:
+		std::shared_ptr<MappedFile> mapping_;
+		std::unordered_map<std::string, std::pair<uint64_t, uint64_t>> files_;
+		bool valid_;
+	};
+}
+
+#endif		// _KLAYGE_STOREDPACKAGE_HPP
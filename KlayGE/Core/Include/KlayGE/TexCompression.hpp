@@ -80,9 +80,17 @@ namespace KlayGE
 			return decoded_fmt_;
 		}
 
+		// A new codec of the same kind. Codecs keep per-block scratch state, so every thread needs its own.
+		virtual TexCompressionPtr Clone() const = 0;
+
 		virtual void EncodeBlock(void* output, void const * input, TexCompressionMethod method) = 0;
 		virtual void DecodeBlock(void* output, void const * input) = 0;
 
+		// Batched versions of EncodeBlock/DecodeBlock. The uncompressed blocks are tightly packed one after another,
+		//  so are the compressed ones.
+		virtual void EncodeBlocks(void* output, void const * input, uint32_t num_blocks, TexCompressionMethod method);
+		virtual void DecodeBlocks(void* output, void const * input, uint32_t num_blocks);
+
 		virtual void EncodeMem(uint32_t width, uint32_t height, 
 			void* output, uint32_t out_row_pitch, uint32_t out_slice_pitch,
 			void const * input, uint32_t in_row_pitch, uint32_t in_slice_pitch,
@@ -34,6 +34,7 @@
 #pragma once
 
 #include <cstring>
+#include <random>
 
 #include <KlayGE/TexCompression.hpp>
 
@@ -80,6 +81,8 @@ namespace KlayGE
 	public:
 		TexCompressionBC1();
 
+		virtual TexCompressionPtr Clone() const override;
+
 		virtual void EncodeBlock(void* output, void const * input, TexCompressionMethod method) override;
 		virtual void DecodeBlock(void* output, void const * input) override;
 
@@ -98,6 +101,8 @@ namespace KlayGE
 	public:
 		TexCompressionBC2();
 
+		virtual TexCompressionPtr Clone() const override;
+
 		virtual void EncodeBlock(void* output, void const * input, TexCompressionMethod method) override;
 		virtual void DecodeBlock(void* output, void const * input) override;
 
@@ -110,6 +115,8 @@ namespace KlayGE
 	public:
 		TexCompressionBC4();
 
+		virtual TexCompressionPtr Clone() const override;
+
 		virtual void EncodeBlock(void* output, void const * input, TexCompressionMethod method) override;
 		virtual void DecodeBlock(void* output, void const * input) override;
 	};
@@ -119,6 +126,8 @@ namespace KlayGE
 	public:
 		TexCompressionBC3();
 
+		virtual TexCompressionPtr Clone() const override;
+
 		virtual void EncodeBlock(void* output, void const * input, TexCompressionMethod method) override;
 		virtual void DecodeBlock(void* output, void const * input) override;
 
@@ -132,6 +141,8 @@ namespace KlayGE
 	public:
 		TexCompressionBC5();
 
+		virtual TexCompressionPtr Clone() const override;
+
 		virtual void EncodeBlock(void* output, void const * input, TexCompressionMethod method) override;
 		virtual void DecodeBlock(void* output, void const * input) override;
 
@@ -144,6 +155,8 @@ namespace KlayGE
 	public:
 		TexCompressionBC6U();
 
+		virtual TexCompressionPtr Clone() const override;
+
 		virtual void EncodeBlock(void* output, void const * input, TexCompressionMethod method) override;
 		virtual void DecodeBlock(void* output, void const * input) override;
 
@@ -205,6 +218,8 @@ namespace KlayGE
 	public:
 		TexCompressionBC6S();
 
+		virtual TexCompressionPtr Clone() const override;
+
 		virtual void EncodeBlock(void* output, void const * input, TexCompressionMethod method) override;
 		virtual void DecodeBlock(void* output, void const * input) override;
 
@@ -270,6 +285,8 @@ namespace KlayGE
 	public:
 		TexCompressionBC7();
 
+		virtual TexCompressionPtr Clone() const override;
+
 		virtual void EncodeBlock(void* output, void const * input, TexCompressionMethod method) override;
 		virtual void DecodeBlock(void* output, void const * input) override;
 
@@ -310,6 +327,9 @@ namespace KlayGE
 		TexCompressionErrorMetric error_metric_;
 		int rotate_mode_;
 		int index_mode_;
+		// Drives the simulated annealing. Reseeded for every block, so a block encodes the same whichever codec and
+		//  thread it lands on.
+		mutable std::ranlux24_base gen_;
 
 		static ModeInfo const mode_info_[];
 	};
@@ -89,6 +89,19 @@ namespace KlayGE
 		ETC2HModeBlock etc2_h_mode;
 		ETC2PlanarModeBlock etc2_planar_mode;
 	};
+
+	struct EACBlock
+	{
+		uint8_t base;
+		uint8_t multiplier_table;
+		uint8_t indices[6];
+	};
+
+	struct ETC2RGBA8Block
+	{
+		EACBlock alpha;
+		ETC2Block rgb;
+	};
 #ifdef KLAYGE_HAS_STRUCT_PACK
 	#pragma pack(pop)
 #endif
@@ -129,6 +142,8 @@ namespace KlayGE
 	public:
 		TexCompressionETC1();
 
+		virtual TexCompressionPtr Clone() const override;
+
 		virtual void EncodeBlock(void* output, void const * input, TexCompressionMethod method) override;
 		virtual void DecodeBlock(void* output, void const * input) override;
 
@@ -206,6 +221,8 @@ namespace KlayGE
 	public:
 		TexCompressionETC2RGB8();
 
+		virtual TexCompressionPtr Clone() const override;
+
 		virtual void EncodeBlock(void* output, void const * input, TexCompressionMethod method) override;
 		virtual void DecodeBlock(void* output, void const * input) override;
 
@@ -222,6 +239,23 @@ namespace KlayGE
 	public:
 		TexCompressionETC2RGB8A1();
 
+		virtual TexCompressionPtr Clone() const override;
+
+		virtual void EncodeBlock(void* output, void const * input, TexCompressionMethod method) override;
+		virtual void DecodeBlock(void* output, void const * input) override;
+
+	private:
+		TexCompressionETC1Ptr etc1_codec_;
+		TexCompressionETC2RGB8Ptr etc2_rgb8_codec_;
+	};
+
+	class KLAYGE_CORE_API TexCompressionETC2RGBA8 : public TexCompression
+	{
+	public:
+		TexCompressionETC2RGBA8();
+
+		virtual TexCompressionPtr Clone() const override;
+
 		virtual void EncodeBlock(void* output, void const * input, TexCompressionMethod method) override;
 		virtual void DecodeBlock(void* output, void const * input) override;
 
@@ -229,6 +263,32 @@ namespace KlayGE
 		TexCompressionETC1Ptr etc1_codec_;
 		TexCompressionETC2RGB8Ptr etc2_rgb8_codec_;
 	};
+
+	class KLAYGE_CORE_API TexCompressionETC2R11 : public TexCompression
+	{
+	public:
+		TexCompressionETC2R11();
+
+		virtual TexCompressionPtr Clone() const override;
+
+		virtual void EncodeBlock(void* output, void const * input, TexCompressionMethod method) override;
+		virtual void DecodeBlock(void* output, void const * input) override;
+
+		// Decodes to 11-bit values, written with the given stride in uint16_t
+		static void DecodeEACR11Internal(uint16_t* r11, uint32_t stride, EACBlock const & eac);
+		static void DecodeEACAlphaInternal(uint8_t* alpha, uint32_t stride, EACBlock const & eac);
+	};
+
+	class KLAYGE_CORE_API TexCompressionETC2RG11 : public TexCompression
+	{
+	public:
+		TexCompressionETC2RG11();
+
+		virtual TexCompressionPtr Clone() const override;
+
+		virtual void EncodeBlock(void* output, void const * input, TexCompressionMethod method) override;
+		virtual void DecodeBlock(void* output, void const * input) override;
+	};
 }
 
 #endif		// _TEXCOMPRESSIONETC_HPP
@@ -40,6 +40,10 @@
 #include <KlayGE/UI.hpp>
 #include <KlayGE/SceneManager.hpp>
 #include <KlayGE/DeferredRenderingLayer.hpp>
+#include <KlayGE/PerfProfiler.hpp>
+
+#include <chrono>
+#include <thread>
 
 #include <boost/assert.hpp>
 
@@ -535,6 +539,10 @@ namespace KlayGE
 	void App3DFramework::Create()
 	{
 #endif
+#ifndef KLAYGE_SHIP
+		PerfProfiler::Instance().ThreadName("Main");
+#endif
+
 		ContextCfg cfg = Context::Instance().Config();
 		Context::Instance().RenderFactoryInstance().RenderEngineInstance().CreateRenderWindow(name_,
 			cfg.graphics_cfg);
@@ -614,6 +622,13 @@ namespace KlayGE
 	void App3DFramework::Run()
 #endif
 	{
+		if (Context::Instance().Config().headless)
+		{
+			this->HeadlessRun();
+			this->OnDestroy();
+			return;
+		}
+
 		RenderEngine& re = Context::Instance().RenderFactoryInstance().RenderEngineInstance();
 
 #if defined KLAYGE_PLATFORM_WINDOWS_DESKTOP
@@ -721,6 +736,47 @@ namespace KlayGE
 		this->OnDestroy();
 	}
 
+	// No message pump. Frames are driven for a scripted count or until Quit(), either back to back or, with
+	// fixed_rate, one every frame_time seconds.
+	void App3DFramework::HeadlessRun()
+	{
+		RenderEngine& re = Context::Instance().RenderFactoryInstance().RenderEngineInstance();
+		ContextCfg const & cfg = Context::Instance().Config();
+
+		bool const fixed_rate = cfg.headless_fixed_rate && (cfg.headless_frame_time > 0);
+		auto const frame_period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::duration<float>(cfg.headless_frame_time));
+		auto next_frame = std::chrono::steady_clock::now();
+		for (uint32_t i = 0; ((0 == cfg.headless_frames) || (i < cfg.headless_frames)) && !main_wnd_->Closed(); ++ i)
+		{
+			re.Refresh();
+
+			if (fixed_rate)
+			{
+				// Paced against an absolute schedule, so a slow frame is caught up rather than shifting every later one
+				next_frame += frame_period;
+				std::this_thread::sleep_until(next_frame);
+			}
+		}
+
+#ifndef KLAYGE_SHIP
+		if (!cfg.headless_report.empty())
+		{
+			// A .json report is a trace of the zones, anything else gets the per-frame ranges as CSV
+			PerfProfiler& profiler = PerfProfiler::Instance();
+			std::string_view const report = cfg.headless_report;
+			if ((report.size() > 5) && (report.substr(report.size() - 5) == ".json"))
+			{
+				profiler.ExportToChromeTrace(cfg.headless_report);
+			}
+			else
+			{
+				profiler.ExportToCSV(cfg.headless_report);
+			}
+		}
+#endif
+	}
+
 	// ȡǰ
 	/////////////////////////////////////////////////////////////////////////////////
 	Camera const & App3DFramework::ActiveCamera() const
@@ -772,6 +828,12 @@ namespace KlayGE
 	/////////////////////////////////////////////////////////////////////////////////
 	void App3DFramework::Quit()
 	{
+		if (Context::Instance().Config().headless)
+		{
+			main_wnd_->Closed(true);
+			return;
+		}
+
 #ifdef KLAYGE_PLATFORM_WINDOWS
 #ifdef KLAYGE_PLATFORM_WINDOWS_DESKTOP
 		::PostQuitMessage(0);
@@ -810,7 +872,16 @@ namespace KlayGE
 		++ total_num_frames_;
 
 		// measure statistics
-		frame_time_ = static_cast<float>(timer_.elapsed());
+		ContextCfg const & cfg = Context::Instance().Config();
+		if (cfg.headless && (cfg.headless_frame_time > 0))
+		{
+			// Deterministic AppTime/FrameTime for benchmark runs, independent of how long the frame really took
+			frame_time_ = cfg.headless_frame_time;
+		}
+		else
+		{
+			frame_time_ = static_cast<float>(timer_.elapsed());
+		}
 		++ num_frames_;
 		accumulate_time_ += frame_time_;
 		app_time_ += frame_time_;
@@ -37,6 +37,7 @@
 
 #include <glloader/glloader.h>
 
+#include <KlayGE/Context.hpp>
 #include <KlayGE/Window.hpp>
 
 namespace KlayGE
@@ -45,6 +46,24 @@ namespace KlayGE
 		: active_(false), ready_(false), closed_(false), keep_screen_on_(settings.keep_screen_on),
 			dpi_scale_(1), effective_dpi_scale_(1), win_rotation_(WR_Identity)
 	{
+		if (Context::Instance().Config().headless)
+		{
+			// There is no X server on headless boxes. The window only carries the frame size and is always active.
+			x_display_ = nullptr;
+			vi_ = nullptr;
+			x_window_ = 0;
+			wm_delete_window_ = 0;
+
+			left_ = settings.left;
+			top_ = settings.top;
+			width_ = settings.width;
+			height_ = settings.height;
+
+			active_ = true;
+			ready_ = true;
+			return;
+		}
+
 		x_display_ = XOpenDisplay(nullptr);
 
 		int r_size, g_size, b_size, a_size, d_size, s_size;
@@ -269,10 +288,13 @@ namespace KlayGE
 
 	Window::~Window()
 	{
-		//XFree(fbc_);
-		XFree(vi_);
-		XDestroyWindow(x_display_, x_window_);
-		XCloseDisplay(x_display_);
+		if (x_display_ != nullptr)
+		{
+			//XFree(fbc_);
+			XFree(vi_);
+			XDestroyWindow(x_display_, x_window_);
+			XCloseDisplay(x_display_);
+		}
 	}
 
 	void Window::MsgProc(XEvent const & event)
@@ -35,6 +35,7 @@
 #include <KFL/Math.hpp>
 #include <KFL/Util.hpp>
 
+#include <KlayGE/Context.hpp>
 #include <KlayGE/Window.hpp>
 
 #if (_WIN32_WINNT >= _WIN32_WINNT_WINBLUE)
@@ -159,10 +160,16 @@ namespace KlayGE
 #pragma warning(pop)
 #endif
 
-		::ShowWindow(wnd_, hide_ ? SW_HIDE : SW_SHOWNORMAL);
+		// A headless run keeps the window hidden. It never gets activated, so treat it as active from the start.
+		bool const headless = Context::Instance().Config().headless;
+		::ShowWindow(wnd_, (hide_ || headless) ? SW_HIDE : SW_SHOWNORMAL);
 		::UpdateWindow(wnd_);
 
 		ready_ = true;
+		if (headless)
+		{
+			active_ = true;
+		}
 	}
 
 	Window::Window(std::string const & name, RenderSettings const & settings, void* native_wnd)
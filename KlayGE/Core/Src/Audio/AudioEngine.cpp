@@ -37,10 +37,16 @@
 namespace KlayGE
 {
 	AudioEngine::AudioEngine()
-		: sound_vol_(1), music_vol_(1)
+		: streaming_service_(MakeUniquePtr<AudioStreamingService>()),
+			sound_vol_(1), music_vol_(1)
 	{
 	}
 
+	AudioStreamingService& AudioEngine::StreamingService()
+	{
+		return *streaming_service_;
+	}
+
 	AudioEngine::~AudioEngine()
 	{
 	}
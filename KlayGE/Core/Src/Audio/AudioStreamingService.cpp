@@ -0,0 +1,335 @@
+/**
+ * @file AudioStreamingService.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Thread.hpp>
+#include <KlayGE/Context.hpp>
+#include <KlayGE/AudioDataSource.hpp>
+
+#include <algorithm>
+
+#include <boost/assert.hpp>
+
+#include <KlayGE/Audio.hpp>
+
+namespace
+{
+	// Four services per refill period, so a stream never waits more than a quarter of a refill for a free slot
+	std::chrono::milliseconds const SERVICE_INTERVAL(125);
+	size_t const MAX_POOLED_REFILL_BUFFERS = 64;
+	float const DEFAULT_PREFETCH_TIME = 1.0f;
+}
+
+namespace KlayGE
+{
+	AudioStreamingService::AudioStreamingService(uint32_t num_workers)
+		: num_workers_(std::max(num_workers, 1U)), quit_(false),
+			prefetch_time_(DEFAULT_PREFETCH_TIME), num_underruns_(0)
+	{
+	}
+
+	AudioStreamingService::~AudioStreamingService()
+	{
+		{
+			std::lock_guard<std::mutex> lock(streams_mutex_);
+			quit_ = true;
+		}
+		work_cond_.notify_all();
+
+		for (auto& worker : workers_)
+		{
+			worker();
+		}
+	}
+
+	void AudioStreamingService::AddStream(MusicBuffer& buffer)
+	{
+		BOOST_ASSERT(nullptr == buffer.streaming_service_);
+
+		auto stream = MakeUniquePtr<Stream>();
+		stream->buffer = &buffer;
+		stream->prefetched_bytes = 0;
+		stream->end_of_stream = false;
+		stream->busy = false;
+
+		buffer.streaming_service_ = this;
+
+		// Fill the device queue before playback starts. Workers take over from here.
+		if (this->ServiceStream(*stream, true))
+		{
+			this->ReleaseStream(*stream);
+
+			std::lock_guard<std::mutex> lock(streams_mutex_);
+			buffer.streaming_service_ = nullptr;
+			return;
+		}
+		stream->next_service = std::chrono::steady_clock::now() + SERVICE_INTERVAL;
+
+		{
+			std::lock_guard<std::mutex> lock(streams_mutex_);
+
+			if (workers_.empty())
+			{
+				for (uint32_t i = 0; i < num_workers_; ++ i)
+				{
+					workers_.push_back(Context::Instance().ThreadPool()(
+						[this]
+						{
+							this->WorkerLoop();
+						}));
+				}
+			}
+
+			streams_.push_back(std::move(stream));
+		}
+		work_cond_.notify_one();
+	}
+
+	bool AudioStreamingService::RemoveStream(MusicBuffer& buffer)
+	{
+		std::unique_lock<std::mutex> lock(streams_mutex_);
+		bool removed = false;
+		for (;;)
+		{
+			auto iter = std::find_if(streams_.begin(), streams_.end(),
+				[&buffer](std::unique_ptr<Stream> const & stream)
+				{
+					return stream->buffer == &buffer;
+				});
+			if (iter == streams_.end())
+			{
+				break;
+			}
+
+			if (!(*iter)->busy)
+			{
+				this->ReleaseStream(**iter);
+				streams_.erase(iter);
+				removed = true;
+				break;
+			}
+
+			idle_cond_.wait(lock);
+		}
+
+		buffer.streaming_service_ = nullptr;
+		return removed;
+	}
+
+	size_t AudioStreamingService::NumStreams() const
+	{
+		std::lock_guard<std::mutex> lock(streams_mutex_);
+		return streams_.size();
+	}
+
+	void AudioStreamingService::PrefetchTime(float seconds)
+	{
+		prefetch_time_ = std::max(seconds, 0.0f);
+	}
+
+	float AudioStreamingService::PrefetchTime() const
+	{
+		return prefetch_time_;
+	}
+
+	uint32_t AudioStreamingService::NumUnderruns() const
+	{
+		return num_underruns_;
+	}
+
+	void AudioStreamingService::WorkerLoop()
+	{
+		std::unique_lock<std::mutex> lock(streams_mutex_);
+		while (!quit_)
+		{
+			Stream* next = nullptr;
+			for (auto const & stream : streams_)
+			{
+				if (!stream->busy && ((nullptr == next) || (stream->next_service < next->next_service)))
+				{
+					next = stream.get();
+				}
+			}
+
+			if (nullptr == next)
+			{
+				work_cond_.wait(lock);
+				continue;
+			}
+			if (next->next_service > std::chrono::steady_clock::now())
+			{
+				work_cond_.wait_until(lock, next->next_service);
+				continue;
+			}
+
+			next->busy = true;
+			lock.unlock();
+
+			bool const finished = this->ServiceStream(*next, false);
+
+			lock.lock();
+			next->busy = false;
+			next->next_service = std::chrono::steady_clock::now() + SERVICE_INTERVAL;
+			if (finished)
+			{
+				next->buffer->streaming_service_ = nullptr;
+				this->ReleaseStream(*next);
+				streams_.erase(std::find_if(streams_.begin(), streams_.end(),
+					[next](std::unique_ptr<Stream> const & stream)
+					{
+						return stream.get() == next;
+					}));
+			}
+			idle_cond_.notify_all();
+		}
+	}
+
+	bool AudioStreamingService::ServiceStream(Stream& stream, bool prime)
+	{
+		MusicBuffer& buffer = *stream.buffer;
+
+		if (!prime && !stream.end_of_stream && buffer.Starved())
+		{
+			++ buffer.num_underruns_;
+			++ num_underruns_;
+		}
+
+		uint32_t free_slots = buffer.FreeRefillSlots();
+		while (free_slots > 0)
+		{
+			if (stream.prefetched.empty() && !stream.end_of_stream)
+			{
+				// Prefetching fell behind the device. Decode on demand.
+				this->DecodeRefill(stream);
+			}
+			if (stream.prefetched.empty())
+			{
+				break;
+			}
+
+			std::vector<uint8_t> refill = std::move(stream.prefetched.front());
+			stream.prefetched.pop_front();
+
+			uint32_t const size = static_cast<uint32_t>(refill.size());
+			stream.prefetched_bytes -= size;
+			buffer.SubmitRefill(refill.data(), size);
+			this->FreeRefillBuffer(std::move(refill));
+
+			-- free_slots;
+		}
+		if (!prime)
+		{
+			buffer.ResumeIfStarved();
+		}
+
+		if (stream.end_of_stream && stream.prefetched.empty())
+		{
+			// Only signaled once the device has room again, so the last refill is not cut short
+			if (free_slots > 0)
+			{
+				buffer.EndOfStream();
+				return true;
+			}
+		}
+		else if (!prime)
+		{
+			uint32_t const prefetch_bytes = static_cast<uint32_t>(prefetch_time_
+				* MusicBuffer::BUFFERS_PER_SECOND * buffer.refill_size_);
+			while (!stream.end_of_stream && (stream.prefetched_bytes < prefetch_bytes))
+			{
+				this->DecodeRefill(stream);
+			}
+		}
+
+		return false;
+	}
+
+	void AudioStreamingService::DecodeRefill(Stream& stream)
+	{
+		MusicBuffer& buffer = *stream.buffer;
+		AudioDataSource& data_source = *buffer.data_source_;
+
+		std::vector<uint8_t> refill = this->AllocRefillBuffer(buffer.refill_size_);
+		size_t size = data_source.Read(refill.data(), refill.size());
+		if ((0 == size) && buffer.loop_)
+		{
+			data_source.Reset();
+			size = data_source.Read(refill.data(), refill.size());
+		}
+
+		if (size > 0)
+		{
+			refill.resize(size);
+			stream.prefetched_bytes += static_cast<uint32_t>(size);
+			stream.prefetched.push_back(std::move(refill));
+		}
+		else
+		{
+			stream.end_of_stream = true;
+			this->FreeRefillBuffer(std::move(refill));
+		}
+	}
+
+	void AudioStreamingService::ReleaseStream(Stream& stream)
+	{
+		for (auto& refill : stream.prefetched)
+		{
+			this->FreeRefillBuffer(std::move(refill));
+		}
+		stream.prefetched.clear();
+		stream.prefetched_bytes = 0;
+	}
+
+	std::vector<uint8_t> AudioStreamingService::AllocRefillBuffer(uint32_t size)
+	{
+		std::vector<uint8_t> buff;
+		{
+			std::lock_guard<std::mutex> lock(refill_pool_mutex_);
+			if (!refill_pool_.empty())
+			{
+				buff = std::move(refill_pool_.back());
+				refill_pool_.pop_back();
+			}
+		}
+
+		buff.resize(size);
+		return buff;
+	}
+
+	void AudioStreamingService::FreeRefillBuffer(std::vector<uint8_t>&& buff)
+	{
+		std::lock_guard<std::mutex> lock(refill_pool_mutex_);
+		if (refill_pool_.size() < MAX_POOLED_REFILL_BUFFERS)
+		{
+			refill_pool_.push_back(std::move(buff));
+		}
+	}
+}
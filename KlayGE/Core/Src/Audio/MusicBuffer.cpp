@@ -29,14 +29,47 @@
  */
 
 #include <KlayGE/KlayGE.hpp>
+#include <KFL/ErrorHandling.hpp>
+#include <KlayGE/Context.hpp>
+#include <KlayGE/AudioFactory.hpp>
 #include <KlayGE/AudioDataSource.hpp>
 
 #include <KlayGE/Audio.hpp>
 
+#include <algorithm>
+
+namespace
+{
+	using namespace KlayGE;
+
+	uint32_t AudioFrameBytes(AudioFormat format)
+	{
+		switch (format)
+		{
+		case AF_Mono8:
+			return 1;
+
+		case AF_Mono16:
+		case AF_Stereo8:
+			return 2;
+
+		case AF_Stereo16:
+			return 4;
+
+		default:
+			KFL_UNREACHABLE("Invalid audio format");
+		}
+	}
+}
+
 namespace KlayGE
 {
 	MusicBuffer::MusicBuffer(AudioDataSourcePtr const & data_source)
-		: AudioBuffer(data_source)
+		: AudioBuffer(data_source),
+			loop_(false),
+			refill_size_(std::max(freq_ / BUFFERS_PER_SECOND, 1U) * AudioFrameBytes(format_)),
+			streaming_service_(nullptr),
+			num_underruns_(0)
 	{
 	}
 
@@ -58,16 +91,41 @@ namespace KlayGE
 
 	void MusicBuffer::Play(bool loop)
 	{
+		// A stream that is still running carries on from where it is. Otherwise the buffer either never played or ran
+		//  to the end, and starts over.
+		AudioStreamingService* service = streaming_service_;
+		if ((nullptr == service) || !service->RemoveStream(*this))
+		{
+			data_source_->Reset();
+		}
 		this->DoStop();
+
+		loop_ = loop;
+		Context::Instance().AudioFactoryInstance().AudioEngineInstance().StreamingService().AddStream(*this);
 		this->DoPlay(loop);
 	}
 
 	void MusicBuffer::Stop()
 	{
+		AudioStreamingService* service = streaming_service_;
+		if (service != nullptr)
+		{
+			service->RemoveStream(*this);
+		}
+
 		if (this->IsPlaying())
 		{
 			this->DoStop();
 			data_source_->Reset();
 		}
 	}
+
+	void MusicBuffer::ResumeIfStarved()
+	{
+	}
+
+	uint32_t MusicBuffer::NumUnderruns() const
+	{
+		return num_underruns_;
+	}
 }
@@ -116,6 +116,7 @@ namespace KlayGE
 #endif
 
 		gtp_instance_ = MakeUniquePtr<thread_pool>(1, 16);
+		gts_instance_ = MakeUniquePtr<task_scheduler>(0);
 	}
 
 	Context::~Context()
@@ -140,6 +141,7 @@ namespace KlayGE
 
 		app_ = nullptr;
 
+		gts_instance_.reset();
 		gtp_instance_.reset();
 	}
 
@@ -318,6 +320,11 @@ namespace KlayGE
 		std::vector<std::pair<std::string, std::string>> graphics_options;
 		bool perf_profiler = false;
 		bool location_sensor = false;
+		bool headless = false;
+		uint32_t headless_frames = 0;
+		float headless_frame_time = 0;
+		bool headless_fixed_rate = false;
+		std::string headless_report;
 
 		std::string rf_name;
 		std::string af_name;
@@ -390,6 +397,33 @@ namespace KlayGE
 				location_sensor = location_sensor_node->Attrib("enabled")->ValueInt() ? true : false;
 			}
 
+			XMLNodePtr headless_node = context_node->FirstNode("headless");
+			if (headless_node)
+			{
+				headless = headless_node->Attrib("enabled")->ValueInt() ? true : false;
+
+				XMLAttributePtr attr = headless_node->Attrib("frames");
+				if (attr)
+				{
+					headless_frames = attr->ValueUInt();
+				}
+				attr = headless_node->Attrib("frame_time");
+				if (attr)
+				{
+					headless_frame_time = attr->ValueFloat();
+				}
+				attr = headless_node->Attrib("fixed_rate");
+				if (attr)
+				{
+					headless_fixed_rate = attr->ValueInt() ? true : false;
+				}
+				attr = headless_node->Attrib("report");
+				if (attr)
+				{
+					headless_report = attr->ValueString();
+				}
+			}
+
 			XMLNodePtr frame_node = graphics_node->FirstNode("frame");
 			XMLAttributePtr attr;
 			attr = frame_node->Attrib("width");
@@ -675,6 +709,21 @@ namespace KlayGE
 			sm_name = available_sms[0];
 		}
 
+#if defined(KLAYGE_PLATFORM_WINDOWS_DESKTOP) || defined(KLAYGE_PLATFORM_LINUX)
+		if (headless)
+		{
+			// No device and no window. NullRender only exists on dev platforms, and the profiler is what a headless
+			// run is for.
+			rf_name = "NullRender";
+			af_name = "NullAudio";
+			if_name = "NullInput";
+			sf_name = "NullShow";
+			perf_profiler = true;
+		}
+#else
+		headless = false;
+#endif
+
 		cfg_.render_factory_name = std::move(rf_name);
 		cfg_.audio_factory_name = std::move(af_name);
 		cfg_.input_factory_name = std::move(if_name);
@@ -709,6 +758,13 @@ namespace KlayGE
 		cfg_.deferred_rendering = false;
 		cfg_.perf_profiler = perf_profiler;
 		cfg_.location_sensor = location_sensor;
+		cfg_.headless = headless;
+		cfg_.headless_frames = headless_frames;
+		cfg_.headless_frame_time = headless_frame_time;
+		cfg_.headless_fixed_rate = headless_fixed_rate;
+		cfg_.headless_report = std::move(headless_report);
+
+		PerfProfiler::ZonesEnabled(cfg_.perf_profiler);
 	}
 
 	void Context::SaveCfg(std::string const & cfg_file)
@@ -754,6 +810,14 @@ namespace KlayGE
 			XMLNodePtr location_sensor_node = cfg_doc.AllocNode(XNT_Element, "location_sensor");
 			location_sensor_node->AppendAttrib(cfg_doc.AllocAttribInt("enabled", cfg_.location_sensor));
 			context_node->AppendNode(location_sensor_node);
+
+			XMLNodePtr headless_node = cfg_doc.AllocNode(XNT_Element, "headless");
+			headless_node->AppendAttrib(cfg_doc.AllocAttribInt("enabled", cfg_.headless));
+			headless_node->AppendAttrib(cfg_doc.AllocAttribUInt("frames", cfg_.headless_frames));
+			headless_node->AppendAttrib(cfg_doc.AllocAttribFloat("frame_time", cfg_.headless_frame_time));
+			headless_node->AppendAttrib(cfg_doc.AllocAttribInt("fixed_rate", cfg_.headless_fixed_rate));
+			headless_node->AppendAttrib(cfg_doc.AllocAttribString("report", cfg_.headless_report));
+			context_node->AppendNode(headless_node);
 		}
 		root->AppendNode(context_node);
 
@@ -931,6 +995,8 @@ namespace KlayGE
 	{
 		cfg_ = cfg;
 
+		PerfProfiler::ZonesEnabled(cfg_.perf_profiler);
+
 		if (this->RenderFactoryValid())
 		{
 			if (cfg_.deferred_rendering)
@@ -35,17 +35,102 @@
 #include <KFL/Thread.hpp>
 
 #include <fstream>
+#include <iomanip>
 
 #include <KlayGE/PerfProfiler.hpp>
 
 namespace
 {
+	using namespace KlayGE;
+
 	std::mutex singleton_mutex;
+
+	// Power of 2. Older events are overwritten, so a capture keeps the most recent ones of each thread.
+	uint32_t constexpr PERF_EVENTS_PER_THREAD = 64 * 1024;
+
+	enum PerfEventType
+	{
+		PET_BeginZone,
+		PET_EndZone,
+		PET_Counter,
+		PET_FrameMarker
+	};
+
+	struct PerfEvent
+	{
+		char const * name;
+		double time;
+		double value;
+		uint32_t type;
+	};
+
+	std::atomic<uint32_t> profiler_generation(0);
+
+	// A profiler can be destroyed and recreated, the generation tells whether the cached buffer belongs to this one
+	thread_local void* tls_thread_events = nullptr;
+	thread_local uint32_t tls_generation = 0;
+
+	void WriteJsonString(std::ostream& os, char const * str)
+	{
+		os << '"';
+		for (char const * p = str; *p != '\0'; ++ p)
+		{
+			switch (*p)
+			{
+			case '"':
+			case '\\':
+				os << '\\' << *p;
+				break;
+
+			case '\n':
+				os << "\\n";
+				break;
+
+			default:
+				if (static_cast<unsigned char>(*p) >= 0x20)
+				{
+					os << *p;
+				}
+				break;
+			}
+		}
+		os << '"';
+	}
 }
 
 namespace KlayGE
 {
+	struct PerfProfiler::ThreadEvents
+	{
+		uint32_t thread_index;
+		std::string name;
+
+		// Single producer, the owner thread. Allocated on its first event, so naming a thread costs nothing.
+		std::vector<PerfEvent> events;
+		std::atomic<uint64_t> write_pos;
+	};
+
 	std::unique_ptr<PerfProfiler> PerfProfiler::perf_profiler_instance_;
+	std::atomic<bool> PerfProfiler::zones_enabled_(false);
+
+	PerfZone::PerfZone(char const * name)
+		: name_(nullptr)
+	{
+		if (PerfProfiler::ZonesEnabled())
+		{
+			name_ = name;
+			PerfProfiler::Instance().BeginZone(name);
+		}
+	}
+
+	PerfZone::~PerfZone()
+	{
+		if (name_ != nullptr)
+		{
+			PerfProfiler::Instance().EndZone(name_);
+		}
+	}
+
 
 	PerfRange::PerfRange()
 		: cpu_time_(0), gpu_time_(0), dirty_(false)
@@ -108,7 +193,7 @@ namespace KlayGE
 
 
 	PerfProfiler::PerfProfiler()
-		: frame_id_(0)
+		: frame_id_(0), generation_(++ profiler_generation)
 	{
 	}
 
@@ -165,6 +250,11 @@ namespace KlayGE
 				}
 			}
 
+			if (zones_enabled_.load(std::memory_order_relaxed))
+			{
+				this->FrameMarker();
+			}
+
 			++ frame_id_;
 		}
 	}
@@ -194,4 +284,178 @@ namespace KlayGE
 			ofs << std::endl;
 		}
 	}
+
+	void PerfProfiler::ZonesEnabled(bool enabled)
+	{
+		zones_enabled_.store(enabled, std::memory_order_relaxed);
+	}
+
+	void PerfProfiler::BeginZone(char const * name)
+	{
+		this->PushEvent(PET_BeginZone, name, 0);
+	}
+
+	void PerfProfiler::EndZone(char const * name)
+	{
+		this->PushEvent(PET_EndZone, name, 0);
+	}
+
+	void PerfProfiler::Counter(char const * name, double value)
+	{
+		this->PushEvent(PET_Counter, name, value);
+	}
+
+	void PerfProfiler::FrameMarker()
+	{
+		this->PushEvent(PET_FrameMarker, "Frame", frame_id_);
+	}
+
+	void PerfProfiler::ThreadName(std::string const & name)
+	{
+		ThreadEvents& te = this->CurrentThreadEvents();
+
+		std::lock_guard<std::mutex> lock(thread_events_mutex_);
+		te.name = name;
+	}
+
+	PerfProfiler::ThreadEvents& PerfProfiler::CurrentThreadEvents()
+	{
+		if ((tls_thread_events == nullptr) || (tls_generation != generation_))
+		{
+			auto te = MakeUniquePtr<ThreadEvents>();
+			te->write_pos = 0;
+
+			std::lock_guard<std::mutex> lock(thread_events_mutex_);
+			te->thread_index = static_cast<uint32_t>(thread_events_.size());
+			tls_thread_events = te.get();
+			tls_generation = generation_;
+			thread_events_.push_back(std::move(te));
+		}
+
+		return *static_cast<ThreadEvents*>(tls_thread_events);
+	}
+
+	void PerfProfiler::PushEvent(uint32_t type, char const * name, double value)
+	{
+		ThreadEvents& te = this->CurrentThreadEvents();
+		if (te.events.empty())
+		{
+			te.events.resize(PERF_EVENTS_PER_THREAD);
+		}
+
+		uint64_t const pos = te.write_pos.load(std::memory_order_relaxed);
+		PerfEvent& ev = te.events[pos & (PERF_EVENTS_PER_THREAD - 1)];
+		ev.name = name;
+		ev.time = timer_.elapsed();
+		ev.value = value;
+		ev.type = type;
+		te.write_pos.store(pos + 1, std::memory_order_release);
+	}
+
+	void PerfProfiler::ExportToChromeTrace(std::string const & file_name) const
+	{
+		std::ofstream ofs(file_name.c_str());
+		ofs << std::fixed << std::setprecision(3);
+		ofs << "{\"traceEvents\":[" << std::endl;
+
+		bool first = true;
+		auto begin_event = [&ofs, &first](char const * ph, uint32_t tid)
+			{
+				if (!first)
+				{
+					ofs << ',' << std::endl;
+				}
+				first = false;
+
+				ofs << "{\"ph\":\"" << ph << "\",\"pid\":0,\"tid\":" << tid;
+			};
+
+		std::lock_guard<std::mutex> lock(thread_events_mutex_);
+		for (auto const & te : thread_events_)
+		{
+			if (!te->name.empty())
+			{
+				begin_event("M", te->thread_index);
+				ofs << ",\"name\":\"thread_name\",\"args\":{\"name\":";
+				WriteJsonString(ofs, te->name.c_str());
+				ofs << "}}";
+			}
+
+			uint64_t const end = te->write_pos.load(std::memory_order_acquire);
+			uint64_t const begin = (end > PERF_EVENTS_PER_THREAD) ? end - PERF_EVENTS_PER_THREAD : 0;
+			std::vector<PerfEvent> snapshot;
+			snapshot.reserve(static_cast<size_t>(end - begin));
+			for (uint64_t i = begin; i < end; ++ i)
+			{
+				snapshot.push_back(te->events[i & (PERF_EVENTS_PER_THREAD - 1)]);
+			}
+
+			// The owner keeps recording while we copy. Whatever it may have overwritten in the meantime is dropped,
+			//  including the slot of end_after, which it may be writing right now.
+			uint64_t const end_after = te->write_pos.load(std::memory_order_acquire);
+			uint64_t const valid_begin = (end_after >= PERF_EVENTS_PER_THREAD) ? end_after - PERF_EVENTS_PER_THREAD + 1 : 0;
+			size_t const skip = static_cast<size_t>(std::min(std::max(valid_begin, begin) - begin, end - begin));
+
+			// Keep B/E balanced: ends whose begins were dropped are skipped, zones still open are closed at the last
+			//  event's time.
+			std::vector<char const *> open_zones;
+			double last_time = 0;
+			for (size_t i = skip; i < snapshot.size(); ++ i)
+			{
+				PerfEvent const & ev = snapshot[i];
+				switch (ev.type)
+				{
+				case PET_BeginZone:
+					open_zones.push_back(ev.name);
+					begin_event("B", te->thread_index);
+					break;
+
+				case PET_EndZone:
+					if (open_zones.empty())
+					{
+						continue;
+					}
+					open_zones.pop_back();
+					begin_event("E", te->thread_index);
+					break;
+
+				case PET_Counter:
+					begin_event("C", te->thread_index);
+					break;
+
+				case PET_FrameMarker:
+				default:
+					begin_event("i", te->thread_index);
+					ofs << ",\"s\":\"g\"";
+					break;
+				}
+
+				ofs << ",\"ts\":" << ev.time * 1e6 << ",\"name\":";
+				WriteJsonString(ofs, ev.name);
+				if (PET_Counter == ev.type)
+				{
+					ofs << ",\"args\":{\"value\":" << ev.value << '}';
+				}
+				else if (PET_FrameMarker == ev.type)
+				{
+					ofs << ",\"args\":{\"frame\":" << static_cast<uint64_t>(ev.value) << '}';
+				}
+				ofs << '}';
+
+				last_time = ev.time;
+			}
+
+			while (!open_zones.empty())
+			{
+				begin_event("E", te->thread_index);
+				ofs << ",\"ts\":" << last_time * 1e6 << ",\"name\":";
+				WriteJsonString(ofs, open_zones.back());
+				ofs << '}';
+
+				open_zones.pop_back();
+			}
+		}
+
+		ofs << std::endl << "],\"displayTimeUnit\":\"ms\"}" << std::endl;
+	}
 }
@@ -30,10 +30,16 @@
 
 #include <KlayGE/KlayGE.hpp>
 #include <KFL/Util.hpp>
+#include <KFL/Timer.hpp>
+#include <KFL/MappedFile.hpp>
 #include <KlayGE/Extract7z.hpp>
+#include <KlayGE/StoredPackage.hpp>
+#include <KlayGE/PerfProfiler.hpp>
 #include <KFL/CXX17/filesystem.hpp>
 
+#include <algorithm>
 #include <fstream>
+#include <limits>
 #include <sstream>
 
 #if defined KLAYGE_PLATFORM_WINDOWS_DESKTOP
@@ -98,7 +104,9 @@ namespace KlayGE
 	std::unique_ptr<ResLoader> ResLoader::res_loader_instance_;
 
 	ResLoader::ResLoader()
-		: quit_(false)
+		: reclaim_shard_(0),
+			stat_loaded_lookups_(0), stat_loaded_hits_(0), stat_loading_lookups_(0), stat_loading_hits_(0), stat_reclaimed_(0),
+			main_thread_stage_budget_(0), quit_(false)
 	{
 #if defined KLAYGE_PLATFORM_WINDOWS
 #if defined KLAYGE_PLATFORM_WINDOWS_DESKTOP
@@ -226,14 +234,27 @@ namespace KlayGE
 #endif
 #endif
 
-		loading_thread_ = MakeUniquePtr<joiner<void>>(Context::Instance().ThreadPool()(
-				std::bind(&ResLoader::LoadingThreadFunc, this)));
+		// Leave some cores to the main and render threads
+		uint32_t const num_loading_threads = std::min(std::max(std::thread::hardware_concurrency() / 2, 1U), 8U);
+		for (uint32_t i = 0; i < num_loading_threads; ++ i)
+		{
+			loading_threads_.push_back(MakeUniquePtr<joiner<void>>(Context::Instance().ThreadPool()(
+				std::bind(&ResLoader::LoadingThreadFunc, this))));
+		}
 	}
 
 	ResLoader::~ResLoader()
 	{
-		quit_ = true;
-		(*loading_thread_)();
+		{
+			std::lock_guard<std::mutex> lock(loading_res_queue_mutex_);
+			quit_ = true;
+		}
+		loading_res_queue_cond_.notify_all();
+
+		for (auto& thread : loading_threads_)
+		{
+			(*thread)();
+		}
 	}
 
 	ResLoader& ResLoader::Instance()
@@ -429,12 +450,29 @@ namespace KlayGE
 #else
 					uint64_t timestamp = std::filesystem::last_write_time(res_path);
 #endif
+
+					// Big files are mapped, so loaders can read them without going through a stream
+					if (std::filesystem::file_size(res_path) >= 64 * 1024)
+					{
+						std::shared_ptr<MappedFile> mapping = MakeSharedPtr<MappedFile>();
+						if (mapping->Map(res_name))
+						{
+							return MakeSharedPtr<ResIdentifier>(name, timestamp, mapping, mapping->Data());
+						}
+					}
+
 					// The static_cast is a workaround for a bug in clang/c2
 					return MakeSharedPtr<ResIdentifier>(name, timestamp,
 						MakeSharedPtr<std::ifstream>(res_name.c_str(), static_cast<std::ios_base::openmode>(std::ios_base::binary)));
 				}
 				else
 				{
+					ResIdentifierPtr stored_file = this->OpenStoredPkt(name, res_name);
+					if (stored_file)
+					{
+						return stored_file;
+					}
+
 					std::string password;
 					std::string internal_name;
 					ResIdentifierPtr pkt_file = LocatePkt(name, res_name, password, internal_name);
@@ -482,27 +520,11 @@ namespace KlayGE
 		}
 		else
 		{
-			std::shared_ptr<volatile LoadingStatus> async_is_done;
-			bool found = false;
-			{
-				std::lock_guard<std::mutex> lock(loading_mutex_);
-
-				for (auto const & lrq : loading_res_)
-				{
-					if (lrq.first->Match(*res_desc))
-					{
-						res_desc->CopyDataFrom(*lrq.first);
-						res = lrq.first->Resource();
-						async_is_done = lrq.second;
-						found = true;
-						break;
-					}
-				}
-			}
-
+			LoadingRes loading_res;
+			bool const found = this->FindMatchLoadingResource(res_desc, MakeSharedPtr<ResLoadingToken>(), res, loading_res);
 			if (found)
 			{
-				*async_is_done = LS_Complete;
+				*loading_res.status = LS_Complete;
 			}
 			else
 			{
@@ -522,10 +544,64 @@ namespace KlayGE
 		return res;
 	}
 
+	bool ResLoader::LoadingTokens::Join(ResLoadingTokenPtr const & token)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (dropped_)
+		{
+			return false;
+		}
+
+		tokens_.push_back(token);
+		return true;
+	}
+
+	float ResLoader::LoadingTokens::Priority() const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		float priority = std::numeric_limits<float>::lowest();
+		for (auto const & token : tokens_)
+		{
+			if (!token->Cancelled())
+			{
+				priority = std::max(priority, token->Priority());
+			}
+		}
+		return priority;
+	}
+
+	bool ResLoader::LoadingTokens::Cancelled() const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return std::all_of(tokens_.begin(), tokens_.end(),
+			[](ResLoadingTokenPtr const & token)
+			{
+				return token->Cancelled();
+			});
+	}
+
+	bool ResLoader::LoadingTokens::TryDrop()
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		dropped_ = std::all_of(tokens_.begin(), tokens_.end(),
+			[](ResLoadingTokenPtr const & token)
+			{
+				return token->Cancelled();
+			});
+		return dropped_;
+	}
+
 	std::shared_ptr<void> ResLoader::ASyncQuery(ResLoadingDescPtr const & res_desc)
+	{
+		return this->ASyncQuery(res_desc, ResLoadingTokenPtr());
+	}
+
+	std::shared_ptr<void> ResLoader::ASyncQuery(ResLoadingDescPtr const & res_desc, ResLoadingTokenPtr const & token)
 	{
 		this->RemoveUnrefResources();
 
+		ResLoadingTokenPtr const own_token = token ? token : MakeSharedPtr<ResLoadingToken>();
+
 		std::shared_ptr<void> res;
 		std::shared_ptr<void> loaded_res = this->FindMatchLoadedResource(res_desc);
 		if (loaded_res)
@@ -545,30 +621,17 @@ namespace KlayGE
 		}
 		else
 		{
-			std::shared_ptr<volatile LoadingStatus> async_is_done;
-			bool found = false;
-			{
-				std::lock_guard<std::mutex> lock(loading_mutex_);
-
-				for (auto const & lrq : loading_res_)
-				{
-					if (lrq.first->Match(*res_desc))
-					{
-						res_desc->CopyDataFrom(*lrq.first);
-						res = lrq.first->Resource();
-						async_is_done = lrq.second;
-						found = true;
-						break;
-					}
-				}
-			}
-
+			LoadingRes loading_res;
+			bool const found = this->FindMatchLoadingResource(res_desc, own_token, res, loading_res);
 			if (found)
 			{
 				if (!res_desc->StateLess())
 				{
+					loading_res.res_desc = res_desc;
+					loading_res.token = own_token;
+
 					std::lock_guard<std::mutex> lock(loading_mutex_);
-					loading_res_.emplace_back(res_desc, async_is_done);
+					loading_res_.emplace(res_desc->Key(), loading_res);
 				}
 			}
 			else
@@ -577,13 +640,21 @@ namespace KlayGE
 				{
 					res = res_desc->CreateResource();
 
-					async_is_done = MakeSharedPtr<LoadingStatus>(LS_Loading);
+					loading_res.res_desc = res_desc;
+					loading_res.status = MakeSharedPtr<LoadingStatus>(LS_Loading);
+					loading_res.token = own_token;
+					loading_res.tokens = MakeSharedPtr<LoadingTokens>();
+					loading_res.tokens->Join(own_token);
 
 					{
 						std::lock_guard<std::mutex> lock(loading_mutex_);
-						loading_res_.emplace_back(res_desc, async_is_done);
+						loading_res_.emplace(res_desc->Key(), loading_res);
 					}
-					loading_res_queue_.push(std::make_pair(res_desc, async_is_done));
+					{
+						std::lock_guard<std::mutex> lock(loading_res_queue_mutex_);
+						loading_res_queue_.push_back(loading_res);
+					}
+					loading_res_queue_cond_.notify_one();
 				}
 				else
 				{
@@ -598,84 +669,172 @@ namespace KlayGE
 
 	void ResLoader::Unload(std::shared_ptr<void> const & res)
 	{
-		std::lock_guard<std::mutex> lock(loaded_mutex_);
-
-		for (auto iter = loaded_res_.begin(); iter != loaded_res_.end(); ++ iter)
+		// There is no key to look up by resource, but unloading is rare
+		for (auto& shard : loaded_res_shards_)
 		{
-			if (res == iter->second.lock())
+			std::lock_guard<std::mutex> lock(shard.mutex);
+
+			for (auto iter = shard.res.begin(); iter != shard.res.end(); ++ iter)
 			{
-				loaded_res_.erase(iter);
-				break;
+				if (res == iter->second.second.lock())
+				{
+					shard.res.erase(iter);
+					return;
+				}
 			}
 		}
 	}
 
 	void ResLoader::AddLoadedResource(ResLoadingDescPtr const & res_desc, std::shared_ptr<void> const & res)
 	{
-		std::lock_guard<std::mutex> lock(loaded_mutex_);
+		size_t const key = res_desc->Key();
+		auto& shard = loaded_res_shards_[key % NUM_LOADED_RES_SHARDS];
+		std::lock_guard<std::mutex> lock(shard.mutex);
 
-		bool found = false;
-		for (auto& c_desc : loaded_res_)
+		auto range = shard.res.equal_range(key);
+		for (auto iter = range.first; iter != range.second; ++ iter)
 		{
-			if (c_desc.first == res_desc)
+			if (iter->second.first == res_desc)
 			{
-				c_desc.second = std::weak_ptr<void>(res);
-				found = true;
-				break;
+				iter->second.second = std::weak_ptr<void>(res);
+				return;
 			}
 		}
-		if (!found)
-		{
-			loaded_res_.emplace_back(res_desc, std::weak_ptr<void>(res));
-		}
+		shard.res.emplace(key, std::make_pair(res_desc, std::weak_ptr<void>(res)));
 	}
 
 	std::shared_ptr<void> ResLoader::FindMatchLoadedResource(ResLoadingDescPtr const & res_desc)
 	{
-		std::lock_guard<std::mutex> lock(loaded_mutex_);
+		++ stat_loaded_lookups_;
+
+		size_t const key = res_desc->Key();
+		auto& shard = loaded_res_shards_[key % NUM_LOADED_RES_SHARDS];
+		std::lock_guard<std::mutex> lock(shard.mutex);
 
 		std::shared_ptr<void> loaded_res;
-		for (auto const & lr : loaded_res_)
+		auto range = shard.res.equal_range(key);
+		for (auto iter = range.first; iter != range.second; ++ iter)
 		{
-			if (lr.first->Match(*res_desc))
+			if (iter->second.first->Match(*res_desc))
 			{
-				loaded_res = lr.second.lock();
+				loaded_res = iter->second.second.lock();
+				if (loaded_res)
+				{
+					++ stat_loaded_hits_;
+				}
 				break;
 			}
 		}
 		return loaded_res;
 	}
 
+	bool ResLoader::FindMatchLoadingResource(ResLoadingDescPtr const & res_desc, ResLoadingTokenPtr const & token,
+		std::shared_ptr<void>& res, LoadingRes& loading_res)
+	{
+		++ stat_loading_lookups_;
+
+		std::lock_guard<std::mutex> lock(loading_mutex_);
+
+		auto range = loading_res_.equal_range(res_desc->Key());
+		for (auto iter = range.first; iter != range.second; ++ iter)
+		{
+			auto const & lrq = iter->second;
+			if (LS_Cancelled == *lrq.status)
+			{
+				continue;
+			}
+
+			// Joining keeps the request from being dropped while this caller still wants it
+			if (lrq.res_desc->Match(*res_desc) && lrq.tokens->Join(token))
+			{
+				res_desc->CopyDataFrom(*lrq.res_desc);
+				res = lrq.res_desc->Resource();
+				loading_res = lrq;
+
+				++ stat_loading_hits_;
+				return true;
+			}
+		}
+		return false;
+	}
+
 	void ResLoader::RemoveUnrefResources()
 	{
-		std::lock_guard<std::mutex> lock(loaded_mutex_);
+		// Only sweep one shard per call, so the cost is spread over queries instead of being O(N) every time
+		uint32_t const shard_index = reclaim_shard_.fetch_add(1) % NUM_LOADED_RES_SHARDS;
+		auto& shard = loaded_res_shards_[shard_index];
+		std::lock_guard<std::mutex> lock(shard.mutex);
 
-		for (auto iter = loaded_res_.begin(); iter != loaded_res_.end();)
+		for (auto iter = shard.res.begin(); iter != shard.res.end();)
 		{
-			if (iter->second.lock())
+			if (iter->second.second.expired())
 			{
-				++ iter;
+				iter = shard.res.erase(iter);
+				++ stat_reclaimed_;
 			}
 			else
 			{
-				iter = loaded_res_.erase(iter);
+				++ iter;
+			}
+		}
+	}
+
+	ResLoadingTokenPtr ResLoader::LoadingToken(std::shared_ptr<void> const & res)
+	{
+		std::lock_guard<std::mutex> lock(loading_mutex_);
+
+		for (auto const & lrq : loading_res_)
+		{
+			if (lrq.second.res_desc->Resource() == res)
+			{
+				return lrq.second.token;
 			}
 		}
+		return ResLoadingTokenPtr();
 	}
 
 	void ResLoader::Update()
 	{
-		std::vector<std::pair<ResLoadingDescPtr, std::shared_ptr<volatile LoadingStatus>>> tmp_loading_res;
+		std::vector<LoadingRes> tmp_loading_res;
 		{
 			std::lock_guard<std::mutex> lock(loading_mutex_);
-			tmp_loading_res = loading_res_;
+			tmp_loading_res.reserve(loading_res_.size());
+			for (auto const & lrq : loading_res_)
+			{
+				tmp_loading_res.push_back(lrq.second);
+			}
+		}
+
+		// With a limited budget, the most important resources have to get through first. Priorities can change on
+		//  other threads at any time, so sort on a snapshot.
+		std::vector<std::pair<float, size_t>> order(tmp_loading_res.size());
+		for (size_t i = 0; i < tmp_loading_res.size(); ++ i)
+		{
+			order[i] = std::make_pair(tmp_loading_res[i].tokens->Priority(), i);
 		}
+		std::stable_sort(order.begin(), order.end(),
+			[](std::pair<float, size_t> const & lhs, std::pair<float, size_t> const & rhs)
+			{
+				return lhs.first > rhs.first;
+			});
 
-		for (auto& lrq : tmp_loading_res)
+		Timer timer;
+		for (auto const & item : order)
 		{
-			if (LS_Complete == *lrq.second)
+			auto& lrq = tmp_loading_res[item.second];
+			if (LS_Cancelled == *lrq.status)
+			{
+				*lrq.status = LS_CanBeRemoved;
+			}
+			else if (LS_Complete == *lrq.status)
 			{
-				ResLoadingDescPtr const & res_desc = lrq.first;
+				if ((main_thread_stage_budget_ > 0) && (timer.elapsed() >= main_thread_stage_budget_))
+				{
+					// The rest has to wait for the next frame
+					continue;
+				}
+
+				ResLoadingDescPtr const & res_desc = lrq.res_desc;
 
 				std::shared_ptr<void> res;
 				std::shared_ptr<void> loaded_res = this->FindMatchLoadedResource(res_desc);
@@ -697,7 +856,7 @@ namespace KlayGE
 					this->AddLoadedResource(res_desc, res);
 				}
 
-				*lrq.second = LS_CanBeRemoved;
+				*lrq.status = LS_CanBeRemoved;
 			}
 		}
 
@@ -705,7 +864,7 @@ namespace KlayGE
 			std::lock_guard<std::mutex> lock(loading_mutex_);
 			for (auto iter = loading_res_.begin(); iter != loading_res_.end();)
 			{
-				if (LS_CanBeRemoved == *(iter->second))
+				if (LS_CanBeRemoved == *(iter->second.status))
 				{
 					iter = loading_res_.erase(iter);
 				}
@@ -717,21 +876,88 @@ namespace KlayGE
 		}
 	}
 
+	ResCacheStats ResLoader::CacheStats() const
+	{
+		ResCacheStats stats;
+		stats.loaded_lookups = stat_loaded_lookups_;
+		stats.loaded_hits = stat_loaded_hits_;
+		stats.loading_lookups = stat_loading_lookups_;
+		stats.loading_hits = stat_loading_hits_;
+		stats.reclaimed = stat_reclaimed_;
+		return stats;
+	}
+
+	void ResLoader::ResetCacheStats()
+	{
+		stat_loaded_lookups_ = 0;
+		stat_loaded_hits_ = 0;
+		stat_loading_lookups_ = 0;
+		stat_loading_hits_ = 0;
+		stat_reclaimed_ = 0;
+	}
+
+	bool ResLoader::PopLoadingRequest(LoadingRes& request)
+	{
+		std::unique_lock<std::mutex> lock(loading_res_queue_mutex_);
+		loading_res_queue_cond_.wait(lock, [this]
+			{
+				return quit_ || !loading_res_queue_.empty();
+			});
+		if (quit_)
+		{
+			return false;
+		}
+
+		// Priorities can change while requests are queued, so the highest one is picked at pop time instead of
+		//  keeping a heap. Cancelled requests are popped first to drop them early. Equal priorities are FIFO.
+		auto best = loading_res_queue_.begin();
+		float best_priority = best->tokens->Priority();
+		for (auto iter = best; iter != loading_res_queue_.end(); ++ iter)
+		{
+			if (iter->tokens->Cancelled())
+			{
+				best = iter;
+				break;
+			}
+
+			float const priority = iter->tokens->Priority();
+			if (priority > best_priority)
+			{
+				best = iter;
+				best_priority = priority;
+			}
+		}
+
+		request = std::move(*best);
+		loading_res_queue_.erase(best);
+		return true;
+	}
+
 	void ResLoader::LoadingThreadFunc()
 	{
-		while (!quit_)
+#ifndef KLAYGE_SHIP
+		PerfProfiler::Instance().ThreadName("Resource loading");
+#endif
+
+		LoadingRes request;
+		while (this->PopLoadingRequest(request))
 		{
-			std::pair<ResLoadingDescPtr, std::shared_ptr<volatile LoadingStatus>> res_pair;
-			while (loading_res_queue_.pop(res_pair))
+			if (LS_Loading == *request.status)
 			{
-				if (LS_Loading == *res_pair.second)
+				if (request.tokens->TryDrop())
 				{
-					res_pair.first->SubThreadStage();
-					*res_pair.second = LS_Complete;
+					*request.status = LS_Cancelled;
+				}
+				else
+				{
+					KLAYGE_PERF_ZONE("ResLoader::SubThreadStage");
+
+					request.res_desc->SubThreadStage();
+					*request.status = LS_Complete;
 				}
 			}
 
-			Sleep(10);
+			request = LoadingRes();
 		}
 	}
 
@@ -771,6 +997,64 @@ namespace KlayGE
 		return res;
 	}
 
+	ResIdentifierPtr ResLoader::OpenStoredPkt(std::string const & name, std::string const & res_name)
+	{
+		std::string::size_type const pkt_offset(res_name.find("//"));
+		if (pkt_offset == std::string::npos)
+		{
+			return ResIdentifierPtr();
+		}
+
+		std::string const pkt_name = res_name.substr(0, pkt_offset);
+		if (pkt_name.find("|") != std::string::npos)
+		{
+			// Only 7z packages can have a password
+			return ResIdentifierPtr();
+		}
+
+		StoredPackagePtr pkg;
+		{
+			std::lock_guard<std::mutex> lock(stored_pkgs_mutex_);
+			auto iter = stored_pkgs_.find(pkt_name);
+			if (iter == stored_pkgs_.end())
+			{
+				std::filesystem::path pkt_path(pkt_name);
+				if (std::filesystem::exists(pkt_path)
+					&& (std::filesystem::is_regular_file(pkt_path)
+						|| std::filesystem::is_symlink(pkt_path)))
+				{
+					pkg = MakeSharedPtr<StoredPackage>(pkt_name);
+					if (!pkg->Valid())
+					{
+						pkg.reset();
+					}
+				}
+				stored_pkgs_.emplace(pkt_name, pkg);
+			}
+			else
+			{
+				pkg = iter->second;
+			}
+		}
+
+		if (pkg)
+		{
+			ArrayRef<uint8_t> const data = pkg->Find(res_name.substr(pkt_offset + 2));
+			if (!data.empty())
+			{
+				std::filesystem::path pkt_path(pkt_name);
+#if defined(KLAYGE_CXX17_LIBRARY_FILESYSTEM_SUPPORT) || defined(KLAYGE_TS_LIBRARY_FILESYSTEM_SUPPORT)
+				uint64_t timestamp = std::filesystem::last_write_time(pkt_path).time_since_epoch().count();
+#else
+				uint64_t timestamp = std::filesystem::last_write_time(pkt_path);
+#endif
+				return MakeSharedPtr<ResIdentifier>(name, timestamp, pkg->Mapping(), data);
+			}
+		}
+
+		return ResIdentifierPtr();
+	}
+
 #if defined(KLAYGE_PLATFORM_ANDROID)
 	AAsset* ResLoader::LocateFileAndroid(std::string const & name)
 	{
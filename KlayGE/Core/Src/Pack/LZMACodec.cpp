@@ -33,6 +33,7 @@
 #include <KlayGE/ResLoader.hpp>
 #include <KFL/DllLoader.hpp>
 #include <KFL/Thread.hpp>
+#include <KlayGE/Context.hpp>
 
 #include <cstring>
 
@@ -113,6 +114,52 @@ namespace
 		static std::unique_ptr<LZMALoader> instance_;
 	};
 	std::unique_ptr<LZMALoader> LZMALoader::instance_;
+
+	uint32_t const CHUNKED_VERSION = 1;
+
+	struct ChunkedHeader
+	{
+		uint32_t fourcc;
+		uint32_t version;
+		uint32_t chunk_size;
+		uint32_t num_chunks;
+		uint64_t original_len;
+	};
+
+	// Layout: ChunkedHeader, num_chunks * uint64_t end offsets of the compressed chunks (relative to the first chunk),
+	//  then the chunks themselves. Every chunk but the last one decodes to exactly chunk_size bytes.
+	ChunkedHeader ReadChunkedHeader(uint8_t const * p, uint64_t len)
+	{
+		if (len < sizeof(ChunkedHeader))
+		{
+			TERRC(std::errc::illegal_byte_sequence);
+		}
+
+		ChunkedHeader header;
+		std::memcpy(&header, p, sizeof(header));
+		header.fourcc = LE2Native(header.fourcc);
+		header.version = LE2Native(header.version);
+		header.chunk_size = LE2Native(header.chunk_size);
+		header.num_chunks = LE2Native(header.num_chunks);
+		header.original_len = LE2Native(header.original_len);
+
+		if ((header.fourcc != MakeFourCC<'L', 'Z', 'M', 'C'>::value) || (header.version != CHUNKED_VERSION)
+			|| (0 == header.chunk_size)
+			|| (len < sizeof(ChunkedHeader) + header.num_chunks * sizeof(uint64_t))
+			|| (header.num_chunks != (header.original_len + header.chunk_size - 1) / header.chunk_size))
+		{
+			TERRC(std::errc::illegal_byte_sequence);
+		}
+
+		return header;
+	}
+
+	uint64_t ChunkEnd(uint8_t const * p, uint32_t index)
+	{
+		uint64_t end;
+		std::memcpy(&end, p + sizeof(ChunkedHeader) + index * sizeof(end), sizeof(end));
+		return LE2Native(end);
+	}
 }
 
 namespace KlayGE
@@ -205,14 +252,157 @@ namespace KlayGE
 	{
 		uint8_t const * p = static_cast<uint8_t const *>(input);
 
-		std::vector<uint8_t> in_data(static_cast<size_t>(len));
-		std::memcpy(&in_data[0], p, static_cast<std::streamsize>(in_data.size()));
-
 		SizeT s_out_len = static_cast<SizeT>(original_len);
 
 		SizeT s_src_len = static_cast<SizeT>(len - LZMA_PROPS_SIZE);
-		int res = LZMALoader::Instance().LzmaUncompress(static_cast<Byte*>(output), &s_out_len, &in_data[LZMA_PROPS_SIZE], &s_src_len,
-			&in_data[0], LZMA_PROPS_SIZE);
+		int res = LZMALoader::Instance().LzmaUncompress(static_cast<Byte*>(output), &s_out_len, p + LZMA_PROPS_SIZE, &s_src_len,
+			p, LZMA_PROPS_SIZE);
 		Verify(0 == res);
 	}
+
+	void LZMACodec::EncodeChunked(std::vector<uint8_t>& output, void const * input, uint64_t len, uint32_t chunk_size)
+	{
+		BOOST_ASSERT(chunk_size > 0);
+
+		uint8_t const * p = static_cast<uint8_t const *>(input);
+		uint32_t const num_chunks = static_cast<uint32_t>((len + chunk_size - 1) / chunk_size);
+
+		// Make sure the DLL is loaded before the workers hit it
+		LZMALoader::Instance();
+
+		std::vector<std::vector<uint8_t>> chunks(num_chunks);
+		Context::Instance().TaskScheduler().parallel_for(0, num_chunks, 1,
+			[this, p, len, chunk_size, &chunks](size_t range_begin, size_t range_end)
+			{
+				for (size_t i = range_begin; i < range_end; ++ i)
+				{
+					uint64_t const offset = i * static_cast<uint64_t>(chunk_size);
+					this->Encode(chunks[i], p + offset, std::min<uint64_t>(len - offset, chunk_size));
+				}
+			});
+
+		size_t const index_size = sizeof(ChunkedHeader) + num_chunks * sizeof(uint64_t);
+		size_t total_size = index_size;
+		for (auto const & chunk : chunks)
+		{
+			total_size += chunk.size();
+		}
+		output.resize(total_size);
+
+		ChunkedHeader header;
+		header.fourcc = Native2LE(MakeFourCC<'L', 'Z', 'M', 'C'>::value);
+		header.version = Native2LE(CHUNKED_VERSION);
+		header.chunk_size = Native2LE(chunk_size);
+		header.num_chunks = Native2LE(num_chunks);
+		header.original_len = Native2LE(len);
+		std::memcpy(&output[0], &header, sizeof(header));
+
+		uint64_t end = 0;
+		uint8_t* dst = &output[index_size];
+		for (uint32_t i = 0; i < num_chunks; ++ i)
+		{
+			std::memcpy(dst, chunks[i].data(), chunks[i].size());
+			dst += chunks[i].size();
+
+			end += chunks[i].size();
+			uint64_t const le_end = Native2LE(end);
+			std::memcpy(&output[sizeof(ChunkedHeader) + i * sizeof(le_end)], &le_end, sizeof(le_end));
+		}
+	}
+
+	uint64_t LZMACodec::EncodeChunked(std::ostream& os, void const * input, uint64_t len, uint32_t chunk_size)
+	{
+		std::vector<uint8_t> output;
+		this->EncodeChunked(output, input, len, chunk_size);
+		os.write(reinterpret_cast<char*>(&output[0]), output.size() * sizeof(output[0]));
+		return output.size();
+	}
+
+	uint64_t LZMACodec::ChunkedOriginalLength(void const * input, uint64_t len)
+	{
+		return ReadChunkedHeader(static_cast<uint8_t const *>(input), len).original_len;
+	}
+
+	void LZMACodec::DecodeChunked(std::vector<uint8_t>& output, ResIdentifierPtr const & is, uint64_t len)
+	{
+		std::vector<uint8_t> in_data(static_cast<size_t>(len));
+		is->read(&in_data[0], static_cast<size_t>(len));
+
+		this->DecodeChunked(output, &in_data[0], len);
+	}
+
+	void LZMACodec::DecodeChunked(std::vector<uint8_t>& output, void const * input, uint64_t len)
+	{
+		output.resize(static_cast<size_t>(this->ChunkedOriginalLength(input, len)));
+		this->DecodeChunked(output.data(), input, len);
+	}
+
+	void LZMACodec::DecodeChunked(void* output, void const * input, uint64_t len)
+	{
+		this->DecodeChunkedRange(output, input, len, 0, this->ChunkedOriginalLength(input, len));
+	}
+
+	void LZMACodec::DecodeChunkedRange(void* output, void const * input, uint64_t len, uint64_t offset, uint64_t size)
+	{
+		uint8_t const * p = static_cast<uint8_t const *>(input);
+		ChunkedHeader const header = ReadChunkedHeader(p, len);
+		if (offset + size > header.original_len)
+		{
+			TERRC(std::errc::invalid_argument);
+		}
+		if (0 == size)
+		{
+			return;
+		}
+
+		uint64_t const chunk_size = header.chunk_size;
+		uint8_t const * chunk_data = p + sizeof(ChunkedHeader) + header.num_chunks * sizeof(uint64_t);
+		uint64_t const data_len = len - (chunk_data - p);
+		uint64_t prev_end = 0;
+		for (uint32_t i = 0; i < header.num_chunks; ++ i)
+		{
+			// Every chunk holds at least the LZMA props, and the ends can't go backwards or past the data
+			uint64_t const end = ChunkEnd(p, i);
+			if ((end < prev_end + LZMA_PROPS_SIZE) || (end > data_len))
+			{
+				TERRC(std::errc::illegal_byte_sequence);
+			}
+			prev_end = end;
+		}
+
+		uint32_t const first_chunk = static_cast<uint32_t>(offset / chunk_size);
+		uint32_t const last_chunk = static_cast<uint32_t>((offset + size - 1) / chunk_size);
+
+		LZMALoader::Instance();
+
+		uint8_t* dst = static_cast<uint8_t*>(output);
+		Context::Instance().TaskScheduler().parallel_for(first_chunk, last_chunk + 1, 1,
+			[this, p, chunk_data, &header, chunk_size, offset, size, dst](size_t range_begin, size_t range_end)
+			{
+				std::vector<uint8_t> partial;
+				for (size_t i = range_begin; i < range_end; ++ i)
+				{
+					uint32_t const index = static_cast<uint32_t>(i);
+					uint64_t const comp_begin = (0 == index) ? 0 : ChunkEnd(p, index - 1);
+					uint64_t const comp_end = ChunkEnd(p, index);
+					uint64_t const chunk_begin = index * chunk_size;
+					uint64_t const chunk_len = std::min(header.original_len - chunk_begin, chunk_size);
+
+					uint64_t const copy_begin = std::max(offset, chunk_begin);
+					uint64_t const copy_end = std::min(offset + size, chunk_begin + chunk_len);
+					if ((copy_begin == chunk_begin) && (copy_end == chunk_begin + chunk_len))
+					{
+						// Whole chunk wanted, decode in place
+						this->Decode(dst + (chunk_begin - offset), chunk_data + comp_begin, comp_end - comp_begin, chunk_len);
+					}
+					else
+					{
+						partial.resize(static_cast<size_t>(chunk_len));
+						this->Decode(partial.data(), chunk_data + comp_begin, comp_end - comp_begin, chunk_len);
+						std::memcpy(dst + (copy_begin - offset), &partial[static_cast<size_t>(copy_begin - chunk_begin)],
+							static_cast<size_t>(copy_end - copy_begin));
+					}
+				}
+			});
+	}
 }
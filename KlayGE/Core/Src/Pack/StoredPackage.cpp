@@ -0,0 +1,198 @@
+/**
+ * @file StoredPackage.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/ErrorHandling.hpp>
+#include <KFL/MappedFile.hpp>
+#include <KFL/Util.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include <KlayGE/StoredPackage.hpp>
+
+namespace
+{
+	using namespace KlayGE;
+
+	uint32_t const STORED_PACKAGE_VERSION = 1;
+	uint64_t const STORED_PACKAGE_ALIGNMENT = 16;
+
+	template <typename T>
+	bool ReadValue(ArrayRef<uint8_t> data, uint64_t& offset, T& value)
+	{
+		if (offset + sizeof(value) > data.size())
+		{
+			return false;
+		}
+
+		std::memcpy(&value, data.data() + offset, sizeof(value));
+		value = LE2Native(value);
+		offset += sizeof(value);
+		return true;
+	}
+}
+
+namespace KlayGE
+{
+	StoredPackage::StoredPackage(std::string const & pkg_name)
+		: mapping_(MakeSharedPtr<MappedFile>()), valid_(false)
+	{
+		if (!mapping_->Map(pkg_name))
+		{
+			return;
+		}
+
+		ArrayRef<uint8_t> const data = mapping_->Data();
+		uint64_t offset = 0;
+
+		uint32_t fourcc;
+		uint32_t ver;
+		uint32_t num_files;
+		if (!ReadValue(data, offset, fourcc) || (fourcc != MakeFourCC<'K', 'P', 'K', 'G'>::value)
+			|| !ReadValue(data, offset, ver) || (ver != STORED_PACKAGE_VERSION)
+			|| !ReadValue(data, offset, num_files))
+		{
+			return;
+		}
+
+		files_.reserve(num_files);
+		for (uint32_t i = 0; i < num_files; ++ i)
+		{
+			uint32_t name_len;
+			if (!ReadValue(data, offset, name_len) || (name_len > data.size() - offset))
+			{
+				files_.clear();
+				return;
+			}
+			std::string name(reinterpret_cast<char const *>(data.data() + offset), name_len);
+			offset += name_len;
+
+			uint64_t file_offset;
+			uint64_t file_size;
+			if (!ReadValue(data, offset, file_offset) || !ReadValue(data, offset, file_size)
+				|| (file_offset > data.size()) || (file_size > data.size() - file_offset))
+			{
+				files_.clear();
+				return;
+			}
+
+			files_.emplace(std::move(name), std::make_pair(file_offset, file_size));
+		}
+
+		valid_ = true;
+	}
+
+	ArrayRef<uint8_t> StoredPackage::Find(std::string_view name) const
+	{
+		auto iter = files_.find(std::string(name));
+		if (iter != files_.end())
+		{
+			return ArrayRef<uint8_t>(mapping_->Data().data() + iter->second.first, static_cast<size_t>(iter->second.second));
+		}
+		return ArrayRef<uint8_t>();
+	}
+
+	void StoredPackage::Save(std::string const & pkg_name, std::vector<std::string> const & internal_names,
+		std::vector<std::string> const & file_names)
+	{
+		BOOST_ASSERT(internal_names.size() == file_names.size());
+
+		uint32_t const num_files = static_cast<uint32_t>(file_names.size());
+
+		uint64_t header_size = sizeof(uint32_t) * 3;
+		for (auto const & name : internal_names)
+		{
+			header_size += sizeof(uint32_t) + name.size() + sizeof(uint64_t) * 2;
+		}
+
+		std::vector<std::ifstream> inputs(num_files);
+		std::vector<uint64_t> offsets(num_files);
+		std::vector<uint64_t> sizes(num_files);
+		uint64_t offset = header_size;
+		for (uint32_t i = 0; i < num_files; ++ i)
+		{
+			inputs[i].open(file_names[i].c_str(), std::ios_base::binary);
+			if (!inputs[i])
+			{
+				TERRC(std::errc::no_such_file_or_directory);
+			}
+			inputs[i].seekg(0, std::ios_base::end);
+			sizes[i] = inputs[i].tellg();
+			inputs[i].seekg(0, std::ios_base::beg);
+
+			offset = (offset + STORED_PACKAGE_ALIGNMENT - 1) & ~(STORED_PACKAGE_ALIGNMENT - 1);
+			offsets[i] = offset;
+			offset += sizes[i];
+		}
+
+		std::ofstream ofs(pkg_name.c_str(), std::ios_base::binary);
+		if (!ofs)
+		{
+			TERRC(std::errc::permission_denied);
+		}
+
+		uint32_t fourcc = Native2LE(MakeFourCC<'K', 'P', 'K', 'G'>::value);
+		ofs.write(reinterpret_cast<char const *>(&fourcc), sizeof(fourcc));
+		uint32_t ver = Native2LE(STORED_PACKAGE_VERSION);
+		ofs.write(reinterpret_cast<char const *>(&ver), sizeof(ver));
+		uint32_t num = Native2LE(num_files);
+		ofs.write(reinterpret_cast<char const *>(&num), sizeof(num));
+		for (uint32_t i = 0; i < num_files; ++ i)
+		{
+			uint32_t name_len = Native2LE(static_cast<uint32_t>(internal_names[i].size()));
+			ofs.write(reinterpret_cast<char const *>(&name_len), sizeof(name_len));
+			ofs.write(internal_names[i].data(), internal_names[i].size());
+			uint64_t file_offset = Native2LE(offsets[i]);
+			ofs.write(reinterpret_cast<char const *>(&file_offset), sizeof(file_offset));
+			uint64_t file_size = Native2LE(sizes[i]);
+			ofs.write(reinterpret_cast<char const *>(&file_size), sizeof(file_size));
+		}
+
+		std::vector<char> buffer(1024 * 1024);
+		uint64_t pos = header_size;
+		for (uint32_t i = 0; i < num_files; ++ i)
+		{
+			std::fill(buffer.begin(), buffer.begin() + static_cast<size_t>(offsets[i] - pos), '\0');
+			ofs.write(buffer.data(), static_cast<std::streamsize>(offsets[i] - pos));
+
+			uint64_t remaining = sizes[i];
+			while (remaining > 0)
+			{
+				std::streamsize const n = static_cast<std::streamsize>(std::min<uint64_t>(remaining, buffer.size()));
+				inputs[i].read(buffer.data(), n);
+				ofs.write(buffer.data(), n);
+				remaining -= n;
+			}
+			pos = offsets[i] + sizes[i];
+		}
+	}
+}
@@ -32,6 +32,7 @@
 #include <KFL/ErrorHandling.hpp>
 #include <KFL/Util.hpp>
 #include <KFL/Math.hpp>
+#include <KFL/SIMDMath.hpp>
 #include <KlayGE/ResLoader.hpp>
 #include <KlayGE/Renderable.hpp>
 #include <KlayGE/RenderableHelper.hpp>
@@ -1520,19 +1521,7 @@ namespace KlayGE
 				pvp.g_buffer_enables[PTB_TransparencyFront]
 					= (pvp.attrib & VPAM_NoTransparencyFront) ? false : has_transparency_front_objs;
 
-				pvp.light_visibles.resize(lights_.size());
-				for (uint32_t li = 0; li < lights_.size(); ++ li)
-				{
-					auto const & light = *lights_[li];
-					if (light.Enabled())
-					{
-						this->CheckLightVisible(vpi, li);
-					}
-					else
-					{
-						pvp.light_visibles[li] = false;
-					}
-				}
+				this->CheckLightsVisible(vpi);
 
 				for (uint32_t i = PTB_Opaque; i < PTB_None; ++ i)
 				{
@@ -1615,40 +1604,73 @@ namespace KlayGE
 #endif
 	}
 
-	void DeferredRenderingLayer::CheckLightVisible(uint32_t vp_index, uint32_t light_index)
+	void DeferredRenderingLayer::CheckLightsVisible(uint32_t vp_index)
 	{
 		SceneManager& scene_mgr = Context::Instance().SceneManagerInstance();
 
 		PerViewport& pvp = viewports_[vp_index];
-		auto const & light = *lights_[light_index];
-
-		float light_scale = std::min(light.Range() * 0.01f, 1.0f) * light_scale_;
-		switch (light.Type())
+		pvp.light_visibles.assign(lights_.size(), false);
+
+		// Spot lights are bounded by the cone, point and area lights by the box. The bounds of each kind are
+		//  transformed in one batch.
+		std::vector<float4x4> cone_models;
+		std::vector<uint32_t> cone_lights;
+		std::vector<float4x4> box_models;
+		std::vector<uint32_t> box_lights;
+		for (uint32_t li = 0; li < lights_.size(); ++ li)
 		{
-		case LightSource::LT_Spot:
+			auto const & light = *lights_[li];
+			if (!light.Enabled())
 			{
-				float4x4 const & inv_light_view = light.SMCamera(0)->InverseViewMatrix();
-				float const scale = light.CosOuterInner().w();
-				float4x4 mat = MathLib::scaling(scale * light_scale, scale * light_scale, light_scale);
-				float4x4 light_model = mat * inv_light_view;
-				pvp.light_visibles[light_index] = (scene_mgr.AABBVisible(MathLib::transform_aabb(cone_aabb_, light_model)) != BO_No);
+				continue;
 			}
-			break;
 
-		case LightSource::LT_Point:
-		case LightSource::LT_SphereArea:
-		case LightSource::LT_TubeArea:
+			float light_scale = std::min(light.Range() * 0.01f, 1.0f) * light_scale_;
+			switch (light.Type())
 			{
-				float3 const & p = light.Position();
-				float4x4 light_model = MathLib::scaling(light_scale, light_scale, light_scale)
-					* MathLib::translation(p);
-				pvp.light_visibles[light_index] = (scene_mgr.AABBVisible(MathLib::transform_aabb(box_aabb_, light_model)) != BO_No);
+			case LightSource::LT_Spot:
+				{
+					float4x4 const & inv_light_view = light.SMCamera(0)->InverseViewMatrix();
+					float const scale = light.CosOuterInner().w();
+					float4x4 mat = MathLib::scaling(scale * light_scale, scale * light_scale, light_scale);
+					cone_models.push_back(mat * inv_light_view);
+					cone_lights.push_back(li);
+				}
+				break;
+
+			case LightSource::LT_Point:
+			case LightSource::LT_SphereArea:
+			case LightSource::LT_TubeArea:
+				{
+					float3 const & p = light.Position();
+					box_models.push_back(MathLib::scaling(light_scale, light_scale, light_scale)
+						* MathLib::translation(p));
+					box_lights.push_back(li);
+				}
+				break;
+
+			default:
+				pvp.light_visibles[li] = true;
+				break;
 			}
-			break;
+		}
 
-		default:
-			pvp.light_visibles[light_index] = true;
-			break;
+		std::vector<AABBox> bounds(std::max(cone_models.size(), box_models.size()));
+		if (!cone_models.empty())
+		{
+			SIMDMathLib::TransformAABBs(&bounds[0], cone_aabb_, &cone_models[0], cone_models.size());
+			for (size_t i = 0; i < cone_lights.size(); ++ i)
+			{
+				pvp.light_visibles[cone_lights[i]] = (scene_mgr.AABBVisible(bounds[i]) != BO_No);
+			}
+		}
+		if (!box_models.empty())
+		{
+			SIMDMathLib::TransformAABBs(&bounds[0], box_aabb_, &box_models[0], box_models.size());
+			for (size_t i = 0; i < box_lights.size(); ++ i)
+			{
+				pvp.light_visibles[box_lights[i]] = (scene_mgr.AABBVisible(bounds[i]) != BO_No);
+			}
 		}
 	}
 
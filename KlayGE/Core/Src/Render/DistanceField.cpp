@@ -29,8 +29,39 @@
  */
 
 #include <KlayGE/KlayGE.hpp>
+#include <KFL/SIMDMath.hpp>
+#include <KFL/SIMDVector.hpp>
+#include <KFL/AlignedAllocator.hpp>
+#include <KFL/Thread.hpp>
+#include <KlayGE/Context.hpp>
+
+#include <algorithm>
+#include <limits>
+
 #include <KlayGE/DistanceField.hpp>
 
+namespace
+{
+	using namespace KlayGE;
+
+	uint32_t const INVALID_SITE = 0xFFFFFFFFU;
+	size_t const MIN_PARALLEL_EDT_PIXELS = 128 * 128;
+	size_t const EDT_PIXELS_PER_TASK = 16 * 1024;
+
+	struct EDTLineScratch
+	{
+		explicit EDTLineScratch(uint32_t n)
+			: f(n), sites(n), v(n), z(n)
+		{
+		}
+
+		std::vector<uint32_t> f;
+		std::vector<uint32_t> sites;
+		std::vector<uint32_t> v;
+		std::vector<double> z;
+	};
+}
+
 namespace KlayGE
 {
 	float EdgeDistance(float2 const & grad, float val)
@@ -65,127 +96,197 @@ namespace KlayGE
 		return df;
 	}
 
-	float AADist(std::vector<float> const & img, std::vector<float2> const & grad,
-		int width, int offset_addr, int2 const & offset_dist_xy, float2 const & new_dist)
+	// Felzenszwalb and Huttenlocher's lower envelope of parabolas along one line. dist_sq holds the squared distance
+	// accumulated over the previous axes, sites the seed it belongs to. Lines without any seed are left untouched.
+	// Squared distances are integers, the parabola heights are kept exact in 64-bit and only the intersections are
+	// divided, in double.
+	void SquaredDistanceLine(uint32_t* dist_sq, uint32_t* sites, uint32_t n, uint32_t stride, EDTLineScratch& scratch)
 	{
-		int closest = offset_addr - offset_dist_xy.y() * width - offset_dist_xy.x(); // Index to the edge pixel pointed to from c
-		float val = MathLib::clamp(img[closest], 0.0f, 1.0f);
-		if (0 == val)
+		int k = -1;
+		for (uint32_t q = 0; q < n; ++ q)
 		{
-			return 1e10f;
+			scratch.f[q] = dist_sq[q * stride];
+			scratch.sites[q] = sites[q * stride];
+			if (scratch.sites[q] == INVALID_SITE)
+			{
+				continue;
+			}
+
+			int64_t const fq = static_cast<int64_t>(scratch.f[q]) + static_cast<int64_t>(q) * q;
+			double s = -std::numeric_limits<double>::max();
+			while (k >= 0)
+			{
+				uint32_t const vk = scratch.v[k];
+				int64_t const fvk = static_cast<int64_t>(scratch.f[vk]) + static_cast<int64_t>(vk) * vk;
+				s = static_cast<double>(fq - fvk) / (2.0 * (q - vk));
+				if (s > scratch.z[k])
+				{
+					break;
+				}
+				-- k;
+			}
+			if (k < 0)
+			{
+				s = -std::numeric_limits<double>::max();
+			}
+
+			++ k;
+			scratch.v[k] = q;
+			scratch.z[k] = s;
 		}
 
-		float di = MathLib::length(new_dist);
-		float df;
-		if (0 == di)
+		if (k < 0)
 		{
-			df = EdgeDistance(grad[closest], val);
+			return;
 		}
-		else
+
+		uint32_t const num_parabolas = k + 1;
+		uint32_t j = 0;
+		for (uint32_t q = 0; q < n; ++ q)
 		{
-			df = EdgeDistance(new_dist, val);
+			while ((j + 1 < num_parabolas) && (scratch.z[j + 1] < q))
+			{
+				++ j;
+			}
+
+			uint32_t const vj = scratch.v[j];
+			uint32_t const d = (q > vj) ? (q - vj) : (vj - q);
+			dist_sq[q * stride] = d * d + scratch.f[vj];
+			sites[q * stride] = scratch.sites[vj];
 		}
-		return di + df;
 	}
 
-	bool UpdateDistance(int x, int y, int dx, int dy, std::vector<float> const & img, int width,
-		std::vector<float2> const & grad, std::vector<int2>& dist_xy, std::vector<float>& dist)
+	// Runs the 1D transform over every line along one axis. Lines are independent, so they are spread over the task
+	// scheduler. n is the length of the axis, stride the distance between two of its elements.
+	void SquaredDistanceAxis(std::vector<uint32_t>& dist_sq, std::vector<uint32_t>& sites, uint32_t n, uint32_t stride)
 	{
-		float const EPSILON = 1e-3f;
+		size_t const num_lines = dist_sq.size() / n;
 
-		bool changed = false;
-		int addr = y * width + x;
-		float old_dist = dist[addr];
-		if (old_dist > 0)
+		auto transform_lines = [&dist_sq, &sites, n, stride](size_t line_begin, size_t line_end)
 		{
-			int offset_addr = (y + dy) * width + (x + dx);
-			int2 new_dist_xy = dist_xy[offset_addr] - int2(dx, dy);
-			float new_dist = AADist(img, grad, width, offset_addr, dist_xy[offset_addr], new_dist_xy);
-			if (new_dist < old_dist - EPSILON)
+			EDTLineScratch scratch(n);
+			for (size_t line = line_begin; line < line_end; ++ line)
 			{
-				dist_xy[addr] = new_dist_xy;
-				dist[addr] = new_dist;
-				changed = true;
+				size_t const start = line / stride * stride * n + line % stride;
+				SquaredDistanceLine(&dist_sq[start], &sites[start], n, stride, scratch);
 			}
+		};
+
+		if (dist_sq.size() < MIN_PARALLEL_EDT_PIXELS)
+		{
+			transform_lines(0, num_lines);
+		}
+		else
+		{
+			Context::Instance().TaskScheduler().parallel_for(0, num_lines, std::max<size_t>(EDT_PIXELS_PER_TASK / n, 1),
+				transform_lines);
 		}
+	}
 
-		return changed;
+	// Separable exact EDT. Seeds come in with 0 distance and their own index as site, everything else with
+	// INVALID_SITE. On return each element has the squared distance to, and the index of, its nearest seed.
+	void NearestSites(std::vector<uint32_t>& dist_sq, std::vector<uint32_t>& sites,
+		uint32_t width, uint32_t height, uint32_t depth)
+	{
+		BOOST_ASSERT(dist_sq.size() == static_cast<size_t>(width) * height * depth);
+		BOOST_ASSERT(sites.size() == dist_sq.size());
+
+		SquaredDistanceAxis(dist_sq, sites, width, 1);
+		if (height > 1)
+		{
+			SquaredDistanceAxis(dist_sq, sites, height, width);
+		}
+		if (depth > 1)
+		{
+			SquaredDistanceAxis(dist_sq, sites, depth, width * height);
+		}
 	}
 
+	// Anti-aliased EDT in linear time. The nearest covered pixel is found by the separable EDT, then the sub-pixel
+	// edge position inside it is recovered from its coverage, as in Gustavson and Strand's AA sweep. The nearest pixel
+	// center isn't always the nearest edge, so each pixel also tries the sites of its 8 neighbors, twice over, which
+	// stands in for the propagation of their sweeps.
 	void AAEuclideanDistance(std::vector<float> const & img, std::vector<float2> const & grad,
-		int width, int height, std::vector<float>& dist)
+		int width, int height, float* dist)
 	{
-		std::vector<int2> dist_xy(img.size(), int2(0, 0));
-
+		std::vector<uint32_t> dist_sq(img.size(), 0);
+		std::vector<uint32_t> sites(img.size());
 		for (size_t i = 0; i < img.size(); ++ i)
 		{
-			if (img[i] <= 0)
+			sites[i] = (img[i] > 0) ? static_cast<uint32_t>(i) : INVALID_SITE;
+		}
+
+		NearestSites(dist_sq, sites, width, height, 1);
+
+		auto site_distance = [&img, &grad, width](int x, int y, uint32_t site)
+		{
+			uint32_t const addr = static_cast<uint32_t>(y * width + x);
+			if (site == INVALID_SITE)
 			{
-				dist[i] = 1e10f;
+				return 1e10f;
 			}
-			else if (img[i] < 1)
+			else if (site == addr)
 			{
-				dist[i] = EdgeDistance(grad[i], img[i]);
+				return (img[addr] < 1) ? EdgeDistance(grad[addr], img[addr]) : 0;
 			}
 			else
 			{
-				dist[i] = 0;
+				float2 const offset(static_cast<float>(x - static_cast<int>(site % width)),
+					static_cast<float>(y - static_cast<int>(site / width)));
+				float const val = MathLib::clamp(img[site], 0.0f, 1.0f);
+				return MathLib::length(offset) + EdgeDistance(offset, val);
 			}
-		}
+		};
 
-		bool changed;
-		do
+		std::vector<uint32_t> refined_sites(sites.size());
+		std::vector<uint32_t> const * src_sites = &sites;
+		std::vector<uint32_t>* dst_sites = &refined_sites;
+		auto resolve_rows = [&src_sites, &dst_sites, width, height, dist, &site_distance](size_t row_begin, size_t row_end)
 		{
-			changed = false;
-
-			for (int y = 1; y < height; ++ y)
+			for (int y = static_cast<int>(row_begin); y < static_cast<int>(row_end); ++ y)
 			{
-				// Scan right, propagate distances from above & left
 				for (int x = 0; x < width; ++ x)
 				{
-					if (x > 0)
+					uint32_t const addr = static_cast<uint32_t>(y * width + x);
+					uint32_t best_site = (*src_sites)[addr];
+					float d = site_distance(x, y, best_site);
+					for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, height - 1); ++ ny)
 					{
-						changed |= UpdateDistance(x, y, -1, +0, img, width, grad, dist_xy, dist);
-						changed |= UpdateDistance(x, y, -1, -1, img, width, grad, dist_xy, dist);
+						for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, width - 1); ++ nx)
+						{
+							uint32_t const neighbor_site = (*src_sites)[ny * width + nx];
+							if (neighbor_site != best_site)
+							{
+								float const neighbor_d = site_distance(x, y, neighbor_site);
+								if (neighbor_d < d)
+								{
+									d = neighbor_d;
+									best_site = neighbor_site;
+								}
+							}
+						}
 					}
-					changed |= UpdateDistance(x, y, +0, -1, img, width, grad, dist_xy, dist);
-					if (x < width - 1)
-					{
-						changed |= UpdateDistance(x, y, +1, -1, img, width, grad, dist_xy, dist);
-					}
-				}
-
-				// Scan left, propagate distance from right
-				for (int x = width - 2; x >= 0; -- x)
-				{
-					changed |= UpdateDistance(x, y, +1, +0, img, width, grad, dist_xy, dist);
+					(*dst_sites)[addr] = best_site;
+					dist[addr] = d;
 				}
 			}
+		};
 
-			for (int y = height - 2; y >= 0; -- y)
+		for (int pass = 0; pass < 2; ++ pass)
+		{
+			if (img.size() < MIN_PARALLEL_EDT_PIXELS)
 			{
-				// Scan left, propagate distances from below & right
-				for (int x = width - 1; x >= 0; -- x)
-				{
-					if (x < width - 1)
-					{
-						changed |= UpdateDistance(x, y, +1, +0, img, width, grad, dist_xy, dist);
-						changed |= UpdateDistance(x, y, +1, +1, img, width, grad, dist_xy, dist);
-					}
-					changed |= UpdateDistance(x, y, +0, +1, img, width, grad, dist_xy, dist);
-					if (x > 0)
-					{
-						changed |= UpdateDistance(x, y, -1, +1, img, width, grad, dist_xy, dist);
-					}
-				}
-
-				// Scan right, propagate distance from left
-				for (int x = 1; x < width; ++ x)
-				{
-					changed |= UpdateDistance(x, y, -1, +0, img, width, grad, dist_xy, dist);
-				}
+				resolve_rows(0, height);
 			}
-		} while (changed);
+			else
+			{
+				Context::Instance().TaskScheduler().parallel_for(0, height, std::max<size_t>(EDT_PIXELS_PER_TASK / width, 1),
+					resolve_rows);
+			}
+
+			src_sites = dst_sites;
+			dst_sites = &sites;
+		}
 	}
 
 	template KLAYGE_CORE_API void Downsample2x(std::vector<float> const & input_data, uint32_t input_width, uint32_t input_height,
@@ -251,8 +352,10 @@ namespace KlayGE
 		std::vector<float2> grad_data(aa_data.size());
 		Downsample2x(grad_2x_data, input_width, input_height, grad_data);
 
-		std::vector<float> outside(grad_data.size());
-		AAEuclideanDistance(aa_data, grad_data, input_width / 2, input_height / 2, outside);
+		// Padded to whole SIMD vectors for the final combine
+		size_t const num_pixels = aa_data.size();
+		std::vector<float, aligned_allocator<float, 16>> outside((num_pixels + 3) & ~static_cast<size_t>(3), 0.0f);
+		AAEuclideanDistance(aa_data, grad_data, input_width / 2, input_height / 2, &outside[0]);
 
 		for (size_t i = 0; i < grad_data.size(); ++ i)
 		{
@@ -260,22 +363,38 @@ namespace KlayGE
 			grad_data[i] = -grad_data[i];
 		}
 
-		std::vector<float> inside(grad_data.size());
-		AAEuclideanDistance(aa_data, grad_data, input_width / 2, input_height / 2, inside);
+		std::vector<float, aligned_allocator<float, 16>> inside(outside.size(), 0.0f);
+		AAEuclideanDistance(aa_data, grad_data, input_width / 2, input_height / 2, &inside[0]);
 
-		dist_data.resize(outside.size());
-		for (uint32_t i = 0; i < outside.size(); ++ i)
+		SIMDVectorF4 const zero = SIMDMathLib::SetVector(0.0f);
+		for (size_t i = 0; i < inside.size(); i += 4)
 		{
-			if (inside[i] < 0)
-			{
-				inside[i] = 0;
-			}
-			if (outside[i] < 0)
-			{
-				outside[i] = 0;
-			}
+			SIMDVectorF4 const in = SIMDMathLib::Maximize(SIMDMathLib::LoadVector4(&inside[i]), zero);
+			SIMDVectorF4 const out = SIMDMathLib::Maximize(SIMDMathLib::LoadVector4(&outside[i]), zero);
+			SIMDMathLib::StoreVector4(&inside[i], in - out);
+		}
 
-			dist_data[i] = inside[i] - outside[i];
+		dist_data.assign(inside.begin(), inside.begin() + num_pixels);
+	}
+
+	void ComputeVolumeDistance(std::vector<uint8_t> const & volume, uint32_t width, uint32_t height, uint32_t depth,
+		std::vector<float>& dist_data)
+	{
+		BOOST_ASSERT(volume.size() == static_cast<size_t>(width) * height * depth);
+
+		std::vector<uint32_t> dist_sq(volume.size(), 0);
+		std::vector<uint32_t> sites(volume.size());
+		for (size_t i = 0; i < volume.size(); ++ i)
+		{
+			sites[i] = (volume[i] != 0) ? static_cast<uint32_t>(i) : INVALID_SITE;
+		}
+
+		NearestSites(dist_sq, sites, width, height, depth);
+
+		dist_data.resize(volume.size());
+		for (size_t i = 0; i < volume.size(); ++ i)
+		{
+			dist_data[i] = (sites[i] == INVALID_SITE) ? 1e10f : MathLib::sqrt(static_cast<float>(dist_sq[i]));
 		}
 	}
 }
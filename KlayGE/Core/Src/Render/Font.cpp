@@ -46,6 +46,7 @@
 #include <KlayGE/LZMACodec.hpp>
 #include <KlayGE/TransientBuffer.hpp>
 #include <KFL/Hash.hpp>
+#include <KFL/Thread.hpp>
 #include <KlayGE/App3D.hpp>
 #include <KlayGE/Window.hpp>
 
@@ -54,6 +55,7 @@
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <unordered_map>
 #include <tuple>
 #include <type_traits>
@@ -94,9 +96,13 @@ namespace KlayGE
 			RenderDeviceCaps const & caps = renderEngine.DeviceCaps();
 			uint32_t size = std::min<uint32_t>(2048U, std::min<uint32_t>(caps.max_texture_width, caps.max_texture_height)) / kfont_char_size * kfont_char_size;
 			dist_texture_ = rf.MakeTexture2D(size, size, 1, 1, EF_R8, 1, 0, EAH_GPU_Read);
-			a_char_data_.resize(kfont_char_size * kfont_char_size);
+			atlas_data_.resize(size * size, 0);
 
-			char_free_list_.emplace_back(0, size * size / kfont_char_size / kfont_char_size);
+			char_slots_.resize(size * size / kfont_char_size / kfont_char_size);
+			num_used_slots_ = 0;
+			lru_head_ = INVALID_SLOT;
+			lru_tail_ = INVALID_SLOT;
+			this->ResetDirtyRect();
 
 			effect_ = SyncLoadRenderEffect("Font.fxml");
 			*(effect_->ParameterByName("distance_tex")) = dist_texture_;
@@ -540,7 +546,6 @@ namespace KlayGE
 			uint32_t const kfont_char_size = kl.CharSize();
 
 			uint32_t const num_chars_a_row = tex_size / kfont_char_size;
-			uint32_t const num_total_chars = num_chars_a_row * num_chars_a_row;
 
 			for (auto const & ch : text)
 			{
@@ -550,123 +555,215 @@ namespace KlayGE
 					auto cmiter = cim.find(ch);
 					if (cmiter != cim.end())
 					{
-						// ҵ
+						// Cache hit, move the slot to the MRU end
 
-						cmiter->second.tick = tick_;
+						uint32_t const s = cmiter->second.slot;
+						char_slots_[s].tick = tick_;
+						this->MoveSlotToFront(s);
 					}
 					else
 					{
-						// ҲԵ
+						// Cache miss, take a never used slot, or evict the LRU one
 
-						KFont::font_info const & ci = kl.CharInfo(offset);
-
-						uint32_t width = ci.width;
-						uint32_t height = ci.height;
-
-						int2 char_pos;
-						CharInfo charInfo;
-						if (cim.size() < num_total_chars)
+						uint32_t s;
+						if (num_used_slots_ < char_slots_.size())
 						{
-							// пռ
-
-							uint32_t const s = char_free_list_.front().first;
-						
-							char_pos.y() = s / num_chars_a_row;
-							char_pos.x() = s - char_pos.y() * num_chars_a_row;
-
-							char_pos.x() *= kfont_char_size;
-							char_pos.y() *= kfont_char_size;
-
-							charInfo.rc.left() = static_cast<float>(char_pos.x()) / tex_size;
-							charInfo.rc.top() = static_cast<float>(char_pos.y()) / tex_size;
-
-							++ char_free_list_.front().first;
-							if (char_free_list_.front().first == char_free_list_.front().second)
-							{
-								char_free_list_.pop_front();
-							}
+							s = num_used_slots_;
+							++ num_used_slots_;
 						}
 						else
 						{
-							// ҵʹʱûʹõ
-
-							uint64_t min_tick = cim.begin()->second.tick;
-							auto min_chiter = cim.begin();
-							for (auto chiter = cim.begin(); chiter != cim.end(); ++ chiter)
+							s = lru_tail_;
+							if (char_slots_[s].tick == tick_)
 							{
-								if (chiter->second.tick < min_tick)
-								{
-									min_tick = chiter->second.tick;
-									min_chiter = chiter;
-								}
+								// Every slot is taken by this text. The pending glyph in this slot has to reach the texture before
+								// it's overwritten.
+								this->UploadPendingChars();
 							}
 
-							char_pos.x() = static_cast<int32_t>(min_chiter->second.rc.left() * tex_size);
-							char_pos.y() = static_cast<int32_t>(min_chiter->second.rc.top() * tex_size);
-							charInfo.rc.left() = min_chiter->second.rc.left();
-							charInfo.rc.top() = min_chiter->second.rc.top();
-
-							for (auto chiter = cim.begin(); chiter != cim.end(); ++ chiter)
-							{
-								if (chiter->second.tick == min_tick)
-								{
-									uint32_t const x = static_cast<int32_t>(chiter->second.rc.left() * tex_size);
-									uint32_t const y = static_cast<int32_t>(chiter->second.rc.top() * tex_size);
-									uint32_t const id = y * num_chars_a_row + x;
-									auto freeiter = char_free_list_.begin();
-									while ((freeiter != char_free_list_.end()) && (freeiter->second <= id))
-									{
-										++ freeiter;
-									}
-									char_free_list_.emplace(freeiter, id, id + 1);
-
-									cim.erase(chiter);
-									break;
-								}
-							}
-							for (auto freeiter = char_free_list_.begin(); freeiter != char_free_list_.end();)
-							{
-								auto nextiter = freeiter;
-								++ nextiter;
-
-								if (nextiter != char_free_list_.end())
-								{
-									if (freeiter->second == nextiter->first)
-									{
-										freeiter->second = nextiter->second;
-										char_free_list_.erase(nextiter);
-									}
-									else
-									{
-										++ freeiter;
-									}
-								}
-								else
-								{
-									break;
-								}
-							}
+							cim.erase(char_slots_[s].ch);
+							this->UnlinkSlot(s);
 						}
 
-						charInfo.rc.right()		= charInfo.rc.left() + static_cast<float>(width) / tex_size;
-						charInfo.rc.bottom()	= charInfo.rc.top() + static_cast<float>(height) / tex_size;
-						charInfo.tick			= tick_;
+						CharSlot& slot = char_slots_[s];
+						slot.ch = ch;
+						slot.tick = tick_;
+						this->LinkSlotToFront(s);
+
+						uint32_t const x = s % num_chars_a_row * kfont_char_size;
+						uint32_t const y = s / num_chars_a_row * kfont_char_size;
 
-						kl.GetDistanceData(&a_char_data_[0], kfont_char_size, offset);
-						dist_texture_->UpdateSubresource2D(0, 0, char_pos.x(), char_pos.y(), kfont_char_size, kfont_char_size,
-							&a_char_data_[0], kfont_char_size);
+						KFont::font_info const & ci = kl.CharInfo(offset);
 
-						cim.emplace(ch, charInfo);
+						CharInfo char_info;
+						char_info.rc.left()		= static_cast<float>(x) / tex_size;
+						char_info.rc.top()		= static_cast<float>(y) / tex_size;
+						char_info.rc.right()	= char_info.rc.left() + static_cast<float>(ci.width) / tex_size;
+						char_info.rc.bottom()	= char_info.rc.top() + static_cast<float>(ci.height) / tex_size;
+						char_info.slot			= s;
+						cim.emplace(ch, char_info);
+
+						// The font stream can't be shared across threads, so the compressed data is read here. Decompression is
+						// deferred to UploadPendingChars.
+						PendingChar pending;
+						pending.slot = s;
+						pending.lzma_offset = static_cast<uint32_t>(lzma_staging_.size());
+						kl.GetLZMADistanceData(nullptr, pending.lzma_size, offset);
+						lzma_staging_.resize(lzma_staging_.size() + pending.lzma_size);
+						kl.GetLZMADistanceData(&lzma_staging_[pending.lzma_offset], pending.lzma_size, offset);
+						pending_chars_.push_back(pending);
+
+						dirty_min_x_ = std::min(dirty_min_x_, x);
+						dirty_min_y_ = std::min(dirty_min_y_, y);
+						dirty_max_x_ = std::max(dirty_max_x_, x + kfont_char_size);
+						dirty_max_y_ = std::max(dirty_max_y_, y + kfont_char_size);
 					}
 				}
 			}
+
+			this->UploadPendingChars();
 		}
 
 	private:
+		// Decodes all the glyphs queued by UpdateTexture into the CPU copy of the atlas, and uploads their bounding rectangle
+		// with one call.
+		void UploadPendingChars()
+		{
+			if (pending_chars_.empty())
+			{
+				return;
+			}
+
+			KFont const & kl = *kfont_loader_;
+			uint32_t const kfont_char_size = kl.CharSize();
+			uint32_t const char_data_size = kfont_char_size * kfont_char_size;
+			uint32_t const tex_size = dist_texture_->Width(0);
+			uint32_t const num_chars_a_row = tex_size / kfont_char_size;
+
+			if (decoded_staging_.size() < pending_chars_.size() * char_data_size)
+			{
+				decoded_staging_.resize(pending_chars_.size() * char_data_size);
+			}
+
+			auto decode_chars = [this, &kl, kfont_char_size, char_data_size, tex_size, num_chars_a_row](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; ++ i)
+				{
+					PendingChar const & pending = pending_chars_[i];
+					uint8_t* decoded = &decoded_staging_[i * char_data_size];
+					kl.DecodeLZMADistanceData(decoded, &lzma_staging_[pending.lzma_offset], pending.lzma_size);
+
+					uint32_t const x = pending.slot % num_chars_a_row * kfont_char_size;
+					uint32_t const y = pending.slot / num_chars_a_row * kfont_char_size;
+					uint8_t* dst = &atlas_data_[y * tex_size + x];
+					for (uint32_t row = 0; row < kfont_char_size; ++ row)
+					{
+						std::memcpy(dst, decoded, kfont_char_size);
+						dst += tex_size;
+						decoded += kfont_char_size;
+					}
+				}
+			};
+
+			if (pending_chars_.size() < MIN_PARALLEL_CHARS)
+			{
+				decode_chars(0, pending_chars_.size());
+			}
+			else
+			{
+				Context::Instance().TaskScheduler().parallel_for(0, pending_chars_.size(), CHARS_PER_DECODE_TASK, decode_chars);
+			}
+
+			dist_texture_->UpdateSubresource2D(0, 0, dirty_min_x_, dirty_min_y_,
+				dirty_max_x_ - dirty_min_x_, dirty_max_y_ - dirty_min_y_,
+				&atlas_data_[dirty_min_y_ * tex_size + dirty_min_x_], tex_size);
+
+			pending_chars_.clear();
+			lzma_staging_.clear();
+			this->ResetDirtyRect();
+		}
+
+		void ResetDirtyRect()
+		{
+			dirty_min_x_ = std::numeric_limits<uint32_t>::max();
+			dirty_min_y_ = std::numeric_limits<uint32_t>::max();
+			dirty_max_x_ = 0;
+			dirty_max_y_ = 0;
+		}
+
+		void UnlinkSlot(uint32_t s)
+		{
+			CharSlot& slot = char_slots_[s];
+			if (slot.prev != INVALID_SLOT)
+			{
+				char_slots_[slot.prev].next = slot.next;
+			}
+			else
+			{
+				lru_head_ = slot.next;
+			}
+			if (slot.next != INVALID_SLOT)
+			{
+				char_slots_[slot.next].prev = slot.prev;
+			}
+			else
+			{
+				lru_tail_ = slot.prev;
+			}
+			slot.prev = INVALID_SLOT;
+			slot.next = INVALID_SLOT;
+		}
+
+		void LinkSlotToFront(uint32_t s)
+		{
+			CharSlot& slot = char_slots_[s];
+			slot.prev = INVALID_SLOT;
+			slot.next = lru_head_;
+			if (lru_head_ != INVALID_SLOT)
+			{
+				char_slots_[lru_head_].prev = s;
+			}
+			else
+			{
+				lru_tail_ = s;
+			}
+			lru_head_ = s;
+		}
+
+		void MoveSlotToFront(uint32_t s)
+		{
+			if (lru_head_ != s)
+			{
+				this->UnlinkSlot(s);
+				this->LinkSlotToFront(s);
+			}
+		}
+
+	private:
+		static uint32_t constexpr INVALID_SLOT = 0xFFFFFFFFU;
+		static size_t constexpr MIN_PARALLEL_CHARS = 8;
+		static size_t constexpr CHARS_PER_DECODE_TASK = 4;
+
 		struct CharInfo
 		{
 			Rect rc;
+			uint32_t slot;
+		};
+
+		// A cell of the distance texture. Cells in use form an intrusive LRU list, most recently used first.
+		struct CharSlot
+		{
+			wchar_t ch;
 			uint64_t tick;
+			uint32_t prev;
+			uint32_t next;
+		};
+
+		struct PendingChar
+		{
+			uint32_t slot;
+			uint32_t lzma_offset;
+			uint32_t lzma_size;
 		};
 
 #ifdef KLAYGE_HAS_STRUCT_PACK
@@ -693,7 +790,10 @@ namespace KlayGE
 		bool restart_;
 
 		std::unordered_map<wchar_t, CharInfo> char_info_map_;
-		std::list<std::pair<uint32_t, uint32_t>> char_free_list_;
+		std::vector<CharSlot> char_slots_;
+		uint32_t num_used_slots_;
+		uint32_t lru_head_;
+		uint32_t lru_tail_;
 
 		bool three_dim_;
 
@@ -703,7 +803,15 @@ namespace KlayGE
 		std::vector<SubAlloc> tb_ib_sub_allocs_;
 
 		TexturePtr		dist_texture_;
-		std::vector<uint8_t> a_char_data_;
+		std::vector<uint8_t> atlas_data_;
+
+		std::vector<PendingChar> pending_chars_;
+		std::vector<uint8_t> lzma_staging_;
+		std::vector<uint8_t> decoded_staging_;
+		uint32_t dirty_min_x_;
+		uint32_t dirty_min_y_;
+		uint32_t dirty_max_x_;
+		uint32_t dirty_max_y_;
 
 		RenderEffectParameter* half_width_height_ep_;
 		RenderEffectParameter* dpi_scale_ep_;
@@ -782,6 +890,15 @@ namespace
 			return true;
 		}
 
+		size_t Key() const override
+		{
+			size_t seed = 0;
+			HashCombine(seed, this->Type());
+			HashRange(seed, font_desc_.res_name.begin(), font_desc_.res_name.end());
+			HashCombine(seed, font_desc_.flag);
+			return seed;
+		}
+
 		bool Match(ResLoadingDesc const & rhs) const override
 		{
 			if (this->Type() == rhs.Type())
@@ -124,6 +124,14 @@ namespace KlayGE
 			return true;
 		}
 
+		size_t Key() const override
+		{
+			size_t seed = 0;
+			HashCombine(seed, this->Type());
+			HashRange(seed, imposter_desc_.res_name.begin(), imposter_desc_.res_name.end());
+			return seed;
+		}
+
 		bool Match(ResLoadingDesc const & rhs) const override
 		{
 			if (this->Type() == rhs.Type())
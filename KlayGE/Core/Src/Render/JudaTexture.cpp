@@ -17,6 +17,7 @@
 #include <KlayGE/RenderEngine.hpp>
 #include <KlayGE/RenderEffect.hpp>
 
+#include <algorithm>
 #include <fstream>
 #include <cstring>
 #include <boost/assert.hpp>
@@ -113,11 +114,23 @@ namespace KlayGE
 	float const THRESHOLD_MSE = 0.001f;
 	int const THRESHOLD_BIAS = 10;
 
+	// Tiles decoded by one streaming task
+	uint32_t const MAX_STREAMING_TILES = 16;
+	// How many coarser levels of a missing tile are requested to cover it
+	uint32_t const FALLBACK_LEVEL_DELTA = 2;
+	// Calls a request stays queued after it's no longer asked for
+	uint64_t const TILE_REQUEST_TIMEOUT = 8;
+	// Level delta in the indirect texture of a tile that has nothing resident to draw from. The shader outputs 0 for it.
+	uint32_t const MISSING_TILE_LEVEL_DELTA = 0xFF;
+
 	JudaTexture::JudaTexture(uint32_t num_tiles, uint32_t tile_size, ElementFormat format)
 		: root_(MakeSharedPtr<quadtree_node>()),
 			num_tiles_(num_tiles), tile_size_(tile_size), format_(format),
 			texel_size_(NumFormatBytes(format)),
-			decode_tick_(0), tile_tick_(0)
+			decode_tick_(0),
+			num_used_cache_slots_(0), lru_head_(INVALID_SLOT), lru_tail_(INVALID_SLOT),
+			num_cache_tiles_a_row_(0), num_cache_tiles_a_layer_(0),
+			tile_tick_(0)
 	{
 		BOOST_ASSERT(num_tiles_ <= MAX_NUM_TILES);
 		BOOST_ASSERT(tile_size_ <= MAX_TILE_SIZE);
@@ -400,11 +413,14 @@ namespace KlayGE
 		}
 	}
 
-	void JudaTexture::DecodeTiles(std::vector<std::vector<uint8_t>>& data, std::vector<uint32_t> const & tile_ids, uint32_t mipmaps)
+	JudaTexture::~JudaTexture()
 	{
-		BOOST_ASSERT(mipmaps - 1 <= lower_levels_);
+		// Waits for the streaming task, it uses this object
+		streaming_tasks_.reset();
+	}
 
-		data.resize(tile_ids.size() * mipmaps);
+	void JudaTexture::DecodeTiles(std::vector<std::vector<uint8_t>>& data, std::vector<uint32_t> const & tile_ids, uint32_t mipmaps)
+	{
 		std::vector<std::pair<uint32_t, uint32_t>> shuffs(tile_ids.size());
 		for (size_t i = 0; i < tile_ids.size(); ++ i)
 		{
@@ -412,6 +428,16 @@ namespace KlayGE
 			this->DecodeTileID(level, tile_x, tile_y, tile_ids[i]);
 			shuffs[i] = std::make_pair(this->Pos2Shuff(level, tile_x, tile_y), static_cast<uint32_t>(i));
 		}
+
+		this->DecodeShuffs(data, shuffs, mipmaps);
+	}
+
+	void JudaTexture::DecodeShuffs(std::vector<std::vector<uint8_t>>& data, std::vector<std::pair<uint32_t, uint32_t>>& shuffs,
+		uint32_t mipmaps)
+	{
+		BOOST_ASSERT(mipmaps - 1 <= lower_levels_);
+
+		data.resize(shuffs.size() * mipmaps);
 		std::sort(shuffs.begin(), shuffs.end());
 
 		uint32_t const full_tile_bytes = cache_tile_size_ * cache_tile_size_ * texel_size_;
@@ -1203,7 +1229,10 @@ namespace KlayGE
 
 			tex_indirect_ = rf.MakeTexture2D(num_tiles_, num_tiles_, 1, 1, EF_ABGR8, 1, 0, EAH_GPU_Read);
 
-			tile_free_list_.emplace_back(0, pages);
+			num_cache_tiles_a_row_ = s;
+			num_cache_tiles_a_layer_ = s * s;
+			uint32_t const num_layers = tex_cache_ ? tex_cache_->ArraySize() : array_size;
+			cache_slots_.resize(std::min(pages, num_cache_tiles_a_layer_ * num_layers));
 		}
 	}
 
@@ -1253,1311 +1282,1529 @@ namespace KlayGE
 
 		++ tile_tick_;
 
-		uint32_t const tex_width = tex_cache_ ? tex_cache_->Width(0) : tex_cache_array_[0]->Width(0);
-		uint32_t const tex_height = tex_cache_ ? tex_cache_->Height(0) : tex_cache_array_[0]->Height(0);
-		uint32_t const tex_layer = tex_cache_ ? tex_cache_->ArraySize() : static_cast<uint32_t>(tex_cache_array_.size());
-		uint32_t const tile_with_border_size = cache_tile_size_ + cache_tile_border_size_ * 2;
-
-		uint32_t const num_cache_tiles_a_row = tex_width / tile_with_border_size;
-		uint32_t const num_cache_tiles_a_layer = num_cache_tiles_a_row * tex_height / tile_with_border_size;
-		uint32_t const num_cache_total_tiles = num_cache_tiles_a_layer * tex_layer;
+		// The decoding states are owned by the streaming task while it runs
+		if (streaming_tasks_)
+		{
+			streaming_tasks_->wait();
+		}
+		this->CollectStreamedTiles();
 
-		std::unordered_map<uint32_t, uint32_t> neighbor_id_map;
-		std::vector<uint32_t> all_neighbor_ids;
-		std::vector<uint32_t> neighbor_ids;
-		std::vector<uint32_t> tile_attrs;
-		std::vector<bool> in_same_image;
-		auto& tim = tile_info_map_;
-		for (size_t i = 0; i < tile_ids.size(); ++ i)
+		std::vector<TileRequest> requests;
+		for (auto const tile_id : tile_ids)
 		{
-			auto tmiter = tim.find(tile_ids[i]);
-			if (tmiter != tim.end())
+			TileRequest request;
+			request.tile_id = tile_id;
+			request.level_delta = 0;
+			request.tick = tile_tick_;
+			request.in_flight = false;
+
+			uint32_t const shuff = this->RequestShuff(request);
+			if (resident_tiles_.find(shuff) == resident_tiles_.end())
 			{
-				// Exists in cache
-
-				tmiter->second.tick = tile_tick_;
+				requests.push_back(request);
+				tile_requests_.erase(shuff);
 			}
-			else
+		}
+
+		if (!requests.empty())
+		{
+			std::vector<CacheTileData> cache_tiles;
+			this->BuildCacheTiles(cache_tiles, requests);
+			for (auto const & cache_tile : cache_tiles)
 			{
-				uint32_t level, tile_x, tile_y;
-				this->DecodeTileID(level, tile_x, tile_y, tile_ids[i]);
+				this->UploadCacheTile(cache_tile, true);
+			}
+		}
 
-				std::array<uint32_t, 9> new_tile_id_with_neighbors;
-				new_tile_id_with_neighbors.fill(0xFFFFFFFF);
-				new_tile_id_with_neighbors[0] = tile_ids[i];
+		this->RequestTiles(tile_ids);
+	}
 
-				std::array<bool, 9> new_in_same_image;
-				new_in_same_image.fill(false);
-				new_in_same_image[0] = true;
+	void JudaTexture::ASyncUpdateCache(std::vector<uint32_t> const & tile_ids)
+	{
+		BOOST_ASSERT(tex_cache_ || !tex_cache_array_.empty());
 
-				uint32_t attr = this->DecodeAAttr(this->Pos2Shuff(level, tile_x, tile_y));
-				tile_attrs.push_back(attr);
-				if (attr != 0xFFFFFFFF)
-				{
-					std::array<int32_t, 9> new_tile_id_x;
-					std::array<int32_t, 9> new_tile_id_y;
+		++ tile_tick_;
 
-					int32_t left = tile_x - 1;
-					int32_t right = tile_x + 1;
-					int32_t up = tile_y - 1;
-					int32_t down = tile_y + 1;
+		this->CollectStreamedTiles();
+		this->RequestTiles(tile_ids);
+		this->DispatchStreaming();
+	}
 
-					ImageEntry const & entry = image_entries_[attr];
-					if (TAM_Wrap == (entry.addr_u_v & 0xF))
-					{
-						left = entry.x + (left - entry.x + entry.w) % entry.w;
-						right = entry.x + (right - entry.x + entry.w) % entry.w;
-					}
-					if (TAM_Wrap == ((entry.addr_u_v >> 4) & 0xF))
+	uint32_t JudaTexture::RequestShuff(TileRequest const & request) const
+	{
+		uint32_t level, tile_x, tile_y;
+		this->DecodeTileID(level, tile_x, tile_y, request.tile_id);
+		return this->ShuffLevel(this->Pos2Shuff(level, tile_x, tile_y), level - request.level_delta);
+	}
+
+	void JudaTexture::RequestTiles(std::vector<uint32_t> const & tile_ids)
+	{
+		// DecodeTiles takes cache tiles from this level when they are smaller than the tiles in file
+		uint32_t min_level = 0;
+		while ((cache_tile_size_ << min_level) < tile_size_)
+		{
+			++ min_level;
+		}
+
+		for (auto const tile_id : tile_ids)
+		{
+			uint32_t level, tile_x, tile_y;
+			this->DecodeTileID(level, tile_x, tile_y, tile_id);
+
+			// Walks up to the first resident level and draws the tile from it. Missing levels up to FALLBACK_LEVEL_DELTA are
+			//  requested, so a coarse version shows up soon and the finer ones replace it.
+			TileRequest request;
+			request.tick = tile_tick_;
+			request.in_flight = false;
+			bool resident = false;
+			for (uint32_t delta = 0; delta <= level - std::min(level, min_level); ++ delta)
+			{
+				uint32_t const mask = ~((1U << delta) - 1);
+				request.tile_id = this->EncodeTileID(level, tile_x & mask, tile_y & mask);
+				request.level_delta = delta;
+
+				uint32_t const shuff = this->RequestShuff(request);
+				auto iter = resident_tiles_.find(shuff);
+				if (iter != resident_tiles_.end())
+				{
+					cache_slots_[iter->second].tick = tile_tick_;
+					this->MoveSlotToFront(iter->second);
+					this->WriteIndirect(tile_id, iter->second, delta);
+					resident = true;
+					break;
+				}
+
+				if (delta <= FALLBACK_LEVEL_DELTA)
+				{
+					auto req_iter = tile_requests_.find(shuff);
+					if (req_iter == tile_requests_.end())
 					{
-						up = entry.y + (up - entry.y + entry.h) % entry.h;
-						down = entry.y + (down - entry.y + entry.h) % entry.h;
+						tile_requests_.emplace(shuff, request);
 					}
-
-					new_tile_id_x[1] = left;
-					new_tile_id_y[1] = up;
-					new_tile_id_x[2] = tile_x;
-					new_tile_id_y[2] = up;
-					new_tile_id_x[3] = right;
-					new_tile_id_y[3] = up;
-
-					new_tile_id_x[4] = left;
-					new_tile_id_y[4] = tile_y;
-					new_tile_id_x[5] = right;
-					new_tile_id_y[5] = tile_y;
-
-					new_tile_id_x[6] = left;
-					new_tile_id_y[6] = down;
-					new_tile_id_x[7] = tile_x;
-					new_tile_id_y[7] = down;
-					new_tile_id_x[8] = right;
-					new_tile_id_y[8] = down;
-
-					for (int j = 1; j < 9; ++ j)
+					else
 					{
-						if ((new_tile_id_x[j] >= 0) && (new_tile_id_y[j] >= 0)
-							&& (new_tile_id_x[j] < static_cast<int32_t>(num_tiles_) - 1)
-							&& (new_tile_id_y[j] < static_cast<int32_t>(num_tiles_) - 1))
-						{
-							new_tile_id_with_neighbors[j] = this->EncodeTileID(level, new_tile_id_x[j], new_tile_id_y[j]);
-							if (new_tile_id_with_neighbors[j] != 0xFFFFFFFF)
-							{
-								if (attr == this->DecodeAAttr(this->Pos2Shuff(level, new_tile_id_x[j], new_tile_id_y[j])))
-								{
-									new_in_same_image[j] = true;
-								}
-							}
-						}
-						else
-						{
-							new_tile_id_with_neighbors[j] = 0xFFFFFFFF;
-						}
+						req_iter->second.tick = tile_tick_;
 					}
 				}
+			}
+
+			if (!resident)
+			{
+				// Otherwise the texel keeps an old entry, which may point to a slot that holds another tile by now
+				this->WriteIndirect(tile_id, 0, MISSING_TILE_LEVEL_DELTA);
+			}
+		}
+	}
+
+	void JudaTexture::CollectStreamedTiles()
+	{
+		if (!streaming_tasks_ || !streaming_tasks_->done())
+		{
+			return;
+		}
 
-				for (size_t j = 0; j < new_tile_id_with_neighbors.size(); ++ j)
+		streaming_tasks_->wait();
+		streaming_tasks_.reset();
+
+		for (auto const & cache_tile : streamed_tiles_)
+		{
+			auto iter = tile_requests_.find(cache_tile.shuff);
+			if (iter != tile_requests_.end())
+			{
+				if (this->UploadCacheTile(cache_tile, false))
 				{
-					if (new_tile_id_with_neighbors[j] != 0xFFFFFFFF)
-					{
-						if (neighbor_id_map.find(new_tile_id_with_neighbors[j]) == neighbor_id_map.end())
-						{
-							neighbor_id_map.emplace(new_tile_id_with_neighbors[j], static_cast<uint32_t>(neighbor_ids.size()));
-							neighbor_ids.push_back(new_tile_id_with_neighbors[j]);
-						}
-					}
-					all_neighbor_ids.push_back(new_tile_id_with_neighbors[j]);
-					in_same_image.push_back(new_in_same_image[j]);
+					tile_requests_.erase(iter);
+				}
+				else
+				{
+					// Everything in the cache is in use. Try again later.
+					iter->second.in_flight = false;
 				}
 			}
 		}
+		streamed_tiles_.clear();
+		streaming_requests_.clear();
+	}
 
-		uint32_t mipmaps = tex_cache_->NumMipMaps();
-		std::vector<std::vector<uint8_t>> neighbor_data;
-		this->DecodeTiles(neighbor_data, neighbor_ids, mipmaps);
+	void JudaTexture::DispatchStreaming()
+	{
+		if (streaming_tasks_)
+		{
+			return;
+		}
 
-		TileInfo tile_info;
-		tile_info.tick = tile_tick_;
-		for (size_t i = 0; i < all_neighbor_ids.size(); i += 9)
+		std::vector<std::pair<uint32_t, TileRequest>> pending;
+		for (auto iter = tile_requests_.begin(); iter != tile_requests_.end();)
 		{
-			tile_info.attr = tile_attrs[i / 9];
-			uint8_t border_clr[4];
-			TexAddressingMode addr_u, addr_v;
-			if (tile_info.attr != 0xFFFFFFFF)
+			if (iter->second.tick + TILE_REQUEST_TIMEOUT < tile_tick_)
 			{
-				ImageEntry const & entry = image_entries_[tile_info.attr];
-				addr_u = static_cast<TexAddressingMode>(entry.addr_u_v & 0xF);
-				addr_v = static_cast<TexAddressingMode>((entry.addr_u_v >> 4) & 0xF);
-				texel_op_.from_float4(border_clr, &entry.border_clr.r());
+				iter = tile_requests_.erase(iter);
 			}
 			else
 			{
-				addr_u = TAM_Clamp;
-				addr_v = TAM_Clamp;
-				border_clr[0] = border_clr[1] = border_clr[2] = border_clr[3] = 0;
+				pending.push_back(*iter);
+				++ iter;
 			}
+		}
+		if (pending.empty())
+		{
+			return;
+		}
 
-			if (tile_info_map_.size() < num_cache_total_tiles)
+		// Coarser levels first, since they cover more tiles. Then the most recent requests.
+		uint32_t const num_streaming = std::min(static_cast<uint32_t>(pending.size()), MAX_STREAMING_TILES);
+		std::partial_sort(pending.begin(), pending.begin() + num_streaming, pending.end(),
+			[this](std::pair<uint32_t, TileRequest> const & lhs, std::pair<uint32_t, TileRequest> const & rhs)
 			{
-				// Still has space in cache
-
-				uint32_t const s = tile_free_list_.front().first;
-				tile_info.z = s / num_cache_tiles_a_layer;
-				tile_info.y = (s - tile_info.z * num_cache_tiles_a_layer) / num_cache_tiles_a_row;
-				tile_info.x = s - tile_info.z * num_cache_tiles_a_layer - tile_info.y * num_cache_tiles_a_row;
-
-				++ tile_free_list_.front().first;
-				if (tile_free_list_.front().first == tile_free_list_.front().second)
+				uint32_t const lhs_level = this->ShuffLevel(lhs.first);
+				uint32_t const rhs_level = this->ShuffLevel(rhs.first);
+				if (lhs_level != rhs_level)
 				{
-					tile_free_list_.pop_front();
+					return lhs_level < rhs_level;
 				}
+				return lhs.second.tick > rhs.second.tick;
+			});
+
+		BOOST_ASSERT(streaming_requests_.empty());
+		for (uint32_t i = 0; i < num_streaming; ++ i)
+		{
+			tile_requests_[pending[i].first].in_flight = true;
+			streaming_requests_.push_back(pending[i].second);
+		}
+
+		streaming_tasks_ = MakeUniquePtr<task_group>(Context::Instance().TaskScheduler());
+		streaming_tasks_->run([this]
+			{
+				this->BuildCacheTiles(streamed_tiles_, streaming_requests_);
+			});
+	}
+
+	uint32_t JudaTexture::TileNeighbors(std::array<uint32_t, 9>& neighbor_shuffs, std::array<bool, 9>& in_same_image,
+		TileRequest const & request)
+	{
+		uint32_t level, tile_x, tile_y;
+		this->DecodeTileID(level, tile_x, tile_y, request.tile_id);
+		uint32_t const target_level = level - request.level_delta;
+		int32_t const step = 1 << request.level_delta;
+
+		neighbor_shuffs.fill(0xFFFFFFFF);
+		neighbor_shuffs[0] = this->RequestShuff(request);
+
+		in_same_image.fill(false);
+		in_same_image[0] = true;
+
+		uint32_t attr = this->DecodeAAttr(neighbor_shuffs[0]);
+		if (attr != 0xFFFFFFFF)
+		{
+			std::array<int32_t, 9> new_tile_id_x;
+			std::array<int32_t, 9> new_tile_id_y;
+
+			int32_t left = tile_x - step;
+			int32_t right = tile_x + step;
+			int32_t up = tile_y - step;
+			int32_t down = tile_y + step;
+
+			ImageEntry const & entry = image_entries_[attr];
+			if (TAM_Wrap == (entry.addr_u_v & 0xF))
+			{
+				left = entry.x + ((left - entry.x) % entry.w + entry.w) % entry.w;
+				right = entry.x + ((right - entry.x) % entry.w + entry.w) % entry.w;
 			}
-			else
+			if (TAM_Wrap == ((entry.addr_u_v >> 4) & 0xF))
 			{
-				// Find tiles that are not used for the longest time
+				up = entry.y + ((up - entry.y) % entry.h + entry.h) % entry.h;
+				down = entry.y + ((down - entry.y) % entry.h + entry.h) % entry.h;
+			}
 
-				uint64_t min_tick = tim.begin()->second.tick;
-				auto min_tileiter = tim.begin();
-				for (auto tileiter = tim.begin(); tileiter != tim.end(); ++ tileiter)
+			new_tile_id_x[1] = left;
+			new_tile_id_y[1] = up;
+			new_tile_id_x[2] = tile_x;
+			new_tile_id_y[2] = up;
+			new_tile_id_x[3] = right;
+			new_tile_id_y[3] = up;
+
+			new_tile_id_x[4] = left;
+			new_tile_id_y[4] = tile_y;
+			new_tile_id_x[5] = right;
+			new_tile_id_y[5] = tile_y;
+
+			new_tile_id_x[6] = left;
+			new_tile_id_y[6] = down;
+			new_tile_id_x[7] = tile_x;
+			new_tile_id_y[7] = down;
+			new_tile_id_x[8] = right;
+			new_tile_id_y[8] = down;
+
+			for (int j = 1; j < 9; ++ j)
+			{
+				if ((new_tile_id_x[j] >= 0) && (new_tile_id_y[j] >= 0)
+					&& (new_tile_id_x[j] < static_cast<int32_t>(num_tiles_) - 1)
+					&& (new_tile_id_y[j] < static_cast<int32_t>(num_tiles_) - 1))
 				{
-					if (tileiter->second.tick < min_tick)
+					neighbor_shuffs[j] = this->ShuffLevel(this->Pos2Shuff(level, new_tile_id_x[j], new_tile_id_y[j]), target_level);
+					if (attr == this->DecodeAAttr(neighbor_shuffs[j]))
 					{
-						min_tick = tileiter->second.tick;
-						min_tileiter = tileiter;
+						in_same_image[j] = true;
 					}
 				}
+			}
+		}
 
-				tile_info.x = min_tileiter->second.x;
-				tile_info.y = min_tileiter->second.y;
-				tile_info.z = min_tileiter->second.z;
+		return attr;
+	}
 
-				for (auto tileiter = tim.begin(); tileiter != tim.end();)
-				{
-					if (tileiter->second.tick == min_tick)
-					{
-						uint32_t const id = tileiter->second.z * num_cache_tiles_a_layer + tileiter->second.y * num_cache_tiles_a_row + tileiter->second.x;
-						auto freeiter = tile_free_list_.begin();
-						while ((freeiter != tile_free_list_.end()) && (freeiter->second <= id))
-						{
-							++ freeiter;
-						}
-						tile_free_list_.emplace(freeiter, id, id + 1);
+	void JudaTexture::BuildCacheTiles(std::vector<CacheTileData>& cache_tiles, std::vector<TileRequest> const & requests)
+	{
+		uint32_t const mipmaps = tex_cache_ ? tex_cache_->NumMipMaps() : tex_cache_array_[0]->NumMipMaps();
+
+		std::unordered_map<uint32_t, uint32_t> neighbor_shuff_map;
+		std::vector<std::pair<uint32_t, uint32_t>> neighbor_shuffs;
+		std::vector<std::array<uint32_t, 9>> index_with_neighbors(requests.size());
+		std::vector<std::array<bool, 9>> in_same_image(requests.size());
+		std::vector<uint32_t> tile_attrs(requests.size());
+		for (size_t i = 0; i < requests.size(); ++ i)
+		{
+			std::array<uint32_t, 9> shuffs;
+			tile_attrs[i] = this->TileNeighbors(shuffs, in_same_image[i], requests[i]);
 
-						tileiter = tim.erase(tileiter);
-					}
-					else
+			for (size_t j = 0; j < shuffs.size(); ++ j)
+			{
+				if (shuffs[j] != 0xFFFFFFFF)
+				{
+					auto iter = neighbor_shuff_map.find(shuffs[j]);
+					if (iter == neighbor_shuff_map.end())
 					{
-						 ++ tileiter;
+						uint32_t const index = static_cast<uint32_t>(neighbor_shuffs.size());
+						iter = neighbor_shuff_map.emplace(shuffs[j], index).first;
+						neighbor_shuffs.emplace_back(shuffs[j], index);
 					}
+					index_with_neighbors[i][j] = iter->second;
 				}
-				for (auto freeiter = tile_free_list_.begin(); freeiter != tile_free_list_.end() - 1;)
+				else
 				{
-					auto nextiter = freeiter;
-					++ nextiter;
-
-					if (freeiter->second == nextiter->first)
-					{
-						freeiter->second = nextiter->second;
-						freeiter = tile_free_list_.erase(nextiter);
-						-- freeiter;
-					}
-					else
-					{
-						++ freeiter;
-					}
+					index_with_neighbors[i][j] = 0xFFFFFFFF;
 				}
 			}
+		}
+
+		// Reading and decompressing share the file and the block cache, so they stay on one thread
+		std::vector<std::vector<uint8_t>> neighbor_data;
+		this->DecodeShuffs(neighbor_data, neighbor_shuffs, mipmaps);
 
-			std::array<uint32_t, 9> index_with_neighbors = { { 0 } };
-			for (size_t j = 0; j < index_with_neighbors.size(); ++ j)
+		cache_tiles.resize(requests.size());
+		Context::Instance().TaskScheduler().parallel_for(0, requests.size(), 1,
+			[this, &cache_tiles, &requests, &tile_attrs, &index_with_neighbors, &in_same_image, &neighbor_data](
+				size_t begin, size_t end)
 			{
-				if (all_neighbor_ids[i + j] != 0xFFFFFFFF)
+				TexCompressionPtr codec = tex_codec_ ? tex_codec_->Clone() : TexCompressionPtr();
+				for (size_t i = begin; i < end; ++ i)
 				{
-					BOOST_ASSERT(neighbor_id_map.find(all_neighbor_ids[i + j]) != neighbor_id_map.end());
+					cache_tiles[i].shuff = this->RequestShuff(requests[i]);
+					this->BuildCacheTile(cache_tiles[i], tile_attrs[i], index_with_neighbors[i], in_same_image[i],
+						neighbor_data, codec.get());
+				}
+			});
+	}
+
+	void JudaTexture::BuildCacheTile(CacheTileData& cache_tile, uint32_t attr, std::array<uint32_t, 9> const & index_with_neighbors,
+		std::array<bool, 9> const & in_same_image, std::vector<std::vector<uint8_t>> const & neighbor_data,
+		TexCompression* codec)
+	{
+		BOOST_ASSERT(index_with_neighbors[0] != 0xFFFFFFFF);
+
+		uint32_t const mipmaps = tex_cache_ ? tex_cache_->NumMipMaps() : tex_cache_array_[0]->NumMipMaps();
+		uint32_t const tile_with_border_size = cache_tile_size_ + cache_tile_border_size_ * 2;
+		ElementFormat const format = tex_cache_ ? tex_cache_->Format() : tex_cache_array_[0]->Format();
+
+		uint8_t border_clr[4];
+		TexAddressingMode addr_u, addr_v;
+		if (attr != 0xFFFFFFFF)
+		{
+			ImageEntry const & entry = image_entries_[attr];
+			addr_u = static_cast<TexAddressingMode>(entry.addr_u_v & 0xF);
+			addr_v = static_cast<TexAddressingMode>((entry.addr_u_v >> 4) & 0xF);
+			texel_op_.from_float4(border_clr, &entry.border_clr.r());
+		}
+		else
+		{
+			addr_u = TAM_Clamp;
+			addr_v = TAM_Clamp;
+			border_clr[0] = border_clr[1] = border_clr[2] = border_clr[3] = 0;
+		}
+
+		cache_tile.mips.resize(mipmaps);
+		cache_tile.row_pitches.resize(mipmaps);
 
-					index_with_neighbors[j] = neighbor_id_map[all_neighbor_ids[i + j]];
+		uint32_t mip_tile_size = cache_tile_size_;
+		uint32_t mip_tile_with_border_size = tile_with_border_size;
+		uint32_t mip_border_size = cache_tile_border_size_;
+		for (uint32_t l = 0; l < mipmaps; ++ l)
+		{
+#if defined(KLAYGE_COMPILER_MSVC)
+			std::array<uint8_t const *, 9> neighbor_data_ptr{};
+#else
+			std::array<uint8_t const *, 9> neighbor_data_ptr;
+#endif
+			for (uint32_t j = 0; j < neighbor_data_ptr.size(); ++ j)
+			{
+				if (index_with_neighbors[j] != 0xFFFFFFFF)
+				{
+					neighbor_data_ptr[j] = &neighbor_data[index_with_neighbors[j] * mipmaps + l][0];
 				}
 				else
 				{
-					index_with_neighbors[j] = 0xFFFFFFFF;
+					neighbor_data_ptr[j] = nullptr;
 				}
 			}
-			BOOST_ASSERT(index_with_neighbors[0] != 0xFFFFFFFF);
 
-			uint32_t mip_tile_size = cache_tile_size_;
-			uint32_t mip_tile_with_border_size = tile_with_border_size;
-			uint32_t mip_border_size = cache_tile_border_size_;
-			for (uint32_t l = 0; l < mipmaps; ++ l)
+			std::vector<uint8_t> tex_a_tile_data(mip_tile_with_border_size * mip_tile_with_border_size * texel_size_);
 			{
-#if defined(KLAYGE_COMPILER_MSVC)
-				std::array<uint8_t const *, 9> neighbor_data_ptr{};
-#else
-				std::array<uint8_t const *, 9> neighbor_data_ptr;
-#endif
-				for (uint32_t j = 0; j < neighbor_data_ptr.size(); ++ j)
+				uint8_t* data_with_border = &tex_a_tile_data[0];
+				uint32_t const data_pitch = mip_tile_with_border_size * texel_size_;
+			
+				for (uint32_t y = 0; y < mip_tile_size; ++ y)
 				{
-					if (index_with_neighbors[j] != 0xFFFFFFFF)
-					{
-						neighbor_data_ptr[j] = &neighbor_data[index_with_neighbors[j] * mipmaps + l][0];
-					}
-					else
-					{
-						neighbor_data_ptr[j] = nullptr;
-					}
+					texel_op_.copy_array(data_with_border + (y + mip_border_size) * data_pitch + mip_border_size * texel_size_,
+						neighbor_data_ptr[0] + y * mip_tile_size * texel_size_, mip_tile_size);
 				}
 
-				std::vector<uint8_t> tex_a_tile_data(mip_tile_with_border_size * mip_tile_with_border_size * texel_size_);
+				if ((neighbor_data_ptr[1] != nullptr) && in_same_image[1])
 				{
-					uint8_t* data_with_border = &tex_a_tile_data[0];
-					uint32_t const data_pitch = mip_tile_with_border_size * texel_size_;
-				
-					for (uint32_t y = 0; y < mip_tile_size; ++ y)
-					{
-						texel_op_.copy_array(data_with_border + (y + mip_border_size) * data_pitch + mip_border_size * texel_size_,
-							neighbor_data_ptr[0] + y * mip_tile_size * texel_size_, mip_tile_size);
-					}
-
-					if ((neighbor_data_ptr[1] != nullptr) && in_same_image[i + 1])
+					for (uint32_t y = 0; y < mip_border_size; ++ y)
 					{
-						for (uint32_t y = 0; y < mip_border_size; ++ y)
-						{
-							texel_op_.copy_array(data_with_border + y * data_pitch,
-								neighbor_data_ptr[1] + ((y + mip_tile_size - mip_border_size) * mip_tile_size + (mip_tile_size - mip_border_size)) * texel_size_,
-								mip_border_size);
-						}
+						texel_op_.copy_array(data_with_border + y * data_pitch,
+							neighbor_data_ptr[1] + ((y + mip_tile_size - mip_border_size) * mip_tile_size + (mip_tile_size - mip_border_size)) * texel_size_,
+							mip_border_size);
 					}
-					else
+				}
+				else
+				{
+					if (attr != 0xFFFFFFFF)
 					{
-						if (tile_info.attr != 0xFFFFFFFF)
+						std::vector<int32_t> border_coords_x(mip_border_size * mip_border_size);
+						std::vector<int32_t> border_coords_y(mip_border_size * mip_border_size);
+						switch (addr_u)
 						{
-							std::vector<int32_t> border_coords_x(mip_border_size * mip_border_size);
-							std::vector<int32_t> border_coords_y(mip_border_size * mip_border_size);
-							switch (addr_u)
+						case TAM_Mirror:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
 							{
-							case TAM_Mirror:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
-								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_x[y * mip_border_size + x] = mip_border_size - 1 - x;
-									}
-								}
-								break;
-
-							case TAM_Clamp:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_x[y * mip_border_size + x] = 0;
-									}
+									border_coords_x[y * mip_border_size + x] = mip_border_size - 1 - x;
 								}
-								break;
+							}
+							break;
 
-							case TAM_Border:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+						case TAM_Clamp:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
+							{
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_x[y * mip_border_size + x] = -1;
-									}
+									border_coords_x[y * mip_border_size + x] = 0;
 								}
-								break;
-
-							default:
-								KFL_UNREACHABLE("Invalid texture addressing mode");
 							}
-							switch (addr_v)
+							break;
+
+						case TAM_Border:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
 							{
-							case TAM_Mirror:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_y[y * mip_border_size + x] = mip_border_size - 1 - y;
-									}
+									border_coords_x[y * mip_border_size + x] = -1;
 								}
-								break;
+							}
+							break;
 
-							case TAM_Clamp:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+						default:
+							KFL_UNREACHABLE("Invalid texture addressing mode");
+						}
+						switch (addr_v)
+						{
+						case TAM_Mirror:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
+							{
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_y[y * mip_border_size + x] = 0;
-									}
+									border_coords_y[y * mip_border_size + x] = mip_border_size - 1 - y;
 								}
-								break;
+							}
+							break;
 
-							case TAM_Border:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+						case TAM_Clamp:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
+							{
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_y[y * mip_border_size + x] = -1;
-									}
+									border_coords_y[y * mip_border_size + x] = 0;
 								}
-								break;
-
-							default:
-								KFL_UNREACHABLE("Invalid texture addressing mode");
 							}
+							break;
 
+						case TAM_Border:
 							for (uint32_t y = 0; y < mip_border_size; ++ y)
 							{
 								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									if ((border_coords_x[y * mip_border_size + x] >= 0) && (border_coords_y[y * mip_border_size + x] >= 0))
-									{
-										texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_,
-											neighbor_data_ptr[0] + border_coords_y[y * mip_border_size + x] * mip_tile_with_border_size + border_coords_x[y * mip_border_size + x]);
-									}
-									else
-									{
-										texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_, border_clr);
-									}
+									border_coords_y[y * mip_border_size + x] = -1;
 								}
 							}
+							break;
+
+						default:
+							KFL_UNREACHABLE("Invalid texture addressing mode");
 						}
-						else
+
+						for (uint32_t y = 0; y < mip_border_size; ++ y)
 						{
-							for (uint32_t y = 0; y < mip_border_size; ++ y)
+							for (uint32_t x = 0; x < mip_border_size; ++ x)
 							{
-								for (uint32_t x = 0; x < mip_border_size; ++ x)
+								if ((border_coords_x[y * mip_border_size + x] >= 0) && (border_coords_y[y * mip_border_size + x] >= 0))
 								{
 									texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_,
-											neighbor_data_ptr[0]);
+										neighbor_data_ptr[0] + border_coords_y[y * mip_border_size + x] * mip_tile_with_border_size + border_coords_x[y * mip_border_size + x]);
+								}
+								else
+								{
+									texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_, border_clr);
 								}
 							}
 						}
 					}
-					if ((neighbor_data_ptr[2] != nullptr) && in_same_image[i + 2])
+					else
 					{
 						for (uint32_t y = 0; y < mip_border_size; ++ y)
 						{
-							texel_op_.copy_array(data_with_border + y * data_pitch + mip_border_size * texel_size_,
-								neighbor_data_ptr[2] + ((y + mip_tile_size - mip_border_size) * mip_tile_size) * texel_size_, mip_tile_size);
+							for (uint32_t x = 0; x < mip_border_size; ++ x)
+							{
+								texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_,
+										neighbor_data_ptr[0]);
+							}
 						}
 					}
-					else
+				}
+				if ((neighbor_data_ptr[2] != nullptr) && in_same_image[2])
+				{
+					for (uint32_t y = 0; y < mip_border_size; ++ y)
+					{
+						texel_op_.copy_array(data_with_border + y * data_pitch + mip_border_size * texel_size_,
+							neighbor_data_ptr[2] + ((y + mip_tile_size - mip_border_size) * mip_tile_size) * texel_size_, mip_tile_size);
+					}
+				}
+				else
+				{
+					if (attr != 0xFFFFFFFF)
 					{
-						if (tile_info.attr != 0xFFFFFFFF)
+						std::vector<int32_t> border_coords_x(mip_tile_size * mip_border_size);
+						std::vector<int32_t> border_coords_y(mip_tile_size * mip_border_size);
+						switch (addr_u)
 						{
-							std::vector<int32_t> border_coords_x(mip_tile_size * mip_border_size);
-							std::vector<int32_t> border_coords_y(mip_tile_size * mip_border_size);
-							switch (addr_u)
+						case TAM_Mirror:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
 							{
-							case TAM_Mirror:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
-								{
-									for (uint32_t x = 0; x < mip_tile_size; ++ x)
-									{
-										border_coords_x[y * mip_tile_size + x] = x;
-									}
-								}
-								break;
-
-							case TAM_Clamp:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+								for (uint32_t x = 0; x < mip_tile_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_tile_size; ++ x)
-									{
-										border_coords_x[y * mip_tile_size + x] = x;
-									}
+									border_coords_x[y * mip_tile_size + x] = x;
 								}
-								break;
+							}
+							break;
 
-							case TAM_Border:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+						case TAM_Clamp:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
+							{
+								for (uint32_t x = 0; x < mip_tile_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_tile_size; ++ x)
-									{
-										border_coords_x[y * mip_tile_size + x] = -1;
-									}
+									border_coords_x[y * mip_tile_size + x] = x;
 								}
-								break;
-
-							default:
-								KFL_UNREACHABLE("Invalid texture addressing mode");
 							}
-							switch (addr_v)
+							break;
+
+						case TAM_Border:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
 							{
-							case TAM_Mirror:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+								for (uint32_t x = 0; x < mip_tile_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_tile_size; ++ x)
-									{
-										border_coords_y[y * mip_tile_size + x] = mip_border_size - 1 - y;
-									}
+									border_coords_x[y * mip_tile_size + x] = -1;
 								}
-								break;
+							}
+							break;
 
-							case TAM_Clamp:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+						default:
+							KFL_UNREACHABLE("Invalid texture addressing mode");
+						}
+						switch (addr_v)
+						{
+						case TAM_Mirror:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
+							{
+								for (uint32_t x = 0; x < mip_tile_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_tile_size; ++ x)
-									{
-										border_coords_y[y * mip_tile_size + x] = 0;
-									}
+									border_coords_y[y * mip_tile_size + x] = mip_border_size - 1 - y;
 								}
-								break;
+							}
+							break;
 
-							case TAM_Border:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+						case TAM_Clamp:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
+							{
+								for (uint32_t x = 0; x < mip_tile_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_tile_size; ++ x)
-									{
-										border_coords_y[y * mip_tile_size + x] = -1;
-									}
+									border_coords_y[y * mip_tile_size + x] = 0;
 								}
-								break;
-
-							default:
-								KFL_UNREACHABLE("Invalid texture addressing mode");
 							}
+							break;
 
+						case TAM_Border:
 							for (uint32_t y = 0; y < mip_border_size; ++ y)
 							{
 								for (uint32_t x = 0; x < mip_tile_size; ++ x)
 								{
-									if ((border_coords_x[y * mip_tile_size + x] >= 0) && (border_coords_y[y * mip_tile_size + x] >= 0))
-									{
-										texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_,
-											neighbor_data_ptr[0] + border_coords_y[y * mip_tile_size + x] * mip_tile_with_border_size + border_coords_x[y * mip_tile_size + x]);
-									}
-									else
-									{
-										texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_, border_clr);
-									}
+									border_coords_y[y * mip_tile_size + x] = -1;
 								}
 							}
-						}
-						else
+							break;
+
+						default:
+							KFL_UNREACHABLE("Invalid texture addressing mode");
+						}
+
+						for (uint32_t y = 0; y < mip_border_size; ++ y)
 						{
-							for (uint32_t y = 0; y < mip_border_size; ++ y)
+							for (uint32_t x = 0; x < mip_tile_size; ++ x)
 							{
-								texel_op_.copy_array(data_with_border + y * data_pitch + mip_border_size * texel_size_,
-									neighbor_data_ptr[0], mip_tile_size);
+								if ((border_coords_x[y * mip_tile_size + x] >= 0) && (border_coords_y[y * mip_tile_size + x] >= 0))
+								{
+									texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_,
+										neighbor_data_ptr[0] + border_coords_y[y * mip_tile_size + x] * mip_tile_with_border_size + border_coords_x[y * mip_tile_size + x]);
+								}
+								else
+								{
+									texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_, border_clr);
+								}
 							}
 						}
 					}
-					if ((neighbor_data_ptr[3] != nullptr) && in_same_image[i + 3])
+					else
 					{
 						for (uint32_t y = 0; y < mip_border_size; ++ y)
 						{
-							texel_op_.copy_array(data_with_border + y * data_pitch + (mip_border_size + mip_tile_size) * texel_size_,
-								neighbor_data_ptr[3] + (y + mip_tile_size - mip_border_size) * mip_tile_size * texel_size_, mip_border_size);
+							texel_op_.copy_array(data_with_border + y * data_pitch + mip_border_size * texel_size_,
+								neighbor_data_ptr[0], mip_tile_size);
 						}
 					}
-					else
+				}
+				if ((neighbor_data_ptr[3] != nullptr) && in_same_image[3])
+				{
+					for (uint32_t y = 0; y < mip_border_size; ++ y)
+					{
+						texel_op_.copy_array(data_with_border + y * data_pitch + (mip_border_size + mip_tile_size) * texel_size_,
+							neighbor_data_ptr[3] + (y + mip_tile_size - mip_border_size) * mip_tile_size * texel_size_, mip_border_size);
+					}
+				}
+				else
+				{
+					if (attr != 0xFFFFFFFF)
 					{
-						if (tile_info.attr != 0xFFFFFFFF)
+						std::vector<int32_t> border_coords_x(mip_border_size * mip_border_size);
+						std::vector<int32_t> border_coords_y(mip_border_size * mip_border_size);
+						switch (addr_u)
 						{
-							std::vector<int32_t> border_coords_x(mip_border_size * mip_border_size);
-							std::vector<int32_t> border_coords_y(mip_border_size * mip_border_size);
-							switch (addr_u)
+						case TAM_Mirror:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
 							{
-							case TAM_Mirror:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
-								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_x[y * mip_border_size + x] = mip_tile_size - 1 - x;
-									}
-								}
-								break;
-
-							case TAM_Clamp:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_x[y * mip_border_size + x] = mip_tile_size - 1;
-									}
+									border_coords_x[y * mip_border_size + x] = mip_tile_size - 1 - x;
 								}
-								break;
+							}
+							break;
 
-							case TAM_Border:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+						case TAM_Clamp:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
+							{
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_x[y * mip_border_size + x] = -1;
-									}
+									border_coords_x[y * mip_border_size + x] = mip_tile_size - 1;
 								}
-								break;
-
-							default:
-								KFL_UNREACHABLE("Invalid texture addressing mode");
 							}
-							switch (addr_v)
+							break;
+
+						case TAM_Border:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
 							{
-							case TAM_Mirror:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_y[y * mip_border_size + x] = mip_border_size - 1 - y;
-									}
+									border_coords_x[y * mip_border_size + x] = -1;
 								}
-								break;
+							}
+							break;
 
-							case TAM_Clamp:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+						default:
+							KFL_UNREACHABLE("Invalid texture addressing mode");
+						}
+						switch (addr_v)
+						{
+						case TAM_Mirror:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
+							{
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_y[y * mip_border_size + x] = 0;
-									}
+									border_coords_y[y * mip_border_size + x] = mip_border_size - 1 - y;
 								}
-								break;
+							}
+							break;
 
-							case TAM_Border:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+						case TAM_Clamp:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
+							{
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_y[y * mip_border_size + x] = -1;
-									}
+									border_coords_y[y * mip_border_size + x] = 0;
 								}
-								break;
-
-							default:
-								KFL_UNREACHABLE("Invalid texture addressing mode");
 							}
+							break;
 
+						case TAM_Border:
 							for (uint32_t y = 0; y < mip_border_size; ++ y)
 							{
 								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									if ((border_coords_x[y * mip_border_size + x] >= 0) && (border_coords_y[y * mip_border_size + x] >= 0))
-									{
-										texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_,
-											neighbor_data_ptr[0] + border_coords_y[y * mip_border_size + x] * mip_tile_with_border_size + border_coords_x[y * mip_border_size + x]);
-									}
-									else
-									{
-										texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_, border_clr);
-									}
+									border_coords_y[y * mip_border_size + x] = -1;
 								}
 							}
+							break;
+
+						default:
+							KFL_UNREACHABLE("Invalid texture addressing mode");
 						}
-						else
+
+						for (uint32_t y = 0; y < mip_border_size; ++ y)
 						{
-							for (uint32_t y = 0; y < mip_border_size; ++ y)
+							for (uint32_t x = 0; x < mip_border_size; ++ x)
 							{
-								for (uint32_t x = 0; x < mip_border_size; ++ x)
+								if ((border_coords_x[y * mip_border_size + x] >= 0) && (border_coords_y[y * mip_border_size + x] >= 0))
+								{
+									texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_,
+										neighbor_data_ptr[0] + border_coords_y[y * mip_border_size + x] * mip_tile_with_border_size + border_coords_x[y * mip_border_size + x]);
+								}
+								else
 								{
-									texel_op_.copy(data_with_border + y * data_pitch + (x + mip_border_size + mip_tile_size) * texel_size_,
-										neighbor_data_ptr[0] + (mip_tile_size - 1) * texel_size_);
+									texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_, border_clr);
 								}
 							}
 						}
 					}
-
-					if ((neighbor_data_ptr[4] != nullptr) && in_same_image[i + 4])
+					else
 					{
-						for (uint32_t y = 0; y < mip_tile_size; ++ y)
+						for (uint32_t y = 0; y < mip_border_size; ++ y)
 						{
-							texel_op_.copy_array(data_with_border + (y + mip_border_size) * data_pitch,
-								neighbor_data_ptr[4] + (y * mip_tile_size + (mip_tile_size - mip_border_size)) * texel_size_, mip_border_size);
+							for (uint32_t x = 0; x < mip_border_size; ++ x)
+							{
+								texel_op_.copy(data_with_border + y * data_pitch + (x + mip_border_size + mip_tile_size) * texel_size_,
+									neighbor_data_ptr[0] + (mip_tile_size - 1) * texel_size_);
+							}
 						}
 					}
-					else
+				}
+
+				if ((neighbor_data_ptr[4] != nullptr) && in_same_image[4])
+				{
+					for (uint32_t y = 0; y < mip_tile_size; ++ y)
 					{
-						if (tile_info.attr != 0xFFFFFFFF)
+						texel_op_.copy_array(data_with_border + (y + mip_border_size) * data_pitch,
+							neighbor_data_ptr[4] + (y * mip_tile_size + (mip_tile_size - mip_border_size)) * texel_size_, mip_border_size);
+					}
+				}
+				else
+				{
+					if (attr != 0xFFFFFFFF)
+					{
+						std::vector<int32_t> border_coords_x(mip_border_size * mip_tile_size);
+						std::vector<int32_t> border_coords_y(mip_border_size * mip_tile_size);
+						switch (addr_u)
 						{
-							std::vector<int32_t> border_coords_x(mip_border_size * mip_tile_size);
-							std::vector<int32_t> border_coords_y(mip_border_size * mip_tile_size);
-							switch (addr_u)
+						case TAM_Mirror:
+							for (uint32_t y = 0; y < mip_tile_size; ++ y)
 							{
-							case TAM_Mirror:
-								for (uint32_t y = 0; y < mip_tile_size; ++ y)
-								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_x[y * mip_border_size + x] = mip_border_size - 1 - x;
-									}
-								}
-								break;
-
-							case TAM_Clamp:
-								for (uint32_t y = 0; y < mip_tile_size; ++ y)
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_x[y * mip_border_size + x] = 0;
-									}
+									border_coords_x[y * mip_border_size + x] = mip_border_size - 1 - x;
 								}
-								break;
+							}
+							break;
 
-							case TAM_Border:
-								for (uint32_t y = 0; y < mip_tile_size; ++ y)
+						case TAM_Clamp:
+							for (uint32_t y = 0; y < mip_tile_size; ++ y)
+							{
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_x[y * mip_border_size + x] = -1;
-									}
+									border_coords_x[y * mip_border_size + x] = 0;
 								}
-								break;
-
-							default:
-								KFL_UNREACHABLE("Invalid texture addressing mode");
 							}
-							switch (addr_v)
+							break;
+
+						case TAM_Border:
+							for (uint32_t y = 0; y < mip_tile_size; ++ y)
 							{
-							case TAM_Mirror:
-								for (uint32_t y = 0; y < mip_tile_size; ++ y)
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_y[y * mip_border_size + x] = y;
-									}
+									border_coords_x[y * mip_border_size + x] = -1;
 								}
-								break;
+							}
+							break;
 
-							case TAM_Clamp:
-								for (uint32_t y = 0; y < mip_tile_size; ++ y)
+						default:
+							KFL_UNREACHABLE("Invalid texture addressing mode");
+						}
+						switch (addr_v)
+						{
+						case TAM_Mirror:
+							for (uint32_t y = 0; y < mip_tile_size; ++ y)
+							{
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_y[y * mip_border_size + x] = y;
-									}
+									border_coords_y[y * mip_border_size + x] = y;
 								}
-								break;
+							}
+							break;
 
-							case TAM_Border:
-								for (uint32_t y = 0; y < mip_tile_size; ++ y)
+						case TAM_Clamp:
+							for (uint32_t y = 0; y < mip_tile_size; ++ y)
+							{
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_y[y * mip_border_size + x] = -1;
-									}
+									border_coords_y[y * mip_border_size + x] = y;
 								}
-								break;
-
-							default:
-								KFL_UNREACHABLE("Invalid texture addressing mode");
 							}
+							break;
 
+						case TAM_Border:
 							for (uint32_t y = 0; y < mip_tile_size; ++ y)
 							{
 								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									if ((border_coords_x[y * mip_border_size + x] >= 0) && (border_coords_y[y * mip_border_size + x] >= 0))
-									{
-										texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_,
-											neighbor_data_ptr[0] + border_coords_y[y * mip_border_size + x] * mip_tile_with_border_size + border_coords_x[y * mip_border_size + x]);
-									}
-									else
-									{
-										texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_, border_clr);
-									}
+									border_coords_y[y * mip_border_size + x] = -1;
 								}
 							}
+							break;
+
+						default:
+							KFL_UNREACHABLE("Invalid texture addressing mode");
 						}
-						else
+
+						for (uint32_t y = 0; y < mip_tile_size; ++ y)
 						{
-							for (uint32_t y = 0; y < mip_tile_size; ++ y)
+							for (uint32_t x = 0; x < mip_border_size; ++ x)
 							{
-								for (uint32_t x = 0; x < mip_border_size; ++ x)
+								if ((border_coords_x[y * mip_border_size + x] >= 0) && (border_coords_y[y * mip_border_size + x] >= 0))
 								{
-									texel_op_.copy(data_with_border + (y + mip_border_size) * data_pitch + x * texel_size_,
-										neighbor_data_ptr[0] + y * mip_tile_size * texel_size_);
+									texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_,
+										neighbor_data_ptr[0] + border_coords_y[y * mip_border_size + x] * mip_tile_with_border_size + border_coords_x[y * mip_border_size + x]);
+								}
+								else
+								{
+									texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_, border_clr);
 								}
 							}
 						}
 					}
-					if ((neighbor_data_ptr[5] != nullptr) && in_same_image[i + 5])
+					else
 					{
 						for (uint32_t y = 0; y < mip_tile_size; ++ y)
 						{
-							texel_op_.copy_array(data_with_border + (y + mip_border_size) * data_pitch + (mip_border_size + mip_tile_size) * texel_size_,
-								neighbor_data_ptr[5] + y * mip_tile_size * texel_size_, mip_border_size);
+							for (uint32_t x = 0; x < mip_border_size; ++ x)
+							{
+								texel_op_.copy(data_with_border + (y + mip_border_size) * data_pitch + x * texel_size_,
+									neighbor_data_ptr[0] + y * mip_tile_size * texel_size_);
+							}
 						}
 					}
-					else
+				}
+				if ((neighbor_data_ptr[5] != nullptr) && in_same_image[5])
+				{
+					for (uint32_t y = 0; y < mip_tile_size; ++ y)
 					{
-						if (tile_info.attr != 0xFFFFFFFF)
+						texel_op_.copy_array(data_with_border + (y + mip_border_size) * data_pitch + (mip_border_size + mip_tile_size) * texel_size_,
+							neighbor_data_ptr[5] + y * mip_tile_size * texel_size_, mip_border_size);
+					}
+				}
+				else
+				{
+					if (attr != 0xFFFFFFFF)
+					{
+						std::vector<int32_t> border_coords_x(mip_border_size * mip_tile_size);
+						std::vector<int32_t> border_coords_y(mip_border_size * mip_tile_size);
+						switch (addr_u)
 						{
-							std::vector<int32_t> border_coords_x(mip_border_size * mip_tile_size);
-							std::vector<int32_t> border_coords_y(mip_border_size * mip_tile_size);
-							switch (addr_u)
+						case TAM_Mirror:
+							for (uint32_t y = 0; y < mip_tile_size; ++ y)
 							{
-							case TAM_Mirror:
-								for (uint32_t y = 0; y < mip_tile_size; ++ y)
-								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_x[y * mip_border_size + x] = mip_tile_size - 1 - x;
-									}
-								}
-								break;
-
-							case TAM_Clamp:
-								for (uint32_t y = 0; y < mip_tile_size; ++ y)
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_x[y * mip_border_size + x] = mip_tile_size - 1;
-									}
+									border_coords_x[y * mip_border_size + x] = mip_tile_size - 1 - x;
 								}
-								break;
+							}
+							break;
 
-							case TAM_Border:
-								for (uint32_t y = 0; y < mip_tile_size; ++ y)
+						case TAM_Clamp:
+							for (uint32_t y = 0; y < mip_tile_size; ++ y)
+							{
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_x[y * mip_border_size + x] = -1;
-									}
+									border_coords_x[y * mip_border_size + x] = mip_tile_size - 1;
 								}
-								break;
-
-							default:
-								KFL_UNREACHABLE("Invalid texture addressing mode");
 							}
-							switch (addr_v)
+							break;
+
+						case TAM_Border:
+							for (uint32_t y = 0; y < mip_tile_size; ++ y)
 							{
-							case TAM_Mirror:
-								for (uint32_t y = 0; y < mip_tile_size; ++ y)
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_y[y * mip_border_size + x] = y;
-									}
+									border_coords_x[y * mip_border_size + x] = -1;
 								}
-								break;
+							}
+							break;
 
-							case TAM_Clamp:
-								for (uint32_t y = 0; y < mip_tile_size; ++ y)
+						default:
+							KFL_UNREACHABLE("Invalid texture addressing mode");
+						}
+						switch (addr_v)
+						{
+						case TAM_Mirror:
+							for (uint32_t y = 0; y < mip_tile_size; ++ y)
+							{
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_y[y * mip_border_size + x] = y;
-									}
+									border_coords_y[y * mip_border_size + x] = y;
 								}
-								break;
+							}
+							break;
 
-							case TAM_Border:
-								for (uint32_t y = 0; y < mip_tile_size; ++ y)
+						case TAM_Clamp:
+							for (uint32_t y = 0; y < mip_tile_size; ++ y)
+							{
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_y[y * mip_border_size + x] = -1;
-									}
+									border_coords_y[y * mip_border_size + x] = y;
 								}
-								break;
-
-							default:
-								KFL_UNREACHABLE("Invalid texture addressing mode");
 							}
+							break;
 
+						case TAM_Border:
 							for (uint32_t y = 0; y < mip_tile_size; ++ y)
 							{
 								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									if ((border_coords_x[y * mip_border_size + x] >= 0) && (border_coords_y[y * mip_border_size + x] >= 0))
-									{
-										texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_,
-											neighbor_data_ptr[0] + border_coords_y[y * mip_border_size + x] * mip_tile_with_border_size + border_coords_x[y * mip_border_size + x]);
-									}
-									else
-									{
-										texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_, border_clr);
-									}
+									border_coords_y[y * mip_border_size + x] = -1;
 								}
 							}
+							break;
+
+						default:
+							KFL_UNREACHABLE("Invalid texture addressing mode");
 						}
-						else
+
+						for (uint32_t y = 0; y < mip_tile_size; ++ y)
 						{
-							for (uint32_t y = 0; y < mip_tile_size; ++ y)
+							for (uint32_t x = 0; x < mip_border_size; ++ x)
 							{
-								for (uint32_t x = 0; x < mip_border_size; ++ x)
+								if ((border_coords_x[y * mip_border_size + x] >= 0) && (border_coords_y[y * mip_border_size + x] >= 0))
+								{
+									texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_,
+										neighbor_data_ptr[0] + border_coords_y[y * mip_border_size + x] * mip_tile_with_border_size + border_coords_x[y * mip_border_size + x]);
+								}
+								else
 								{
-									texel_op_.copy(data_with_border + (y + mip_border_size) * data_pitch + (x + mip_border_size + mip_tile_size) * texel_size_,
-										neighbor_data_ptr[0] + (y * mip_tile_size + mip_tile_size - 1) * texel_size_);
+									texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_, border_clr);
 								}
 							}
 						}
 					}
-
-					if ((neighbor_data_ptr[6] != nullptr) && in_same_image[i + 6])
+					else
 					{
-						for (uint32_t y = 0; y < mip_border_size; ++ y)
+						for (uint32_t y = 0; y < mip_tile_size; ++ y)
 						{
-							texel_op_.copy_array(data_with_border + (y + mip_border_size + mip_tile_size) * data_pitch,
-								neighbor_data_ptr[6] + (y * mip_tile_size + (mip_tile_size - mip_border_size)) * texel_size_, mip_border_size);
+							for (uint32_t x = 0; x < mip_border_size; ++ x)
+							{
+								texel_op_.copy(data_with_border + (y + mip_border_size) * data_pitch + (x + mip_border_size + mip_tile_size) * texel_size_,
+									neighbor_data_ptr[0] + (y * mip_tile_size + mip_tile_size - 1) * texel_size_);
+							}
 						}
 					}
-					else
+				}
+
+				if ((neighbor_data_ptr[6] != nullptr) && in_same_image[6])
+				{
+					for (uint32_t y = 0; y < mip_border_size; ++ y)
 					{
-						if (tile_info.attr != 0xFFFFFFFF)
+						texel_op_.copy_array(data_with_border + (y + mip_border_size + mip_tile_size) * data_pitch,
+							neighbor_data_ptr[6] + (y * mip_tile_size + (mip_tile_size - mip_border_size)) * texel_size_, mip_border_size);
+					}
+				}
+				else
+				{
+					if (attr != 0xFFFFFFFF)
+					{
+						std::vector<int32_t> border_coords_x(mip_border_size * mip_border_size);
+						std::vector<int32_t> border_coords_y(mip_border_size * mip_border_size);
+						switch (addr_u)
 						{
-							std::vector<int32_t> border_coords_x(mip_border_size * mip_border_size);
-							std::vector<int32_t> border_coords_y(mip_border_size * mip_border_size);
-							switch (addr_u)
+						case TAM_Mirror:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
 							{
-							case TAM_Mirror:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
-								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_x[y * mip_border_size + x] = mip_border_size - 1 - x;
-									}
-								}
-								break;
-
-							case TAM_Clamp:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_x[y * mip_border_size + x] = 0;
-									}
+									border_coords_x[y * mip_border_size + x] = mip_border_size - 1 - x;
 								}
-								break;
+							}
+							break;
 
-							case TAM_Border:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+						case TAM_Clamp:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
+							{
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_x[y * mip_border_size + x] = -1;
-									}
+									border_coords_x[y * mip_border_size + x] = 0;
 								}
-								break;
-
-							default:
-								KFL_UNREACHABLE("Invalid texture addressing mode");
 							}
-							switch (addr_v)
+							break;
+
+						case TAM_Border:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
 							{
-							case TAM_Mirror:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_y[y * mip_border_size + x] = mip_tile_size - 1 - y;
-									}
+									border_coords_x[y * mip_border_size + x] = -1;
 								}
-								break;
+							}
+							break;
 
-							case TAM_Clamp:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+						default:
+							KFL_UNREACHABLE("Invalid texture addressing mode");
+						}
+						switch (addr_v)
+						{
+						case TAM_Mirror:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
+							{
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_y[y * mip_border_size + x] = mip_tile_size - 1;
-									}
+									border_coords_y[y * mip_border_size + x] = mip_tile_size - 1 - y;
 								}
-								break;
+							}
+							break;
 
-							case TAM_Border:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+						case TAM_Clamp:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
+							{
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_y[y * mip_border_size + x] = -1;
-									}
+									border_coords_y[y * mip_border_size + x] = mip_tile_size - 1;
 								}
-								break;
-
-							default:
-								KFL_UNREACHABLE("Invalid texture addressing mode");
 							}
+							break;
 
+						case TAM_Border:
 							for (uint32_t y = 0; y < mip_border_size; ++ y)
 							{
 								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									if ((border_coords_x[y * mip_border_size + x] >= 0) && (border_coords_y[y * mip_border_size + x] >= 0))
-									{
-										texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_,
-											neighbor_data_ptr[0] + border_coords_y[y * mip_border_size + x] * mip_tile_with_border_size + border_coords_x[y * mip_border_size + x]);
-									}
-									else
-									{
-										texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_, border_clr);
-									}
+									border_coords_y[y * mip_border_size + x] = -1;
 								}
 							}
+							break;
+
+						default:
+							KFL_UNREACHABLE("Invalid texture addressing mode");
 						}
-						else
+
+						for (uint32_t y = 0; y < mip_border_size; ++ y)
 						{
-							for (uint32_t y = 0; y < mip_border_size; ++ y)
+							for (uint32_t x = 0; x < mip_border_size; ++ x)
 							{
-								for (uint32_t x = 0; x < mip_border_size; ++ x)
+								if ((border_coords_x[y * mip_border_size + x] >= 0) && (border_coords_y[y * mip_border_size + x] >= 0))
 								{
-									texel_op_.copy(data_with_border + (y + mip_border_size + mip_tile_size) * data_pitch + x * texel_size_,
-										neighbor_data_ptr[0] + (mip_tile_size - 1) * mip_tile_size * texel_size_);
+									texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_,
+										neighbor_data_ptr[0] + border_coords_y[y * mip_border_size + x] * mip_tile_with_border_size + border_coords_x[y * mip_border_size + x]);
+								}
+								else
+								{
+									texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_, border_clr);
 								}
 							}
 						}
 					}
-					if ((neighbor_data_ptr[7] != nullptr) && in_same_image[i + 7])
+					else
 					{
 						for (uint32_t y = 0; y < mip_border_size; ++ y)
 						{
-							texel_op_.copy_array(data_with_border + (y + mip_border_size + mip_tile_size) * data_pitch + mip_border_size * texel_size_,
-								neighbor_data_ptr[7] + y * mip_tile_size * texel_size_, mip_tile_size);
+							for (uint32_t x = 0; x < mip_border_size; ++ x)
+							{
+								texel_op_.copy(data_with_border + (y + mip_border_size + mip_tile_size) * data_pitch + x * texel_size_,
+									neighbor_data_ptr[0] + (mip_tile_size - 1) * mip_tile_size * texel_size_);
+							}
 						}
 					}
-					else
+				}
+				if ((neighbor_data_ptr[7] != nullptr) && in_same_image[7])
+				{
+					for (uint32_t y = 0; y < mip_border_size; ++ y)
 					{
-						if (tile_info.attr != 0xFFFFFFFF)
+						texel_op_.copy_array(data_with_border + (y + mip_border_size + mip_tile_size) * data_pitch + mip_border_size * texel_size_,
+							neighbor_data_ptr[7] + y * mip_tile_size * texel_size_, mip_tile_size);
+					}
+				}
+				else
+				{
+					if (attr != 0xFFFFFFFF)
+					{
+						std::vector<int32_t> border_coords_x(mip_tile_size * mip_border_size);
+						std::vector<int32_t> border_coords_y(mip_tile_size * mip_border_size);
+						switch (addr_u)
 						{
-							std::vector<int32_t> border_coords_x(mip_tile_size * mip_border_size);
-							std::vector<int32_t> border_coords_y(mip_tile_size * mip_border_size);
-							switch (addr_u)
+						case TAM_Mirror:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
 							{
-							case TAM_Mirror:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
-								{
-									for (uint32_t x = 0; x < mip_tile_size; ++ x)
-									{
-										border_coords_x[y * mip_tile_size + x] = x;
-									}
-								}
-								break;
-
-							case TAM_Clamp:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+								for (uint32_t x = 0; x < mip_tile_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_tile_size; ++ x)
-									{
-										border_coords_x[y * mip_tile_size + x] = x;
-									}
+									border_coords_x[y * mip_tile_size + x] = x;
 								}
-								break;
+							}
+							break;
 
-							case TAM_Border:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+						case TAM_Clamp:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
+							{
+								for (uint32_t x = 0; x < mip_tile_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_tile_size; ++ x)
-									{
-										border_coords_x[y * mip_tile_size + x] = -1;
-									}
+									border_coords_x[y * mip_tile_size + x] = x;
 								}
-								break;
-
-							default:
-								KFL_UNREACHABLE("Invalid texture addressing mode");
 							}
-							switch (addr_v)
+							break;
+
+						case TAM_Border:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
 							{
-							case TAM_Mirror:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+								for (uint32_t x = 0; x < mip_tile_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_tile_size; ++ x)
-									{
-										border_coords_y[y * mip_tile_size + x] = mip_tile_size - 1 - y;
-									}
+									border_coords_x[y * mip_tile_size + x] = -1;
 								}
-								break;
+							}
+							break;
 
-							case TAM_Clamp:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+						default:
+							KFL_UNREACHABLE("Invalid texture addressing mode");
+						}
+						switch (addr_v)
+						{
+						case TAM_Mirror:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
+							{
+								for (uint32_t x = 0; x < mip_tile_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_tile_size; ++ x)
-									{
-										border_coords_y[y * mip_tile_size + x] = mip_tile_size - 1;
-									}
+									border_coords_y[y * mip_tile_size + x] = mip_tile_size - 1 - y;
 								}
-								break;
+							}
+							break;
 
-							case TAM_Border:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+						case TAM_Clamp:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
+							{
+								for (uint32_t x = 0; x < mip_tile_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_tile_size; ++ x)
-									{
-										border_coords_y[y * mip_tile_size + x] = -1;
-									}
+									border_coords_y[y * mip_tile_size + x] = mip_tile_size - 1;
 								}
-								break;
-
-							default:
-								KFL_UNREACHABLE("Invalid texture addressing mode");
 							}
+							break;
 
+						case TAM_Border:
 							for (uint32_t y = 0; y < mip_border_size; ++ y)
 							{
 								for (uint32_t x = 0; x < mip_tile_size; ++ x)
 								{
-									if ((border_coords_x[y * mip_tile_size + x] >= 0) && (border_coords_y[y * mip_tile_size + x] >= 0))
-									{
-										texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_,
-											neighbor_data_ptr[0] + border_coords_y[y * mip_tile_size + x] * mip_tile_with_border_size + border_coords_x[y * mip_tile_size + x]);
-									}
-									else
-									{
-										texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_, border_clr);
-									}
+									border_coords_y[y * mip_tile_size + x] = -1;
 								}
 							}
+							break;
+
+						default:
+							KFL_UNREACHABLE("Invalid texture addressing mode");
 						}
-						else
+
+						for (uint32_t y = 0; y < mip_border_size; ++ y)
 						{
-							for (uint32_t y = 0; y < mip_border_size; ++ y)
+							for (uint32_t x = 0; x < mip_tile_size; ++ x)
 							{
-								texel_op_.copy_array(data_with_border + (y + mip_border_size + mip_tile_size) * data_pitch + mip_border_size * texel_size_,
-									neighbor_data_ptr[0] + (mip_tile_size - 1) * mip_tile_size * texel_size_, mip_tile_size);
+								if ((border_coords_x[y * mip_tile_size + x] >= 0) && (border_coords_y[y * mip_tile_size + x] >= 0))
+								{
+									texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_,
+										neighbor_data_ptr[0] + border_coords_y[y * mip_tile_size + x] * mip_tile_with_border_size + border_coords_x[y * mip_tile_size + x]);
+								}
+								else
+								{
+									texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_, border_clr);
+								}
 							}
 						}
-					}			
-					if ((neighbor_data_ptr[8] != nullptr) && in_same_image[i + 8])
+					}
+					else
 					{
 						for (uint32_t y = 0; y < mip_border_size; ++ y)
 						{
-							texel_op_.copy_array(data_with_border + (y + mip_border_size + mip_tile_size) * data_pitch + (mip_border_size + mip_tile_size) * texel_size_,
-								neighbor_data_ptr[8] + y * mip_tile_size * texel_size_, mip_border_size);
+							texel_op_.copy_array(data_with_border + (y + mip_border_size + mip_tile_size) * data_pitch + mip_border_size * texel_size_,
+								neighbor_data_ptr[0] + (mip_tile_size - 1) * mip_tile_size * texel_size_, mip_tile_size);
 						}
 					}
-					else
+				}			
+				if ((neighbor_data_ptr[8] != nullptr) && in_same_image[8])
+				{
+					for (uint32_t y = 0; y < mip_border_size; ++ y)
 					{
-						if (tile_info.attr != 0xFFFFFFFF)
+						texel_op_.copy_array(data_with_border + (y + mip_border_size + mip_tile_size) * data_pitch + (mip_border_size + mip_tile_size) * texel_size_,
+							neighbor_data_ptr[8] + y * mip_tile_size * texel_size_, mip_border_size);
+					}
+				}
+				else
+				{
+					if (attr != 0xFFFFFFFF)
+					{
+						std::vector<int32_t> border_coords_x(mip_border_size * mip_border_size);
+						std::vector<int32_t> border_coords_y(mip_border_size * mip_border_size);
+						switch (addr_u)
 						{
-							std::vector<int32_t> border_coords_x(mip_border_size * mip_border_size);
-							std::vector<int32_t> border_coords_y(mip_border_size * mip_border_size);
-							switch (addr_u)
+						case TAM_Mirror:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
 							{
-							case TAM_Mirror:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
-								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_x[y * mip_border_size + x] = mip_tile_size - 1 - x;
-									}
-								}
-								break;
-
-							case TAM_Clamp:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_x[y * mip_border_size + x] = mip_tile_size - 1;
-									}
+									border_coords_x[y * mip_border_size + x] = mip_tile_size - 1 - x;
 								}
-								break;
+							}
+							break;
 
-							case TAM_Border:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+						case TAM_Clamp:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
+							{
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_x[y * mip_border_size + x] = -1;
-									}
+									border_coords_x[y * mip_border_size + x] = mip_tile_size - 1;
 								}
-								break;
-
-							default:
-								KFL_UNREACHABLE("Invalid texture addressing mode");
 							}
-							switch (addr_v)
+							break;
+
+						case TAM_Border:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
 							{
-							case TAM_Mirror:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_y[y * mip_border_size + x] = mip_tile_size - 1 - y;
-									}
+									border_coords_x[y * mip_border_size + x] = -1;
 								}
-								break;
+							}
+							break;
 
-							case TAM_Clamp:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+						default:
+							KFL_UNREACHABLE("Invalid texture addressing mode");
+						}
+						switch (addr_v)
+						{
+						case TAM_Mirror:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
+							{
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_y[y * mip_border_size + x] = mip_tile_size - 1;
-									}
+									border_coords_y[y * mip_border_size + x] = mip_tile_size - 1 - y;
 								}
-								break;
+							}
+							break;
 
-							case TAM_Border:
-								for (uint32_t y = 0; y < mip_border_size; ++ y)
+						case TAM_Clamp:
+							for (uint32_t y = 0; y < mip_border_size; ++ y)
+							{
+								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_border_size; ++ x)
-									{
-										border_coords_y[y * mip_border_size + x] = -1;
-									}
+									border_coords_y[y * mip_border_size + x] = mip_tile_size - 1;
 								}
-								break;
-
-							default:
-								KFL_UNREACHABLE("Invalid texture addressing mode");
 							}
+							break;
 
+						case TAM_Border:
 							for (uint32_t y = 0; y < mip_border_size; ++ y)
 							{
 								for (uint32_t x = 0; x < mip_border_size; ++ x)
 								{
-									if ((border_coords_x[y * mip_border_size + x] >= 0) && (border_coords_y[y * mip_border_size + x] >= 0))
-									{
-										texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_,
-											neighbor_data_ptr[0] + border_coords_y[y * mip_border_size + x] * mip_tile_with_border_size + border_coords_x[y * mip_border_size + x]);
-									}
-									else
-									{
-										texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_, border_clr);
-									}
+									border_coords_y[y * mip_border_size + x] = -1;
 								}
 							}
+							break;
+
+						default:
+							KFL_UNREACHABLE("Invalid texture addressing mode");
 						}
-						else
+
+						for (uint32_t y = 0; y < mip_border_size; ++ y)
 						{
-							for (uint32_t y = 0; y < mip_border_size; ++ y)
+							for (uint32_t x = 0; x < mip_border_size; ++ x)
 							{
-								for (uint32_t x = 0; x < mip_border_size; ++ x)
+								if ((border_coords_x[y * mip_border_size + x] >= 0) && (border_coords_y[y * mip_border_size + x] >= 0))
 								{
-									texel_op_.copy(data_with_border + (y + mip_border_size + mip_tile_size) * data_pitch + (x + mip_border_size + mip_tile_size) * texel_size_,
-										neighbor_data_ptr[0] + (mip_tile_size - 1) * mip_tile_size * texel_size_);
+									texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_,
+										neighbor_data_ptr[0] + border_coords_y[y * mip_border_size + x] * mip_tile_with_border_size + border_coords_x[y * mip_border_size + x]);
+								}
+								else
+								{
+									texel_op_.copy(data_with_border + y * data_pitch + x * texel_size_, border_clr);
 								}
 							}
 						}
 					}
+					else
+					{
+						for (uint32_t y = 0; y < mip_border_size; ++ y)
+						{
+							for (uint32_t x = 0; x < mip_border_size; ++ x)
+							{
+								texel_op_.copy(data_with_border + (y + mip_border_size + mip_tile_size) * data_pitch + (x + mip_border_size + mip_tile_size) * texel_size_,
+									neighbor_data_ptr[0] + (mip_tile_size - 1) * mip_tile_size * texel_size_);
+							}
+						}
+					}
 				}
+			}
 
-				ElementFormat format;
-				if (tex_cache_)
-				{
-					format = tex_cache_->Format();
-				}
-				else
-				{
-					format = tex_cache_array_[tile_info.z]->Format();
-				}
-
-				TexturePtr target_tex;
-				uint32_t target_array_index;
-				if (tex_cache_)
-				{
-					target_tex = tex_cache_;
-					target_array_index = tile_info.z;
-				}
-				else
-				{
-					target_tex = tex_cache_array_[tile_info.z];
-					target_array_index = 0;
-				}
-
-				if (IsCompressedFormat(format))
+			if (IsCompressedFormat(format))
+			{
+				uint32_t const block_width = codec->BlockWidth();
+				uint32_t const block_height = codec->BlockHeight();
+				uint32_t const block_bytes = NumFormatBytes(format) * 4;
+				uint32_t const bc_row_pitch = (mip_tile_with_border_size + block_width - 1) / block_width * block_bytes;
+				uint32_t const bc_slice_pitch = (mip_tile_with_border_size + block_height - 1) / block_height * bc_row_pitch;
+				std::vector<uint8_t> bc(bc_slice_pitch);
 				{
-					uint32_t const block_width = tex_codec_->BlockWidth();
-					uint32_t const block_height = tex_codec_->BlockHeight();
-					uint32_t const block_bytes = NumFormatBytes(format) * 4;
-					uint32_t const bc_row_pitch = (mip_tile_with_border_size + block_width - 1) / block_width * block_bytes;
-					uint32_t const bc_slice_pitch = (mip_tile_with_border_size + block_height - 1) / block_height * bc_row_pitch;
-					std::vector<uint8_t> bc(bc_slice_pitch);
+					uint8_t const * data_with_border = &tex_a_tile_data[0];
+					uint32_t const data_row_pitch = mip_tile_with_border_size * texel_size_;
+					uint32_t const data_slice_pitch = mip_tile_with_border_size
+						* mip_tile_with_border_size * texel_size_;
+
+					uint32_t const * p_argb;
+					uint32_t row_pitch;
+					uint32_t slice_pitch;
+					std::vector<uint32_t> argb_data;
+					switch (format_)
 					{
-						uint8_t const * data_with_border = &tex_a_tile_data[0];
-						uint32_t const data_row_pitch = mip_tile_with_border_size * texel_size_;
-						uint32_t const data_slice_pitch = mip_tile_with_border_size
-							* mip_tile_with_border_size * texel_size_;
-
-						uint32_t const * p_argb;
-						uint32_t row_pitch;
-						uint32_t slice_pitch;
-						std::vector<uint32_t> argb_data;
-						switch (format_)
+					case EF_R8:
 						{
-						case EF_R8:
+							argb_data.resize(mip_tile_with_border_size * mip_tile_with_border_size, 0);
+							for (uint32_t y = 0; y < mip_tile_with_border_size; ++ y)
 							{
-								argb_data.resize(mip_tile_with_border_size * mip_tile_with_border_size, 0);
-								for (uint32_t y = 0; y < mip_tile_with_border_size; ++ y)
+								for (uint32_t x = 0; x < mip_tile_with_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_tile_with_border_size; ++ x)
-									{
-										argb_data[y * mip_tile_with_border_size + x] = data_with_border[y * data_row_pitch + x] << 16;
-									}
+									argb_data[y * mip_tile_with_border_size + x] = data_with_border[y * data_row_pitch + x] << 16;
 								}
-								p_argb = &argb_data[0];
-								row_pitch = mip_tile_with_border_size * 4;
-								slice_pitch = mip_tile_with_border_size * row_pitch;
 							}
-							break;
+							p_argb = &argb_data[0];
+							row_pitch = mip_tile_with_border_size * 4;
+							slice_pitch = mip_tile_with_border_size * row_pitch;
+						}
+						break;
 
-						case EF_GR8:
+					case EF_GR8:
+						{
+							argb_data.resize(mip_tile_with_border_size * mip_tile_with_border_size, 0);
+							for (uint32_t y = 0; y < mip_tile_with_border_size; ++ y)
 							{
-								argb_data.resize(mip_tile_with_border_size * mip_tile_with_border_size, 0);
-								for (uint32_t y = 0; y < mip_tile_with_border_size; ++ y)
+								for (uint32_t x = 0; x < mip_tile_with_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_tile_with_border_size; ++ x)
-									{
-										argb_data[y * mip_tile_with_border_size + x] = (data_with_border[y * data_row_pitch + x * 2 + 0] << 16)
-											| (data_with_border[y * data_row_pitch + x * 2 + 1] << 8);
-									}
+									argb_data[y * mip_tile_with_border_size + x] = (data_with_border[y * data_row_pitch + x * 2 + 0] << 16)
+										| (data_with_border[y * data_row_pitch + x * 2 + 1] << 8);
 								}
-								p_argb = &argb_data[0];
-								row_pitch = mip_tile_with_border_size * 4;
-								slice_pitch = mip_tile_with_border_size * row_pitch;
 							}
-							break;
+							p_argb = &argb_data[0];
+							row_pitch = mip_tile_with_border_size * 4;
+							slice_pitch = mip_tile_with_border_size * row_pitch;
+						}
+						break;
 
-						case EF_ABGR8:
+					case EF_ABGR8:
+						{
+							argb_data.resize(mip_tile_with_border_size * mip_tile_with_border_size, 0);
+							for (uint32_t y = 0; y < mip_tile_with_border_size; ++ y)
 							{
-								argb_data.resize(mip_tile_with_border_size * mip_tile_with_border_size, 0);
-								for (uint32_t y = 0; y < mip_tile_with_border_size; ++ y)
+								for (uint32_t x = 0; x < mip_tile_with_border_size; ++ x)
 								{
-									for (uint32_t x = 0; x < mip_tile_with_border_size; ++ x)
-									{
-										argb_data[y * mip_tile_with_border_size + x] = (data_with_border[y * data_row_pitch + x * 4 + 0] << 16)
-											| (data_with_border[y * data_row_pitch + x * 4 + 1] << 8)
-											| (data_with_border[y * data_row_pitch + x * 4 + 2] << 0)
-											| (data_with_border[y * data_row_pitch + x * 4 + 3] << 24);
-									}
+									argb_data[y * mip_tile_with_border_size + x] = (data_with_border[y * data_row_pitch + x * 4 + 0] << 16)
+										| (data_with_border[y * data_row_pitch + x * 4 + 1] << 8)
+										| (data_with_border[y * data_row_pitch + x * 4 + 2] << 0)
+										| (data_with_border[y * data_row_pitch + x * 4 + 3] << 24);
 								}
-								p_argb = &argb_data[0];
-								row_pitch = mip_tile_with_border_size * 4;
-								slice_pitch = mip_tile_with_border_size * row_pitch;
 							}
-							break;
-
-						case EF_ARGB8:
-							p_argb = reinterpret_cast<uint32_t const *>(data_with_border);
-							row_pitch = data_row_pitch;
-							slice_pitch = data_slice_pitch;
-							break;
-
-						default:
-							KFL_UNREACHABLE("Not supported element format");
+							p_argb = &argb_data[0];
+							row_pitch = mip_tile_with_border_size * 4;
+							slice_pitch = mip_tile_with_border_size * row_pitch;
 						}
+						break;
+
+					case EF_ARGB8:
+						p_argb = reinterpret_cast<uint32_t const *>(data_with_border);
+						row_pitch = data_row_pitch;
+						slice_pitch = data_slice_pitch;
+						break;
 
-						tex_codec_->EncodeMem(mip_tile_with_border_size, mip_tile_with_border_size,
-							&bc[0], bc_row_pitch, bc_slice_pitch, p_argb, row_pitch, slice_pitch, TCM_Quality);
+					default:
+						KFL_UNREACHABLE("Not supported element format");
 					}
 
-					target_tex->UpdateSubresource2D(target_array_index, l,
-						tile_info.x * mip_tile_with_border_size, tile_info.y * mip_tile_with_border_size,
-						mip_tile_with_border_size, mip_tile_with_border_size,
-						&bc[0], bc_row_pitch);
-				}
-				else
-				{
-					target_tex->UpdateSubresource2D(target_array_index, l,
-						tile_info.x * mip_tile_with_border_size, tile_info.y * mip_tile_with_border_size,
-						mip_tile_with_border_size, mip_tile_with_border_size,
-						&tex_a_tile_data[0], mip_tile_with_border_size * texel_size_);
+					codec->EncodeMem(mip_tile_with_border_size, mip_tile_with_border_size,
+						&bc[0], bc_row_pitch, bc_slice_pitch, p_argb, row_pitch, slice_pitch, TCM_Quality);
 				}
 
-				mip_tile_size /= 2;
-				mip_tile_with_border_size /= 2;
-				mip_border_size /= 2;
+				cache_tile.mips[l].swap(bc);
+				cache_tile.row_pitches[l] = bc_row_pitch;
 			}
+			else
+			{
+				cache_tile.mips[l].swap(tex_a_tile_data);
+				cache_tile.row_pitches[l] = mip_tile_with_border_size * texel_size_;
+			}
+
+			mip_tile_size /= 2;
+			mip_tile_with_border_size /= 2;
+			mip_border_size /= 2;
+		}
+	}
 
-			uint8_t const a_tile_indirect[] =
+	bool JudaTexture::UploadCacheTile(CacheTileData const & cache_tile, bool evict_in_use)
+	{
+		uint32_t s;
+		if (num_used_cache_slots_ < cache_slots_.size())
+		{
+			s = num_used_cache_slots_;
+			++ num_used_cache_slots_;
+		}
+		else
+		{
+			// Reuses the least recently used slot. Streamed tiles are collected before this call's RequestTiles, so the
+			//  tiles drawn by the previous call are still in use too.
+			s = lru_tail_;
+			if (!evict_in_use && (cache_slots_[s].tick + 1 >= tile_tick_))
 			{
-				static_cast<uint8_t>(tile_info.x),
-				static_cast<uint8_t>(tile_info.y),
-				static_cast<uint8_t>(tile_info.z),
-				0
-			};
-			uint32_t level, tile_x, tile_y;
-			this->DecodeTileID(level, tile_x, tile_y, all_neighbor_ids[i]);
+				return false;
+			}
+
+			resident_tiles_.erase(cache_slots_[s].shuff);
+			this->UnlinkSlot(s);
+		}
+
+		CacheSlot& slot = cache_slots_[s];
+		slot.shuff = cache_tile.shuff;
+		slot.tick = tile_tick_;
+		this->LinkSlotToFront(s);
+		resident_tiles_.emplace(cache_tile.shuff, s);
+
+		uint32_t const z = s / num_cache_tiles_a_layer_;
+		uint32_t const y = (s - z * num_cache_tiles_a_layer_) / num_cache_tiles_a_row_;
+		uint32_t const x = s - z * num_cache_tiles_a_layer_ - y * num_cache_tiles_a_row_;
+
+		TexturePtr target_tex;
+		uint32_t target_array_index;
+		if (tex_cache_)
+		{
+			target_tex = tex_cache_;
+			target_array_index = z;
+		}
+		else
+		{
+			target_tex = tex_cache_array_[z];
+			target_array_index = 0;
+		}
+
+		uint32_t mip_tile_with_border_size = cache_tile_size_ + cache_tile_border_size_ * 2;
+		for (uint32_t l = 0; l < cache_tile.mips.size(); ++ l)
+		{
+			target_tex->UpdateSubresource2D(target_array_index, l,
+				x * mip_tile_with_border_size, y * mip_tile_with_border_size,
+				mip_tile_with_border_size, mip_tile_with_border_size,
+				&cache_tile.mips[l][0], cache_tile.row_pitches[l]);
+
+			mip_tile_with_border_size /= 2;
+		}
+
+		return true;
+	}
+
+	void JudaTexture::WriteIndirect(uint32_t tile_id, uint32_t slot, uint32_t level_delta)
+	{
+		uint32_t const z = slot / num_cache_tiles_a_layer_;
+		uint32_t const y = (slot - z * num_cache_tiles_a_layer_) / num_cache_tiles_a_row_;
+		uint32_t const x = slot - z * num_cache_tiles_a_layer_ - y * num_cache_tiles_a_row_;
+
+		uint8_t const a_tile_indirect[] =
+		{
+			static_cast<uint8_t>(x),
+			static_cast<uint8_t>(y),
+			static_cast<uint8_t>(z),
+			static_cast<uint8_t>(level_delta)
+		};
+		uint32_t entry;
+		std::memcpy(&entry, a_tile_indirect, sizeof(entry));
+
+		uint32_t level, tile_x, tile_y;
+		this->DecodeTileID(level, tile_x, tile_y, tile_id);
+
+		// Only changed entries are uploaded
+		uint32_t const key = (tile_y << MAX_TREE_LEVEL) | tile_x;
+		auto iter = indirect_entries_.find(key);
+		if ((iter == indirect_entries_.end()) || (iter->second != entry))
+		{
 			tex_indirect_->UpdateSubresource2D(0, 0, tile_x, tile_y, 1, 1, a_tile_indirect, sizeof(a_tile_indirect));
+			indirect_entries_[key] = entry;
+		}
+	}
 
-			tim.emplace(all_neighbor_ids[i], tile_info);
+	void JudaTexture::UnlinkSlot(uint32_t s)
+	{
+		CacheSlot& slot = cache_slots_[s];
+		if (slot.prev != INVALID_SLOT)
+		{
+			cache_slots_[slot.prev].next = slot.next;
+		}
+		else
+		{
+			lru_head_ = slot.next;
+		}
+		if (slot.next != INVALID_SLOT)
+		{
+			cache_slots_[slot.next].prev = slot.prev;
+		}
+		else
+		{
+			lru_tail_ = slot.prev;
+		}
+		slot.prev = INVALID_SLOT;
+		slot.next = INVALID_SLOT;
+	}
+
+	void JudaTexture::LinkSlotToFront(uint32_t s)
+	{
+		CacheSlot& slot = cache_slots_[s];
+		slot.prev = INVALID_SLOT;
+		slot.next = lru_head_;
+		if (lru_head_ != INVALID_SLOT)
+		{
+			cache_slots_[lru_head_].prev = s;
+		}
+		else
+		{
+			lru_tail_ = s;
+		}
+		lru_head_ = s;
+	}
+
+	void JudaTexture::MoveSlotToFront(uint32_t s)
+	{
+		if (lru_head_ != s)
+		{
+			this->UnlinkSlot(s);
+			this->LinkSlotToFront(s);
 		}
 	}
 }
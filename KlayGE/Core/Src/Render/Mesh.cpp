@@ -20,6 +20,7 @@
 //////////////////////////////////////////////////////////////////////////////////
 
 #include <KlayGE/KlayGE.hpp>
+#include <KFL/ErrorHandling.hpp>
 #include <KFL/Math.hpp>
 #include <KlayGE/Context.hpp>
 #include <KlayGE/RenderFactory.hpp>
@@ -33,9 +34,12 @@
 #include <KlayGE/Light.hpp>
 #include <KlayGE/RenderMaterial.hpp>
 #include <KFL/Hash.hpp>
+#include <KFL/Thread.hpp>
+#include <KFL/SIMDMath.hpp>
 
 #include <algorithm>
 #include <fstream>
+#include <limits>
 #include <sstream>
 #include <cstring>
 
@@ -47,7 +51,56 @@ namespace
 {
 	using namespace KlayGE;
 
-	uint32_t const MODEL_BIN_VERSION = 15;
+	uint32_t const MODEL_BIN_VERSION = 18;
+	size_t const MODELS_PER_ANIMATION_TASK = 4;
+
+	// The last key not after frame, as found by upper_bound. cursor is the key found last time. During playback it is
+	//  usually still right, or one key behind.
+	uint32_t FindFirstKey(uint32_t const * frame_ids, uint32_t num_keys, float frame, uint32_t cursor)
+	{
+		auto is_key0 = [frame_ids, num_keys, frame](uint32_t index)
+		{
+			return (index < num_keys) && (frame_ids[index] <= frame)
+				&& ((index + 1 == num_keys) || (frame < frame_ids[index + 1]));
+		};
+		if (!is_key0(cursor))
+		{
+			if (is_key0(cursor + 1))
+			{
+				++ cursor;
+			}
+			else
+			{
+				uint32_t const * iter = std::upper_bound(frame_ids, frame_ids + num_keys, frame);
+				cursor = static_cast<uint32_t>(std::max<ptrdiff_t>(iter - frame_ids, 1) - 1);
+			}
+		}
+		return cursor;
+	}
+
+	// Frames sampled from the clip of an action. SkinnedModel plays frames between two actions, and before the first
+	//  one, from the clip of the action started last, so the clip has to keep the keys of those frames too.
+	void ActionClipRange(AnimationActionsType const & actions, uint32_t index, uint32_t num_frames,
+		uint32_t& start_frame, uint32_t& end_frame)
+	{
+		AnimationAction const & action = actions[index];
+
+		bool first = true;
+		end_frame = std::max(action.end_frame, num_frames);
+		for (auto const & other : actions)
+		{
+			if (other.start_frame < action.start_frame)
+			{
+				first = false;
+			}
+			else if (other.start_frame > action.start_frame)
+			{
+				end_frame = std::min(end_frame, other.start_frame);
+			}
+		}
+		end_frame = std::max(end_frame, action.end_frame);
+		start_frame = first ? 0 : action.start_frame;
+	}
 
 	class RenderModelLoadingDesc : public ResLoadingDesc
 	{
@@ -87,7 +140,7 @@ namespace
 
 				std::vector<Joint> joints;
 				std::shared_ptr<AnimationActionsType> actions;
-				std::shared_ptr<KeyFramesType> kfs;
+				std::vector<AnimationClipPtr> clips;
 				uint32_t num_frames;
 				uint32_t frame_rate;
 				std::vector<std::shared_ptr<AABBKeyFrames>> frame_pos_bbs;
@@ -154,7 +207,7 @@ namespace
 				pos_bbs, tc_bbs,
 				mesh_num_vertices, mesh_base_vertices,
 				mesh_num_indices, mesh_start_indices,
-				model_desc_.model_data->joints, model_desc_.model_data->actions, model_desc_.model_data->kfs,
+				model_desc_.model_data->joints, model_desc_.model_data->actions, model_desc_.model_data->clips,
 				model_desc_.model_data->num_frames, model_desc_.model_data->frame_rate,
 				model_desc_.model_data->frame_pos_bbs);
 
@@ -199,6 +252,15 @@ namespace
 			return true;
 		}
 
+		size_t Key() const override
+		{
+			size_t seed = 0;
+			HashCombine(seed, this->Type());
+			HashRange(seed, model_desc_.res_name.begin(), model_desc_.res_name.end());
+			HashCombine(seed, model_desc_.access_hint);
+			return seed;
+		}
+
 		bool Match(ResLoadingDesc const & rhs) const override
 		{
 			if (this->Type() == rhs.Type())
@@ -280,7 +342,8 @@ namespace
 						joints[i] = rhs_skinned_model->GetJoint(i);
 					}
 					skinned_model->AssignJoints(joints.begin(), joints.end());
-					skinned_model->AttachKeyFrames(rhs_skinned_model->GetKeyFrames());
+					skinned_model->AttachActions(rhs_skinned_model->GetActions());
+					skinned_model->AttachAnimationClips(rhs_skinned_model->GetAnimationClips());
 
 					skinned_model->NumFrames(rhs_skinned_model->NumFrames());
 					skinned_model->FrameRate(rhs_skinned_model->FrameRate());
@@ -364,14 +427,15 @@ namespace
 				}
 			}
 
-			if (model_desc_.model_data->kfs && !model_desc_.model_data->kfs->empty())
+			if (!model_desc_.model_data->clips.empty())
 			{
 				if (!model_desc_.model_data->joints.empty())
 				{
 					SkinnedModelPtr skinned_model = checked_pointer_cast<SkinnedModel>(model);
 
 					skinned_model->AssignJoints(model_desc_.model_data->joints.begin(), model_desc_.model_data->joints.end());
-					skinned_model->AttachKeyFrames(model_desc_.model_data->kfs);
+					skinned_model->AttachActions(model_desc_.model_data->actions);
+					skinned_model->AttachAnimationClips(model_desc_.model_data->clips);
 
 					skinned_model->NumFrames(model_desc_.model_data->num_frames);
 					skinned_model->FrameRate(model_desc_.model_data->frame_rate);
@@ -707,22 +771,265 @@ namespace KlayGE
 		}
 		else
 		{
-			frame = std::fmod(frame, static_cast<float>(frame_id.back() + 1));
-
-			auto iter = std::upper_bound(frame_id.begin(), frame_id.end(), frame);
-			int index = static_cast<int>(iter - frame_id.begin());
-
-			int index0 = index - 1;
-			int index1 = index % frame_id.size();
-			int frame0 = frame_id[index0];
-			int frame1 = frame_id[index1];
-			float factor = (frame - frame0) / (frame1 - frame0);
-			ret.first = MathLib::sclerp(bind_real[index0], bind_dual[index0], bind_real[index1], bind_dual[index1], factor);
+			uint32_t cursor = 0;
+			uint32_t index0, index1;
+			float const factor = this->FrameKeys(frame, cursor, index0, index1);
+			// The same blend as SkinnedModel::BuildBones, so tools see the poses the runtime draws
+			SIMDMathLib::BlendDualQuaternions(&ret.first.first, &ret.first.second,
+				&bind_real[index0], &bind_dual[index0], &bind_real[index1], &bind_dual[index1], &factor, 1);
 			ret.second = MathLib::lerp(bind_scale[index0], bind_scale[index1], factor);
 		}
 		return ret;
 	}
 
+	float KeyFrames::FrameKeys(float frame, uint32_t& cursor, uint32_t& index0, uint32_t& index1) const
+	{
+		uint32_t const num_keys = static_cast<uint32_t>(frame_id.size());
+		if (1 == num_keys)
+		{
+			cursor = 0;
+			index0 = 0;
+			index1 = 0;
+			return 0;
+		}
+
+		frame = std::fmod(frame, static_cast<float>(frame_id.back() + 1));
+		cursor = FindFirstKey(&frame_id[0], num_keys, frame, cursor);
+
+		index0 = cursor;
+		index1 = (cursor + 1) % num_keys;
+		float const frame0 = static_cast<float>(frame_id[index0]);
+		float const frame1 = static_cast<float>(frame_id[index1]);
+		return (frame - frame0) / (frame1 - frame0);
+	}
+
+
+	AnimationClip::AnimationClip()
+		: start_frame_(0), end_frame_(0)
+	{
+	}
+
+	AnimationClip::AnimationClip(KeyFramesType const & kfs, uint32_t start_frame, uint32_t end_frame)
+		: start_frame_(start_frame), end_frame_(end_frame)
+	{
+		std::vector<float3> trans;
+
+		tracks_.resize(kfs.size());
+		for (size_t i = 0; i < kfs.size(); ++ i)
+		{
+			KeyFrames const & kf = kfs[i];
+			BOOST_ASSERT(!kf.frame_id.empty());
+
+			// Keys in the range, and the ones around it to interpolate from
+			uint32_t const num_kf = static_cast<uint32_t>(kf.frame_id.size());
+			uint32_t first = static_cast<uint32_t>(
+				std::upper_bound(kf.frame_id.begin(), kf.frame_id.end(), start_frame) - kf.frame_id.begin());
+			first = std::max(first, 1U) - 1;
+			uint32_t last = static_cast<uint32_t>(
+				std::lower_bound(kf.frame_id.begin(), kf.frame_id.end(), end_frame) - kf.frame_id.begin());
+			last = std::max(std::min(last, num_kf - 1), first);
+
+			Track& track = tracks_[i];
+			track.first_key = static_cast<uint32_t>(keys_.size());
+			track.num_keys = last - first + 1;
+
+			float3 trans_min(+std::numeric_limits<float>::max(), +std::numeric_limits<float>::max(),
+				+std::numeric_limits<float>::max());
+			float3 trans_max(-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(),
+				-std::numeric_limits<float>::max());
+			trans.resize(track.num_keys);
+			for (uint32_t k = first; k <= last; ++ k)
+			{
+				trans[k - first] = MathLib::udq_to_trans(kf.bind_real[k], kf.bind_dual[k]);
+				trans_min = MathLib::minimize(trans_min, trans[k - first]);
+				trans_max = MathLib::maximize(trans_max, trans[k - first]);
+			}
+			track.trans_min = trans_min;
+			track.trans_step = (trans_max - trans_min) / 65535.0f;
+
+			for (uint32_t k = first; k <= last; ++ k)
+			{
+				Quaternion const real = MathLib::normalize(kf.bind_real[k]);
+
+				Key key;
+				for (int c = 0; c < 4; ++ c)
+				{
+					key.real[c] = static_cast<int16_t>(MathLib::clamp(std::lround(real[c] * 32767), -32767L, 32767L));
+				}
+				for (int c = 0; c < 3; ++ c)
+				{
+					key.trans[c] = (track.trans_step[c] > 0)
+						? static_cast<uint16_t>(MathLib::clamp(std::lround((trans[k - first][c] - trans_min[c]) / track.trans_step[c]), 0L, 65535L))
+						: 0;
+				}
+				key.scale = half(kf.bind_scale[k]);
+
+				frame_ids_.push_back(kf.frame_id[k]);
+				keys_.push_back(key);
+			}
+		}
+	}
+
+	float AnimationClip::FrameKeys(uint32_t track, float frame, uint32_t& cursor, uint32_t& index0, uint32_t& index1) const
+	{
+		Track const & t = tracks_[track];
+		uint32_t const * frame_ids = &frame_ids_[t.first_key];
+
+		cursor = FindFirstKey(frame_ids, t.num_keys, frame, cursor);
+
+		index0 = cursor;
+		index1 = std::min(cursor + 1, t.num_keys - 1);
+		if (index0 == index1)
+		{
+			return 0;
+		}
+		float const frame0 = static_cast<float>(frame_ids[index0]);
+		float const frame1 = static_cast<float>(frame_ids[index1]);
+		return MathLib::clamp((frame - frame0) / (frame1 - frame0), 0.0f, 1.0f);
+	}
+
+	void AnimationClip::DecodeKey(uint32_t track, uint32_t index, Quaternion& real, Quaternion& dual, float& scale) const
+	{
+		Track const & t = tracks_[track];
+		Key const & key = keys_[t.first_key + index];
+
+		real = MathLib::normalize(Quaternion(key.real[0], key.real[1], key.real[2], key.real[3]));
+		float3 const trans = t.trans_min + float3(key.trans[0], key.trans[1], key.trans[2]) * t.trans_step;
+		dual = MathLib::quat_trans_to_udq(real, trans);
+		scale = key.scale;
+	}
+
+	void AnimationClip::AppendKeyFrames(KeyFramesType& kfs) const
+	{
+		if (kfs.size() < tracks_.size())
+		{
+			kfs.resize(tracks_.size());
+		}
+
+		for (uint32_t i = 0; i < tracks_.size(); ++ i)
+		{
+			KeyFrames& kf = kfs[i];
+			for (uint32_t k = 0; k < tracks_[i].num_keys; ++ k)
+			{
+				// Keys around the range are shared with the neighbor clips
+				uint32_t const frame_id = this->KeyFrameId(i, k);
+				auto const iter = std::lower_bound(kf.frame_id.begin(), kf.frame_id.end(), frame_id);
+				if ((iter == kf.frame_id.end()) || (*iter != frame_id))
+				{
+					Quaternion real, dual;
+					float scale;
+					this->DecodeKey(i, k, real, dual, scale);
+
+					ptrdiff_t const offset = iter - kf.frame_id.begin();
+					kf.frame_id.insert(iter, frame_id);
+					kf.bind_real.insert(kf.bind_real.begin() + offset, real);
+					kf.bind_dual.insert(kf.bind_dual.begin() + offset, dual);
+					kf.bind_scale.insert(kf.bind_scale.begin() + offset, scale);
+				}
+			}
+		}
+	}
+
+	void AnimationClip::Read(ResIdentifier& res)
+	{
+		static_assert(sizeof(Key) == 16, "A key should be packed into 16 bytes");
+
+		res.read(&start_frame_, sizeof(start_frame_));
+		start_frame_ = LE2Native(start_frame_);
+		res.read(&end_frame_, sizeof(end_frame_));
+		end_frame_ = LE2Native(end_frame_);
+
+		uint32_t num_tracks;
+		res.read(&num_tracks, sizeof(num_tracks));
+		num_tracks = LE2Native(num_tracks);
+
+		uint32_t num_keys = 0;
+		tracks_.resize(num_tracks);
+		for (auto& track : tracks_)
+		{
+			track.first_key = num_keys;
+			res.read(&track.num_keys, sizeof(track.num_keys));
+			track.num_keys = LE2Native(track.num_keys);
+			res.read(&track.trans_min, sizeof(track.trans_min));
+			res.read(&track.trans_step, sizeof(track.trans_step));
+			for (int c = 0; c < 3; ++ c)
+			{
+				track.trans_min[c] = LE2Native(track.trans_min[c]);
+				track.trans_step[c] = LE2Native(track.trans_step[c]);
+			}
+
+			num_keys += track.num_keys;
+		}
+
+		frame_ids_.resize(num_keys);
+		keys_.resize(num_keys);
+		if (num_keys > 0)
+		{
+			res.read(&frame_ids_[0], frame_ids_.size() * sizeof(frame_ids_[0]));
+			res.read(&keys_[0], keys_.size() * sizeof(keys_[0]));
+		}
+		for (uint32_t k = 0; k < num_keys; ++ k)
+		{
+			frame_ids_[k] = LE2Native(frame_ids_[k]);
+
+			Key& key = keys_[k];
+			for (int c = 0; c < 4; ++ c)
+			{
+				key.real[c] = LE2Native(key.real[c]);
+			}
+			for (int c = 0; c < 3; ++ c)
+			{
+				key.trans[c] = LE2Native(key.trans[c]);
+			}
+			key.scale = LE2Native(key.scale);
+		}
+	}
+
+	void AnimationClip::Write(std::ostream& os) const
+	{
+		uint32_t start_frame = Native2LE(start_frame_);
+		os.write(reinterpret_cast<char*>(&start_frame), sizeof(start_frame));
+		uint32_t end_frame = Native2LE(end_frame_);
+		os.write(reinterpret_cast<char*>(&end_frame), sizeof(end_frame));
+
+		uint32_t num_tracks = Native2LE(static_cast<uint32_t>(tracks_.size()));
+		os.write(reinterpret_cast<char*>(&num_tracks), sizeof(num_tracks));
+
+		for (auto const & track : tracks_)
+		{
+			uint32_t num_keys = Native2LE(track.num_keys);
+			os.write(reinterpret_cast<char*>(&num_keys), sizeof(num_keys));
+			float3 trans_min;
+			float3 trans_step;
+			for (int c = 0; c < 3; ++ c)
+			{
+				trans_min[c] = Native2LE(track.trans_min[c]);
+				trans_step[c] = Native2LE(track.trans_step[c]);
+			}
+			os.write(reinterpret_cast<char*>(&trans_min), sizeof(trans_min));
+			os.write(reinterpret_cast<char*>(&trans_step), sizeof(trans_step));
+		}
+
+		for (auto frame_id : frame_ids_)
+		{
+			frame_id = Native2LE(frame_id);
+			os.write(reinterpret_cast<char*>(&frame_id), sizeof(frame_id));
+		}
+		for (auto key : keys_)
+		{
+			for (int c = 0; c < 4; ++ c)
+			{
+				key.real[c] = Native2LE(key.real[c]);
+			}
+			for (int c = 0; c < 3; ++ c)
+			{
+				key.trans[c] = Native2LE(key.trans[c]);
+			}
+			key.scale = Native2LE(key.scale);
+			os.write(reinterpret_cast<char*>(&key), sizeof(key));
+		}
+	}
+
 	AABBox AABBKeyFrames::Frame(float frame) const
 	{
 		if (frame_id.size() == 1)
@@ -756,12 +1063,49 @@ namespace KlayGE
 	
 	void SkinnedModel::BuildBones(float frame)
 	{
-		for (size_t i = 0; i < joints_.size(); ++ i)
+		if (num_frames_ > 0)
+		{
+			frame = std::fmod(frame, static_cast<float>(num_frames_));
+		}
+
+		uint32_t const action = this->ActionOfFrame(frame);
+		if ((action >= clips_.size()) || !clips_[action])
+		{
+			// The clip isn't streamed in yet
+			return;
+		}
+		AnimationClip const & clip = *clips_[action];
+
+		size_t const num_joints = joints_.size();
+		BOOST_ASSERT(clip.NumTracks() >= num_joints);
+		key_cursors_.resize(num_joints, 0);
+		this->ResizeJointScratch();
+
+		// Keys of all joints are gathered first, and blended in one batch
+		for (uint32_t i = 0; i < num_joints; ++ i)
+		{
+			uint32_t index0, index1;
+			float const factor = clip.FrameKeys(i, frame, key_cursors_[i], index0, index1);
+			float scale0, scale1;
+			clip.DecodeKey(i, index0, joint_reals_[0][i], joint_duals_[0][i], scale0);
+			clip.DecodeKey(i, index1, joint_reals_[1][i], joint_duals_[1][i], scale1);
+			joint_factors_[i] = factor;
+			joint_scales_[i] = MathLib::lerp(scale0, scale1, factor);
+		}
+		if (num_joints > 0)
+		{
+			SIMDMathLib::BlendDualQuaternions(&joint_reals_[0][0], &joint_duals_[0][0],
+				&joint_reals_[0][0], &joint_duals_[0][0], &joint_reals_[1][0], &joint_duals_[1][0],
+				&joint_factors_[0], num_joints);
+		}
+
+		// Parents come before their children
+		for (size_t i = 0; i < num_joints; ++ i)
 		{
 			Joint& joint = joints_[i];
-			KeyFrames const & kf = (*key_frames_)[i];
 
-			std::pair<std::pair<Quaternion, Quaternion>, float> key_dq = kf.Frame(frame);
+			std::pair<std::pair<Quaternion, Quaternion>, float> key_dq(
+				std::make_pair(joint_reals_[0][i], joint_duals_[0][i]), joint_scales_[i]);
 
 			if (joint.parent != -1)
 			{
@@ -823,9 +1167,27 @@ namespace KlayGE
 
 	void SkinnedModel::UpdateBinds()
 	{
-		bind_reals_.resize(joints_.size());
-		bind_duals_.resize(joints_.size());
-		for (size_t i = 0; i < joints_.size(); ++ i)
+		size_t const num_joints = joints_.size();
+		bind_reals_.resize(num_joints);
+		bind_duals_.resize(num_joints);
+		this->ResizeJointScratch();
+
+		// Products for the common case of positive scales are done in one batch
+		for (size_t i = 0; i < num_joints; ++ i)
+		{
+			Joint const & joint = joints_[i];
+			joint_reals_[0][i] = joint.inverse_origin_real;
+			joint_duals_[0][i] = joint.inverse_origin_dual;
+			joint_reals_[1][i] = joint.bind_real;
+			joint_duals_[1][i] = joint.bind_dual;
+		}
+		if (num_joints > 0)
+		{
+			SIMDMathLib::MultiplyDualQuaternions(&joint_reals_[0][0], &joint_duals_[0][0],
+				&joint_reals_[0][0], &joint_duals_[0][0], &joint_reals_[1][0], &joint_duals_[1][0], num_joints);
+		}
+
+		for (size_t i = 0; i < num_joints; ++ i)
 		{
 			Joint const & joint = joints_[i];
 
@@ -833,9 +1195,8 @@ namespace KlayGE
 			float bind_scale;
 			if ((MathLib::SignBit(joint.inverse_origin_scale) > 0) && (MathLib::SignBit(joint.bind_scale) > 0))
 			{
-				bind_real = MathLib::mul_real(joint.inverse_origin_real, joint.bind_real);
-				bind_dual = MathLib::mul_dual(joint.inverse_origin_real, joint.inverse_origin_dual,
-					joint.bind_real, joint.bind_dual);
+				bind_real = joint_reals_[0][i];
+				bind_dual = joint_duals_[0][i];
 				bind_scale = joint.inverse_origin_scale * joint.bind_scale;
 
 				if (MathLib::SignBit(bind_real.w()) < 0)
@@ -901,6 +1262,117 @@ namespace KlayGE
 		}
 	}
 
+	void SkinnedModel::SetFrames(ArrayRef<SkinnedModel*> models, ArrayRef<float> frames)
+	{
+		BOOST_ASSERT(models.size() == frames.size());
+
+		Context::Instance().TaskScheduler().parallel_for(0, models.size(), MODELS_PER_ANIMATION_TASK,
+			[&models, &frames](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; ++ i)
+				{
+					models[i]->SetFrame(frames[i]);
+				}
+			});
+	}
+
+	void SkinnedModel::AttachKeyFrames(std::shared_ptr<KeyFramesType> const & kf)
+	{
+		std::vector<AnimationClipPtr> clips;
+		if (kf && !kf->empty())
+		{
+			if (actions_)
+			{
+				for (uint32_t i = 0; i < actions_->size(); ++ i)
+				{
+					uint32_t start_frame, end_frame;
+					ActionClipRange(*actions_, i, num_frames_, start_frame, end_frame);
+					clips.push_back(MakeSharedPtr<AnimationClip>(*kf, start_frame, end_frame));
+				}
+			}
+			else
+			{
+				uint32_t end_frame = num_frames_;
+				for (auto const & track : *kf)
+				{
+					end_frame = std::max(end_frame, track.frame_id.back() + 1);
+				}
+				clips.push_back(MakeSharedPtr<AnimationClip>(*kf, 0, end_frame));
+			}
+		}
+		this->AttachAnimationClips(clips);
+	}
+
+	std::shared_ptr<KeyFramesType> SkinnedModel::GetKeyFrames() const
+	{
+		std::shared_ptr<KeyFramesType> kfs;
+		for (auto const & clip : clips_)
+		{
+			if (clip)
+			{
+				if (!kfs)
+				{
+					kfs = MakeSharedPtr<KeyFramesType>();
+				}
+				clip->AppendKeyFrames(*kfs);
+			}
+		}
+		return kfs;
+	}
+
+	void SkinnedModel::AttachAnimationClips(std::vector<AnimationClipPtr> const & clips)
+	{
+		clips_ = clips;
+	}
+
+	void SkinnedModel::AttachAnimationClip(uint32_t action, AnimationClipPtr const & clip)
+	{
+		if (action >= clips_.size())
+		{
+			clips_.resize(action + 1);
+		}
+		clips_[action] = clip;
+
+		if (clip && (last_frame_ >= 0))
+		{
+			this->BuildBones(last_frame_);
+		}
+	}
+
+	uint32_t SkinnedModel::ActionOfFrame(float frame) const
+	{
+		// The action playing frame, or the last one started before it when frame is in none
+		uint32_t ret = 0;
+		if (actions_)
+		{
+			for (uint32_t i = 0; i < actions_->size(); ++ i)
+			{
+				AnimationAction const & action = (*actions_)[i];
+				if (action.start_frame <= frame)
+				{
+					ret = i;
+					if (frame < action.end_frame)
+					{
+						break;
+					}
+				}
+			}
+		}
+		return ret;
+	}
+
+	void SkinnedModel::ResizeJointScratch()
+	{
+		size_t const num_joints = joints_.size();
+		for (int i = 0; i < 2; ++ i)
+		{
+			joint_reals_[i].resize(num_joints);
+			joint_duals_[i].resize(num_joints);
+		}
+		joint_factors_.resize(num_joints);
+		joint_scales_.resize(num_joints);
+	}
+
 	void SkinnedModel::RebindJoints()
 	{
 		this->BuildBones(last_frame_);
@@ -1081,7 +1553,7 @@ namespace KlayGE
 		std::vector<uint32_t>& mesh_num_vertices, std::vector<uint32_t>& mesh_base_vertices,
 		std::vector<uint32_t>& mesh_num_indices, std::vector<uint32_t>& mesh_base_indices,
 		std::vector<Joint>& joints, std::shared_ptr<AnimationActionsType>& actions,
-		std::shared_ptr<KeyFramesType>& kfs, uint32_t& num_frames, uint32_t& frame_rate,
+		std::vector<AnimationClipPtr>& clips, uint32_t& num_frames, uint32_t& frame_rate,
 		std::vector<std::shared_ptr<AABBKeyFrames>>& frame_pos_bbs)
 	{
 		ResIdentifierPtr lzma_file;
@@ -1121,18 +1593,34 @@ namespace KlayGE
 		ver = LE2Native(ver);
 		BOOST_ASSERT(MODEL_BIN_VERSION == ver);
 
-		std::shared_ptr<std::stringstream> ss = MakeSharedPtr<std::stringstream>();
-
 		uint64_t original_len, len;
 		lzma_file->read(&original_len, sizeof(original_len));
 		original_len = LE2Native(original_len);
 		lzma_file->read(&len, sizeof(len));
 		len = LE2Native(len);
 
+		// Decode into one buffer and parse it in place, without going through a stringstream. The compressed data is
+		//  read from the mapping when the file is mapped. Chunks are decoded in parallel.
+		std::shared_ptr<std::vector<uint8_t>> decoded_data = MakeSharedPtr<std::vector<uint8_t>>();
 		LZMACodec lzma;
-		lzma.Decode(*ss, lzma_file, len, original_len);
+		ArrayRef<uint8_t> const mapped_data = lzma_file->MappedData();
+		if (mapped_data.empty())
+		{
+			lzma.DecodeChunked(*decoded_data, lzma_file, len);
+		}
+		else
+		{
+			uint64_t const pos = lzma_file->tellg();
+			if ((pos > mapped_data.size()) || (len > mapped_data.size() - pos))
+			{
+				TERRC(std::errc::illegal_byte_sequence);
+			}
+			lzma.DecodeChunked(*decoded_data, mapped_data.data() + pos, len);
+		}
+		BOOST_ASSERT(decoded_data->size() == original_len);
 
-		ResIdentifierPtr decoded = MakeSharedPtr<ResIdentifier>(lzma_file->ResName(), lzma_file->Timestamp(), ss);
+		ResIdentifierPtr decoded = MakeSharedPtr<ResIdentifier>(lzma_file->ResName(), lzma_file->Timestamp(),
+			decoded_data, ArrayRef<uint8_t>(*decoded_data));
 
 		uint32_t num_mtls;
 		decoded->read(&num_mtls, sizeof(num_mtls));
@@ -1415,47 +1903,15 @@ namespace KlayGE
 			decoded->read(&frame_rate, sizeof(frame_rate));
 			frame_rate = LE2Native(frame_rate);
 
-			kfs = MakeSharedPtr<KeyFramesType>(joints.size());
-			for (uint32_t kf_index = 0; kf_index < num_kfs; ++ kf_index)
-			{
-				uint32_t joint_index = kf_index;
-
-				uint32_t num_kf;
-				decoded->read(&num_kf, sizeof(num_kf));
-				num_kf = LE2Native(num_kf);
+			uint32_t num_clips;
+			decoded->read(&num_clips, sizeof(num_clips));
+			num_clips = LE2Native(num_clips);
 
-				KeyFrames kf;
-				kf.frame_id.resize(num_kf);
-				kf.bind_real.resize(num_kf);
-				kf.bind_dual.resize(num_kf);
-				kf.bind_scale.resize(num_kf);
-				for (uint32_t k_index = 0; k_index < num_kf; ++ k_index)
-				{
-					decoded->read(&kf.frame_id[k_index], sizeof(kf.frame_id[k_index]));
-					kf.frame_id[k_index] = LE2Native(kf.frame_id[k_index]);
-					decoded->read(&kf.bind_real[k_index], sizeof(kf.bind_real[k_index]));
-					kf.bind_real[k_index][0] = LE2Native(kf.bind_real[k_index][0]);
-					kf.bind_real[k_index][1] = LE2Native(kf.bind_real[k_index][1]);
-					kf.bind_real[k_index][2] = LE2Native(kf.bind_real[k_index][2]);
-					kf.bind_real[k_index][3] = LE2Native(kf.bind_real[k_index][3]);
-					decoded->read(&kf.bind_dual[k_index], sizeof(kf.bind_dual[k_index]));
-					kf.bind_dual[k_index][0] = LE2Native(kf.bind_dual[k_index][0]);
-					kf.bind_dual[k_index][1] = LE2Native(kf.bind_dual[k_index][1]);
-					kf.bind_dual[k_index][2] = LE2Native(kf.bind_dual[k_index][2]);
-					kf.bind_dual[k_index][3] = LE2Native(kf.bind_dual[k_index][3]);
-
-					float flip = MathLib::SignBit(kf.bind_real[k_index].w());
-
-					kf.bind_scale[k_index] = MathLib::length(kf.bind_real[k_index]);
-					kf.bind_real[k_index] /= kf.bind_scale[k_index];
-
-					kf.bind_scale[k_index] *= flip;
-				}
-
-				if (joint_index < num_joints)
-				{
-					(*kfs)[joint_index] = kf;
-				}
+			clips.resize(num_clips);
+			for (uint32_t clip_index = 0; clip_index < num_clips; ++ clip_index)
+			{
+				clips[clip_index] = MakeSharedPtr<AnimationClip>();
+				clips[clip_index]->Read(*decoded);
 			}
 
 			frame_pos_bbs.resize(num_meshes);
@@ -1489,7 +1945,8 @@ namespace KlayGE
 			
 			if (num_actions > 0)
 			{
-				actions = MakeSharedPtr<AnimationActionsType>(num_actions);
+				actions = MakeSharedPtr<AnimationActionsType>();
+				actions->reserve(num_actions);
 				for (uint32_t action_index = 0; action_index < num_actions; ++ action_index)
 				{
 					AnimationAction action;
@@ -2020,40 +2477,34 @@ namespace KlayGE
 		}
 	}
 
-	void WriteKeyFramesChunk(uint32_t num_frames, uint32_t frame_rate, std::vector<KeyFrames>& kfs,
-		std::ostream& os)
+	void WriteKeyFramesChunk(uint32_t num_frames, uint32_t frame_rate, std::vector<KeyFrames> const & kfs,
+		std::shared_ptr<AnimationActionsType> const & actions, std::ostream& os)
 	{
+		uint32_t const root_end_frame = num_frames;
+
 		num_frames = Native2LE(num_frames);
 		os.write(reinterpret_cast<char*>(&num_frames), sizeof(num_frames));
 		frame_rate = Native2LE(frame_rate);
 		os.write(reinterpret_cast<char*>(&frame_rate), sizeof(frame_rate));
 
-		for (size_t i = 0; i < kfs.size(); ++ i)
-		{
-			uint32_t num_kf = Native2LE(static_cast<uint32_t>(kfs[i].frame_id.size()));
-			os.write(reinterpret_cast<char*>(&num_kf), sizeof(num_kf));
+		// One clip per action, so they can be streamed separately
+		uint32_t num_clips = (actions && !actions->empty()) ? static_cast<uint32_t>(actions->size()) : 1;
+		num_clips = Native2LE(num_clips);
+		os.write(reinterpret_cast<char*>(&num_clips), sizeof(num_clips));
 
-			for (size_t j = 0; j < kfs[i].frame_id.size(); ++ j)
+		if (actions && !actions->empty())
+		{
+			for (uint32_t i = 0; i < actions->size(); ++ i)
 			{
-				Quaternion bind_real = kfs[i].bind_real[j];
-				Quaternion bind_dual = kfs[i].bind_dual[j];
-				float bind_scale = kfs[i].bind_scale[j];
-
-				uint32_t frame_id = Native2LE(kfs[i].frame_id[j]);
-				os.write(reinterpret_cast<char*>(&frame_id), sizeof(frame_id));
-				bind_real *= bind_scale;
-				bind_real.x() = Native2LE(bind_real.x());
-				bind_real.y() = Native2LE(bind_real.y());
-				bind_real.z() = Native2LE(bind_real.z());
-				bind_real.w() = Native2LE(bind_real.w());
-				os.write(reinterpret_cast<char*>(&bind_real), sizeof(bind_real));
-				bind_dual.x() = Native2LE(bind_dual.x());
-				bind_dual.y() = Native2LE(bind_dual.y());
-				bind_dual.z() = Native2LE(bind_dual.z());
-				bind_dual.w() = Native2LE(bind_dual.w());
-				os.write(reinterpret_cast<char*>(&bind_dual), sizeof(bind_dual));
+				uint32_t start_frame, end_frame;
+				ActionClipRange(*actions, i, root_end_frame, start_frame, end_frame);
+				AnimationClip(kfs, start_frame, end_frame).Write(os);
 			}
 		}
+		else
+		{
+			AnimationClip(kfs, 0, root_end_frame).Write(os);
+		}
 	}
 
 	void WriteBBKeyFramesChunk(std::vector<AABBKeyFrames> const & bb_kfs, std::ostream& os)
@@ -2143,7 +2594,7 @@ namespace KlayGE
 
 		if (kfs && !kfs->empty())
 		{
-			WriteKeyFramesChunk(num_frames, frame_rate, *kfs, ss);
+			WriteKeyFramesChunk(num_frames, frame_rate, *kfs, actions, ss);
 
 			std::vector<AABBKeyFrames> bb_kfss;
 
@@ -2163,7 +2614,10 @@ namespace KlayGE
 			}
 			WriteBBKeyFramesChunk(bb_kfss, ss);
 
-			WriteActionsChunk(*actions, ss);
+			if (actions)
+			{
+				WriteActionsChunk(*actions, ss);
+			}
 		}
 
 		std::ofstream ofs(jit_name.c_str(), std::ios_base::binary);
@@ -2182,7 +2636,8 @@ namespace KlayGE
 		ofs.write(reinterpret_cast<char*>(&len), sizeof(len));
 
 		LZMACodec lzma;
-		len = lzma.Encode(ofs, ss.str().c_str(), ss.str().size());
+		std::string const raw = ss.str();
+		len = lzma.EncodeChunked(ofs, raw.c_str(), raw.size());
 
 		ofs.seekp(p, std::ios_base::beg);
 		len = Native2LE(len);
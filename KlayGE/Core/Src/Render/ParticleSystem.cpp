@@ -41,7 +41,10 @@
 #include <KFL/XMLDom.hpp>
 #include <KlayGE/DeferredRenderingLayer.hpp>
 #include <KFL/Hash.hpp>
+#include <KFL/SIMDMath.hpp>
+#include <KFL/SIMDVector.hpp>
 
+#include <cstring>
 #include <fstream>
 
 #if defined(KLAYGE_COMPILER_GCC)
@@ -62,6 +65,7 @@ namespace
 	using namespace KlayGE;
 
 	uint32_t const NUM_PARTICLES = 4096;
+	uint32_t const NUM_PARTICLE_ATTRIBS = 11;
 
 	class ParticleSystemLoadingDesc : public ResLoadingDesc
 	{
@@ -346,6 +350,14 @@ namespace
 			return true;
 		}
 
+		size_t Key() const override
+		{
+			size_t seed = 0;
+			HashCombine(seed, this->Type());
+			HashRange(seed, ps_desc_.res_name.begin(), ps_desc_.res_name.end());
+			return seed;
+		}
+
 		bool Match(ResLoadingDesc const & rhs) const override
 		{
 			if (this->Type() == rhs.Type())
@@ -550,14 +562,71 @@ namespace
 		using RenderableHelper::PosBound;
 	};
 
-	class ParticleCmp
+	// Maps a float to an uint32_t that sorts in the opposite order
+	uint32_t DescendingSortKey(float f)
 	{
-	public:
-		bool operator()(std::pair<uint32_t, float> const & lhs, std::pair<uint32_t, float> const & rhs) const
+		uint32_t bits;
+		memcpy(&bits, &f, sizeof(bits));
+		uint32_t const ascending = (bits & 0x80000000U) ? ~bits : (bits | 0x80000000U);
+		return ~ascending;
+	}
+
+	// Stable LSD radix sort of indices by keys, 8 bits per pass. The results end up in keys and indices.
+	void RadixSort(std::vector<uint32_t>& keys, std::vector<uint32_t>& indices,
+		std::vector<uint32_t>& tmp_keys, std::vector<uint32_t>& tmp_indices)
+	{
+		uint32_t const num = static_cast<uint32_t>(keys.size());
+		tmp_keys.resize(num);
+		tmp_indices.resize(num);
+
+		for (uint32_t shift = 0; shift < 32; shift += 8)
+		{
+			uint32_t offsets[256] = { 0 };
+			for (uint32_t i = 0; i < num; ++ i)
+			{
+				++ offsets[(keys[i] >> shift) & 0xFF];
+			}
+
+			// Particles usually share the high bytes of their keys. Such a pass wouldn't move anything.
+			if (offsets[(keys[0] >> shift) & 0xFF] == num)
+			{
+				continue;
+			}
+
+			uint32_t sum = 0;
+			for (auto& offset : offsets)
+			{
+				uint32_t const count = offset;
+				offset = sum;
+				sum += count;
+			}
+
+			for (uint32_t i = 0; i < num; ++ i)
+			{
+				uint32_t const dst = offsets[(keys[i] >> shift) & 0xFF] ++;
+				tmp_keys[dst] = keys[i];
+				tmp_indices[dst] = indices[i];
+			}
+
+			keys.swap(tmp_keys);
+			indices.swap(tmp_indices);
+		}
+	}
+
+	float EvaluatePolyline(std::vector<float2> const & ctrl_pts, float x)
+	{
+		float ret = ctrl_pts.back().y();
+		for (auto iter = ctrl_pts.begin(); iter != ctrl_pts.end() - 1; ++ iter)
 		{
-			return lhs.second > rhs.second;
+			if ((iter + 1)->x() >= x)
+			{
+				float const s = (x - iter->x()) / ((iter + 1)->x() - iter->x());
+				ret = MathLib::lerp(iter->y(), (iter + 1)->y(), s);
+				break;
+			}
 		}
-	};
+		return ret;
+	}
 }
 
 namespace KlayGE
@@ -601,6 +670,16 @@ namespace KlayGE
 	{
 	}
 
+	void ParticleUpdater::BatchUpdate(ParticleSpan const & span, float elapse_time)
+	{
+		for (uint32_t i = 0; i < span.num; ++ i)
+		{
+			Particle par = span.Get(i);
+			this->Update(par, elapse_time);
+			span.Set(i, par);
+		}
+	}
+
 	void ParticleUpdater::DoClone(ParticleUpdaterPtr const & rhs)
 	{
 		rhs->ps_ = ps_;
@@ -609,9 +688,13 @@ namespace KlayGE
 
 	ParticleSystem::ParticleSystem(uint32_t max_num_particles)
 		: SceneObjectHelper(SOA_Moveable | SOA_NotCastShadow),
-			particles_(max_num_particles),
+			max_num_particles_(max_num_particles), attrib_stride_((max_num_particles + 3) & ~3U),
+			num_alive_particles_(0),
 			gravity_(0.5f), force_(0, 0, 0), media_density_(0.0f)
 	{
+		particle_attribs_.resize(attrib_stride_ * NUM_PARTICLE_ATTRIBS, 0.0f);
+		active_particles_.reserve(max_num_particles_);
+
 		this->ClearParticles();
 
 		RenderFactory& rf = Context::Instance().RenderFactoryInstance();
@@ -717,80 +800,186 @@ namespace KlayGE
 
 	void ParticleSystem::ClearParticles()
 	{
-		for (auto& particle : particles_)
-		{
-			particle.life = 0;
-		}
+		num_alive_particles_ = 0;
 	}
 
-	void ParticleSystem::SubThreadUpdate(float /*app_time*/, float elapsed_time)
+	ParticleSpan ParticleSystem::MakeSpan(uint32_t begin, uint32_t end) const
 	{
-		auto emitter_iter = emitters_.begin();
-		uint32_t new_particle = (*emitter_iter)->Update(elapsed_time);
+		BOOST_ASSERT(begin <= end);
+		BOOST_ASSERT(end <= max_num_particles_);
+
+		float* attribs = const_cast<float*>(particle_attribs_.data()) + begin;
+
+		ParticleSpan span;
+		span.pos_x = attribs + attrib_stride_ * 0;
+		span.pos_y = attribs + attrib_stride_ * 1;
+		span.pos_z = attribs + attrib_stride_ * 2;
+		span.vel_x = attribs + attrib_stride_ * 3;
+		span.vel_y = attribs + attrib_stride_ * 4;
+		span.vel_z = attribs + attrib_stride_ * 5;
+		span.life = attribs + attrib_stride_ * 6;
+		span.spin = attribs + attrib_stride_ * 7;
+		span.size = attribs + attrib_stride_ * 8;
+		span.alpha = attribs + attrib_stride_ * 9;
+		span.init_life = attribs + attrib_stride_ * 10;
+		span.num = end - begin;
+		return span;
+	}
 
-		float4x4 const & view_mat = Context::Instance().AppInstance().ActiveCamera().ViewMatrix();
-		std::vector<std::pair<uint32_t, float>> active_particles;
+	void ParticleSystem::RemoveDeadParticles()
+	{
+		float* attribs = particle_attribs_.data();
+		float const * life = this->MakeSpan(0, num_alive_particles_).life;
 
-		float3 min_bb(+1e10f, +1e10f, +1e10f);
-		float3 max_bb(-1e10f, -1e10f, -1e10f);
-		
-		for (uint32_t i = 0; i < particles_.size(); ++ i)
+		uint32_t i = 0;
+		while (i < num_alive_particles_)
 		{
-			Particle& particle = particles_[i];
-
-			if (particle.life > 0)
+			if (life[i] > 0)
 			{
-				for (auto const & updater : updaters_)
-				{
-					updater->Update(particle, elapsed_time);
-				}
+				++ i;
 			}
 			else
 			{
-				if (new_particle > 0)
+				// Moves the last live particle into the hole
+				-- num_alive_particles_;
+				for (uint32_t a = 0; a < NUM_PARTICLE_ATTRIBS; ++ a)
 				{
-					(*emitter_iter)->Emit(particle);
-					for (auto const & updater : updaters_)
-					{
-						updater->Update(particle, 0);
-					}
-					-- new_particle;
+					attribs[attrib_stride_ * a + i] = attribs[attrib_stride_ * a + num_alive_particles_];
 				}
-				else
+			}
+		}
+	}
+
+	void ParticleSystem::EmitParticles(float elapsed_time)
+	{
+		uint32_t const first_new = num_alive_particles_;
+		for (auto const & emitter : emitters_)
+		{
+			uint32_t const num_new = std::min(emitter->Update(elapsed_time), max_num_particles_ - num_alive_particles_);
+			if (num_new > 0)
+			{
+				ParticleSpan const span = this->MakeSpan(num_alive_particles_, num_alive_particles_ + num_new);
+				for (uint32_t i = 0; i < span.num; ++ i)
 				{
-					if (emitter_iter != emitters_.end())
-					{
-						++ emitter_iter;
-						if (emitter_iter != emitters_.end())
-						{
-							new_particle = (*emitter_iter)->Update(elapsed_time);
-						}
-					}
+					Particle par = span.Get(i);
+					emitter->Emit(par);
+					span.Set(i, par);
 				}
+				num_alive_particles_ += num_new;
 			}
+		}
 
-			if (particle.life > 0)
+		if (num_alive_particles_ > first_new)
+		{
+			ParticleSpan const span = this->MakeSpan(first_new, num_alive_particles_);
+			for (auto const & updater : updaters_)
 			{
-				float3 const & pos = particle.pos;
-				float p_to_v = (pos.x() * view_mat(0, 2) + pos.y() * view_mat(1, 2) + pos.z() * view_mat(2, 2) + view_mat(3, 2))
-					/ (pos.x() * view_mat(0, 3) + pos.y() * view_mat(1, 3) + pos.z() * view_mat(2, 3) + view_mat(3, 3));
+				updater->BatchUpdate(span, 0);
+			}
+		}
+	}
+
+	void ParticleSystem::SortActiveParticles(float4x4 const & view_mat)
+	{
+		using namespace SIMDMathLib;
+
+		ParticleSpan const span = this->MakeSpan(0, num_alive_particles_);
+
+		sort_depths_.resize(attrib_stride_);
+		float* depths = sort_depths_.data();
+
+		float3 min_bb(+1e10f, +1e10f, +1e10f);
+		float3 max_bb(-1e10f, -1e10f, -1e10f);
 
-				active_particles.emplace_back(i, p_to_v);
+		// 4 particles at a time. The arrays are aligned, and [0, attrib_stride_) is in range.
+		uint32_t const num_batched = span.num & ~3U;
+		if (num_batched > 0)
+		{
+			SIMDVectorF4 const m02 = SetVector(view_mat(0, 2));
+			SIMDVectorF4 const m12 = SetVector(view_mat(1, 2));
+			SIMDVectorF4 const m22 = SetVector(view_mat(2, 2));
+			SIMDVectorF4 const m32 = SetVector(view_mat(3, 2));
+			SIMDVectorF4 const m03 = SetVector(view_mat(0, 3));
+			SIMDVectorF4 const m13 = SetVector(view_mat(1, 3));
+			SIMDVectorF4 const m23 = SetVector(view_mat(2, 3));
+			SIMDVectorF4 const m33 = SetVector(view_mat(3, 3));
+
+			SIMDVectorF4 min_x = SetVector(+1e10f);
+			SIMDVectorF4 min_y = min_x;
+			SIMDVectorF4 min_z = min_x;
+			SIMDVectorF4 max_x = SetVector(-1e10f);
+			SIMDVectorF4 max_y = max_x;
+			SIMDVectorF4 max_z = max_x;
+			for (uint32_t i = 0; i < num_batched; i += 4)
+			{
+				SIMDVectorF4 const x = LoadVector4(span.pos_x + i);
+				SIMDVectorF4 const y = LoadVector4(span.pos_y + i);
+				SIMDVectorF4 const z = LoadVector4(span.pos_z + i);
+
+				StoreVector4(depths + i, (x * m02 + y * m12 + z * m22 + m32) / (x * m03 + y * m13 + z * m23 + m33));
+
+				min_x = Minimize(min_x, x);
+				min_y = Minimize(min_y, y);
+				min_z = Minimize(min_z, z);
+				max_x = Maximize(max_x, x);
+				max_y = Maximize(max_y, y);
+				max_z = Maximize(max_z, z);
+			}
 
-				min_bb = MathLib::minimize(min_bb, pos);
-				max_bb = MathLib::maximize(min_bb, pos);
+			for (size_t j = 0; j < 4; ++ j)
+			{
+				min_bb = MathLib::minimize(min_bb,
+					float3(GetByIndex(min_x, j), GetByIndex(min_y, j), GetByIndex(min_z, j)));
+				max_bb = MathLib::maximize(max_bb,
+					float3(GetByIndex(max_x, j), GetByIndex(max_y, j), GetByIndex(max_z, j)));
 			}
 		}
+		for (uint32_t i = num_batched; i < span.num; ++ i)
+		{
+			float3 const pos(span.pos_x[i], span.pos_y[i], span.pos_z[i]);
+			depths[i] = (pos.x() * view_mat(0, 2) + pos.y() * view_mat(1, 2) + pos.z() * view_mat(2, 2) + view_mat(3, 2))
+				/ (pos.x() * view_mat(0, 3) + pos.y() * view_mat(1, 3) + pos.z() * view_mat(2, 3) + view_mat(3, 3));
+
+			min_bb = MathLib::minimize(min_bb, pos);
+			max_bb = MathLib::maximize(max_bb, pos);
+		}
 
-		if (!active_particles.empty())
+		sort_keys_.resize(span.num);
+		active_particles_.resize(span.num);
+		for (uint32_t i = 0; i < span.num; ++ i)
 		{
-			std::sort(active_particles.begin(), active_particles.end(), ParticleCmp());
+			sort_keys_[i] = DescendingSortKey(depths[i]);
+			active_particles_[i] = i;
+		}
+
+		if (span.num > 0)
+		{
+			RadixSort(sort_keys_, active_particles_, sort_tmp_keys_, sort_tmp_indices_);
 
 			checked_pointer_cast<RenderParticles>(renderable_)->PosBound(AABBox(min_bb, max_bb));
 		}
+	}
+
+	void ParticleSystem::SubThreadUpdate(float /*app_time*/, float elapsed_time)
+	{
+		// Updaters change particles in place. Removing, emitting and sorting move particles between slots, so they
+		//  run under the lock MainThreadUpdate reads active_particles_ with.
+		if (num_alive_particles_ > 0)
+		{
+			ParticleSpan const span = this->MakeSpan(0, num_alive_particles_);
+			for (auto const & updater : updaters_)
+			{
+				updater->BatchUpdate(span, elapsed_time);
+			}
+		}
+
+		float4x4 const & view_mat = Context::Instance().AppInstance().ActiveCamera().ViewMatrix();
 
 		std::lock_guard<std::mutex> lock(update_mutex_);
-		active_particles_ = active_particles;
+
+		this->RemoveDeadParticles();
+		this->EmitParticles(elapsed_time);
+		this->SortActiveParticles(view_mat);
 	}
 
 	bool ParticleSystem::MainThreadUpdate(float app_time, float elapsed_time)
@@ -847,15 +1036,18 @@ namespace KlayGE
 			{
 				GraphicsBuffer::Mapper mapper(*instance_gb, BA_Write_Only);
 				ParticleInstance* instance_data = mapper.Pointer<ParticleInstance>();
+				ParticleSpan const span = this->MakeSpan(0, max_num_particles_);
 				for (uint32_t i = 0; i < num_active_particles; ++ i, ++ instance_data)
 				{
-					Particle const & par = particles_[active_particles_[i].first];
-					instance_data->pos = par.pos;
-					instance_data->life = par.life;
-					instance_data->spin = par.spin;
-					instance_data->size = par.size;
-					instance_data->life_factor = (par.init_life - par.life) / par.init_life;
-					instance_data->alpha = par.alpha;
+					uint32_t const index = active_particles_[i];
+					float const life = span.life[index];
+					float const init_life = span.init_life[index];
+					instance_data->pos = float3(span.pos_x[index], span.pos_y[index], span.pos_z[index]);
+					instance_data->life = life;
+					instance_data->spin = span.spin[index];
+					instance_data->size = span.size[index];
+					instance_data->life_factor = (init_life - life) / init_life;
+					instance_data->alpha = span.alpha[index];
 				}
 			}
 		}
@@ -1128,46 +1320,84 @@ namespace KlayGE
 
 	void PolylineParticleUpdater::Update(Particle& par, float elapse_time)
 	{
+		std::lock_guard<std::mutex> lock(update_mutex_);
+		this->DoUpdate(par, elapse_time);
+	}
+
+	void PolylineParticleUpdater::BatchUpdate(ParticleSpan const & span, float elapse_time)
+	{
+		using namespace SIMDMathLib;
+
 		std::lock_guard<std::mutex> lock(update_mutex_);
 
 		BOOST_ASSERT(!size_over_life_.empty());
 		BOOST_ASSERT(!mass_over_life_.empty());
 		BOOST_ASSERT(!opacity_over_life_.empty());
 
-		float pos = (par.init_life - par.life) / par.init_life;
-
-		float cur_size = size_over_life_.back().y();
-		for (auto iter = size_over_life_.begin(); iter != size_over_life_.end() - 1; ++ iter)
+		// Particles before the first 16-byte boundary go through the scalar path
+		uint32_t i = 0;
+		for (; (i < span.num) && ((reinterpret_cast<uintptr_t>(span.life + i) & 0xF) != 0); ++ i)
 		{
-			if ((iter + 1)->x() >= pos)
-			{
-				float const s = (pos - iter->x()) / ((iter + 1)->x() - iter->x());
-				cur_size = MathLib::lerp(iter->y(), (iter + 1)->y(), s);
-				break;
-			}
+			Particle par = span.Get(i);
+			this->DoUpdate(par, elapse_time);
+			span.Set(i, par);
 		}
 
-		float cur_mass = mass_over_life_.back().y();
-		for (auto iter = mass_over_life_.begin(); iter != mass_over_life_.end() - 1; ++ iter)
+		ParticleSystemPtr ps = ps_.lock();
+		float const gravity = ps->Gravity();
+		float3 const & force = ps->Force();
+		float const buoyancy_scale = 4.0f / 3 * PI * ps->MediaDensity() * gravity;
+
+		for (; i + 4 <= span.num; i += 4)
 		{
-			if ((iter + 1)->x() >= pos)
+			// The curves are looked up per particle, the integration is done on 4 particles at once
+			float mass[4];
+			for (uint32_t j = 0; j < 4; ++ j)
 			{
-				float const s = (pos - iter->x()) / ((iter + 1)->x() - iter->x());
-				cur_mass = MathLib::lerp(iter->y(), (iter + 1)->y(), s);
-				break;
+				uint32_t const index = i + j;
+				float const pos = (span.init_life[index] - span.life[index]) / span.init_life[index];
+				span.size[index] = EvaluatePolyline(size_over_life_, pos);
+				mass[j] = EvaluatePolyline(mass_over_life_, pos);
+				span.alpha[index] = EvaluatePolyline(opacity_over_life_, pos);
 			}
+
+			SIMDVectorF4 const inv_mass = SetVector(1.0f) / SetVector(mass[0], mass[1], mass[2], mass[3]);
+			SIMDVectorF4 const buoyancy = Cube(LoadVector4(span.size + i)) * buoyancy_scale;
+			SIMDVectorF4 const accel_x = inv_mass * force.x();
+			SIMDVectorF4 const accel_y = (buoyancy + force.y()) * inv_mass - gravity;
+			SIMDVectorF4 const accel_z = inv_mass * force.z();
+
+			SIMDVectorF4 const vel_x = LoadVector4(span.vel_x + i) + accel_x * elapse_time;
+			SIMDVectorF4 const vel_y = LoadVector4(span.vel_y + i) + accel_y * elapse_time;
+			SIMDVectorF4 const vel_z = LoadVector4(span.vel_z + i) + accel_z * elapse_time;
+			StoreVector4(span.vel_x + i, vel_x);
+			StoreVector4(span.vel_y + i, vel_y);
+			StoreVector4(span.vel_z + i, vel_z);
+			StoreVector4(span.pos_x + i, LoadVector4(span.pos_x + i) + vel_x * elapse_time);
+			StoreVector4(span.pos_y + i, LoadVector4(span.pos_y + i) + vel_y * elapse_time);
+			StoreVector4(span.pos_z + i, LoadVector4(span.pos_z + i) + vel_z * elapse_time);
+			StoreVector4(span.life + i, LoadVector4(span.life + i) - elapse_time);
+			StoreVector4(span.spin + i, LoadVector4(span.spin + i) + 0.001f);
 		}
 
-		float cur_alpha = opacity_over_life_.back().y();
-		for (auto iter = opacity_over_life_.begin(); iter != opacity_over_life_.end() - 1; ++ iter)
+		for (; i < span.num; ++ i)
 		{
-			if ((iter + 1)->x() >= pos)
-			{
-				float const s = (pos - iter->x()) / ((iter + 1)->x() - iter->x());
-				cur_alpha = MathLib::lerp(iter->y(), (iter + 1)->y(), s);
-				break;
-			}
+			Particle par = span.Get(i);
+			this->DoUpdate(par, elapse_time);
+			span.Set(i, par);
 		}
+	}
+
+	void PolylineParticleUpdater::DoUpdate(Particle& par, float elapse_time)
+	{
+		BOOST_ASSERT(!size_over_life_.empty());
+		BOOST_ASSERT(!mass_over_life_.empty());
+		BOOST_ASSERT(!opacity_over_life_.empty());
+
+		float const pos = (par.init_life - par.life) / par.init_life;
+		float const cur_size = EvaluatePolyline(size_over_life_, pos);
+		float const cur_mass = EvaluatePolyline(mass_over_life_, pos);
+		float const cur_alpha = EvaluatePolyline(opacity_over_life_, pos);
 
 		ParticleSystemPtr ps = ps_.lock();
 		float buoyancy = 4.0f / 3 * PI * MathLib::cube(cur_size) * ps->MediaDensity() * ps->Gravity();
@@ -99,74 +99,55 @@ namespace
 			ResIdentifierPtr ppmm_input = ResLoader::Instance().Open(pp_desc_.res_name);
 
 			KlayGE::XMLDocument doc;
-			XMLNodePtr root = doc.Parse(ppmm_input);
+			doc.Parse(ppmm_input);
+			XMLNodeView const root = doc.RootView();
 
 			pp_desc_.pp_data->cs_data_per_thread_x = 1;
 			pp_desc_.pp_data->cs_data_per_thread_y = 1;
 			pp_desc_.pp_data->cs_data_per_thread_z = 1;
 
-			for (XMLNodePtr pp_node = root->FirstNode("post_processor"); pp_node; pp_node = pp_node->NextSibling("post_processor"))
+			for (XMLNodeView pp_node = root.FirstNode("post_processor"); pp_node; pp_node = pp_node.NextSibling("post_processor"))
 			{
-				std::string name = pp_node->Attrib("name")->ValueString();
+				std::string_view const name = pp_node.Attrib("name").ValueString();
 				if (pp_desc_.pp_name == name)
 				{
 					Convert(pp_desc_.pp_data->name, name);
 
-					XMLAttributePtr vol_attr = pp_node->Attrib("volumetric");
-					if (vol_attr)
-					{
-						pp_desc_.pp_data->volumetric = (vol_attr->ValueInt() != 0);
-					}
-					else
-					{
-						pp_desc_.pp_data->volumetric = false;
-					}
+					pp_desc_.pp_data->volumetric = (pp_node.AttribInt("volumetric", 0) != 0);
 
-					XMLNodePtr params_chunk = pp_node->FirstNode("params");
+					XMLNodeView const params_chunk = pp_node.FirstNode("params");
 					if (params_chunk)
 					{
-						for (XMLNodePtr p_node = params_chunk->FirstNode("param"); p_node; p_node = p_node->NextSibling("param"))
+						for (XMLNodeView p_node = params_chunk.FirstNode("param"); p_node; p_node = p_node.NextSibling("param"))
 						{
-							pp_desc_.pp_data->param_names.push_back(p_node->Attrib("name")->ValueString());
+							pp_desc_.pp_data->param_names.emplace_back(p_node.Attrib("name").ValueString());
 						}
 					}
-					XMLNodePtr input_chunk = pp_node->FirstNode("input");
+					XMLNodeView const input_chunk = pp_node.FirstNode("input");
 					if (input_chunk)
 					{
-						for (XMLNodePtr pin_node = input_chunk->FirstNode("pin"); pin_node; pin_node = pin_node->NextSibling("pin"))
+						for (XMLNodeView pin_node = input_chunk.FirstNode("pin"); pin_node; pin_node = pin_node.NextSibling("pin"))
 						{
-							pp_desc_.pp_data->input_pin_names.push_back(pin_node->Attrib("name")->ValueString());
+							pp_desc_.pp_data->input_pin_names.emplace_back(pin_node.Attrib("name").ValueString());
 						}
 					}
-					XMLNodePtr output_chunk = pp_node->FirstNode("output");
+					XMLNodeView const output_chunk = pp_node.FirstNode("output");
 					if (output_chunk)
 					{
-						for (XMLNodePtr pin_node = output_chunk->FirstNode("pin"); pin_node; pin_node = pin_node->NextSibling("pin"))
+						for (XMLNodeView pin_node = output_chunk.FirstNode("pin"); pin_node; pin_node = pin_node.NextSibling("pin"))
 						{
-							pp_desc_.pp_data->output_pin_names.push_back(pin_node->Attrib("name")->ValueString());
+							pp_desc_.pp_data->output_pin_names.emplace_back(pin_node.Attrib("name").ValueString());
 						}
 					}
-					XMLNodePtr shader_chunk = pp_node->FirstNode("shader");
+					XMLNodeView const shader_chunk = pp_node.FirstNode("shader");
 					if (shader_chunk)
 					{
-						pp_desc_.pp_data->effect_name = shader_chunk->Attrib("effect")->ValueString();
-						pp_desc_.pp_data->tech_name = shader_chunk->Attrib("tech")->ValueString();
+						pp_desc_.pp_data->effect_name = std::string(shader_chunk.Attrib("effect").ValueString());
+						pp_desc_.pp_data->tech_name = std::string(shader_chunk.Attrib("tech").ValueString());
 
-						XMLAttributePtr attr = shader_chunk->Attrib("cs_data_per_thread_x");
-						if (attr)
-						{
-							pp_desc_.pp_data->cs_data_per_thread_x = attr->ValueUInt();
-						}
-						attr = shader_chunk->Attrib("cs_data_per_thread_y");
-						if (attr)
-						{
-							pp_desc_.pp_data->cs_data_per_thread_y = attr->ValueUInt();
-						}
-						attr = shader_chunk->Attrib("cs_data_per_thread_z");
-						if (attr)
-						{
-							pp_desc_.pp_data->cs_data_per_thread_z = attr->ValueUInt();
-						}
+						pp_desc_.pp_data->cs_data_per_thread_x = shader_chunk.AttribUInt("cs_data_per_thread_x", 1);
+						pp_desc_.pp_data->cs_data_per_thread_y = shader_chunk.AttribUInt("cs_data_per_thread_y", 1);
+						pp_desc_.pp_data->cs_data_per_thread_z = shader_chunk.AttribUInt("cs_data_per_thread_z", 1);
 					}
 				}
 			}
@@ -190,6 +171,15 @@ namespace
 			return true;
 		}
 
+		size_t Key() const override
+		{
+			size_t seed = 0;
+			HashCombine(seed, this->Type());
+			HashRange(seed, pp_desc_.res_name.begin(), pp_desc_.res_name.end());
+			HashRange(seed, pp_desc_.pp_name.begin(), pp_desc_.pp_name.end());
+			return seed;
+		}
+
 		bool Match(ResLoadingDesc const & rhs) const override
 		{
 			if (this->Type() == rhs.Type())
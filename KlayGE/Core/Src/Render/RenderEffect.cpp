@@ -61,15 +61,6 @@
 
 #include <fstream>
 #include <boost/assert.hpp>
-#if defined(KLAYGE_COMPILER_GCC)
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wdeprecated-declarations" // Ignore auto_ptr declaration
-#endif
-#include <boost/algorithm/string/split.hpp>
-#if defined(KLAYGE_COMPILER_GCC)
-#pragma GCC diagnostic pop
-#endif
-#include <boost/algorithm/string/trim.hpp>
 #include <boost/lexical_cast.hpp>
 
 #include <KlayGE/RenderEffect.hpp>
@@ -462,40 +453,64 @@ namespace
 		}
 	}
 
-	int get_index(XMLNode const & node)
+	int get_index(XMLNodeView const & node)
 	{
-		int index = 0;
-		XMLAttributePtr attr = node.Attrib("index");
-		if (attr)
-		{
-			index = attr->ValueInt();
-		}
-		return index;
+		return node.AttribInt("index", 0);
 	}
 
-	std::string get_profile(XMLNode const & node)
+	std::string get_profile(XMLNodeView const & node)
 	{
-		XMLAttributePtr attr = node.Attrib("profile");
-		if (attr)
-		{
-			return attr->ValueString();
-		}
-		else
-		{
-			return "auto";
-		}
+		return std::string(node.AttribString("profile", "auto"));
+	}
+
+	std::string get_func_name(XMLNodeView const & node)
+	{
+		std::string_view const value = node.Attrib("value").ValueString();
+		return std::string(value.substr(0, value.find("(")));
+	}
+
+	uint32_t read_values(XMLNodeView const & node, int32_t* vals, uint32_t num)
+	{
+		return node.ValueInts(vals, num);
+	}
+
+	uint32_t read_values(XMLNodeView const & node, uint32_t* vals, uint32_t num)
+	{
+		return node.ValueUInts(vals, num);
+	}
+
+	uint32_t read_values(XMLNodeView const & node, float* vals, uint32_t num)
+	{
+		return node.ValueFloats(vals, num);
 	}
 
-	std::string get_func_name(XMLNode const & node)
+	// Array values are comma separated components in the CDATA of the <value> child. A partially filled
+	// last element gets 0 for the missing components.
+	template <typename T, typename ComponentT>
+	std::vector<T> read_array(XMLNodeView const & node, uint32_t array_size)
 	{
-		std::string value = node.Attrib("value")->ValueString();
-		return value.substr(0, value.find("("));
+		uint32_t constexpr num_components = sizeof(T) / sizeof(ComponentT);
+
+		std::vector<T> ret;
+		XMLNodeView value_node = node.FirstNode("value");
+		if (value_node)
+		{
+			value_node = value_node.FirstNode();
+			if (value_node && (XNT_CData == value_node.Type()))
+			{
+				std::vector<ComponentT> values(array_size * num_components, 0);
+				uint32_t const num_values = read_values(value_node, values.data(), static_cast<uint32_t>(values.size()));
+				ret.resize((num_values + num_components - 1) / num_components);
+				std::memcpy(ret.data(), values.data(), ret.size() * sizeof(T));
+			}
+		}
+		return ret;
 	}
 
-	std::unique_ptr<RenderVariable> read_var(XMLNode const & node, uint32_t type, uint32_t array_size)
+	std::unique_ptr<RenderVariable> read_var(XMLNodeView const & node, uint32_t type, uint32_t array_size)
 	{
 		std::unique_ptr<RenderVariable> var;
-		XMLAttributePtr attr;
+		XMLAttributeView attr;
 
 		switch (type)
 		{
@@ -506,7 +521,7 @@ namespace
 				bool tmp = false;
 				if (attr)
 				{
-					tmp = BoolFromStr(attr->ValueString());
+					tmp = BoolFromStr(attr.ValueString());
 				}
 
 				var = MakeUniquePtr<RenderVariableBool>();
@@ -521,7 +536,7 @@ namespace
 				uint32_t tmp = 0;
 				if (attr)
 				{
-					tmp = attr->ValueInt();
+					tmp = attr.ValueInt();
 				}
 
 				var = MakeUniquePtr<RenderVariableUInt>();
@@ -531,27 +546,7 @@ namespace
 			{
 				var = MakeUniquePtr<RenderVariableUIntArray>();
 
-				XMLNodePtr value_node = node.FirstNode("value");
-				if (value_node)
-				{
-					value_node = value_node->FirstNode();
-					if (value_node && (XNT_CData == value_node->Type()))
-					{
-						std::string const & value_str = value_node->ValueString();
-						std::vector<std::string> strs;
-						boost::algorithm::split(strs, value_str, boost::is_any_of(","));
-						std::vector<uint32_t> init_val(std::min(array_size, static_cast<uint32_t>(strs.size())), 0);
-						for (size_t index = 0; index < init_val.size(); ++ index)
-						{
-							if (index < strs.size())
-							{
-								boost::algorithm::trim(strs[index]);
-								init_val[index] = boost::lexical_cast<uint32_t>(strs[index]);
-							}
-						}
-						*var = init_val;
-					}
-				}
+				*var = read_array<uint32_t, uint32_t>(node, array_size);
 			}
 			break;
 
@@ -562,7 +557,7 @@ namespace
 				int32_t tmp = 0;
 				if (attr)
 				{
-					tmp = attr->ValueInt();
+					tmp = attr.ValueInt();
 				}
 
 				var = MakeUniquePtr<RenderVariableInt>();
@@ -572,27 +567,7 @@ namespace
 			{
 				var = MakeUniquePtr<RenderVariableIntArray>();
 
-				XMLNodePtr value_node = node.FirstNode("value");
-				if (value_node)
-				{
-					value_node = value_node->FirstNode();
-					if (value_node && (XNT_CData == value_node->Type()))
-					{
-						std::string const & value_str = value_node->ValueString();
-						std::vector<std::string> strs;
-						boost::algorithm::split(strs, value_str, boost::is_any_of(","));
-						std::vector<int32_t> init_val(std::min(array_size, static_cast<uint32_t>(strs.size())), 0);
-						for (size_t index = 0; index < init_val.size(); ++ index)
-						{
-							if (index < strs.size())
-							{
-								boost::algorithm::trim(strs[index]);
-								init_val[index] = boost::lexical_cast<int32_t>(strs[index]);
-							}
-						}
-						*var = init_val;
-					}
-				}
+				*var = read_array<int32_t, int32_t>(node, array_size);
 			}
 			break;
 
@@ -602,7 +577,7 @@ namespace
 				std::string tmp;
 				if (attr)
 				{
-					tmp = attr->ValueString();
+					tmp = std::string(attr.ValueString());
 				}
 
 				var = MakeUniquePtr<RenderVariableString>();
@@ -628,7 +603,7 @@ namespace
 			attr = node.Attrib("elem_type");
 			if (attr)
 			{
-				*var = attr->ValueString();
+				*var = std::string(attr.ValueString());
 			}
 			else
 			{
@@ -640,15 +615,15 @@ namespace
 			{
 				SamplerStateDesc desc;
 
-				for (XMLNodePtr state_node = node.FirstNode("state"); state_node; state_node = state_node->NextSibling("state"))
+				for (XMLNodeView state_node = node.FirstNode("state"); state_node; state_node = state_node.NextSibling("state"))
 				{
-					size_t const name_hash = RT_HASH(state_node->Attrib("name")->ValueString().c_str());
+					size_t const name_hash = RT_HASH(state_node.Attrib("name").ValueString());
 
-					XMLAttributePtr const value_attr = state_node->Attrib("value");
+					XMLAttributeView const value_attr = state_node.Attrib("value");
 					std::string_view value_str;
 					if (value_attr)
 					{
-						value_str = value_attr->ValueString();
+						value_str = value_attr.ValueString();
 					}
 
 					if (CT_HASH("filtering") == name_hash)
@@ -669,19 +644,19 @@ namespace
 					}
 					else if (CT_HASH("max_anisotropy") == name_hash)
 					{
-						desc.max_anisotropy = static_cast<uint8_t>(value_attr->ValueUInt());
+						desc.max_anisotropy = static_cast<uint8_t>(value_attr.ValueUInt());
 					}
 					else if (CT_HASH("min_lod") == name_hash)
 					{
-						desc.min_lod = value_attr->ValueFloat();
+						desc.min_lod = value_attr.ValueFloat();
 					}
 					else if (CT_HASH("max_lod") == name_hash)
 					{
-						desc.max_lod = value_attr->ValueFloat();
+						desc.max_lod = value_attr.ValueFloat();
 					}
 					else if (CT_HASH("mip_map_lod_bias") == name_hash)
 					{
-						desc.mip_map_lod_bias = value_attr->ValueFloat();
+						desc.mip_map_lod_bias = value_attr.ValueFloat();
 					}
 					else if (CT_HASH("cmp_func") == name_hash)
 					{
@@ -689,25 +664,25 @@ namespace
 					}
 					else if (CT_HASH("border_clr") == name_hash)
 					{
-						attr = state_node->Attrib("r");
+						attr = state_node.Attrib("r");
 						if (attr)
 						{
-							desc.border_clr.r() = attr->ValueFloat();
+							desc.border_clr.r() = attr.ValueFloat();
 						}
-						attr = state_node->Attrib("g");
+						attr = state_node.Attrib("g");
 						if (attr)
 						{
-							desc.border_clr.g() = attr->ValueFloat();
+							desc.border_clr.g() = attr.ValueFloat();
 						}
-						attr = state_node->Attrib("b");
+						attr = state_node.Attrib("b");
 						if (attr)
 						{
-							desc.border_clr.b() = attr->ValueFloat();
+							desc.border_clr.b() = attr.ValueFloat();
 						}
-						attr = state_node->Attrib("a");
+						attr = state_node.Attrib("a");
 						if (attr)
 						{
-							desc.border_clr.a() = attr->ValueFloat();
+							desc.border_clr.a() = attr.ValueFloat();
 						}
 					}
 					else
@@ -739,7 +714,7 @@ namespace
 				attr = node.Attrib("value");
 				if (attr)
 				{
-					tmp = attr->ValueFloat();
+					tmp = attr.ValueFloat();
 				}
 
 				var = MakeUniquePtr<RenderVariableFloat>();
@@ -749,27 +724,7 @@ namespace
 			{
 				var = MakeUniquePtr<RenderVariableFloatArray>();
 
-				XMLNodePtr value_node = node.FirstNode("value");
-				if (value_node)
-				{
-					value_node = value_node->FirstNode();
-					if (value_node && (XNT_CData == value_node->Type()))
-					{
-						std::string const & value_str = value_node->ValueString();
-						std::vector<std::string> strs;
-						boost::algorithm::split(strs, value_str, boost::is_any_of(","));
-						std::vector<float> init_val(std::min(array_size, static_cast<uint32_t>(strs.size())), 0.0f);
-						for (size_t index = 0; index < init_val.size(); ++ index)
-						{
-							if (index < strs.size())
-							{
-								boost::algorithm::trim(strs[index]);
-								init_val[index] = boost::lexical_cast<float>(strs[index]);
-							}
-						}
-						*var = init_val;
-					}
-				}
+				*var = read_array<float, float>(node, array_size);
 			}
 			break;
 
@@ -780,12 +735,12 @@ namespace
 				attr = node.Attrib("x");
 				if (attr)
 				{
-					tmp.x() = attr->ValueUInt();
+					tmp.x() = attr.ValueUInt();
 				}
 				attr = node.Attrib("y");
 				if (attr)
 				{
-					tmp.y() = attr->ValueUInt();
+					tmp.y() = attr.ValueUInt();
 				}
 
 				var = MakeUniquePtr<RenderVariableUInt2>();
@@ -795,30 +750,7 @@ namespace
 			{
 				var = MakeUniquePtr<RenderVariableInt2Array>();
 
-				XMLNodePtr value_node = node.FirstNode("value");
-				if (value_node)
-				{
-					value_node = value_node->FirstNode();
-					if (value_node && (XNT_CData == value_node->Type()))
-					{
-						std::string const & value_str = value_node->ValueString();
-						std::vector<std::string> strs;
-						boost::algorithm::split(strs, value_str, boost::is_any_of(","));
-						std::vector<uint2> init_val(std::min(array_size, static_cast<uint32_t>((strs.size() + 1) / 2)), int2(0, 0));
-						for (size_t index = 0; index < init_val.size(); ++ index)
-						{
-							for (size_t j = 0; j < 2; ++ j)
-							{
-								if (index * 2 + j < strs.size())
-								{
-									boost::algorithm::trim(strs[index * 2 + j]);
-									init_val[index][j] = boost::lexical_cast<uint32_t>(strs[index * 2 + j]);
-								}
-							}
-						}
-						*var = init_val;
-					}
-				}
+				*var = read_array<uint2, uint32_t>(node, array_size);
 			}
 			break;
 
@@ -829,17 +761,17 @@ namespace
 				attr = node.Attrib("x");
 				if (attr)
 				{
-					tmp.x() = attr->ValueUInt();
+					tmp.x() = attr.ValueUInt();
 				}
 				attr = node.Attrib("y");
 				if (attr)
 				{
-					tmp.y() = attr->ValueUInt();
+					tmp.y() = attr.ValueUInt();
 				}
 				attr = node.Attrib("z");
 				if (attr)
 				{
-					tmp.z() = attr->ValueUInt();
+					tmp.z() = attr.ValueUInt();
 				}
 
 				var = MakeUniquePtr<RenderVariableUInt3>();
@@ -849,30 +781,7 @@ namespace
 			{
 				var = MakeUniquePtr<RenderVariableInt3Array>();
 
-				XMLNodePtr value_node = node.FirstNode("value");
-				if (value_node)
-				{
-					value_node = value_node->FirstNode();
-					if (value_node && (XNT_CData == value_node->Type()))
-					{
-						std::string const & value_str = value_node->ValueString();
-						std::vector<std::string> strs;
-						boost::algorithm::split(strs, value_str, boost::is_any_of(","));
-						std::vector<uint3> init_val(std::min(array_size, static_cast<uint32_t>((strs.size() + 2) / 3)), int3(0, 0, 0));
-						for (size_t index = 0; index < init_val.size(); ++ index)
-						{
-							for (size_t j = 0; j < 3; ++ j)
-							{
-								if (index * 3 + j < strs.size())
-								{
-									boost::algorithm::trim(strs[index * 3 + j]);
-									init_val[index][j] = boost::lexical_cast<uint32_t>(strs[index * 3 + j]);
-								}
-							}
-						}
-						*var = init_val;
-					}
-				}
+				*var = read_array<uint3, uint32_t>(node, array_size);
 			}
 			break;
 
@@ -883,22 +792,22 @@ namespace
 				attr = node.Attrib("x");
 				if (attr)
 				{
-					tmp.x() = attr->ValueUInt();
+					tmp.x() = attr.ValueUInt();
 				}
 				attr = node.Attrib("y");
 				if (attr)
 				{
-					tmp.y() = attr->ValueUInt();
+					tmp.y() = attr.ValueUInt();
 				}
 				attr = node.Attrib("z");
 				if (attr)
 				{
-					tmp.z() = attr->ValueUInt();
+					tmp.z() = attr.ValueUInt();
 				}
 				attr = node.Attrib("w");
 				if (attr)
 				{
-					tmp.w() = attr->ValueUInt();
+					tmp.w() = attr.ValueUInt();
 				}
 
 				var = MakeUniquePtr<RenderVariableUInt4>();
@@ -908,30 +817,7 @@ namespace
 			{
 				var = MakeUniquePtr<RenderVariableInt4Array>();
 
-				XMLNodePtr value_node = node.FirstNode("value");
-				if (value_node)
-				{
-					value_node = value_node->FirstNode();
-					if (value_node && (XNT_CData == value_node->Type()))
-					{
-						std::string const & value_str = value_node->ValueString();
-						std::vector<std::string> strs;
-						boost::algorithm::split(strs, value_str, boost::is_any_of(","));
-						std::vector<int4> init_val(std::min(array_size, static_cast<uint32_t>((strs.size() + 3) / 4)), int4(0, 0, 0, 0));
-						for (size_t index = 0; index < init_val.size(); ++ index)
-						{
-							for (size_t j = 0; j < 4; ++ j)
-							{
-								if (index * 4 + j < strs.size())
-								{
-									boost::algorithm::trim(strs[index * 4 + j]);
-									init_val[index][j] = boost::lexical_cast<uint32_t>(strs[index * 4 + j]);
-								}
-							}
-						}
-						*var = init_val;
-					}
-				}
+				*var = read_array<int4, uint32_t>(node, array_size);
 			}
 			break;
 
@@ -942,12 +828,12 @@ namespace
 				attr = node.Attrib("x");
 				if (attr)
 				{
-					tmp.x() = attr->ValueInt();
+					tmp.x() = attr.ValueInt();
 				}
 				attr = node.Attrib("y");
 				if (attr)
 				{
-					tmp.y() = attr->ValueInt();
+					tmp.y() = attr.ValueInt();
 				}
 
 				var = MakeUniquePtr<RenderVariableInt2>();
@@ -957,30 +843,7 @@ namespace
 			{
 				var = MakeUniquePtr<RenderVariableInt2Array>();
 
-				XMLNodePtr value_node = node.FirstNode("value");
-				if (value_node)
-				{
-					value_node = value_node->FirstNode();
-					if (value_node && (XNT_CData == value_node->Type()))
-					{
-						std::string const & value_str = value_node->ValueString();
-						std::vector<std::string> strs;
-						boost::algorithm::split(strs, value_str, boost::is_any_of(","));
-						std::vector<int2> init_val(std::min(array_size, static_cast<uint32_t>((strs.size() + 1) / 2)), int2(0, 0));
-						for (size_t index = 0; index < init_val.size(); ++ index)
-						{
-							for (size_t j = 0; j < 2; ++ j)
-							{
-								if (index * 2 + j < strs.size())
-								{
-									boost::algorithm::trim(strs[index * 2 + j]);
-									init_val[index][j] = boost::lexical_cast<int32_t>(strs[index * 2 + j]);
-								}
-							}
-						}
-						*var = init_val;
-					}
-				}
+				*var = read_array<int2, int32_t>(node, array_size);
 			}
 			break;
 
@@ -991,17 +854,17 @@ namespace
 				attr = node.Attrib("x");
 				if (attr)
 				{
-					tmp.x() = attr->ValueInt();
+					tmp.x() = attr.ValueInt();
 				}
 				attr = node.Attrib("y");
 				if (attr)
 				{
-					tmp.y() = attr->ValueInt();
+					tmp.y() = attr.ValueInt();
 				}
 				attr = node.Attrib("z");
 				if (attr)
 				{
-					tmp.z() = attr->ValueInt();
+					tmp.z() = attr.ValueInt();
 				}
 
 				var = MakeUniquePtr<RenderVariableInt3>();
@@ -1011,30 +874,7 @@ namespace
 			{
 				var = MakeUniquePtr<RenderVariableInt3Array>();
 
-				XMLNodePtr value_node = node.FirstNode("value");
-				if (value_node)
-				{
-					value_node = value_node->FirstNode();
-					if (value_node && (XNT_CData == value_node->Type()))
-					{
-						std::string const & value_str = value_node->ValueString();
-						std::vector<std::string> strs;
-						boost::algorithm::split(strs, value_str, boost::is_any_of(","));
-						std::vector<int3> init_val(std::min(array_size, static_cast<uint32_t>((strs.size() + 2) / 3)), int3(0, 0, 0));
-						for (size_t index = 0; index < init_val.size(); ++ index)
-						{
-							for (size_t j = 0; j < 3; ++ j)
-							{
-								if (index * 3 + j < strs.size())
-								{
-									boost::algorithm::trim(strs[index * 3 + j]);
-									init_val[index][j] = boost::lexical_cast<int32_t>(strs[index * 3 + j]);
-								}
-							}
-						}
-						*var = init_val;
-					}
-				}
+				*var = read_array<int3, int32_t>(node, array_size);
 			}
 			break;
 
@@ -1045,22 +885,22 @@ namespace
 				attr = node.Attrib("x");
 				if (attr)
 				{
-					tmp.x() = attr->ValueInt();
+					tmp.x() = attr.ValueInt();
 				}
 				attr = node.Attrib("y");
 				if (attr)
 				{
-					tmp.y() = attr->ValueInt();
+					tmp.y() = attr.ValueInt();
 				}
 				attr = node.Attrib("z");
 				if (attr)
 				{
-					tmp.z() = attr->ValueInt();
+					tmp.z() = attr.ValueInt();
 				}
 				attr = node.Attrib("w");
 				if (attr)
 				{
-					tmp.w() = attr->ValueInt();
+					tmp.w() = attr.ValueInt();
 				}
 
 				var = MakeUniquePtr<RenderVariableInt4>();
@@ -1070,30 +910,7 @@ namespace
 			{
 				var = MakeUniquePtr<RenderVariableInt4Array>();
 
-				XMLNodePtr value_node = node.FirstNode("value");
-				if (value_node)
-				{
-					value_node = value_node->FirstNode();
-					if (value_node && (XNT_CData == value_node->Type()))
-					{
-						std::string const & value_str = value_node->ValueString();
-						std::vector<std::string> strs;
-						boost::algorithm::split(strs, value_str, boost::is_any_of(","));
-						std::vector<int4> init_val(std::min(array_size, static_cast<uint32_t>((strs.size() + 3) / 4)), int4(0, 0, 0, 0));
-						for (size_t index = 0; index < init_val.size(); ++ index)
-						{
-							for (size_t j = 0; j < 4; ++ j)
-							{
-								if (index * 4 + j < strs.size())
-								{
-									boost::algorithm::trim(strs[index * 4 + j]);
-									init_val[index][j] = boost::lexical_cast<int32_t>(strs[index * 4 + j]);
-								}
-							}
-						}
-						*var = init_val;
-					}
-				}
+				*var = read_array<int4, int32_t>(node, array_size);
 			}
 			break;
 
@@ -1104,12 +921,12 @@ namespace
 				attr = node.Attrib("x");
 				if (attr)
 				{
-					tmp.x() = attr->ValueFloat();
+					tmp.x() = attr.ValueFloat();
 				}
 				attr = node.Attrib("y");
 				if (attr)
 				{
-					tmp.y() = attr->ValueFloat();
+					tmp.y() = attr.ValueFloat();
 				}
 
 				var = MakeUniquePtr<RenderVariableFloat2>();
@@ -1119,30 +936,7 @@ namespace
 			{
 				var = MakeUniquePtr<RenderVariableFloat2Array>();
 
-				XMLNodePtr value_node = node.FirstNode("value");
-				if (value_node)
-				{
-					value_node = value_node->FirstNode();
-					if (value_node && (XNT_CData == value_node->Type()))
-					{
-						std::string const & value_str = value_node->ValueString();
-						std::vector<std::string> strs;
-						boost::algorithm::split(strs, value_str, boost::is_any_of(","));
-						std::vector<float2> init_val(std::min(array_size, static_cast<uint32_t>((strs.size() + 1) / 2)), float2(0, 0));
-						for (size_t index = 0; index < init_val.size(); ++ index)
-						{
-							for (size_t j = 0; j < 2; ++ j)
-							{
-								if (index * 2 + j < strs.size())
-								{
-									boost::algorithm::trim(strs[index * 2 + j]);
-									init_val[index][j] = boost::lexical_cast<float>(strs[index * 2 + j]);
-								}
-							}
-						}
-						*var = init_val;
-					}
-				}
+				*var = read_array<float2, float>(node, array_size);
 			}
 			break;
 
@@ -1153,17 +947,17 @@ namespace
 				attr = node.Attrib("x");
 				if (attr)
 				{
-					tmp.x() = attr->ValueFloat();
+					tmp.x() = attr.ValueFloat();
 				}
 				attr = node.Attrib("y");
 				if (attr)
 				{
-					tmp.y() = attr->ValueFloat();
+					tmp.y() = attr.ValueFloat();
 				}
 				attr = node.Attrib("z");
 				if (attr)
 				{
-					tmp.z() = attr->ValueFloat();
+					tmp.z() = attr.ValueFloat();
 				}
 
 				var = MakeUniquePtr<RenderVariableFloat3>();
@@ -1173,30 +967,7 @@ namespace
 			{
 				var = MakeUniquePtr<RenderVariableFloat3Array>();
 
-				XMLNodePtr value_node = node.FirstNode("value");
-				if (value_node)
-				{
-					value_node = value_node->FirstNode();
-					if (value_node && (XNT_CData == value_node->Type()))
-					{
-						std::string const & value_str = value_node->ValueString();
-						std::vector<std::string> strs;
-						boost::algorithm::split(strs, value_str, boost::is_any_of(","));
-						std::vector<float3> init_val(std::min(array_size, static_cast<uint32_t>((strs.size() + 2) / 3)), float3(0, 0, 0));
-						for (size_t index = 0; index < init_val.size(); ++ index)
-						{
-							for (size_t j = 0; j < 3; ++ j)
-							{
-								if (index * 3 + j < strs.size())
-								{
-									boost::algorithm::trim(strs[index * 3 + j]);
-									init_val[index][j] = boost::lexical_cast<float>(strs[index * 3 + j]);
-								}
-							}
-						}
-						*var = init_val;
-					}
-				}
+				*var = read_array<float3, float>(node, array_size);
 			}
 			break;
 
@@ -1207,22 +978,22 @@ namespace
 				attr = node.Attrib("x");
 				if (attr)
 				{
-					tmp.x() = attr->ValueFloat();
+					tmp.x() = attr.ValueFloat();
 				}
 				attr = node.Attrib("y");
 				if (attr)
 				{
-					tmp.y() = attr->ValueFloat();
+					tmp.y() = attr.ValueFloat();
 				}
 				attr = node.Attrib("z");
 				if (attr)
 				{
-					tmp.z() = attr->ValueFloat();
+					tmp.z() = attr.ValueFloat();
 				}
 				attr = node.Attrib("w");
 				if (attr)
 				{
-					tmp.w() = attr->ValueFloat();
+					tmp.w() = attr.ValueFloat();
 				}
 
 				var = MakeUniquePtr<RenderVariableFloat4>();
@@ -1232,30 +1003,7 @@ namespace
 			{
 				var = MakeUniquePtr<RenderVariableFloat4Array>();
 
-				XMLNodePtr value_node = node.FirstNode("value");
-				if (value_node)
-				{
-					value_node = value_node->FirstNode();
-					if (value_node && (XNT_CData == value_node->Type()))
-					{
-						std::string const & value_str = value_node->ValueString();
-						std::vector<std::string> strs;
-						boost::algorithm::split(strs, value_str, boost::is_any_of(","));
-						std::vector<float4> init_val(std::min(array_size, static_cast<uint32_t>((strs.size() + 3) / 4)), float4(0, 0, 0, 0));
-						for (size_t index = 0; index < init_val.size(); ++ index)
-						{
-							for (size_t j = 0; j < 4; ++ j)
-							{
-								if (index * 4 + j < strs.size())
-								{
-									boost::algorithm::trim(strs[index * 4 + j]);
-									init_val[index][j] = boost::lexical_cast<float>(strs[index * 4 + j]);
-								}
-							}
-						}
-						*var = init_val;
-					}
-				}
+				*var = read_array<float4, float>(node, array_size);
 			}
 			break;
 
@@ -1271,7 +1019,7 @@ namespace
 							+ static_cast<char>('0' + y) + static_cast<char>('0' + x));
 						if (attr)
 						{
-							tmp[y * 4 + x] = attr->ValueFloat();
+							tmp[y * 4 + x] = attr.ValueFloat();
 						}
 					}
 				}
@@ -1283,30 +1031,7 @@ namespace
 			{
 				var = MakeUniquePtr<RenderVariableFloat4x4Array>();
 
-				XMLNodePtr value_node = node.FirstNode("value");
-				if (value_node)
-				{
-					value_node = value_node->FirstNode();
-					if (value_node && (XNT_CData == value_node->Type()))
-					{
-						std::string const & value_str = value_node->ValueString();
-						std::vector<std::string> strs;
-						boost::algorithm::split(strs, value_str, boost::is_any_of(","));
-						std::vector<float4> init_val(std::min(array_size, static_cast<uint32_t>((strs.size() + 3) / 4)), float4(0, 0, 0, 0));
-						for (size_t index = 0; index < init_val.size(); ++ index)
-						{
-							for (size_t j = 0; j < 16; ++ j)
-							{
-								if (index * 16 + j < strs.size())
-								{
-									boost::algorithm::trim(strs[index * 16 + j]);
-									init_val[index][j] = boost::lexical_cast<float>(strs[index * 16 + j]);
-								}
-							}
-						}
-						*var = init_val;
-					}
-				}
+				*var = read_array<float4x4, float>(node, array_size);
 			}
 			break;
 
@@ -1321,7 +1046,7 @@ namespace
 			attr = node.Attrib("elem_type");
 			if (attr)
 			{
-				*var = attr->ValueString();
+				*var = std::string(attr.ValueString());
 			}
 			else
 			{
@@ -2458,6 +2183,17 @@ namespace KlayGE
 			return false;
 		}
 
+		size_t Key() const override
+		{
+			size_t seed = 0;
+			HashCombine(seed, this->Type());
+			for (auto const & name : effect_desc_.res_name)
+			{
+				HashRange(seed, name.begin(), name.end());
+			}
+			return seed;
+		}
+
 		bool Match(ResLoadingDesc const & rhs) const override
 		{
 			if (this->Type() == rhs.Type())
@@ -2497,7 +2233,7 @@ namespace KlayGE
 	{
 		type_ = type_define::instance().TypeCode(node->Attrib("type")->ValueString());
 		name_ = node->Attrib("name")->ValueString();
-		var_ = read_var(*node, type_, 0);
+		var_ = read_var(XMLNodeView(*node), type_, 0);
 	}
 #endif
 
@@ -3751,15 +3487,14 @@ namespace KlayGE
 
 				is_validate_ &= pass->Validate();
 
-				for (XMLNodePtr state_node = pass_node->FirstNode("state"); state_node; state_node = state_node->NextSibling("state"))
+				for (XMLNodeView state_node = XMLNodeView(*pass_node).FirstNode("state"); state_node;
+					state_node = state_node.NextSibling("state"))
 				{
 					++ weight_;
 
-					std::string state_name = state_node->Attrib("name")->ValueString();
-					if ("blend_enable" == state_name)
+					if ("blend_enable" == state_node.Attrib("name").ValueString())
 					{
-						std::string value_str = state_node->Attrib("value")->ValueString();
-						if (BoolFromStr(value_str))
+						if (BoolFromStr(state_node.Attrib("value").ValueString()))
 						{
 							transparent_ = true;
 						}
@@ -3993,15 +3728,15 @@ namespace KlayGE
 			shader_desc_ids_ = inherit_pass->shader_desc_ids_;
 		}
 
-		for (XMLNodePtr state_node = node->FirstNode("state"); state_node; state_node = state_node->NextSibling("state"))
+		for (XMLNodeView state_node = XMLNodeView(*node).FirstNode("state"); state_node; state_node = state_node.NextSibling("state"))
 		{
-			size_t const state_name_hash = RT_HASH(state_node->Attrib("name")->ValueString().c_str());
+			size_t const state_name_hash = RT_HASH(state_node.Attrib("name").ValueString());
 
-			XMLAttributePtr const value_attr = state_node->Attrib("value");
+			XMLAttributeView const value_attr = state_node.Attrib("value");
 			std::string_view value_str;
 			if (value_attr)
 			{
-				value_str = value_attr->ValueString();
+				value_str = value_attr.ValueString();
 			}
 
 			if (CT_HASH("polygon_mode") == state_name_hash)
@@ -4022,11 +3757,11 @@ namespace KlayGE
 			}
 			else if (CT_HASH("polygon_offset_factor") == state_name_hash)
 			{
-				rs_desc.polygon_offset_factor = value_attr->ValueFloat();
+				rs_desc.polygon_offset_factor = value_attr.ValueFloat();
 			}
 			else if (CT_HASH("polygon_offset_units") == state_name_hash)
 			{
-				rs_desc.polygon_offset_units = value_attr->ValueFloat();
+				rs_desc.polygon_offset_units = value_attr.ValueFloat();
 			}
 			else if (CT_HASH("depth_clip_enable") == state_name_hash)
 			{
@@ -4050,80 +3785,80 @@ namespace KlayGE
 			}
 			else if (CT_HASH("blend_enable") == state_name_hash)
 			{
-				int index = get_index(*state_node);
+				int index = get_index(state_node);
 				bs_desc.blend_enable[index] = BoolFromStr(value_str);
 			}
 			else if (CT_HASH("logic_op_enable") == state_name_hash)
 			{
-				int index = get_index(*state_node);
+				int index = get_index(state_node);
 				bs_desc.logic_op_enable[index] = BoolFromStr(value_str);
 			}
 			else if (CT_HASH("blend_op") == state_name_hash)
 			{
-				int index = get_index(*state_node);
+				int index = get_index(state_node);
 				bs_desc.blend_op[index] = BlendOperationFromStr(value_str);
 			}
 			else if (CT_HASH("src_blend") == state_name_hash)
 			{
-				int index = get_index(*state_node);
+				int index = get_index(state_node);
 				bs_desc.src_blend[index] = AlphaBlendFactorFromStr(value_str);
 			}
 			else if (CT_HASH("dest_blend") == state_name_hash)
 			{
-				int index = get_index(*state_node);
+				int index = get_index(state_node);
 				bs_desc.dest_blend[index] = AlphaBlendFactorFromStr(value_str);
 			}
 			else if (CT_HASH("blend_op_alpha") == state_name_hash)
 			{
-				int index = get_index(*state_node);
+				int index = get_index(state_node);
 				bs_desc.blend_op_alpha[index] = BlendOperationFromStr(value_str);
 			}
 			else if (CT_HASH("src_blend_alpha") == state_name_hash)
 			{
-				int index = get_index(*state_node);
+				int index = get_index(state_node);
 				bs_desc.src_blend_alpha[index] = AlphaBlendFactorFromStr(value_str);
 			}
 			else if (CT_HASH("dest_blend_alpha") == state_name_hash)
 			{
-				int index = get_index(*state_node);
+				int index = get_index(state_node);
 				bs_desc.dest_blend_alpha[index] = AlphaBlendFactorFromStr(value_str);
 			}
 			else if (CT_HASH("logic_op") == state_name_hash)
 			{
-				int index = get_index(*state_node);
+				int index = get_index(state_node);
 				bs_desc.logic_op[index] = LogicOperationFromStr(value_str);
 			}
 			else if (CT_HASH("color_write_mask") == state_name_hash)
 			{
-				int index = get_index(*state_node);
-				bs_desc.color_write_mask[index] = static_cast<uint8_t>(value_attr->ValueUInt());
+				int index = get_index(state_node);
+				bs_desc.color_write_mask[index] = static_cast<uint8_t>(value_attr.ValueUInt());
 			}
 			else if (CT_HASH("blend_factor") == state_name_hash)
 			{
-				XMLAttributePtr attr = state_node->Attrib("r");
+				XMLAttributeView attr = state_node.Attrib("r");
 				if (attr)
 				{
-					bs_desc.blend_factor.r() = attr->ValueFloat();
+					bs_desc.blend_factor.r() = attr.ValueFloat();
 				}
-				attr = state_node->Attrib("g");
+				attr = state_node.Attrib("g");
 				if (attr)
 				{
-					bs_desc.blend_factor.g() = attr->ValueFloat();
+					bs_desc.blend_factor.g() = attr.ValueFloat();
 				}
-				attr = state_node->Attrib("b");
+				attr = state_node.Attrib("b");
 				if (attr)
 				{
-					bs_desc.blend_factor.b() = attr->ValueFloat();
+					bs_desc.blend_factor.b() = attr.ValueFloat();
 				}
-				attr = state_node->Attrib("a");
+				attr = state_node.Attrib("a");
 				if (attr)
 				{
-					bs_desc.blend_factor.a() = attr->ValueFloat();
+					bs_desc.blend_factor.a() = attr.ValueFloat();
 				}
 			}
 			else if (CT_HASH("sample_mask") == state_name_hash)
 			{
-				bs_desc.sample_mask = value_attr->ValueUInt();
+				bs_desc.sample_mask = value_attr.ValueUInt();
 			}
 			else if (CT_HASH("depth_enable") == state_name_hash)
 			{
@@ -4147,15 +3882,15 @@ namespace KlayGE
 			}
 			else if (CT_HASH("front_stencil_ref") == state_name_hash)
 			{
-				dss_desc.front_stencil_ref = static_cast<uint16_t>(value_attr->ValueUInt());
+				dss_desc.front_stencil_ref = static_cast<uint16_t>(value_attr.ValueUInt());
 			}
 			else if (CT_HASH("front_stencil_read_mask") == state_name_hash)
 			{
-				dss_desc.front_stencil_read_mask = static_cast<uint16_t>(value_attr->ValueUInt());
+				dss_desc.front_stencil_read_mask = static_cast<uint16_t>(value_attr.ValueUInt());
 			}
 			else if (CT_HASH("front_stencil_write_mask") == state_name_hash)
 			{
-				dss_desc.front_stencil_write_mask = static_cast<uint16_t>(value_attr->ValueUInt());
+				dss_desc.front_stencil_write_mask = static_cast<uint16_t>(value_attr.ValueUInt());
 			}
 			else if (CT_HASH("front_stencil_fail") == state_name_hash)
 			{
@@ -4179,15 +3914,15 @@ namespace KlayGE
 			}
 			else if (CT_HASH("back_stencil_ref") == state_name_hash)
 			{
-				dss_desc.back_stencil_ref = static_cast<uint16_t>(value_attr->ValueUInt());
+				dss_desc.back_stencil_ref = static_cast<uint16_t>(value_attr.ValueUInt());
 			}
 			else if (CT_HASH("back_stencil_read_mask") == state_name_hash)
 			{
-				dss_desc.back_stencil_read_mask = static_cast<uint16_t>(value_attr->ValueUInt());
+				dss_desc.back_stencil_read_mask = static_cast<uint16_t>(value_attr.ValueUInt());
 			}
 			else if (CT_HASH("back_stencil_write_mask") == state_name_hash)
 			{
-				dss_desc.back_stencil_write_mask = static_cast<uint16_t>(value_attr->ValueUInt());
+				dss_desc.back_stencil_write_mask = static_cast<uint16_t>(value_attr.ValueUInt());
 			}
 			else if (CT_HASH("back_stencil_fail") == state_name_hash)
 			{
@@ -4233,24 +3968,24 @@ namespace KlayGE
 				}
 
 				ShaderDesc sd;
-				sd.profile = get_profile(*state_node);
-				sd.func_name = get_func_name(*state_node);
+				sd.profile = get_profile(state_node);
+				sd.func_name = get_func_name(state_node);
 				sd.macros_hash = macros_hash;
 
 				if ((ShaderObject::ST_VertexShader == type) || (ShaderObject::ST_GeometryShader == type))
 				{
-					XMLNodePtr so_node = state_node->FirstNode("stream_output");
+					XMLNodeView so_node = state_node.FirstNode("stream_output");
 					if (so_node)
 					{
-						for (XMLNodePtr entry_node = so_node->FirstNode("entry"); entry_node; entry_node = entry_node->NextSibling("entry"))
+						for (XMLNodeView entry_node = so_node.FirstNode("entry"); entry_node; entry_node = entry_node.NextSibling("entry"))
 						{
 							ShaderDesc::StreamOutputDecl decl;
 
-							size_t const usage_str_hash = RT_HASH(entry_node->Attrib("usage")->ValueString().c_str());
-							XMLAttributePtr attr = entry_node->Attrib("usage_index");
+							size_t const usage_str_hash = RT_HASH(entry_node.Attrib("usage").ValueString());
+							XMLAttributeView attr = entry_node.Attrib("usage_index");
 							if (attr)
 							{
-								decl.usage_index = static_cast<uint8_t>(attr->ValueInt());
+								decl.usage_index = static_cast<uint8_t>(attr.ValueInt());
 							}
 							else
 							{
@@ -4297,11 +4032,11 @@ namespace KlayGE
 								decl.usage = VEU_Binormal;
 							}
 
-							attr = entry_node->Attrib("component");
-							std::string component_str;
+							attr = entry_node.Attrib("component");
+							std::string_view component_str;
 							if (attr)
 							{
-								component_str = attr->ValueString();
+								component_str = attr.ValueString();
 							}
 							else
 							{
@@ -4310,10 +4045,10 @@ namespace KlayGE
 							decl.start_component = static_cast<uint8_t>(component_str[0] - 'x');
 							decl.component_count = static_cast<uint8_t>(std::min(static_cast<size_t>(4), component_str.size()));
 
-							attr = entry_node->Attrib("slot");
+							attr = entry_node.Attrib("slot");
 							if (attr)
 							{
-								decl.slot = static_cast<uint8_t>(attr->ValueInt());
+								decl.slot = static_cast<uint8_t>(attr.ValueInt());
 							}
 							else
 							{
@@ -4799,7 +4534,7 @@ namespace KlayGE
 		{
 			as = 0;
 		}
-		var_ = read_var(*node, type_, as);
+		var_ = read_var(XMLNodeView(*node), type_, as);
 
 		{
 			XMLNodePtr anno_node = node->FirstNode("annotation");
@@ -5267,6 +5002,7 @@ namespace KlayGE
 
 
 	RenderVariable::RenderVariable()
+		: version_(1)
 	{
 	}
 
@@ -5687,10 +5423,16 @@ namespace KlayGE
 			}
 
 			data_.cbuff_desc.cbuff->Dirty(true);
+			++ version_;
 		}
 		else
 		{
-			this->RetriveT() = value;
+			std::vector<float4x4>& val = this->RetriveT();
+			if (val != value)
+			{
+				val = value;
+				++ version_;
+			}
 		}
 		return *this;
 	}
@@ -5734,13 +5476,17 @@ namespace KlayGE
 			array_size = value->ArraySize();
 			mipmap = value->NumMipMaps();
 		}
-		val_ = TextureSubresource(value, 0, array_size, 0, mipmap);
-		return *this;
+		return this->operator=(TextureSubresource(value, 0, array_size, 0, mipmap));
 	}
 
 	RenderVariable& RenderVariableTexture::operator=(TextureSubresource const & value)
 	{
-		val_ = value;
+		if ((val_.tex != value.tex) || (val_.first_array_index != value.first_array_index) || (val_.num_items != value.num_items)
+			|| (val_.first_level != value.first_level) || (val_.num_levels != value.num_levels))
+		{
+			val_ = value;
+			++ version_;
+		}
 		return *this;
 	}
 
@@ -5766,7 +5512,11 @@ namespace KlayGE
 
 	RenderVariable& RenderVariableTexture::operator=(std::string const & value)
 	{
-		elem_type_ = value;
+		if (elem_type_ != value)
+		{
+			elem_type_ = value;
+			++ version_;
+		}
 		return *this;
 	}
 
@@ -5790,7 +5540,11 @@ namespace KlayGE
 
 	RenderVariable& RenderVariableBuffer::operator=(GraphicsBufferPtr const & value)
 	{
-		val_ = value;
+		if (val_ != value)
+		{
+			val_ = value;
+			++ version_;
+		}
 		return *this;
 	}
 
@@ -5801,7 +5555,11 @@ namespace KlayGE
 
 	RenderVariable& RenderVariableBuffer::operator=(std::string const & value)
 	{
-		elem_type_ = value;
+		if (elem_type_ != value)
+		{
+			elem_type_ = value;
+			++ version_;
+		}
 		return *this;
 	}
 
@@ -5825,7 +5583,11 @@ namespace KlayGE
 
 	RenderVariable& RenderVariableByteAddressBuffer::operator=(GraphicsBufferPtr const & value)
 	{
-		val_ = value;
+		if (val_ != value)
+		{
+			val_ = value;
+			++ version_;
+		}
 		return *this;
 	}
 
@@ -5836,7 +5598,11 @@ namespace KlayGE
 
 	RenderVariable& RenderVariableByteAddressBuffer::operator=(std::string const & value)
 	{
-		elem_type_ = value;
+		if (elem_type_ != value)
+		{
+			elem_type_ = value;
+			++ version_;
+		}
 		return *this;
 	}
 
@@ -67,6 +67,7 @@ namespace KlayGE
 	RenderEngine::RenderEngine()
 		: num_primitives_just_rendered_(0), num_vertices_just_rendered_(0),
 			num_draws_just_called_(0), num_dispatches_just_called_(0),
+			num_param_binds_just_applied_(0), num_param_binds_just_skipped_(0),
 			default_fov_(PI / 4), default_render_width_scale_(1), default_render_height_scale_(1),
 			stereo_method_(STM_None), stereo_separation_(0),
 			fb_stage_(0), force_line_mode_(false)
@@ -537,6 +538,7 @@ namespace KlayGE
 
 #ifndef KLAYGE_SHIP
 		PerfProfiler& profiler = PerfProfiler::Instance();
+		frame_perf_ = profiler.CreatePerfRange(0, "Frame");
 		hdr_pp_perf_ = profiler.CreatePerfRange(0, "HDR PP");
 		smaa_pp_perf_ = profiler.CreatePerfRange(0, "SMAA PP");
 		post_tone_mapping_pp_perf_ = profiler.CreatePerfRange(0, "Post tone mapping PP");
@@ -728,6 +730,20 @@ namespace KlayGE
 		return ret;
 	}
 
+	uint32_t RenderEngine::NumParamBindsJustApplied()
+	{
+		uint32_t const ret = num_param_binds_just_applied_;
+		num_param_binds_just_applied_ = 0;
+		return ret;
+	}
+
+	uint32_t RenderEngine::NumParamBindsJustSkipped()
+	{
+		uint32_t const ret = num_param_binds_just_skipped_;
+		num_param_binds_just_skipped_ = 0;
+		return ret;
+	}
+
 	// ȡȾ豸
 	/////////////////////////////////////////////////////////////////////////////////
 	RenderDeviceCaps const & RenderEngine::DeviceCaps() const
@@ -1114,9 +1130,13 @@ namespace KlayGE
 	{
 		if (Context::Instance().AppInstance().MainWnd()->Active())
 		{
+#ifndef KLAYGE_SHIP
+			frame_perf_->Begin();
+#endif
 			Context::Instance().SceneManagerInstance().Update();
 
 #ifndef KLAYGE_SHIP
+			frame_perf_->End();
 			PerfProfiler::Instance().CollectData();
 #endif
 		}
@@ -1514,6 +1534,7 @@ namespace KlayGE
 		}
 
 #ifndef KLAYGE_SHIP
+		frame_perf_.reset();
 		hdr_pp_perf_.reset();
 		smaa_pp_perf_.reset();
 		post_tone_mapping_pp_perf_.reset();
@@ -32,14 +32,49 @@
 #include <KlayGE/Context.hpp>
 #include <KlayGE/RenderFactory.hpp>
 #include <KlayGE/Texture.hpp>
+#include <KFL/Thread.hpp>
 
 #include <vector>
 #include <cstring>
 
 #include <KlayGE/TexCompression.hpp>
 
+namespace
+{
+	// Images smaller than this are not worth spreading over the task scheduler
+	uint32_t const MIN_PARALLEL_BLOCKS = 64;
+}
+
 namespace KlayGE
 {
+	void TexCompression::EncodeBlocks(void* output, void const * input, uint32_t num_blocks, TexCompressionMethod method)
+	{
+		uint32_t const in_block_bytes = block_width_ * block_height_ * NumFormatBytes(decoded_fmt_);
+
+		uint8_t* dst = static_cast<uint8_t*>(output);
+		uint8_t const * src = static_cast<uint8_t const *>(input);
+		for (uint32_t i = 0; i < num_blocks; ++ i)
+		{
+			this->EncodeBlock(dst, src, method);
+			dst += block_bytes_;
+			src += in_block_bytes;
+		}
+	}
+
+	void TexCompression::DecodeBlocks(void* output, void const * input, uint32_t num_blocks)
+	{
+		uint32_t const out_block_bytes = block_width_ * block_height_ * NumFormatBytes(decoded_fmt_);
+
+		uint8_t* dst = static_cast<uint8_t*>(output);
+		uint8_t const * src = static_cast<uint8_t const *>(input);
+		for (uint32_t i = 0; i < num_blocks; ++ i)
+		{
+			this->DecodeBlock(dst, src);
+			dst += out_block_bytes;
+			src += block_bytes_;
+		}
+	}
+
 	void TexCompression::EncodeMem(uint32_t width, uint32_t height,
 		void* output, uint32_t out_row_pitch, uint32_t out_slice_pitch,
 		void const * input, uint32_t in_row_pitch, uint32_t in_slice_pitch,
@@ -49,37 +84,54 @@ namespace KlayGE
 		KFL_UNUSED(in_slice_pitch);
 
 		uint32_t const elem_size = NumFormatBytes(decoded_fmt_);
+		uint32_t const in_block_bytes = block_width_ * block_height_ * elem_size;
+		uint32_t const blocks_x = (width + block_width_ - 1) / block_width_;
+		uint32_t const blocks_y = (height + block_height_ - 1) / block_height_;
 
 		uint8_t const * src = static_cast<uint8_t const *>(input);
 
-		std::vector<uint8_t> uncompressed(block_width_ * block_height_ * elem_size);
-		for (uint32_t y_base = 0; y_base < height; y_base += block_height_)
+		// Each range of block rows is gathered into a row of tightly packed blocks and encoded in one batch
+		auto encode_rows = [=](TexCompression& codec, size_t row_begin, size_t row_end)
 		{
-			uint8_t* dst = static_cast<uint8_t*>(output) + (y_base / block_height_) * out_row_pitch;
-
-			for (uint32_t x_base = 0; x_base < width; x_base += block_width_)
+			std::vector<uint8_t> uncompressed(blocks_x * in_block_bytes);
+			for (size_t by = row_begin; by < row_end; ++ by)
 			{
-				for (uint32_t y = 0; y < block_height_; ++ y)
+				uint32_t const y_base = static_cast<uint32_t>(by) * block_height_;
+				for (uint32_t bx = 0; bx < blocks_x; ++ bx)
 				{
-					for (uint32_t x = 0; x < block_width_; ++ x)
+					uint32_t const x_base = bx * block_width_;
+					uint32_t const copy_bytes = std::min(block_width_, width - x_base) * elem_size;
+					for (uint32_t y = 0; y < block_height_; ++ y)
 					{
-						if ((x_base + x < width) && (y_base + y < height))
+						uint8_t* block_row = &uncompressed[bx * in_block_bytes + y * block_width_ * elem_size];
+						if (y_base + y < height)
 						{
-							memcpy(&uncompressed[(y * block_width_ + x) * elem_size],
-								&src[(y_base + y) * in_row_pitch + (x_base + x) * elem_size],
-								elem_size);
+							memcpy(block_row, &src[(y_base + y) * in_row_pitch + x_base * elem_size], copy_bytes);
+							memset(block_row + copy_bytes, 0, block_width_ * elem_size - copy_bytes);
 						}
 						else
 						{
-							memset(&uncompressed[(y * block_width_ + x) * elem_size],
-								0, elem_size);
+							memset(block_row, 0, block_width_ * elem_size);
 						}
 					}
 				}
 
-				this->EncodeBlock(dst, &uncompressed[0], method);
-				dst += block_bytes_;
+				codec.EncodeBlocks(static_cast<uint8_t*>(output) + by * out_row_pitch, &uncompressed[0], blocks_x, method);
 			}
+		};
+
+		if (blocks_x * blocks_y < MIN_PARALLEL_BLOCKS)
+		{
+			encode_rows(*this, 0, blocks_y);
+		}
+		else
+		{
+			Context::Instance().TaskScheduler().parallel_for(0, blocks_y, std::max(MIN_PARALLEL_BLOCKS / blocks_x, 1U),
+				[this, &encode_rows](size_t row_begin, size_t row_end)
+				{
+					TexCompressionPtr codec = this->Clone();
+					encode_rows(*codec, row_begin, row_end);
+				});
 		}
 	}
 
@@ -91,31 +143,46 @@ namespace KlayGE
 		KFL_UNUSED(in_slice_pitch);
 
 		uint32_t const elem_size = NumFormatBytes(decoded_fmt_);
+		uint32_t const out_block_bytes = block_width_ * block_height_ * elem_size;
+		uint32_t const blocks_x = (width + block_width_ - 1) / block_width_;
+		uint32_t const blocks_y = (height + block_height_ - 1) / block_height_;
 
-		uint8_t * dst = static_cast<uint8_t*>(output);
+		uint8_t* dst = static_cast<uint8_t*>(output);
 
-		std::vector<uint8_t> uncompressed(block_width_ * block_height_ * elem_size);
-		for (uint32_t y_base = 0; y_base < height; y_base += block_height_)
+		auto decode_rows = [=](TexCompression& codec, size_t row_begin, size_t row_end)
 		{
-			uint8_t const * src = static_cast<uint8_t const *>(input) + in_row_pitch * (y_base / block_height_);
-
-			uint32_t const block_h = std::min(block_height_, height - y_base);
-			for (uint32_t x_base = 0; x_base < width; x_base += block_width_)
+			std::vector<uint8_t> uncompressed(blocks_x * out_block_bytes);
+			for (size_t by = row_begin; by < row_end; ++ by)
 			{
-				uint32_t const block_w = std::min(block_width_, width - x_base);
-
-				this->DecodeBlock(&uncompressed[0], src);
-				src += block_bytes_;
+				codec.DecodeBlocks(&uncompressed[0], static_cast<uint8_t const *>(input) + by * in_row_pitch, blocks_x);
 
-				for (uint32_t y = 0; y < block_h; ++ y)
+				uint32_t const y_base = static_cast<uint32_t>(by) * block_height_;
+				uint32_t const block_h = std::min(block_height_, height - y_base);
+				for (uint32_t bx = 0; bx < blocks_x; ++ bx)
 				{
-					for (uint32_t x = 0; x < block_w; ++ x)
+					uint32_t const x_base = bx * block_width_;
+					uint32_t const copy_bytes = std::min(block_width_, width - x_base) * elem_size;
+					for (uint32_t y = 0; y < block_h; ++ y)
 					{
-						memcpy(&dst[(y_base + y) * out_row_pitch + (x_base + x) * elem_size],
-							&uncompressed[(y * block_width_ + x) * elem_size], elem_size);
+						memcpy(&dst[(y_base + y) * out_row_pitch + x_base * elem_size],
+							&uncompressed[bx * out_block_bytes + y * block_width_ * elem_size], copy_bytes);
 					}
 				}
 			}
+		};
+
+		if (blocks_x * blocks_y < MIN_PARALLEL_BLOCKS)
+		{
+			decode_rows(*this, 0, blocks_y);
+		}
+		else
+		{
+			Context::Instance().TaskScheduler().parallel_for(0, blocks_y, std::max(MIN_PARALLEL_BLOCKS / blocks_x, 1U),
+				[this, &decode_rows](size_t row_begin, size_t row_end)
+				{
+					TexCompressionPtr codec = this->Clone();
+					decode_rows(*codec, row_begin, row_end);
+				});
 		}
 	}
 
@@ -44,6 +44,9 @@
 #ifdef KLAYGE_COMPILER_MSVC
 	#include <intrin.h>		// For _BitScanForward
 #endif
+#if defined(KLAYGE_SSE2_SUPPORT)
+	#include <emmintrin.h>
+#endif
 
 #include <KlayGE/TexCompressionBC.hpp>
 #include "../Base/TableGen/Tables.hpp"
@@ -881,6 +884,29 @@ namespace
 			KFL_UNREACHABLE("Invalid rotation mode");
 		}
 	}
+
+	// Moves bit i of a 16-bit value to bit 2 * i
+	uint32_t SpreadBits16(uint32_t x)
+	{
+		x = (x | (x << 8)) & 0x00FF00FF;
+		x = (x | (x << 4)) & 0x0F0F0F0F;
+		x = (x | (x << 2)) & 0x33333333;
+		x = (x | (x << 1)) & 0x55555555;
+		return x;
+	}
+
+#if defined(KLAYGE_SSE2_SUPPORT)
+	// Dot products of 4 ARGBColor32 pixels with a direction, laid out as (b, g, r, 0) 16-bit pairs
+	__m128i DotARGB4(__m128i pixels, __m128i dir)
+	{
+		__m128i const zero = _mm_setzero_si128();
+		__m128i const lo = _mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), dir);
+		__m128i const hi = _mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), dir);
+		__m128 const even = _mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(2, 0, 2, 0));
+		__m128 const odd = _mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(3, 1, 3, 1));
+		return _mm_add_epi32(_mm_castps_si128(even), _mm_castps_si128(odd));
+	}
+#endif
 }
 
 namespace KlayGE
@@ -895,6 +921,11 @@ namespace KlayGE
 		decoded_fmt_ = EF_ARGB8;
 	}
 
+	TexCompressionPtr TexCompressionBC1::Clone() const
+	{
+		return MakeSharedPtr<TexCompressionBC1>();
+	}
+
 	void TexCompressionBC1::EncodeBlock(void* output, void const * input, TexCompressionMethod method)
 	{
 		BOOST_ASSERT(output);
@@ -999,6 +1030,40 @@ namespace KlayGE
 		int dirg = color[0].g() - color[1].g();
 		int dirb = color[0].b() - color[1].b();
 
+#if defined(KLAYGE_SSE2_SUPPORT)
+		if (!alpha)
+		{
+			std::array<int, 4> stops;
+			for (int i = 0; i < 4; ++ i)
+			{
+				stops[i] = color[i].r() * dirr + color[i].g() * dirg + color[i].b() * dirb;
+			}
+
+			// Same thresholds as the scalar path below, evaluated on 4 pixels at a time
+			__m128i const c0_point = _mm_set1_epi32((stops[1] + stops[3]) >> 1);
+			__m128i const half_point = _mm_set1_epi32((stops[3] + stops[2]) >> 1);
+			__m128i const c3_point = _mm_set1_epi32((stops[2] + stops[0]) >> 1);
+			__m128i const dir = _mm_setr_epi16(static_cast<short>(dirb), static_cast<short>(dirg), static_cast<short>(dirr), 0,
+				static_cast<short>(dirb), static_cast<short>(dirg), static_cast<short>(dirr), 0);
+
+			uint32_t low_bits = 0;
+			uint32_t high_bits = 0;
+			for (int i = 0; i < 4; ++ i)
+			{
+				__m128i const dot = DotARGB4(_mm_loadu_si128(reinterpret_cast<__m128i const *>(argb + i * 4)), dir);
+				__m128i const lt_c0 = _mm_cmplt_epi32(dot, c0_point);
+				__m128i const lt_half = _mm_cmplt_epi32(dot, half_point);
+				__m128i const lt_c3 = _mm_cmplt_epi32(dot, c3_point);
+
+				// index 1 below c0, 3 below half, 2 below c3, 0 otherwise
+				low_bits |= _mm_movemask_ps(_mm_castsi128_ps(lt_half)) << (i * 4);
+				high_bits |= _mm_movemask_ps(_mm_castsi128_ps(_mm_andnot_si128(lt_c0, lt_c3))) << (i * 4);
+			}
+
+			return SpreadBits16(low_bits) | (SpreadBits16(high_bits) << 1);
+		}
+#endif
+
 		int dots[16];
 		for (int i = 0; i < 16; ++ i)
 		{
@@ -1385,6 +1450,11 @@ namespace KlayGE
 		decoded_fmt_ = EF_ARGB8;
 	}
 
+	TexCompressionPtr TexCompressionBC2::Clone() const
+	{
+		return MakeSharedPtr<TexCompressionBC2>();
+	}
+
 	void TexCompressionBC2::EncodeBlock(void* output, void const * input, TexCompressionMethod method)
 	{
 		BOOST_ASSERT(output);
@@ -1439,6 +1509,11 @@ namespace KlayGE
 		decoded_fmt_ = EF_ARGB8;
 	}
 
+	TexCompressionPtr TexCompressionBC3::Clone() const
+	{
+		return MakeSharedPtr<TexCompressionBC3>();
+	}
+
 	void TexCompressionBC3::EncodeBlock(void* output, void const * input, TexCompressionMethod method)
 	{
 		BOOST_ASSERT(output);
@@ -1488,6 +1563,11 @@ namespace KlayGE
 		decoded_fmt_ = EF_R8;
 	}
 
+	TexCompressionPtr TexCompressionBC4::Clone() const
+	{
+		return MakeSharedPtr<TexCompressionBC4>();
+	}
+
 	// Alpha block compression (this is easy for a change)
 	void TexCompressionBC4::EncodeBlock(void* output, void const * input, TexCompressionMethod method)
 	{
@@ -1501,6 +1581,19 @@ namespace KlayGE
 
 		// find min/max color
 		int min, max;
+#if defined(KLAYGE_SSE2_SUPPORT)
+		__m128i const pixels = _mm_loadu_si128(reinterpret_cast<__m128i const *>(r));
+		__m128i min_pixels = _mm_min_epu8(pixels, _mm_srli_si128(pixels, 8));
+		__m128i max_pixels = _mm_max_epu8(pixels, _mm_srli_si128(pixels, 8));
+		min_pixels = _mm_min_epu8(min_pixels, _mm_srli_si128(min_pixels, 4));
+		max_pixels = _mm_max_epu8(max_pixels, _mm_srli_si128(max_pixels, 4));
+		min_pixels = _mm_min_epu8(min_pixels, _mm_srli_si128(min_pixels, 2));
+		max_pixels = _mm_max_epu8(max_pixels, _mm_srli_si128(max_pixels, 2));
+		min_pixels = _mm_min_epu8(min_pixels, _mm_srli_si128(min_pixels, 1));
+		max_pixels = _mm_max_epu8(max_pixels, _mm_srli_si128(max_pixels, 1));
+		min = _mm_cvtsi128_si32(min_pixels) & 0xFF;
+		max = _mm_cvtsi128_si32(max_pixels) & 0xFF;
+#else
 		min = max = r[0];
 
 		for (int i = 1; i < 16; ++ i)
@@ -1508,6 +1601,7 @@ namespace KlayGE
 			min = std::min<int>(min, r[i]);
 			max = std::max<int>(max, r[i]);
 		}
+#endif
 
 		// encode them
 		bc4.alpha_0 = static_cast<uint8_t>(max);
@@ -1520,9 +1614,47 @@ namespace KlayGE
 		int dist2 = dist * 2;
 		int bits = 0, mask = 0;
 
+#if defined(KLAYGE_SSE2_SUPPORT)
+		// The same bit magic as the scalar path, on 8 16-bit lanes at a time. Every intermediate fits in 16 bits.
+		std::array<int16_t, 16> indices;
+		{
+			__m128i const zero = _mm_setzero_si128();
+			__m128i const v_dist = _mm_set1_epi16(static_cast<short>(dist));
+			__m128i const v_dist2 = _mm_set1_epi16(static_cast<short>(dist2));
+			__m128i const v_dist4 = _mm_set1_epi16(static_cast<short>(dist4));
+			__m128i const v_bias = _mm_set1_epi16(static_cast<short>(bias));
+			__m128i const v_seven = _mm_set1_epi16(7);
+			__m128i const v_two = _mm_set1_epi16(2);
+			__m128i const v_one = _mm_set1_epi16(1);
+			__m128i const v_four = _mm_set1_epi16(4);
+			for (int half = 0; half < 2; ++ half)
+			{
+				__m128i const r16 = half ? _mm_unpackhi_epi8(pixels, zero) : _mm_unpacklo_epi8(pixels, zero);
+				__m128i a = _mm_sub_epi16(_mm_mullo_epi16(r16, v_seven), v_bias);
+
+				__m128i t = _mm_srai_epi16(_mm_sub_epi16(v_dist4, a), 15);
+				__m128i ind = _mm_and_si128(t, v_four);
+				a = _mm_sub_epi16(a, _mm_and_si128(v_dist4, t));
+				t = _mm_srai_epi16(_mm_sub_epi16(v_dist2, a), 15);
+				ind = _mm_add_epi16(ind, _mm_and_si128(t, v_two));
+				a = _mm_sub_epi16(a, _mm_and_si128(v_dist2, t));
+				t = _mm_srai_epi16(_mm_sub_epi16(v_dist, a), 15);
+				ind = _mm_add_epi16(ind, _mm_and_si128(t, v_one));
+
+				ind = _mm_and_si128(_mm_sub_epi16(zero, ind), v_seven);
+				ind = _mm_xor_si128(ind, _mm_and_si128(_mm_cmpgt_epi16(v_two, ind), v_one));
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(&indices[half * 8]), ind);
+			}
+		}
+#endif
+
 		int dest = 0;
 		for (int i = 0; i < 16; ++ i)
 		{
+#if defined(KLAYGE_SSE2_SUPPORT)
+			int const ind = indices[i];
+#else
 			int a = r[i] * 7 - bias;
 			int ind, t;
 
@@ -1533,6 +1665,7 @@ namespace KlayGE
 
 			ind = -ind & 7;
 			ind ^= (2 > ind);
+#endif
 
 			// write index
 			mask |= ind << bits;
@@ -1554,37 +1687,39 @@ namespace KlayGE
 		uint8_t* alpha_block = static_cast<uint8_t*>(output);
 		BC4Block const & bc4 = *static_cast<BC4Block const *>(input);
 
+		// Integer interpolation, rounding to nearest. A fraction of 1/7 or 1/5 never lands on .5,
+		//  so this matches the float lerp it replaces.
 		std::array<uint8_t, 8> alpha;
-		float falpha0 = bc4.alpha_0 / 255.0f;
-		float falpha1 = bc4.alpha_1 / 255.0f;
+		int const alpha0 = bc4.alpha_0;
+		int const alpha1 = bc4.alpha_1;
 		alpha[0] = bc4.alpha_0;
 		alpha[1] = bc4.alpha_1;
 		if (alpha[0] > alpha[1])
 		{
-			alpha[2] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 1 / 7.0f) * 255 + 0.5f), 0, 255));
-			alpha[3] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 2 / 7.0f) * 255 + 0.5f), 0, 255));
-			alpha[4] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 3 / 7.0f) * 255 + 0.5f), 0, 255));
-			alpha[5] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 4 / 7.0f) * 255 + 0.5f), 0, 255));
-			alpha[6] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 5 / 7.0f) * 255 + 0.5f), 0, 255));
-			alpha[7] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 6 / 7.0f) * 255 + 0.5f), 0, 255));
+			for (int i = 1; i < 7; ++ i)
+			{
+				alpha[i + 1] = static_cast<uint8_t>((alpha0 * (7 - i) + alpha1 * i + 3) / 7);
+			}
 		}
 		else
 		{
-			alpha[2] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 1 / 5.0f) * 255 + 0.5f), 0, 255));
-			alpha[3] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 2 / 5.0f) * 255 + 0.5f), 0, 255));
-			alpha[4] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 3 / 5.0f) * 255 + 0.5f), 0, 255));
-			alpha[5] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>(MathLib::lerp(falpha0, falpha1, 4 / 5.0f) * 255 + 0.5f), 0, 255));
+			for (int i = 1; i < 5; ++ i)
+			{
+				alpha[i + 1] = static_cast<uint8_t>((alpha0 * (5 - i) + alpha1 * i + 2) / 5);
+			}
 			alpha[6] = 0;
 			alpha[7] = 255;
 		}
 
-		for (int i = 0; i < 2; ++ i)
+		// 48 little-endian index bits, 3 per texel
+		uint64_t bits = 0;
+		for (int i = 5; i >= 0; -- i)
 		{
-			uint32_t alpha32 = (bc4.bitmap[i * 3 + 2] << 16) | (bc4.bitmap[i * 3 + 1] << 8) | (bc4.bitmap[i * 3 + 0] << 0);
-			for (int j = 0; j < 8; ++ j)
-			{
-				alpha_block[i * 8 + j] = alpha[(alpha32 >> (j * 3)) & 0x7];
-			}
+			bits = (bits << 8) | bc4.bitmap[i];
+		}
+		for (int i = 0; i < 16; ++ i)
+		{
+			alpha_block[i] = alpha[(bits >> (i * 3)) & 0x7];
 		}
 	}
 
@@ -1597,6 +1732,11 @@ namespace KlayGE
 		decoded_fmt_ = EF_GR8;
 	}
 
+	TexCompressionPtr TexCompressionBC5::Clone() const
+	{
+		return MakeSharedPtr<TexCompressionBC5>();
+	}
+
 	void TexCompressionBC5::EncodeBlock(void* output, void const * input, TexCompressionMethod method)
 	{
 		BOOST_ASSERT(output);
@@ -1900,6 +2040,11 @@ namespace KlayGE
 		decoded_fmt_ = EF_ABGR16F;
 	}
 
+	TexCompressionPtr TexCompressionBC6U::Clone() const
+	{
+		return MakeSharedPtr<TexCompressionBC6U>();
+	}
+
 	void TexCompressionBC6U::EncodeBlock(void* output, void const * input, TexCompressionMethod method)
 	{
 		KFL_UNUSED(output);
@@ -2154,6 +2299,11 @@ namespace KlayGE
 		decoded_fmt_ = EF_ABGR16F;
 	}
 
+	TexCompressionPtr TexCompressionBC6S::Clone() const
+	{
+		return MakeSharedPtr<TexCompressionBC6S>();
+	}
+
 	void TexCompressionBC6S::EncodeBlock(void* output, void const * input, TexCompressionMethod method)
 	{
 		KFL_UNUSED(output);
@@ -2199,6 +2349,11 @@ namespace KlayGE
 		decoded_fmt_ = EF_ARGB8;
 	}
 
+	TexCompressionPtr TexCompressionBC7::Clone() const
+	{
+		return MakeSharedPtr<TexCompressionBC7>();
+	}
+
 	void TexCompressionBC7::EncodeBlock(void* output, void const * input, TexCompressionMethod method)
 	{
 		BOOST_ASSERT(output);
@@ -2223,6 +2378,8 @@ namespace KlayGE
 			return;
 		}
 
+		gen_.seed();
+
 		TexCompressionErrorMetric metric = TCEM_Uniform;
 		int sa_steps;
 		switch (method)
@@ -2907,7 +3064,7 @@ namespace KlayGE
 		{
 			float4 const & p = pt ? p1 : p2;
 			float4& np = pt ? np1 : np2;
-			uint32_t const rdir = rand() & 0xF;
+			uint32_t const rdir = gen_() & 0xF;
 
 			np = p;
 			if (has_pbits)
@@ -2939,8 +3096,8 @@ namespace KlayGE
 			return true;
 		}
 
-		size_t const p = static_cast<size_t>(exp(0.1f * static_cast<int64_t>(old_err - new_err) / temp) * RAND_MAX);
-		size_t const r = rand();
+		size_t const p = static_cast<size_t>(exp(0.1f * static_cast<int64_t>(old_err - new_err) / temp) * gen_.max());
+		size_t const r = gen_();
 
 		return r < p;
 	}
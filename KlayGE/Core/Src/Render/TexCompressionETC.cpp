@@ -36,6 +36,8 @@
 #include <KlayGE/Texture.hpp>
 #include <KFL/Thread.hpp>
 
+#include <algorithm>
+#include <limits>
 #include <vector>
 #include <cstring>
 #include <boost/assert.hpp>
@@ -49,6 +51,139 @@ namespace
 
 	static uint8_t const selector_index_to_etc1[] = { 3, 2, 0, 1 };
 
+	// Modifier tables shared by EAC alpha and R11/RG11 blocks
+	static int8_t const eac_modifier_table[16][8] =
+	{
+		{ -3, -6, -9, -15, 2, 5, 8, 14 },
+		{ -3, -7, -10, -13, 2, 6, 9, 12 },
+		{ -2, -5, -8, -13, 1, 4, 7, 12 },
+		{ -2, -4, -6, -13, 1, 3, 5, 12 },
+		{ -3, -6, -8, -12, 2, 5, 7, 11 },
+		{ -3, -7, -9, -11, 2, 6, 8, 10 },
+		{ -4, -7, -8, -11, 3, 6, 7, 10 },
+		{ -3, -5, -8, -11, 2, 4, 7, 10 },
+		{ -2, -6, -8, -10, 1, 5, 7, 9 },
+		{ -2, -5, -8, -10, 1, 4, 7, 9 },
+		{ -2, -4, -8, -10, 1, 3, 7, 9 },
+		{ -2, -5, -7, -10, 1, 4, 6, 9 },
+		{ -3, -4, -7, -10, 2, 3, 6, 9 },
+		{ -1, -2, -3, -10, 0, 1, 2, 9 },
+		{ -4, -6, -8, -9, 3, 5, 7, 8 },
+		{ -3, -5, -7, -9, 2, 4, 6, 8 }
+	};
+
+	// The 48 index bits of an EAC block are stored big-endian, 3 bits per texel, texels in column-major order
+	uint64_t EACIndexBits(EACBlock const & eac)
+	{
+		uint64_t bits = 0;
+		for (int i = 0; i < 6; ++ i)
+		{
+			bits = (bits << 8) | eac.indices[i];
+		}
+		return bits;
+	}
+
+	int DecodeEACAlphaValue(int base, int multiplier, int modifier)
+	{
+		return MathLib::clamp(base + modifier * multiplier, 0, 255);
+	}
+
+	int DecodeEACR11Value(int base, int multiplier, int modifier)
+	{
+		return MathLib::clamp(base * 8 + 4 + ((0 == multiplier) ? modifier : modifier * multiplier * 8), 0, 2047);
+	}
+
+	// Finds the table, multiplier and base that reproduce the 16 row-major values best. decode gives the value of a
+	//  modifier as the decoder sees it, value_scale is how much one step of the base moves it.
+	template <typename DecodeFunc>
+	void EncodeEACBlockInternal(EACBlock& eac, int const * values, int value_scale, DecodeFunc decode)
+	{
+		int const min_value = *std::min_element(values, values + 16);
+		int const max_value = *std::max_element(values, values + 16);
+
+		int best_err = std::numeric_limits<int>::max();
+		int best_base = 0;
+		int best_multiplier = 1;
+		int best_table = 0;
+		for (int table = 0; (table < 16) && (best_err > 0); ++ table)
+		{
+			// The smallest and largest modifiers of every table are at 3 and 7
+			int8_t const * modifiers = eac_modifier_table[table];
+			int const mod_min = modifiers[3];
+			int const mod_max = modifiers[7];
+
+			int const multiplier_guess = (max_value - min_value + (mod_max - mod_min) * value_scale / 2)
+				/ ((mod_max - mod_min) * value_scale);
+			for (int multiplier = std::max(multiplier_guess - 1, 1); multiplier <= std::min(multiplier_guess + 1, 15); ++ multiplier)
+			{
+				// The base that centers the modifiers on the range of the values
+				float const center = ((min_value + max_value) * 0.5f - (mod_min + mod_max) * multiplier * value_scale * 0.5f
+					- decode(0, multiplier, 0)) / value_scale;
+				int const base_guess = static_cast<int>(std::floor(center + 0.5f));
+				for (int base = std::max(base_guess - 1, 0); base <= std::min(base_guess + 1, 255); ++ base)
+				{
+					int err = 0;
+					for (int i = 0; (i < 16) && (err < best_err); ++ i)
+					{
+						int texel_err = std::numeric_limits<int>::max();
+						for (int m = 0; m < 8; ++ m)
+						{
+							int const diff = values[i] - decode(base, multiplier, modifiers[m]);
+							texel_err = std::min(texel_err, diff * diff);
+						}
+						err += texel_err;
+					}
+
+					if (err < best_err)
+					{
+						best_err = err;
+						best_base = base;
+						best_multiplier = multiplier;
+						best_table = table;
+					}
+				}
+			}
+		}
+
+		int8_t const * modifiers = eac_modifier_table[best_table];
+		uint64_t bits = 0;
+		for (int i = 0; i < 16; ++ i)
+		{
+			// Texels are stored in column-major order
+			int const value = values[(i & 3) * 4 + i / 4];
+
+			int best_index = 0;
+			int best_texel_err = std::numeric_limits<int>::max();
+			for (int m = 0; m < 8; ++ m)
+			{
+				int const diff = value - decode(best_base, best_multiplier, modifiers[m]);
+				if (diff * diff < best_texel_err)
+				{
+					best_texel_err = diff * diff;
+					best_index = m;
+				}
+			}
+			bits = (bits << 3) | best_index;
+		}
+
+		eac.base = static_cast<uint8_t>(best_base);
+		eac.multiplier_table = static_cast<uint8_t>((best_multiplier << 4) | best_table);
+		for (int i = 0; i < 6; ++ i)
+		{
+			eac.indices[i] = static_cast<uint8_t>(bits >> (40 - i * 8));
+		}
+	}
+
+	void EncodeEACR11Block(EACBlock& eac, uint8_t const * r, uint32_t stride)
+	{
+		std::array<int, 16> r11;
+		for (size_t i = 0; i < r11.size(); ++ i)
+		{
+			r11[i] = (r[i * stride] * 2047 + 127) / 255;
+		}
+		EncodeEACBlockInternal(eac, &r11[0], 8, DecodeEACR11Value);
+	}
+
 	// color8_to_etc_block_config_0_255[color][table_index] = Supplies for each 8-bit color value a list of packed ETC1 diff/intensity table/selectors/packed_colors that map to that color.
 	// To pack: diff | (inten << 1) | (selector << 4) | (packed_c << 8)
 	static uint16_t const color8_to_etc_block_config_0_255[2][33] =
@@ -654,6 +789,11 @@ namespace KlayGE
 		sorted_luma_indices_ = nullptr;
 	}
 
+	TexCompressionPtr TexCompressionETC1::Clone() const
+	{
+		return MakeSharedPtr<TexCompressionETC1>();
+	}
+
 	void TexCompressionETC1::EncodeBlock(void* output, void const * input, TexCompressionMethod method)
 	{
 		BOOST_ASSERT(output);
@@ -1829,6 +1969,11 @@ namespace KlayGE
 		etc1_codec_ = MakeSharedPtr<TexCompressionETC1>();
 	}
 
+	TexCompressionPtr TexCompressionETC2RGB8::Clone() const
+	{
+		return MakeSharedPtr<TexCompressionETC2RGB8>();
+	}
+
 	void TexCompressionETC2RGB8::EncodeBlock(void* output, void const * input, TexCompressionMethod method)
 	{
 		KFL_UNUSED(output);
@@ -2053,6 +2198,11 @@ namespace KlayGE
 		etc2_rgb8_codec_ = MakeSharedPtr<TexCompressionETC2RGB8>();
 	}
 
+	TexCompressionPtr TexCompressionETC2RGB8A1::Clone() const
+	{
+		return MakeSharedPtr<TexCompressionETC2RGB8A1>();
+	}
+
 	void TexCompressionETC2RGB8A1::EncodeBlock(void* output, void const * input, TexCompressionMethod method)
 	{
 		KFL_UNUSED(output);
@@ -2095,4 +2245,175 @@ namespace KlayGE
 			etc1_codec_->DecodeETCDifferentialModeInternal(argb, etc2.etc1, !op);
 		}
 	}
+
+
+	TexCompressionETC2RGBA8::TexCompressionETC2RGBA8()
+	{
+		block_width_ = block_height_ = 4;
+		block_depth_ = 1;
+		block_bytes_ = NumFormatBytes(EF_ETC2_ABGR8) * 4;
+		decoded_fmt_ = EF_ARGB8;
+
+		etc1_codec_ = MakeSharedPtr<TexCompressionETC1>();
+		etc2_rgb8_codec_ = MakeSharedPtr<TexCompressionETC2RGB8>();
+	}
+
+	TexCompressionPtr TexCompressionETC2RGBA8::Clone() const
+	{
+		return MakeSharedPtr<TexCompressionETC2RGBA8>();
+	}
+
+	void TexCompressionETC2RGBA8::EncodeBlock(void* output, void const * input, TexCompressionMethod method)
+	{
+		BOOST_ASSERT(output);
+		BOOST_ASSERT(input);
+
+		ETC2RGBA8Block& etc2 = *static_cast<ETC2RGBA8Block*>(output);
+		ARGBColor32 const * argb = static_cast<ARGBColor32 const *>(input);
+
+		// An ETC1 block is a valid ETC2 RGB block
+		etc1_codec_->EncodeBlock(&etc2.rgb, argb, method);
+
+		std::array<int, 16> alpha;
+		for (size_t i = 0; i < alpha.size(); ++ i)
+		{
+			alpha[i] = argb[i].a();
+		}
+		EncodeEACBlockInternal(etc2.alpha, &alpha[0], 1, DecodeEACAlphaValue);
+	}
+
+	void TexCompressionETC2RGBA8::DecodeBlock(void* output, void const * input)
+	{
+		BOOST_ASSERT(output);
+		BOOST_ASSERT(input);
+
+		ARGBColor32* argb = static_cast<ARGBColor32*>(output);
+		ETC2RGBA8Block const & etc2 = *static_cast<ETC2RGBA8Block const *>(input);
+
+		etc2_rgb8_codec_->DecodeBlock(argb, &etc2.rgb);
+		TexCompressionETC2R11::DecodeEACAlphaInternal(&argb[0][ARGBColor32::AChannel], sizeof(ARGBColor32), etc2.alpha);
+	}
+
+
+	TexCompressionETC2R11::TexCompressionETC2R11()
+	{
+		block_width_ = block_height_ = 4;
+		block_depth_ = 1;
+		block_bytes_ = NumFormatBytes(EF_ETC2_R11) * 4;
+		decoded_fmt_ = EF_R8;
+	}
+
+	TexCompressionPtr TexCompressionETC2R11::Clone() const
+	{
+		return MakeSharedPtr<TexCompressionETC2R11>();
+	}
+
+	void TexCompressionETC2R11::EncodeBlock(void* output, void const * input, TexCompressionMethod method)
+	{
+		BOOST_ASSERT(output);
+		BOOST_ASSERT(input);
+
+		KFL_UNUSED(method);
+
+		EncodeEACR11Block(*static_cast<EACBlock*>(output), static_cast<uint8_t const *>(input), 1);
+	}
+
+	void TexCompressionETC2R11::DecodeBlock(void* output, void const * input)
+	{
+		BOOST_ASSERT(output);
+		BOOST_ASSERT(input);
+
+		uint8_t* r = static_cast<uint8_t*>(output);
+		EACBlock const & eac = *static_cast<EACBlock const *>(input);
+
+		std::array<uint16_t, 16> r11;
+		DecodeEACR11Internal(&r11[0], 1, eac);
+		for (size_t i = 0; i < r11.size(); ++ i)
+		{
+			r[i] = static_cast<uint8_t>((r11[i] * 255 + 1023) / 2047);
+		}
+	}
+
+	void TexCompressionETC2R11::DecodeEACR11Internal(uint16_t* r11, uint32_t stride, EACBlock const & eac)
+	{
+		int const base = eac.base * 8 + 4;
+		int const multiplier = eac.multiplier_table >> 4;
+		int8_t const * modifiers = eac_modifier_table[eac.multiplier_table & 0xF];
+
+		uint64_t const bits = EACIndexBits(eac);
+		for (uint32_t i = 0; i < 16; ++ i)
+		{
+			int const modifier = modifiers[(bits >> (45 - i * 3)) & 0x7];
+			int const value = base + ((0 == multiplier) ? modifier : modifier * multiplier * 8);
+
+			uint32_t const x = i / 4;
+			uint32_t const y = i & 3;
+			r11[(y * 4 + x) * stride] = static_cast<uint16_t>(MathLib::clamp(value, 0, 2047));
+		}
+	}
+
+	void TexCompressionETC2R11::DecodeEACAlphaInternal(uint8_t* alpha, uint32_t stride, EACBlock const & eac)
+	{
+		int const base = eac.base;
+		int const multiplier = eac.multiplier_table >> 4;
+		int8_t const * modifiers = eac_modifier_table[eac.multiplier_table & 0xF];
+
+		uint64_t const bits = EACIndexBits(eac);
+		for (uint32_t i = 0; i < 16; ++ i)
+		{
+			int const value = base + modifiers[(bits >> (45 - i * 3)) & 0x7] * multiplier;
+
+			uint32_t const x = i / 4;
+			uint32_t const y = i & 3;
+			alpha[(y * 4 + x) * stride] = static_cast<uint8_t>(MathLib::clamp(value, 0, 255));
+		}
+	}
+
+
+	TexCompressionETC2RG11::TexCompressionETC2RG11()
+	{
+		block_width_ = block_height_ = 4;
+		block_depth_ = 1;
+		block_bytes_ = NumFormatBytes(EF_ETC2_GR11) * 4;
+		decoded_fmt_ = EF_GR8;
+	}
+
+	TexCompressionPtr TexCompressionETC2RG11::Clone() const
+	{
+		return MakeSharedPtr<TexCompressionETC2RG11>();
+	}
+
+	void TexCompressionETC2RG11::EncodeBlock(void* output, void const * input, TexCompressionMethod method)
+	{
+		BOOST_ASSERT(output);
+		BOOST_ASSERT(input);
+
+		KFL_UNUSED(method);
+
+		EACBlock* eac = static_cast<EACBlock*>(output);
+		uint8_t const * gr = static_cast<uint8_t const *>(input);
+
+		// EF_GR8 texels have red in the low byte
+		EncodeEACR11Block(eac[0], gr + 0, 2);
+		EncodeEACR11Block(eac[1], gr + 1, 2);
+	}
+
+	void TexCompressionETC2RG11::DecodeBlock(void* output, void const * input)
+	{
+		BOOST_ASSERT(output);
+		BOOST_ASSERT(input);
+
+		uint16_t* gr = static_cast<uint16_t*>(output);
+		EACBlock const * eac = static_cast<EACBlock const *>(input);
+
+		std::array<uint16_t, 32> rg11;
+		TexCompressionETC2R11::DecodeEACR11Internal(&rg11[0], 2, eac[0]);
+		TexCompressionETC2R11::DecodeEACR11Internal(&rg11[1], 2, eac[1]);
+		for (size_t i = 0; i < 16; ++ i)
+		{
+			uint32_t const r = (rg11[i * 2 + 0] * 255 + 1023) / 2047;
+			uint32_t const g = (rg11[i * 2 + 1] * 255 + 1023) / 2047;
+			gr[i] = static_cast<uint16_t>(r | (g << 8));
+		}
+	}
 }
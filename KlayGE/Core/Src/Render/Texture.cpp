@@ -40,6 +40,7 @@
 #include <KlayGE/TexCompressionETC.hpp>
 #include <KFL/Half.hpp>
 #include <KFL/Hash.hpp>
+#include <KFL/Thread.hpp>
 
 #include <cstring>
 #include <fstream>
@@ -912,12 +913,11 @@ namespace
 		}
 	}
 	
-	void DecodeTexture(std::vector<uint8_t>& dst_data_block, uint32_t& dst_row_pitch, uint32_t& dst_slice_pitch, ElementFormat& dst_format,
-		void const * src_data, uint32_t src_row_pitch, uint32_t src_slice_pitch, ElementFormat src_format,
-		uint32_t src_width, uint32_t src_height, uint32_t src_depth)
+	ElementFormat DecodedFormat(ElementFormat src_format)
 	{
 		BOOST_ASSERT(IsCompressedFormat(src_format));
 
+		ElementFormat dst_format;
 		switch (src_format)
 		{				
 		case EF_BC1:
@@ -977,6 +977,16 @@ namespace
 			KFL_UNREACHABLE("Invalid destination format");
 		}
 
+		return dst_format;
+	}
+
+	// Decodes straight into the destination, which must be in DecodedFormat(src_format) and of the same size
+	void DecodeTexture(void* dst_data, uint32_t dst_row_pitch, uint32_t dst_slice_pitch,
+		void const * src_data, uint32_t src_row_pitch, uint32_t src_slice_pitch, ElementFormat src_format,
+		uint32_t src_width, uint32_t src_height, uint32_t src_depth)
+	{
+		BOOST_ASSERT(IsCompressedFormat(src_format));
+
 		std::unique_ptr<TexCompression> codec;
 		switch (src_format)
 		{
@@ -1039,17 +1049,18 @@ namespace
 
 		case EF_ETC2_ABGR8:
 		case EF_ETC2_ABGR8_SRGB:
-			// TODO
-			KFL_UNREACHABLE("Not implemented");
+			codec = MakeUniquePtr<TexCompressionETC2RGBA8>();
 			break;
 
 		case EF_ETC2_R11:
-		case EF_SIGNED_ETC2_R11:
-			// TODO
-			KFL_UNREACHABLE("Not implemented");
+			codec = MakeUniquePtr<TexCompressionETC2R11>();
 			break;
 
 		case EF_ETC2_GR11:
+			codec = MakeUniquePtr<TexCompressionETC2RG11>();
+			break;
+
+		case EF_SIGNED_ETC2_R11:
 		case EF_SIGNED_ETC2_GR11:
 			// TODO
 			KFL_UNREACHABLE("Not implemented");
@@ -1059,12 +1070,8 @@ namespace
 			KFL_UNREACHABLE("Invalid source format");
 		}
 
-		dst_row_pitch = src_width * NumFormatBytes(dst_format);
-		dst_slice_pitch = dst_row_pitch * src_height;
-		dst_data_block.resize(src_depth * dst_slice_pitch);
-
 		uint8_t const * src = static_cast<uint8_t const *>(src_data);
-		uint8_t* dst = static_cast<uint8_t*>(&dst_data_block[0]);
+		uint8_t* dst = static_cast<uint8_t*>(dst_data);
 		for (uint32_t z = 0; z < src_depth; ++ z)
 		{
 			codec->DecodeMem(src_width, src_height, dst, dst_row_pitch, dst_slice_pitch,
@@ -1075,6 +1082,19 @@ namespace
 		}
 	}
 
+	void DecodeTexture(std::vector<uint8_t>& dst_data_block, uint32_t& dst_row_pitch, uint32_t& dst_slice_pitch, ElementFormat& dst_format,
+		void const * src_data, uint32_t src_row_pitch, uint32_t src_slice_pitch, ElementFormat src_format,
+		uint32_t src_width, uint32_t src_height, uint32_t src_depth)
+	{
+		dst_format = DecodedFormat(src_format);
+
+		dst_row_pitch = src_width * NumFormatBytes(dst_format);
+		dst_slice_pitch = dst_row_pitch * src_height;
+		dst_data_block.resize(src_depth * dst_slice_pitch);
+
+		DecodeTexture(&dst_data_block[0], dst_row_pitch, dst_slice_pitch,
+			src_data, src_row_pitch, src_slice_pitch, src_format, src_width, src_height, src_depth);
+	}
 
 	class TextureLoadingDesc : public ResLoadingDesc
 	{
@@ -1198,6 +1218,8 @@ namespace
 				{ EF_ETC2_A1BGR8_SRGB, EF_ARGB8_SRGB },
 				{ EF_ETC2_ABGR8, EF_ARGB8 },
 				{ EF_ETC2_ABGR8_SRGB, EF_ARGB8_SRGB },
+				{ EF_ETC2_R11, EF_R8 },
+				{ EF_ETC2_GR11, EF_GR8 },
 				{ EF_R8, EF_ARGB8 },
 				{ EF_SIGNED_R8, EF_SIGNED_ABGR8 },
 				{ EF_GR8, EF_ARGB8 },
@@ -1256,6 +1278,15 @@ namespace
 			return true;
 		}
 
+		size_t Key() const override
+		{
+			size_t seed = 0;
+			HashCombine(seed, this->Type());
+			HashRange(seed, tex_desc_.res_name.begin(), tex_desc_.res_name.end());
+			HashCombine(seed, tex_desc_.access_hint);
+			return seed;
+		}
+
 		bool Match(ResLoadingDesc const & rhs) const override
 		{
 			if (this->Type() == rhs.Type())
@@ -1315,19 +1346,28 @@ namespace
 				array_size *= 6;
 			}
 
+			// Format fallbacks run over blocks and sub-resources on the task scheduler
+			task_scheduler& ts = Context::Instance().TaskScheduler();
+			size_t const BLOCKS_PER_TASK = 4096;
+
 			if (((EF_BC5 == tex_data.format) && !caps.texture_format_support(EF_BC5))
 				|| ((EF_BC5_SRGB == tex_data.format) && !caps.texture_format_support(EF_BC5_SRGB)))
 			{
-				BC1Block tmp;
 				for (size_t i = 0; i < tex_data.init_data.size(); ++ i)
 				{
-					for (size_t j = 0; j < tex_data.init_data[i].slice_pitch; j += sizeof(BC4Block) * 2)
-					{
-						char* p = static_cast<char*>(const_cast<void*>(tex_data.init_data[i].data)) + j;
+					char* sub_data = static_cast<char*>(const_cast<void*>(tex_data.init_data[i].data));
+					ts.parallel_for(0, tex_data.init_data[i].slice_pitch / (sizeof(BC4Block) * 2), BLOCKS_PER_TASK,
+						[sub_data](size_t block_begin, size_t block_end)
+						{
+							BC1Block tmp;
+							for (size_t j = block_begin; j < block_end; ++ j)
+							{
+								char* p = sub_data + j * sizeof(BC4Block) * 2;
 
-						BC4ToBC1G(tmp, *reinterpret_cast<BC4Block const *>(p + sizeof(BC4Block)));
-						std::memcpy(p + sizeof(BC4Block), &tmp, sizeof(BC1Block));
-					}
+								BC4ToBC1G(tmp, *reinterpret_cast<BC4Block const *>(p + sizeof(BC4Block)));
+								std::memcpy(p + sizeof(BC4Block), &tmp, sizeof(BC1Block));
+							}
+						});
 				}
 
 				if (IsSRGB(tex_data.format))
@@ -1342,16 +1382,21 @@ namespace
 			if (((EF_BC4 == tex_data.format) && !caps.texture_format_support(EF_BC4))
 				|| ((EF_BC4_SRGB == tex_data.format) && !caps.texture_format_support(EF_BC4_SRGB)))
 			{
-				BC1Block tmp;
 				for (size_t i = 0; i < tex_data.init_data.size(); ++ i)
 				{
-					for (size_t j = 0; j < tex_data.init_data[i].slice_pitch; j += sizeof(BC4Block))
-					{
-						char* p = static_cast<char*>(const_cast<void*>(tex_data.init_data[i].data)) + j;
+					char* sub_data = static_cast<char*>(const_cast<void*>(tex_data.init_data[i].data));
+					ts.parallel_for(0, tex_data.init_data[i].slice_pitch / sizeof(BC4Block), BLOCKS_PER_TASK,
+						[sub_data](size_t block_begin, size_t block_end)
+						{
+							BC1Block tmp;
+							for (size_t j = block_begin; j < block_end; ++ j)
+							{
+								char* p = sub_data + j * sizeof(BC4Block);
 
-						BC4ToBC1G(tmp, *reinterpret_cast<BC4Block const *>(p));
-						std::memcpy(p, &tmp, sizeof(BC1Block));
-					}
+								BC4ToBC1G(tmp, *reinterpret_cast<BC4Block const *>(p));
+								std::memcpy(p, &tmp, sizeof(BC1Block));
+							}
+						});
 				}
 
 				if (IsSRGB(tex_data.format))
@@ -1389,6 +1434,8 @@ namespace
 				{ EF_ETC2_A1BGR8_SRGB, EF_ARGB8_SRGB },
 				{ EF_ETC2_ABGR8, EF_ARGB8 },
 				{ EF_ETC2_ABGR8_SRGB, EF_ARGB8_SRGB },
+				{ EF_ETC2_R11, EF_R8 },
+				{ EF_ETC2_GR11, EF_GR8 },
 				{ EF_R8, EF_ARGB8 },
 				{ EF_SIGNED_R8, EF_SIGNED_ABGR8 },
 				{ EF_GR8, EF_ARGB8 },
@@ -1446,52 +1493,54 @@ namespace
 							new_data_block.resize(new_data_block_size);
 						}
 
-						for (size_t index = 0; index < array_size; ++ index)
-						{
-							uint32_t width = tex_data.width;
-							uint32_t height = tex_data.height;
-							uint32_t depth = tex_data.depth;
-							for (size_t level = 0; level < tex_data.num_mipmaps; ++ level)
+						// Every mip of every array slice converts independently
+						ElementFormat const src_fmt = convert_fmts[i][0];
+						ElementFormat const dst_fmt = convert_fmts[i][1];
+						ts.parallel_for(0, array_size * tex_data.num_mipmaps, 1,
+							[&tex_data, &new_data_block, &new_sub_res_start, needs_new_data_block, src_fmt, dst_fmt, dst_elem_size](
+								size_t sub_res_begin, size_t sub_res_end)
 							{
-								uint32_t row_pitch, slice_pitch;
-								if (IsCompressedFormat(convert_fmts[i][1]))
-								{
-									row_pitch = ((width + 3) & ~3) * dst_elem_size;
-									slice_pitch = (height + 3) / 4 * row_pitch;
-								}
-								else
+								for (size_t sub_res = sub_res_begin; sub_res < sub_res_end; ++ sub_res)
 								{
-									row_pitch = width * dst_elem_size;
-									slice_pitch = height * row_pitch;
-								}
+									uint32_t const level = static_cast<uint32_t>(sub_res % tex_data.num_mipmaps);
+									uint32_t const width = std::max<uint32_t>(1U, tex_data.width >> level);
+									uint32_t const height = std::max<uint32_t>(1U, tex_data.height >> level);
+									uint32_t const depth = std::max<uint32_t>(1U, tex_data.depth >> level);
 
-								size_t sub_res = index * tex_data.num_mipmaps + level;
-								uint8_t* sub_data_block;
-								if (needs_new_data_block)
-								{
-									sub_data_block = &new_data_block[new_sub_res_start[sub_res]];
-								}
-								else
-								{
-									sub_data_block = static_cast<uint8_t*>(
-										const_cast<void*>(tex_data.init_data[sub_res].data));
+									uint32_t row_pitch, slice_pitch;
+									if (IsCompressedFormat(dst_fmt))
+									{
+										row_pitch = ((width + 3) & ~3) * dst_elem_size;
+										slice_pitch = (height + 3) / 4 * row_pitch;
+									}
+									else
+									{
+										row_pitch = width * dst_elem_size;
+										slice_pitch = height * row_pitch;
+									}
+
+									uint8_t* sub_data_block;
+									if (needs_new_data_block)
+									{
+										sub_data_block = &new_data_block[new_sub_res_start[sub_res]];
+									}
+									else
+									{
+										sub_data_block = static_cast<uint8_t*>(
+											const_cast<void*>(tex_data.init_data[sub_res].data));
+									}
+									ResizeTexture(sub_data_block, row_pitch, slice_pitch,
+										dst_fmt, width, height, depth,
+										tex_data.init_data[sub_res].data,
+										tex_data.init_data[sub_res].row_pitch,
+										tex_data.init_data[sub_res].slice_pitch,
+										src_fmt, width, height, depth, false);
+
+									tex_data.init_data[sub_res].row_pitch = row_pitch;
+									tex_data.init_data[sub_res].slice_pitch = slice_pitch;
+									tex_data.init_data[sub_res].data = sub_data_block;
 								}
-								ResizeTexture(sub_data_block, row_pitch, slice_pitch,
-									convert_fmts[i][1], width, height, depth,
-									tex_data.init_data[sub_res].data,
-									tex_data.init_data[sub_res].row_pitch,
-									tex_data.init_data[sub_res].slice_pitch,
-									convert_fmts[i][0], width, height, depth, false);
-
-								width = std::max<uint32_t>(1U, width / 2);
-								height = std::max<uint32_t>(1U, height / 2);
-								depth = std::max<uint32_t>(1U, depth / 2);
-
-								tex_data.init_data[sub_res].row_pitch = row_pitch;
-								tex_data.init_data[sub_res].slice_pitch = slice_pitch;
-								tex_data.init_data[sub_res].data = sub_data_block;
-							}
-						}
+							});
 
 						if (needs_new_data_block)
 						{
@@ -2014,6 +2063,7 @@ namespace KlayGE
 		}
 
 		std::vector<size_t> base;
+		size_t data_size = data_block.size();
 		switch (type)
 		{
 		case Texture::TT_1D:
@@ -2037,14 +2087,11 @@ namespace KlayGE
 							image_size = (padding ? ((the_width + 3) & ~3) : the_width) * fmt_size;
 						}
 
-						base[index] = data_block.size();
-						data_block.resize(base[index] + image_size);
+						base[index] = data_size;
+						data_size = base[index] + image_size;
 						init_data[index].row_pitch = image_size;
 						init_data[index].slice_pitch = image_size;
 
-						tex_res->read(&data_block[base[index]], static_cast<std::streamsize>(image_size));
-						BOOST_ASSERT(tex_res->gcount() == static_cast<int>(image_size));
-
 						the_width = std::max<uint32_t>(the_width / 2, 1);
 					}
 				}
@@ -2067,23 +2114,17 @@ namespace KlayGE
 							uint32_t const block_size = NumFormatBytes(format) * 4;
 							uint32_t image_size = ((the_width + 3) / 4) * ((the_height + 3) / 4) * block_size;
 
-							base[index] = data_block.size();
-							data_block.resize(base[index] + image_size);
+							base[index] = data_size;
+							data_size = base[index] + image_size;
 							init_data[index].row_pitch = (the_width + 3) / 4 * block_size;
 							init_data[index].slice_pitch = image_size;
-
-							tex_res->read(&data_block[base[index]], static_cast<std::streamsize>(image_size));
-							BOOST_ASSERT(tex_res->gcount() == static_cast<int>(image_size));
 						}
 						else
 						{
 							init_data[index].row_pitch = (padding ? ((the_width + 3) & ~3) : the_width) * fmt_size;
 							init_data[index].slice_pitch = init_data[index].row_pitch * the_height;
-							base[index] = data_block.size();
-							data_block.resize(base[index] + init_data[index].slice_pitch);
-
-							tex_res->read(&data_block[base[index]], static_cast<std::streamsize>(init_data[index].slice_pitch));
-							BOOST_ASSERT(tex_res->gcount() == static_cast<int>(init_data[index].slice_pitch));
+							base[index] = data_size;
+							data_size = base[index] + init_data[index].slice_pitch;
 						}
 
 						the_width = std::max<uint32_t>(the_width / 2, 1);
@@ -2110,23 +2151,17 @@ namespace KlayGE
 							uint32_t const block_size = NumFormatBytes(format) * 4;
 							uint32_t image_size = ((the_width + 3) / 4) * ((the_height + 3) / 4) * the_depth * block_size;
 
-							base[index] = data_block.size();
-							data_block.resize(base[index] + image_size);
+							base[index] = data_size;
+							data_size = base[index] + image_size;
 							init_data[index].row_pitch = (the_width + 3) / 4 * block_size;
 							init_data[index].slice_pitch = ((the_width + 3) / 4) * ((the_height + 3) / 4) * block_size;
-
-							tex_res->read(&data_block[base[index]], static_cast<std::streamsize>(image_size));
-							BOOST_ASSERT(tex_res->gcount() == static_cast<int>(image_size));
 						}
 						else
 						{
 							init_data[index].row_pitch = (padding ? ((the_width + 3) & ~3) : the_width) * fmt_size;
 							init_data[index].slice_pitch = init_data[index].row_pitch * the_height;
-							base[index] = data_block.size();
-							data_block.resize(base[index] + init_data[index].slice_pitch * the_depth);
-
-							tex_res->read(&data_block[base[index]], static_cast<std::streamsize>(init_data[index].slice_pitch * the_depth));
-							BOOST_ASSERT(tex_res->gcount() == static_cast<int>(init_data[index].slice_pitch * the_depth));
+							base[index] = data_size;
+							data_size = base[index] + init_data[index].slice_pitch * the_depth;
 						}
 
 						the_width = std::max<uint32_t>(the_width / 2, 1);
@@ -2155,23 +2190,17 @@ namespace KlayGE
 								uint32_t const block_size = NumFormatBytes(format) * 4;
 								uint32_t image_size = ((the_width + 3) / 4) * ((the_height + 3) / 4) * block_size;
 
-								base[index] = data_block.size();
-								data_block.resize(base[index] + image_size);
+								base[index] = data_size;
+								data_size = base[index] + image_size;
 								init_data[index].row_pitch = (the_width + 3) / 4 * block_size;
 								init_data[index].slice_pitch = image_size;
-
-								tex_res->read(&data_block[base[index]], static_cast<std::streamsize>(image_size));
-								BOOST_ASSERT(tex_res->gcount() == static_cast<int>(image_size));
 							}
 							else
 							{
 								init_data[index].row_pitch = (padding ? ((the_width + 3) & ~3) : the_width) * fmt_size;
 								init_data[index].slice_pitch = init_data[index].row_pitch * the_width;
-								base[index] = data_block.size();
-								data_block.resize(base[index] + init_data[index].slice_pitch);
-
-								tex_res->read(&data_block[base[index]], static_cast<std::streamsize>(init_data[index].slice_pitch));
-								BOOST_ASSERT(tex_res->gcount() == static_cast<int>(init_data[index].slice_pitch));
+								base[index] = data_size;
+								data_size = base[index] + init_data[index].slice_pitch;
 							}
 
 							the_width = std::max<uint32_t>(the_width / 2, 1);
@@ -2183,6 +2212,24 @@ namespace KlayGE
 			break;
 		}
 
+		// All subresources are contiguous in the file, so they are read in one go into a buffer allocated once. A mapped
+		//  file is copied straight out of the mapping instead of going through the stream.
+		size_t const payload_offset = data_block.size();
+		size_t const payload_size = data_size - payload_offset;
+		data_block.resize(data_size);
+		ArrayRef<uint8_t> const mapped_data = tex_res->MappedData();
+		uint64_t const payload_pos = static_cast<uint64_t>(tex_res->tellg());
+		if (!mapped_data.empty() && (payload_pos <= mapped_data.size()) && (payload_size <= mapped_data.size() - payload_pos))
+		{
+			std::memcpy(&data_block[payload_offset], mapped_data.data() + payload_pos, payload_size);
+			tex_res->seekg(static_cast<int64_t>(payload_size), std::ios_base::cur);
+		}
+		else
+		{
+			tex_res->read(&data_block[payload_offset], static_cast<std::streamsize>(payload_size));
+			BOOST_ASSERT(tex_res->gcount() == static_cast<int64_t>(payload_size));
+		}
+
 		for (size_t i = 0; i < base.size(); ++ i)
 		{
 			init_data[i].data = &data_block[base[i]];
@@ -3324,6 +3371,16 @@ namespace KlayGE
 		uint32_t src_width, uint32_t src_height, uint32_t src_depth,
 		bool linear)
 	{
+		if (IsCompressedFormat(src_format) && !IsCompressedFormat(dst_format)
+			&& (DecodedFormat(src_format) == dst_format)
+			&& (src_width == dst_width) && (src_height == dst_height) && (src_depth == dst_depth))
+		{
+			// Pure format fallback, decode straight into the destination without an intermediate copy
+			DecodeTexture(dst_data, dst_row_pitch, dst_slice_pitch,
+				src_data, src_row_pitch, src_slice_pitch, src_format, src_width, src_height, src_depth);
+			return;
+		}
+
 		std::vector<uint8_t> src_cpu_data_block;
 		void* src_cpu_data;
 		uint32_t src_cpu_row_pitch;
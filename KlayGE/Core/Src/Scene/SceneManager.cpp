@@ -48,18 +48,143 @@
 #include <KlayGE/Renderable.hpp>
 #include <KlayGE/RenderEffect.hpp>
 #include <KlayGE/Light.hpp>
+#include <KlayGE/Mesh.hpp>
 #include <KlayGE/SceneObject.hpp>
 #include <KlayGE/Input.hpp>
 #include <KlayGE/InputFactory.hpp>
 #include <KlayGE/FrameBuffer.hpp>
 #include <KlayGE/DeferredRenderingLayer.hpp>
+#include <KlayGE/PerfProfiler.hpp>
 #include <KFL/Hash.hpp>
+#include <KFL/SIMDMath.hpp>
 
 #include <map>
+#include <array>
+#include <cstring>
 #include <algorithm>
 
 #include <KlayGE/SceneManager.hpp>
 
+namespace
+{
+	using namespace KlayGE;
+
+	size_t const OBJS_PER_SYNC_TASK = 2048;
+	size_t const OBJS_PER_CLIP_BLOCK = 64;
+	size_t const CLIP_BLOCKS_PER_TASK = 16;
+	size_t const ITEMS_PER_SORT_CHUNK = 4096;
+	size_t const ITEMS_PER_KEY_TASK = 256;
+	size_t const OBJS_PER_SUB_THREAD_UPDATE_TASK = 64;
+
+	uint32_t const MAX_KEY_FIELD = 0xFFFF;
+
+	typedef std::pair<uint64_t, Renderable*> RenderQueueItem;
+
+	// Top 16 bits of a float, flipped so that they compare like the float does
+	uint64_t DepthKeyBits(float depth)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &depth, sizeof(bits));
+		bits = (bits & 0x80000000UL) ? ~bits : (bits | 0x80000000UL);
+		return bits >> 16;
+	}
+
+	RenderLayout const * QueueLayout(Renderable const & renderable)
+	{
+		return &renderable.GetRenderLayout(std::max(renderable.ActiveLod(), 0));
+	}
+
+#ifndef KLAYGE_SHIP
+	// Technique, material or layout switches between consecutive items
+	uint32_t CountStateChanges(std::vector<RenderQueueItem> const & items)
+	{
+		uint32_t changes = 0;
+		RenderTechnique const * last_tech = nullptr;
+		RenderMaterial const * last_mtl = nullptr;
+		RenderLayout const * last_layout = nullptr;
+		for (auto const & item : items)
+		{
+			RenderTechnique const * tech = item.second->GetRenderTechnique();
+			RenderMaterial const * mtl = item.second->GetMaterial().get();
+			RenderLayout const * layout = QueueLayout(*item.second);
+			changes += (tech != last_tech) + (mtl != last_mtl) + (layout != last_layout);
+			last_tech = tech;
+			last_mtl = mtl;
+			last_layout = layout;
+		}
+		return changes;
+	}
+#endif
+
+	// Stable LSD radix sort on the 64-bit keys, 8 bits per pass. Each chunk of items builds its histogram and scatters
+	//  in parallel, and digits that are the same for every item are skipped.
+	void RadixSortRenderQueue(std::vector<RenderQueueItem>& items, std::vector<RenderQueueItem>& buff)
+	{
+		size_t const num_items = items.size();
+		size_t const num_chunks = (num_items + ITEMS_PER_SORT_CHUNK - 1) / ITEMS_PER_SORT_CHUNK;
+		buff.resize(num_items);
+
+		task_scheduler& ts = Context::Instance().TaskScheduler();
+		std::vector<std::array<size_t, 256>> offsets(num_chunks);
+		for (uint32_t shift = 0; shift < 64; shift += 8)
+		{
+			ts.parallel_for(0, num_chunks, 1,
+				[&items, &offsets, num_items, shift](size_t chunk_begin, size_t chunk_end)
+				{
+					for (size_t c = chunk_begin; c < chunk_end; ++ c)
+					{
+						auto& hist = offsets[c];
+						hist.fill(0);
+						size_t const end = std::min((c + 1) * ITEMS_PER_SORT_CHUNK, num_items);
+						for (size_t i = c * ITEMS_PER_SORT_CHUNK; i < end; ++ i)
+						{
+							++ hist[(items[i].first >> shift) & 0xFF];
+						}
+					}
+				});
+
+			bool single_digit = false;
+			size_t sum = 0;
+			for (uint32_t d = 0; d < 256; ++ d)
+			{
+				size_t digit_count = 0;
+				for (size_t c = 0; c < num_chunks; ++ c)
+				{
+					size_t const count = offsets[c][d];
+					offsets[c][d] = sum;
+					sum += count;
+					digit_count += count;
+				}
+				if (digit_count == num_items)
+				{
+					single_digit = true;
+					break;
+				}
+			}
+			if (single_digit)
+			{
+				continue;
+			}
+
+			ts.parallel_for(0, num_chunks, 1,
+				[&items, &buff, &offsets, num_items, shift](size_t chunk_begin, size_t chunk_end)
+				{
+					for (size_t c = chunk_begin; c < chunk_end; ++ c)
+					{
+						auto& offset = offsets[c];
+						size_t const end = std::min((c + 1) * ITEMS_PER_SORT_CHUNK, num_items);
+						for (size_t i = c * ITEMS_PER_SORT_CHUNK; i < end; ++ i)
+						{
+							buff[offset[(items[i].first >> shift) & 0xFF] ++] = items[i];
+						}
+					}
+				});
+
+			items.swap(buff);
+		}
+	}
+}
+
 namespace KlayGE
 {
 	// 캯
@@ -68,9 +193,11 @@ namespace KlayGE
 		: frustum_(nullptr),
 			small_obj_threshold_(0),
 			update_elapse_(1.0f / 60),
+			scene_objs_version_(0), sub_thread_objs_version_(0),
 			num_objects_rendered_(0), num_renderables_rendered_(0),
 			num_primitives_rendered_(0), num_vertices_rendered_(0),
 			num_draw_calls_(0), num_dispatch_calls_(0),
+			num_state_changes_(0), num_state_changes_saved_(0),
 			quit_(false), deferred_mode_(false)
 	{
 	}
@@ -80,7 +207,10 @@ namespace KlayGE
 	SceneManager::~SceneManager()
 	{
 		quit_ = true;
-		(*update_thread_)();
+		if (update_thread_)
+		{
+			(*update_thread_)();
+		}
 
 		this->ClearLight();
 		this->ClearCamera();
@@ -125,27 +255,121 @@ namespace KlayGE
 			}
 		}
 
-		for (auto const & obj : scene_objs_)
+		float3 const & view_dir = camera.ForwardVec();
+		float3 const & eye_pos = camera.EyePos();
+		bool const frustum_test = frustum_ && !camera.OmniDirectionalMode();
+
+		auto& store = scene_obj_store_;
+		size_t const num_objs = scene_objs_.size();
+
+		// Moveable objects can share a renderable, so their matrices are refreshed here rather than in the parallel pass
+		for (size_t i = 0; i < num_objs; ++ i)
 		{
-			auto so = obj.get();
+			uint32_t const attr = store.attribs[i];
+			if (!store.has_parent[i] && !(attr & SceneObject::SOA_Invisible) && (attr & SceneObject::SOA_Moveable))
+			{
+				auto so = scene_objs_[i].get();
+				so->UpdateAbsModelMatrix();
+				if (attr & SceneObject::SOA_Cullable)
+				{
+					this->UpdateObjectStoreBound(i, so->PosBoundWS());
+				}
+			}
+		}
+
+		// Root objects, with the frustum test done on a whole block of bounds at a time
+		Context::Instance().TaskScheduler().parallel_for(0, (num_objs + OBJS_PER_CLIP_BLOCK - 1) / OBJS_PER_CLIP_BLOCK,
+			CLIP_BLOCKS_PER_TASK,
+			[this, &store, &view_dir, &eye_pos, &view_proj, frustum_test, num_objs](size_t block_begin, size_t block_end)
+			{
+				BoundOverlap frustum_bos[OBJS_PER_CLIP_BLOCK];
+				for (size_t block = block_begin; block < block_end; ++ block)
+				{
+					size_t const base = block * OBJS_PER_CLIP_BLOCK;
+					size_t const num = std::min(num_objs - base, OBJS_PER_CLIP_BLOCK);
+
+					if (frustum_test)
+					{
+						SIMDMathLib::IntersectAABBsFrustum(frustum_bos, &store.min_x[base], &store.min_y[base], &store.min_z[base],
+							&store.max_x[base], &store.max_y[base], &store.max_z[base], num, *frustum_);
+					}
+
+					for (size_t j = 0; j < num; ++ j)
+					{
+						size_t const i = base + j;
+						if (store.has_parent[i])
+						{
+							continue;
+						}
+
+						uint32_t const attr = store.attribs[i];
+						BoundOverlap bo;
+						if (attr & SceneObject::SOA_Invisible)
+						{
+							bo = BO_No;
+						}
+						else if (attr & SceneObject::SOA_Cullable)
+						{
+							if (small_obj_threshold_ > 0)
+							{
+								AABBox const aabb_ws(float3(store.min_x[i], store.min_y[i], store.min_z[i]),
+									float3(store.max_x[i], store.max_y[i], store.max_z[i]));
+								bo = ((MathLib::ortho_area(view_dir, aabb_ws) > small_obj_threshold_)
+									&& (MathLib::perspective_area(eye_pos, view_proj, aabb_ws) > small_obj_threshold_))
+									? BO_Yes : BO_No;
+							}
+							else
+							{
+								bo = BO_Yes;
+							}
+
+							if (frustum_test && (BO_Yes == bo))
+							{
+								bo = frustum_bos[j];
+							}
+						}
+						else
+						{
+							bo = BO_Yes;
+						}
+
+						store.visible_marks[i] = static_cast<uint8_t>(bo);
+						scene_objs_[i]->VisibleMark(bo);
+					}
+				}
+			});
+
+		// Children depend on the marks of their parents, which come earlier in scene_objs_
+		for (size_t i = 0; i < num_objs; ++ i)
+		{
+			if (!store.has_parent[i])
+			{
+				continue;
+			}
+
+			auto so = scene_objs_[i].get();
 			BoundOverlap visible;
-			uint32_t const attr = so->Attrib();
-			if (so->Visible())
+			uint32_t const attr = store.attribs[i];
+			if (!(attr & SceneObject::SOA_Invisible))
 			{
-				visible = this->VisibleTestFromParent(so, camera.ForwardVec(), camera.EyePos(), view_proj);
+				visible = this->VisibleTestFromParent(so, view_dir, eye_pos, view_proj);
 				if (BO_Partial == visible)
 				{
 					if (attr & SceneObject::SOA_Moveable)
 					{
 						so->UpdateAbsModelMatrix();
+						if (attr & SceneObject::SOA_Cullable)
+						{
+							this->UpdateObjectStoreBound(i, so->PosBoundWS());
+						}
 					}
 
 					if (attr & SceneObject::SOA_Cullable)
 					{
 						if (small_obj_threshold_ > 0)
 						{
-							visible = ((MathLib::ortho_area(camera.ForwardVec(), so->PosBoundWS()) > small_obj_threshold_)
-								&& (MathLib::perspective_area(camera.EyePos(), view_proj, so->PosBoundWS()) > small_obj_threshold_))
+							visible = ((MathLib::ortho_area(view_dir, so->PosBoundWS()) > small_obj_threshold_)
+								&& (MathLib::perspective_area(eye_pos, view_proj, so->PosBoundWS()) > small_obj_threshold_))
 								? BO_Yes : BO_No;
 						}
 						else
@@ -170,6 +394,7 @@ namespace KlayGE
 				visible = BO_No;
 			}
 
+			store.visible_marks[i] = static_cast<uint8_t>(visible);
 			so->VisibleMark(visible);
 		}
 	}
@@ -266,7 +491,9 @@ namespace KlayGE
 				obj->UpdateAbsModelMatrix();
 			}
 
+			this->AddToObjectStore(*obj);
 			scene_objs_.push_back(obj);
+			++ scene_objs_version_;
 			this->OnAddSceneObject(obj);
 		}
 	}
@@ -300,9 +527,87 @@ namespace KlayGE
 	std::vector<SceneObjectPtr>::iterator SceneManager::DelSceneObjectLocked(std::vector<SceneObjectPtr>::iterator iter)
 	{
 		this->OnDelSceneObject(iter);
+		this->DelFromObjectStore(iter - scene_objs_.begin());
+		++ scene_objs_version_;
 		return scene_objs_.erase(iter);
 	}
 
+	void SceneManager::AddToObjectStore(SceneObject const & obj)
+	{
+		auto& store = scene_obj_store_;
+		uint32_t const attr = obj.Attrib();
+		if (attr & SceneObject::SOA_Cullable)
+		{
+			AABBox const & aabb_ws = obj.PosBoundWS();
+			store.min_x.push_back(aabb_ws.Min().x());
+			store.min_y.push_back(aabb_ws.Min().y());
+			store.min_z.push_back(aabb_ws.Min().z());
+			store.max_x.push_back(aabb_ws.Max().x());
+			store.max_y.push_back(aabb_ws.Max().y());
+			store.max_z.push_back(aabb_ws.Max().z());
+		}
+		else
+		{
+			store.min_x.push_back(0);
+			store.min_y.push_back(0);
+			store.min_z.push_back(0);
+			store.max_x.push_back(0);
+			store.max_y.push_back(0);
+			store.max_z.push_back(0);
+		}
+		store.attribs.push_back(attr);
+		store.has_parent.push_back(obj.Parent() ? 1 : 0);
+		store.visible_marks.push_back(static_cast<uint8_t>(BO_No));
+	}
+
+	void SceneManager::DelFromObjectStore(size_t index)
+	{
+		auto& store = scene_obj_store_;
+		BOOST_ASSERT(index < store.attribs.size());
+
+		store.min_x.erase(store.min_x.begin() + index);
+		store.min_y.erase(store.min_y.begin() + index);
+		store.min_z.erase(store.min_z.begin() + index);
+		store.max_x.erase(store.max_x.begin() + index);
+		store.max_y.erase(store.max_y.begin() + index);
+		store.max_z.erase(store.max_z.begin() + index);
+		store.attribs.erase(store.attribs.begin() + index);
+		store.has_parent.erase(store.has_parent.begin() + index);
+		store.visible_marks.erase(store.visible_marks.begin() + index);
+	}
+
+	void SceneManager::UpdateObjectStoreBound(size_t index, AABBox const & aabb_ws)
+	{
+		auto& store = scene_obj_store_;
+		store.min_x[index] = aabb_ws.Min().x();
+		store.min_y[index] = aabb_ws.Min().y();
+		store.min_z[index] = aabb_ws.Min().z();
+		store.max_x[index] = aabb_ws.Max().x();
+		store.max_y[index] = aabb_ws.Max().y();
+		store.max_z[index] = aabb_ws.Max().z();
+	}
+
+	// Attributes and parents can change on the objects at any time, so refresh them once per flush. This also
+	//  resets the marks, which scene managers overriding ClipScene rely on.
+	void SceneManager::SyncObjectStore()
+	{
+		auto& store = scene_obj_store_;
+		BOOST_ASSERT(store.attribs.size() == scene_objs_.size());
+
+		Context::Instance().TaskScheduler().parallel_for(0, scene_objs_.size(), OBJS_PER_SYNC_TASK,
+			[this, &store](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; ++ i)
+				{
+					auto so = scene_objs_[i].get();
+					so->VisibleMark(BO_No);
+					store.attribs[i] = so->Attrib();
+					store.has_parent[i] = so->Parent() ? 1 : 0;
+					store.visible_marks[i] = static_cast<uint8_t>(BO_No);
+				}
+			});
+	}
+
 	// Ⱦ
 	/////////////////////////////////////////////////////////////////////////////////
 	void SceneManager::AddRenderable(Renderable* obj)
@@ -355,22 +660,10 @@ namespace KlayGE
 
 			if (add)
 			{
-				RenderTechnique const * obj_tech = obj->GetRenderTechnique();
-				BOOST_ASSERT(obj_tech);
-				bool found = false;
-				for (auto& items : render_queue_)
-				{
-					if (items.first == obj_tech)
-					{
-						items.second.push_back(obj);
-						found = true;
-						break;
-					}
-				}
-				if (!found)
-				{
-					render_queue_.emplace_back(obj_tech, std::vector<Renderable*>(1, obj));
-				}
+				BOOST_ASSERT(obj->GetRenderTechnique());
+
+				// Keys are filled in Flush, after all the instances are known
+				render_queue_.emplace_back(0, obj);
 			}
 		}
 	}
@@ -448,17 +741,47 @@ namespace KlayGE
 		lights_.resize(0);
 	}
 
+	void SceneManager::PoseSkinnedModel(SkinnedModelPtr const & model, float frame)
+	{
+		posed_models_[model] = frame;
+	}
+
+	void SceneManager::PoseSkinnedModels()
+	{
+		if (posed_models_.empty())
+		{
+			return;
+		}
+
+		KLAYGE_PERF_ZONE("SceneManager::PoseSkinnedModels");
+
+		pose_batch_models_.clear();
+		pose_batch_frames_.clear();
+		for (auto const & posed : posed_models_)
+		{
+			pose_batch_models_.push_back(posed.first.get());
+			pose_batch_frames_.push_back(posed.second);
+		}
+		SkinnedModel::SetFrames(pose_batch_models_, pose_batch_frames_);
+
+		posed_models_.clear();
+	}
+
 	void SceneManager::ClearObject()
 	{
 		std::lock_guard<std::mutex> lock(update_mutex_);
 		scene_objs_.resize(0);
 		overlay_scene_objs_.resize(0);
+		scene_obj_store_ = SceneObjectStore();
+		++ scene_objs_version_;
 	}
 
 	// ³
 	/////////////////////////////////////////////////////////////////////////////////
 	void SceneManager::Update()
 	{
+		KLAYGE_PERF_ZONE("SceneManager::Update");
+
 		deferred_mode_ = !!Context::Instance().DeferredRenderingLayerInstance();
 
 		App3DFramework& app = Context::Instance().AppInstance();
@@ -468,6 +791,26 @@ namespace KlayGE
 		RenderEngine& re = Context::Instance().RenderFactoryInstance().RenderEngineInstance();
 		re.BeginFrame();
 
+		// One snapshot of what the update thread published, for all the passes of this frame
+		{
+			std::lock_guard<std::mutex> lock(update_mutex_);
+
+			task_scheduler& ts = Context::Instance().TaskScheduler();
+			ts.parallel_for(0, scene_objs_.size(), OBJS_PER_SYNC_TASK,
+				[this](size_t begin, size_t end)
+				{
+					for (size_t i = begin; i < end; ++ i)
+					{
+						scene_objs_[i]->AcquireSubThreadState();
+					}
+				});
+			for (auto const & scene_obj : overlay_scene_objs_)
+			{
+				scene_obj->AcquireSubThreadState();
+			}
+		}
+
+		this->PoseSkinnedModels();
 		this->FlushScene();
 
 		if (!update_thread_ && !quit_)
@@ -480,10 +823,15 @@ namespace KlayGE
 		{
 			std::lock_guard<std::mutex> lock(update_mutex_);
 
-			for (auto const & scene_obj : scene_objs_)
+			for (size_t i = 0; i < scene_objs_.size(); ++ i)
 			{
+				auto const & scene_obj = scene_objs_[i];
 				if (scene_obj->MainThreadUpdate(app_time, frame_time))
 				{
+					if (scene_obj->Attrib() & SceneObject::SOA_Cullable)
+					{
+						this->UpdateObjectStoreBound(i, scene_obj->PosBoundWS());
+					}
 					added_scene_objs.push_back(scene_obj);
 				}
 			}
@@ -536,6 +884,8 @@ namespace KlayGE
 	/////////////////////////////////////////////////////////////////////////////////
 	void SceneManager::Flush(uint32_t urt)
 	{
+		KLAYGE_PERF_ZONE("SceneManager::Flush");
+
 		std::lock_guard<std::mutex> lock(update_mutex_);
 
 		urt_ = urt;
@@ -551,143 +901,121 @@ namespace KlayGE
 		num_vertices_rendered_ = 0;
 
 		Camera& camera = app.ActiveCamera();
-		auto const & scene_objs = (urt & App3DFramework::URV_Overlay) ? overlay_scene_objs_ : scene_objs_;
 
-		for (auto const & scene_obj : scene_objs)
+		visible_leaf_objs_.clear();
+		if (urt & App3DFramework::URV_Overlay)
 		{
-			scene_obj->VisibleMark(BO_No);
+			for (auto const & scene_obj : overlay_scene_objs_)
+			{
+				scene_obj->MainThreadUpdate(app_time, frame_time);
+				bool const visible = scene_obj->Visible();
+				scene_obj->VisibleMark(visible ? BO_Yes : BO_No);
+				if (visible && (0 == scene_obj->NumChildren()))
+				{
+					visible_leaf_objs_.push_back(scene_obj.get());
+				}
+			}
 		}
-		if (urt & App3DFramework::URV_NeedFlush)
+		else
 		{
-			frustum_ = &camera.ViewFrustum();
+			this->SyncObjectStore();
 
-			std::vector<uint32_t> visible_list((scene_objs.size() + 31) / 32, 0);
-			for (size_t i = 0; i < scene_objs.size(); ++ i)
+			auto& store = scene_obj_store_;
+			size_t const num_objs = scene_objs_.size();
+			if (urt & App3DFramework::URV_NeedFlush)
 			{
-				if (scene_objs[i]->Visible())
+				frustum_ = &camera.ViewFrustum();
+
+				std::vector<uint32_t> visible_list((num_objs + 31) / 32, 0);
+				for (size_t i = 0; i < num_objs; ++ i)
 				{
-					visible_list[i / 32] |= (1UL << (i & 31));
+					if (!(store.attribs[i] & SceneObject::SOA_Invisible))
+					{
+						visible_list[i / 32] |= (1UL << (i & 31));
+					}
 				}
-			}
-			size_t seed = 0;
-			HashRange(seed, visible_list.begin(), visible_list.end());
-			HashCombine(seed, camera.OmniDirectionalMode());
-			HashCombine(seed, &camera);
+				size_t seed = 0;
+				HashRange(seed, visible_list.begin(), visible_list.end());
+				HashCombine(seed, camera.OmniDirectionalMode());
+				HashCombine(seed, &camera);
+
+				task_scheduler& ts = Context::Instance().TaskScheduler();
+				auto vmiter = visible_marks_map_.find(seed);
+				if (vmiter == visible_marks_map_.end())
+				{
+					this->ClipScene();
 
-			auto vmiter = visible_marks_map_.find(seed);
-			if (vmiter == visible_marks_map_.end())
-			{
-				this->ClipScene();
+					// An overridden ClipScene might only mark the objects
+					ts.parallel_for(0, num_objs, OBJS_PER_SYNC_TASK,
+						[this, &store](size_t begin, size_t end)
+						{
+							for (size_t i = begin; i < end; ++ i)
+							{
+								store.visible_marks[i] = static_cast<uint8_t>(scene_objs_[i]->VisibleMark());
+							}
+						});
 
-				auto visible_marks = MakeUniquePtr<std::vector<BoundOverlap>>(scene_objs.size());
-				for (size_t i = 0; i < scene_objs.size(); ++ i)
+					visible_marks_map_.emplace(seed, MakeSharedPtr<std::vector<uint8_t>>(store.visible_marks));
+				}
+				else
 				{
-					(*visible_marks)[i] = scene_objs[i]->VisibleMark();
+					store.visible_marks = *vmiter->second;
+					ts.parallel_for(0, num_objs, OBJS_PER_SYNC_TASK,
+						[this, &store](size_t begin, size_t end)
+						{
+							for (size_t i = begin; i < end; ++ i)
+							{
+								scene_objs_[i]->VisibleMark(static_cast<BoundOverlap>(store.visible_marks[i]));
+							}
+						});
 				}
 
-				visible_marks_map_.emplace(seed, std::move(visible_marks));
-			}
-			else
-			{
-				for (size_t i = 0; i < scene_objs.size(); ++ i)
+				for (size_t i = 0; i < num_objs; ++ i)
 				{
-					scene_objs[i]->VisibleMark((*vmiter->second)[i]);
+					if (store.visible_marks[i] != BO_No)
+					{
+						auto so = scene_objs_[i].get();
+						if (0 == so->NumChildren())
+						{
+							visible_leaf_objs_.push_back(so);
+						}
+					}
 				}
 			}
 		}
-		if (urt & App3DFramework::URV_Overlay)
-		{
-			for (auto const & scene_obj : scene_objs)
-			{
-				scene_obj->MainThreadUpdate(app_time, frame_time);
-				scene_obj->VisibleMark(scene_obj->Visible() ? BO_Yes : BO_No);
-			}
-		}
 
-		for (auto const & obj : scene_objs)
+		for (auto so : visible_leaf_objs_)
 		{
-			auto so = obj.get();
-			if ((so->VisibleMark() != BO_No) && (0 == so->NumChildren()))
+			auto renderable = so->GetRenderable().get();
+			if (renderable)
 			{
-				auto renderable = so->GetRenderable().get();
-				if (renderable)
-				{
-					renderable->ClearInstances();
-				}
+				renderable->ClearInstances();
 			}
 		}
 
-		for (auto const & obj : scene_objs)
+		for (auto so : visible_leaf_objs_)
 		{
-			auto so = obj.get();
-			if ((so->VisibleMark() != BO_No) && (0 == so->NumChildren()))
+			auto renderable = so->GetRenderable().get();
+			if (renderable)
 			{
-				auto renderable = so->GetRenderable().get();
-				if (renderable)
+				if (0 == renderable->NumInstances())
 				{
-					if (0 == renderable->NumInstances())
-					{
-						renderable->AddToRenderQueue();
-					}
-					renderable->AddInstance(so);
-					++ num_objects_rendered_;
+					renderable->AddToRenderQueue();
 				}
+				renderable->AddInstance(so);
+				++ num_objects_rendered_;
 			}
 		}
 
-		std::sort(render_queue_.begin(), render_queue_.end(),
-			[](std::pair<RenderTechnique const *, std::vector<Renderable*>> const & lhs,
-				std::pair<RenderTechnique const *, std::vector<Renderable*>> const & rhs)
-			{
-				BOOST_ASSERT(lhs.first);
-				BOOST_ASSERT(rhs.first);
-
-				return lhs.first->Weight() < rhs.first->Weight();
-			});
-
-		float4 const & view_mat_z = camera.ViewMatrix().Col(2);
-		for (auto& items : render_queue_)
+		if (!render_queue_.empty())
 		{
-			if (!items.first->Transparent() && !items.first->HasDiscard() && (items.second.size() > 1))
-			{
-				std::vector<std::pair<float, uint32_t>> min_depths(items.second.size());
-				for (size_t j = 0; j < min_depths.size(); ++ j)
-				{
-					Renderable const * renderable = items.second[j];
-					AABBox const & box = renderable->PosBound();
-					uint32_t const num = renderable->NumInstances();
-					float md = 1e10f;
-					for (uint32_t i = 0; i < num; ++ i)
-					{
-						float4x4 const & mat = renderable->GetInstance(i)->ModelMatrix();
-						float4 const zvec(MathLib::dot(mat.Row(0), view_mat_z),
-							MathLib::dot(mat.Row(1), view_mat_z), MathLib::dot(mat.Row(2), view_mat_z),
-							MathLib::dot(mat.Row(3), view_mat_z));
-						for (int k = 0; k < 8; ++ k)
-						{
-							float3 const v = box.Corner(k);
-							md = std::min(md, v.x() * zvec.x() + v.y() * zvec.y() + v.z() * zvec.z() + zvec.w());
-						}
-					}
-
-					min_depths[j] = std::make_pair(md, static_cast<uint32_t>(j));
-				}
-
-				std::sort(min_depths.begin(), min_depths.end());
-
-				std::vector<Renderable*> sorted_items(min_depths.size());
-				for (size_t j = 0; j < min_depths.size(); ++ j)
-				{
-					sorted_items[j] = items.second[min_depths[j].second];
-				}
-				items.second.swap(sorted_items);
-			}
+			this->SortRenderQueue(camera);
 
-			for (auto const & item : items.second)
+			for (auto const & item : render_queue_)
 			{
-				item->Render();
+				item.second->Render();
 			}
-			num_renderables_rendered_ += static_cast<uint32_t>(items.second.size());
+			num_renderables_rendered_ += static_cast<uint32_t>(render_queue_.size());
 		}
 		render_queue_.resize(0);
 
@@ -735,11 +1063,129 @@ namespace KlayGE
 		return num_dispatch_calls_;
 	}
 
+	uint32_t SceneManager::NumStateChanges() const
+	{
+		return num_state_changes_;
+	}
+
+	uint32_t SceneManager::NumStateChangesSaved() const
+	{
+		return num_state_changes_saved_;
+	}
+
+	void SceneManager::SortRenderQueue(Camera const & camera)
+	{
+		// Techniques, materials and layouts get small ids in order of appearance
+		std::vector<RenderTechnique const *> techs;
+		for (auto& item : render_queue_)
+		{
+			Renderable const & renderable = *item.second;
+			RenderTechnique const * tech = renderable.GetRenderTechnique();
+			auto tech_iter = queue_tech_ids_.emplace(tech, static_cast<uint32_t>(techs.size())).first;
+			if (tech_iter->second == techs.size())
+			{
+				techs.push_back(tech);
+			}
+			uint32_t const mtl_id = queue_mtl_ids_.emplace(renderable.GetMaterial().get(),
+				static_cast<uint32_t>(queue_mtl_ids_.size())).first->second;
+			uint32_t const layout_id = queue_layout_ids_.emplace(QueueLayout(renderable),
+				static_cast<uint32_t>(queue_layout_ids_.size())).first->second;
+
+			// The technique id is read back from the key below, so it must not be clamped
+			BOOST_ASSERT(tech_iter->second <= MAX_KEY_FIELD);
+			item.first = (static_cast<uint64_t>(tech_iter->second) << 48)
+				| (static_cast<uint64_t>(std::min(mtl_id, MAX_KEY_FIELD)) << 32)
+				| (static_cast<uint64_t>(std::min(layout_id, MAX_KEY_FIELD)) << 16);
+		}
+
+		std::vector<uint32_t> tech_orders(techs.size());
+		{
+			std::vector<uint32_t> sorted_techs(techs.size());
+			for (uint32_t i = 0; i < sorted_techs.size(); ++ i)
+			{
+				sorted_techs[i] = i;
+			}
+			std::stable_sort(sorted_techs.begin(), sorted_techs.end(),
+				[&techs](uint32_t lhs, uint32_t rhs)
+				{
+					return techs[lhs]->Weight() < techs[rhs]->Weight();
+				});
+			for (uint32_t i = 0; i < sorted_techs.size(); ++ i)
+			{
+				tech_orders[sorted_techs[i]] = i;
+			}
+		}
+
+		// Opaque items without discard also go front to back. Others keep their material and layout zeroed, so they
+		//  draw in the order they were added.
+		float4x4 const & view_mat = camera.ViewMatrix();
+		Context::Instance().TaskScheduler().parallel_for(0, render_queue_.size(), ITEMS_PER_KEY_TASK,
+			[this, &techs, &tech_orders, &view_mat](size_t begin, size_t end)
+			{
+				std::vector<float4x4> model_views;
+				std::vector<AABBox> view_bounds;
+				for (size_t j = begin; j < end; ++ j)
+				{
+					auto& item = render_queue_[j];
+					uint32_t const tech_id = static_cast<uint32_t>(item.first >> 48);
+					RenderTechnique const * tech = techs[tech_id];
+					uint64_t key = static_cast<uint64_t>(tech_orders[tech_id]) << 48;
+					if (!tech->Transparent() && !tech->HasDiscard())
+					{
+						Renderable const * renderable = item.second;
+						uint32_t const num = renderable->NumInstances();
+						float md = 1e10f;
+						if (num > 0)
+						{
+							// The nearest depth of all instances is the smallest z of their view space bounds
+							model_views.resize(num);
+							view_bounds.resize(num);
+							for (uint32_t i = 0; i < num; ++ i)
+							{
+								model_views[i] = renderable->GetInstance(i)->ModelMatrix();
+							}
+							SIMDMathLib::MultiplyMatrices(&model_views[0], &model_views[0], view_mat, num);
+							SIMDMathLib::TransformAABBs(&view_bounds[0], renderable->PosBound(), &model_views[0], num);
+							for (uint32_t i = 0; i < num; ++ i)
+							{
+								md = std::min(md, view_bounds[i].Min().z());
+							}
+						}
+
+						key |= (item.first & 0x0000FFFFFFFF0000ULL) | DepthKeyBits(md);
+					}
+					item.first = key;
+				}
+			});
+
+#ifndef KLAYGE_SHIP
+		// The state change statistics walk the queue twice, so they're only gathered while profiling
+		if (PerfProfiler::ZonesEnabled())
+		{
+			uint32_t const unsorted_changes = CountStateChanges(render_queue_);
+			RadixSortRenderQueue(render_queue_, render_queue_sort_buff_);
+			uint32_t const sorted_changes = CountStateChanges(render_queue_);
+			num_state_changes_ += sorted_changes;
+			num_state_changes_saved_ += unsorted_changes - std::min(unsorted_changes, sorted_changes);
+		}
+		else
+#endif
+		{
+			RadixSortRenderQueue(render_queue_, render_queue_sort_buff_);
+		}
+
+		queue_tech_ids_.clear();
+		queue_mtl_ids_.clear();
+		queue_layout_ids_.clear();
+	}
+
 	void SceneManager::FlushScene()
 	{
 		RenderEngine& re = Context::Instance().RenderFactoryInstance().RenderEngineInstance();
 
 		visible_marks_map_.clear();
+		num_state_changes_ = 0;
+		num_state_changes_saved_ = 0;
 
 		uint32_t urt;
 		App3DFramework& app = Context::Instance().AppInstance();
@@ -775,10 +1221,19 @@ namespace KlayGE
 
 		num_draw_calls_ = re.NumDrawsJustCalled();
 		num_dispatch_calls_ = re.NumDispatchesJustCalled();
+
+		KLAYGE_PERF_COUNTER("Draw calls", num_draw_calls_);
+		KLAYGE_PERF_COUNTER("Dispatch calls", num_dispatch_calls_);
+		KLAYGE_PERF_COUNTER("State changes", num_state_changes_);
+		KLAYGE_PERF_COUNTER("State changes saved", num_state_changes_saved_);
 	}
 
 	void SceneManager::UpdateThreadFunc()
 	{
+#ifndef KLAYGE_SHIP
+		PerfProfiler::Instance().ThreadName("Scene update");
+#endif
+
 		Timer timer;
 		float app_time = 0;
 		while (!quit_)
@@ -792,16 +1247,31 @@ namespace KlayGE
 				WindowPtr const & win = Context::Instance().AppInstance().MainWnd();
 				if (win && win->Active())
 				{
-					std::lock_guard<std::mutex> lock(update_mutex_);
+					KLAYGE_PERF_ZONE("SceneManager::SubThreadUpdate");
 
-					for (auto const & scene_obj : scene_objs_)
-					{
-						scene_obj->SubThreadUpdate(app_time, frame_time);
-					}
-					for (auto const & scene_obj : overlay_scene_objs_)
+					// Only copying the object lists needs the lock. The objects publish their own state.
 					{
-						scene_obj->SubThreadUpdate(app_time, frame_time);
+						std::lock_guard<std::mutex> lock(update_mutex_);
+
+						if (sub_thread_objs_version_ != scene_objs_version_)
+						{
+							sub_thread_objs_ = scene_objs_;
+							sub_thread_objs_version_ = scene_objs_version_;
+
+							for (auto const & obj : sub_thread_objs_)
+							{
+								obj->PrepareSubThreadUpdate();
+							}
+						}
+						sub_thread_overlay_objs_ = overlay_scene_objs_;
+						for (auto const & obj : sub_thread_overlay_objs_)
+						{
+							obj->PrepareSubThreadUpdate();
+						}
 					}
+
+					this->SubThreadUpdateObjects(sub_thread_objs_, app_time, frame_time);
+					this->SubThreadUpdateObjects(sub_thread_overlay_objs_, app_time, frame_time);
 				}
 
 				if (frame_time < update_elapse_)
@@ -812,6 +1282,43 @@ namespace KlayGE
 		}
 	}
 
+	void SceneManager::SubThreadUpdateObjects(std::vector<SceneObjectPtr> const & objs, float app_time, float elapsed_time)
+	{
+		// Objects are updated one hierarchy level at a time, so a child reads the state its parent made in this tick
+		for (auto& level : sub_thread_levels_)
+		{
+			level.clear();
+		}
+		for (auto const & obj : objs)
+		{
+			size_t depth = 0;
+			for (auto parent = obj->Parent(); parent; parent = parent->Parent())
+			{
+				++ depth;
+			}
+			if (depth >= sub_thread_levels_.size())
+			{
+				sub_thread_levels_.resize(depth + 1);
+			}
+			sub_thread_levels_[depth].push_back(obj.get());
+		}
+
+		for (auto const & level : sub_thread_levels_)
+		{
+			Context::Instance().TaskScheduler().parallel_for(0, level.size(), OBJS_PER_SUB_THREAD_UPDATE_TASK,
+				[&level, app_time, elapsed_time](size_t begin, size_t end)
+				{
+					for (size_t i = begin; i < end; ++ i)
+					{
+						auto so = level[i];
+						so->BeginSubThreadUpdate();
+						so->SubThreadUpdate(app_time, elapsed_time);
+						so->EndSubThreadUpdate();
+					}
+				});
+		}
+	}
+
 	BoundOverlap SceneManager::VisibleTestFromParent(SceneObject* obj, float3 const & view_dir, float3 const & eye_pos,
 		float4x4 const & view_proj)
 	{
@@ -24,12 +24,21 @@
 
 #include <KlayGE/SceneObject.hpp>
 
+namespace
+{
+	// Nonzero while the current thread is inside a SubThreadUpdate
+	thread_local uint32_t sub_thread_update_depth = 0;
+}
+
 namespace KlayGE
 {
 	SceneObject::SceneObject(uint32_t attrib)
 		: attrib_(attrib), parent_(nullptr), renderable_hw_res_ready_(false),
 			model_(float4x4::Identity()), abs_model_(float4x4::Identity()),
-			visible_mark_(BO_No)
+			visible_mark_(BO_No),
+			sub_thread_middle_(0), sub_thread_back_(0), main_thread_front_(0),
+			main_thread_model_version_(0), main_thread_visible_version_(0),
+			sub_thread_dirty_(false)
 	{
 		if (!(attrib & SOA_Overlay) && (attrib & (SOA_Cullable | SOA_Moveable)))
 		{
@@ -69,12 +78,28 @@ namespace KlayGE
 
 	void SceneObject::ModelMatrix(float4x4 const & mat)
 	{
-		model_ = mat;
+		if (sub_thread_states_ && this->InSubThreadUpdate())
+		{
+			sub_thread_states_[0].model = mat;
+			++ sub_thread_states_[0].model_version;
+			sub_thread_dirty_ = true;
+		}
+		else
+		{
+			model_ = mat;
+		}
 	}
 
 	float4x4 const & SceneObject::ModelMatrix() const
 	{
-		return model_;
+		if (sub_thread_states_ && this->InSubThreadUpdate())
+		{
+			return sub_thread_states_[0].model;
+		}
+		else
+		{
+			return model_;
+		}
 	}
 
 	float4x4 const & SceneObject::AbsModelMatrix() const
@@ -137,6 +162,80 @@ namespace KlayGE
 		}
 	}
 
+	void SceneObject::PrepareSubThreadUpdate()
+	{
+		if (!sub_thread_states_)
+		{
+			this->InitSubThreadStates();
+		}
+	}
+
+	void SceneObject::BeginSubThreadUpdate()
+	{
+		++ sub_thread_update_depth;
+	}
+
+	void SceneObject::EndSubThreadUpdate()
+	{
+		-- sub_thread_update_depth;
+
+		if (sub_thread_dirty_)
+		{
+			sub_thread_states_[sub_thread_back_] = sub_thread_states_[0];
+			uint32_t const old_middle = sub_thread_middle_.exchange(sub_thread_back_ | SUB_THREAD_STATE_FRESH,
+				std::memory_order_acq_rel);
+			sub_thread_back_ = old_middle & ~SUB_THREAD_STATE_FRESH;
+			sub_thread_dirty_ = false;
+		}
+	}
+
+	void SceneObject::AcquireSubThreadState()
+	{
+		if (sub_thread_middle_.load(std::memory_order_relaxed) & SUB_THREAD_STATE_FRESH)
+		{
+			uint32_t const old_middle = sub_thread_middle_.exchange(main_thread_front_, std::memory_order_acq_rel);
+			main_thread_front_ = old_middle & ~SUB_THREAD_STATE_FRESH;
+
+			SubThreadState const & state = sub_thread_states_[main_thread_front_];
+			if (state.model_version != main_thread_model_version_)
+			{
+				model_ = state.model;
+				main_thread_model_version_ = state.model_version;
+			}
+			if (state.visible_version != main_thread_visible_version_)
+			{
+				if (state.visible)
+				{
+					attrib_ &= ~SOA_Invisible;
+				}
+				else
+				{
+					attrib_ |= SOA_Invisible;
+				}
+				main_thread_visible_version_ = state.visible_version;
+			}
+		}
+	}
+
+	bool SceneObject::InSubThreadUpdate()
+	{
+		return sub_thread_update_depth > 0;
+	}
+
+	void SceneObject::InitSubThreadStates()
+	{
+		sub_thread_states_ = MakeUniquePtr<SubThreadState[]>(4);
+		sub_thread_states_[0].model = model_;
+		sub_thread_states_[0].visible = (0 == (attrib_ & SOA_Invisible));
+		sub_thread_states_[0].model_version = 0;
+		sub_thread_states_[0].visible_version = 0;
+		main_thread_model_version_ = 0;
+		main_thread_visible_version_ = 0;
+		sub_thread_back_ = 1;
+		main_thread_front_ = 2;
+		sub_thread_middle_.store(3, std::memory_order_release);
+	}
+
 	bool SceneObject::MainThreadUpdate(float app_time, float elapsed_time)
 	{
 		bool refreshed = false;
@@ -199,12 +298,25 @@ namespace KlayGE
 
 	bool SceneObject::Visible() const
 	{
-		return (0 == (attrib_ & SOA_Invisible));
+		if (sub_thread_states_ && this->InSubThreadUpdate())
+		{
+			return sub_thread_states_[0].visible;
+		}
+		else
+		{
+			return (0 == (attrib_ & SOA_Invisible));
+		}
 	}
 
 	void SceneObject::Visible(bool vis)
 	{
-		if (vis)
+		if (sub_thread_states_ && this->InSubThreadUpdate())
+		{
+			sub_thread_states_[0].visible = vis;
+			++ sub_thread_states_[0].visible_version;
+			sub_thread_dirty_ = true;
+		}
+		else if (vis)
 		{
 			attrib_ &= ~SOA_Invisible;
 		}
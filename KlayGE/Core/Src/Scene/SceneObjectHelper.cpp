@@ -221,7 +221,7 @@ namespace KlayGE
 
 	void SceneObjectCameraProxy::SubThreadUpdate(float /*app_time*/, float /*elapsed_time*/)
 	{
-		model_ = model_scaling_ * camera_->InverseViewMatrix();
+		this->ModelMatrix(model_scaling_ * camera_->InverseViewMatrix());
 	}
 
 	void SceneObjectCameraProxy::Scaling(float x, float y, float z)
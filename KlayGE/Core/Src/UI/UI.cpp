@@ -58,14 +58,14 @@ namespace
 		}
 	}
 
-	bool ReadBool(KlayGE::XMLNodePtr& node, std::string const & name, bool default_val)
+	bool ReadBool(KlayGE::XMLNodeView node, std::string_view name, bool default_val)
 	{
 		bool ret = default_val;
 
-		KlayGE::XMLAttributePtr attr = node->Attrib(name);
+		KlayGE::XMLAttributeView const attr = node.Attrib(name);
 		if (attr)
 		{
-			ret = BoolFromStr(attr->ValueString());
+			ret = BoolFromStr(attr.ValueString());
 		}
 
 		return ret;
@@ -418,12 +418,10 @@ namespace KlayGE
 			XMLDocument doc;
 			XMLNodePtr root = doc.Parse(source);
 
-			XMLAttributePtr attr;
-
 			std::vector<std::unique_ptr<XMLDocument>> include_docs;
 			for (XMLNodePtr node = root->FirstNode("include"); node;)
 			{
-				attr = node->Attrib("name");
+				XMLAttributePtr attr = node->Attrib("name");
 				include_docs.push_back(MakeUniquePtr<XMLDocument>());
 				XMLNodePtr include_root = include_docs.back()->Parse(ResLoader::Instance().Open(attr->ValueString()));
 
@@ -440,24 +438,26 @@ namespace KlayGE
 				node = node_next;
 			}
 
-			for (XMLNodePtr node = root->FirstNode("dialog"); node; node = node->NextSibling("dialog"))
+			XMLAttributeView attr;
+			XMLNodeView const root_view(*root);
+			for (XMLNodeView node = root_view.FirstNode("dialog"); node; node = node.NextSibling("dialog"))
 			{
 				UIDialogPtr dlg;
 				{
 					int32_t x, y;
 					uint32_t width, height;
 					UIDialog::ControlAlignment align_x = UIDialog::CA_Left, align_y = UIDialog::CA_Top;
-					std::string id = node->AttribString("id", "");
-					std::string caption = node->AttribString("caption", "");
-					std::string skin = node->AttribString("skin", "");
-					x = node->Attrib("x")->ValueInt();
-					y = node->Attrib("y")->ValueInt();
-					width = node->Attrib("width")->ValueInt();
-					height = node->Attrib("height")->ValueInt();
-					attr = node->Attrib("align_x");
+					std::string const id(node.AttribString("id", ""));
+					std::string const caption(node.AttribString("caption", ""));
+					std::string const skin(node.AttribString("skin", ""));
+					x = node.Attrib("x").ValueInt();
+					y = node.Attrib("y").ValueInt();
+					width = node.Attrib("width").ValueInt();
+					height = node.Attrib("height").ValueInt();
+					attr = node.Attrib("align_x");
 					if (attr)
 					{
-						std::string const & align_x_str = attr->ValueString();
+						std::string_view const align_x_str = attr.ValueString();
 						if ("left" == align_x_str)
 						{
 							align_x = UIDialog::CA_Left;
@@ -472,10 +472,10 @@ namespace KlayGE
 							align_x = UIDialog::CA_Center;
 						}
 					}
-					attr = node->Attrib("align_y");
+					attr = node.Attrib("align_y");
 					if (attr)
 					{
-						std::string const & align_y_str = attr->ValueString();
+						std::string_view const align_y_str = attr.ValueString();
 						if ("top" == align_y_str)
 						{
 							align_y = UIDialog::CA_Top;
@@ -506,25 +506,25 @@ namespace KlayGE
 					dlg->AlwaysInOpacity(ReadBool(node, "opacity", false));
 
 					Color bg_clr(0.4f, 0.6f, 0.8f, 1);
-					attr = node->Attrib("bg_color_r");
+					attr = node.Attrib("bg_color_r");
 					if (attr)
 					{
-						bg_clr.r() = attr->ValueFloat();
+						bg_clr.r() = attr.ValueFloat();
 					}
-					attr = node->Attrib("bg_color_g");
+					attr = node.Attrib("bg_color_g");
 					if (attr)
 					{
-						bg_clr.g() = attr->ValueFloat();
+						bg_clr.g() = attr.ValueFloat();
 					}
-					attr = node->Attrib("bg_color_b");
+					attr = node.Attrib("bg_color_b");
 					if (attr)
 					{
-						bg_clr.b() = attr->ValueFloat();
+						bg_clr.b() = attr.ValueFloat();
 					}
-					attr = node->Attrib("bg_color_a");
+					attr = node.Attrib("bg_color_a");
 					if (attr)
 					{
-						bg_clr.a() = attr->ValueFloat();
+						bg_clr.a() = attr.ValueFloat();
 					}
 					dlg->SetBackgroundColors(bg_clr);
 
@@ -534,14 +534,14 @@ namespace KlayGE
 				}
 
 				std::vector<std::string> ctrl_ids;
-				for (XMLNodePtr ctrl_node = node->FirstNode("control"); ctrl_node; ctrl_node = ctrl_node->NextSibling("control"))
+				for (XMLNodeView ctrl_node = node.FirstNode("control"); ctrl_node; ctrl_node = ctrl_node.NextSibling("control"))
 				{
-					ctrl_ids.push_back(ctrl_node->Attrib("id")->ValueString());
+					ctrl_ids.emplace_back(ctrl_node.Attrib("id").ValueString());
 				}
 				std::sort(ctrl_ids.begin(), ctrl_ids.end());
 				ctrl_ids.erase(std::unique(ctrl_ids.begin(), ctrl_ids.end()), ctrl_ids.end());
 
-				for (XMLNodePtr ctrl_node = node->FirstNode("control"); ctrl_node; ctrl_node = ctrl_node->NextSibling("control"))
+				for (XMLNodeView ctrl_node = node.FirstNode("control"); ctrl_node; ctrl_node = ctrl_node.NextSibling("control"))
 				{
 					int32_t x, y;
 					uint32_t width, height;
@@ -551,21 +551,21 @@ namespace KlayGE
 
 					uint32_t id;
 					{
-						std::string id_str = ctrl_node->Attrib("id")->ValueString();
+						std::string const id_str(ctrl_node.Attrib("id").ValueString());
 						id = static_cast<uint32_t>(std::find(ctrl_ids.begin(), ctrl_ids.end(), id_str) - ctrl_ids.begin());
 						dlg->AddIDName(id_str, id);
 					}
 
-					x = ctrl_node->Attrib("x")->ValueInt();
-					y = ctrl_node->Attrib("y")->ValueInt();
-					width = ctrl_node->Attrib("width")->ValueInt();
-					height = ctrl_node->Attrib("height")->ValueInt();
+					x = ctrl_node.Attrib("x").ValueInt();
+					y = ctrl_node.Attrib("y").ValueInt();
+					width = ctrl_node.Attrib("width").ValueInt();
+					height = ctrl_node.Attrib("height").ValueInt();
 					is_default = ReadBool(ctrl_node, "is_default", false);
 					visible = ReadBool(ctrl_node, "visible", true);
-					attr = ctrl_node->Attrib("align_x");
+					attr = ctrl_node.Attrib("align_x");
 					if (attr)
 					{
-						std::string const & align_x_str = attr->ValueString();
+						std::string_view const align_x_str = attr.ValueString();
 						if ("left" == align_x_str)
 						{
 							align_x = UIDialog::CA_Left;
@@ -580,10 +580,10 @@ namespace KlayGE
 							align_x = UIDialog::CA_Center;
 						}
 					}
-					attr = ctrl_node->Attrib("align_y");
+					attr = ctrl_node.Attrib("align_y");
 					if (attr)
 					{
-						std::string const & align_y_str = attr->ValueString();
+						std::string_view const align_y_str = attr.ValueString();
 						if ("top" == align_y_str)
 						{
 							align_y = UIDialog::CA_Top;
@@ -604,11 +604,10 @@ namespace KlayGE
 						dlg->CtrlLocation(id, loc);
 					}
 
-					std::string type_str = ctrl_node->Attrib("type")->ValueString();
-					size_t const type_str_hash = RT_HASH(type_str.c_str());
+					size_t const type_str_hash = RT_HASH(ctrl_node.Attrib("type").ValueString());
 					if (CT_HASH("static") == type_str_hash)
 					{
-						std::string caption = ctrl_node->Attrib("caption")->ValueString();
+						std::string_view const caption = ctrl_node.Attrib("caption").ValueString();
 						std::wstring wcaption;
 						Convert(wcaption, caption);
 						dlg->AddControl(MakeSharedPtr<UIStatic>(dlg, id, wcaption,
@@ -616,8 +615,8 @@ namespace KlayGE
 					}
 					else if (CT_HASH("button") == type_str_hash)
 					{
-						std::string caption = ctrl_node->Attrib("caption")->ValueString();
-						uint8_t hotkey = static_cast<uint8_t>(ctrl_node->AttribInt("hotkey", 0));
+						std::string_view const caption = ctrl_node.Attrib("caption").ValueString();
+						uint8_t hotkey = static_cast<uint8_t>(ctrl_node.AttribInt("hotkey", 0));
 						std::wstring wcaption;
 						Convert(wcaption, caption);
 						dlg->AddControl(MakeSharedPtr<UIButton>(dlg, id, wcaption,
@@ -626,21 +625,21 @@ namespace KlayGE
 					else if (CT_HASH("tex_button") == type_str_hash)
 					{
 						TexturePtr tex;
-						attr = ctrl_node->Attrib("texture");
+						attr = ctrl_node.Attrib("texture");
 						if (attr)
 						{
-							std::string tex_name = attr->ValueString();
+							std::string const tex_name(attr.ValueString());
 							tex = SyncLoadTexture(tex_name, EAH_GPU_Read | EAH_Immutable);
 						}
-						uint8_t hotkey = static_cast<uint8_t>(ctrl_node->AttribInt("hotkey", 0));
+						uint8_t hotkey = static_cast<uint8_t>(ctrl_node.AttribInt("hotkey", 0));
 						dlg->AddControl(MakeSharedPtr<UITexButton>(dlg, id, tex,
 							int4(x, y, width, height), hotkey, is_default));
 					}
 					else if (CT_HASH("check_box") == type_str_hash)
 					{
-						std::string caption = ctrl_node->Attrib("caption")->ValueString();
+						std::string_view const caption = ctrl_node.Attrib("caption").ValueString();
 						bool checked = ReadBool(ctrl_node, "checked", false);
-						uint8_t hotkey = static_cast<uint8_t>(ctrl_node->AttribInt("hotkey", 0));
+						uint8_t hotkey = static_cast<uint8_t>(ctrl_node.AttribInt("hotkey", 0));
 						std::wstring wcaption;
 						Convert(wcaption, caption);
 						dlg->AddControl(MakeSharedPtr<UICheckBox>(dlg, id, wcaption,
@@ -648,10 +647,10 @@ namespace KlayGE
 					}
 					else if (CT_HASH("radio_button") == type_str_hash)
 					{
-						std::string caption = ctrl_node->Attrib("caption")->ValueString();
-						int32_t button_group = ctrl_node->Attrib("button_group")->ValueInt();
+						std::string_view const caption = ctrl_node.Attrib("caption").ValueString();
+						int32_t button_group = ctrl_node.Attrib("button_group").ValueInt();
 						bool checked = ReadBool(ctrl_node, "checked", false);
-						uint8_t hotkey = static_cast<uint8_t>(ctrl_node->AttribInt("hotkey", 0));
+						uint8_t hotkey = static_cast<uint8_t>(ctrl_node.AttribInt("hotkey", 0));
 						std::wstring wcaption;
 						Convert(wcaption, caption);
 						dlg->AddControl(MakeSharedPtr<UIRadioButton>(dlg, id, button_group, wcaption,
@@ -659,28 +658,28 @@ namespace KlayGE
 					}
 					else if (CT_HASH("slider") == type_str_hash)
 					{
-						int32_t min_v = ctrl_node->AttribInt("min", 0);
-						int32_t max_v = ctrl_node->AttribInt("max", 100);
-						int32_t value = ctrl_node->AttribInt("value", 50);
+						int32_t min_v = ctrl_node.AttribInt("min", 0);
+						int32_t max_v = ctrl_node.AttribInt("max", 100);
+						int32_t value = ctrl_node.AttribInt("value", 50);
 						dlg->AddControl(MakeSharedPtr<UISlider>(dlg, id,
 							int4(x, y, width, height), min_v, max_v, value, is_default));
 					}
 					else if (CT_HASH("scroll_bar") == type_str_hash)
 					{
-						int32_t track_start = ctrl_node->AttribInt("track_start", 0);
-						int32_t track_end = ctrl_node->AttribInt("track_end", 1);
-						int32_t track_pos = ctrl_node->AttribInt("track_pos", 1);
-						int32_t page_size = ctrl_node->AttribInt("page_size", 1);
+						int32_t track_start = ctrl_node.AttribInt("track_start", 0);
+						int32_t track_end = ctrl_node.AttribInt("track_end", 1);
+						int32_t track_pos = ctrl_node.AttribInt("track_pos", 1);
+						int32_t page_size = ctrl_node.AttribInt("page_size", 1);
 						dlg->AddControl(MakeSharedPtr<UIScrollBar>(dlg, id,
 							int4(x, y, width, height), track_start, track_end, track_pos, page_size));
 					}
 					else if (CT_HASH("list_box") == type_str_hash)
 					{
 						UIListBox::STYLE style = UIListBox::SINGLE_SELECTION;
-						attr = ctrl_node->Attrib("style");
+						attr = ctrl_node.Attrib("style");
 						if (attr)
 						{
-							std::string const & style_str = attr->ValueString();
+							std::string_view const style_str = attr.ValueString();
 							if ("single" == style_str)
 							{
 								style = UIListBox::SINGLE_SELECTION;
@@ -694,43 +693,43 @@ namespace KlayGE
 						dlg->AddControl(MakeSharedPtr<UIListBox>(dlg, id,
 							int4(x, y, width, height), style ? UIListBox::SINGLE_SELECTION : UIListBox::MULTI_SELECTION));
 
-						for (XMLNodePtr item_node = ctrl_node->FirstNode("item"); item_node; item_node = item_node->NextSibling("item"))
+						for (XMLNodeView item_node = ctrl_node.FirstNode("item"); item_node; item_node = item_node.NextSibling("item"))
 						{
-							std::string caption = item_node->Attrib("name")->ValueString();
+							std::string_view const caption = item_node.Attrib("name").ValueString();
 							std::wstring wcaption;
 							Convert(wcaption, caption);
 							dlg->Control<UIListBox>(id)->AddItem(wcaption);
 						}
 
-						attr = ctrl_node->Attrib("selected");
+						attr = ctrl_node.Attrib("selected");
 						if (attr)
 						{
-							dlg->Control<UIListBox>(id)->SelectItem(attr->ValueInt());
+							dlg->Control<UIListBox>(id)->SelectItem(attr.ValueInt());
 						}
 					}
 					else if (CT_HASH("combo_box") == type_str_hash)
 					{
-						uint8_t hotkey = static_cast<uint8_t>(ctrl_node->AttribInt("hotkey", 0));
+						uint8_t hotkey = static_cast<uint8_t>(ctrl_node.AttribInt("hotkey", 0));
 						dlg->AddControl(MakeSharedPtr<UIComboBox>(dlg, id,
 							int4(x, y, width, height), hotkey, is_default));
 
-						for (XMLNodePtr item_node = ctrl_node->FirstNode("item"); item_node; item_node = item_node->NextSibling("item"))
+						for (XMLNodeView item_node = ctrl_node.FirstNode("item"); item_node; item_node = item_node.NextSibling("item"))
 						{
-							std::string caption = item_node->Attrib("name")->ValueString();
+							std::string_view const caption = item_node.Attrib("name").ValueString();
 							std::wstring wcaption;
 							Convert(wcaption, caption);
 							dlg->Control<UIComboBox>(id)->AddItem(wcaption);
 						}
 
-						attr = ctrl_node->Attrib("selected");
+						attr = ctrl_node.Attrib("selected");
 						if (attr)
 						{
-							dlg->Control<UIComboBox>(id)->SetSelectedByIndex(attr->ValueInt());
+							dlg->Control<UIComboBox>(id)->SetSelectedByIndex(attr.ValueInt());
 						}
 					}
 					else if (CT_HASH("edit_box") == type_str_hash)
 					{
-						std::string caption = ctrl_node->Attrib("caption")->ValueString();
+						std::string_view const caption = ctrl_node.Attrib("caption").ValueString();
 						std::wstring wcaption;
 						Convert(wcaption, caption);
 						dlg->AddControl(MakeSharedPtr<UIEditBox>(dlg, id, wcaption,
@@ -739,17 +738,17 @@ namespace KlayGE
 					else if (CT_HASH("polyline_edit_box") == type_str_hash)
 					{
 						Color line_clr(0, 1, 0, 1);
-						line_clr.r() = ctrl_node->AttribFloat("line_r", 0);
-						line_clr.g() = ctrl_node->AttribFloat("line_g", 1);
-						line_clr.b() = ctrl_node->AttribFloat("line_b", 0);
-						line_clr.a() = ctrl_node->AttribFloat("line_a", 1);
+						line_clr.r() = ctrl_node.AttribFloat("line_r", 0);
+						line_clr.g() = ctrl_node.AttribFloat("line_g", 1);
+						line_clr.b() = ctrl_node.AttribFloat("line_b", 0);
+						line_clr.a() = ctrl_node.AttribFloat("line_a", 1);
 						dlg->AddControl(MakeSharedPtr<UIPolylineEditBox>(dlg, id,
 							int4(x, y, width, height), is_default));
 						dlg->Control<UIPolylineEditBox>(id)->SetColor(line_clr);
 					}
 					else if (CT_HASH("progress_bar") == type_str_hash)
 					{
-						int32_t progress = ctrl_node->AttribInt("value", 0);
+						int32_t progress = ctrl_node.AttribInt("value", 0);
 						dlg->AddControl(MakeSharedPtr<UIProgressBar>(dlg, id, progress,
 							int4(x, y, width, height), is_default));
 					}
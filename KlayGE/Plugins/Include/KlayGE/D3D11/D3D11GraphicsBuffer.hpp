@@ -46,6 +46,7 @@ namespace KlayGE
 
 		virtual void CreateHWResource(void const * init_data) override;
 		virtual void DeleteHWResource() override;
+		virtual bool HWResourceReady() const override;
 
 		void UpdateSubresource(uint32_t offset, uint32_t size, void const * data) override;
 
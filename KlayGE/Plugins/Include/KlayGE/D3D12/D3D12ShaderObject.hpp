@@ -208,7 +208,8 @@ namespace KlayGE
 		{
 			RenderEffectParameter* param;
 			uint32_t offset;
-			std::function<void()> func;
+			// Returns false if the binding is skipped because the parameter hasn't changed
+			std::function<bool()> func;
 		};
 
 	public:
@@ -34,7 +34,7 @@
 #pragma once
 
 #include <KlayGE/PreDeclare.hpp>
-#include <KFL/Thread.hpp>
+#include <KFL/Timer.hpp>
 
 #include <vector>
 #include <windows.h>
@@ -107,28 +107,23 @@ namespace KlayGE
 		void Direction(float3 const & v) override;
 
 	private:
-		void LoopUpdateBuffer();
-
 		void DoReset() override;
 		void DoPlay(bool loop) override;
 		void DoStop() override;
 
-		bool FillData(uint32_t size);
+		uint32_t FreeRefillSlots() override;
+		bool Starved() override;
+		void SubmitRefill(uint8_t const * data, uint32_t size) override;
+		void EndOfStream() override;
+
+		void FillData(uint8_t const * data, uint32_t size);
 
 	private:
 		IDSBufferPtr buffer_;
-		uint32_t fill_size_;
 		uint32_t fill_count_;
+		Timer fill_timer_;
 
 		std::shared_ptr<IDirectSound3DBuffer> ds_3d_buffer_;
-
-		bool loop_;
-
-		bool played_;
-		bool stopped_;
-		std::condition_variable play_cond_;
-		std::mutex play_mutex_;
-		joiner<void> play_thread_;
 	};
 
 	class DSAudioEngine : public AudioEngine
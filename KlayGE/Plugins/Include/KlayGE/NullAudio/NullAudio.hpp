@@ -34,6 +34,10 @@
 #pragma once
 
 #include <KlayGE/PreDeclare.hpp>
+#include <KFL/Timer.hpp>
+
+#include <deque>
+#include <mutex>
 
 #include <KlayGE/Audio.hpp>
 
@@ -90,10 +94,26 @@ namespace KlayGE
 		void DoPlay(bool loop) override;
 		void DoStop() override;
 
+		uint32_t FreeRefillSlots() override;
+		bool Starved() override;
+		void SubmitRefill(uint8_t const * data, uint32_t size) override;
+		void EndOfStream() override;
+
+		void Consume() const;
+
 	private:
 		float3 pos_;
 		float3 vel_;
 		float3 dir_;
+
+		// A simulated device queue, advanced lazily from const queries too
+		uint32_t num_slots_;
+		mutable std::deque<uint32_t> queued_;
+		mutable double pending_bytes_;
+		mutable Timer play_timer_;
+		bool playing_;
+		bool ended_;
+		mutable std::mutex device_mutex_;
 	};
 
 	class NullAudioEngine : public AudioEngine
@@ -0,0 +1,65 @@
+/**
+ * @file NullGraphicsBuffer.hpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#ifndef KLAYGE_PLUGINS_NULL_GRAPHICS_BUFFER_HPP
+#define KLAYGE_PLUGINS_NULL_GRAPHICS_BUFFER_HPP
+
+#pragma once
+
+#include <vector>
+
+#include <KlayGE/GraphicsBuffer.hpp>
+
+namespace KlayGE
+{
+	// Backed by system memory, so mapping, updating and copying behave like a real buffer without a device
+	class NullGraphicsBuffer : public GraphicsBuffer
+	{
+	public:
+		NullGraphicsBuffer(BufferUsage usage, uint32_t access_hint, uint32_t size_in_byte);
+
+		void CopyToBuffer(GraphicsBuffer& target) override;
+
+		void CreateHWResource(void const * init_data) override;
+		void DeleteHWResource() override;
+		bool HWResourceReady() const override;
+
+		void UpdateSubresource(uint32_t offset, uint32_t size, void const * data) override;
+
+	private:
+		void* Map(BufferAccess ba) override;
+		void Unmap() override;
+
+	private:
+		std::vector<uint8_t> data_;
+	};
+}
+
+#endif			// KLAYGE_PLUGINS_NULL_GRAPHICS_BUFFER_HPP
@@ -108,7 +108,10 @@ namespace KlayGE
 		void DoSuspend() override;
 		void DoResume() override;
 
+		void BindPasses(RenderEffect const & effect, RenderTechnique const & tech);
+
 		void FillRenderDeviceCaps();
+		void FillHeadlessDeviceCaps();
 
 		bool VertexFormatSupport(ElementFormat elem_fmt);
 		bool TextureFormatSupport(ElementFormat elem_fmt);
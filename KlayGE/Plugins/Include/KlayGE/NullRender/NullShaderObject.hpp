@@ -184,13 +184,24 @@ namespace KlayGE
 		void OGLESAttachShader(ShaderType type, RenderEffect const & effect,
 			RenderTechnique const & tech, RenderPass const & pass, ShaderObjectPtr const & shared_so);
 
+		void AttachParameterBinds(RenderEffect const & effect);
+
 		std::shared_ptr<std::vector<uint8_t>> D3D11CompiteToBytecode(ShaderType type, RenderEffect const & effect,
 			RenderTechnique const & tech, RenderPass const & pass, std::array<uint32_t, ST_NumShaderTypes> const & shader_desc_ids);
 		void D3D11AttachShaderBytecode(ShaderType type, RenderEffect const & effect,
 			std::array<uint32_t, ST_NumShaderTypes> const & shader_desc_ids, std::shared_ptr<std::vector<uint8_t>> const & code_blob);
+	private:
+		struct ParameterBind
+		{
+			RenderEffectParameter* param;
+			uint32_t version;
+		};
+
 	private:
 		std::shared_ptr<NullShaderObjectTemplate> so_template_;
 
+		std::vector<ParameterBind> param_binds_;
+
 		std::vector<std::tuple<std::string, RenderEffectParameter*, RenderEffectParameter*, uint32_t>> gl_tex_sampler_binds_;
 	};
 }
@@ -33,6 +33,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include <KlayGE/Texture.hpp>
 
 namespace KlayGE
@@ -40,7 +42,8 @@ namespace KlayGE
 	class NullTexture : public Texture
 	{
 	public:
-		NullTexture(TextureType type, uint32_t sample_count, uint32_t sample_quality, uint32_t access_hint);
+		NullTexture(TextureType type, uint32_t width, uint32_t height, uint32_t depth, uint32_t num_mip_maps, uint32_t array_size,
+			ElementFormat format, uint32_t sample_count, uint32_t sample_quality, uint32_t access_hint);
 		~NullTexture() override;
 
 		std::wstring const & Name() const override;
@@ -107,6 +110,17 @@ namespace KlayGE
 		void UpdateSubresourceCube(uint32_t array_index, CubeFaces face, uint32_t level,
 			uint32_t x_offset, uint32_t y_offset, uint32_t width, uint32_t height,
 			void const * data, uint32_t row_pitch) override;
+
+	private:
+		void* MapScratch(uint32_t width, uint32_t height, uint32_t depth, uint32_t& row_pitch, uint32_t& slice_pitch);
+
+	private:
+		uint32_t width_;
+		uint32_t height_;
+		uint32_t depth_;
+
+		// Mapping hands out CPU scratch memory so loaders and readbacks keep working without a device
+		std::vector<uint8_t> mapped_data_;
 	};
 }
 
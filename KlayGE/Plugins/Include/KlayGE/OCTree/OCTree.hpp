@@ -30,6 +30,7 @@
 #include <KFL/AABBox.hpp>
 
 #include <vector>
+#include <unordered_map>
 
 namespace KlayGE
 {
@@ -55,9 +56,24 @@ namespace KlayGE
 		virtual void DoSuspend() override;
 		virtual void DoResume() override;
 
-		void DivideNode(size_t index, uint32_t curr_depth);
-		void NodeVisible(size_t index);
-		void MarkNodeObjs(size_t index, bool force);
+		// Cell an object falls into. Depth 0 is the root, x/y/z index the cells on that level.
+		struct CellLocation
+		{
+			uint32_t depth;
+			uint32_t x, y, z;
+		};
+
+		bool InTree(uint32_t attr, bool has_parent) const;
+		void RebuildTree();
+		CellLocation ObjectCell(AABBox const & aabb) const;
+		int CellNode(CellLocation const & cell);
+		void DivideNode(size_t index);
+		void RelocateObject(SceneObject* so);
+		void RemoveObject(SceneObject* so);
+		bool AreaVisible(AABBox const & aabb, float3 const & view_dir, float3 const & eye_pos, float4x4 const & view_proj) const;
+		void NodeVisible(size_t index, BoundOverlap vis, float3 const & view_dir, float3 const & eye_pos,
+			float4x4 const & view_proj);
+		void MarkNodeObjs(size_t index, float3 const & view_dir, float3 const & eye_pos, float4x4 const & view_proj);
 
 		BoundOverlap BoundVisible(size_t index, AABBox const & aabb) const;
 		BoundOverlap BoundVisible(size_t index, OBBox const & obb) const;
@@ -69,6 +85,8 @@ namespace KlayGE
 		OCTree& operator=(OCTree const & rhs);
 
 	private:
+		// A loose octree. Each node's bound is twice the size of its cell, so every object sits in exactly one node,
+		//  picked by its size and center, and moving objects only change nodes when they leave that bound.
 		struct octree_node_t
 		{
 			AABBox bb;
@@ -79,6 +97,10 @@ namespace KlayGE
 		};
 
 		std::vector<octree_node_t> octree_;
+		std::unordered_map<SceneObject*, int> obj_node_indices_;
+		float3 root_center_;
+		float root_half_size_;
+		size_t num_root_objs_after_rebuild_;
 
 		uint32_t max_tree_depth_;
 
@@ -34,7 +34,6 @@
 #pragma once
 
 #include <KlayGE/PreDeclare.hpp>
-#include <KFL/Thread.hpp>
 
 #ifdef KLAYGE_PLATFORM_WINDOWS
 #include <al.h>
@@ -107,24 +106,21 @@ namespace KlayGE
 		float3 Direction() const override;
 		void Direction(float3 const & v) override;
 
-		void LoopUpdateBuffer();
-
 	private:
 		void DoReset() override;
 		void DoPlay(bool loop) override;
 		void DoStop() override;
 
+		uint32_t FreeRefillSlots() override;
+		bool Starved() override;
+		void SubmitRefill(uint8_t const * data, uint32_t size) override;
+		void EndOfStream() override;
+		void ResumeIfStarved() override;
+
 	private:
 		ALuint source_;
 		std::vector<ALuint> buffer_queue_;
-
-		bool loop_;
-
-		bool played_;
-		bool stopped_;
-		std::condition_variable play_cond_;
-		std::mutex play_mutex_;
-		joiner<void> play_thread_;
+		std::vector<ALuint> free_buffers_;
 	};
 
 	class OALAudioEngine : public AudioEngine
@@ -87,7 +87,8 @@ namespace KlayGE
 			RenderEffectParameter* param;
 			int location;
 			int tex_sampler_bind_index;
-			std::function<void()> func;
+			// Returns false if the binding is skipped because the parameters haven't changed
+			std::function<bool()> func;
 		};
 
 		void AttachGLSL(uint32_t type);
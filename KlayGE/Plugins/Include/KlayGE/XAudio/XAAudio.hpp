@@ -34,7 +34,6 @@
 #pragma once
 
 #include <KlayGE/PreDeclare.hpp>
-#include <KFL/Thread.hpp>
 
 #include <vector>
 #include <windows.h>
@@ -118,30 +117,21 @@ namespace KlayGE
 		void Direction(float3 const & v) override;
 
 	private:
-		void LoopUpdateBuffer();
-
 		void DoReset() override;
 		void DoPlay(bool loop) override;
-		void DoStop();
+		void DoStop() override;
 
-		bool FillData(uint32_t size);
+		uint32_t FreeRefillSlots() override;
+		bool Starved() override;
+		void SubmitRefill(uint8_t const * data, uint32_t size) override;
+		void EndOfStream() override;
 
 	private:
 		IXAudio2SourceVoicePtr source_voice_;
-		std::unique_ptr<IXAudio2VoiceCallback> voice_call_back_;
 		std::vector<uint8_t> audio_data_;
-		uint32_t buffer_size_;
 		uint32_t buffer_count_;
 		uint32_t curr_buffer_index_;
 
-		bool loop_;
-
-		bool played_;
-		bool stopped_;
-		std::condition_variable play_cond_;
-		std::mutex play_mutex_;
-		joiner<void> play_thread_;
-
 		X3DAUDIO_EMITTER emitter_;
 		X3DAUDIO_DSP_SETTINGS dsp_settings_;
 		std::vector<float> output_matrix_;
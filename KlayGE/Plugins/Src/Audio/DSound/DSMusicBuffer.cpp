@@ -44,11 +44,9 @@
 namespace KlayGE
 {
 	DSMusicBuffer::DSMusicBuffer(AudioDataSourcePtr const & data_source, uint32_t buffer_seconds, float volume)
-					: MusicBuffer(data_source),
-						played_(false), stopped_(true)
+					: MusicBuffer(data_source)
 	{
 		WAVEFORMATEX wfx = WaveFormatEx(data_source);
-		fill_size_ = wfx.nAvgBytesPerSec / BUFFERS_PER_SECOND;
 		fill_count_	= buffer_seconds * BUFFERS_PER_SECOND;
 
 		bool const mono = (1 == wfx.nChannels);
@@ -62,7 +60,7 @@ namespace KlayGE
 		{
 			dsbd.dwFlags |= DSBCAPS_CTRL3D | DSBCAPS_MUTE3DATMAXDISTANCE;
 		}
-		dsbd.dwBufferBytes = fill_size_ * fill_count_;
+		dsbd.dwBufferBytes = refill_size_ * fill_count_;
 		dsbd.lpwfxFormat = &wfx;
 
 		IDirectSoundBuffer* buffer;
@@ -90,42 +88,6 @@ namespace KlayGE
 		this->Stop();
 	}
 
-	void DSMusicBuffer::LoopUpdateBuffer()
-	{
-		std::unique_lock<std::mutex> lock(play_mutex_);
-		while (!played_)
-		{
-			play_cond_.wait(lock);
-		}
-		played_ = false;
-
-		while (!stopped_)
-		{
-			DWORD play_cursor, write_cursor;
-			buffer_->GetCurrentPosition(&play_cursor, &write_cursor);
-
-			uint32_t const next_cursor = play_cursor + fill_size_;
-			if (next_cursor >= write_cursor)
-			{
-				if (this->FillData(fill_size_))
-				{
-					if (loop_)
-					{
-						stopped_ = false;
-						this->DoReset();
-					}
-					else
-					{
-						stopped_ = true;
-						buffer_->Stop();
-					}
-				}
-			}
-
-			Sleep(1000 / BUFFERS_PER_SECOND);
-		}
-	}
-
 	void DSMusicBuffer::DoReset()
 	{
 		data_source_->Reset();
@@ -135,75 +97,74 @@ namespace KlayGE
 
 	void DSMusicBuffer::DoPlay(bool loop)
 	{
-		play_thread_ = Context::Instance().ThreadPool()(std::bind(&DSMusicBuffer::LoopUpdateBuffer, this));
-
-		loop_ = loop;
-
-		stopped_ = false;
-		{
-			std::lock_guard<std::mutex> lock(play_mutex_);
-			played_ = true;
-		}
-		play_cond_.notify_one();
+		KFL_UNUSED(loop);
 
 		buffer_->Play(0, 0, DSBPLAY_LOOPING);
 	}
 
 	void DSMusicBuffer::DoStop()
 	{
-		if (!stopped_)
+		buffer_->Stop();
+	}
+
+	uint32_t DSMusicBuffer::FreeRefillSlots()
+	{
+		// Refills are written at the write cursor, one per refill period once playing
+		if (this->IsPlaying() && (fill_timer_.elapsed() < 1.0 / BUFFERS_PER_SECOND))
 		{
-			stopped_ = true;
-			play_thread_();
+			return 0;
 		}
 
-		buffer_->Stop();
+		DWORD play_cursor, write_cursor;
+		buffer_->GetCurrentPosition(&play_cursor, &write_cursor);
+		return (play_cursor + refill_size_ >= write_cursor) ? 1 : 0;
+	}
+
+	bool DSMusicBuffer::Starved()
+	{
+		// A looping DirectSound buffer never runs dry, it replays stale data instead. Nothing to detect here.
+		return false;
 	}
 
-	bool DSMusicBuffer::FillData(uint32_t size)
+	void DSMusicBuffer::SubmitRefill(uint8_t const * data, uint32_t size)
 	{
-		std::vector<uint8_t> data(size);
-		data.resize(data_source_->Read(data.data(), size));
+		this->FillData(data, size);
+	}
 
+	void DSMusicBuffer::EndOfStream()
+	{
+		this->FillData(nullptr, 0);
+		buffer_->Stop();
+	}
+
+	void DSMusicBuffer::FillData(uint8_t const * data, uint32_t size)
+	{
 		uint8_t* locked_buff[2];
 		DWORD locked_buff_size[2];
-		TIFHR(buffer_->Lock(0, size,
+		TIFHR(buffer_->Lock(0, refill_size_,
 			reinterpret_cast<void**>(&locked_buff[0]), &locked_buff_size[0],
 			reinterpret_cast<void**>(&locked_buff[1]), &locked_buff_size[1],
 			DSBLOCK_FROMWRITECURSOR));
 
-		bool ret;
-		if (data.empty())
+		// Copy what was decoded and pad the rest of the locked range with silence
+		for (int i = 0; i < 2; ++ i)
 		{
-			memset(locked_buff[0], 0, locked_buff_size[0]);
-			if (locked_buff[1] != nullptr)
+			if (locked_buff[i] != nullptr)
 			{
-				memset(locked_buff[1], 0, locked_buff_size[1]);
-			}
-
-			ret = true;
-		}
-		else
-		{
-			memcpy(locked_buff[0], &data[0], locked_buff_size[0]);
-			if (locked_buff_size[0] > data.size())
-			{
-				memset(locked_buff[0], 0, locked_buff_size[0] - data.size());
-			}
-			if (locked_buff[1] != nullptr)
-			{
-				memcpy(locked_buff[1], &data[locked_buff_size[0]], locked_buff_size[1]);
-				if (locked_buff_size[1] > data.size() - locked_buff_size[0])
+				uint32_t const copy_size = std::min<uint32_t>(size, locked_buff_size[i]);
+				if (copy_size > 0)
 				{
-					memset(locked_buff[1], 0, locked_buff_size[1] - data.size() + locked_buff_size[0]);
+					memcpy(locked_buff[i], data, copy_size);
+					data += copy_size;
+					size -= copy_size;
 				}
+				memset(locked_buff[i] + copy_size, 0, locked_buff_size[i] - copy_size);
 			}
-
-			ret = false;
 		}
 
 		buffer_->Unlock(locked_buff[0], locked_buff_size[0], locked_buff[1], locked_buff_size[1]);
-		return ret;
+
+		fill_timer_.restart();
 	}
 
 	bool DSMusicBuffer::IsPlaying() const
@@ -35,10 +35,10 @@
 namespace KlayGE
 {
 	NullMusicBuffer::NullMusicBuffer(AudioDataSourcePtr const & data_source, uint32_t buffer_seconds, float volume)
-					: MusicBuffer(data_source)
+					: MusicBuffer(data_source),
+						num_slots_(buffer_seconds * BUFFERS_PER_SECOND),
+						pending_bytes_(0), playing_(false), ended_(false)
 	{
-		KFL_UNUSED(buffer_seconds);
-
 		this->Position(float3::Zero());
 		this->Velocity(float3::Zero());
 		this->Direction(float3::Zero());
@@ -56,20 +56,84 @@ namespace KlayGE
 	void NullMusicBuffer::DoReset()
 	{
 		data_source_->Reset();
+
+		std::lock_guard<std::mutex> lock(device_mutex_);
+		queued_.clear();
+		ended_ = false;
 	}
 
 	void NullMusicBuffer::DoPlay(bool loop)
 	{
 		KFL_UNUSED(loop);
+
+		// ended_ is left alone, a short source can reach its end while the queue is primed before playback starts
+		std::lock_guard<std::mutex> lock(device_mutex_);
+		playing_ = true;
+		pending_bytes_ = 0;
+		play_timer_.restart();
 	}
 
 	void NullMusicBuffer::DoStop()
 	{
+		std::lock_guard<std::mutex> lock(device_mutex_);
+		playing_ = false;
+		queued_.clear();
+		ended_ = false;
+	}
+
+	uint32_t NullMusicBuffer::FreeRefillSlots()
+	{
+		std::lock_guard<std::mutex> lock(device_mutex_);
+		this->Consume();
+		return num_slots_ - static_cast<uint32_t>(queued_.size());
+	}
+
+	bool NullMusicBuffer::Starved()
+	{
+		std::lock_guard<std::mutex> lock(device_mutex_);
+		this->Consume();
+		return playing_ && queued_.empty();
+	}
+
+	void NullMusicBuffer::SubmitRefill(uint8_t const * data, uint32_t size)
+	{
+		KFL_UNUSED(data);
+
+		std::lock_guard<std::mutex> lock(device_mutex_);
+		this->Consume();
+		queued_.push_back(size);
+	}
+
+	void NullMusicBuffer::EndOfStream()
+	{
+		std::lock_guard<std::mutex> lock(device_mutex_);
+		ended_ = true;
+	}
+
+	// Plays the queued refills back in real time, as a device would
+	void NullMusicBuffer::Consume() const
+	{
+		if (playing_)
+		{
+			pending_bytes_ += play_timer_.elapsed() * refill_size_ * BUFFERS_PER_SECOND;
+			while (!queued_.empty() && (pending_bytes_ >= queued_.front()))
+			{
+				pending_bytes_ -= queued_.front();
+				queued_.pop_front();
+			}
+			if (queued_.empty())
+			{
+				pending_bytes_ = 0;
+			}
+		}
+		play_timer_.restart();
 	}
 
 	bool NullMusicBuffer::IsPlaying() const
 	{
-		return false;
+		std::lock_guard<std::mutex> lock(device_mutex_);
+		this->Consume();
+		return playing_ && !(ended_ && queued_.empty());
 	}
 
 	void NullMusicBuffer::Volume(float vol)
@@ -34,14 +34,11 @@
 
 #include <KlayGE/OpenAL/OALAudio.hpp>
 
-size_t constexpr READ_SIZE = 88200;
-
 namespace KlayGE
 {
 	OALMusicBuffer::OALMusicBuffer(AudioDataSourcePtr const & data_source, uint32_t buffer_seconds, float volume)
 							: MusicBuffer(data_source),
-								buffer_queue_(buffer_seconds * BUFFERS_PER_SECOND),
-								played_(false), stopped_(true)
+								buffer_queue_(buffer_seconds * BUFFERS_PER_SECOND)
 	{
 		alGenBuffers(static_cast<ALsizei>(buffer_queue_.size()), buffer_queue_.data());
 
@@ -65,121 +62,93 @@ namespace KlayGE
 		alDeleteSources(1, &source_);
 	}
 
-	void OALMusicBuffer::LoopUpdateBuffer()
+	void OALMusicBuffer::DoReset()
 	{
-		std::unique_lock<std::mutex> lock(play_mutex_);
-		while (!played_)
-		{
-			play_cond_.wait(lock);
-		}
-		played_ = false;
+		alSourceStopv(1, &source_);
 
-		while (!stopped_)
+		ALint queued;
+		alGetSourcei(source_, AL_BUFFERS_QUEUED, &queued);
+		if (queued > 0)
 		{
-			ALint processed;
-			alGetSourcei(source_, AL_BUFFERS_PROCESSED, &processed);
-			if (processed > 0)
-			{
-				while (processed > 0)
-				{
-					-- processed;
-
-					ALuint buf;
-					alSourceUnqueueBuffers(source_, 1, &buf);
-
-					std::vector<uint8_t> data(READ_SIZE);
-					data.resize(data_source_->Read(data.data(), data.size()));
-					if (data.empty())
-					{
-						if (loop_)
-						{
-							stopped_ = false;
-							alSourceStopv(1, &source_);
-							this->DoReset();
-							alSourcePlay(source_);
-						}
-						else
-						{
-							stopped_ = true;
-						}
-					}
-					else
-					{
-						alBufferData(buf, Convert(format_), data.data(), static_cast<ALsizei>(data.size()), freq_);
-						alSourceQueueBuffers(source_, 1, &buf);
-					}
-				}
-			}
-			else
-			{
-				Sleep(1000 / BUFFERS_PER_SECOND);
-			}
+			std::vector<ALuint> cur_queue(queued);
+			alSourceUnqueueBuffers(source_, queued, cur_queue.data());
 		}
+		free_buffers_ = buffer_queue_;
+
+		data_source_->Reset();
+
+		alSourceRewindv(1, &source_);
 	}
 
-	void OALMusicBuffer::DoReset()
+	void OALMusicBuffer::DoPlay(bool loop)
 	{
-		ALint queued_;
-		alGetSourcei(source_, AL_BUFFERS_QUEUED, &queued_);
-		if (queued_ > 0)
-		{
-			std::vector<ALuint> cur_queue(queued_);
-			alSourceUnqueueBuffers(source_, queued_, &cur_queue[0]);
-		}
+		KFL_UNUSED(loop);
 
-		ALenum const format(Convert(format_));
-		std::vector<uint8_t> data(READ_SIZE);
+		alSourcei(source_, AL_LOOPING, false);
+		alSourcePlay(source_);
+	}
 
-		data_source_->Reset();
+	void OALMusicBuffer::DoStop()
+	{
+		alSourceStopv(1, &source_);
+	}
 
-		ALsizei non_empty_buf = 0;
-		// Load 1 / BUFFERS_PER_SECOND second data to each buffer
-		for (auto const & buf : buffer_queue_)
+	uint32_t OALMusicBuffer::FreeRefillSlots()
+	{
+		// Take back every buffer the source is done with. Once the source stops, that is all of them,
+		// so nothing stale is left in the queue when it restarts.
+		ALint processed;
+		alGetSourcei(source_, AL_BUFFERS_PROCESSED, &processed);
+		if (processed > 0)
 		{
-			data.resize(data_source_->Read(data.data(), data.size()));
-			if (data.empty())
-			{
-				break;
-			}
-			else
+			size_t const num_free = free_buffers_.size();
+			free_buffers_.resize(num_free + processed);
+
+			alGetError();
+			alSourceUnqueueBuffers(source_, processed, &free_buffers_[num_free]);
+			if (alGetError() != AL_NO_ERROR)
 			{
-				++ non_empty_buf;
-				alBufferData(buf, format, data.data(),
-					static_cast<ALuint>(data.size()), static_cast<ALuint>(freq_));
+				free_buffers_.resize(num_free);
 			}
 		}
 
-		alSourceQueueBuffers(source_, non_empty_buf, buffer_queue_.data());
-
-		alSourceRewindv(1, &source_);
+		return static_cast<uint32_t>(free_buffers_.size());
 	}
 
-	void OALMusicBuffer::DoPlay(bool loop)
+	bool OALMusicBuffer::Starved()
 	{
-		play_thread_ = Context::Instance().ThreadPool()(std::bind(&OALMusicBuffer::LoopUpdateBuffer, this));
+		ALint state;
+		alGetSourcei(source_, AL_SOURCE_STATE, &state);
+		return (AL_STOPPED == state);
+	}
 
-		loop_ = loop;
+	void OALMusicBuffer::SubmitRefill(uint8_t const * data, uint32_t size)
+	{
+		BOOST_ASSERT(!free_buffers_.empty());
 
-		stopped_ = false;
-		{
-			std::lock_guard<std::mutex> lock(play_mutex_);
-			played_ = true;
-		}
-		play_cond_.notify_one();
+		ALuint const buf = free_buffers_.back();
+		free_buffers_.pop_back();
 
-		alSourcei(source_, AL_LOOPING, false);
-		alSourcePlay(source_);
+		alBufferData(buf, Convert(format_), data, static_cast<ALsizei>(size), static_cast<ALsizei>(freq_));
+		alSourceQueueBuffers(source_, 1, &buf);
 	}
 
-	void OALMusicBuffer::DoStop()
+	void OALMusicBuffer::ResumeIfStarved()
 	{
-		if (!stopped_)
+		// A source that ran dry stops by itself. Restart it once the refills are all queued.
+		if (this->Starved())
 		{
-			stopped_ = true;
-			play_thread_();
+			ALint queued;
+			alGetSourcei(source_, AL_BUFFERS_QUEUED, &queued);
+			if (queued > 0)
+			{
+				alSourcePlay(source_);
+			}
 		}
+	}
 
-		alSourceStopv(1, &source_);
+	void OALMusicBuffer::EndOfStream()
+	{
 	}
 
 	bool OALMusicBuffer::IsPlaying() const
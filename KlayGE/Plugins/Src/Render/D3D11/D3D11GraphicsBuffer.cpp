@@ -215,6 +215,11 @@ namespace KlayGE
 		buffer_.reset();
 	}
 
+	bool D3D11GraphicsBuffer::HWResourceReady() const
+	{
+		return buffer_.get() ? true : false;
+	}
+
 	void* D3D11GraphicsBuffer::Map(BufferAccess ba)
 	{
 		BOOST_ASSERT(buffer_);
@@ -54,12 +54,18 @@ namespace
 	public:
 		SetD3D11ShaderParameterTextureSRV(std::tuple<void*, uint32_t, uint32_t>& srvsrc,
 				ID3D11ShaderResourceView*& srv, RenderEffectParameter* param)
-			: srvsrc_(&srvsrc), srv_(&srv), param_(param)
+			: srvsrc_(&srvsrc), srv_(&srv), param_(param), version_(0)
 		{
 		}
 
-		void operator()()
+		bool operator()()
 		{
+			uint32_t const version = param_->Version();
+			if (version == version_)
+			{
+				return false;
+			}
+
 			TextureSubresource tex_subres;
 			param_->Value(tex_subres);
 			if (tex_subres.tex)
@@ -75,12 +81,17 @@ namespace
 			{
 				std::get<0>(*srvsrc_) = nullptr;
 			}
+
+			// A texture still loading gets its resource later, keep reapplying it until then
+			version_ = (!tex_subres.tex || tex_subres.tex->HWResourceReady()) ? version : 0;
+			return true;
 		}
 
 	private:
 		std::tuple<void*, uint32_t, uint32_t>* srvsrc_;
 		ID3D11ShaderResourceView** srv_;
 		RenderEffectParameter* param_;
+		uint32_t version_;
 	};
 
 	class SetD3D11ShaderParameterGraphicsBufferSRV
@@ -88,12 +99,18 @@ namespace
 	public:
 		SetD3D11ShaderParameterGraphicsBufferSRV(std::tuple<void*, uint32_t, uint32_t>& srvsrc,
 				ID3D11ShaderResourceView*& srv, RenderEffectParameter* param)
-			: srvsrc_(&srvsrc), srv_(&srv), param_(param)
+			: srvsrc_(&srvsrc), srv_(&srv), param_(param), version_(0)
 		{
 		}
 
-		void operator()()
+		bool operator()()
 		{
+			uint32_t const version = param_->Version();
+			if (version == version_)
+			{
+				return false;
+			}
+
 			GraphicsBufferPtr buf;
 			param_->Value(buf);
 			if (buf)
@@ -105,24 +122,35 @@ namespace
 			{
 				std::get<0>(*srvsrc_) = nullptr;
 			}
+
+			// A delay created buffer gets its views later, keep reapplying it until then
+			version_ = (!buf || buf->HWResourceReady()) ? version : 0;
+			return true;
 		}
 
 	private:
 		std::tuple<void*, uint32_t, uint32_t>* srvsrc_;
 		ID3D11ShaderResourceView** srv_;
 		RenderEffectParameter* param_;
+		uint32_t version_;
 	};
 
 	class SetD3D11ShaderParameterTextureUAV
 	{
 	public:
 		SetD3D11ShaderParameterTextureUAV(void*& uavsrc, ID3D11UnorderedAccessView*& uav, RenderEffectParameter* param)
-			: uavsrc_(&uavsrc), uav_(&uav), param_(param)
+			: uavsrc_(&uavsrc), uav_(&uav), param_(param), version_(0)
 		{
 		}
 
-		void operator()()
+		bool operator()()
 		{
+			uint32_t const version = param_->Version();
+			if (version == version_)
+			{
+				return false;
+			}
+
 			TextureSubresource tex_subres;
 			param_->Value(tex_subres);
 			if (tex_subres.tex)
@@ -135,24 +163,34 @@ namespace
 			{
 				*uavsrc_ = nullptr;
 			}
+
+			version_ = (!tex_subres.tex || tex_subres.tex->HWResourceReady()) ? version : 0;
+			return true;
 		}
 
 	private:
 		void** uavsrc_;
 		ID3D11UnorderedAccessView** uav_;
 		RenderEffectParameter* param_;
+		uint32_t version_;
 	};
 
 	class SetD3D11ShaderParameterGraphicsBufferUAV
 	{
 	public:
 		SetD3D11ShaderParameterGraphicsBufferUAV(void*& uavsrc, ID3D11UnorderedAccessView*& uav, RenderEffectParameter* param)
-			: uavsrc_(&uavsrc), uav_(&uav), param_(param)
+			: uavsrc_(&uavsrc), uav_(&uav), param_(param), version_(0)
 		{
 		}
 
-		void operator()()
+		bool operator()()
 		{
+			uint32_t const version = param_->Version();
+			if (version == version_)
+			{
+				return false;
+			}
+
 			GraphicsBufferPtr buf;
 			param_->Value(buf);
 			if (buf)
@@ -164,12 +202,16 @@ namespace
 			{
 				*uavsrc_ = nullptr;
 			}
+
+			version_ = (!buf || buf->HWResourceReady()) ? version : 0;
+			return true;
 		}
 
 	private:
 		void** uavsrc_;
 		ID3D11UnorderedAccessView** uav_;
 		RenderEffectParameter* param_;
+		uint32_t version_;
 	};
 }
 
@@ -1346,13 +1388,23 @@ namespace KlayGE
 		re.HSSetShader(so_template_->hull_shader_.get());
 		re.DSSetShader(so_template_->domain_shader_.get());
 
+		uint32_t num_applied = 0;
+		uint32_t num_skipped = 0;
 		for (auto const & pbs : param_binds_)
 		{
 			for (auto const & pb : pbs)
 			{
-				pb.func();
+				if (pb.func())
+				{
+					++ num_applied;
+				}
+				else
+				{
+					++ num_skipped;
+				}
 			}
 		}
+		re.AddParamBinds(num_applied, num_skipped);
 
 		for (auto cb : all_cbuffs_)
 		{
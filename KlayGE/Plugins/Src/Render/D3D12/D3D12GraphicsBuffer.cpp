@@ -219,6 +219,11 @@ namespace KlayGE
 		d3d_resource_.reset();
 	}
 
+	bool D3D12GraphicsBuffer::HWResourceReady() const
+	{
+		return d3d_resource_.get() ? true : false;
+	}
+
 	void* D3D12GraphicsBuffer::Map(BufferAccess ba)
 	{
 		BOOST_ASSERT(d3d_resource_);
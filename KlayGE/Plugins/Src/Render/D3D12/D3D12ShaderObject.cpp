@@ -70,12 +70,18 @@ namespace
 	public:
 		SetD3D12ShaderParameterTextureSRV(std::tuple<D3D12Resource*, uint32_t, uint32_t>& srvsrc,
 				D3D12ShaderResourceViewSimulation*& srv, RenderEffectParameter* param)
-			: srvsrc_(&srvsrc), srv_(&srv), param_(param)
+			: srvsrc_(&srvsrc), srv_(&srv), param_(param), version_(0)
 		{
 		}
 
-		void operator()()
+		bool operator()()
 		{
+			uint32_t const version = param_->Version();
+			if (version == version_)
+			{
+				return false;
+			}
+
 			TextureSubresource tex_subres;
 			param_->Value(tex_subres);
 			if (tex_subres.tex)
@@ -91,12 +97,17 @@ namespace
 			{
 				std::get<0>(*srvsrc_) = nullptr;
 			}
+
+			// A texture still loading gets its resource later, keep reapplying it until then
+			version_ = (!tex_subres.tex || tex_subres.tex->HWResourceReady()) ? version : 0;
+			return true;
 		}
 
 	private:
 		std::tuple<D3D12Resource*, uint32_t, uint32_t>* srvsrc_;
 		D3D12ShaderResourceViewSimulation** srv_;
 		RenderEffectParameter* param_;
+		uint32_t version_;
 	};
 
 	class SetD3D12ShaderParameterGraphicsBufferSRV
@@ -104,12 +115,18 @@ namespace
 	public:
 		SetD3D12ShaderParameterGraphicsBufferSRV(std::tuple<D3D12Resource*, uint32_t, uint32_t>& srvsrc,
 				D3D12ShaderResourceViewSimulation*& srv, RenderEffectParameter* param)
-			: srvsrc_(&srvsrc), srv_(&srv), param_(param)
+			: srvsrc_(&srvsrc), srv_(&srv), param_(param), version_(0)
 		{
 		}
 
-		void operator()()
+		bool operator()()
 		{
+			uint32_t const version = param_->Version();
+			if (version == version_)
+			{
+				return false;
+			}
+
 			GraphicsBufferPtr buf;
 			param_->Value(buf);
 			if (buf)
@@ -121,12 +138,17 @@ namespace
 			{
 				std::get<0>(*srvsrc_) = nullptr;
 			}
+
+			// A delay created buffer gets its views later, keep reapplying it until then
+			version_ = (!buf || buf->HWResourceReady()) ? version : 0;
+			return true;
 		}
 
 	private:
 		std::tuple<D3D12Resource*, uint32_t, uint32_t>* srvsrc_;
 		D3D12ShaderResourceViewSimulation** srv_;
 		RenderEffectParameter* param_;
+		uint32_t version_;
 	};
 
 	class SetD3D12ShaderParameterTextureUAV
@@ -134,12 +156,18 @@ namespace
 	public:
 		SetD3D12ShaderParameterTextureUAV(std::pair<D3D12Resource*, ID3D12Resource*>& uavsrc,
 				D3D12UnorderedAccessViewSimulation*& uav, RenderEffectParameter* param)
-			: uavsrc_(&uavsrc), uav_(&uav), param_(param)
+			: uavsrc_(&uavsrc), uav_(&uav), param_(param), version_(0)
 		{
 		}
 
-		void operator()()
+		bool operator()()
 		{
+			uint32_t const version = param_->Version();
+			if (version == version_)
+			{
+				return false;
+			}
+
 			TextureSubresource tex_subres;
 			param_->Value(tex_subres);
 			if (tex_subres.tex)
@@ -154,12 +182,16 @@ namespace
 				uavsrc_->first = nullptr;
 				uavsrc_->second = nullptr;
 			}
+
+			version_ = (!tex_subres.tex || tex_subres.tex->HWResourceReady()) ? version : 0;
+			return true;
 		}
 
 	private:
 		std::pair<D3D12Resource*, ID3D12Resource*>* uavsrc_;
 		D3D12UnorderedAccessViewSimulation** uav_;
 		RenderEffectParameter* param_;
+		uint32_t version_;
 	};
 
 	class SetD3D12ShaderParameterGraphicsBufferUAV
@@ -167,12 +199,18 @@ namespace
 	public:
 		SetD3D12ShaderParameterGraphicsBufferUAV(std::pair<D3D12Resource*, ID3D12Resource*>& uavsrc,
 				D3D12UnorderedAccessViewSimulation*& uav, RenderEffectParameter* const & param)
-			: uavsrc_(&uavsrc), uav_(&uav), param_(param)
+			: uavsrc_(&uavsrc), uav_(&uav), param_(param), version_(0)
 		{
 		}
 
-		void operator()()
+		bool operator()()
 		{
+			uint32_t const version = param_->Version();
+			if (version == version_)
+			{
+				return false;
+			}
+
 			GraphicsBufferPtr buf;
 			param_->Value(buf);
 			if (buf)
@@ -186,12 +224,16 @@ namespace
 				uavsrc_->first = nullptr;
 				uavsrc_->second = nullptr;
 			}
+
+			version_ = (!buf || buf->HWResourceReady()) ? version : 0;
+			return true;
 		}
 
 	private:
 		std::pair<D3D12Resource*, ID3D12Resource*>* uavsrc_;
 		D3D12UnorderedAccessViewSimulation** uav_;
 		RenderEffectParameter* param_;
+		uint32_t version_;
 	};
 }
 
@@ -1337,12 +1379,23 @@ namespace KlayGE
 
 	void D3D12ShaderObject::Bind()
 	{
+		auto& re = *checked_cast<D3D12RenderEngine*>(&Context::Instance().RenderFactoryInstance().RenderEngineInstance());
+
+		uint32_t num_applied = 0;
+		uint32_t num_skipped = 0;
 		std::vector<D3D12_RESOURCE_BARRIER> barriers;
 		for (size_t st = 0; st < ST_NumShaderTypes; ++ st)
 		{
 			for (auto const & pb : param_binds_[st])
 			{
-				pb.func();
+				if (pb.func())
+				{
+					++ num_applied;
+				}
+				else
+				{
+					++ num_skipped;
+				}
 			}
 
 			D3D12_RESOURCE_BARRIER barrier;
@@ -1384,9 +1437,10 @@ namespace KlayGE
 				}
 			}
 		}
+		re.AddParamBinds(num_applied, num_skipped);
+
 		if (!barriers.empty())
 		{
-			auto& re = *checked_cast<D3D12RenderEngine*>(&Context::Instance().RenderFactoryInstance().RenderEngineInstance());
 			re.D3DRenderCmdList()->ResourceBarrier(static_cast<UINT>(barriers.size()), &barriers[0]);
 		}
 
@@ -0,0 +1,79 @@
+/**
+ * @file NullFrameBuffer.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+#include <KlayGE/Viewport.hpp>
+
+#include <KlayGE/NullRender/NullFrameBuffer.hpp>
+
+namespace KlayGE
+{
+	NullFrameBuffer::NullFrameBuffer()
+	{
+	}
+
+	NullFrameBuffer::NullFrameBuffer(uint32_t width, uint32_t height)
+	{
+		width_ = width;
+		height_ = height;
+
+		viewport_->left = 0;
+		viewport_->top = 0;
+		viewport_->width = static_cast<int>(width);
+		viewport_->height = static_cast<int>(height);
+	}
+
+	std::wstring const & NullFrameBuffer::Description() const
+	{
+		static std::wstring const desc(L"Null Frame Buffer");
+		return desc;
+	}
+
+	void NullFrameBuffer::Clear(uint32_t flags, Color const & clr, float depth, int32_t stencil)
+	{
+		KFL_UNUSED(flags);
+		KFL_UNUSED(clr);
+		KFL_UNUSED(depth);
+		KFL_UNUSED(stencil);
+	}
+
+	void NullFrameBuffer::Discard(uint32_t flags)
+	{
+		KFL_UNUSED(flags);
+	}
+
+	void NullFrameBuffer::OnBind()
+	{
+	}
+
+	void NullFrameBuffer::OnUnbind()
+	{
+	}
+}
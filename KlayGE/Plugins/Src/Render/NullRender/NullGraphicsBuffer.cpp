@@ -0,0 +1,91 @@
+/**
+ * @file NullGraphicsBuffer.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+
+#include <cstring>
+
+#include <KlayGE/NullRender/NullGraphicsBuffer.hpp>
+
+namespace KlayGE
+{
+	NullGraphicsBuffer::NullGraphicsBuffer(BufferUsage usage, uint32_t access_hint, uint32_t size_in_byte)
+		: GraphicsBuffer(usage, access_hint, size_in_byte)
+	{
+	}
+
+	void NullGraphicsBuffer::CopyToBuffer(GraphicsBuffer& target)
+	{
+		BOOST_ASSERT(this->Size() <= target.Size());
+
+		NullGraphicsBuffer& null_target = *checked_cast<NullGraphicsBuffer*>(&target);
+		if (!data_.empty() && !null_target.data_.empty())
+		{
+			std::memcpy(null_target.data_.data(), data_.data(), this->Size());
+		}
+	}
+
+	void NullGraphicsBuffer::CreateHWResource(void const * init_data)
+	{
+		data_.resize(size_in_byte_);
+		if (init_data != nullptr)
+		{
+			std::memcpy(data_.data(), init_data, size_in_byte_);
+		}
+	}
+
+	void NullGraphicsBuffer::DeleteHWResource()
+	{
+		data_.clear();
+		data_.shrink_to_fit();
+	}
+
+	bool NullGraphicsBuffer::HWResourceReady() const
+	{
+		return data_.size() == size_in_byte_;
+	}
+
+	void NullGraphicsBuffer::UpdateSubresource(uint32_t offset, uint32_t size, void const * data)
+	{
+		BOOST_ASSERT(offset + size <= data_.size());
+		std::memcpy(&data_[offset], data, size);
+	}
+
+	void* NullGraphicsBuffer::Map(BufferAccess ba)
+	{
+		KFL_UNUSED(ba);
+		BOOST_ASSERT(!data_.empty());
+		return data_.data();
+	}
+
+	void NullGraphicsBuffer::Unmap()
+	{
+	}
+}
@@ -31,12 +31,15 @@
 #include <KlayGE/KlayGE.hpp>
 #include <KFL/ErrorHandling.hpp>
 #include <KFL/Hash.hpp>
+#include <KlayGE/RenderEffect.hpp>
 
+#include <KlayGE/NullRender/NullFrameBuffer.hpp>
 #include <KlayGE/NullRender/NullRenderEngine.hpp>
 
 namespace KlayGE
 {
 	NullRenderEngine::NullRenderEngine()
+		: major_version_(0), minor_version_(0), requires_flipping_(false), frag_depth_support_(false)
 	{
 	}
 
@@ -54,7 +57,15 @@ namespace KlayGE
 	void NullRenderEngine::DoCreateRenderWindow(std::string const & name, RenderSettings const & settings)
 	{
 		KFL_UNUSED(name);
-		KFL_UNUSED(settings);
+
+		if (native_shader_platform_name_.empty())
+		{
+			// Not configured by an offline tool, so this is a headless app run. Pretend to be a D3D11 device to pick
+			// up the precompiled d3d_11_0 effects.
+			this->FillHeadlessDeviceCaps();
+		}
+
+		this->BindFrameBuffer(MakeSharedPtr<NullFrameBuffer>(settings.width, settings.height));
 	}
 
 	void NullRenderEngine::ForceFlush()
@@ -184,27 +195,41 @@ namespace KlayGE
 
 	void NullRenderEngine::DoRender(RenderEffect const & effect, RenderTechnique const & tech, RenderLayout const & rl)
 	{
-		KFL_UNUSED(effect);
-		KFL_UNUSED(tech);
 		KFL_UNUSED(rl);
+
+		this->BindPasses(effect, tech);
+		num_draws_just_called_ += tech.NumPasses();
 	}
 
 	void NullRenderEngine::DoDispatch(RenderEffect const & effect, RenderTechnique const & tech, uint32_t tgx, uint32_t tgy, uint32_t tgz)
 	{
-		KFL_UNUSED(effect);
-		KFL_UNUSED(tech);
 		KFL_UNUSED(tgx);
 		KFL_UNUSED(tgy);
 		KFL_UNUSED(tgz);
+
+		this->BindPasses(effect, tech);
+		num_dispatches_just_called_ += tech.NumPasses();
 	}
 
 	void NullRenderEngine::DoDispatchIndirect(RenderEffect const & effect, RenderTechnique const & tech,
 		GraphicsBufferPtr const & buff_args, uint32_t offset)
 	{
-		KFL_UNUSED(effect);
-		KFL_UNUSED(tech);
 		KFL_UNUSED(buff_args);
 		KFL_UNUSED(offset);
+
+		this->BindPasses(effect, tech);
+		num_dispatches_just_called_ += tech.NumPasses();
+	}
+
+	// Goes through the same pass binding as the real plugins, so the shader parameter binding cost shows up headless
+	void NullRenderEngine::BindPasses(RenderEffect const & effect, RenderTechnique const & tech)
+	{
+		for (uint32_t i = 0; i < tech.NumPasses(); ++ i)
+		{
+			auto& pass = tech.Pass(i);
+			pass.Bind(effect);
+			pass.Unbind(effect);
+		}
 	}
 
 	void NullRenderEngine::DoResize(uint32_t width, uint32_t height)
@@ -269,6 +294,70 @@ namespace KlayGE
 		return (iter != uav_format_.end()) && (*iter == elem_fmt);
 	}
 
+	void NullRenderEngine::FillHeadlessDeviceCaps()
+	{
+		std::string platform = "d3d_11_0";
+		this->SetCustomAttrib("PLATFORM", &platform);
+		major_version_ = 11;
+		minor_version_ = 0;
+		requires_flipping_ = true;
+		frag_depth_support_ = true;
+		native_shader_fourcc_ = MakeFourCC<'D', 'X', 'B', 'C'>::value;
+		native_shader_version_ = 5;
+
+		caps_.max_shader_model = ShaderModel(5, 0);
+		caps_.max_texture_width = caps_.max_texture_height = 16384;
+		caps_.max_texture_depth = 2048;
+		caps_.max_texture_cube_size = 16384;
+		caps_.max_texture_array_length = 2048;
+		caps_.max_vertex_texture_units = 16;
+		caps_.max_pixel_texture_units = 16;
+		caps_.max_geometry_texture_units = 16;
+		caps_.max_simultaneous_rts = 8;
+		caps_.max_simultaneous_uavs = 8;
+		caps_.max_vertex_streams = 16;
+		caps_.max_texture_anisotropy = 16;
+		caps_.is_tbdr = false;
+		caps_.hw_instancing_support = true;
+		caps_.instance_id_support = true;
+		caps_.stream_output_support = true;
+		caps_.alpha_to_coverage_support = true;
+		caps_.primitive_restart_support = true;
+		caps_.multithread_rendering_support = true;
+		caps_.multithread_res_creating_support = true;
+		caps_.mrt_independent_bit_depths_support = true;
+		caps_.logic_op_support = false;
+		caps_.independent_blend_support = true;
+		caps_.depth_texture_support = true;
+		caps_.fp_color_support = true;
+		caps_.pack_to_rgba_required = false;
+		caps_.draw_indirect_support = true;
+		caps_.no_overwrite_support = true;
+		caps_.full_npot_texture_support = true;
+		caps_.render_to_texture_array_support = true;
+		caps_.load_from_buffer_support = true;
+		caps_.gs_support = true;
+		caps_.cs_support = true;
+		caps_.hs_support = true;
+		caps_.ds_support = true;
+		caps_.tess_method = TM_Hardware;
+
+		// Nothing is ever sampled or rasterized, so every format is accepted
+		caps_.vertex_format_support = [](ElementFormat elem_fmt)
+			{
+				KFL_UNUSED(elem_fmt);
+				return true;
+			};
+		caps_.texture_format_support = caps_.vertex_format_support;
+		caps_.rendertarget_format_support = [](ElementFormat elem_fmt, uint32_t sample_count, uint32_t sample_quality)
+			{
+				KFL_UNUSED(elem_fmt);
+				KFL_UNUSED(sample_quality);
+				return 1 == sample_count;
+			};
+		caps_.uav_format_support = caps_.vertex_format_support;
+	}
+
 	void NullRenderEngine::FillRenderDeviceCaps()
 	{
 		std::sort(vertex_format_.begin(), vertex_format_.end());
@@ -30,8 +30,14 @@
 
 #include <KlayGE/KlayGE.hpp>
 
+#include <KlayGE/NullRender/NullFence.hpp>
+#include <KlayGE/NullRender/NullFrameBuffer.hpp>
+#include <KlayGE/NullRender/NullGraphicsBuffer.hpp>
+#include <KlayGE/NullRender/NullQuery.hpp>
 #include <KlayGE/NullRender/NullRenderEngine.hpp>
+#include <KlayGE/NullRender/NullRenderLayout.hpp>
 #include <KlayGE/NullRender/NullRenderStateObject.hpp>
+#include <KlayGE/NullRender/NullRenderView.hpp>
 #include <KlayGE/NullRender/NullShaderObject.hpp>
 #include <KlayGE/NullRender/NullTexture.hpp>
 
@@ -53,91 +59,67 @@ namespace KlayGE
 	TexturePtr NullRenderFactory::MakeDelayCreationTexture1D(uint32_t width, uint32_t num_mip_maps, uint32_t array_size,
 			ElementFormat format, uint32_t sample_count, uint32_t sample_quality, uint32_t access_hint)
 	{
-		KFL_UNUSED(width);
-		KFL_UNUSED(num_mip_maps);
-		KFL_UNUSED(array_size);
-		KFL_UNUSED(format);
-		return MakeSharedPtr<NullTexture>(Texture::TT_1D, sample_count, sample_quality, access_hint);
+		return MakeSharedPtr<NullTexture>(Texture::TT_1D, width, 1, 1, num_mip_maps, array_size, format,
+			sample_count, sample_quality, access_hint);
 	}
 	TexturePtr NullRenderFactory::MakeDelayCreationTexture2D(uint32_t width, uint32_t height, uint32_t num_mip_maps, uint32_t array_size,
 			ElementFormat format, uint32_t sample_count, uint32_t sample_quality, uint32_t access_hint)
 	{
-		KFL_UNUSED(width);
-		KFL_UNUSED(height);
-		KFL_UNUSED(num_mip_maps);
-		KFL_UNUSED(array_size);
-		KFL_UNUSED(format);
-		return MakeSharedPtr<NullTexture>(Texture::TT_2D, sample_count, sample_quality, access_hint);
+		return MakeSharedPtr<NullTexture>(Texture::TT_2D, width, height, 1, num_mip_maps, array_size, format,
+			sample_count, sample_quality, access_hint);
 	}
 	TexturePtr NullRenderFactory::MakeDelayCreationTexture3D(uint32_t width, uint32_t height, uint32_t depth, uint32_t num_mip_maps, uint32_t array_size,
 			ElementFormat format, uint32_t sample_count, uint32_t sample_quality, uint32_t access_hint)
 	{
-		KFL_UNUSED(width);
-		KFL_UNUSED(height);
-		KFL_UNUSED(depth);
-		KFL_UNUSED(num_mip_maps);
-		KFL_UNUSED(array_size);
-		KFL_UNUSED(format);
-		return MakeSharedPtr<NullTexture>(Texture::TT_3D, sample_count, sample_quality, access_hint);
+		return MakeSharedPtr<NullTexture>(Texture::TT_3D, width, height, depth, num_mip_maps, array_size, format,
+			sample_count, sample_quality, access_hint);
 	}
 	TexturePtr NullRenderFactory::MakeDelayCreationTextureCube(uint32_t size, uint32_t num_mip_maps, uint32_t array_size,
 			ElementFormat format, uint32_t sample_count, uint32_t sample_quality, uint32_t access_hint)
 	{
-		KFL_UNUSED(size);
-		KFL_UNUSED(num_mip_maps);
-		KFL_UNUSED(array_size);
-		KFL_UNUSED(format);
-		return MakeSharedPtr<NullTexture>(Texture::TT_Cube, sample_count, sample_quality, access_hint);
+		return MakeSharedPtr<NullTexture>(Texture::TT_Cube, size, size, 1, num_mip_maps, array_size, format,
+			sample_count, sample_quality, access_hint);
 	}
 
 	FrameBufferPtr NullRenderFactory::MakeFrameBuffer()
 	{
-		return FrameBufferPtr();
+		return MakeSharedPtr<NullFrameBuffer>();
 	}
 
 	RenderLayoutPtr NullRenderFactory::MakeRenderLayout()
 	{
-		return RenderLayoutPtr();
+		return MakeSharedPtr<NullRenderLayout>();
 	}
 
 	GraphicsBufferPtr NullRenderFactory::MakeDelayCreationVertexBuffer(BufferUsage usage, uint32_t access_hint,
 			uint32_t size_in_byte, ElementFormat fmt)
 	{
-		KFL_UNUSED(usage);
-		KFL_UNUSED(access_hint);
-		KFL_UNUSED(size_in_byte);
 		KFL_UNUSED(fmt);
-		return GraphicsBufferPtr();
+		return MakeSharedPtr<NullGraphicsBuffer>(usage, access_hint, size_in_byte);
 	}
 
 	GraphicsBufferPtr NullRenderFactory::MakeDelayCreationIndexBuffer(BufferUsage usage, uint32_t access_hint,
 			uint32_t size_in_byte, ElementFormat fmt)
 	{
-		KFL_UNUSED(usage);
-		KFL_UNUSED(access_hint);
-		KFL_UNUSED(size_in_byte);
 		KFL_UNUSED(fmt);
-		return GraphicsBufferPtr();
+		return MakeSharedPtr<NullGraphicsBuffer>(usage, access_hint, size_in_byte);
 	}
 
 	GraphicsBufferPtr NullRenderFactory::MakeDelayCreationConstantBuffer(BufferUsage usage, uint32_t access_hint,
 			uint32_t size_in_byte, ElementFormat fmt)
 	{
-		KFL_UNUSED(usage);
-		KFL_UNUSED(access_hint);
-		KFL_UNUSED(size_in_byte);
 		KFL_UNUSED(fmt);
-		return GraphicsBufferPtr();
+		return MakeSharedPtr<NullGraphicsBuffer>(usage, access_hint, size_in_byte);
 	}
 
 	QueryPtr NullRenderFactory::MakeOcclusionQuery()
 	{
-		return QueryPtr();
+		return MakeSharedPtr<NullOcclusionQuery>();
 	}
 
 	QueryPtr NullRenderFactory::MakeConditionalRender()
 	{
-		return QueryPtr();
+		return MakeSharedPtr<NullConditionalRender>();
 	}
 
 	QueryPtr NullRenderFactory::MakeTimerQuery()
@@ -147,202 +129,158 @@ namespace KlayGE
 
 	QueryPtr NullRenderFactory::MakeSOStatisticsQuery()
 	{
-		return QueryPtr();
+		return MakeSharedPtr<NullSOStatisticsQuery>();
 	}
 
 	FencePtr NullRenderFactory::MakeFence()
 	{
-		return FencePtr();
+		return MakeSharedPtr<NullFence>();
 	}
 
 	RenderViewPtr NullRenderFactory::Make1DRenderView(Texture& texture, int first_array_index, int array_size, int level)
 	{
-		KFL_UNUSED(texture);
 		KFL_UNUSED(first_array_index);
 		KFL_UNUSED(array_size);
-		KFL_UNUSED(level);
-		return RenderViewPtr();
+		return MakeSharedPtr<NullRenderView>(texture.Width(level), texture.Height(level), texture.Format());
 	}
 
 	RenderViewPtr NullRenderFactory::Make2DRenderView(Texture& texture, int first_array_index, int array_size, int level)
 	{
-		KFL_UNUSED(texture);
 		KFL_UNUSED(first_array_index);
 		KFL_UNUSED(array_size);
-		KFL_UNUSED(level);
-		return RenderViewPtr();
+		return MakeSharedPtr<NullRenderView>(texture.Width(level), texture.Height(level), texture.Format());
 	}
 
 	RenderViewPtr NullRenderFactory::Make2DRenderView(Texture& texture, int array_index, Texture::CubeFaces face, int level)
 	{
-		KFL_UNUSED(texture);
 		KFL_UNUSED(array_index);
 		KFL_UNUSED(face);
-		KFL_UNUSED(level);
-		return RenderViewPtr();
+		return MakeSharedPtr<NullRenderView>(texture.Width(level), texture.Height(level), texture.Format());
 	}
 
 	RenderViewPtr NullRenderFactory::Make2DRenderView(Texture& texture, int array_index, uint32_t slice, int level)
 	{
-		KFL_UNUSED(texture);
 		KFL_UNUSED(array_index);
 		KFL_UNUSED(slice);
-		KFL_UNUSED(level);
-		return RenderViewPtr();
+		return MakeSharedPtr<NullRenderView>(texture.Width(level), texture.Height(level), texture.Format());
 	}
 
 	RenderViewPtr NullRenderFactory::MakeCubeRenderView(Texture& texture, int array_index, int level)
 	{
-		KFL_UNUSED(texture);
 		KFL_UNUSED(array_index);
-		KFL_UNUSED(level);
-		return RenderViewPtr();
+		return MakeSharedPtr<NullRenderView>(texture.Width(level), texture.Height(level), texture.Format());
 	}
 
 	RenderViewPtr NullRenderFactory::Make3DRenderView(Texture& texture, int array_index, uint32_t first_slice, uint32_t num_slices, int level)
 	{
-		KFL_UNUSED(texture);
 		KFL_UNUSED(array_index);
 		KFL_UNUSED(first_slice);
 		KFL_UNUSED(num_slices);
-		KFL_UNUSED(level);
-		return RenderViewPtr();
+		return MakeSharedPtr<NullRenderView>(texture.Width(level), texture.Height(level), texture.Format());
 	}
 
 	RenderViewPtr NullRenderFactory::MakeGraphicsBufferRenderView(GraphicsBuffer& gbuffer,
 		uint32_t width, uint32_t height, ElementFormat pf)
 	{
 		KFL_UNUSED(gbuffer);
-		KFL_UNUSED(width);
-		KFL_UNUSED(height);
-		KFL_UNUSED(pf);
-		return RenderViewPtr();
+		return MakeSharedPtr<NullRenderView>(width, height, pf);
 	}
 
 	RenderViewPtr NullRenderFactory::Make2DDepthStencilRenderView(uint32_t width, uint32_t height,
 		ElementFormat pf, uint32_t sample_count, uint32_t sample_quality)
 	{
-		KFL_UNUSED(width);
-		KFL_UNUSED(height);
-		KFL_UNUSED(pf);
 		KFL_UNUSED(sample_count);
 		KFL_UNUSED(sample_quality);
-		return RenderViewPtr();
+		return MakeSharedPtr<NullRenderView>(width, height, pf);
 	}
 
 	RenderViewPtr NullRenderFactory::Make1DDepthStencilRenderView(Texture& texture, int first_array_index, int array_size, int level)
 	{
-		KFL_UNUSED(texture);
 		KFL_UNUSED(first_array_index);
 		KFL_UNUSED(array_size);
-		KFL_UNUSED(level);
-		return RenderViewPtr();
+		return MakeSharedPtr<NullRenderView>(texture.Width(level), texture.Height(level), texture.Format());
 	}
 
 	RenderViewPtr NullRenderFactory::Make2DDepthStencilRenderView(Texture& texture, int first_array_index, int array_size, int level)
 	{
-		KFL_UNUSED(texture);
 		KFL_UNUSED(first_array_index);
 		KFL_UNUSED(array_size);
-		KFL_UNUSED(level);
-		return RenderViewPtr();
+		return MakeSharedPtr<NullRenderView>(texture.Width(level), texture.Height(level), texture.Format());
 	}
 
 	RenderViewPtr NullRenderFactory::Make2DDepthStencilRenderView(Texture& texture, int array_index, Texture::CubeFaces face, int level)
 	{
-		KFL_UNUSED(texture);
 		KFL_UNUSED(array_index);
 		KFL_UNUSED(face);
-		KFL_UNUSED(level);
-		return RenderViewPtr();
+		return MakeSharedPtr<NullRenderView>(texture.Width(level), texture.Height(level), texture.Format());
 	}
 	
 	RenderViewPtr NullRenderFactory::Make2DDepthStencilRenderView(Texture& texture, int array_index, uint32_t slice, int level)
 	{
-		KFL_UNUSED(texture);
 		KFL_UNUSED(array_index);
 		KFL_UNUSED(slice);
-		KFL_UNUSED(level);
-		return RenderViewPtr();
+		return MakeSharedPtr<NullRenderView>(texture.Width(level), texture.Height(level), texture.Format());
 	}
 
 	RenderViewPtr NullRenderFactory::MakeCubeDepthStencilRenderView(Texture& texture, int array_index, int level)
 	{
-		KFL_UNUSED(texture);
 		KFL_UNUSED(array_index);
-		KFL_UNUSED(level);
-		return RenderViewPtr();
+		return MakeSharedPtr<NullRenderView>(texture.Width(level), texture.Height(level), texture.Format());
 	}
 	
 	RenderViewPtr NullRenderFactory::Make3DDepthStencilRenderView(Texture& texture, int array_index, uint32_t first_slice, uint32_t num_slices, int level)
 	{
-		KFL_UNUSED(texture);
 		KFL_UNUSED(array_index);
 		KFL_UNUSED(first_slice);
 		KFL_UNUSED(num_slices);
-		KFL_UNUSED(level);
-		return RenderViewPtr();
+		return MakeSharedPtr<NullRenderView>(texture.Width(level), texture.Height(level), texture.Format());
 	}
 
 	UnorderedAccessViewPtr NullRenderFactory::Make1DUnorderedAccessView(Texture& texture, int first_array_index, int array_size, int level)
 	{
-		KFL_UNUSED(texture);
 		KFL_UNUSED(first_array_index);
 		KFL_UNUSED(array_size);
-		KFL_UNUSED(level);
-		return UnorderedAccessViewPtr();
+		return MakeSharedPtr<NullUnorderedAccessView>(texture.Width(level), texture.Height(level), texture.Format());
 	}
 
 	UnorderedAccessViewPtr NullRenderFactory::Make2DUnorderedAccessView(Texture& texture, int first_array_index, int array_size, int level)
 	{
-		KFL_UNUSED(texture);
 		KFL_UNUSED(first_array_index);
 		KFL_UNUSED(array_size);
-		KFL_UNUSED(level);
-		return UnorderedAccessViewPtr();
+		return MakeSharedPtr<NullUnorderedAccessView>(texture.Width(level), texture.Height(level), texture.Format());
 	}
 
 	UnorderedAccessViewPtr NullRenderFactory::Make2DUnorderedAccessView(Texture& texture, int array_index, Texture::CubeFaces face, int level)
 	{
-		KFL_UNUSED(texture);
 		KFL_UNUSED(array_index);
 		KFL_UNUSED(face);
-		KFL_UNUSED(level);
-		return UnorderedAccessViewPtr();
+		return MakeSharedPtr<NullUnorderedAccessView>(texture.Width(level), texture.Height(level), texture.Format());
 	}
 
 	UnorderedAccessViewPtr NullRenderFactory::Make2DUnorderedAccessView(Texture& texture, int array_index, uint32_t slice, int level)
 	{
-		KFL_UNUSED(texture);
 		KFL_UNUSED(array_index);
 		KFL_UNUSED(slice);
-		KFL_UNUSED(level);
-		return UnorderedAccessViewPtr();
+		return MakeSharedPtr<NullUnorderedAccessView>(texture.Width(level), texture.Height(level), texture.Format());
 	}
 
 	UnorderedAccessViewPtr NullRenderFactory::MakeCubeUnorderedAccessView(Texture& texture, int array_index, int level)
 	{
-		KFL_UNUSED(texture);
 		KFL_UNUSED(array_index);
-		KFL_UNUSED(level);
-		return UnorderedAccessViewPtr();
+		return MakeSharedPtr<NullUnorderedAccessView>(texture.Width(level), texture.Height(level), texture.Format());
 	}
 
 	UnorderedAccessViewPtr NullRenderFactory::Make3DUnorderedAccessView(Texture& texture, int array_index, uint32_t first_slice, uint32_t num_slices, int level)
 	{
-		KFL_UNUSED(texture);
 		KFL_UNUSED(array_index);
 		KFL_UNUSED(first_slice);
 		KFL_UNUSED(num_slices);
-		KFL_UNUSED(level);
-		return UnorderedAccessViewPtr();
+		return MakeSharedPtr<NullUnorderedAccessView>(texture.Width(level), texture.Height(level), texture.Format());
 	}
 
 	UnorderedAccessViewPtr NullRenderFactory::MakeGraphicsBufferUnorderedAccessView(GraphicsBuffer& gbuffer, ElementFormat pf)
 	{
-		KFL_UNUSED(gbuffer);
-		KFL_UNUSED(pf);
-		return UnorderedAccessViewPtr();
+		return MakeSharedPtr<NullUnorderedAccessView>(gbuffer.Size() / NumFormatBytes(pf), 1, pf);
 	}
 
 	ShaderObjectPtr NullRenderFactory::MakeShaderObject()
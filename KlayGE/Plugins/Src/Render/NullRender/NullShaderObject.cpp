@@ -35,6 +35,8 @@
 #include <KlayGE/RenderEngine.hpp>
 #include <KlayGE/RenderFactory.hpp>
 #include <KlayGE/RenderEffect.hpp>
+#include <KlayGE/GraphicsBuffer.hpp>
+#include <KlayGE/Texture.hpp>
 #include <KFL/Hash.hpp>
 #include <KFL/ResIdentifier.hpp>
 
@@ -65,6 +67,42 @@
 #include <KlayGE/NullRender/NullRenderEngine.hpp>
 #include <KlayGE/NullRender/NullShaderObject.hpp>
 
+namespace
+{
+	using namespace KlayGE;
+
+	// Same rule as the real plugins: a resource whose hardware resource isn't created yet keeps being reapplied
+	bool ParamHWResourceReady(RenderEffectParameter const & param)
+	{
+		switch (param.Type())
+		{
+		case REDT_sampler:
+			return true;
+
+		case REDT_buffer:
+		case REDT_structured_buffer:
+		case REDT_byte_address_buffer:
+		case REDT_rw_buffer:
+		case REDT_rw_structured_buffer:
+		case REDT_rw_byte_address_buffer:
+		case REDT_append_structured_buffer:
+		case REDT_consume_structured_buffer:
+			{
+				GraphicsBufferPtr buf;
+				param.Value(buf);
+				return !buf || buf->HWResourceReady();
+			}
+
+		default:
+			{
+				TextureSubresource tex_subres;
+				param.Value(tex_subres);
+				return !tex_subres.tex || tex_subres.tex->HWResourceReady();
+			}
+		}
+	}
+}
+
 namespace KlayGE
 {
 #ifndef KLAYGE_PLATFORM_WINDOWS_STORE
@@ -182,6 +220,8 @@ namespace KlayGE
 
 	void NullShaderObject::LinkShaders(RenderEffect const & effect)
 	{
+		this->AttachParameterBinds(effect);
+
 		if (so_template_->as_d3d11_ || so_template_->as_d3d12_)
 		{
 			this->D3D11LinkShaders(effect);
@@ -194,18 +234,79 @@ namespace KlayGE
 
 	ShaderObjectPtr NullShaderObject::Clone(RenderEffect const & effect)
 	{
-		KFL_UNUSED(effect);
-		return MakeSharedPtr<NullShaderObject>();
+		auto ret = MakeSharedPtr<NullShaderObject>();
+		ret->AttachParameterBinds(effect);
+		return ret;
 	}
 
 	void NullShaderObject::Bind()
 	{
+		// Nothing reaches a device here, but the version check matches the real plugins, so the applied/skipped counters
+		// can be measured headless.
+		uint32_t num_applied = 0;
+		for (auto& pb : param_binds_)
+		{
+			uint32_t const version = pb.param->Version();
+			if (version != pb.version)
+			{
+				pb.version = ParamHWResourceReady(*pb.param) ? version : 0;
+				++ num_applied;
+			}
+		}
+
+		RenderEngine& re = Context::Instance().RenderFactoryInstance().RenderEngineInstance();
+		re.AddParamBinds(num_applied, static_cast<uint32_t>(param_binds_.size()) - num_applied);
 	}
 
 	void NullShaderObject::Unbind()
 	{
 	}
 	
+	void NullShaderObject::AttachParameterBinds(RenderEffect const & effect)
+	{
+		// Without shader reflection, every resource parameter of the effect is treated as bound.
+		param_binds_.clear();
+		for (uint32_t i = 0; i < effect.NumParameters(); ++ i)
+		{
+			RenderEffectParameter* param = effect.ParameterByIndex(i);
+			switch (param->Type())
+			{
+			case REDT_texture1D:
+			case REDT_texture2D:
+			case REDT_texture3D:
+			case REDT_textureCUBE:
+			case REDT_texture1DArray:
+			case REDT_texture2DArray:
+			case REDT_texture3DArray:
+			case REDT_textureCUBEArray:
+			case REDT_sampler:
+			case REDT_buffer:
+			case REDT_structured_buffer:
+			case REDT_byte_address_buffer:
+			case REDT_rw_buffer:
+			case REDT_rw_structured_buffer:
+			case REDT_rw_texture1D:
+			case REDT_rw_texture2D:
+			case REDT_rw_texture3D:
+			case REDT_rw_texture1DArray:
+			case REDT_rw_texture2DArray:
+			case REDT_rw_byte_address_buffer:
+			case REDT_append_structured_buffer:
+			case REDT_consume_structured_buffer:
+				{
+					ParameterBind pb;
+					pb.param = param;
+					pb.version = 0;
+					param_binds_.push_back(pb);
+				}
+				break;
+
+			default:
+				break;
+			}
+		}
+	}
+
 	// D3D11/D3D12
 
 	void NullShaderObject::D3D11StreamOut(std::ostream& os, ShaderType type)
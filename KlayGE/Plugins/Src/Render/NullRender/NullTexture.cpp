@@ -34,9 +34,24 @@
 
 namespace KlayGE
 {
-	NullTexture::NullTexture(TextureType type, uint32_t sample_count, uint32_t sample_quality, uint32_t access_hint)
-		: Texture(type, sample_count, sample_quality, access_hint)
+	NullTexture::NullTexture(TextureType type, uint32_t width, uint32_t height, uint32_t depth, uint32_t num_mip_maps,
+			uint32_t array_size, ElementFormat format, uint32_t sample_count, uint32_t sample_quality, uint32_t access_hint)
+		: Texture(type, sample_count, sample_quality, access_hint),
+			width_(width), height_(height), depth_(depth)
 	{
+		if (0 == num_mip_maps)
+		{
+			num_mip_maps = 1;
+			uint32_t size = std::max(std::max(width, height), depth);
+			while (size > 1)
+			{
+				++ num_mip_maps;
+				size /= 2;
+			}
+		}
+		num_mip_maps_ = num_mip_maps;
+		array_size_ = array_size;
+		format_ = format;
 	}
 
 	NullTexture::~NullTexture()
@@ -51,20 +66,23 @@ namespace KlayGE
 
 	uint32_t NullTexture::Width(uint32_t level) const
 	{
-		KFL_UNUSED(level);
-		return 0;
+		BOOST_ASSERT(level < num_mip_maps_);
+
+		return std::max<uint32_t>(1U, width_ >> level);
 	}
 
 	uint32_t NullTexture::Height(uint32_t level) const
 	{
-		KFL_UNUSED(level);
-		return 0;
+		BOOST_ASSERT(level < num_mip_maps_);
+
+		return std::max<uint32_t>(1U, height_ >> level);
 	}
 
 	uint32_t NullTexture::Depth(uint32_t level) const
 	{
-		KFL_UNUSED(level);
-		return 0;
+		BOOST_ASSERT(level < num_mip_maps_);
+
+		return std::max<uint32_t>(1U, depth_ >> level);
 	}
 
 	void NullTexture::CopyToTexture(Texture& target)
@@ -168,9 +186,9 @@ namespace KlayGE
 		KFL_UNUSED(level);
 		KFL_UNUSED(tma);
 		KFL_UNUSED(x_offset);
-		KFL_UNUSED(width);
 
-		data = nullptr;
+		uint32_t row_pitch, slice_pitch;
+		data = this->MapScratch(width, 1, 1, row_pitch, slice_pitch);
 	}
 
 	void NullTexture::Map2D(uint32_t array_index, uint32_t level, TextureMapAccess tma,
@@ -182,11 +200,9 @@ namespace KlayGE
 		KFL_UNUSED(tma);
 		KFL_UNUSED(x_offset);
 		KFL_UNUSED(y_offset);
-		KFL_UNUSED(width);
-		KFL_UNUSED(height);
 
-		data = nullptr;
-		row_pitch = 0;
+		uint32_t slice_pitch;
+		data = this->MapScratch(width, height, 1, row_pitch, slice_pitch);
 	}
 
 	void NullTexture::Map3D(uint32_t array_index, uint32_t level, TextureMapAccess tma,
@@ -200,13 +216,8 @@ namespace KlayGE
 		KFL_UNUSED(x_offset);
 		KFL_UNUSED(y_offset);
 		KFL_UNUSED(z_offset);
-		KFL_UNUSED(width);
-		KFL_UNUSED(height);
-		KFL_UNUSED(depth);
 
-		data = nullptr;
-		row_pitch = 0;
-		slice_pitch = 0;
+		data = this->MapScratch(width, height, depth, row_pitch, slice_pitch);
 	}
 
 	void NullTexture::MapCube(uint32_t array_index, CubeFaces face, uint32_t level, TextureMapAccess tma,
@@ -219,11 +230,27 @@ namespace KlayGE
 		KFL_UNUSED(tma);
 		KFL_UNUSED(x_offset);
 		KFL_UNUSED(y_offset);
-		KFL_UNUSED(width);
-		KFL_UNUSED(height);
 
-		data = nullptr;
-		row_pitch = 0;
+		uint32_t slice_pitch;
+		data = this->MapScratch(width, height, 1, row_pitch, slice_pitch);
+	}
+
+	void* NullTexture::MapScratch(uint32_t width, uint32_t height, uint32_t depth, uint32_t& row_pitch, uint32_t& slice_pitch)
+	{
+		if (IsCompressedFormat(format_))
+		{
+			uint32_t const block_bytes = NumFormatBytes(format_) * 4;
+			row_pitch = (width + 3) / 4 * block_bytes;
+			slice_pitch = (height + 3) / 4 * row_pitch;
+		}
+		else
+		{
+			row_pitch = width * NumFormatBytes(format_);
+			slice_pitch = height * row_pitch;
+		}
+
+		mapped_data_.resize(std::max<size_t>(mapped_data_.size(), slice_pitch * depth));
+		return mapped_data_.data();
 	}
 
 	void NullTexture::Unmap1D(uint32_t array_index, uint32_t level)
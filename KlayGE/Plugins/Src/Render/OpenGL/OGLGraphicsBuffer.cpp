@@ -170,6 +170,11 @@ namespace KlayGE
 		}
 	}
 
+	bool OGLGraphicsBuffer::HWResourceReady() const
+	{
+		return vb_ != 0;
+	}
+
 	void* OGLGraphicsBuffer::Map(BufferAccess ba)
 	{
 		OGLRenderEngine& re = *checked_cast<OGLRenderEngine*>(&Context::Instance().RenderFactoryInstance().RenderEngineInstance());
@@ -138,6 +138,11 @@ namespace KlayGE
 		}
 	}
 
+	bool OGLESGraphicsBuffer::HWResourceReady() const
+	{
+		return vb_ != 0;
+	}
+
 	void* OGLESGraphicsBuffer::Map(BufferAccess ba)
 	{
 		last_ba_ = ba;
@@ -76,12 +76,18 @@ namespace
 					RenderEffectParameter* buff_param)
 			: buffers_(&buffers),
 				gl_bind_targets_(&gl_bind_targets), gl_bind_textures_(&gl_bind_textures), gl_bind_samplers_(&gl_bind_samplers),
-				location_(location), stage_(stage), buff_param_(buff_param)
+				location_(location), stage_(stage), buff_param_(buff_param), version_(0)
 		{
 		}
 
-		void operator()()
+		bool operator()()
 		{
+			uint32_t const version = buff_param_->Version();
+			if (version == version_)
+			{
+				return false;
+			}
+
 			buff_param_->Value((*buffers_)[stage_].tex_buff);
 
 			if ((*buffers_)[stage_].tex_buff)
@@ -98,6 +104,10 @@ namespace
 
 			OGLESRenderEngine& re = *checked_cast<OGLESRenderEngine*>(&Context::Instance().RenderFactoryInstance().RenderEngineInstance());
 			re.Uniform1i(location_, stage_);
+
+			// A delay created buffer gets its texture later, keep reapplying it until then
+			version_ = (!(*buffers_)[stage_].tex_buff || (*buffers_)[stage_].tex_buff->HWResourceReady()) ? version : 0;
+			return true;
 		}
 
 	private:
@@ -108,6 +118,7 @@ namespace
 		GLint location_;
 		GLuint stage_;
 		RenderEffectParameter* buff_param_;
+		uint32_t version_;
 	};
 
 	template <>
@@ -120,12 +131,25 @@ namespace
 					RenderEffectParameter* tex_param, RenderEffectParameter* sampler_param)
 			: samplers_(&samplers),
 				gl_bind_targets_(&gl_bind_targets), gl_bind_textures_(&gl_bind_textures), gl_bind_samplers_(&gl_bind_samplers),
-				location_(location), stage_(stage), tex_param_(tex_param), sampler_param_(sampler_param)
+				location_(location), stage_(stage), tex_param_(tex_param), sampler_param_(sampler_param),
+				tex_version_(0), sampler_version_(0)
 		{
 		}
 
-		void operator()()
+		bool operator()()
 		{
+			uint32_t const tex_version = tex_param_->Version();
+			uint32_t const sampler_version = sampler_param_->Version();
+			if ((tex_version == tex_version_) && (sampler_version == sampler_version_))
+			{
+				// Anisotropy is a texture state in GLES. It has to be set again in case another sampler changed it.
+				if ((*samplers_)[stage_].tex)
+				{
+					checked_cast<OGLESSamplerStateObject*>((*samplers_)[stage_].sampler.get())->Active((*samplers_)[stage_].tex);
+				}
+				return false;
+			}
+
 			tex_param_->Value((*samplers_)[stage_].tex);
 			sampler_param_->Value((*samplers_)[stage_].sampler);
 
@@ -149,6 +173,12 @@ namespace
 
 			OGLESRenderEngine& re = *checked_cast<OGLESRenderEngine*>(&Context::Instance().RenderFactoryInstance().RenderEngineInstance());
 			re.Uniform1i(location_, stage_);
+
+			// A texture still loading gets its resource later, keep reapplying it until then
+			auto const & tex = (*samplers_)[stage_].tex;
+			tex_version_ = (!tex || tex->HWResourceReady()) ? tex_version : 0;
+			sampler_version_ = sampler_version;
+			return true;
 		}
 
 	private:
@@ -160,6 +190,8 @@ namespace
 		GLuint stage_;
 		RenderEffectParameter* tex_param_;
 		RenderEffectParameter* sampler_param_;
+		uint32_t tex_version_;
+		uint32_t sampler_version_;
 	};
 }
 
@@ -1376,10 +1408,15 @@ namespace KlayGE
 		OGLESRenderEngine& re = *checked_cast<OGLESRenderEngine*>(&Context::Instance().RenderFactoryInstance().RenderEngineInstance());
 		re.UseProgram(glsl_program_);
 
+		uint32_t num_applied = 0;
 		for (auto const & pb : param_binds_)
 		{
-			pb.func();
+			if (pb.func())
+			{
+				++ num_applied;
+			}
 		}
+		re.AddParamBinds(num_applied, static_cast<uint32_t>(param_binds_.size()) - num_applied);
 
 		for (size_t i = 0; i < all_cbuffs_.size(); ++ i)
 		{
@@ -28,6 +28,8 @@
 #include <KFL/Vector.hpp>
 #include <KFL/Matrix.hpp>
 #include <KFL/Plane.hpp>
+#include <KFL/SIMDMath.hpp>
+#include <KlayGE/Context.hpp>
 #include <KlayGE/SceneObject.hpp>
 #include <KlayGE/RenderableHelper.hpp>
 #include <KlayGE/Camera.hpp>
@@ -35,17 +37,25 @@
 #include <KlayGE/DeferredRenderingLayer.hpp>
 
 #include <algorithm>
+#include <array>
 #include <functional>
 #include <boost/assert.hpp>
 
 #ifdef KLAYGE_DRAW_NODES
-#include <KlayGE/Context.hpp>
 #include <KlayGE/RenderFactory.hpp>
 #include <KlayGE/RenderEffect.hpp>
 #endif
 
 #include <KlayGE/OCTree/OCTree.hpp>
 
+namespace
+{
+	float const LOOSENESS = 2.0f;
+	size_t const MIN_ROOT_OBJS_TO_REBUILD = 64;
+	size_t const OBJS_PER_PLACE_TASK = 1024;
+	size_t const NODES_PER_MARK_TASK = 64;
+}
+
 #ifdef KLAYGE_DRAW_NODES
 namespace
 {
@@ -99,13 +109,15 @@ namespace
 namespace KlayGE
 {
 	OCTree::OCTree()
-		: max_tree_depth_(4), rebuild_tree_(false)
+		: root_center_(0, 0, 0), root_half_size_(1), num_root_objs_after_rebuild_(0),
+			max_tree_depth_(4), rebuild_tree_(false)
 	{
 	}
 
 	void OCTree::MaxTreeDepth(uint32_t max_tree_depth)
 	{
 		max_tree_depth_ = std::min<uint32_t>(max_tree_depth, 16UL);
+		rebuild_tree_ = true;
 	}
 
 	uint32_t OCTree::MaxTreeDepth() const
@@ -115,31 +127,51 @@ namespace KlayGE
 
 	void OCTree::ClipScene()
 	{
+		App3DFramework& app = Context::Instance().AppInstance();
+		Camera& camera = app.ActiveCamera();
+
+		float4x4 view_proj = camera.ViewProjMatrix();
+		auto drl = Context::Instance().DeferredRenderingLayerInstance();
+		if (drl)
+		{
+			int32_t cas_index = drl->CurrCascadeIndex();
+			if (cas_index >= 0)
+			{
+				view_proj *= drl->GetCascadedShadowLayer()->CascadeCropMatrix(cas_index);
+			}
+		}
+
+		float3 const & view_dir = camera.ForwardVec();
+		float3 const & eye_pos = camera.EyePos();
+		auto const & store = scene_obj_store_;
+
 		if (rebuild_tree_)
 		{
-			octree_.resize(1);
-			AABBox bb_root(float3(0, 0, 0), float3(0, 0, 0));
-			octree_[0].first_child_index = -1;
-			octree_[0].visible = BO_No;
-			for (auto const & obj : scene_objs_)
+			this->RebuildTree();
+		}
+
+		// Moveable objects are refitted into the tree before it's traversed. They can share a renderable, so this is
+		//  kept serial.
+		for (size_t i = 0; i < scene_objs_.size(); ++ i)
+		{
+			uint32_t const attr = store.attribs[i];
+			if (!store.has_parent[i] && !(attr & SceneObject::SOA_Invisible) && (attr & SceneObject::SOA_Moveable))
 			{
-				uint32_t const attr = obj->Attrib();
-				if ((attr & SceneObject::SOA_Cullable)
-					&& !(attr & SceneObject::SOA_Moveable))
+				auto so = scene_objs_[i].get();
+				so->UpdateAbsModelMatrix();
+				if (attr & SceneObject::SOA_Cullable)
 				{
-					bb_root |= obj->PosBoundWS();
-					octree_[0].obj_ptrs.push_back(obj.get());
+					this->UpdateObjectStoreBound(i, so->PosBoundWS());
+					this->RelocateObject(so);
 				}
 			}
-			float3 const & center = bb_root.Center();
-			float3 const & extent = bb_root.HalfSize();
-			float longest_dim = std::max(std::max(extent.x(), extent.y()), extent.z());
-			float3 new_extent(longest_dim, longest_dim, longest_dim);
-			octree_[0].bb = AABBox(center - new_extent, center + new_extent);
-
-			this->DivideNode(0, 1);
+		}
 
-			rebuild_tree_ = false;
+		// Too many objects stuck in the root, mostly ones that moved out of the tree bound
+		if (!octree_.empty()
+			&& (octree_[0].obj_ptrs.size() > std::max<size_t>(num_root_objs_after_rebuild_ * 2, MIN_ROOT_OBJS_TO_REBUILD)))
+		{
+			this->RebuildTree();
 		}
 
 #ifdef KLAYGE_DRAW_NODES
@@ -150,57 +182,32 @@ namespace KlayGE
 		checked_pointer_cast<NodeRenderable>(node_renderable_)->ClearInstances();
 #endif
 
-		if (!octree_.empty())
-		{
-			this->NodeVisible(0);
-		}
-
-		App3DFramework& app = Context::Instance().AppInstance();
-		Camera& camera = app.ActiveCamera();
-
-		float4x4 view_proj = camera.ViewProjMatrix();
-		auto drl = Context::Instance().DeferredRenderingLayerInstance();
-		if (drl)
-		{
-			int32_t cas_index = drl->CurrCascadeIndex();
-			if (cas_index >= 0)
-			{
-				view_proj *= drl->GetCascadedShadowLayer()->CascadeCropMatrix(cas_index);
-			}
-		}
-
 		if (camera.OmniDirectionalMode())
 		{
-			for (auto const & obj : scene_objs_)
+			for (size_t i = 0; i < scene_objs_.size(); ++ i)
 			{
-				if (obj->Visible())
+				uint32_t const attr = store.attribs[i];
+				if (!(attr & SceneObject::SOA_Invisible) && (attr & SceneObject::SOA_Cullable))
 				{
-					uint32_t const attr = obj->Attrib();
-					if (attr & SceneObject::SOA_Moveable)
+					auto so = scene_objs_[i].get();
+					if (store.has_parent[i] && (attr & SceneObject::SOA_Moveable))
 					{
-						obj->UpdateAbsModelMatrix();
+						so->UpdateAbsModelMatrix();
 					}
 
-					if (attr & SceneObject::SOA_Cullable)
+					BoundOverlap bo;
+					if (small_obj_threshold_ > 0)
 					{
-						BoundOverlap bo;
-						if (small_obj_threshold_ > 0)
-						{
-							AABBox const & aabb_ws = obj->PosBoundWS();
-							bo = ((MathLib::ortho_area(camera.ForwardVec(), aabb_ws) > small_obj_threshold_)
-								&& (MathLib::perspective_area(camera.EyePos(), view_proj, aabb_ws) > small_obj_threshold_))
-								? BO_Yes : BO_No;
-						}
-						else
-						{
-							bo = BO_Yes;
-						}
-						obj->VisibleMark(bo);
+						AABBox const & aabb_ws = so->PosBoundWS();
+						bo = ((MathLib::ortho_area(view_dir, aabb_ws) > small_obj_threshold_)
+							&& (MathLib::perspective_area(eye_pos, view_proj, aabb_ws) > small_obj_threshold_))
+							? BO_Yes : BO_No;
 					}
-				}
-				else
-				{
-					obj->VisibleMark(BO_No);
+					else
+					{
+						bo = BO_Yes;
+					}
+					so->VisibleMark(bo);
 				}
 			}
 		}
@@ -208,43 +215,63 @@ namespace KlayGE
 		{
 			if (!octree_.empty())
 			{
-				this->MarkNodeObjs(0, false);
+				AABBox const & root_bb = octree_[0].bb;
+				this->NodeVisible(0, this->AreaVisible(root_bb, view_dir, eye_pos, view_proj) ? frustum_->Intersect(root_bb) : BO_No,
+					view_dir, eye_pos, view_proj);
+
+				// Every object lives in exactly one node, so nodes can be marked independently
+				Context::Instance().TaskScheduler().parallel_for(0, octree_.size(), NODES_PER_MARK_TASK,
+					[this, &view_dir, &eye_pos, &view_proj](size_t begin, size_t end)
+					{
+						for (size_t i = begin; i < end; ++ i)
+						{
+							this->MarkNodeObjs(i, view_dir, eye_pos, view_proj);
+						}
+					});
+
+#ifdef KLAYGE_DRAW_NODES
+				// Gathered after the parallel traversal, so the renderable is only touched by this thread
+				auto& node_renderable = *checked_pointer_cast<NodeRenderable>(node_renderable_);
+				for (auto const & node : octree_)
+				{
+					if ((node.visible != BO_No) && (-1 == node.first_child_index))
+					{
+						node_renderable.AddInstance(MathLib::scaling(node.bb.HalfSize()) * MathLib::translation(node.bb.Center()));
+					}
+				}
+#endif
 			}
 
-			for (auto const & obj : scene_objs_)
+			for (size_t i = 0; i < scene_objs_.size(); ++ i)
 			{
-				if (obj->Visible())
+				uint32_t const attr = store.attribs[i];
+				if ((attr & SceneObject::SOA_Invisible) || this->InTree(attr, store.has_parent[i] != 0))
+				{
+					continue;
+				}
+
+				auto so = scene_objs_[i].get();
+				BoundOverlap visible = this->VisibleTestFromParent(so, view_dir, eye_pos, view_proj);
+				if (BO_Partial == visible)
 				{
-					BoundOverlap visible = this->VisibleTestFromParent(obj.get(), camera.ForwardVec(), camera.EyePos(), view_proj);
-					if (BO_Partial == visible)
+					if (store.has_parent[i] && (attr & SceneObject::SOA_Moveable))
 					{
-						uint32_t const attr = obj->Attrib();
-						if (attr & SceneObject::SOA_Moveable)
-						{
-							obj->UpdateAbsModelMatrix();
-						}
+						so->UpdateAbsModelMatrix();
+					}
 
-						if (attr & SceneObject::SOA_Cullable)
-						{
-							if (attr & SceneObject::SOA_Moveable)
-							{
-								obj->VisibleMark(this->AABBVisible(obj->PosBoundWS()));
-							}
-							else
-							{
-								obj->VisibleMark(visible);
-							}
-						}
-						else
-						{
-							obj->VisibleMark(BO_Yes);
-						}
+					if (attr & SceneObject::SOA_Cullable)
+					{
+						so->VisibleMark(frustum_->Intersect(so->PosBoundWS()));
 					}
 					else
 					{
-						obj->VisibleMark(visible);
+						so->VisibleMark(BO_Yes);
 					}
 				}
+				else
+				{
+					so->VisibleMark(visible);
+				}
 			}
 		}
 
@@ -258,16 +285,23 @@ namespace KlayGE
 		SceneManager::ClearObject();
 
 		octree_.clear();
+		obj_node_indices_.clear();
 		rebuild_tree_ = true;
 	}
 
 	void OCTree::OnAddSceneObject(SceneObjectPtr const & obj)
 	{
-		uint32_t const attr = obj->Attrib();
-		if ((attr & SceneObject::SOA_Cullable)
-			&& !(attr & SceneObject::SOA_Moveable))
+		if (this->InTree(obj->Attrib(), obj->Parent() != nullptr))
 		{
-			rebuild_tree_ = true;
+			if (octree_.empty())
+			{
+				rebuild_tree_ = true;
+			}
+			else if (!rebuild_tree_)
+			{
+				// Objects are added again after their renderable is ready, with a new bound
+				this->RelocateObject(obj.get());
+			}
 		}
 	}
 
@@ -275,12 +309,7 @@ namespace KlayGE
 	{
 		BOOST_ASSERT(iter != scene_objs_.end());
 
-		uint32_t const attr = (*iter)->Attrib();
-		if ((attr & SceneObject::SOA_Cullable)
-			&& !(attr & SceneObject::SOA_Moveable))
-		{
-			rebuild_tree_ = true;
-		}
+		this->RemoveObject(iter->get());
 	}
 
 	void OCTree::DoSuspend()
@@ -293,158 +322,259 @@ namespace KlayGE
 		// TODO
 	}
 
-	void OCTree::DivideNode(size_t index, uint32_t curr_depth)
+	bool OCTree::InTree(uint32_t attr, bool has_parent) const
 	{
-		if (octree_[index].obj_ptrs.size() > 1)
-		{
-			size_t const this_size = octree_.size();
-			AABBox const parent_bb = octree_[index].bb;
-			float3 const parent_center = parent_bb.Center();
-			octree_[index].first_child_index = static_cast<int>(this_size);
-			octree_[index].visible = BO_No;
-
-			octree_.resize(this_size + 8);
-			for (auto so : octree_[index].obj_ptrs)
-			{
-				AABBox const & aabb = so->PosBoundWS();
-				int mark[6];
-				mark[0] = aabb.Min().x() >= parent_center.x() ? 1 : 0;
-				mark[1] = aabb.Min().y() >= parent_center.y() ? 2 : 0;
-				mark[2] = aabb.Min().z() >= parent_center.z() ? 4 : 0;
-				mark[3] = aabb.Max().x() >= parent_center.x() ? 1 : 0;
-				mark[4] = aabb.Max().y() >= parent_center.y() ? 2 : 0;
-				mark[5] = aabb.Max().z() >= parent_center.z() ? 4 : 0;
-				for (int j = 0; j < 8; ++ j)
-				{
-					if (j == ((j & 1) ? mark[3] : mark[0])
-						+ ((j & 2) ? mark[4] : mark[1])
-						+ ((j & 4) ? mark[5] : mark[2]))
-					{
-						octree_[this_size + j].obj_ptrs.push_back(so);
-					}
-				}
-			}
+		return (attr & SceneObject::SOA_Cullable) && !has_parent;
+	}
 
-			for (size_t j = 0; j < 8; ++ j)
+	void OCTree::RebuildTree()
+	{
+		std::vector<SceneObject*> tree_objs;
+		AABBox bb_root(float3(0, 0, 0), float3(0, 0, 0));
+		for (auto const & obj : scene_objs_)
+		{
+			if (this->InTree(obj->Attrib(), obj->Parent() != nullptr))
 			{
-				octree_node_t& new_node = octree_[this_size + j];
-				new_node.first_child_index = -1;
-				new_node.bb = AABBox(float3((j & 1) ? parent_center.x() : parent_bb.Min().x(),
-						(j & 2) ? parent_center.y() : parent_bb.Min().y(),
-						(j & 4) ? parent_center.z() : parent_bb.Min().z()),
-					float3((j & 1) ? parent_bb.Max().x() : parent_center.x(),
-						(j & 2) ? parent_bb.Max().y() : parent_center.y(),
-						(j & 4) ? parent_bb.Max().z() : parent_center.z()));
+				bb_root |= obj->PosBoundWS();
+				tree_objs.push_back(obj.get());
+			}
+		}
+		float3 const & extent = bb_root.HalfSize();
+		root_center_ = bb_root.Center();
+		root_half_size_ = std::max(std::max(std::max(extent.x(), extent.y()), extent.z()), 1e-3f);
+
+		octree_.resize(1);
+		octree_[0].bb = AABBox(root_center_ - float3(root_half_size_, root_half_size_, root_half_size_) * LOOSENESS,
+			root_center_ + float3(root_half_size_, root_half_size_, root_half_size_) * LOOSENESS);
+		octree_[0].first_child_index = -1;
+		octree_[0].visible = BO_No;
+		octree_[0].obj_ptrs.clear();
+		obj_node_indices_.clear();
 
-				if (curr_depth < max_tree_depth_)
+		// Finding the cells is independent per object, only linking them into nodes has to be serial
+		std::vector<CellLocation> cells(tree_objs.size());
+		Context::Instance().TaskScheduler().parallel_for(0, tree_objs.size(), OBJS_PER_PLACE_TASK,
+			[this, &tree_objs, &cells](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; ++ i)
 				{
-					this->DivideNode(this_size + j, curr_depth + 1);
+					cells[i] = this->ObjectCell(tree_objs[i]->PosBoundWS());
 				}
-			}
-
-			octree_[index].obj_ptrs.clear();
-			octree_[index].obj_ptrs.shrink_to_fit();
+			});
+		for (size_t i = 0; i < tree_objs.size(); ++ i)
+		{
+			int const node_index = this->CellNode(cells[i]);
+			octree_[node_index].obj_ptrs.push_back(tree_objs[i]);
+			obj_node_indices_[tree_objs[i]] = node_index;
 		}
+
+		num_root_objs_after_rebuild_ = octree_[0].obj_ptrs.size();
+		rebuild_tree_ = false;
 	}
 
-	void OCTree::NodeVisible(size_t index)
+	OCTree::CellLocation OCTree::ObjectCell(AABBox const & aabb) const
 	{
-		BOOST_ASSERT(index < octree_.size());
-
-		App3DFramework& app = Context::Instance().AppInstance();
-		Camera& camera = app.ActiveCamera();
+		CellLocation cell = { 0, 0, 0, 0 };
 
-		float4x4 view_proj = camera.ViewProjMatrix();
-		auto drl = Context::Instance().DeferredRenderingLayerInstance();
-		if (drl)
+		float3 const center = aabb.Center();
+		float3 const extent = aabb.HalfSize();
+		float const max_extent = std::max(std::max(extent.x(), extent.y()), extent.z());
+		float3 const offset = center - root_center_;
+		if ((max_extent <= root_half_size_) && (MathLib::abs(offset.x()) <= root_half_size_)
+			&& (MathLib::abs(offset.y()) <= root_half_size_) && (MathLib::abs(offset.z()) <= root_half_size_))
 		{
-			int32_t cas_index = drl->CurrCascadeIndex();
-			if (cas_index >= 0)
+			// The deepest cell still big enough. With a looseness of 2, the object fits the node wherever its
+			//  center is in the cell.
+			float cell_half_size = root_half_size_;
+			while ((cell.depth < max_tree_depth_) && (max_extent <= cell_half_size * 0.5f))
 			{
-				view_proj *= drl->GetCascadedShadowLayer()->CascadeCropMatrix(cas_index);
+				cell_half_size *= 0.5f;
+				++ cell.depth;
 			}
+
+			uint32_t const num_cells = 1UL << cell.depth;
+			float const scale = num_cells / (root_half_size_ * 2);
+			cell.x = std::min(static_cast<uint32_t>(std::max((offset.x() + root_half_size_) * scale, 0.0f)), num_cells - 1);
+			cell.y = std::min(static_cast<uint32_t>(std::max((offset.y() + root_half_size_) * scale, 0.0f)), num_cells - 1);
+			cell.z = std::min(static_cast<uint32_t>(std::max((offset.z() + root_half_size_) * scale, 0.0f)), num_cells - 1);
 		}
 
-		octree_node_t& node = octree_[index];
-		if ((small_obj_threshold_ <= 0)
-			|| ((MathLib::ortho_area(camera.ForwardVec(), node.bb) > small_obj_threshold_)
-				&& (MathLib::perspective_area(camera.EyePos(), view_proj, node.bb) > small_obj_threshold_)))
+		return cell;
+	}
+
+	int OCTree::CellNode(CellLocation const & cell)
+	{
+		int node_index = 0;
+		for (uint32_t level = cell.depth; level > 0; -- level)
 		{
-			BoundOverlap const vis = frustum_->Intersect(node.bb);
-			node.visible = vis;
-			if (BO_Partial == vis)
+			if (-1 == octree_[node_index].first_child_index)
 			{
-				if (node.first_child_index != -1)
-				{
-					for (int i = 0; i < 8; ++ i)
-					{
-						this->NodeVisible(node.first_child_index + i);
-					}
-				}
+				this->DivideNode(node_index);
 			}
+
+			uint32_t const shift = level - 1;
+			int const j = ((cell.x >> shift) & 1) | (((cell.y >> shift) & 1) << 1) | (((cell.z >> shift) & 1) << 2);
+			node_index = octree_[node_index].first_child_index + j;
 		}
-		else
+		return node_index;
+	}
+
+	void OCTree::DivideNode(size_t index)
+	{
+		size_t const this_size = octree_.size();
+		AABBox const parent_bb = octree_[index].bb;
+		float3 const parent_center = parent_bb.Center();
+		float const child_half_size = parent_bb.HalfSize().x() / LOOSENESS * 0.5f;
+		float3 const child_loose_extent = float3(child_half_size, child_half_size, child_half_size) * LOOSENESS;
+		octree_[index].first_child_index = static_cast<int>(this_size);
+
+		octree_.resize(this_size + 8);
+		for (size_t j = 0; j < 8; ++ j)
 		{
-			node.visible = BO_No;
+			float3 const child_center(parent_center.x() + ((j & 1) ? child_half_size : -child_half_size),
+				parent_center.y() + ((j & 2) ? child_half_size : -child_half_size),
+				parent_center.z() + ((j & 4) ? child_half_size : -child_half_size));
+
+			octree_node_t& new_node = octree_[this_size + j];
+			new_node.bb = AABBox(child_center - child_loose_extent, child_center + child_loose_extent);
+			new_node.first_child_index = -1;
+			new_node.visible = BO_No;
 		}
+	}
 
-#ifdef KLAYGE_DRAW_NODES
-		if ((vis != BO_No) && (-1 == node.first_child_index))
+	void OCTree::RelocateObject(SceneObject* so)
+	{
+		AABBox const & aabb_ws = so->PosBoundWS();
+
+		auto iter = obj_node_indices_.find(so);
+		if (iter != obj_node_indices_.end())
 		{
-			checked_pointer_cast<NodeRenderable>(node_renderable_)->AddInstance(MathLib::scaling(node.bb.HalfSize()) * MathLib::translation(node.bb.Center()));
+			// Objects in the root might fit deeper now, so only the others can stay put
+			octree_node_t const & node = octree_[iter->second];
+			if ((iter->second != 0) && node.bb.VecInBound(aabb_ws.Min()) && node.bb.VecInBound(aabb_ws.Max()))
+			{
+				return;
+			}
+
+			this->RemoveObject(so);
+		}
+
+		int const node_index = this->CellNode(this->ObjectCell(aabb_ws));
+		octree_[node_index].obj_ptrs.push_back(so);
+		obj_node_indices_.emplace(so, node_index);
+	}
+
+	void OCTree::RemoveObject(SceneObject* so)
+	{
+		auto iter = obj_node_indices_.find(so);
+		if (iter != obj_node_indices_.end())
+		{
+			auto& obj_ptrs = octree_[iter->second].obj_ptrs;
+			auto obj_iter = std::find(obj_ptrs.begin(), obj_ptrs.end(), so);
+			BOOST_ASSERT(obj_iter != obj_ptrs.end());
+			*obj_iter = obj_ptrs.back();
+			obj_ptrs.pop_back();
+
+			obj_node_indices_.erase(iter);
 		}
-#endif
 	}
 
-	void OCTree::MarkNodeObjs(size_t index, bool force)
+	bool OCTree::AreaVisible(AABBox const & aabb, float3 const & view_dir, float3 const & eye_pos,
+		float4x4 const & view_proj) const
+	{
+		return (small_obj_threshold_ <= 0)
+			|| ((MathLib::ortho_area(view_dir, aabb) > small_obj_threshold_)
+				&& (MathLib::perspective_area(eye_pos, view_proj, aabb) > small_obj_threshold_));
+	}
+
+	void OCTree::NodeVisible(size_t index, BoundOverlap vis, float3 const & view_dir, float3 const & eye_pos,
+		float4x4 const & view_proj)
 	{
 		BOOST_ASSERT(index < octree_.size());
 
-		App3DFramework& app = Context::Instance().AppInstance();
-		Camera& camera = app.ActiveCamera();
+		octree_node_t& node = octree_[index];
+		node.visible = vis;
 
-		float4x4 view_proj = camera.ViewProjMatrix();
-		auto drl = Context::Instance().DeferredRenderingLayerInstance();
-		if (drl)
+		if (node.first_child_index != -1)
 		{
-			int32_t cas_index = drl->CurrCascadeIndex();
-			if (cas_index >= 0)
+			int const first_child_index = node.first_child_index;
+
+			// Subtrees fully inside or outside take the parent's result, so marking can read any node directly.
+			//  Otherwise the 8 children are tested against the frustum in one batch.
+			std::array<BoundOverlap, 8> child_vis;
+			if (BO_Partial == vis)
 			{
-				view_proj *= drl->GetCascadedShadowLayer()->CascadeCropMatrix(cas_index);
+				float bounds[6][8];
+				for (int i = 0; i < 8; ++ i)
+				{
+					AABBox const & bb = octree_[first_child_index + i].bb;
+					for (int j = 0; j < 3; ++ j)
+					{
+						bounds[j][i] = bb.Min()[j];
+						bounds[j + 3][i] = bb.Max()[j];
+					}
+				}
+				SIMDMathLib::IntersectAABBsFrustum(&child_vis[0], bounds[0], bounds[1], bounds[2],
+					bounds[3], bounds[4], bounds[5], 8, *frustum_);
+
+				for (int i = 0; i < 8; ++ i)
+				{
+					if ((child_vis[i] != BO_No) && !this->AreaVisible(octree_[first_child_index + i].bb, view_dir, eye_pos, view_proj))
+					{
+						child_vis[i] = BO_No;
+					}
+				}
+			}
+			else
+			{
+				child_vis.fill(vis);
 			}
-		}
 
-		octree_node_t const & node = octree_[index];
-		if ((node.visible != BO_No) || force)
-		{
-			for (auto so : node.obj_ptrs)
+			if (0 == index)
 			{
-				if ((BO_No == so->VisibleMark()) && so->Visible())
-				{
-					BoundOverlap visible = this->VisibleTestFromParent(so, camera.ForwardVec(), camera.EyePos(), view_proj);
-					if (BO_Partial == visible)
+				Context::Instance().TaskScheduler().parallel_for(0, 8, 1,
+					[this, first_child_index, &child_vis, &view_dir, &eye_pos, &view_proj](size_t begin, size_t end)
 					{
-						AABBox const & aabb_ws = so->PosBoundWS();
-						if (so->Parent() || (small_obj_threshold_ <= 0)
-							|| ((MathLib::ortho_area(camera.ForwardVec(), node.bb) > small_obj_threshold_)
-								&& (MathLib::perspective_area(camera.EyePos(), view_proj, aabb_ws) > small_obj_threshold_)))
-						{
-							visible = frustum_->Intersect(aabb_ws);
-						}
-						else
+						for (size_t i = begin; i < end; ++ i)
 						{
-							visible = BO_No;
+							this->NodeVisible(first_child_index + i, child_vis[i], view_dir, eye_pos, view_proj);
 						}
-					}
-					so->VisibleMark(visible);
+					});
+			}
+			else
+			{
+				for (int i = 0; i < 8; ++ i)
+				{
+					this->NodeVisible(first_child_index + i, child_vis[i], view_dir, eye_pos, view_proj);
 				}
 			}
+		}
+	}
+
+	void OCTree::MarkNodeObjs(size_t index, float3 const & view_dir, float3 const & eye_pos, float4x4 const & view_proj)
+	{
+		BOOST_ASSERT(index < octree_.size());
+
+		octree_node_t const & node = octree_[index];
 
-			if (node.first_child_index != -1)
+		// Objects in the root may be outside its bound, so they are always tested one by one
+		if ((0 == index) || (node.visible != BO_No))
+		{
+			for (auto so : node.obj_ptrs)
 			{
-				for (int i = 0; i < 8; ++ i)
+				if (so->Visible())
 				{
-					this->MarkNodeObjs(node.first_child_index + i, (BO_Yes == node.visible) || force);
+					AABBox const & aabb_ws = so->PosBoundWS();
+					BoundOverlap visible;
+					if (this->AreaVisible(aabb_ws, view_dir, eye_pos, view_proj))
+					{
+						visible = ((index != 0) && (BO_Yes == node.visible)) ? BO_Yes : frustum_->Intersect(aabb_ws);
+					}
+					else
+					{
+						visible = BO_No;
+					}
+					so->VisibleMark(visible);
 				}
 			}
 		}
@@ -530,7 +530,7 @@ uint32_t JudaTexViewer::DoUpdate(uint32_t /*pass*/)
 		rl_border.VertexStreamFrequencyDivider(i, RenderLayout::ST_Geometry, nx * ny);
 	}
 
-	juda_tex_->UpdateCache(tile_ids);
+	juda_tex_->ASyncUpdateCache(tile_ids);
 
 	Color clear_clr(0.2f, 0.4f, 0.6f, 1);
 	if (Context::Instance().Config().graphics_cfg.gamma)
@@ -223,7 +223,8 @@ namespace
 
 		void Instance(float4x4 const & mat, Color const & clr)
 		{
-			model_ = mat;
+			this->ModelMatrix(mat);
+			last_model_ = mat;
 			inst_.clr = clr.ABGR();
 		}
 
@@ -241,20 +242,27 @@ namespace
 		{
 			KFL_UNUSED(app_time);
 
-			last_model_ = model_;
+			float4x4 const & model = this->ModelMatrix();
+			float e = elapsed_time * 0.3f * -model(3, 1);
+			this->ModelMatrix(model * MathLib::rotation_y(e));
+		}
 
+		bool MainThreadUpdate(float app_time, float elapsed_time) override
+		{
+			// The instance data is read by the renderer, so it's only built on the main thread
 			float4x4 mat_t = MathLib::transpose(last_model_);
 			inst_.last_mat[0] = mat_t.Row(0);
 			inst_.last_mat[1] = mat_t.Row(1);
 			inst_.last_mat[2] = mat_t.Row(2);
 
-			float e = elapsed_time * 0.3f * -model_(3, 1);
-			model_ *= MathLib::rotation_y(e);
-
 			mat_t = MathLib::transpose(model_);
 			inst_.mat[0] = mat_t.Row(0);
 			inst_.mat[1] = mat_t.Row(1);
 			inst_.mat[2] = mat_t.Row(2);
+
+			last_model_ = model_;
+
+			return SceneObjectHelper::MainThreadUpdate(app_time, elapsed_time);
 		}
 
 		void VelocityPass(bool velocity)
@@ -145,13 +145,16 @@ namespace
 			}
 		}
 
-		virtual void SubThreadUpdate(float app_time, float /*elapsed_time*/) override
+		// The renderables are read by the renderer, so they are only changed on the main thread
+		virtual bool MainThreadUpdate(float app_time, float elapsed_time) override
 		{
 			RenderModelPtr model = checked_pointer_cast<RenderModel>(renderable_);
 			for (uint32_t i = 0; i < model->NumSubrenderables(); ++ i)
 			{
 				checked_pointer_cast<RenderPolygon>(model->Subrenderable(i))->AppTime(app_time);
 			}
+
+			return SceneObjectHelper::MainThreadUpdate(app_time, elapsed_time);
 		}
 	};
 
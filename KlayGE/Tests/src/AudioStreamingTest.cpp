@@ -0,0 +1,365 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KlayGE/AudioDataSource.hpp>
+#include <KlayGE/Audio.hpp>
+#include <KlayGE/AudioFactory.hpp>
+#include <KlayGE/Context.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	class PatternDataSource : public AudioDataSource
+	{
+	public:
+		explicit PatternDataSource(size_t size)
+			: size_(size), pos_(0), total_read_(0)
+		{
+			format_ = AF_Mono16;
+			freq_ = 8000;
+		}
+
+		void Open(ResIdentifierPtr const & file) override
+		{
+			KFL_UNUSED(file);
+		}
+
+		void Close() override
+		{
+		}
+
+		size_t Size() override
+		{
+			return size_;
+		}
+
+		size_t Read(void* data, size_t size) override
+		{
+			size_t const read_size = std::min(size, size_ - pos_);
+			uint8_t* bytes = static_cast<uint8_t*>(data);
+			for (size_t i = 0; i < read_size; ++ i)
+			{
+				bytes[i] = static_cast<uint8_t>(pos_ + i);
+			}
+			pos_ += read_size;
+			total_read_ += read_size;
+			return read_size;
+		}
+
+		void Reset() override
+		{
+			pos_ = 0;
+		}
+
+		// Bytes handed out over all plays
+		size_t TotalRead() const
+		{
+			return total_read_;
+		}
+
+	private:
+		size_t size_;
+		size_t pos_;
+		std::atomic<size_t> total_read_;
+	};
+
+	// A device the test drains by hand
+	class ManualMusicBuffer : public MusicBuffer
+	{
+	public:
+		ManualMusicBuffer(AudioDataSourcePtr const & data_source, uint32_t num_slots, bool loop)
+			: MusicBuffer(data_source),
+				num_slots_(num_slots), accept_refills_(true), ended_(false)
+		{
+			loop_ = loop;
+		}
+
+		uint32_t RefillSize() const
+		{
+			return refill_size_;
+		}
+
+		void AcceptRefills(bool accept)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			accept_refills_ = accept;
+		}
+
+		size_t NumQueued() const
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			return queued_.size();
+		}
+
+		bool Ended() const
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			return ended_;
+		}
+
+		// Plays everything queued, returns the bytes played
+		std::vector<uint8_t> Drain()
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			std::vector<uint8_t> ret;
+			for (auto const & refill : queued_)
+			{
+				ret.insert(ret.end(), refill.begin(), refill.end());
+			}
+			queued_.clear();
+			return ret;
+		}
+
+		void Volume(float vol) override
+		{
+			KFL_UNUSED(vol);
+		}
+
+		bool IsPlaying() const override
+		{
+			return false;
+		}
+
+		float3 Position() const override
+		{
+			return float3::Zero();
+		}
+		void Position(float3 const & v) override
+		{
+			KFL_UNUSED(v);
+		}
+		float3 Velocity() const override
+		{
+			return float3::Zero();
+		}
+		void Velocity(float3 const & v) override
+		{
+			KFL_UNUSED(v);
+		}
+		float3 Direction() const override
+		{
+			return float3::Zero();
+		}
+		void Direction(float3 const & v) override
+		{
+			KFL_UNUSED(v);
+		}
+
+	private:
+		void DoReset() override
+		{
+		}
+		void DoPlay(bool loop) override
+		{
+			KFL_UNUSED(loop);
+		}
+		void DoStop() override
+		{
+		}
+
+		uint32_t FreeRefillSlots() override
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			return accept_refills_ ? num_slots_ - static_cast<uint32_t>(queued_.size()) : 0;
+		}
+
+		bool Starved() override
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			return queued_.empty();
+		}
+
+		void SubmitRefill(uint8_t const * data, uint32_t size) override
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			queued_.emplace_back(data, data + size);
+		}
+
+		void EndOfStream() override
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			ended_ = true;
+		}
+
+	private:
+		uint32_t num_slots_;
+		std::deque<std::vector<uint8_t>> queued_;
+		bool accept_refills_;
+		bool ended_;
+		mutable std::mutex mutex_;
+	};
+
+	bool WaitFor(std::function<bool()> const & pred)
+	{
+		auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+		while (!pred())
+		{
+			if (std::chrono::steady_clock::now() > deadline)
+			{
+				return false;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		}
+		return true;
+	}
+}
+
+TEST(AudioStreamingTest, PrimeOnAdd)
+{
+	AudioStreamingService service;
+
+	ManualMusicBuffer buffer(MakeSharedPtr<PatternDataSource>(100000), 4, false);
+	service.AddStream(buffer);
+
+	EXPECT_EQ(buffer.NumQueued(), 4U);
+	EXPECT_EQ(service.NumStreams(), 1U);
+
+	service.RemoveStream(buffer);
+	EXPECT_EQ(service.NumStreams(), 0U);
+}
+
+TEST(AudioStreamingTest, StreamToEnd)
+{
+	AudioStreamingService service;
+
+	size_t const source_size = 100000;
+	ManualMusicBuffer buffer(MakeSharedPtr<PatternDataSource>(source_size), 4, false);
+	service.AddStream(buffer);
+
+	std::vector<uint8_t> played;
+	EXPECT_TRUE(WaitFor([&buffer, &played]
+		{
+			auto const refills = buffer.Drain();
+			played.insert(played.end(), refills.begin(), refills.end());
+			return buffer.Ended();
+		}));
+	auto const tail = buffer.Drain();
+	played.insert(played.end(), tail.begin(), tail.end());
+
+	ASSERT_EQ(played.size(), source_size);
+	for (size_t i = 0; i < played.size(); ++ i)
+	{
+		EXPECT_EQ(played[i], static_cast<uint8_t>(i));
+	}
+
+	EXPECT_TRUE(WaitFor([&service]
+		{
+			return service.NumStreams() == 0;
+		}));
+	service.RemoveStream(buffer);
+}
+
+TEST(AudioStreamingTest, Loop)
+{
+	AudioStreamingService service;
+
+	size_t const source_size = 10000;
+	ManualMusicBuffer buffer(MakeSharedPtr<PatternDataSource>(source_size), 2, true);
+	service.AddStream(buffer);
+
+	std::vector<uint8_t> played;
+	EXPECT_TRUE(WaitFor([&buffer, &played, source_size]
+		{
+			auto const refills = buffer.Drain();
+			played.insert(played.end(), refills.begin(), refills.end());
+			return played.size() > source_size * 3;
+		}));
+	EXPECT_FALSE(buffer.Ended());
+
+	for (size_t i = 0; i < played.size(); ++ i)
+	{
+		EXPECT_EQ(played[i], static_cast<uint8_t>(i % source_size));
+	}
+
+	service.RemoveStream(buffer);
+	EXPECT_EQ(service.NumStreams(), 0U);
+}
+
+TEST(AudioStreamingTest, Underrun)
+{
+	AudioStreamingService service;
+
+	ManualMusicBuffer buffer(MakeSharedPtr<PatternDataSource>(100000), 2, false);
+	service.AddStream(buffer);
+	EXPECT_EQ(buffer.NumUnderruns(), 0U);
+
+	buffer.AcceptRefills(false);
+	buffer.Drain();
+	EXPECT_TRUE(WaitFor([&buffer]
+		{
+			return buffer.NumUnderruns() > 0;
+		}));
+	EXPECT_GE(service.NumUnderruns(), buffer.NumUnderruns());
+
+	service.RemoveStream(buffer);
+}
+
+TEST(AudioStreamingTest, ManyStreams)
+{
+	AudioStreamingService service(2);
+	service.PrefetchTime(0.5f);
+
+	std::vector<std::unique_ptr<ManualMusicBuffer>> buffers;
+	for (int i = 0; i < 32; ++ i)
+	{
+		buffers.push_back(MakeUniquePtr<ManualMusicBuffer>(MakeSharedPtr<PatternDataSource>(50000), 2, false));
+		service.AddStream(*buffers.back());
+	}
+	EXPECT_EQ(service.NumStreams(), buffers.size());
+
+	EXPECT_TRUE(WaitFor([&buffers]
+		{
+			bool all_ended = true;
+			for (auto& buffer : buffers)
+			{
+				buffer->Drain();
+				all_ended &= buffer->Ended();
+			}
+			return all_ended;
+		}));
+
+	for (auto& buffer : buffers)
+	{
+		service.RemoveStream(*buffer);
+	}
+	EXPECT_EQ(service.NumStreams(), 0U);
+}
+
+TEST(AudioStreamingTest, NullAudioReplay)
+{
+	Context::Instance().LoadAudioFactory("NullAudio");
+	ASSERT_TRUE(Context::Instance().AudioFactoryValid());
+	AudioFactory& af = Context::Instance().AudioFactoryInstance();
+
+	// Half a second of 8kHz mono16
+	auto source = MakeSharedPtr<PatternDataSource>(8000);
+	AudioBufferPtr buffer = af.MakeMusicBuffer(source, 1);
+
+	buffer->Play(false);
+	EXPECT_TRUE(buffer->IsPlaying());
+	buffer->Stop();
+	EXPECT_FALSE(buffer->IsPlaying());
+
+	// Played again after a stop, and again after running to the end. Each play streams the whole source.
+	for (int i = 0; i < 2; ++ i)
+	{
+		size_t const read_before = source->TotalRead();
+		buffer->Play(false);
+		EXPECT_TRUE(buffer->IsPlaying());
+		EXPECT_TRUE(WaitFor([&buffer]
+			{
+				return !buffer->IsPlaying();
+			}));
+		EXPECT_EQ(source->TotalRead() - read_before, 8000U);
+	}
+}
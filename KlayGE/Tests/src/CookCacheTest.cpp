@@ -0,0 +1,97 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/CXX17/filesystem.hpp>
+
+#include "CookCache.hpp"
+
+#include "KlayGETests.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	uint64_t HashString(std::string const & str, uint64_t seed = 0)
+	{
+		return HashBytes(reinterpret_cast<uint8_t const *>(str.data()), str.size(), seed);
+	}
+
+	std::vector<uint8_t> MakeBytes(std::string const & str)
+	{
+		return std::vector<uint8_t>(str.begin(), str.end());
+	}
+}
+
+TEST(CookCacheTest, HashBytes)
+{
+	// Reference xxHash64 values, seed 0
+	EXPECT_EQ(HashString(""), 0xEF46DB3751D8E999ULL);
+	EXPECT_EQ(HashString("a"), 0xD24EC4F1A98C6E5BULL);
+	EXPECT_EQ(HashString("abc"), 0x44BC2CF5AD770999ULL);
+	// Long enough to go through the 32-byte stripes, and the 8, 4 and 1-byte tails
+	EXPECT_EQ(HashString("Nobody inspects the spammish repetition"), 0xFBCEA83C8A378BF1ULL);
+
+	EXPECT_NE(HashString("abc", 1), HashString("abc"));
+	EXPECT_EQ(HashString("abc", 1), HashString("abc", 1));
+
+	EXPECT_EQ(HashToString(0xEF46DB3751D8E999ULL), "ef46db3751d8e999");
+	EXPECT_EQ(HashToString(0x1234), "0000000000001234");
+}
+
+TEST(CookCacheTest, LookupAndStore)
+{
+	filesystem::path const dir = filesystem::temp_directory_path() / "KlayGE_CookCacheTest";
+	filesystem::remove_all(dir);
+
+	uint64_t const config_hash = HashString("config");
+
+	std::vector<uint8_t> const input = MakeBytes("raw texture");
+	std::vector<uint8_t> const output = MakeBytes("cooked texture");
+	uint64_t const input_hash = HashBytes(input.data(), input.size());
+	uint64_t const output_hash = HashBytes(output.data(), output.size());
+	uint64_t const key = HashBytes(input.data(), input.size(), config_hash);
+	uint64_t const identity_key = HashBytes(output.data(), output.size(), config_hash);
+
+	{
+		CookCache cache(dir.string());
+
+		uint64_t hash;
+		EXPECT_FALSE(cache.Lookup(key, input, hash));
+
+		cache.Store(key, input_hash, input, identity_key, output_hash, output);
+
+		ASSERT_TRUE(cache.Lookup(key, input, hash));
+		EXPECT_EQ(hash, output_hash);
+
+		std::vector<uint8_t> fetched;
+		ASSERT_TRUE(cache.Fetch(hash, fetched));
+		EXPECT_EQ(fetched, output);
+
+		// A different input under the same key, like a hash collision, isn't a hit
+		EXPECT_FALSE(cache.Lookup(key, MakeBytes("other texture"), hash));
+
+		// A cooked output maps to itself, so cooking it again is a no-op
+		ASSERT_TRUE(cache.Lookup(identity_key, output, hash));
+		EXPECT_EQ(hash, output_hash);
+	}
+
+	{
+		// The manifest survives reopening
+		CookCache cache(dir.string());
+
+		uint64_t hash;
+		ASSERT_TRUE(cache.Lookup(key, input, hash));
+		EXPECT_EQ(hash, output_hash);
+		ASSERT_TRUE(cache.Lookup(identity_key, output, hash));
+		EXPECT_EQ(hash, output_hash);
+
+		// A blob that doesn't match its hash anymore isn't handed out
+		EXPECT_TRUE(WriteFileBytes((dir / (HashToString(output_hash) + ".bin")).string(), MakeBytes("corrupted")));
+		std::vector<uint8_t> fetched;
+		EXPECT_FALSE(cache.Fetch(output_hash, fetched));
+	}
+
+	filesystem::remove_all(dir);
+}
@@ -0,0 +1,118 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KlayGE/DistanceField.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <cmath>
+#include <random>
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	void TestVolumeDistance(uint32_t width, uint32_t height, uint32_t depth, uint32_t num_seeds)
+	{
+		std::vector<uint8_t> volume(width * height * depth, 0);
+		std::vector<uint32_t> seeds;
+		std::mt19937 gen(width * 131 + height * 17 + depth);
+		std::uniform_int_distribution<uint32_t> dis(0, static_cast<uint32_t>(volume.size() - 1));
+		for (uint32_t i = 0; i < num_seeds; ++ i)
+		{
+			uint32_t const seed = dis(gen);
+			volume[seed] = 255;
+			seeds.push_back(seed);
+		}
+
+		std::vector<float> dist_data;
+		ComputeVolumeDistance(volume, width, height, depth, dist_data);
+		ASSERT_EQ(dist_data.size(), volume.size());
+
+		for (uint32_t z = 0; z < depth; ++ z)
+		{
+			for (uint32_t y = 0; y < height; ++ y)
+			{
+				for (uint32_t x = 0; x < width; ++ x)
+				{
+					float min_dist_sq = 1e20f;
+					for (auto seed : seeds)
+					{
+						int const dx = static_cast<int>(x) - static_cast<int>(seed % width);
+						int const dy = static_cast<int>(y) - static_cast<int>(seed / width % height);
+						int const dz = static_cast<int>(z) - static_cast<int>(seed / (width * height));
+						min_dist_sq = std::min(min_dist_sq, static_cast<float>(dx * dx + dy * dy + dz * dz));
+					}
+
+					EXPECT_NEAR(dist_data[(z * height + y) * width + x], std::sqrt(min_dist_sq), 1e-3f);
+				}
+			}
+		}
+	}
+}
+
+TEST(DistanceFieldTest, VolumeDistance)
+{
+	TestVolumeDistance(17, 13, 9, 7);
+}
+
+TEST(DistanceFieldTest, VolumeDistanceParallel)
+{
+	TestVolumeDistance(64, 64, 8, 23);
+}
+
+TEST(DistanceFieldTest, VolumeDistanceEmpty)
+{
+	std::vector<uint8_t> volume(8 * 8 * 8, 0);
+	std::vector<float> dist_data;
+	ComputeVolumeDistance(volume, 8, 8, 8, dist_data);
+	for (auto d : dist_data)
+	{
+		EXPECT_GT(d, 1e9f);
+	}
+}
+
+TEST(DistanceFieldTest, AADiskDistance)
+{
+	uint32_t const size = 256;
+	float const radius = 40;
+	float const center = size / 4.0f;
+
+	// 2x super-sampled coverage of a disk, 4x4 samples per 2x texel
+	std::vector<float> aa_2x_data(size * size);
+	for (uint32_t y = 0; y < size; ++ y)
+	{
+		for (uint32_t x = 0; x < size; ++ x)
+		{
+			float coverage = 0;
+			for (uint32_t sy = 0; sy < 4; ++ sy)
+			{
+				for (uint32_t sx = 0; sx < 4; ++ sx)
+				{
+					float const px = (x + (sx + 0.5f) / 4) / 2 - center;
+					float const py = (y + (sy + 0.5f) / 4) / 2 - center;
+					if (px * px + py * py < radius * radius)
+					{
+						coverage += 1.0f / 16;
+					}
+				}
+			}
+			aa_2x_data[y * size + x] = coverage;
+		}
+	}
+
+	std::vector<float> dist_data;
+	ComputeDistance(aa_2x_data, size, size, dist_data);
+	ASSERT_EQ(dist_data.size(), static_cast<size_t>(size * size / 4));
+
+	uint32_t const half_size = size / 2;
+	for (uint32_t y = 0; y < half_size; ++ y)
+	{
+		for (uint32_t x = 0; x < half_size; ++ x)
+		{
+			float const dx = x + 0.5f - center;
+			float const dy = y + 0.5f - center;
+			float const expected = radius - std::sqrt(dx * dx + dy * dy);
+			EXPECT_NEAR(dist_data[y * half_size + x], expected, 0.5f);
+		}
+	}
+}
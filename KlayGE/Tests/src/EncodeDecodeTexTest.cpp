@@ -297,3 +297,119 @@ TEST_F(KlayGETest, EncodeDecodeETC1)
 {
 	TestEncodeDecodeTex("Lenna.dds", "", EF_ETC1, 4.8f);
 }
+
+// EncodeMem/DecodeMem spread block rows over the task scheduler, each task with its own codec. The results must match
+//  encoding and decoding every block one at a time.
+void TestBatchedEncodeDecode(TexCompression& codec, TexCompressionMethod method)
+{
+	// Not a multiple of the block size, with padded pitches, and enough blocks to go parallel
+	uint32_t const width = 70;
+	uint32_t const height = 45;
+	uint32_t const pixel_size = NumFormatBytes(codec.DecodedFormat());
+	uint32_t const block_width = codec.BlockWidth();
+	uint32_t const block_height = codec.BlockHeight();
+	uint32_t const block_bytes = codec.BlockBytes();
+	uint32_t const blocks_x = (width + block_width - 1) / block_width;
+	uint32_t const blocks_y = (height + block_height - 1) / block_height;
+	uint32_t const in_row_pitch = width * pixel_size + 12;
+	uint32_t const bc_row_pitch = blocks_x * block_bytes + 8;
+
+	std::vector<uint8_t> input(in_row_pitch * height);
+	uint32_t seed = 1;
+	for (uint32_t y = 0; y < height; ++ y)
+	{
+		for (uint32_t x = 0; x < width; ++ x)
+		{
+			seed = seed * 1664525U + 1013904223U;
+			uint8_t* pixel = &input[y * in_row_pitch + x * pixel_size];
+			pixel[0] = static_cast<uint8_t>(x * 3 + (seed >> 28));
+			pixel[1] = static_cast<uint8_t>(y * 5);
+			pixel[2] = static_cast<uint8_t>((x + y) * 2 + (seed >> 29));
+			pixel[3] = static_cast<uint8_t>(((x / 8 + y / 8) & 1) ? 255 : 128 + x);
+		}
+	}
+
+	TexCompressionPtr serial_codec = codec.Clone();
+
+	std::vector<uint8_t> serial_bc(bc_row_pitch * blocks_y, 0);
+	std::vector<uint8_t> uncompressed(block_width * block_height * pixel_size);
+	for (uint32_t by = 0; by < blocks_y; ++ by)
+	{
+		for (uint32_t bx = 0; bx < blocks_x; ++ bx)
+		{
+			for (uint32_t y = 0; y < block_height; ++ y)
+			{
+				for (uint32_t x = 0; x < block_width; ++ x)
+				{
+					uint32_t const src_x = bx * block_width + x;
+					uint32_t const src_y = by * block_height + y;
+					if ((src_x < width) && (src_y < height))
+					{
+						memcpy(&uncompressed[(y * block_width + x) * pixel_size],
+							&input[src_y * in_row_pitch + src_x * pixel_size], pixel_size);
+					}
+					else
+					{
+						memset(&uncompressed[(y * block_width + x) * pixel_size], 0, pixel_size);
+					}
+				}
+			}
+
+			serial_codec->EncodeBlock(&serial_bc[by * bc_row_pitch + bx * block_bytes], &uncompressed[0], method);
+		}
+	}
+
+	std::vector<uint8_t> batched_bc(bc_row_pitch * blocks_y, 0);
+	codec.EncodeMem(width, height, &batched_bc[0], bc_row_pitch, bc_row_pitch * blocks_y,
+		&input[0], in_row_pitch, in_row_pitch * height, method);
+	for (uint32_t by = 0; by < blocks_y; ++ by)
+	{
+		EXPECT_EQ(0, memcmp(&serial_bc[by * bc_row_pitch], &batched_bc[by * bc_row_pitch], blocks_x * block_bytes))
+			<< "block row " << by;
+	}
+
+	std::vector<uint8_t> serial_restored(in_row_pitch * height, 0);
+	std::vector<uint8_t> decoded(block_width * block_height * pixel_size);
+	for (uint32_t by = 0; by < blocks_y; ++ by)
+	{
+		for (uint32_t bx = 0; bx < blocks_x; ++ bx)
+		{
+			serial_codec->DecodeBlock(&decoded[0], &serial_bc[by * bc_row_pitch + bx * block_bytes]);
+			for (uint32_t y = 0; y < block_height; ++ y)
+			{
+				for (uint32_t x = 0; x < block_width; ++ x)
+				{
+					uint32_t const dst_x = bx * block_width + x;
+					uint32_t const dst_y = by * block_height + y;
+					if ((dst_x < width) && (dst_y < height))
+					{
+						memcpy(&serial_restored[dst_y * in_row_pitch + dst_x * pixel_size],
+							&decoded[(y * block_width + x) * pixel_size], pixel_size);
+					}
+				}
+			}
+		}
+	}
+
+	std::vector<uint8_t> batched_restored(in_row_pitch * height, 0);
+	codec.DecodeMem(width, height, &batched_restored[0], in_row_pitch, in_row_pitch * height,
+		&serial_bc[0], bc_row_pitch, bc_row_pitch * blocks_y);
+	for (uint32_t y = 0; y < height; ++ y)
+	{
+		EXPECT_EQ(0, memcmp(&serial_restored[y * in_row_pitch], &batched_restored[y * in_row_pitch], width * pixel_size))
+			<< "row " << y;
+	}
+}
+
+TEST_F(KlayGETest, BatchedEncodeDecodeBC1)
+{
+	TexCompressionBC1 codec;
+	TestBatchedEncodeDecode(codec, TCM_Balanced);
+}
+
+TEST_F(KlayGETest, BatchedEncodeDecodeBC7)
+{
+	TexCompressionBC7 codec;
+	TestBatchedEncodeDecode(codec, TCM_Speed);
+	TestBatchedEncodeDecode(codec, TCM_Quality);
+}
@@ -0,0 +1,228 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Math.hpp>
+#include <KFL/ResIdentifier.hpp>
+#include <KlayGE/Mesh.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	KeyFrames TestKeyFrames()
+	{
+		KeyFrames kf;
+		uint32_t const ids[] = { 0, 3, 4, 10, 11, 20 };
+		for (auto id : ids)
+		{
+			kf.frame_id.push_back(id);
+			kf.bind_real.push_back(MathLib::rotation_axis(float3(0, 1, 0), id * 0.1f));
+			kf.bind_dual.push_back(MathLib::quat_trans_to_udq(kf.bind_real.back(), float3(id * 1.0f, 0, 0)));
+			kf.bind_scale.push_back(1);
+		}
+		return kf;
+	}
+
+	KeyFramesType TestClipKeyFrames()
+	{
+		KeyFramesType kfs(2, TestKeyFrames());
+		for (size_t k = 0; k < kfs[1].frame_id.size(); ++ k)
+		{
+			kfs[1].bind_real[k] = MathLib::rotation_axis(MathLib::normalize(float3(1, 2, 3)), k * -0.7f);
+			kfs[1].bind_dual[k] = MathLib::quat_trans_to_udq(kfs[1].bind_real[k], float3(0.5f, k * -0.25f, 3));
+			kfs[1].bind_scale[k] = 1 + k * 0.5f;
+		}
+		return kfs;
+	}
+
+	void ExpectNearKey(KeyFrames const & kf, uint32_t index, Quaternion const & real, Quaternion const & dual, float scale)
+	{
+		for (int c = 0; c < 4; ++ c)
+		{
+			EXPECT_NEAR(kf.bind_real[index][c], real[c], 1e-4f);
+		}
+		float3 const expected_trans = MathLib::udq_to_trans(kf.bind_real[index], kf.bind_dual[index]);
+		float3 const trans = MathLib::udq_to_trans(real, dual);
+		for (int c = 0; c < 3; ++ c)
+		{
+			EXPECT_NEAR(expected_trans[c], trans[c], 1e-3f);
+		}
+		EXPECT_NEAR(kf.bind_scale[index], scale, 2e-3f);
+	}
+
+	void ExpectSameKeys(KeyFrames const & kf, float frame, uint32_t index0, uint32_t index1, float factor)
+	{
+		float const f = std::fmod(frame, static_cast<float>(kf.frame_id.back() + 1));
+		uint32_t const expected_index = static_cast<uint32_t>(std::upper_bound(kf.frame_id.begin(), kf.frame_id.end(), f)
+			- kf.frame_id.begin());
+		uint32_t const expected_index0 = expected_index - 1;
+		uint32_t const expected_index1 = expected_index % kf.frame_id.size();
+		EXPECT_EQ(expected_index0, index0);
+		EXPECT_EQ(expected_index1, index1);
+		EXPECT_FLOAT_EQ((f - kf.frame_id[expected_index0]) / (static_cast<float>(kf.frame_id[expected_index1])
+			- static_cast<float>(kf.frame_id[expected_index0])), factor);
+	}
+}
+
+TEST(KeyFramesTest, FrameKeysPlayback)
+{
+	KeyFrames const kf = TestKeyFrames();
+
+	uint32_t cursor = 0;
+	for (float frame = 0; frame < 60; frame += 0.37f)
+	{
+		uint32_t index0, index1;
+		float const factor = kf.FrameKeys(frame, cursor, index0, index1);
+		ExpectSameKeys(kf, frame, index0, index1, factor);
+	}
+}
+
+TEST(KeyFramesTest, FrameKeysSeek)
+{
+	KeyFrames const kf = TestKeyFrames();
+
+	uint32_t cursor = 0;
+	float const frames[] = { 15.5f, 2, 20.5f, 10, 10, 4.5f, 0, 19.9f };
+	for (auto frame : frames)
+	{
+		uint32_t index0, index1;
+		float const factor = kf.FrameKeys(frame, cursor, index0, index1);
+		ExpectSameKeys(kf, frame, index0, index1, factor);
+	}
+}
+
+TEST(KeyFramesTest, AnimationClipKeys)
+{
+	KeyFramesType const kfs = TestClipKeyFrames();
+	AnimationClip const clip(kfs, 0, 21);
+
+	ASSERT_EQ(2U, clip.NumTracks());
+	for (uint32_t i = 0; i < clip.NumTracks(); ++ i)
+	{
+		ASSERT_EQ(kfs[i].frame_id.size(), clip.NumKeys(i));
+		for (uint32_t k = 0; k < clip.NumKeys(i); ++ k)
+		{
+			EXPECT_EQ(kfs[i].frame_id[k], clip.KeyFrameId(i, k));
+
+			Quaternion real, dual;
+			float scale;
+			clip.DecodeKey(i, k, real, dual, scale);
+			ExpectNearKey(kfs[i], k, real, dual, scale);
+		}
+	}
+}
+
+TEST(KeyFramesTest, AnimationClipRange)
+{
+	KeyFramesType const kfs = TestClipKeyFrames();
+	AnimationClip const clip(kfs, 5, 11);
+
+	// Keys 4 and 11 are kept to interpolate the ends of the range
+	ASSERT_EQ(3U, clip.NumKeys(0));
+	EXPECT_EQ(4U, clip.KeyFrameId(0, 0));
+	EXPECT_EQ(10U, clip.KeyFrameId(0, 1));
+	EXPECT_EQ(11U, clip.KeyFrameId(0, 2));
+
+	uint32_t cursor = 0;
+	uint32_t index0, index1;
+	float factor = clip.FrameKeys(0, 7, cursor, index0, index1);
+	EXPECT_EQ(0U, index0);
+	EXPECT_EQ(1U, index1);
+	EXPECT_FLOAT_EQ(0.5f, factor);
+
+	factor = clip.FrameKeys(0, 2, cursor, index0, index1);
+	EXPECT_EQ(0U, index0);
+	EXPECT_FLOAT_EQ(0, factor);
+
+	factor = clip.FrameKeys(0, 30, cursor, index0, index1);
+	EXPECT_EQ(2U, index0);
+	EXPECT_EQ(2U, index1);
+	EXPECT_FLOAT_EQ(0, factor);
+}
+
+TEST(KeyFramesTest, AnimationClipSerialization)
+{
+	KeyFramesType const kfs = TestClipKeyFrames();
+	AnimationClip const clip(kfs, 0, 21);
+
+	auto ss = MakeSharedPtr<std::stringstream>();
+	clip.Write(*ss);
+	ResIdentifier res("clip", 0, ss);
+	AnimationClip read_clip;
+	read_clip.Read(res);
+
+	EXPECT_EQ(clip.StartFrame(), read_clip.StartFrame());
+	EXPECT_EQ(clip.EndFrame(), read_clip.EndFrame());
+	ASSERT_EQ(clip.NumTracks(), read_clip.NumTracks());
+	for (uint32_t i = 0; i < clip.NumTracks(); ++ i)
+	{
+		ASSERT_EQ(clip.NumKeys(i), read_clip.NumKeys(i));
+		for (uint32_t k = 0; k < clip.NumKeys(i); ++ k)
+		{
+			EXPECT_EQ(clip.KeyFrameId(i, k), read_clip.KeyFrameId(i, k));
+
+			Quaternion real, dual, read_real, read_dual;
+			float scale, read_scale;
+			clip.DecodeKey(i, k, real, dual, scale);
+			read_clip.DecodeKey(i, k, read_real, read_dual, read_scale);
+			EXPECT_TRUE(real == read_real);
+			EXPECT_TRUE(dual == read_dual);
+			EXPECT_EQ(scale, read_scale);
+		}
+	}
+}
+
+TEST(KeyFramesTest, AnimationClipsToKeyFrames)
+{
+	KeyFramesType const kfs = TestClipKeyFrames();
+
+	// Clips of neighbor actions share the keys around their boundary
+	KeyFramesType decoded;
+	AnimationClip(kfs, 0, 10).AppendKeyFrames(decoded);
+	AnimationClip(kfs, 10, 21).AppendKeyFrames(decoded);
+
+	ASSERT_EQ(kfs.size(), decoded.size());
+	for (size_t i = 0; i < kfs.size(); ++ i)
+	{
+		ASSERT_TRUE(kfs[i].frame_id == decoded[i].frame_id);
+		for (uint32_t k = 0; k < decoded[i].frame_id.size(); ++ k)
+		{
+			ExpectNearKey(kfs[i], k, decoded[i].bind_real[k], decoded[i].bind_dual[k], decoded[i].bind_scale[k]);
+		}
+	}
+}
+
+TEST(KeyFramesTest, SkinnedModelClipsCoverGaps)
+{
+	KeyFramesType const kfs = TestClipKeyFrames();
+
+	// Frames 3 to 9 belong to no action. They are played from the first clip, so its keys 4 and 10 can't be dropped.
+	auto actions = MakeSharedPtr<AnimationActionsType>(2);
+	(*actions)[0].start_frame = 0;
+	(*actions)[0].end_frame = 3;
+	(*actions)[1].start_frame = 10;
+	(*actions)[1].end_frame = 21;
+
+	SkinnedModel model(L"SkinnedModelClipsCoverGaps");
+	model.AttachActions(actions);
+	model.NumFrames(21);
+	model.AttachKeyFrames(MakeSharedPtr<KeyFramesType>(kfs));
+
+	auto const & clips = model.GetAnimationClips();
+	ASSERT_EQ(2U, clips.size());
+	EXPECT_EQ(0U, clips[0]->StartFrame());
+	EXPECT_EQ(10U, clips[0]->EndFrame());
+
+	auto const decoded = model.GetKeyFrames();
+	ASSERT_TRUE(decoded);
+	ASSERT_EQ(kfs.size(), decoded->size());
+	for (size_t i = 0; i < kfs.size(); ++ i)
+	{
+		EXPECT_TRUE(kfs[i].frame_id == (*decoded)[i].frame_id);
+	}
+}
@@ -0,0 +1,138 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KlayGE/LZMACodec.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <cstring>
+#include <system_error>
+#include <vector>
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	uint32_t const TEST_CHUNK_SIZE = 4096;
+	// Not a multiple of the chunk size, so the last chunk is a short one
+	uint32_t const TEST_DATA_SIZE = TEST_CHUNK_SIZE * 12 + 1234;
+
+	std::vector<uint8_t> MakeTestData()
+	{
+		// Runs of repeated bytes mixed with noise, so LZMA has something to squeeze but chunks differ in size
+		std::vector<uint8_t> data(TEST_DATA_SIZE);
+		uint32_t seed = 0x12345678U;
+		for (size_t i = 0; i < data.size(); ++ i)
+		{
+			seed = seed * 1664525U + 1013904223U;
+			data[i] = (seed & 0x300) ? static_cast<uint8_t>(i / 97) : static_cast<uint8_t>(seed >> 24);
+		}
+		return data;
+	}
+
+	uint64_t ReadChunkEnd(std::vector<uint8_t> const & encoded, uint32_t index)
+	{
+		// Ends follow the 24-byte header
+		uint64_t end;
+		std::memcpy(&end, &encoded[24 + index * sizeof(end)], sizeof(end));
+		return LE2Native(end);
+	}
+
+	void WriteChunkEnd(std::vector<uint8_t>& encoded, uint32_t index, uint64_t end)
+	{
+		end = Native2LE(end);
+		std::memcpy(&encoded[24 + index * sizeof(end)], &end, sizeof(end));
+	}
+}
+
+TEST_F(KlayGETest, LZMAChunkedRoundTrip)
+{
+	std::vector<uint8_t> const data = MakeTestData();
+
+	LZMACodec lzma;
+	std::vector<uint8_t> encoded;
+	lzma.EncodeChunked(encoded, data.data(), data.size(), TEST_CHUNK_SIZE);
+	EXPECT_EQ(lzma.ChunkedOriginalLength(encoded.data(), encoded.size()), data.size());
+
+	std::vector<uint8_t> decoded;
+	lzma.DecodeChunked(decoded, encoded.data(), encoded.size());
+	EXPECT_TRUE(decoded == data);
+}
+
+TEST_F(KlayGETest, LZMAChunkedRange)
+{
+	std::vector<uint8_t> const data = MakeTestData();
+
+	LZMACodec lzma;
+	std::vector<uint8_t> encoded;
+	lzma.EncodeChunked(encoded, data.data(), data.size(), TEST_CHUNK_SIZE);
+
+	struct Range
+	{
+		uint64_t offset;
+		uint64_t size;
+	};
+	Range const ranges[] =
+	{
+		{ 0, 1 },
+		{ 100, 200 },
+		{ TEST_CHUNK_SIZE, TEST_CHUNK_SIZE },
+		{ TEST_CHUNK_SIZE - 10, 20 },
+		{ TEST_CHUNK_SIZE / 2, TEST_CHUNK_SIZE * 5 },
+		{ TEST_DATA_SIZE - 1000, 1000 },
+		{ TEST_DATA_SIZE - 1, 1 },
+		{ 0, TEST_DATA_SIZE }
+	};
+	for (auto const & range : ranges)
+	{
+		std::vector<uint8_t> decoded(static_cast<size_t>(range.size));
+		lzma.DecodeChunkedRange(decoded.data(), encoded.data(), encoded.size(), range.offset, range.size);
+		EXPECT_EQ(0, std::memcmp(decoded.data(), &data[static_cast<size_t>(range.offset)], decoded.size()))
+			<< "offset " << range.offset << ", size " << range.size;
+	}
+
+	uint8_t dummy = 0;
+	lzma.DecodeChunkedRange(&dummy, encoded.data(), encoded.size(), TEST_DATA_SIZE, 0);
+	EXPECT_THROW(lzma.DecodeChunkedRange(&dummy, encoded.data(), encoded.size(), TEST_DATA_SIZE, 1), std::system_error);
+}
+
+TEST_F(KlayGETest, LZMAChunkedCorruptTable)
+{
+	std::vector<uint8_t> const data = MakeTestData();
+
+	LZMACodec lzma;
+	std::vector<uint8_t> encoded;
+	lzma.EncodeChunked(encoded, data.data(), data.size(), TEST_CHUNK_SIZE);
+
+	std::vector<uint8_t> decoded(TEST_CHUNK_SIZE);
+
+	// Ends going backwards. Decoding only the last chunk must catch it too, not just a full decode.
+	{
+		std::vector<uint8_t> corrupt = encoded;
+		uint64_t const end1 = ReadChunkEnd(corrupt, 1);
+		uint64_t const end2 = ReadChunkEnd(corrupt, 2);
+		WriteChunkEnd(corrupt, 1, end2);
+		WriteChunkEnd(corrupt, 2, end1);
+		EXPECT_THROW(lzma.DecodeChunkedRange(decoded.data(), corrupt.data(), corrupt.size(), TEST_CHUNK_SIZE * 2, 16),
+			std::system_error);
+		EXPECT_THROW(lzma.DecodeChunkedRange(decoded.data(), corrupt.data(), corrupt.size(), TEST_DATA_SIZE - 16, 16),
+			std::system_error);
+	}
+
+	// An empty chunk
+	{
+		std::vector<uint8_t> corrupt = encoded;
+		WriteChunkEnd(corrupt, 3, ReadChunkEnd(corrupt, 2));
+		EXPECT_THROW(lzma.DecodeChunkedRange(decoded.data(), corrupt.data(), corrupt.size(), TEST_CHUNK_SIZE * 3, 16),
+			std::system_error);
+	}
+
+	// A middle chunk pointing past the data
+	{
+		std::vector<uint8_t> corrupt = encoded;
+		WriteChunkEnd(corrupt, 5, corrupt.size());
+		EXPECT_THROW(lzma.DecodeChunkedRange(decoded.data(), corrupt.data(), corrupt.size(), 0, 16), std::system_error);
+	}
+
+	// Truncated data
+	EXPECT_THROW(lzma.DecodeChunkedRange(decoded.data(), encoded.data(), encoded.size() - 1, 0, 16), std::system_error);
+}
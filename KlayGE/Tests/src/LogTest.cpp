@@ -0,0 +1,127 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Log.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	size_t CountOccurrences(std::string const & str, std::string const & pattern)
+	{
+		size_t count = 0;
+		for (size_t pos = str.find(pattern); pos != std::string::npos; pos = str.find(pattern, pos + pattern.size()))
+		{
+			++ count;
+		}
+		return count;
+	}
+
+	// Redirects std::clog for the lifetime of the object. Everything queued before is written out first.
+	class ClogCapture
+	{
+	public:
+		ClogCapture()
+		{
+			LogFlush();
+			old_buf_ = std::clog.rdbuf(ss_.rdbuf());
+		}
+
+		~ClogCapture()
+		{
+			LogFlush();
+			std::clog.rdbuf(old_buf_);
+		}
+
+		std::string Str()
+		{
+			LogFlush();
+			return ss_.str();
+		}
+
+	private:
+		std::stringstream ss_;
+		std::streambuf* old_buf_;
+	};
+}
+
+TEST(LogTest, Filter)
+{
+	ClogCapture capture;
+
+	LogMinLevel(LL_Warn);
+	LogMessage(LL_Info, "LogTest", "hidden %d", 1);
+	LogMessage(LL_Warn, "LogTest", "shown %d", 2);
+	LogMinLevel(LL_Info);
+
+	LogCategoryEnabled("LogTestMuted", false);
+	LogMessage(LL_Warn, "LogTestMuted", "hidden %d", 3);
+	LogMessage(LL_Info, "LogTest", "shown %d", 4);
+	LogCategoryEnabled("LogTestMuted", true);
+	LogMessage(LL_Info, "LogTestMuted", "shown %d", 5);
+
+	std::string const str = capture.Str();
+	EXPECT_EQ(CountOccurrences(str, "hidden"), 0U);
+	EXPECT_EQ(CountOccurrences(str, "(WARN) LogTest: shown 2\n"), 1U);
+	EXPECT_EQ(CountOccurrences(str, "(INFO) LogTest: shown 4\n"), 1U);
+	EXPECT_EQ(CountOccurrences(str, "(INFO) LogTestMuted: shown 5\n"), 1U);
+}
+
+TEST(LogTest, RateLimit)
+{
+	ClogCapture capture;
+
+	LogRateLimit(3);
+	for (int i = 0; i < 20; ++ i)
+	{
+		LogMessage(LL_Info, "LogTest", "spam %d", i);
+	}
+	LogRateLimit(0);
+
+	EXPECT_LE(CountOccurrences(capture.Str(), "spam"), 6U);
+}
+
+TEST(LogTest, MultiThreaded)
+{
+	ClogCapture capture;
+
+	int const num_threads = 4;
+	int const num_messages = 1000;
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < num_threads; ++ t)
+	{
+		threads.emplace_back([t]
+			{
+				for (int i = 0; i < num_messages; ++ i)
+				{
+					LogMessage(LL_Info, "LogTest", "thread %d message %d", t, i);
+				}
+			});
+	}
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	std::string const str = capture.Str();
+	EXPECT_EQ(CountOccurrences(str, "(INFO) LogTest: thread "), static_cast<size_t>(num_threads * num_messages));
+
+	// Messages from one thread keep their order
+	size_t last_pos = 0;
+	for (int i = 0; i < num_messages; ++ i)
+	{
+		std::string const line = "thread 0 message " + std::to_string(i) + "\n";
+		size_t const pos = str.find(line);
+		ASSERT_NE(pos, std::string::npos);
+		EXPECT_GE(pos, last_pos);
+		last_pos = pos;
+	}
+}
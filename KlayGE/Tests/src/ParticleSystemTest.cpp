@@ -0,0 +1,193 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Math.hpp>
+#include <KlayGE/ParticleSystem.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	// Exposes the steps SubThreadUpdate runs, so they can be driven without a camera or a frame
+	class TestParticleSystem : public ParticleSystem
+	{
+	public:
+		explicit TestParticleSystem(uint32_t max_num_particles)
+			: ParticleSystem(max_num_particles)
+		{
+		}
+
+		using ParticleSystem::MakeSpan;
+		using ParticleSystem::EmitParticles;
+		using ParticleSystem::SortActiveParticles;
+	};
+
+	// Emits the given particles in order, all in one EmitParticles(1) call
+	class ListParticleEmitter : public ParticleEmitter
+	{
+	public:
+		ListParticleEmitter(SceneObjectPtr const & ps, std::vector<Particle> const & particles)
+			: ParticleEmitter(ps), particles_(particles), next_(0)
+		{
+			this->Frequency(static_cast<float>(particles.size()));
+		}
+
+		std::string const & Type() const override
+		{
+			static std::string const type("list");
+			return type;
+		}
+
+		ParticleEmitterPtr Clone() override
+		{
+			return MakeSharedPtr<ListParticleEmitter>(ps_.lock(), particles_);
+		}
+
+		void Emit(Particle& par) override
+		{
+			par = particles_[next_];
+			++ next_;
+		}
+
+	private:
+		std::vector<Particle> particles_;
+		size_t next_;
+	};
+
+	Particle MakeParticle(float3 const & pos, float3 const & vel, float life, float init_life)
+	{
+		Particle par;
+		par.pos = pos;
+		par.vel = vel;
+		par.life = life;
+		par.spin = 0;
+		par.size = 1;
+		par.alpha = 1;
+		par.init_life = init_life;
+		return par;
+	}
+
+	void ExpectNearRelative(float expected, float actual)
+	{
+		EXPECT_NEAR(expected, actual, 1e-4f * std::max(1.0f, std::abs(expected)));
+	}
+}
+
+TEST_F(KlayGETest, ParticleRadixSort)
+{
+	uint32_t const num_particles = 1003;
+
+	// Depths on both sides of the camera, some sharing their high bytes, a few exact duplicates to check stability
+	std::ranlux24_base gen(1);
+	std::uniform_real_distribution<float> wide_dis(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> narrow_dis(10.0f, 10.5f);
+	std::vector<Particle> particles;
+	for (uint32_t i = 0; i < num_particles; ++ i)
+	{
+		float depth;
+		if (i % 7 == 6)
+		{
+			depth = particles[i - 3].pos.z();
+		}
+		else if (i % 3 == 0)
+		{
+			depth = narrow_dis(gen);
+		}
+		else
+		{
+			depth = wide_dis(gen);
+		}
+		if (0 == depth)
+		{
+			depth = 1;
+		}
+		particles.push_back(MakeParticle(float3(0, 0, depth), float3(0, 0, 0), 1, 1));
+	}
+
+	auto ps = MakeSharedPtr<TestParticleSystem>(num_particles);
+	ps->AddEmitter(MakeSharedPtr<ListParticleEmitter>(ps, particles));
+	ps->EmitParticles(1);
+	ASSERT_EQ(ps->MakeSpan(0, num_particles).num, num_particles);
+
+	// With an identity view, the sort depth is z
+	ps->SortActiveParticles(float4x4::Identity());
+	ASSERT_EQ(ps->NumActiveParticles(), num_particles);
+
+	std::vector<uint32_t> expected(num_particles);
+	for (uint32_t i = 0; i < num_particles; ++ i)
+	{
+		expected[i] = i;
+	}
+	std::stable_sort(expected.begin(), expected.end(), [&particles](uint32_t lhs, uint32_t rhs)
+		{
+			return particles[lhs].pos.z() > particles[rhs].pos.z();
+		});
+
+	for (uint32_t i = 0; i < num_particles; ++ i)
+	{
+		EXPECT_EQ(ps->GetActiveParticleIndex(i), expected[i]) << "position " << i;
+	}
+}
+
+TEST_F(KlayGETest, PolylineParticleBatchUpdate)
+{
+	uint32_t const num_particles = 37;
+	float const elapsed_time = 0.03f;
+
+	std::ranlux24_base gen(2);
+	std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
+	std::vector<Particle> particles;
+	for (uint32_t i = 0; i < num_particles; ++ i)
+	{
+		float const init_life = 2 + dis(gen);
+		float const life = init_life * (0.5f + dis(gen) * 0.49f);
+		particles.push_back(MakeParticle(float3(dis(gen), dis(gen), dis(gen)) * 10,
+			float3(dis(gen), dis(gen), dis(gen)), life, init_life));
+	}
+
+	auto ps = MakeSharedPtr<TestParticleSystem>(num_particles);
+	ps->Gravity(0.5f);
+	ps->Force(float3(0.1f, 0.2f, -0.3f));
+	ps->MediaDensity(0.7f);
+
+	auto updater = MakeSharedPtr<PolylineParticleUpdater>(ps);
+	updater->SizeOverLife({ float2(0, 1), float2(1, 2) });
+	updater->MassOverLife({ float2(0, 1), float2(0.5f, 2), float2(1, 0.5f) });
+	updater->OpacityOverLife({ float2(0, 1), float2(1, 0) });
+
+	ps->AddEmitter(MakeSharedPtr<ListParticleEmitter>(ps, particles));
+	ps->EmitParticles(1);
+
+	// Starting at 1, so the span has an unaligned head, full batches of 4 and a tail
+	ParticleSpan const span = ps->MakeSpan(1, num_particles);
+	updater->BatchUpdate(span, elapsed_time);
+
+	for (uint32_t i = 0; i < span.num; ++ i)
+	{
+		Particle expected = particles[i + 1];
+		updater->Update(expected, elapsed_time);
+
+		Particle const actual = span.Get(i);
+		for (uint32_t j = 0; j < 3; ++ j)
+		{
+			ExpectNearRelative(expected.pos[j], actual.pos[j]);
+			ExpectNearRelative(expected.vel[j], actual.vel[j]);
+		}
+		ExpectNearRelative(expected.life, actual.life);
+		ExpectNearRelative(expected.spin, actual.spin);
+		ExpectNearRelative(expected.size, actual.size);
+		ExpectNearRelative(expected.alpha, actual.alpha);
+		ExpectNearRelative(expected.init_life, actual.init_life);
+	}
+
+	// The particle outside the span is untouched
+	Particle const first = ps->GetParticle(0);
+	EXPECT_EQ(first.pos, particles[0].pos);
+	EXPECT_EQ(first.life, particles[0].life);
+}
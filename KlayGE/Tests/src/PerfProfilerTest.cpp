@@ -0,0 +1,140 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KlayGE/PerfProfiler.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	size_t CountOccurrences(std::string const & str, std::string const & pattern)
+	{
+		size_t count = 0;
+		for (size_t pos = str.find(pattern); pos != std::string::npos; pos = str.find(pattern, pos + pattern.size()))
+		{
+			++ count;
+		}
+		return count;
+	}
+
+	std::string ReadAll(std::string const & file_name)
+	{
+		std::ifstream ifs(file_name.c_str());
+		std::stringstream ss;
+		ss << ifs.rdbuf();
+		return ss.str();
+	}
+}
+
+TEST(PerfProfilerTest, ChromeTrace)
+{
+	PerfProfiler::ZonesEnabled(true);
+	{
+		PerfProfiler& profiler = PerfProfiler::Instance();
+		profiler.ThreadName("Test \"main\"");
+
+		{
+			PerfZone outer("Outer");
+			{
+				PerfZone inner("Inner");
+			}
+			profiler.Counter("Items", 42);
+		}
+
+		std::thread worker([&profiler]()
+			{
+				profiler.ThreadName("Worker");
+				PerfZone zone("Work");
+			});
+		worker.join();
+
+		std::string const file_name = "PerfProfilerTest.json";
+		profiler.ExportToChromeTrace(file_name);
+		std::string const trace = ReadAll(file_name);
+
+		EXPECT_EQ(trace.find("{\"traceEvents\":["), 0U);
+		EXPECT_EQ(CountOccurrences(trace, "\"ph\":\"B\""), 3U);
+		EXPECT_EQ(CountOccurrences(trace, "\"ph\":\"E\""), 3U);
+		EXPECT_EQ(CountOccurrences(trace, "\"ph\":\"C\""), 1U);
+		EXPECT_EQ(CountOccurrences(trace, "\"ph\":\"M\""), 2U);
+		EXPECT_NE(trace.find("\"name\":\"Test \\\"main\\\"\""), std::string::npos);
+		EXPECT_NE(trace.find("\"args\":{\"value\":42.000}"), std::string::npos);
+
+		// The worker's zone lives on its own track
+		EXPECT_NE(trace.find("{\"ph\":\"B\",\"pid\":0,\"tid\":1,\"ts\":"), std::string::npos);
+
+		// Begin comes before the matching end on each thread
+		EXPECT_LT(trace.find("\"name\":\"Inner\""), trace.rfind("\"name\":\"Inner\""));
+	}
+	PerfProfiler::ZonesEnabled(false);
+	PerfProfiler::Destroy();
+}
+
+TEST(PerfProfilerTest, ChromeTraceWrapped)
+{
+	PerfProfiler::ZonesEnabled(true);
+	{
+		PerfProfiler& profiler = PerfProfiler::Instance();
+		{
+			// More events than a thread keeps, so Outer's begin is overwritten
+			PerfZone outer("Outer");
+			for (uint32_t i = 0; i < 40000; ++ i)
+			{
+				PerfZone inner("Inner");
+			}
+		}
+		PerfZone open("Open");
+
+		std::string const file_name = "PerfProfilerWrappedTest.json";
+		profiler.ExportToChromeTrace(file_name);
+		std::string const trace = ReadAll(file_name);
+
+		EXPECT_EQ(CountOccurrences(trace, "\"ph\":\"B\""), CountOccurrences(trace, "\"ph\":\"E\""));
+		EXPECT_EQ(trace.find("\"name\":\"Outer\""), std::string::npos);
+		EXPECT_EQ(CountOccurrences(trace, "\"name\":\"Open\""), 2U);
+
+		// No end before its begin
+		int depth = 0;
+		int min_depth = 0;
+		for (size_t pos = trace.find("\"ph\":\""); pos != std::string::npos; pos = trace.find("\"ph\":\"", pos + 1))
+		{
+			char const ph = trace[pos + 6];
+			if ('B' == ph)
+			{
+				++ depth;
+			}
+			else if ('E' == ph)
+			{
+				-- depth;
+				min_depth = std::min(min_depth, depth);
+			}
+		}
+		EXPECT_EQ(depth, 0);
+		EXPECT_EQ(min_depth, 0);
+	}
+	PerfProfiler::ZonesEnabled(false);
+	PerfProfiler::Destroy();
+}
+
+TEST(PerfProfilerTest, DisabledZones)
+{
+	PerfProfiler::ZonesEnabled(false);
+	{
+		PerfZone zone("Ignored");
+		KLAYGE_PERF_COUNTER("Ignored", 1);
+	}
+
+	std::string const file_name = "PerfProfilerDisabledTest.json";
+	PerfProfiler::Instance().ExportToChromeTrace(file_name);
+	std::string const trace = ReadAll(file_name);
+
+	EXPECT_EQ(trace.find("Ignored"), std::string::npos);
+	PerfProfiler::Destroy();
+}
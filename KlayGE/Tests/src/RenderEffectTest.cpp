@@ -0,0 +1,147 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KlayGE/Context.hpp>
+#include <KlayGE/GraphicsBuffer.hpp>
+#include <KlayGE/RenderEffect.hpp>
+#include <KlayGE/RenderEngine.hpp>
+#include <KlayGE/RenderFactory.hpp>
+#include <KlayGE/Texture.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <vector>
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	struct ParamBinds
+	{
+		uint32_t applied;
+		uint32_t skipped;
+	};
+
+	ParamBinds BindFirstPass(RenderEffect const & effect, RenderTechnique const & tech)
+	{
+		RenderEngine& re = Context::Instance().RenderFactoryInstance().RenderEngineInstance();
+		re.NumParamBindsJustApplied();
+		re.NumParamBindsJustSkipped();
+
+		auto const & pass = tech.Pass(0);
+		pass.Bind(effect);
+		pass.Unbind(effect);
+
+		ParamBinds ret;
+		ret.applied = re.NumParamBindsJustApplied();
+		ret.skipped = re.NumParamBindsJustSkipped();
+		return ret;
+	}
+}
+
+TEST(RenderEffectTest, VariableVersion)
+{
+	RenderVariableFloat4 var;
+	var = float4(1, 2, 3, 4);
+	uint32_t version = var.Version();
+	EXPECT_NE(version, 0U);
+
+	// Assigning an equal value isn't a change
+	var = float4(1, 2, 3, 4);
+	EXPECT_EQ(var.Version(), version);
+
+	var = float4(4, 3, 2, 1);
+	EXPECT_GT(var.Version(), version);
+	version = var.Version();
+
+	std::unique_ptr<RenderVariable> clone = var.Clone();
+	float4 clone_val;
+	clone->Value(clone_val);
+	EXPECT_EQ(clone_val, float4(4, 3, 2, 1));
+	EXPECT_EQ(var.Version(), version);
+
+	RenderVariableFloatArray arr;
+	std::vector<float> vals = { 1, 2, 3 };
+	arr = vals;
+	version = arr.Version();
+
+	arr = vals;
+	EXPECT_EQ(arr.Version(), version);
+
+	vals.push_back(4);
+	arr = vals;
+	EXPECT_GT(arr.Version(), version);
+}
+
+TEST_F(KlayGETest, ParameterBindSkipping)
+{
+	RenderFactory& rf = Context::Instance().RenderFactoryInstance();
+
+	TexturePtr tex0 = rf.MakeTexture2D(4, 4, 1, 1, EF_ABGR8, 1, 0, EAH_GPU_Read);
+	TexturePtr tex1 = rf.MakeTexture2D(4, 4, 1, 1, EF_ABGR8, 1, 0, EAH_GPU_Read);
+
+	RenderEffectPtr effect = SyncLoadRenderEffect("Copy.fxml");
+	RenderTechnique* tech = effect->TechniqueByName("Copy");
+	*(effect->ParameterByName("src_tex")) = tex0;
+
+	ParamBinds binds = BindFirstPass(*effect, *tech);
+	uint32_t const num_binds = binds.applied + binds.skipped;
+	EXPECT_GT(binds.applied, 0U);
+
+	// Nothing changed, every binding is skipped
+	binds = BindFirstPass(*effect, *tech);
+	EXPECT_EQ(binds.applied, 0U);
+	EXPECT_EQ(binds.skipped, num_binds);
+
+	*(effect->ParameterByName("src_tex")) = tex0;
+	binds = BindFirstPass(*effect, *tech);
+	EXPECT_EQ(binds.applied, 0U);
+
+	*(effect->ParameterByName("src_tex")) = tex1;
+	binds = BindFirstPass(*effect, *tech);
+	EXPECT_EQ(binds.applied, 1U);
+	EXPECT_EQ(binds.skipped, num_binds - 1);
+
+	// Another effect has its own bindings. They're applied even though the values match what the first one just bound.
+	RenderEffectPtr effect2 = SyncLoadRenderEffect("Copy.fxml");
+	RenderTechnique* tech2 = effect2->TechniqueByName("Copy");
+	*(effect2->ParameterByName("src_tex")) = tex1;
+	binds = BindFirstPass(*effect2, *tech2);
+	EXPECT_EQ(binds.applied, num_binds);
+
+	// Back to the first effect, its skipped bindings still reflect its own values
+	binds = BindFirstPass(*effect, *tech);
+	EXPECT_EQ(binds.applied, 0U);
+	EXPECT_EQ(binds.skipped, num_binds);
+
+	*(effect2->ParameterByName("src_tex")) = tex0;
+	binds = BindFirstPass(*effect, *tech);
+	EXPECT_EQ(binds.applied, 0U);
+	binds = BindFirstPass(*effect2, *tech2);
+	EXPECT_EQ(binds.applied, 1U);
+}
+
+TEST_F(KlayGETest, ParameterBindWaitsForBuffer)
+{
+	RenderFactory& rf = Context::Instance().RenderFactoryInstance();
+
+	RenderEffectPtr effect = SyncLoadRenderEffect("FFT.fxml");
+	RenderTechnique* tech = effect->TechniqueByName("Buf2Tex");
+	ASSERT_TRUE(tech->Validate());
+
+	BindFirstPass(*effect, *tech);
+	EXPECT_EQ(BindFirstPass(*effect, *tech).applied, 0U);
+
+	GraphicsBufferPtr buf = rf.MakeDelayCreationVertexBuffer(BU_Dynamic, EAH_GPU_Read | EAH_GPU_Structured,
+		16 * sizeof(float2), EF_GR32F);
+	*(effect->ParameterByName("input_buf")) = buf;
+
+	// Without a hardware resource, the buffer keeps being reapplied
+	for (int i = 0; i < 3; ++ i)
+	{
+		EXPECT_EQ(BindFirstPass(*effect, *tech).applied, 1U);
+	}
+
+	buf->CreateHWResource(nullptr);
+	EXPECT_EQ(BindFirstPass(*effect, *tech).applied, 1U);
+	EXPECT_EQ(BindFirstPass(*effect, *tech).applied, 0U);
+}
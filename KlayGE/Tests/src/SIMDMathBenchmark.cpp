@@ -0,0 +1,271 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Math.hpp>
+#include <KFL/SIMDMath.hpp>
+#include <KFL/Timer.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <vector>
+#include <iostream>
+
+using namespace std;
+using namespace KlayGE;
+
+// Each benchmark runs the scalar MathLib loop and the batch kernel on the same data, and only checks that they agree.
+//  Timings go to stdout. They're disabled so the regular test run stays fast, run them with
+//  --gtest_also_run_disabled_tests --gtest_filter=SIMDMathBenchmark.*
+
+namespace
+{
+	size_t const NUM_ITEMS = 16384;
+	int const NUM_ROUNDS = 50;
+
+	float RandomFloat(float low, float high)
+	{
+		return low + (high - low) * rand() / RAND_MAX;
+	}
+
+	Frustum BenchmarkFrustum()
+	{
+		float4x4 const view_proj = MathLib::look_at_lh(float3(0, 0, 0), float3(0, 0, 1))
+			* MathLib::perspective_fov_lh(PI / 3, 1.5f, 0.5f, 100.0f);
+		Frustum frustum;
+		frustum.ClipMatrix(view_proj, MathLib::inverse(view_proj));
+		return frustum;
+	}
+
+	void Report(char const * name, double scalar_time, double batch_time)
+	{
+		cout << name << ": scalar " << scalar_time * 1000 << " ms, batch " << batch_time * 1000 << " ms, "
+			<< scalar_time / batch_time << "x" << endl;
+	}
+}
+
+TEST(SIMDMathBenchmark, DISABLED_IntersectAABBsFrustum)
+{
+	Frustum const frustum = BenchmarkFrustum();
+
+	std::vector<AABBox> aabbs(NUM_ITEMS);
+	std::vector<float> bounds[6];
+	for (auto& b : bounds)
+	{
+		b.resize(NUM_ITEMS);
+	}
+	srand(1);
+	for (size_t i = 0; i < NUM_ITEMS; ++ i)
+	{
+		float3 const center(RandomFloat(-100, 100), RandomFloat(-100, 100), RandomFloat(-20, 120));
+		float3 const half_size(RandomFloat(0.5f, 4), RandomFloat(0.5f, 4), RandomFloat(0.5f, 4));
+		aabbs[i] = AABBox(center - half_size, center + half_size);
+		for (int j = 0; j < 3; ++ j)
+		{
+			bounds[j][i] = aabbs[i].Min()[j];
+			bounds[j + 3][i] = aabbs[i].Max()[j];
+		}
+	}
+
+	std::vector<BoundOverlap> scalar_results(NUM_ITEMS);
+	std::vector<BoundOverlap> batch_results(NUM_ITEMS);
+
+	Timer timer;
+	for (int r = 0; r < NUM_ROUNDS; ++ r)
+	{
+		for (size_t i = 0; i < NUM_ITEMS; ++ i)
+		{
+			scalar_results[i] = MathLib::intersect_aabb_frustum(aabbs[i], frustum);
+		}
+	}
+	double const scalar_time = timer.elapsed();
+
+	timer.restart();
+	for (int r = 0; r < NUM_ROUNDS; ++ r)
+	{
+		SIMDMathLib::IntersectAABBsFrustum(&batch_results[0], &bounds[0][0], &bounds[1][0], &bounds[2][0],
+			&bounds[3][0], &bounds[4][0], &bounds[5][0], NUM_ITEMS, frustum);
+	}
+	double const batch_time = timer.elapsed();
+
+	Report("IntersectAABBsFrustum", scalar_time, batch_time);
+	EXPECT_TRUE(scalar_results == batch_results);
+}
+
+TEST(SIMDMathBenchmark, DISABLED_IntersectSpheresFrustum)
+{
+	Frustum const frustum = BenchmarkFrustum();
+
+	std::vector<Sphere> spheres(NUM_ITEMS);
+	std::vector<float> soa[4];
+	for (auto& s : soa)
+	{
+		s.resize(NUM_ITEMS);
+	}
+	srand(2);
+	for (size_t i = 0; i < NUM_ITEMS; ++ i)
+	{
+		spheres[i] = Sphere(float3(RandomFloat(-100, 100), RandomFloat(-100, 100), RandomFloat(-20, 120)),
+			RandomFloat(0.5f, 4));
+		for (int j = 0; j < 3; ++ j)
+		{
+			soa[j][i] = spheres[i].Center()[j];
+		}
+		soa[3][i] = spheres[i].Radius();
+	}
+
+	std::vector<BoundOverlap> scalar_results(NUM_ITEMS);
+	std::vector<BoundOverlap> batch_results(NUM_ITEMS);
+
+	Timer timer;
+	for (int r = 0; r < NUM_ROUNDS; ++ r)
+	{
+		for (size_t i = 0; i < NUM_ITEMS; ++ i)
+		{
+			scalar_results[i] = MathLib::intersect_sphere_frustum(spheres[i], frustum);
+		}
+	}
+	double const scalar_time = timer.elapsed();
+
+	timer.restart();
+	for (int r = 0; r < NUM_ROUNDS; ++ r)
+	{
+		SIMDMathLib::IntersectSpheresFrustum(&batch_results[0], &soa[0][0], &soa[1][0], &soa[2][0], &soa[3][0],
+			NUM_ITEMS, frustum);
+	}
+	double const batch_time = timer.elapsed();
+
+	Report("IntersectSpheresFrustum", scalar_time, batch_time);
+	EXPECT_TRUE(scalar_results == batch_results);
+}
+
+TEST(SIMDMathBenchmark, DISABLED_TransformAABBs)
+{
+	AABBox const aabb(float3(-1, -2, -0.5f), float3(1, 2, 3));
+	std::vector<float4x4> mats(NUM_ITEMS);
+	srand(3);
+	for (auto& mat : mats)
+	{
+		mat = MathLib::scaling(float3(RandomFloat(0.5f, 2), RandomFloat(0.5f, 2), RandomFloat(0.5f, 2)))
+			* MathLib::rotation_y(RandomFloat(-PI, PI))
+			* MathLib::translation(RandomFloat(-10, 10), RandomFloat(-10, 10), RandomFloat(-10, 10));
+	}
+
+	std::vector<AABBox> scalar_results(NUM_ITEMS);
+	std::vector<AABBox> batch_results(NUM_ITEMS);
+
+	Timer timer;
+	for (int r = 0; r < NUM_ROUNDS; ++ r)
+	{
+		for (size_t i = 0; i < NUM_ITEMS; ++ i)
+		{
+			scalar_results[i] = MathLib::transform_aabb(aabb, mats[i]);
+		}
+	}
+	double const scalar_time = timer.elapsed();
+
+	timer.restart();
+	for (int r = 0; r < NUM_ROUNDS; ++ r)
+	{
+		SIMDMathLib::TransformAABBs(&batch_results[0], aabb, &mats[0], NUM_ITEMS);
+	}
+	double const batch_time = timer.elapsed();
+
+	Report("TransformAABBs", scalar_time, batch_time);
+	for (size_t i = 0; i < NUM_ITEMS; ++ i)
+	{
+		EXPECT_LT(MathLib::length(scalar_results[i].Min() - batch_results[i].Min()), 1e-3f);
+		EXPECT_LT(MathLib::length(scalar_results[i].Max() - batch_results[i].Max()), 1e-3f);
+	}
+}
+
+TEST(SIMDMathBenchmark, DISABLED_MultiplyMatrices)
+{
+	std::vector<float4x4> lhs(NUM_ITEMS);
+	srand(4);
+	for (auto& mat : lhs)
+	{
+		for (auto& elem : mat)
+		{
+			elem = RandomFloat(-2, 2);
+		}
+	}
+	float4x4 const rhs = MathLib::look_at_lh(float3(1, 2, 3), float3(0, 0, 0));
+
+	std::vector<float4x4> scalar_results(NUM_ITEMS);
+	std::vector<float4x4> batch_results(NUM_ITEMS);
+
+	Timer timer;
+	for (int r = 0; r < NUM_ROUNDS; ++ r)
+	{
+		for (size_t i = 0; i < NUM_ITEMS; ++ i)
+		{
+			scalar_results[i] = lhs[i] * rhs;
+		}
+	}
+	double const scalar_time = timer.elapsed();
+
+	timer.restart();
+	for (int r = 0; r < NUM_ROUNDS; ++ r)
+	{
+		SIMDMathLib::MultiplyMatrices(&batch_results[0], &lhs[0], rhs, NUM_ITEMS);
+	}
+	double const batch_time = timer.elapsed();
+
+	Report("MultiplyMatrices", scalar_time, batch_time);
+	for (size_t i = 0; i < NUM_ITEMS; ++ i)
+	{
+		for (int j = 0; j < 16; ++ j)
+		{
+			EXPECT_NEAR(scalar_results[i][j], batch_results[i][j], 1e-4f);
+		}
+	}
+}
+
+TEST(SIMDMathBenchmark, DISABLED_BlendDualQuaternions)
+{
+	std::vector<Quaternion> reals0(NUM_ITEMS), duals0(NUM_ITEMS), reals1(NUM_ITEMS), duals1(NUM_ITEMS);
+	std::vector<float> factors(NUM_ITEMS);
+	srand(5);
+	for (size_t i = 0; i < NUM_ITEMS; ++ i)
+	{
+		reals0[i] = MathLib::rotation_axis(float3(0, 1, 0), RandomFloat(-PI, PI));
+		reals1[i] = MathLib::rotation_axis(float3(1, 0, 0), RandomFloat(-PI, PI));
+		duals0[i] = MathLib::quat_trans_to_udq(reals0[i], float3(RandomFloat(-5, 5), 0, RandomFloat(-5, 5)));
+		duals1[i] = MathLib::quat_trans_to_udq(reals1[i], float3(0, RandomFloat(-5, 5), RandomFloat(-5, 5)));
+		factors[i] = RandomFloat(0, 1);
+	}
+
+	std::vector<Quaternion> scalar_reals(NUM_ITEMS), scalar_duals(NUM_ITEMS);
+	std::vector<Quaternion> batch_reals(NUM_ITEMS), batch_duals(NUM_ITEMS);
+
+	Timer timer;
+	for (int r = 0; r < NUM_ROUNDS; ++ r)
+	{
+		for (size_t i = 0; i < NUM_ITEMS; ++ i)
+		{
+			float const w1 = (MathLib::dot(reals0[i], reals1[i]) < 0) ? -factors[i] : factors[i];
+			Quaternion const real = reals0[i] * (1 - factors[i]) + reals1[i] * w1;
+			Quaternion const dual = duals0[i] * (1 - factors[i]) + duals1[i] * w1;
+			float const inv_len = 1 / MathLib::length(real);
+			scalar_reals[i] = real * inv_len;
+			scalar_duals[i] = dual * inv_len;
+		}
+	}
+	double const scalar_time = timer.elapsed();
+
+	timer.restart();
+	for (int r = 0; r < NUM_ROUNDS; ++ r)
+	{
+		SIMDMathLib::BlendDualQuaternions(&batch_reals[0], &batch_duals[0], &reals0[0], &duals0[0], &reals1[0], &duals1[0],
+			&factors[0], NUM_ITEMS);
+	}
+	double const batch_time = timer.elapsed();
+
+	Report("BlendDualQuaternions", scalar_time, batch_time);
+	for (size_t i = 0; i < NUM_ITEMS; ++ i)
+	{
+		for (int j = 0; j < 4; ++ j)
+		{
+			EXPECT_NEAR(scalar_reals[i][j], batch_reals[i][j], 1e-4f);
+			EXPECT_NEAR(scalar_duals[i][j], batch_duals[i][j], 1e-4f);
+		}
+	}
+}
@@ -31,3 +31,237 @@ TEST(SIMDMathTest, NormalizeVector4)
 	v = SIMDMathLib::NormalizeVector4(v);
 	EXPECT_LT(MathLib::abs(SIMDMathLib::GetX(SIMDMathLib::LengthVector4(v)) - 1.0f), 1e-3f);
 }
+
+namespace
+{
+	Frustum TestFrustum()
+	{
+		float4x4 const view_proj = MathLib::look_at_lh(float3(1, 2, -3), float3(0, 0, 10))
+			* MathLib::perspective_fov_lh(PI / 4, 1.5f, 0.5f, 50.0f);
+		Frustum frustum;
+		frustum.ClipMatrix(view_proj, MathLib::inverse(view_proj));
+		return frustum;
+	}
+
+	float RandomFloat(float low, float high)
+	{
+		return low + (high - low) * rand() / RAND_MAX;
+	}
+
+	void ExpectNear(float3 const & lhs, float3 const & rhs, float tolerance)
+	{
+		for (int i = 0; i < 3; ++ i)
+		{
+			EXPECT_NEAR(lhs[i], rhs[i], tolerance);
+		}
+	}
+}
+
+TEST(SIMDMathTest, IntersectAABBsFrustum)
+{
+	Frustum const frustum = TestFrustum();
+
+	// 1003 is not a multiple of any vector width, so the tail is covered too
+	size_t const num = 1003;
+	std::vector<float> bounds[6];
+	for (auto& b : bounds)
+	{
+		b.resize(num);
+	}
+	srand(1);
+	for (size_t i = 0; i < num; ++ i)
+	{
+		float3 const center(RandomFloat(-40, 40), RandomFloat(-40, 40), RandomFloat(-10, 60));
+		float3 const half_size(RandomFloat(0.1f, 8), RandomFloat(0.1f, 8), RandomFloat(0.1f, 8));
+		for (int j = 0; j < 3; ++ j)
+		{
+			bounds[j][i] = center[j] - half_size[j];
+			bounds[j + 3][i] = center[j] + half_size[j];
+		}
+	}
+
+	std::vector<BoundOverlap> results(num);
+	SIMDMathLib::IntersectAABBsFrustum(&results[0], &bounds[0][0], &bounds[1][0], &bounds[2][0],
+		&bounds[3][0], &bounds[4][0], &bounds[5][0], num, frustum);
+	for (size_t i = 0; i < num; ++ i)
+	{
+		AABBox const aabb(float3(bounds[0][i], bounds[1][i], bounds[2][i]), float3(bounds[3][i], bounds[4][i], bounds[5][i]));
+		EXPECT_EQ(MathLib::intersect_aabb_frustum(aabb, frustum), results[i]);
+	}
+}
+
+TEST(SIMDMathTest, IntersectSpheresFrustum)
+{
+	Frustum const frustum = TestFrustum();
+
+	size_t const num = 1003;
+	std::vector<float> spheres[4];
+	for (auto& s : spheres)
+	{
+		s.resize(num);
+	}
+	srand(2);
+	for (size_t i = 0; i < num; ++ i)
+	{
+		spheres[0][i] = RandomFloat(-40, 40);
+		spheres[1][i] = RandomFloat(-40, 40);
+		spheres[2][i] = RandomFloat(-10, 60);
+		spheres[3][i] = RandomFloat(0.1f, 8);
+	}
+
+	std::vector<BoundOverlap> results(num);
+	SIMDMathLib::IntersectSpheresFrustum(&results[0], &spheres[0][0], &spheres[1][0], &spheres[2][0], &spheres[3][0],
+		num, frustum);
+	for (size_t i = 0; i < num; ++ i)
+	{
+		Sphere const sphere(float3(spheres[0][i], spheres[1][i], spheres[2][i]), spheres[3][i]);
+		EXPECT_EQ(MathLib::intersect_sphere_frustum(sphere, frustum), results[i]);
+	}
+}
+
+TEST(SIMDMathTest, TransformAABBs)
+{
+	size_t const num = 100;
+	std::vector<AABBox> aabbs;
+	std::vector<float4x4> mats;
+	srand(3);
+	for (size_t i = 0; i < num; ++ i)
+	{
+		float3 const center(RandomFloat(-10, 10), RandomFloat(-10, 10), RandomFloat(-10, 10));
+		float3 const half_size(RandomFloat(0.1f, 5), RandomFloat(0.1f, 5), RandomFloat(0.1f, 5));
+		aabbs.emplace_back(center - half_size, center + half_size);
+
+		float3 const axis = MathLib::normalize(float3(RandomFloat(-1, 1), RandomFloat(-1, 1), RandomFloat(0.1f, 1)));
+		mats.push_back(MathLib::scaling(float3(RandomFloat(0.5f, 2), RandomFloat(0.5f, 2), RandomFloat(0.5f, 2)))
+			* MathLib::to_matrix(MathLib::rotation_axis(axis, RandomFloat(-PI, PI)))
+			* MathLib::translation(RandomFloat(-10, 10), RandomFloat(-10, 10), RandomFloat(-10, 10)));
+	}
+
+	std::vector<AABBox> results(num);
+	SIMDMathLib::TransformAABBs(&results[0], &aabbs[0], mats[0], num);
+	for (size_t i = 0; i < num; ++ i)
+	{
+		AABBox const expected = MathLib::transform_aabb(aabbs[i], mats[0]);
+		ExpectNear(expected.Min(), results[i].Min(), 1e-3f);
+		ExpectNear(expected.Max(), results[i].Max(), 1e-3f);
+	}
+
+	SIMDMathLib::TransformAABBs(&results[0], aabbs[0], &mats[0], num);
+	for (size_t i = 0; i < num; ++ i)
+	{
+		AABBox const expected = MathLib::transform_aabb(aabbs[0], mats[i]);
+		ExpectNear(expected.Min(), results[i].Min(), 1e-3f);
+		ExpectNear(expected.Max(), results[i].Max(), 1e-3f);
+	}
+}
+
+TEST(SIMDMathTest, MultiplyMatrices)
+{
+	size_t const num = 37;
+	std::vector<float4x4> lhs(num);
+	srand(4);
+	for (auto& mat : lhs)
+	{
+		for (auto& elem : mat)
+		{
+			elem = RandomFloat(-2, 2);
+		}
+	}
+	float4x4 rhs;
+	for (auto& elem : rhs)
+	{
+		elem = RandomFloat(-2, 2);
+	}
+
+	std::vector<float4x4> results(num);
+	SIMDMathLib::MultiplyMatrices(&results[0], &lhs[0], rhs, num);
+	for (size_t i = 0; i < num; ++ i)
+	{
+		float4x4 const expected = lhs[i] * rhs;
+		for (int j = 0; j < 16; ++ j)
+		{
+			EXPECT_NEAR(expected[j], results[i][j], 1e-4f);
+		}
+	}
+
+	// In place
+	SIMDMathLib::MultiplyMatrices(&lhs[0], &lhs[0], rhs, num);
+	for (size_t i = 0; i < num; ++ i)
+	{
+		for (int j = 0; j < 16; ++ j)
+		{
+			EXPECT_NEAR(results[i][j], lhs[i][j], 1e-6f);
+		}
+	}
+}
+
+TEST(SIMDMathTest, BlendDualQuaternions)
+{
+	size_t const num = 64;
+	std::vector<Quaternion> reals0, duals0, reals1, duals1;
+	std::vector<float> factors;
+	srand(5);
+	for (size_t i = 0; i < num; ++ i)
+	{
+		float3 const axis = MathLib::normalize(float3(RandomFloat(-1, 1), RandomFloat(-1, 1), RandomFloat(0.1f, 1)));
+		Quaternion const rot0 = MathLib::rotation_axis(axis, RandomFloat(-1, 1));
+		Quaternion rot1 = MathLib::rotation_axis(axis, RandomFloat(-1, 1));
+		if (i & 1)
+		{
+			// Same rotation from the other hemisphere
+			rot1 = -rot1;
+		}
+		reals0.push_back(rot0);
+		duals0.push_back(MathLib::quat_trans_to_udq(rot0, float3(RandomFloat(-5, 5), RandomFloat(-5, 5), RandomFloat(-5, 5))));
+		reals1.push_back(rot1);
+		duals1.push_back(MathLib::quat_trans_to_udq(rot1, float3(RandomFloat(-5, 5), RandomFloat(-5, 5), RandomFloat(-5, 5))));
+		factors.push_back(RandomFloat(0, 1));
+	}
+
+	std::vector<Quaternion> results_real(num), results_dual(num);
+	SIMDMathLib::BlendDualQuaternions(&results_real[0], &results_dual[0], &reals0[0], &duals0[0], &reals1[0], &duals1[0],
+		&factors[0], num);
+	for (size_t i = 0; i < num; ++ i)
+	{
+		float const w1 = (MathLib::dot(reals0[i], reals1[i]) < 0) ? -factors[i] : factors[i];
+		Quaternion const real = reals0[i] * (1 - factors[i]) + reals1[i] * w1;
+		Quaternion const dual = duals0[i] * (1 - factors[i]) + duals1[i] * w1;
+		float const len = MathLib::length(real);
+		EXPECT_NEAR(MathLib::length(results_real[i]), 1.0f, 1e-4f);
+		for (int j = 0; j < 4; ++ j)
+		{
+			EXPECT_NEAR(real[j] / len, results_real[i][j], 1e-4f);
+			EXPECT_NEAR(dual[j] / len, results_dual[i][j], 1e-4f);
+		}
+	}
+}
+
+TEST(SIMDMathTest, MultiplyDualQuaternions)
+{
+	size_t const num = 64;
+	std::vector<Quaternion> lhs_reals, lhs_duals, rhs_reals, rhs_duals;
+	srand(6);
+	for (size_t i = 0; i < num; ++ i)
+	{
+		float3 const axis0 = MathLib::normalize(float3(RandomFloat(-1, 1), RandomFloat(-1, 1), RandomFloat(0.1f, 1)));
+		float3 const axis1 = MathLib::normalize(float3(RandomFloat(0.1f, 1), RandomFloat(-1, 1), RandomFloat(-1, 1)));
+		lhs_reals.push_back(MathLib::rotation_axis(axis0, RandomFloat(-PI, PI)));
+		lhs_duals.push_back(MathLib::quat_trans_to_udq(lhs_reals.back(), float3(RandomFloat(-5, 5), RandomFloat(-5, 5), RandomFloat(-5, 5))));
+		rhs_reals.push_back(MathLib::rotation_axis(axis1, RandomFloat(-PI, PI)));
+		rhs_duals.push_back(MathLib::quat_trans_to_udq(rhs_reals.back(), float3(RandomFloat(-5, 5), RandomFloat(-5, 5), RandomFloat(-5, 5))));
+	}
+
+	std::vector<Quaternion> results_real(num), results_dual(num);
+	SIMDMathLib::MultiplyDualQuaternions(&results_real[0], &results_dual[0], &lhs_reals[0], &lhs_duals[0],
+		&rhs_reals[0], &rhs_duals[0], num);
+	for (size_t i = 0; i < num; ++ i)
+	{
+		Quaternion const real = MathLib::mul_real(lhs_reals[i], rhs_reals[i]);
+		Quaternion const dual = MathLib::mul_dual(lhs_reals[i], lhs_duals[i], rhs_reals[i], rhs_duals[i]);
+		for (int j = 0; j < 4; ++ j)
+		{
+			EXPECT_NEAR(real[j], results_real[i][j], 1e-4f);
+			EXPECT_NEAR(dual[j], results_dual[i][j], 1e-4f);
+		}
+	}
+}
@@ -0,0 +1,195 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Math.hpp>
+#include <KlayGE/SceneManager.hpp>
+#include <KlayGE/SceneObject.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <cstdlib>
+#include <vector>
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	// A bare scene manager, with access to the object store and the base ClipScene
+	class TestSceneManager : public SceneManager
+	{
+	public:
+		SceneObjectStore const & Store() const
+		{
+			return scene_obj_store_;
+		}
+
+		void Clip(Frustum const & frustum)
+		{
+			frustum_ = &frustum;
+			this->ClipScene();
+		}
+
+	protected:
+		void OnAddSceneObject(SceneObjectPtr const & obj) override
+		{
+			KFL_UNUSED(obj);
+		}
+		void OnDelSceneObject(std::vector<SceneObjectPtr>::iterator iter) override
+		{
+			KFL_UNUSED(iter);
+		}
+		void DoSuspend() override
+		{
+		}
+		void DoResume() override
+		{
+		}
+	};
+
+	// An object with a fixed world space bound and no renderable
+	class BoundSceneObject : public SceneObject
+	{
+	public:
+		BoundSceneObject(uint32_t attrib, AABBox const & aabb_ws)
+			: SceneObject(attrib)
+		{
+			if (pos_aabb_ws_)
+			{
+				*pos_aabb_ws_ = aabb_ws;
+			}
+		}
+	};
+
+	float RandomFloat(float low, float high)
+	{
+		return low + (high - low) * rand() / RAND_MAX;
+	}
+
+	void ExpectStoreMatches(TestSceneManager const & sm)
+	{
+		auto const & store = sm.Store();
+		uint32_t const num = sm.NumSceneObjects();
+		ASSERT_EQ(store.attribs.size(), num);
+		ASSERT_EQ(store.min_x.size(), num);
+		ASSERT_EQ(store.min_y.size(), num);
+		ASSERT_EQ(store.min_z.size(), num);
+		ASSERT_EQ(store.max_x.size(), num);
+		ASSERT_EQ(store.max_y.size(), num);
+		ASSERT_EQ(store.max_z.size(), num);
+		ASSERT_EQ(store.has_parent.size(), num);
+		ASSERT_EQ(store.visible_marks.size(), num);
+
+		for (uint32_t i = 0; i < num; ++ i)
+		{
+			SceneObjectPtr const & obj = sm.GetSceneObject(i);
+			EXPECT_EQ(store.attribs[i], obj->Attrib()) << "object " << i;
+			EXPECT_EQ(store.has_parent[i], 0) << "object " << i;
+			if (obj->Attrib() & SceneObject::SOA_Cullable)
+			{
+				AABBox const & aabb = obj->PosBoundWS();
+				EXPECT_EQ(store.min_x[i], aabb.Min().x()) << "object " << i;
+				EXPECT_EQ(store.min_y[i], aabb.Min().y()) << "object " << i;
+				EXPECT_EQ(store.min_z[i], aabb.Min().z()) << "object " << i;
+				EXPECT_EQ(store.max_x[i], aabb.Max().x()) << "object " << i;
+				EXPECT_EQ(store.max_y[i], aabb.Max().y()) << "object " << i;
+				EXPECT_EQ(store.max_z[i], aabb.Max().z()) << "object " << i;
+			}
+		}
+	}
+}
+
+TEST_F(KlayGETest, SceneObjectStoreBookkeeping)
+{
+	TestSceneManager sm;
+
+	std::vector<SceneObjectPtr> objs;
+	for (uint32_t i = 0; i < 10; ++ i)
+	{
+		uint32_t attrib = (i % 3 == 1) ? 0 : SceneObject::SOA_Cullable;
+		if (i % 4 == 3)
+		{
+			attrib |= SceneObject::SOA_Invisible;
+		}
+		float3 const min_pt(static_cast<float>(i), static_cast<float>(i * 2), static_cast<float>(i * 3));
+		objs.push_back(MakeSharedPtr<BoundSceneObject>(attrib, AABBox(min_pt, min_pt + float3(1, 2, 3))));
+		sm.AddSceneObject(objs.back());
+	}
+	ExpectStoreMatches(sm);
+
+	// First, middle and last
+	sm.DelSceneObject(objs[0]);
+	ExpectStoreMatches(sm);
+	sm.DelSceneObject(objs[5]);
+	ExpectStoreMatches(sm);
+	sm.DelSceneObject(objs[9]);
+	ExpectStoreMatches(sm);
+	EXPECT_EQ(sm.NumSceneObjects(), 7U);
+
+	// Not in the scene any more, nothing changes
+	sm.DelSceneObject(objs[5]);
+	EXPECT_EQ(sm.NumSceneObjects(), 7U);
+
+	sm.AddSceneObject(MakeSharedPtr<BoundSceneObject>(SceneObject::SOA_Cullable,
+		AABBox(float3(-1, -2, -3), float3(4, 5, 6))));
+	ExpectStoreMatches(sm);
+	EXPECT_EQ(sm.Store().min_x.back(), -1);
+	EXPECT_EQ(sm.Store().max_z.back(), 6);
+
+	sm.ClearObject();
+	ExpectStoreMatches(sm);
+	EXPECT_EQ(sm.NumSceneObjects(), 0U);
+}
+
+TEST_F(KlayGETest, SceneManagerBatchCulling)
+{
+	TestSceneManager sm;
+
+	float4x4 const view_proj = MathLib::look_at_lh(float3(1, 2, -3), float3(0, 0, 10))
+		* MathLib::perspective_fov_lh(PI / 4, 1.5f, 0.5f, 50.0f);
+	Frustum frustum;
+	frustum.ClipMatrix(view_proj, MathLib::inverse(view_proj));
+
+	// Several clip blocks plus a partial one, with some uncullable and invisible objects mixed in
+	uint32_t const num_objs = 1003;
+	srand(1);
+	for (uint32_t i = 0; i < num_objs; ++ i)
+	{
+		uint32_t attrib = (i % 10 == 9) ? 0 : SceneObject::SOA_Cullable;
+		if (i % 7 == 6)
+		{
+			attrib |= SceneObject::SOA_Invisible;
+		}
+		float3 const center(RandomFloat(-40, 40), RandomFloat(-40, 40), RandomFloat(-10, 60));
+		float3 const half_size(RandomFloat(0.1f, 8), RandomFloat(0.1f, 8), RandomFloat(0.1f, 8));
+		sm.AddSceneObject(MakeSharedPtr<BoundSceneObject>(attrib, AABBox(center - half_size, center + half_size)));
+	}
+
+	sm.Clip(frustum);
+
+	uint32_t num_visible = 0;
+	for (uint32_t i = 0; i < num_objs; ++ i)
+	{
+		SceneObjectPtr const & obj = sm.GetSceneObject(i);
+		uint32_t const attrib = obj->Attrib();
+		BoundOverlap expected;
+		if (attrib & SceneObject::SOA_Invisible)
+		{
+			expected = BO_No;
+		}
+		else if (attrib & SceneObject::SOA_Cullable)
+		{
+			expected = MathLib::intersect_aabb_frustum(obj->PosBoundWS(), frustum);
+		}
+		else
+		{
+			expected = BO_Yes;
+		}
+
+		EXPECT_EQ(obj->VisibleMark(), expected) << "object " << i;
+		EXPECT_EQ(sm.Store().visible_marks[i], static_cast<uint8_t>(expected)) << "object " << i;
+		num_visible += (expected != BO_No);
+	}
+
+	// The frustum cuts through the boxes, the test is meaningless if it takes all or nothing
+	EXPECT_GT(num_visible, 0U);
+	EXPECT_LT(num_visible, num_objs);
+}
@@ -0,0 +1,85 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Math.hpp>
+#include <KlayGE/SceneObject.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <atomic>
+#include <thread>
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	void RunSubThreadUpdate(SceneObject& so)
+	{
+		so.BeginSubThreadUpdate();
+		so.SubThreadUpdate(0, 0);
+		so.EndSubThreadUpdate();
+	}
+}
+
+TEST(SceneObjectTest, SubThreadPublishKeepsMainThreadWrites)
+{
+	SceneObject so(SceneObject::SOA_Moveable);
+	so.BindSubThreadUpdateFunc([](SceneObject& obj, float, float)
+		{
+			obj.Visible(!obj.Visible());
+		});
+	so.PrepareSubThreadUpdate();
+
+	// Moved after the copies are seeded, the sub-thread only touches visibility
+	float4x4 const moved = MathLib::translation(1.0f, 2.0f, 3.0f);
+	so.ModelMatrix(moved);
+
+	std::thread update_thread([&so]
+		{
+			RunSubThreadUpdate(so);
+		});
+	update_thread.join();
+
+	so.AcquireSubThreadState();
+	EXPECT_EQ(so.ModelMatrix(), moved);
+	EXPECT_FALSE(so.Visible());
+
+	// Nothing new published, a main-thread write must stick
+	so.Visible(true);
+	so.AcquireSubThreadState();
+	EXPECT_TRUE(so.Visible());
+}
+
+TEST(SceneObjectTest, ConcurrentMoveAndToggle)
+{
+	SceneObject so(SceneObject::SOA_Moveable);
+	std::atomic<uint32_t> toggles(0);
+	so.BindSubThreadUpdateFunc([&toggles](SceneObject& obj, float, float)
+		{
+			obj.Visible(!obj.Visible());
+			++ toggles;
+		});
+	so.PrepareSubThreadUpdate();
+
+	uint32_t const num_updates = 10000;
+	std::thread update_thread([&so, num_updates]
+		{
+			for (uint32_t i = 0; i < num_updates; ++ i)
+			{
+				RunSubThreadUpdate(so);
+			}
+		});
+
+	for (uint32_t i = 0; i < num_updates; ++ i)
+	{
+		float4x4 const moved = MathLib::translation(static_cast<float>(i), 0.0f, 0.0f);
+		so.ModelMatrix(moved);
+		so.AcquireSubThreadState();
+		EXPECT_EQ(so.ModelMatrix(), moved);
+	}
+	update_thread.join();
+
+	so.AcquireSubThreadState();
+	EXPECT_EQ(toggles.load(), num_updates);
+	EXPECT_EQ(so.Visible(), (num_updates % 2) == 0);
+	EXPECT_EQ(so.ModelMatrix(), MathLib::translation(static_cast<float>(num_updates - 1), 0.0f, 0.0f));
+}
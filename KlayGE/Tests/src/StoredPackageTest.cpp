@@ -0,0 +1,93 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/MappedFile.hpp>
+#include <KlayGE/StoredPackage.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	std::vector<uint8_t> MakeFileData(size_t size, uint8_t seed)
+	{
+		std::vector<uint8_t> data(size);
+		for (size_t i = 0; i < size; ++ i)
+		{
+			data[i] = static_cast<uint8_t>(i * 31 + seed);
+		}
+		return data;
+	}
+
+	void WriteFile(std::string const & name, std::vector<uint8_t> const & data)
+	{
+		std::ofstream ofs(name.c_str(), std::ios_base::binary);
+		ofs.write(reinterpret_cast<char const *>(data.data()), static_cast<std::streamsize>(data.size()));
+	}
+}
+
+TEST(StoredPackageTest, SaveAndRead)
+{
+	std::vector<std::string> const internal_names = { "a.bin", "sub/b.bin", "empty.bin", "c.bin" };
+	std::vector<std::string> const file_names = { "StoredPackageTest_a.bin", "StoredPackageTest_b.bin",
+		"StoredPackageTest_empty.bin", "StoredPackageTest_c.bin" };
+	std::vector<std::vector<uint8_t>> const contents = { MakeFileData(13, 1), MakeFileData(100000, 2),
+		MakeFileData(0, 3), MakeFileData(17, 4) };
+	for (size_t i = 0; i < file_names.size(); ++ i)
+	{
+		WriteFile(file_names[i], contents[i]);
+	}
+
+	std::string const pkg_name = "StoredPackageTest.kpkg";
+	StoredPackage::Save(pkg_name, internal_names, file_names);
+
+	{
+		StoredPackage pkg(pkg_name);
+		ASSERT_TRUE(pkg.Valid());
+
+		uint8_t const * base = pkg.Mapping()->Data().data();
+		for (size_t i = 0; i < internal_names.size(); ++ i)
+		{
+			ArrayRef<uint8_t> const data = pkg.Find(internal_names[i]);
+			ASSERT_EQ(data.size(), contents[i].size()) << internal_names[i];
+			EXPECT_TRUE(std::equal(data.begin(), data.end(), contents[i].begin())) << internal_names[i];
+			if (!data.empty())
+			{
+				EXPECT_EQ((data.data() - base) % 16, 0) << internal_names[i];
+			}
+		}
+
+		EXPECT_TRUE(pkg.Find("missing.bin").empty());
+	}
+
+	// Cut into the last file, the entry no longer fits
+	{
+		std::ifstream ifs(pkg_name.c_str(), std::ios_base::binary);
+		std::vector<char> pkg_data((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+		ifs.close();
+
+		std::string const truncated_name = "StoredPackageTest_truncated.kpkg";
+		{
+			std::ofstream ofs(truncated_name.c_str(), std::ios_base::binary);
+			ofs.write(pkg_data.data(), static_cast<std::streamsize>(pkg_data.size() - 1));
+		}
+		{
+			StoredPackage pkg(truncated_name);
+			EXPECT_FALSE(pkg.Valid());
+		}
+		std::remove(truncated_name.c_str());
+	}
+
+	std::remove(pkg_name.c_str());
+	for (auto const & name : file_names)
+	{
+		std::remove(name.c_str());
+	}
+}
@@ -0,0 +1,80 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Thread.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <atomic>
+#include <stdexcept>
+
+using namespace std;
+using namespace KlayGE;
+
+TEST(ThreadTest, ParallelFor)
+{
+	task_scheduler ts(4);
+
+	std::vector<uint32_t> data(100003, 0);
+	ts.parallel_for(0, data.size(), 0, [&data](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; ++ i)
+			{
+				data[i] = static_cast<uint32_t>(i);
+			}
+		});
+
+	for (size_t i = 0; i < data.size(); ++ i)
+	{
+		EXPECT_EQ(data[i], static_cast<uint32_t>(i));
+	}
+}
+
+TEST(ThreadTest, NestedTaskGroups)
+{
+	task_scheduler ts(4);
+
+	std::atomic<uint32_t> counter(0);
+	std::atomic<uint32_t> continuation_value(0);
+	{
+		task_group outer(ts);
+		for (int i = 0; i < 64; ++ i)
+		{
+			outer.run([&ts, &counter]()
+				{
+					task_group inner(ts);
+					for (int j = 0; j < 16; ++ j)
+					{
+						inner.run([&counter]()
+							{
+								++ counter;
+							});
+					}
+					inner.wait();
+				});
+		}
+
+		outer.then([&counter, &continuation_value]()
+			{
+				continuation_value = counter.load();
+			});
+		outer.wait();
+	}
+
+	EXPECT_EQ(counter, 64U * 16U);
+	while (continuation_value == 0)
+	{
+		std::this_thread::yield();
+	}
+	EXPECT_EQ(continuation_value, 64U * 16U);
+}
+
+TEST(ThreadTest, TaskGroupException)
+{
+	task_scheduler ts(2);
+
+	task_group group(ts);
+	group.run([]()
+		{
+			throw std::runtime_error("task failed");
+		});
+	EXPECT_THROW(group.wait(), std::runtime_error);
+}
@@ -0,0 +1,82 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/ResIdentifier.hpp>
+#include <KFL/XMLDom.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <sstream>
+#include <string>
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	XMLNodePtr ParseString(XMLDocument& doc, std::string const & str)
+	{
+		return doc.Parse(MakeSharedPtr<ResIdentifier>("test.xml", 0, MakeSharedPtr<std::stringstream>(str)));
+	}
+}
+
+TEST(XMLDomTest, View)
+{
+	XMLDocument doc;
+	ParseString(doc, "<root version=\"3\">"
+		"<item name=\"a\" i=\"-12\" u=\"+7\" f=\"1.5e2\" bad=\"4x\"/>"
+		"<item name=\"b\" list=\"1, 2.5,-3\t4\">  42 </item>"
+		"<other/>"
+		"</root>");
+
+	XMLNodeView const root = doc.RootView();
+	ASSERT_TRUE(root);
+	EXPECT_EQ(root.Name(), "root");
+	EXPECT_EQ(root.AttribUInt("version", 0), 3U);
+	EXPECT_EQ(root.AttribInt("missing", -1), -1);
+
+	XMLNodeView item = root.FirstNode("item");
+	ASSERT_TRUE(item);
+	EXPECT_EQ(item.AttribString("name", ""), "a");
+	EXPECT_EQ(item.AttribInt("i", 0), -12);
+	EXPECT_EQ(item.AttribUInt("u", 0), 7U);
+	EXPECT_FLOAT_EQ(item.AttribFloat("f", 0), 150.0f);
+
+	int32_t val;
+	EXPECT_FALSE(item.TryConvertAttrib("bad", val, 0));
+	EXPECT_FALSE(item.TryConvertAttrib("i", reinterpret_cast<uint32_t&>(val), 0U));
+	EXPECT_THROW(item.Attrib("bad").ValueInt(), std::runtime_error);
+
+	item = item.NextSibling("item");
+	ASSERT_TRUE(item);
+	EXPECT_EQ(item.ValueInt(), 42);
+
+	float list[5];
+	EXPECT_EQ(item.Attrib("list").ValueFloats(list, 5), 4U);
+	EXPECT_FLOAT_EQ(list[0], 1.0f);
+	EXPECT_FLOAT_EQ(list[1], 2.5f);
+	EXPECT_FLOAT_EQ(list[2], -3.0f);
+	EXPECT_FLOAT_EQ(list[3], 4.0f);
+
+	int32_t ints[4];
+	EXPECT_EQ(item.Attrib("list").ValueInts(ints, 4), 1U);
+
+	EXPECT_FALSE(item.NextSibling("item"));
+	EXPECT_EQ(item.NextSibling().Name(), "other");
+	EXPECT_EQ(item.Parent().Name(), "root");
+}
+
+TEST(XMLDomTest, ViewOfAllocatedNodes)
+{
+	XMLDocument doc;
+	XMLNodePtr root = doc.AllocNode(XNT_Element, "root");
+	doc.RootNode(root);
+	root->AppendAttrib(doc.AllocAttribFloat("scale", 0.25f));
+	root->AppendAttrib(doc.AllocAttribString("offset", "1 2 3"));
+
+	XMLNodeView const view(*root);
+	EXPECT_FLOAT_EQ(view.AttribFloat("scale", 0), 0.25f);
+	EXPECT_FLOAT_EQ(root->AttribFloat("scale", 0), 0.25f);
+
+	uint32_t offset[3];
+	EXPECT_EQ(view.Attrib("offset").ValueUInts(offset, 3), 3U);
+	EXPECT_EQ(offset[2], 3U);
+}
@@ -8,6 +8,7 @@
 #include <KlayGE/RenderFactory.hpp>
 #include <KlayGE/Context.hpp>
 #include <KlayGE/RenderSettings.hpp>
+#include <KlayGE/DistanceField.hpp>
 
 #include <cmath>
 #include <iostream>
@@ -21,196 +22,15 @@
 using namespace std;
 using namespace KlayGE;
 
-// A type to hold the distance map while it's being constructed
-template <typename DistanceType>
-class DistanceMap
-{
-public:
-	DistanceMap(int width, int height, int depth)
-		: data_(width * height * depth * 3),
-			width_(width), height_(height), depth_(depth)
-	{
-	}
-
-	DistanceType& operator()(int x, int y, int z, int i)
-	{
-		return data_[((z * height_ + y) * width_ + x) * 3 + i];
-	}
-
-	DistanceType const & operator()(int x, int y, int z, int i) const
-	{
-		return data_[((z * height_ + y) * width_ + x) * 3 + i];
-	}
-
-	bool inside(int x, int y, int z) const
-	{
-		return (0 <= x) && (x < width_)
-			&& (0 <= y) && (y < height_)
-			&& (0 <= z) && (z < depth_);
-	}
-
-	// Do a single pass over the data.
-	// Start at (x,y,z) and walk in the direction (cx,cy,cz)
-	// Combine each pixel (x,y,z) with the value at (x+dx,y+dy,z+dz)
-	void combine(int dx, int dy, int dz,
-		int cx, int cy, int cz,
-		int x, int y, int z)
-	{
-		while (inside(x, y, z) && inside(x + dx, y + dy, z + dz))
-		{
-			int d[3] =
-			{
-				abs(dx),
-				abs(dy),
-				abs(dz)
-			};
-
-			uint32_t v1[3], v2[3];
-			for (int i = 0; i < 3; ++ i)
-			{
-				v1[i] = operator()(x, y, z, i);
-				v2[i] = operator()(x + dx, y + dy, z + dz, i) + d[i];
-			}
-
-			if (v1[0] * v1[0] + v1[1] * v1[1] + v1[2] * v1[2] > v2[0] * v2[0] + v2[1] * v2[1] + v2[2] * v2[2])
-			{
-				for (int i = 0; i < 3; ++ i)
-				{
-					operator()(x, y, z, i) = static_cast<DistanceType>(v2[i]);
-				}
-			}
-
-			x += cx;
-			y += cy;
-			z += cz;
-		}
-	}
-
-private:
-	std::vector<DistanceType> data_;
-	int width_, height_, depth_;
-};
-
 void ComputeDistanceField(std::vector<uint8_t>& distances, int width, int height, int depth,
 						std::vector<uint8_t> const & volume)
 {
-	// and +infinity above
-	DistanceMap<uint16_t> dmap(width, height, depth);
-	for (int z = 0; z < depth; ++ z)
-	{
-		for (int y = 0; y < height; ++ y)
-		{
-			for (int x = 0; x < width; ++ x)
-			{
-				for (int i = 0; i < 3; ++ i)
-				{
-					if (volume[(z * height + y) * width + x] != 0)
-					{
-						dmap(x, y, z, i) = 0;
-					}
-					else
-					{
-						dmap(x, y, z, i) = std::numeric_limits<uint16_t>::max();
-					}
-				}
-			}
-		}
-	}
-
+	std::vector<float> dist_data;
+	ComputeVolumeDistance(volume, width, height, depth, dist_data);
 
-	// Compute the rest of dmap by sequential sweeps over the data
-	// using a 3d variant of Danielsson's algorithm
-
-	for (int z = 1; z < depth; ++ z)
+	for (size_t i = 0; i < dist_data.size(); ++ i)
 	{
-		// combine with everything with dz = -1
-		for (int y = 0; y < height; ++ y)
-		{
-			dmap.combine(0, 0, -1,
-				1, 0, 0,
-				0, y, z);
-		}
-
-		for (int y = 1; y < height; ++ y)
-		{
-			dmap.combine(0, -1, 0,
-				1, 0, 0,
-				0, y, z);
-			dmap.combine(-1, 0, 0,
-				1, 0, 0,
-				1, y, z);
-			dmap.combine(+1, 0, 0,
-				-1, 0, 0,
-				width - 2, y, z);
-		}
-
-		for (int y = height - 1; y >= 0; -- y)
-		{
-			dmap.combine(0, +1, 0,
-				1, 0, 0,
-				0, y, z);
-			dmap.combine(-1, 0, 0,
-				1, 0, 0,
-				1, y, z);
-			dmap.combine(+1, 0, 0,
-				-1, 0, 0,
-				width - 1, y, z);
-		}
-	}
-
-	for (int z = depth - 1; z >= 0; -- z)
-	{
-		cout << ".";
-
-		// combine with everything with dz = +1
-		for (int y = 0; y < height; ++ y)
-		{
-			dmap.combine(0, 0, +1,
-				1, 0, 0,
-				0, y, z);
-		}
-
-		for (int y = 1; y < height; ++ y)
-		{
-			dmap.combine(0, -1, 0,
-				1, 0, 0,
-				0, y, z);
-			dmap.combine(-1, 0, 0,
-				1, 0, 0,
-				1, y, z);
-			dmap.combine(+1, 0, 0,
-				-1, 0, 0,
-				width - 2, y, z);
-		}
-		for (int y = height - 1; y >= 0; -- y)
-		{
-			dmap.combine(0, +1, 0,
-				1, 0, 0,
-				0, y, z);
-			dmap.combine(-1, 0, 0,
-				1, 0, 0,
-				1, y, z);
-			dmap.combine(+1, 0, 0,
-				-1, 0, 0,
-				width - 1, y, z);
-		}
-	}
-
-	for (int z = 0; z < depth; ++ z)
-	{
-		for (int y = 0; y < height; ++ y)
-		{
-			for (int x = 0; x < width; ++ x)
-			{
-				float value = 0;
-				for (int i = 0; i < 3; ++ i)
-				{
-					value += dmap(x, y, z, i) * dmap(x, y, z, i);
-				}
-				distances[(z * height + y) * width + x]
-					= static_cast<uint8_t>(MathLib::clamp(sqrt(value) / depth, 0.0f, 1.0f) * 255);
-			}
-		}
+		distances[i] = static_cast<uint8_t>(MathLib::clamp(dist_data[i] / depth, 0.0f, 1.0f) * 255);
 	}
 }
 
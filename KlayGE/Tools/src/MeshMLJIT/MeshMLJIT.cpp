@@ -16,16 +16,6 @@
 #include <vector>
 #include <cstring>
 
-#if defined(KLAYGE_COMPILER_GCC)
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wdeprecated-declarations" // Ignore auto_ptr declaration
-#endif
-#include <boost/algorithm/string/split.hpp>
-#if defined(KLAYGE_COMPILER_GCC)
-#pragma GCC diagnostic pop
-#endif
-#include <boost/algorithm/string/trim.hpp>
-
 #if defined(KLAYGE_COMPILER_GCC)
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations" // Ignore auto_ptr declaration
@@ -40,6 +30,11 @@ using namespace KlayGE;
 
 namespace
 {
+	// Errors allowed when dropping a key. Translation error is relative to the longest translation of the track.
+	float const KEY_ROTATION_TOLERANCE = 0.001f;
+	float const KEY_TRANSLATION_TOLERANCE = 0.001f;
+	float const KEY_SCALE_TOLERANCE = 0.001f;
+
 	struct OfflineRenderMaterial
 	{
 		RenderMaterial material;
@@ -76,48 +71,61 @@ namespace
 
 	std::string const JIT_EXT_NAME = ".model_bin";
 
-	template <int N>
-	void ExtractFVector(std::string const & value_str, float* v)
+	void ParseToken(char const * token, float& v)
 	{
-		std::vector<std::string> strs;
-		boost::algorithm::split(strs, value_str, boost::is_any_of(" "));
-		for (size_t i = 0; i < N; ++ i)
+		v = static_cast<float>(atof(token));
+	}
+
+	void ParseToken(char const * token, uint32_t& v)
+	{
+		v = static_cast<uint32_t>(atoi(token));
+	}
+
+	// Keeps the tolerance of the atof/atoi parse of the old meshml files. Tokens are split on single spaces, and each one
+	//  gives its longest numeric prefix, or 0. Returns the number of tokens read.
+	template <typename T>
+	uint32_t ExtractTokens(std::string_view str, T* v, uint32_t num)
+	{
+		uint32_t n = 0;
+		size_t pos = 0;
+		while ((n < num) && (pos <= str.size()))
 		{
-			if (i < strs.size())
-			{
-				boost::algorithm::trim(strs[i]);
-				v[i] = static_cast<float>(atof(strs[i].c_str()));
-			}
-			else
-			{
-				v[i] = 0;
-			}
+			size_t const end = std::min(str.find(' ', pos), str.size());
+
+			char token[64];
+			size_t const len = std::min(end - pos, sizeof(token) - 1);
+			std::memcpy(token, str.data() + pos, len);
+			token[len] = '\0';
+			ParseToken(token, v[n]);
+
+			pos = end + 1;
+			++ n;
 		}
+		return n;
 	}
 
-	template <int N>
-	void ExtractUIVector(std::string const & value_str, uint32_t* v)
+	template <uint32_t N>
+	void ExtractFVector(XMLAttributeView const & attr, float* v)
 	{
-		std::vector<std::string> strs;
-		boost::algorithm::split(strs, value_str, boost::is_any_of(" "));
-		for (size_t i = 0; i < N; ++ i)
+		for (uint32_t i = ExtractTokens(attr.ValueString(), v, N); i < N; ++ i)
 		{
-			if (i < strs.size())
-			{
-				boost::algorithm::trim(strs[i]);
-				v[i] = static_cast<uint32_t>(atoi(strs[i].c_str()));
-			}
-			else
-			{
-				v[i] = 0;
-			}
+			v[i] = 0;
+		}
+	}
+
+	template <uint32_t N>
+	void ExtractUIVector(XMLAttributeView const & attr, uint32_t* v)
+	{
+		for (uint32_t i = ExtractTokens(attr.ValueString(), v, N); i < N; ++ i)
+		{
+			v[i] = 0;
 		}
 	}
 
-	void CompileMaterialsChunk(XMLNodePtr const & materials_chunk, std::vector<OfflineRenderMaterial>& mtls)
+	void CompileMaterialsChunk(XMLNodeView const & materials_chunk, std::vector<OfflineRenderMaterial>& mtls)
 	{
 		uint32_t mtl_index = 0;
-		for (XMLNodePtr mtl_node = materials_chunk->FirstNode("material"); mtl_node; mtl_node = mtl_node->NextSibling("material"), ++ mtl_index)
+		for (XMLNodeView mtl_node = materials_chunk.FirstNode("material"); mtl_node; mtl_node = mtl_node.NextSibling("material"), ++ mtl_index)
 		{
 			OfflineRenderMaterial offline_mtl;
 			auto& mtl = offline_mtl.material;
@@ -138,191 +146,190 @@ namespace
 			mtl.tess_factors = float4(5, 5, 1, 9);
 
 			{
-				XMLAttributePtr attr = mtl_node->Attrib("name");
+				XMLAttributeView attr = mtl_node.Attrib("name");
 				if (attr)
 				{
-					mtl.name = attr->ValueString();
+					mtl.name = std::string(attr.ValueString());
 				}
 			}
 
-			XMLNodePtr albedo_node = mtl_node->FirstNode("albedo");
+			XMLNodeView albedo_node = mtl_node.FirstNode("albedo");
 			if (albedo_node)
 			{
-				XMLAttributePtr attr = albedo_node->Attrib("color");
+				XMLAttributeView attr = albedo_node.Attrib("color");
 				if (attr)
 				{
-					ExtractFVector<4>(attr->ValueString(), &mtl.albedo[0]);
+					ExtractFVector<4>(attr, &mtl.albedo[0]);
 				}
-				attr = albedo_node->Attrib("texture");
+				attr = albedo_node.Attrib("texture");
 				if (attr)
 				{
-					offline_mtl.texture_slots.emplace_back("Albedo", attr->ValueString());
+					offline_mtl.texture_slots.emplace_back("Albedo", attr.ValueString());
 				}
 			}
 			else
 			{
-				XMLAttributePtr attr = mtl_node->Attrib("diffuse");
+				XMLAttributeView attr = mtl_node.Attrib("diffuse");
 				if (attr)
 				{
-					ExtractFVector<3>(attr->ValueString(), &mtl.albedo[0]);
+					ExtractFVector<3>(attr, &mtl.albedo[0]);
 				}
 				else
 				{
-					attr = mtl_node->Attrib("diffuse_r");
+					attr = mtl_node.Attrib("diffuse_r");
 					if (attr)
 					{
-						mtl.albedo.x() = attr->ValueFloat();
+						mtl.albedo.x() = attr.ValueFloat();
 					}
-					attr = mtl_node->Attrib("diffuse_g");
+					attr = mtl_node.Attrib("diffuse_g");
 					if (attr)
 					{
-						mtl.albedo.y() = attr->ValueFloat();
+						mtl.albedo.y() = attr.ValueFloat();
 					}
-					attr = mtl_node->Attrib("diffuse_b");
+					attr = mtl_node.Attrib("diffuse_b");
 					if (attr)
 					{
-						mtl.albedo.z() = attr->ValueFloat();
+						mtl.albedo.z() = attr.ValueFloat();
 					}
 				}
 
-				attr = mtl_node->Attrib("opacity");
+				attr = mtl_node.Attrib("opacity");
 				if (attr)
 				{
-					mtl.albedo.w() = mtl_node->Attrib("opacity")->ValueFloat();
+					mtl.albedo.w() = mtl_node.Attrib("opacity").ValueFloat();
 				}
 			}
 
-			XMLNodePtr metalness_node = mtl_node->FirstNode("metalness");
+			XMLNodeView metalness_node = mtl_node.FirstNode("metalness");
 			if (metalness_node)
 			{
-				XMLAttributePtr attr = metalness_node->Attrib("value");
+				XMLAttributeView attr = metalness_node.Attrib("value");
 				if (attr)
 				{
-					mtl.metalness = attr->ValueFloat();
+					mtl.metalness = attr.ValueFloat();
 				}
-				attr = metalness_node->Attrib("texture");
+				attr = metalness_node.Attrib("texture");
 				if (attr)
 				{
-					offline_mtl.texture_slots.emplace_back("Metalness", attr->ValueString());
+					offline_mtl.texture_slots.emplace_back("Metalness", attr.ValueString());
 				}
 			}
 
-			XMLNodePtr glossiness_node = mtl_node->FirstNode("glossiness");
+			XMLNodeView glossiness_node = mtl_node.FirstNode("glossiness");
 			if (glossiness_node)
 			{
-				XMLAttributePtr attr = glossiness_node->Attrib("value");
+				XMLAttributeView attr = glossiness_node.Attrib("value");
 				if (attr)
 				{
-					mtl.glossiness = attr->ValueFloat();
+					mtl.glossiness = attr.ValueFloat();
 				}
-				attr = glossiness_node->Attrib("texture");
+				attr = glossiness_node.Attrib("texture");
 				if (attr)
 				{
-					offline_mtl.texture_slots.emplace_back("Glossiness", attr->ValueString());
+					offline_mtl.texture_slots.emplace_back("Glossiness", attr.ValueString());
 				}
 			}
 			else
 			{
-				XMLAttributePtr attr = mtl_node->Attrib("shininess");
+				XMLAttributeView attr = mtl_node.Attrib("shininess");
 				if (attr)
 				{
-					float shininess = mtl_node->Attrib("shininess")->ValueFloat();
+					float shininess = mtl_node.Attrib("shininess").ValueFloat();
 					shininess = MathLib::clamp(shininess, 1.0f, MAX_SHININESS);
 					mtl.glossiness = Shininess2Glossiness(shininess);
 				}
 			}
 
-			XMLNodePtr emissive_node = mtl_node->FirstNode("emissive");
+			XMLNodeView emissive_node = mtl_node.FirstNode("emissive");
 			if (emissive_node)
 			{
-				XMLAttributePtr attr = emissive_node->Attrib("color");
+				XMLAttributeView attr = emissive_node.Attrib("color");
 				if (attr)
 				{
-					ExtractFVector<3>(attr->ValueString(), &mtl.emissive[0]);
+					ExtractFVector<3>(attr, &mtl.emissive[0]);
 				}
-				attr = emissive_node->Attrib("texture");
+				attr = emissive_node.Attrib("texture");
 				if (attr)
 				{
-					offline_mtl.texture_slots.emplace_back("Emissive", attr->ValueString());
+					offline_mtl.texture_slots.emplace_back("Emissive", attr.ValueString());
 				}
 			}
 			else
 			{
-				XMLAttributePtr attr = mtl_node->Attrib("emit");
+				XMLAttributeView attr = mtl_node.Attrib("emit");
 				if (attr)
 				{
-					ExtractFVector<3>(attr->ValueString(), &mtl.emissive[0]);
+					ExtractFVector<3>(attr, &mtl.emissive[0]);
 				}
 				else
 				{
-					attr = mtl_node->Attrib("emit_r");
+					attr = mtl_node.Attrib("emit_r");
 					if (attr)
 					{
-						mtl.emissive.x() = attr->ValueFloat();
+						mtl.emissive.x() = attr.ValueFloat();
 					}
-					attr = mtl_node->Attrib("emit_g");
+					attr = mtl_node.Attrib("emit_g");
 					if (attr)
 					{
-						mtl.emissive.y() = attr->ValueFloat();
+						mtl.emissive.y() = attr.ValueFloat();
 					}
-					attr = mtl_node->Attrib("emit_b");
+					attr = mtl_node.Attrib("emit_b");
 					if (attr)
 					{
-						mtl.emissive.z() = attr->ValueFloat();
+						mtl.emissive.z() = attr.ValueFloat();
 					}
 				}
 			}
 
-			XMLNodePtr bump_node = mtl_node->FirstNode("bump");
+			XMLNodeView bump_node = mtl_node.FirstNode("bump");
 			if (bump_node)
 			{
-				XMLAttributePtr attr = bump_node->Attrib("texture");
+				XMLAttributeView attr = bump_node.Attrib("texture");
 				if (attr)
 				{
-					offline_mtl.texture_slots.emplace_back("Bump", attr->ValueString());
+					offline_mtl.texture_slots.emplace_back("Bump", attr.ValueString());
 				}
 			}
 			
-			XMLNodePtr normal_node = mtl_node->FirstNode("normal");
+			XMLNodeView normal_node = mtl_node.FirstNode("normal");
 			if (normal_node)
 			{
-				XMLAttributePtr attr = normal_node->Attrib("texture");
+				XMLAttributeView attr = normal_node.Attrib("texture");
 				if (attr)
 				{
-					offline_mtl.texture_slots.emplace_back("Normal", attr->ValueString());
+					offline_mtl.texture_slots.emplace_back("Normal", attr.ValueString());
 				}
 			}
 
-			XMLNodePtr height_node = mtl_node->FirstNode("height");
+			XMLNodeView height_node = mtl_node.FirstNode("height");
 			if (height_node)
 			{
-				XMLAttributePtr attr = height_node->Attrib("texture");
+				XMLAttributeView attr = height_node.Attrib("texture");
 				if (attr)
 				{
-					offline_mtl.texture_slots.emplace_back("Height", attr->ValueString());
+					offline_mtl.texture_slots.emplace_back("Height", attr.ValueString());
 				}
 
-				attr = height_node->Attrib("offset");
+				attr = height_node.Attrib("offset");
 				if (attr)
 				{
-					mtl.height_offset_scale.x() = attr->ValueFloat();
+					mtl.height_offset_scale.x() = attr.ValueFloat();
 				}
 
-				attr = height_node->Attrib("scale");
+				attr = height_node.Attrib("scale");
 				if (attr)
 				{
-					mtl.height_offset_scale.y() = attr->ValueFloat();
+					mtl.height_offset_scale.y() = attr.ValueFloat();
 				}
 			}
 
-			XMLNodePtr detail_node = mtl_node->FirstNode("detail");
+			XMLNodeView detail_node = mtl_node.FirstNode("detail");
 			if (detail_node)
 			{
-				XMLAttributePtr attr = detail_node->Attrib("mode");
+				XMLAttributeView attr = detail_node.Attrib("mode");
 				if (attr)
 				{
-					std::string const & mode_str = attr->ValueString();
-					size_t const mode_hash = RT_HASH(mode_str.c_str());
+					size_t const mode_hash = RT_HASH(attr.ValueString());
 					if (CT_HASH("Flat Tessellation") == mode_hash)
 					{
 						mtl.detail_mode = RenderMaterial::SDM_FlatTessellation;
@@ -333,130 +340,130 @@ namespace
 					}
 				}
 
-				attr = detail_node->Attrib("height_offset");
+				attr = detail_node.Attrib("height_offset");
 				if (attr)
 				{
-					mtl.height_offset_scale.x() = attr->ValueFloat();
+					mtl.height_offset_scale.x() = attr.ValueFloat();
 				}
 
-				attr = detail_node->Attrib("height_scale");
+				attr = detail_node.Attrib("height_scale");
 				if (attr)
 				{
-					mtl.height_offset_scale.y() = attr->ValueFloat();
+					mtl.height_offset_scale.y() = attr.ValueFloat();
 				}
 
-				XMLNodePtr tess_node = detail_node->FirstNode("tess");
+				XMLNodeView tess_node = detail_node.FirstNode("tess");
 				if (tess_node)
 				{
-					attr = tess_node->Attrib("edge_hint");
+					attr = tess_node.Attrib("edge_hint");
 					if (attr)
 					{
-						mtl.tess_factors.x() = attr->ValueFloat();
+						mtl.tess_factors.x() = attr.ValueFloat();
 					}
-					attr = tess_node->Attrib("inside_hint");
+					attr = tess_node.Attrib("inside_hint");
 					if (attr)
 					{
-						mtl.tess_factors.y() = attr->ValueFloat();
+						mtl.tess_factors.y() = attr.ValueFloat();
 					}
-					attr = tess_node->Attrib("min");
+					attr = tess_node.Attrib("min");
 					if (attr)
 					{
-						mtl.tess_factors.z() = attr->ValueFloat();
+						mtl.tess_factors.z() = attr.ValueFloat();
 					}
-					attr = tess_node->Attrib("max");
+					attr = tess_node.Attrib("max");
 					if (attr)
 					{
-						mtl.tess_factors.w() = attr->ValueFloat();
+						mtl.tess_factors.w() = attr.ValueFloat();
 					}
 				}
 				else
 				{
-					attr = detail_node->Attrib("edge_tess_hint");
+					attr = detail_node.Attrib("edge_tess_hint");
 					if (attr)
 					{
-						mtl.tess_factors.x() = attr->ValueFloat();
+						mtl.tess_factors.x() = attr.ValueFloat();
 					}
-					attr = detail_node->Attrib("inside_tess_hint");
+					attr = detail_node.Attrib("inside_tess_hint");
 					if (attr)
 					{
-						mtl.tess_factors.y() = attr->ValueFloat();
+						mtl.tess_factors.y() = attr.ValueFloat();
 					}
-					attr = detail_node->Attrib("min_tess");
+					attr = detail_node.Attrib("min_tess");
 					if (attr)
 					{
-						mtl.tess_factors.z() = attr->ValueFloat();
+						mtl.tess_factors.z() = attr.ValueFloat();
 					}
-					attr = detail_node->Attrib("max_tess");
+					attr = detail_node.Attrib("max_tess");
 					if (attr)
 					{
-						mtl.tess_factors.w() = attr->ValueFloat();
+						mtl.tess_factors.w() = attr.ValueFloat();
 					}
 				}
 			}
 
-			XMLNodePtr transparent_node = mtl_node->FirstNode("transparent");
+			XMLNodeView transparent_node = mtl_node.FirstNode("transparent");
 			if (transparent_node)
 			{
-				XMLAttributePtr attr = transparent_node->Attrib("value");
+				XMLAttributeView attr = transparent_node.Attrib("value");
 				if (attr)
 				{
-					mtl.transparent = attr->ValueInt() ? true : false;
+					mtl.transparent = attr.ValueInt() ? true : false;
 				}
 			}
 
-			XMLNodePtr alpha_test_node = mtl_node->FirstNode("alpha_test");
+			XMLNodeView alpha_test_node = mtl_node.FirstNode("alpha_test");
 			if (alpha_test_node)
 			{
-				XMLAttributePtr attr = alpha_test_node->Attrib("value");
+				XMLAttributeView attr = alpha_test_node.Attrib("value");
 				if (attr)
 				{
-					mtl.alpha_test = attr->ValueFloat();
+					mtl.alpha_test = attr.ValueFloat();
 				}
 			}
 
-			XMLNodePtr sss_node = mtl_node->FirstNode("sss");
+			XMLNodeView sss_node = mtl_node.FirstNode("sss");
 			if (sss_node)
 			{
-				XMLAttributePtr attr = sss_node->Attrib("value");
+				XMLAttributeView attr = sss_node.Attrib("value");
 				if (attr)
 				{
-					mtl.sss = attr->ValueInt() ? true : false;
+					mtl.sss = attr.ValueInt() ? true : false;
 				}
 			}
 			else
 			{
-				XMLAttributePtr attr = mtl_node->Attrib("sss");
+				XMLAttributeView attr = mtl_node.Attrib("sss");
 				if (attr)
 				{
-					mtl.sss = attr->ValueInt() ? true : false;
+					mtl.sss = attr.ValueInt() ? true : false;
 				}
 			}
 
-			XMLNodePtr two_sided_node = mtl_node->FirstNode("two_sided");
+			XMLNodeView two_sided_node = mtl_node.FirstNode("two_sided");
 			if (two_sided_node)
 			{
-				XMLAttributePtr attr = two_sided_node->Attrib("value");
+				XMLAttributeView attr = two_sided_node.Attrib("value");
 				if (attr)
 				{
-					mtl.two_sided = attr->ValueInt() ? true : false;
+					mtl.two_sided = attr.ValueInt() ? true : false;
 				}
 			}
 
-			XMLNodePtr tex_node = mtl_node->FirstNode("texture");
+			XMLNodeView tex_node = mtl_node.FirstNode("texture");
 			if (!tex_node)
 			{
-				XMLNodePtr textures_chunk = mtl_node->FirstNode("textures_chunk");
+				XMLNodeView textures_chunk = mtl_node.FirstNode("textures_chunk");
 				if (textures_chunk)
 				{
-					tex_node = textures_chunk->FirstNode("texture");
+					tex_node = textures_chunk.FirstNode("texture");
 				}
 			}
 			if (tex_node)
 			{
-				for (; tex_node; tex_node = tex_node->NextSibling("texture"))
+				for (; tex_node; tex_node = tex_node.NextSibling("texture"))
 				{
-					offline_mtl.texture_slots.emplace_back(tex_node->Attrib("type")->ValueString(),
-						tex_node->Attrib("name")->ValueString());
+					offline_mtl.texture_slots.emplace_back(tex_node.Attrib("type").ValueString(),
+						tex_node.Attrib("name").ValueString());
 				}
 			}
 
@@ -464,40 +471,40 @@ namespace
 		}
 	}
 
-	void CompileMeshBoundingBox(XMLNodePtr const & mesh_node,
+	void CompileMeshBoundingBox(XMLNodeView const & mesh_node,
 		AABBox& pos_bb, AABBox& tc_bb,
 		bool& recompute_pos_bb, bool& recompute_tc_bb)
 	{
-		XMLNodePtr pos_bb_node = mesh_node->FirstNode("pos_bb");
+		XMLNodeView pos_bb_node = mesh_node.FirstNode("pos_bb");
 		if (pos_bb_node)
 		{
 			float3 pos_min_bb, pos_max_bb;
 			{
-				XMLAttributePtr attr = pos_bb_node->Attrib("min");
+				XMLAttributeView attr = pos_bb_node.Attrib("min");
 				if (attr)
 				{
-					ExtractFVector<3>(attr->ValueString(), &pos_min_bb[0]);
+					ExtractFVector<3>(attr, &pos_min_bb[0]);
 				}
 				else
 				{
-					XMLNodePtr pos_min_node = pos_bb_node->FirstNode("min");
-					pos_min_bb.x() = pos_min_node->Attrib("x")->ValueFloat();
-					pos_min_bb.y() = pos_min_node->Attrib("y")->ValueFloat();
-					pos_min_bb.z() = pos_min_node->Attrib("z")->ValueFloat();
+					XMLNodeView pos_min_node = pos_bb_node.FirstNode("min");
+					pos_min_bb.x() = pos_min_node.Attrib("x").ValueFloat();
+					pos_min_bb.y() = pos_min_node.Attrib("y").ValueFloat();
+					pos_min_bb.z() = pos_min_node.Attrib("z").ValueFloat();
 				}
 			}
 			{
-				XMLAttributePtr attr = pos_bb_node->Attrib("max");
+				XMLAttributeView attr = pos_bb_node.Attrib("max");
 				if (attr)
 				{
-					ExtractFVector<3>(attr->ValueString(), &pos_max_bb[0]);
+					ExtractFVector<3>(attr, &pos_max_bb[0]);
 				}
 				else
 				{
-					XMLNodePtr pos_max_node = pos_bb_node->FirstNode("max");
-					pos_max_bb.x() = pos_max_node->Attrib("x")->ValueFloat();
-					pos_max_bb.y() = pos_max_node->Attrib("y")->ValueFloat();
-					pos_max_bb.z() = pos_max_node->Attrib("z")->ValueFloat();
+					XMLNodeView pos_max_node = pos_bb_node.FirstNode("max");
+					pos_max_bb.x() = pos_max_node.Attrib("x").ValueFloat();
+					pos_max_bb.y() = pos_max_node.Attrib("y").ValueFloat();
+					pos_max_bb.z() = pos_max_node.Attrib("z").ValueFloat();
 				}
 			}
 			pos_bb = AABBox(pos_min_bb, pos_max_bb);
@@ -509,34 +516,34 @@ namespace
 			recompute_pos_bb = true;
 		}
 
-		XMLNodePtr tc_bb_node = mesh_node->FirstNode("tc_bb");
+		XMLNodeView tc_bb_node = mesh_node.FirstNode("tc_bb");
 		if (tc_bb_node)
 		{
 			float3 tc_min_bb, tc_max_bb;
 			{
-				XMLAttributePtr attr = tc_bb_node->Attrib("min");
+				XMLAttributeView attr = tc_bb_node.Attrib("min");
 				if (attr)
 				{
-					ExtractFVector<2>(attr->ValueString(), &tc_min_bb[0]);
+					ExtractFVector<2>(attr, &tc_min_bb[0]);
 				}
 				else
 				{
-					XMLNodePtr tc_min_node = tc_bb_node->FirstNode("min");
-					tc_min_bb.x() = tc_min_node->Attrib("x")->ValueFloat();
-					tc_min_bb.y() = tc_min_node->Attrib("y")->ValueFloat();
+					XMLNodeView tc_min_node = tc_bb_node.FirstNode("min");
+					tc_min_bb.x() = tc_min_node.Attrib("x").ValueFloat();
+					tc_min_bb.y() = tc_min_node.Attrib("y").ValueFloat();
 				}
 			}
 			{
-				XMLAttributePtr attr = tc_bb_node->Attrib("max");
+				XMLAttributeView attr = tc_bb_node.Attrib("max");
 				if (attr)
 				{
-					ExtractFVector<2>(attr->ValueString(), &tc_max_bb[0]);
+					ExtractFVector<2>(attr, &tc_max_bb[0]);
 				}
 				else
 				{
-					XMLNodePtr tc_max_node = tc_bb_node->FirstNode("max");
-					tc_max_bb.x() = tc_max_node->Attrib("x")->ValueFloat();
-					tc_max_bb.y() = tc_max_node->Attrib("y")->ValueFloat();
+					XMLNodeView tc_max_node = tc_bb_node.FirstNode("max");
+					tc_max_bb.x() = tc_max_node.Attrib("x").ValueFloat();
+					tc_max_bb.y() = tc_max_node.Attrib("y").ValueFloat();
 				}
 			}
 
@@ -552,7 +559,7 @@ namespace
 		}
 	}
 
-	void CompileMeshesVerticesChunk(XMLNodePtr const & vertices_chunk,
+	void CompileMeshesVerticesChunk(XMLNodeView const & vertices_chunk,
 		AABBox& pos_bb, AABBox& tc_bb, bool recompute_pos_bb, bool recompute_tc_bb,
 		std::vector<VertexElement>& vertex_elements,
 		std::vector<int16_t>& positions, std::vector<uint32_t>& normals,
@@ -581,97 +588,97 @@ namespace
 		bool has_binormal = false;
 		bool has_tangent_quat = false;
 
-		for (XMLNodePtr vertex_node = vertices_chunk->FirstNode("vertex"); vertex_node; vertex_node = vertex_node->NextSibling("vertex"))
+		for (XMLNodeView vertex_node = vertices_chunk.FirstNode("vertex"); vertex_node; vertex_node = vertex_node.NextSibling("vertex"))
 		{
 			{
 				float3 pos;
-				XMLAttributePtr attr = vertex_node->Attrib("x");
+				XMLAttributeView attr = vertex_node.Attrib("x");
 				if (attr)
 				{
-					pos.x() = vertex_node->Attrib("x")->ValueFloat();
-					pos.y() = vertex_node->Attrib("y")->ValueFloat();
-					pos.z() = vertex_node->Attrib("z")->ValueFloat();
+					pos.x() = vertex_node.Attrib("x").ValueFloat();
+					pos.y() = vertex_node.Attrib("y").ValueFloat();
+					pos.z() = vertex_node.Attrib("z").ValueFloat();
 
-					attr = vertex_node->Attrib("u");
+					attr = vertex_node.Attrib("u");
 					if (attr)
 					{
 						float2 tex_coord;
-						tex_coord.x() = vertex_node->Attrib("u")->ValueFloat();
-						tex_coord.y() = vertex_node->Attrib("v")->ValueFloat();
+						tex_coord.x() = vertex_node.Attrib("u").ValueFloat();
+						tex_coord.y() = vertex_node.Attrib("v").ValueFloat();
 						mesh_tex_coords.push_back(tex_coord);
 					}
 				}
 				else
 				{
-					ExtractFVector<3>(vertex_node->Attrib("v")->ValueString(), &pos[0]);
+					ExtractFVector<3>(vertex_node.Attrib("v"), &pos[0]);
 				}
 				mesh_positions.push_back(pos);
 			}
 
-			XMLNodePtr diffuse_node = vertex_node->FirstNode("diffuse");
+			XMLNodeView diffuse_node = vertex_node.FirstNode("diffuse");
 			if (diffuse_node)
 			{
 				has_diffuse = true;
 
 				float4 diffuse;
-				XMLAttributePtr attr = diffuse_node->Attrib("v");
+				XMLAttributeView attr = diffuse_node.Attrib("v");
 				if (attr)
 				{
-					ExtractFVector<4>(attr->ValueString(), &diffuse[0]);
+					ExtractFVector<4>(attr, &diffuse[0]);
 				}
 				else
 				{
-					diffuse.x() = diffuse_node->Attrib("r")->ValueFloat();
-					diffuse.y() = diffuse_node->Attrib("g")->ValueFloat();
-					diffuse.z() = diffuse_node->Attrib("b")->ValueFloat();
-					diffuse.w() = diffuse_node->Attrib("a")->ValueFloat();										
+					diffuse.x() = diffuse_node.Attrib("r").ValueFloat();
+					diffuse.y() = diffuse_node.Attrib("g").ValueFloat();
+					diffuse.z() = diffuse_node.Attrib("b").ValueFloat();
+					diffuse.w() = diffuse_node.Attrib("a").ValueFloat();										
 				}
 				mesh_diffuses.push_back(diffuse);
 			}
 
-			XMLNodePtr specular_node = vertex_node->FirstNode("specular");
+			XMLNodeView specular_node = vertex_node.FirstNode("specular");
 			if (specular_node)
 			{
 				has_specular = true;
 
 				float3 specular;
-				XMLAttributePtr attr = specular_node->Attrib("v");
+				XMLAttributeView attr = specular_node.Attrib("v");
 				if (attr)
 				{
-					ExtractFVector<3>(attr->ValueString(), &specular[0]);
+					ExtractFVector<3>(attr, &specular[0]);
 				}
 				else
 				{
-					specular.x() = specular_node->Attrib("r")->ValueFloat();
-					specular.y() = specular_node->Attrib("g")->ValueFloat();
-					specular.z() = specular_node->Attrib("b")->ValueFloat();
+					specular.x() = specular_node.Attrib("r").ValueFloat();
+					specular.y() = specular_node.Attrib("g").ValueFloat();
+					specular.z() = specular_node.Attrib("b").ValueFloat();
 				}
 				mesh_speculars.push_back(specular);
 			}
 
-			if (!vertex_node->Attrib("u"))
+			if (!vertex_node.Attrib("u"))
 			{
-				XMLNodePtr tex_coord_node = vertex_node->FirstNode("tex_coord");
+				XMLNodeView tex_coord_node = vertex_node.FirstNode("tex_coord");
 				if (tex_coord_node)
 				{
 					has_tex_coord = true;
 
 					float2 tex_coord;
-					XMLAttributePtr attr = tex_coord_node->Attrib("u");
+					XMLAttributeView attr = tex_coord_node.Attrib("u");
 					if (attr)
 					{
-						tex_coord.x() = tex_coord_node->Attrib("u")->ValueFloat();
-						tex_coord.y() = tex_coord_node->Attrib("v")->ValueFloat();
+						tex_coord.x() = tex_coord_node.Attrib("u").ValueFloat();
+						tex_coord.y() = tex_coord_node.Attrib("v").ValueFloat();
 					}
 					else
 					{
-						ExtractFVector<2>(tex_coord_node->Attrib("v")->ValueString(), &tex_coord[0]);
+						ExtractFVector<2>(tex_coord_node.Attrib("v"), &tex_coord[0]);
 					}
 					mesh_tex_coords.push_back(tex_coord);
 				}
 			}
 
-			XMLNodePtr weight_node = vertex_node->FirstNode("weight");
+			XMLNodeView weight_node = vertex_node.FirstNode("weight");
 			if (weight_node)
 			{
 				has_weight = true;
@@ -680,41 +687,30 @@ namespace
 				float bone_weight32[4] = { 0, 0, 0, 0 };
 
 				uint32_t num_blend = 0;
-				XMLAttributePtr attr = weight_node->Attrib("joint");
+				XMLAttributeView attr = weight_node.Attrib("joint");
 				if (!attr)
 				{
-					attr = weight_node->Attrib("bone_index");
+					attr = weight_node.Attrib("bone_index");
 				}
 				if (attr)
 				{
-					XMLAttributePtr weight_attr = weight_node->Attrib("weight");
-
-					std::vector<std::string> index_strs;
-					std::vector<std::string> weight_strs;
-					boost::algorithm::split(index_strs, attr->ValueString(), boost::is_any_of(" "));
-					boost::algorithm::split(weight_strs, weight_attr->ValueString(), boost::is_any_of(" "));
-					
-					for (num_blend = 0; num_blend < 4; ++ num_blend)
+					uint32_t const num_indices = ExtractTokens(attr.ValueString(), bone_index32, 4);
+					uint32_t const num_weights = ExtractTokens(weight_node.Attrib("weight").ValueString(), bone_weight32, 4);
+					num_blend = std::min(num_indices, num_weights);
+					for (uint32_t j = num_blend; j < 4; ++ j)
 					{
-						if ((num_blend < index_strs.size()) && (num_blend < weight_strs.size()))
-						{
-							bone_index32[num_blend] = static_cast<uint32_t>(atoi(index_strs[num_blend].c_str()));
-							bone_weight32[num_blend] = static_cast<float>(atof(weight_strs[num_blend].c_str()));
-						}
-						else
-						{
-							break;
-						}
+						bone_index32[j] = 0;
+						bone_weight32[j] = 0;
 					}
 				}
 				else
 				{
 					while (weight_node && (num_blend < 4))
 					{
-						bone_index32[num_blend] = weight_node->Attrib("bone_index")->ValueUInt();
-						bone_weight32[num_blend] = weight_node->Attrib("weight")->ValueFloat();
+						bone_index32[num_blend] = weight_node.Attrib("bone_index").ValueUInt();
+						bone_weight32[num_blend] = weight_node.Attrib("weight").ValueFloat();
 
-						weight_node = weight_node->NextSibling("weight");
+						weight_node = weight_node.NextSibling("weight");
 						++ num_blend;
 					}
 				}
@@ -733,46 +729,46 @@ namespace
 				mesh_bone_weights.push_back(weight32);
 			}
 						
-			XMLNodePtr normal_node = vertex_node->FirstNode("normal");
+			XMLNodeView normal_node = vertex_node.FirstNode("normal");
 			if (normal_node)
 			{
 				has_normal = true;
 
 				float3 normal;
-				XMLAttributePtr attr = normal_node->Attrib("v");
+				XMLAttributeView attr = normal_node.Attrib("v");
 				if (attr)
 				{
-					ExtractFVector<3>(attr->ValueString(), &normal[0]);
+					ExtractFVector<3>(attr, &normal[0]);
 				}
 				else
 				{
-					normal.x() = normal_node->Attrib("x")->ValueFloat();
-					normal.y() = normal_node->Attrib("y")->ValueFloat();
-					normal.z() = normal_node->Attrib("z")->ValueFloat();
+					normal.x() = normal_node.Attrib("x").ValueFloat();
+					normal.y() = normal_node.Attrib("y").ValueFloat();
+					normal.z() = normal_node.Attrib("z").ValueFloat();
 				}
 				mesh_normals.push_back(normal);
 			}
 
-			XMLNodePtr tangent_node = vertex_node->FirstNode("tangent");
+			XMLNodeView tangent_node = vertex_node.FirstNode("tangent");
 			if (tangent_node)
 			{
 				has_tangent = true;
 
 				float4 tangent;
-				XMLAttributePtr attr = tangent_node->Attrib("v");
+				XMLAttributeView attr = tangent_node.Attrib("v");
 				if (attr)
 				{
-					ExtractFVector<4>(attr->ValueString(), &tangent[0]);
+					ExtractFVector<4>(attr, &tangent[0]);
 				}
 				else
 				{
-					tangent.x() = tangent_node->Attrib("x")->ValueFloat();
-					tangent.y() = tangent_node->Attrib("y")->ValueFloat();
-					tangent.z() = tangent_node->Attrib("z")->ValueFloat();
-					attr = tangent_node->Attrib("w");
+					tangent.x() = tangent_node.Attrib("x").ValueFloat();
+					tangent.y() = tangent_node.Attrib("y").ValueFloat();
+					tangent.z() = tangent_node.Attrib("z").ValueFloat();
+					attr = tangent_node.Attrib("w");
 					if (attr)
 					{
-						tangent.w() = attr->ValueFloat();
+						tangent.w() = attr.ValueFloat();
 					}
 					else
 					{
@@ -782,43 +778,43 @@ namespace
 				mesh_tangents.push_back(tangent);
 			}
 
-			XMLNodePtr binormal_node = vertex_node->FirstNode("binormal");
+			XMLNodeView binormal_node = vertex_node.FirstNode("binormal");
 			if (binormal_node)
 			{
 				has_binormal = true;
 
 				float3 binormal;
-				XMLAttributePtr attr = binormal_node->Attrib("v");
+				XMLAttributeView attr = binormal_node.Attrib("v");
 				if (attr)
 				{
-					ExtractFVector<3>(attr->ValueString(), &binormal[0]);
+					ExtractFVector<3>(attr, &binormal[0]);
 				}
 				else
 				{
-					binormal.x() = binormal_node->Attrib("x")->ValueFloat();
-					binormal.y() = binormal_node->Attrib("y")->ValueFloat();
-					binormal.z() = binormal_node->Attrib("z")->ValueFloat();
+					binormal.x() = binormal_node.Attrib("x").ValueFloat();
+					binormal.y() = binormal_node.Attrib("y").ValueFloat();
+					binormal.z() = binormal_node.Attrib("z").ValueFloat();
 				}
 				mesh_binormals.push_back(binormal);
 			}
 
-			XMLNodePtr tangent_quat_node = vertex_node->FirstNode("tangent_quat");
+			XMLNodeView tangent_quat_node = vertex_node.FirstNode("tangent_quat");
 			if (tangent_quat_node)
 			{
 				has_tangent_quat = true;
 
 				Quaternion tangent_quat;
-				XMLAttributePtr const & attr = tangent_quat_node->Attrib("v");
+				XMLAttributeView const attr = tangent_quat_node.Attrib("v");
 				if (attr)
 				{
-					ExtractFVector<4>(attr->ValueString(), &tangent_quat[0]);
+					ExtractFVector<4>(attr, &tangent_quat[0]);
 				}
 				else
 				{
-					tangent_quat.x() = tangent_quat_node->Attrib("x")->ValueFloat();
-					tangent_quat.y() = tangent_quat_node->Attrib("y")->ValueFloat();
-					tangent_quat.z() = tangent_quat_node->Attrib("z")->ValueFloat();
-					tangent_quat.w() = tangent_quat_node->Attrib("w")->ValueFloat();
+					tangent_quat.x() = tangent_quat_node.Attrib("x").ValueFloat();
+					tangent_quat.y() = tangent_quat_node.Attrib("y").ValueFloat();
+					tangent_quat.z() = tangent_quat_node.Attrib("z").ValueFloat();
+					tangent_quat.w() = tangent_quat_node.Attrib("w").ValueFloat();
 				}
 				mesh_tangent_quats.push_back(tangent_quat);
 			}
@@ -1063,25 +1059,25 @@ namespace
 		bone_weights = mesh_bone_weights;
 	}
 
-	void CompileMeshesTrianglesChunk(XMLNodePtr const & triangles_chunk,
+	void CompileMeshesTrianglesChunk(XMLNodeView const & triangles_chunk,
 		std::vector<uint8_t>& triangle_indices, char& is_index_16)
 	{
 		std::vector<uint32_t> mesh_triangle_indices;
 
 		is_index_16 = true;
-		for (XMLNodePtr tri_node = triangles_chunk->FirstNode("triangle"); tri_node; tri_node = tri_node->NextSibling("triangle"))
+		for (XMLNodeView tri_node = triangles_chunk.FirstNode("triangle"); tri_node; tri_node = tri_node.NextSibling("triangle"))
 		{
 			uint32_t ind[3];
-			XMLAttributePtr attr = tri_node->Attrib("index");
+			XMLAttributeView attr = tri_node.Attrib("index");
 			if (attr)
 			{
-				ExtractUIVector<3>(attr->ValueString(), &ind[0]);
+				ExtractUIVector<3>(attr, &ind[0]);
 			}
 			else
 			{
-				ind[0] = tri_node->Attrib("a")->ValueUInt();
-				ind[1] = tri_node->Attrib("b")->ValueUInt();
-				ind[2] = tri_node->Attrib("c")->ValueUInt();
+				ind[0] = tri_node.Attrib("a").ValueUInt();
+				ind[1] = tri_node.Attrib("b").ValueUInt();
+				ind[2] = tri_node.Attrib("c").ValueUInt();
 			}
 			mesh_triangle_indices.push_back(ind[0]);
 			mesh_triangle_indices.push_back(ind[1]);
@@ -1316,7 +1312,7 @@ namespace
 		}
 	}
 
-	void CompileMeshLodChunk(XMLNodePtr const & lod_node, uint32_t mesh_index,
+	void CompileMeshLodChunk(XMLNodeView const & lod_node, uint32_t mesh_index,
 		std::vector<AABBox>& pos_bbs, std::vector<AABBox>& tc_bbs, bool recompute_pos_bb, bool recompute_tc_bb,
 		std::vector<uint32_t>& mesh_num_vertices, std::vector<uint32_t>& mesh_base_vertices,
 		std::vector<uint32_t>& mesh_num_indices, std::vector<uint32_t>& mesh_start_indices,
@@ -1333,7 +1329,7 @@ namespace
 		std::vector<uint32_t> bone_indices;
 		std::vector<uint32_t> bone_weights;
 
-		XMLNodePtr vertices_chunk = lod_node->FirstNode("vertices_chunk");
+		XMLNodeView vertices_chunk = lod_node.FirstNode("vertices_chunk");
 		if (vertices_chunk)
 		{
 			CompileMeshesVerticesChunk(vertices_chunk,
@@ -1352,7 +1348,7 @@ namespace
 
 		std::vector<uint8_t> triangle_indices;
 
-		XMLNodePtr triangles_chunk = lod_node->FirstNode("triangles_chunk");
+		XMLNodeView triangles_chunk = lod_node.FirstNode("triangles_chunk");
 		if (triangles_chunk)
 		{
 			char is_index_16s = true;
@@ -1364,7 +1360,7 @@ namespace
 		}
 	}
 
-	void CompileMeshesChunk(XMLNodePtr const & meshes_chunk,
+	void CompileMeshesChunk(XMLNodeView const & meshes_chunk,
 		std::vector<std::string>& mesh_names, std::vector<int32_t>& mtl_ids, std::vector<uint32_t>& mesh_lods,
 		std::vector<AABBox>& pos_bbs, std::vector<AABBox>& tc_bbs, 
 		std::vector<uint32_t>& mesh_num_vertices, std::vector<uint32_t>& mesh_base_vertices,
@@ -1386,10 +1382,10 @@ namespace
 		is_index_16_bit = true;
 
 		uint32_t mesh_index = 0;
-		for (XMLNodePtr mesh_node = meshes_chunk->FirstNode("mesh"); mesh_node; mesh_node = mesh_node->NextSibling("mesh"), ++ mesh_index)
+		for (XMLNodeView mesh_node = meshes_chunk.FirstNode("mesh"); mesh_node; mesh_node = mesh_node.NextSibling("mesh"), ++ mesh_index)
 		{
-			mesh_names.push_back(mesh_node->Attrib("name")->ValueString());
-			mtl_ids.push_back(mesh_node->Attrib("mtl_id")->ValueInt());
+			mesh_names.emplace_back(mesh_node.Attrib("name").ValueString());
+			mtl_ids.push_back(mesh_node.Attrib("mtl_id").ValueInt());
 
 			pos_bbs.resize(mesh_index + 1);
 			tc_bbs.resize(pos_bbs.size());
@@ -1398,7 +1394,7 @@ namespace
 			CompileMeshBoundingBox(mesh_node, pos_bbs[mesh_index], tc_bbs[mesh_index], recompute_pos_bb, recompute_tc_bb);
 			if (recompute_pos_bb && recompute_tc_bb)
 			{
-				XMLNodePtr vertices_chunk = mesh_node->FirstNode("vertices_chunk");
+				XMLNodeView vertices_chunk = mesh_node.FirstNode("vertices_chunk");
 				if (vertices_chunk)
 				{
 					CompileMeshBoundingBox(vertices_chunk, pos_bbs[mesh_index], tc_bbs[mesh_index], recompute_pos_bb, recompute_tc_bb);
@@ -1407,20 +1403,20 @@ namespace
 
 			uint32_t mesh_lod;
 
-			XMLNodePtr lod_node = mesh_node->FirstNode("lod");
+			XMLNodeView lod_node = mesh_node.FirstNode("lod");
 			if (lod_node)
 			{
 				mesh_lod = 0;
 
-				for (; lod_node; lod_node = lod_node->NextSibling("lod"))
+				for (; lod_node; lod_node = lod_node.NextSibling("lod"))
 				{
 					++ mesh_lod;
 				}
 
-				std::vector<XMLNodePtr> lod_nodes(mesh_lod);
-				for (lod_node = mesh_node->FirstNode("lod"); lod_node; lod_node = lod_node->NextSibling("lod"))
+				std::vector<XMLNodeView> lod_nodes(mesh_lod);
+				for (lod_node = mesh_node.FirstNode("lod"); lod_node; lod_node = lod_node.NextSibling("lod"))
 				{
-					uint32_t const lod = lod_node->Attrib("value")->ValueUInt();
+					uint32_t const lod = lod_node.Attrib("value").ValueUInt();
 					lod_nodes[lod] = lod_node;
 				}
 
@@ -1464,24 +1460,24 @@ namespace
 		}
 	}
 
-	void CompileBonesChunk(XMLNodePtr const & bones_chunk,
+	void CompileBonesChunk(XMLNodeView const & bones_chunk,
 		std::vector<Joint>& joints)
 	{
 		Joint joint;
-		for (XMLNodePtr bone_node = bones_chunk->FirstNode("bone"); bone_node; bone_node = bone_node->NextSibling("bone"))
+		for (XMLNodeView bone_node = bones_chunk.FirstNode("bone"); bone_node; bone_node = bone_node.NextSibling("bone"))
 		{
-			joint.name = bone_node->Attrib("name")->ValueString();
-			joint.parent = static_cast<int16_t>(bone_node->Attrib("parent")->ValueInt());
+			joint.name = std::string(bone_node.Attrib("name").ValueString());
+			joint.parent = static_cast<int16_t>(bone_node.Attrib("parent").ValueInt());
 
-			XMLNodePtr bind_pos_node = bone_node->FirstNode("bind_pos");
+			XMLNodeView bind_pos_node = bone_node.FirstNode("bind_pos");
 			if (bind_pos_node)
 			{
-				float3 bind_pos(bind_pos_node->Attrib("x")->ValueFloat(), bind_pos_node->Attrib("y")->ValueFloat(),
-					bind_pos_node->Attrib("z")->ValueFloat());
+				float3 bind_pos(bind_pos_node.Attrib("x").ValueFloat(), bind_pos_node.Attrib("y").ValueFloat(),
+					bind_pos_node.Attrib("z").ValueFloat());
 
-				XMLNodePtr bind_quat_node = bone_node->FirstNode("bind_quat");
-				Quaternion bind_quat(bind_quat_node->Attrib("x")->ValueFloat(), bind_quat_node->Attrib("y")->ValueFloat(),
-					bind_quat_node->Attrib("z")->ValueFloat(), bind_quat_node->Attrib("w")->ValueFloat());
+				XMLNodeView bind_quat_node = bone_node.FirstNode("bind_quat");
+				Quaternion bind_quat(bind_quat_node.Attrib("x").ValueFloat(), bind_quat_node.Attrib("y").ValueFloat(),
+					bind_quat_node.Attrib("z").ValueFloat(), bind_quat_node.Attrib("w").ValueFloat());
 
 				float scale = MathLib::length(bind_quat);
 				bind_quat /= scale;
@@ -1492,40 +1488,40 @@ namespace
 			}
 			else
 			{
-				XMLNodePtr bind_real_node = bone_node->FirstNode("real");
+				XMLNodeView bind_real_node = bone_node.FirstNode("real");
 				if (!bind_real_node)
 				{
-					bind_real_node = bone_node->FirstNode("bind_real");
+					bind_real_node = bone_node.FirstNode("bind_real");
 				}
-				XMLAttributePtr attr = bind_real_node->Attrib("v");
+				XMLAttributeView attr = bind_real_node.Attrib("v");
 				if (attr)
 				{
-					ExtractFVector<4>(attr->ValueString(), &joint.bind_real[0]);
+					ExtractFVector<4>(attr, &joint.bind_real[0]);
 				}
 				else
 				{
-					joint.bind_real.x() = bind_real_node->Attrib("x")->ValueFloat();
-					joint.bind_real.y() = bind_real_node->Attrib("y")->ValueFloat();
-					joint.bind_real.z() = bind_real_node->Attrib("z")->ValueFloat();
-					joint.bind_real.w() = bind_real_node->Attrib("w")->ValueFloat();
+					joint.bind_real.x() = bind_real_node.Attrib("x").ValueFloat();
+					joint.bind_real.y() = bind_real_node.Attrib("y").ValueFloat();
+					joint.bind_real.z() = bind_real_node.Attrib("z").ValueFloat();
+					joint.bind_real.w() = bind_real_node.Attrib("w").ValueFloat();
 				}
 
-				XMLNodePtr bind_dual_node = bone_node->FirstNode("dual");
+				XMLNodeView bind_dual_node = bone_node.FirstNode("dual");
 				if (!bind_dual_node)
 				{
-					bind_dual_node = bone_node->FirstNode("bind_dual");
+					bind_dual_node = bone_node.FirstNode("bind_dual");
 				}
-				attr = bind_dual_node->Attrib("v");
+				attr = bind_dual_node.Attrib("v");
 				if (attr)
 				{
-					ExtractFVector<4>(attr->ValueString(), &joint.bind_dual[0]);
+					ExtractFVector<4>(attr, &joint.bind_dual[0]);
 				}
 				else
 				{
-					joint.bind_dual.x() = bind_dual_node->Attrib("x")->ValueFloat();
-					joint.bind_dual.y() = bind_dual_node->Attrib("y")->ValueFloat();
-					joint.bind_dual.z() = bind_dual_node->Attrib("z")->ValueFloat();
-					joint.bind_dual.w() = bind_dual_node->Attrib("w")->ValueFloat();
+					joint.bind_dual.x() = bind_dual_node.Attrib("x").ValueFloat();
+					joint.bind_dual.y() = bind_dual_node.Attrib("y").ValueFloat();
+					joint.bind_dual.z() = bind_dual_node.Attrib("z").ValueFloat();
+					joint.bind_dual.w() = bind_dual_node.Attrib("w").ValueFloat();
 				}
 
 				joint.bind_scale = MathLib::length(joint.bind_real);
@@ -1541,30 +1537,30 @@ namespace
 		}
 	}
 
-	void CompileKeyFramesChunk(XMLNodePtr const & key_frames_chunk,
+	void CompileKeyFramesChunk(XMLNodeView const & key_frames_chunk,
 		uint32_t& num_frames, uint32_t& frame_rate,
 		KeyFramesType& kfss)
 	{
-		XMLAttributePtr nf_attr = key_frames_chunk->Attrib("num_frames");
+		XMLAttributeView nf_attr = key_frames_chunk.Attrib("num_frames");
 		if (nf_attr)
 		{
-			num_frames = nf_attr->ValueUInt();
+			num_frames = nf_attr.ValueUInt();
 		}
 		else
 		{
-			int32_t start_frame = key_frames_chunk->Attrib("start_frame")->ValueInt();
-			int32_t end_frame = key_frames_chunk->Attrib("end_frame")->ValueInt();
+			int32_t start_frame = key_frames_chunk.Attrib("start_frame").ValueInt();
+			int32_t end_frame = key_frames_chunk.Attrib("end_frame").ValueInt();
 			num_frames = end_frame - start_frame;
 		}
-		frame_rate = key_frames_chunk->Attrib("frame_rate")->ValueUInt();
+		frame_rate = key_frames_chunk.Attrib("frame_rate").ValueUInt();
 
 		uint32_t joint_id = 0;
-		for (XMLNodePtr kf_node = key_frames_chunk->FirstNode("key_frame"); kf_node; kf_node = kf_node->NextSibling("key_frame"))
+		for (XMLNodeView kf_node = key_frames_chunk.FirstNode("key_frame"); kf_node; kf_node = kf_node.NextSibling("key_frame"))
 		{
-			XMLAttributePtr joint_attr = kf_node->Attrib("joint");
+			XMLAttributeView joint_attr = kf_node.Attrib("joint");
 			if (joint_attr)
 			{
-				joint_id = joint_attr->ValueUInt();
+				joint_id = joint_attr.ValueUInt();
 			}
 			else
 			{
@@ -1578,12 +1574,12 @@ namespace
 			kfs.bind_scale.clear();
 
 			int32_t frame_id = -1;
-			for (XMLNodePtr key_node = kf_node->FirstNode("key"); key_node; key_node = key_node->NextSibling("key"))
+			for (XMLNodeView key_node = kf_node.FirstNode("key"); key_node; key_node = key_node.NextSibling("key"))
 			{
-				XMLAttributePtr id_attr = key_node->Attrib("id");
+				XMLAttributeView id_attr = key_node.Attrib("id");
 				if (id_attr)
 				{
-					frame_id = id_attr->ValueInt();
+					frame_id = id_attr.ValueInt();
 				}
 				else
 				{
@@ -1593,15 +1589,15 @@ namespace
 
 				Quaternion bind_real, bind_dual;
 				float bind_scale;
-				XMLNodePtr pos_node = key_node->FirstNode("pos");
+				XMLNodeView pos_node = key_node.FirstNode("pos");
 				if (pos_node)
 				{
-					float3 bind_pos(pos_node->Attrib("x")->ValueFloat(), pos_node->Attrib("y")->ValueFloat(),
-						pos_node->Attrib("z")->ValueFloat());
+					float3 bind_pos(pos_node.Attrib("x").ValueFloat(), pos_node.Attrib("y").ValueFloat(),
+						pos_node.Attrib("z").ValueFloat());
 
-					XMLNodePtr quat_node = key_node->FirstNode("quat");
-					bind_real = Quaternion(quat_node->Attrib("x")->ValueFloat(), quat_node->Attrib("y")->ValueFloat(),
-						quat_node->Attrib("z")->ValueFloat(), quat_node->Attrib("w")->ValueFloat());
+					XMLNodeView quat_node = key_node.FirstNode("quat");
+					bind_real = Quaternion(quat_node.Attrib("x").ValueFloat(), quat_node.Attrib("y").ValueFloat(),
+						quat_node.Attrib("z").ValueFloat(), quat_node.Attrib("w").ValueFloat());
 
 					bind_scale = MathLib::length(bind_real);
 					bind_real /= bind_scale;
@@ -1610,40 +1606,40 @@ namespace
 				}
 				else
 				{
-					XMLNodePtr bind_real_node = key_node->FirstNode("real");
+					XMLNodeView bind_real_node = key_node.FirstNode("real");
 					if (!bind_real_node)
 					{
-						bind_real_node = key_node->FirstNode("bind_real");
+						bind_real_node = key_node.FirstNode("bind_real");
 					}
-					XMLAttributePtr attr = bind_real_node->Attrib("v");
+					XMLAttributeView attr = bind_real_node.Attrib("v");
 					if (attr)
 					{
-						ExtractFVector<4>(attr->ValueString(), &bind_real[0]);
+						ExtractFVector<4>(attr, &bind_real[0]);
 					}
 					else
 					{
-						bind_real.x() = bind_real_node->Attrib("x")->ValueFloat();
-						bind_real.y() = bind_real_node->Attrib("y")->ValueFloat();
-						bind_real.z() = bind_real_node->Attrib("z")->ValueFloat();
-						bind_real.w() = bind_real_node->Attrib("w")->ValueFloat();
+						bind_real.x() = bind_real_node.Attrib("x").ValueFloat();
+						bind_real.y() = bind_real_node.Attrib("y").ValueFloat();
+						bind_real.z() = bind_real_node.Attrib("z").ValueFloat();
+						bind_real.w() = bind_real_node.Attrib("w").ValueFloat();
 					}
 							
-					XMLNodePtr bind_dual_node = key_node->FirstNode("dual");
+					XMLNodeView bind_dual_node = key_node.FirstNode("dual");
 					if (!bind_dual_node)
 					{
-						bind_dual_node = key_node->FirstNode("bind_dual");
+						bind_dual_node = key_node.FirstNode("bind_dual");
 					}
-					attr = bind_dual_node->Attrib("v");
+					attr = bind_dual_node.Attrib("v");
 					if (attr)
 					{
-						ExtractFVector<4>(attr->ValueString(), &bind_dual[0]);
+						ExtractFVector<4>(attr, &bind_dual[0]);
 					}
 					else
 					{
-						bind_dual.x() = bind_dual_node->Attrib("x")->ValueFloat();
-						bind_dual.y() = bind_dual_node->Attrib("y")->ValueFloat();
-						bind_dual.z() = bind_dual_node->Attrib("z")->ValueFloat();
-						bind_dual.w() = bind_dual_node->Attrib("w")->ValueFloat();
+						bind_dual.x() = bind_dual_node.Attrib("x").ValueFloat();
+						bind_dual.y() = bind_dual_node.Attrib("y").ValueFloat();
+						bind_dual.z() = bind_dual_node.Attrib("z").ValueFloat();
+						bind_dual.w() = bind_dual_node.Attrib("w").ValueFloat();
 					}
 
 					bind_scale = MathLib::length(bind_real);
@@ -1664,25 +1660,25 @@ namespace
 		}
 	}
 
-	void CompileBBKeyFramesChunk(XMLNodePtr const & bb_kfs_chunk,
+	void CompileBBKeyFramesChunk(XMLNodeView const & bb_kfs_chunk,
 		std::vector<AABBox> const & pos_bbs, uint32_t num_frames,
 		std::vector<AABBKeyFrames>& bb_kfss)
 	{
 		AABBKeyFrames bb_kfs;
 		if (bb_kfs_chunk)
 		{
-			for (XMLNodePtr bb_kf_node = bb_kfs_chunk->FirstNode("bb_key_frame"); bb_kf_node; bb_kf_node = bb_kf_node->NextSibling("bb_key_frame"))
+			for (XMLNodeView bb_kf_node = bb_kfs_chunk.FirstNode("bb_key_frame"); bb_kf_node; bb_kf_node = bb_kf_node.NextSibling("bb_key_frame"))
 			{
 				bb_kfs.frame_id.clear();
 				bb_kfs.bb.clear();
 
 				int32_t frame_id = -1;
-				for (XMLNodePtr key_node = bb_kf_node->FirstNode("key"); key_node; key_node = key_node->NextSibling("key"))
+				for (XMLNodeView key_node = bb_kf_node.FirstNode("key"); key_node; key_node = key_node.NextSibling("key"))
 				{
-					XMLAttributePtr id_attr = key_node->Attrib("id");
+					XMLAttributeView id_attr = key_node.Attrib("id");
 					if (id_attr)
 					{
-						frame_id = id_attr->ValueInt();
+						frame_id = id_attr.ValueInt();
 					}
 					else
 					{
@@ -1691,29 +1687,29 @@ namespace
 					bb_kfs.frame_id.push_back(frame_id);
 
 					float3 bb_min, bb_max;
-					XMLAttributePtr attr = key_node->Attrib("min");
+					XMLAttributeView attr = key_node.Attrib("min");
 					if (attr)
 					{
-						ExtractFVector<3>(attr->ValueString(), &bb_min[0]);
+						ExtractFVector<3>(attr, &bb_min[0]);
 					}
 					else
 					{
-						XMLNodePtr min_node = key_node->FirstNode("min");
-						bb_min.x() = min_node->Attrib("x")->ValueFloat();
-						bb_min.y() = min_node->Attrib("y")->ValueFloat();
-						bb_min.z() = min_node->Attrib("z")->ValueFloat();
+						XMLNodeView min_node = key_node.FirstNode("min");
+						bb_min.x() = min_node.Attrib("x").ValueFloat();
+						bb_min.y() = min_node.Attrib("y").ValueFloat();
+						bb_min.z() = min_node.Attrib("z").ValueFloat();
 					}
-					attr = key_node->Attrib("max");
+					attr = key_node.Attrib("max");
 					if (attr)
 					{
-						ExtractFVector<3>(attr->ValueString(), &bb_max[0]);
+						ExtractFVector<3>(attr, &bb_max[0]);
 					}
 					else
 					{
-						XMLNodePtr max_node = key_node->FirstNode("max");
-						bb_max.x() = max_node->Attrib("x")->ValueFloat();
-						bb_max.y() = max_node->Attrib("y")->ValueFloat();
-						bb_max.z() = max_node->Attrib("z")->ValueFloat();
+						XMLNodeView max_node = key_node.FirstNode("max");
+						bb_max.x() = max_node.Attrib("x").ValueFloat();
+						bb_max.y() = max_node.Attrib("y").ValueFloat();
+						bb_max.z() = max_node.Attrib("z").ValueFloat();
 					}
 
 					bb_kfs.bb.push_back(AABBox(bb_min, bb_max));
@@ -1740,25 +1736,25 @@ namespace
 		}
 	}
 
-	void CompileActionsChunk(XMLNodePtr const & actions_chunk,
+	void CompileActionsChunk(XMLNodeView const & actions_chunk,
 		uint32_t num_frames,
 		std::vector<AnimationAction>& actions)
 	{
-		XMLNodePtr action_node;
+		XMLNodeView action_node;
 		if (actions_chunk)
 		{
-			action_node = actions_chunk->FirstNode("action");
+			action_node = actions_chunk.FirstNode("action");
 		}
 
 		AnimationAction action;
 		if (action_node)
 		{
-			for (; action_node; action_node = action_node->NextSibling("action"))
+			for (; action_node; action_node = action_node.NextSibling("action"))
 			{
-				action.name = action_node->Attrib("name")->ValueString();
+				action.name = std::string(action_node.Attrib("name").ValueString());
 
-				action.start_frame = action_node->Attrib("start")->ValueUInt();
-				action.end_frame = action_node->Attrib("end")->ValueUInt();
+				action.start_frame = action_node.Attrib("start").ValueUInt();
+				action.end_frame = action_node.Attrib("end").ValueUInt();
 
 				actions.push_back(action);
 			}
@@ -1773,6 +1769,98 @@ namespace
 		}
 	}
 
+	// Drops the keys that blending their neighbors, the same way SkinnedModel does, reproduces within the tolerances.
+	//  Keys on action boundaries are kept, so every action starts and ends on exact keys.
+	void ReduceKeyFrames(KeyFrames& kf, std::vector<uint32_t> const & fixed_frames)
+	{
+		size_t const num_keys = kf.frame_id.size();
+		if (num_keys <= 2)
+		{
+			return;
+		}
+
+		std::vector<float3> trans(num_keys);
+		float max_trans = 0;
+		for (size_t k = 0; k < num_keys; ++ k)
+		{
+			trans[k] = MathLib::udq_to_trans(kf.bind_real[k], kf.bind_dual[k]);
+			max_trans = std::max(max_trans, MathLib::length(trans[k]));
+		}
+		float const trans_tolerance = KEY_TRANSLATION_TOLERANCE * max_trans + 1e-6f;
+
+		auto fits = [&kf, &trans, trans_tolerance](size_t k0, size_t k1)
+		{
+			Quaternion const & real0 = kf.bind_real[k0];
+			Quaternion const & real1 = kf.bind_real[k1];
+			float const sign = (MathLib::dot(real0, real1) < 0) ? -1.0f : 1.0f;
+			for (size_t j = k0 + 1; j < k1; ++ j)
+			{
+				float const factor = static_cast<float>(kf.frame_id[j] - kf.frame_id[k0]) / (kf.frame_id[k1] - kf.frame_id[k0]);
+
+				Quaternion real = real0 * (1 - factor) + real1 * (sign * factor);
+				Quaternion dual = kf.bind_dual[k0] * (1 - factor) + kf.bind_dual[k1] * (sign * factor);
+				float const inv_len = 1 / MathLib::length(real);
+				real *= inv_len;
+				dual *= inv_len;
+
+				float const cos_half_angle = std::min(MathLib::abs(MathLib::dot(real, kf.bind_real[j])), 1.0f);
+				if (2 * std::acos(cos_half_angle) > KEY_ROTATION_TOLERANCE)
+				{
+					return false;
+				}
+				if (MathLib::length(MathLib::udq_to_trans(real, dual) - trans[j]) > trans_tolerance)
+				{
+					return false;
+				}
+				float const scale = MathLib::lerp(kf.bind_scale[k0], kf.bind_scale[k1], factor);
+				if (MathLib::abs(scale - kf.bind_scale[j]) > KEY_SCALE_TOLERANCE * MathLib::abs(kf.bind_scale[j]))
+				{
+					return false;
+				}
+			}
+			return true;
+		};
+
+		std::vector<char> keep(num_keys, false);
+		keep.front() = true;
+		keep.back() = true;
+		for (size_t k = 0; k < num_keys; ++ k)
+		{
+			if (std::binary_search(fixed_frames.begin(), fixed_frames.end(), kf.frame_id[k]))
+			{
+				keep[k] = true;
+			}
+		}
+
+		// Greedily extends the span from the last kept key, until the key before k can't be dropped
+		size_t anchor = 0;
+		for (size_t k = 2; k < num_keys; ++ k)
+		{
+			if (keep[k - 1] || !fits(anchor, k))
+			{
+				keep[k - 1] = true;
+				anchor = k - 1;
+			}
+		}
+
+		size_t num_kept = 0;
+		for (size_t k = 0; k < num_keys; ++ k)
+		{
+			if (keep[k])
+			{
+				kf.frame_id[num_kept] = kf.frame_id[k];
+				kf.bind_real[num_kept] = kf.bind_real[k];
+				kf.bind_dual[num_kept] = kf.bind_dual[k];
+				kf.bind_scale[num_kept] = kf.bind_scale[k];
+				++ num_kept;
+			}
+		}
+		kf.frame_id.resize(num_kept);
+		kf.bind_real.resize(num_kept);
+		kf.bind_dual.resize(num_kept);
+		kf.bind_scale.resize(num_kept);
+	}
+
 	void ConvertTextures(std::string const & output_name, std::vector<OfflineRenderMaterial>& mtls, std::string const & platform)
 	{
 		std::map<filesystem::path, std::vector<std::pair<size_t, size_t>>> all_texture_slots;
@@ -1918,11 +2006,12 @@ namespace
 	{
 		ResIdentifierPtr file = ResLoader::Instance().Open(meshml_name);
 		KlayGE::XMLDocument doc;
-		XMLNodePtr root = doc.Parse(file);
+		doc.Parse(file);
+		XMLNodeView const root = doc.RootView();
 
-		BOOST_ASSERT(root->Attrib("version") && (root->Attrib("version")->ValueInt() >= 1));
+		BOOST_ASSERT(root.Attrib("version") && (root.Attrib("version").ValueInt() >= 1));
 
-		XMLNodePtr materials_chunk = root->FirstNode("materials_chunk");
+		XMLNodeView materials_chunk = root.FirstNode("materials_chunk");
 		std::vector<OfflineRenderMaterial> mtls;
 		if (materials_chunk)
 		{
@@ -1968,7 +2057,7 @@ namespace
 			}
 		}
 
-		XMLNodePtr meshes_chunk = root->FirstNode("meshes_chunk");
+		XMLNodeView meshes_chunk = root.FirstNode("meshes_chunk");
 		std::vector<std::string> mesh_names;
 		std::vector<int32_t> mtl_ids;
 		std::vector<uint32_t> mesh_lods;
@@ -1991,14 +2080,14 @@ namespace
 				is_index_16_bit);
 		}
 
-		XMLNodePtr bones_chunk = root->FirstNode("bones_chunk");
+		XMLNodeView bones_chunk = root.FirstNode("bones_chunk");
 		std::vector<Joint> joints;
 		if (bones_chunk)
 		{
 			CompileBonesChunk(bones_chunk, joints);
 		}
 
-		XMLNodePtr key_frames_chunk = root->FirstNode("key_frames_chunk");
+		XMLNodeView key_frames_chunk = root.FirstNode("key_frames_chunk");
 		uint32_t num_frames = 0;
 		uint32_t frame_rate = 0;
 		std::shared_ptr<std::vector<KeyFrames>> kfs;
@@ -2038,11 +2127,11 @@ namespace
 				}
 			}
 
-			XMLNodePtr bb_kfs_chunk = root->FirstNode("bb_key_frames_chunk");
+			XMLNodeView bb_kfs_chunk = root.FirstNode("bb_key_frames_chunk");
 			CompileBBKeyFramesChunk(bb_kfs_chunk, pos_bbs, num_frames, bb_kfs);
 		}
 
-		XMLNodePtr actions_chunk = root->FirstNode("actions_chunk");
+		XMLNodeView actions_chunk = root.FirstNode("actions_chunk");
 		std::shared_ptr<std::vector<AnimationAction>> actions;
 		if (actions_chunk)
 		{
@@ -2050,6 +2139,25 @@ namespace
 			CompileActionsChunk(actions_chunk, num_frames, *actions);
 		}
 
+		if (kfs)
+		{
+			std::vector<uint32_t> action_frames;
+			if (actions)
+			{
+				for (auto const & action : *actions)
+				{
+					action_frames.push_back(action.start_frame);
+					action_frames.push_back(action.end_frame);
+				}
+				std::sort(action_frames.begin(), action_frames.end());
+			}
+
+			for (auto& kf : *kfs)
+			{
+				ReduceKeyFrames(kf, action_frames);
+			}
+		}
+
 		std::vector<RenderMaterialPtr> output_mtls(mtls.size());
 		for (size_t i = 0; i < mtls.size(); ++ i)
 		{
@@ -183,7 +183,8 @@ namespace
 
 		void SetFrame(float frame)
 		{
-			checked_pointer_cast<DetailedSkinnedModel>(renderable_)->SetFrame(frame);
+			Context::Instance().SceneManagerInstance().PoseSkinnedModel(
+				checked_pointer_cast<DetailedSkinnedModel>(renderable_), frame);
 		}
 
 		void VisualizeLighting()
@@ -0,0 +1,231 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Util.hpp>
+
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#include "CookCache.hpp"
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	uint64_t RotateLeft(uint64_t v, int n)
+	{
+		return (v << n) | (v >> (64 - n));
+	}
+
+	uint64_t Read64(uint8_t const * p)
+	{
+		uint64_t v;
+		std::memcpy(&v, p, sizeof(v));
+		return LE2Native(v);
+	}
+
+	uint32_t Read32(uint8_t const * p)
+	{
+		uint32_t v;
+		std::memcpy(&v, p, sizeof(v));
+		return LE2Native(v);
+	}
+}
+
+uint64_t HashBytes(uint8_t const * data, size_t size, uint64_t seed)
+{
+	uint64_t const PRIME1 = 0x9E3779B185EBCA87ULL;
+	uint64_t const PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+	uint64_t const PRIME3 = 0x165667B19E3779F9ULL;
+	uint64_t const PRIME4 = 0x85EBCA77C2B2AE63ULL;
+	uint64_t const PRIME5 = 0x27D4EB2F165667C5ULL;
+
+	auto round = [PRIME1, PRIME2](uint64_t acc, uint64_t input)
+	{
+		return RotateLeft(acc + input * PRIME2, 31) * PRIME1;
+	};
+	auto merge_round = [PRIME1, PRIME4, &round](uint64_t acc, uint64_t val)
+	{
+		return (acc ^ round(0, val)) * PRIME1 + PRIME4;
+	};
+
+	uint8_t const * p = data;
+	uint8_t const * const end = data + size;
+
+	uint64_t h;
+	if (size >= 32)
+	{
+		uint64_t v1 = seed + PRIME1 + PRIME2;
+		uint64_t v2 = seed + PRIME2;
+		uint64_t v3 = seed;
+		uint64_t v4 = seed - PRIME1;
+		for (; p + 32 <= end; p += 32)
+		{
+			v1 = round(v1, Read64(p + 0));
+			v2 = round(v2, Read64(p + 8));
+			v3 = round(v3, Read64(p + 16));
+			v4 = round(v4, Read64(p + 24));
+		}
+
+		h = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) + RotateLeft(v4, 18);
+		h = merge_round(h, v1);
+		h = merge_round(h, v2);
+		h = merge_round(h, v3);
+		h = merge_round(h, v4);
+	}
+	else
+	{
+		h = seed + PRIME5;
+	}
+
+	h += size;
+	for (; p + 8 <= end; p += 8)
+	{
+		h = RotateLeft(h ^ round(0, Read64(p)), 27) * PRIME1 + PRIME4;
+	}
+	if (p + 4 <= end)
+	{
+		h = RotateLeft(h ^ (Read32(p) * PRIME1), 23) * PRIME2 + PRIME3;
+		p += 4;
+	}
+	for (; p < end; ++ p)
+	{
+		h = RotateLeft(h ^ (*p * PRIME5), 11) * PRIME1;
+	}
+
+	h ^= h >> 33;
+	h *= PRIME2;
+	h ^= h >> 29;
+	h *= PRIME3;
+	h ^= h >> 32;
+	return h;
+}
+
+std::string HashToString(uint64_t hash)
+{
+	std::ostringstream ss;
+	ss << std::hex << std::setw(sizeof(hash) * 2) << std::setfill('0') << hash;
+	return ss.str();
+}
+
+bool ReadFileBytes(std::string const & name, std::vector<uint8_t>& bytes)
+{
+	std::ifstream ifs(name.c_str(), std::ios_base::binary);
+	if (!ifs)
+	{
+		return false;
+	}
+
+	ifs.seekg(0, std::ios_base::end);
+	bytes.resize(static_cast<size_t>(ifs.tellg()));
+	ifs.seekg(0, std::ios_base::beg);
+	if (!bytes.empty())
+	{
+		ifs.read(reinterpret_cast<char*>(&bytes[0]), bytes.size());
+	}
+	return !ifs.fail();
+}
+
+bool WriteFileBytes(std::string const & name, std::vector<uint8_t> const & bytes)
+{
+	std::ofstream ofs(name.c_str(), std::ios_base::binary);
+	if (!ofs)
+	{
+		return false;
+	}
+
+	if (!bytes.empty())
+	{
+		ofs.write(reinterpret_cast<char const *>(&bytes[0]), bytes.size());
+	}
+	return !ofs.fail();
+}
+
+char const * const CookCache::MANIFEST_VERSION = "KlayGE_CookCache_2";
+
+CookCache::CookCache(std::string const & dir)
+	: dir_(dir)
+{
+	std::filesystem::create_directories(dir_);
+
+	std::string const manifest_name = (dir_ / "manifest.txt").string();
+	{
+		std::ifstream ifs(manifest_name.c_str());
+		std::string version;
+		if ((ifs >> version) && (MANIFEST_VERSION == version))
+		{
+			uint64_t key;
+			ManifestEntry entry;
+			while (ifs >> std::hex >> key >> entry.input_hash >> entry.output_hash)
+			{
+				manifest_[key] = entry;
+			}
+		}
+	}
+
+	// Rewritten compacted, later entries of the same key replaced the earlier ones on load
+	manifest_file_.open(manifest_name.c_str(), std::ios_base::out | std::ios_base::trunc);
+	manifest_file_ << MANIFEST_VERSION << '\n';
+	for (auto const & entry : manifest_)
+	{
+		this->WriteManifestEntry(entry.first, entry.second);
+	}
+	manifest_file_.flush();
+}
+
+bool CookCache::Lookup(uint64_t key, std::vector<uint8_t> const & input, uint64_t& output_hash)
+{
+	ManifestEntry entry;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		auto iter = manifest_.find(key);
+		if (iter == manifest_.end())
+		{
+			return false;
+		}
+		entry = iter->second;
+	}
+
+	std::vector<uint8_t> stored_input;
+	if (ReadFileBytes(this->BlobName(entry.input_hash), stored_input) && (stored_input == input))
+	{
+		output_hash = entry.output_hash;
+		return true;
+	}
+	return false;
+}
+
+bool CookCache::Fetch(uint64_t output_hash, std::vector<uint8_t>& output)
+{
+	return ReadFileBytes(this->BlobName(output_hash), output) && (HashBytes(output.data(), output.size()) == output_hash);
+}
+
+void CookCache::Store(uint64_t key, uint64_t input_hash, std::vector<uint8_t> const & input,
+	uint64_t identity_key, uint64_t output_hash, std::vector<uint8_t> const & output)
+{
+	if (WriteFileBytes(this->BlobName(input_hash), input) && WriteFileBytes(this->BlobName(output_hash), output))
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		ManifestEntry const entry = { input_hash, output_hash };
+		ManifestEntry const identity_entry = { output_hash, output_hash };
+		manifest_[key] = entry;
+		manifest_[identity_key] = identity_entry;
+
+		this->WriteManifestEntry(key, entry);
+		this->WriteManifestEntry(identity_key, identity_entry);
+		manifest_file_.flush();
+	}
+}
+
+std::string CookCache::BlobName(uint64_t hash) const
+{
+	return (dir_ / (HashToString(hash) + ".bin")).string();
+}
+
+void CookCache::WriteManifestEntry(uint64_t key, ManifestEntry const & entry)
+{
+	manifest_file_ << HashToString(key) << ' ' << HashToString(entry.input_hash) << ' '
+		<< HashToString(entry.output_hash) << '\n';
+}
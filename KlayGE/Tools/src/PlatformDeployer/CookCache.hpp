@@ -0,0 +1,59 @@
+#ifndef _COOK_CACHE_HPP
+#define _COOK_CACHE_HPP
+
+#pragma once
+
+#include <KFL/CXX17/filesystem.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// xxHash64 of a block of bytes. The cache is keyed by content, so it needs a real 64-bit hash that is the same on every
+//  platform and every run, which HashCombine isn't.
+uint64_t HashBytes(uint8_t const * data, size_t size, uint64_t seed = 0);
+std::string HashToString(uint64_t hash);
+
+bool ReadFileBytes(std::string const & name, std::vector<uint8_t>& bytes);
+bool WriteFileBytes(std::string const & name, std::vector<uint8_t> const & bytes);
+
+// Cooked textures, keyed by the xxHash64 of the input content seeded with the hash of the cooking configuration (tool
+//  version, platform caps, resource type and steps). Inputs and cooked outputs are kept as blobs named by their own hash.
+//  A manifest entry maps a key to the input and output blobs, and a hit only counts when the stored input has exactly
+//  the same bytes, so a hash collision can't hand out the wrong texture. Cooked outputs are also recorded as mapping to
+//  themselves, so deploying a resource that is already cooked is a no-op. The manifest is appended to after every store,
+//  so an interrupted run keeps what it has cooked.
+class CookCache
+{
+public:
+	explicit CookCache(std::string const & dir);
+
+	bool Lookup(uint64_t key, std::vector<uint8_t> const & input, uint64_t& output_hash);
+	bool Fetch(uint64_t output_hash, std::vector<uint8_t>& output);
+	void Store(uint64_t key, uint64_t input_hash, std::vector<uint8_t> const & input,
+		uint64_t identity_key, uint64_t output_hash, std::vector<uint8_t> const & output);
+
+private:
+	struct ManifestEntry
+	{
+		uint64_t input_hash;
+		uint64_t output_hash;
+	};
+
+	std::string BlobName(uint64_t hash) const;
+	void WriteManifestEntry(uint64_t key, ManifestEntry const & entry);
+
+private:
+	static char const * const MANIFEST_VERSION;
+
+	std::filesystem::path dir_;
+
+	std::mutex mutex_;
+	std::map<uint64_t, ManifestEntry> manifest_;
+	std::ofstream manifest_file_;
+};
+
+#endif		// _COOK_CACHE_HPP
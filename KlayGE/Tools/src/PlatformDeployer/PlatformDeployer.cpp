@@ -1,12 +1,22 @@
 #include <KlayGE/KlayGE.hpp>
+#include <KFL/ErrorHandling.hpp>
 #include <KFL/Util.hpp>
+#include <KFL/Math.hpp>
+#include <KFL/Thread.hpp>
+#include <KlayGE/Context.hpp>
+#include <KlayGE/Texture.hpp>
+#include <KlayGE/TexCompression.hpp>
+#include <KlayGE/TexCompressionBC.hpp>
+#include <KlayGE/TexCompressionETC.hpp>
 #include <KlayGE/JudaTexture.hpp>
 #include <KlayGE/ResLoader.hpp>
 #include <KFL/XMLDom.hpp>
 #include <KFL/CXX17/filesystem.hpp>
 
+#include <cstring>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <vector>
 #include <regex>
 
@@ -30,6 +40,8 @@
 #endif
 #include <boost/algorithm/string/trim.hpp>
 
+#include "CookCache.hpp"
+
 using namespace std;
 using namespace KlayGE;
 
@@ -160,159 +172,661 @@ OfflineRenderDeviceCaps LoadPlatformConfig(std::string const & platform)
 	return caps;
 }
 
-void Deploy(std::vector<std::string> const & res_names, std::string const & res_type, OfflineRenderDeviceCaps const & caps)
+// Bump this whenever the cooking code changes its output, so that the cached results are rebuilt
+char const * DEPLOYER_VERSION = "1.1.0";
+
+enum CookStepType
 {
-	std::ofstream ofs("convert.bat");
+	CST_Bump2Normal,
+	CST_ForceSRGB,
+	CST_GenMipmaps,
+	CST_Compress,
+	CST_CompressNormal
+};
 
-	if (("albedo" == res_type)
-		|| ("emissive" == res_type))
+struct CookStep
+{
+	CookStepType type;
+	ElementFormat format;
+	float param;
+};
+
+struct CookTexture
+{
+	Texture::TextureType type;
+	uint32_t width;
+	uint32_t height;
+	uint32_t depth;
+	uint32_t num_mipmaps;
+	uint32_t array_size;
+	ElementFormat format;
+	std::vector<ElementInitData> init_data;
+
+	std::vector<uint8_t> loaded_block;
+	std::vector<std::vector<uint8_t>> data_blocks;
+
+	void Reset(ElementFormat fmt, uint32_t w, uint32_t h, uint32_t mipmaps)
 	{
-		for (size_t i = 0; i < res_names.size(); ++ i)
-		{
-			ofs << "@echo Processing: " << res_names[i] << std::endl;
+		format = fmt;
+		width = w;
+		height = h;
+		num_mipmaps = mipmaps;
+		init_data.assign(array_size * num_mipmaps, ElementInitData());
+	}
 
-			ofs << "@echo off" << std::endl << std::endl;
-			if (caps.srgb_support)
-			{
-				ofs << "ForceTexSRGB \"" << res_names[i] << "\" temp.dds" << std::endl;
-			}
-			else
-			{
-				ofs << "copy \"" << res_names[i] << "\" temp.dds" << std::endl;
-			}
-			ofs << "Mipmapper temp.dds" << std::endl;
-			if (caps.bc7_support)
+	void AllocSubresource(std::vector<std::vector<uint8_t>>& blocks, uint32_t sub_res, uint32_t row_pitch, uint32_t slice_pitch)
+	{
+		ElementInitData& data = init_data[sub_res];
+		data.row_pitch = row_pitch;
+		data.slice_pitch = slice_pitch;
+		blocks[sub_res].assign(slice_pitch, 0);
+		data.data = &blocks[sub_res][0];
+	}
+};
+
+// Produces the same textures as the ForceTexSRGB, Bump2Normal, Mipmapper, TexCompressor and NormalMapCompressor tools,
+//  but on memory. Every step replaces the subresources of the texture.
+void CookBump2Normal(CookTexture& tex, float offset)
+{
+	std::vector<std::vector<uint8_t>> new_blocks(tex.init_data.size());
+	std::vector<ElementInitData> const in_data = tex.init_data;
+	ElementFormat const in_format = tex.format;
+	tex.Reset(EF_ABGR8, tex.width, tex.height, tex.num_mipmaps);
+
+	Context::Instance().TaskScheduler().parallel_for(0, in_data.size(), 1,
+		[&tex, &new_blocks, &in_data, in_format, offset](size_t sub_res_begin, size_t sub_res_end)
+		{
+			std::vector<Color> in_color;
+			for (size_t sub_res = sub_res_begin; sub_res < sub_res_end; ++ sub_res)
 			{
-				ofs << "TexCompressor BC7 temp.dds \"" << res_names[i] << "\"" << std::endl;
+				uint32_t const mip = static_cast<uint32_t>(sub_res % tex.num_mipmaps);
+				uint32_t const width = std::max(tex.width >> mip, 1U);
+				uint32_t const height = std::max(tex.height >> mip, 1U);
+
+				in_color.resize(width * height);
+				uint8_t const * src = static_cast<uint8_t const *>(in_data[sub_res].data);
+				for (uint32_t y = 0; y < height; ++ y)
+				{
+					ConvertToABGR32F(in_format, src + y * in_data[sub_res].row_pitch, width, &in_color[y * width]);
+				}
+
+				tex.AllocSubresource(new_blocks, static_cast<uint32_t>(sub_res), width * 4, width * height * 4);
+				uint8_t* normals = &new_blocks[sub_res][0];
+				for (uint32_t i = 0; i < width * height; ++ i)
+				{
+					float3 n;
+					n.x() = (in_color[i].r() * 2 - 1) * offset;
+					n.y() = (in_color[i].g() * 2 - 1) * offset;
+					n.z() = 1;
+					n = MathLib::normalize(n);
+
+					normals[i * 4 + 0] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>((n.x() * 0.5f + 0.5f) * 255.0f + 0.5f), 0, 255));
+					normals[i * 4 + 1] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>((n.y() * 0.5f + 0.5f) * 255.0f + 0.5f), 0, 255));
+					normals[i * 4 + 2] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>((n.z() * 0.5f + 0.5f) * 255.0f + 0.5f), 0, 255));
+					normals[i * 4 + 3] = 255;
+				}
 			}
-			else if (caps.bc1_support)
+		});
+
+	tex.data_blocks.swap(new_blocks);
+}
+
+void CookForceSRGB(CookTexture& tex)
+{
+	tex.format = MakeSRGB(tex.format);
+}
+
+void CookGenMipmaps(CookTexture& tex)
+{
+	uint32_t num_full_mip_maps = 1;
+	uint32_t w = tex.width;
+	uint32_t h = tex.height;
+	while ((w != 1) || (h != 1))
+	{
+		++ num_full_mip_maps;
+
+		w = std::max<uint32_t>(1U, w / 2);
+		h = std::max<uint32_t>(1U, h / 2);
+	}
+
+	uint32_t const elem_size = NumFormatBytes(tex.format);
+	uint32_t const in_num_mipmaps = tex.num_mipmaps;
+	std::vector<ElementInitData> const in_data = tex.init_data;
+	std::vector<std::vector<uint8_t>> new_blocks(tex.array_size * num_full_mip_maps);
+	tex.Reset(tex.format, tex.width, tex.height, num_full_mip_maps);
+
+	// Mip chains of different array slices don't depend on each other
+	Context::Instance().TaskScheduler().parallel_for(0, tex.array_size, 1,
+		[&tex, &new_blocks, &in_data, in_num_mipmaps, elem_size](size_t array_begin, size_t array_end)
+		{
+			for (size_t array_index = array_begin; array_index < array_end; ++ array_index)
 			{
-				ofs << "TexCompressor BC1 temp.dds \"" << res_names[i] << "\"" << std::endl;
+				uint32_t const base = static_cast<uint32_t>(array_index * tex.num_mipmaps);
+				uint32_t the_width = tex.width;
+				uint32_t the_height = tex.height;
+
+				tex.AllocSubresource(new_blocks, base, the_width * elem_size, the_width * the_height * elem_size);
+				{
+					ElementInitData const & src_data = in_data[array_index * in_num_mipmaps];
+					ElementInitData const & dst_data = tex.init_data[base];
+
+					uint8_t const * src = static_cast<uint8_t const *>(src_data.data);
+					uint8_t* dst = &new_blocks[base][0];
+					for (uint32_t y = 0; y < the_height; ++ y)
+					{
+						std::memcpy(dst, src, dst_data.row_pitch);
+
+						src += src_data.row_pitch;
+						dst += dst_data.row_pitch;
+					}
+				}
+
+				for (uint32_t mip = 0; mip < tex.num_mipmaps - 1; ++ mip)
+				{
+					uint32_t const new_width = std::max(the_width / 2, 1U);
+					uint32_t const new_height = std::max(the_height / 2, 1U);
+
+					tex.AllocSubresource(new_blocks, base + mip + 1, new_width * elem_size, new_width * new_height * elem_size);
+
+					ElementInitData const & src_data = tex.init_data[base + mip];
+					ElementInitData const & dst_data = tex.init_data[base + mip + 1];
+					ResizeTexture(&new_blocks[base + mip + 1][0], dst_data.row_pitch, dst_data.slice_pitch,
+						tex.format, new_width, new_height, 1,
+						src_data.data, src_data.row_pitch, src_data.slice_pitch,
+						tex.format, the_width, the_height, 1,
+						true);
+
+					the_width = new_width;
+					the_height = new_height;
+				}
 			}
-			else if (caps.etc1_support)
+		});
+
+	tex.data_blocks.swap(new_blocks);
+	tex.loaded_block.clear();
+}
+
+TexCompressionPtr MakeTexCodec(ElementFormat fmt)
+{
+	switch (fmt)
+	{
+	case EF_BC1:
+	case EF_BC1_SRGB:
+	case EF_SIGNED_BC1:
+		return MakeSharedPtr<TexCompressionBC1>();
+
+	case EF_BC3:
+	case EF_BC3_SRGB:
+	case EF_SIGNED_BC3:
+		return MakeSharedPtr<TexCompressionBC3>();
+
+	case EF_BC4:
+	case EF_BC4_SRGB:
+	case EF_SIGNED_BC4:
+		return MakeSharedPtr<TexCompressionBC4>();
+
+	case EF_BC5:
+	case EF_BC5_SRGB:
+	case EF_SIGNED_BC5:
+		return MakeSharedPtr<TexCompressionBC5>();
+
+	case EF_BC7:
+	case EF_BC7_SRGB:
+		return MakeSharedPtr<TexCompressionBC7>();
+
+	case EF_ETC1:
+		return MakeSharedPtr<TexCompressionETC1>();
+
+	default:
+		KFL_UNREACHABLE("Invalid compression format");
+	}
+}
+
+void CookCompress(CookTexture& tex, ElementFormat fmt)
+{
+	if (IsSigned(tex.format))
+	{
+		fmt = MakeSigned(fmt);
+	}
+	if (IsSRGB(tex.format))
+	{
+		fmt = MakeSRGB(fmt);
+	}
+
+	TexCompressionPtr codec = MakeTexCodec(fmt);
+	uint32_t const block_w = codec->BlockWidth();
+	uint32_t const block_h = codec->BlockHeight();
+	ElementFormat const in_format = MakeNonSRGB(tex.format);
+	ElementFormat const decoded_format = codec->DecodedFormat();
+	uint32_t const decoded_elem_size = NumFormatBytes(decoded_format);
+
+	uint32_t const in_width = tex.width;
+	uint32_t const in_height = tex.height;
+	uint32_t const out_width = (in_width + block_w - 1) & ~(block_w - 1);
+	uint32_t const out_height = (in_height + block_h - 1) & ~(block_h - 1);
+
+	std::vector<ElementInitData> const in_data = tex.init_data;
+	std::vector<std::vector<uint8_t>> new_blocks(in_data.size());
+	tex.Reset(fmt, out_width, out_height, tex.num_mipmaps);
+
+	std::vector<uint8_t> decoded;
+	std::vector<Color> decoded_f32;
+	for (uint32_t sub_res = 0; sub_res < in_data.size(); ++ sub_res)
+	{
+		uint32_t const mip = sub_res % tex.num_mipmaps;
+		uint32_t const src_width = std::max(in_width >> mip, 1U);
+		uint32_t const src_height = std::max(in_height >> mip, 1U);
+		uint32_t const dst_width = std::max(out_width >> mip, 1U);
+		uint32_t const dst_height = std::max(out_height >> mip, 1U);
+
+		uint32_t const row_pitch = (dst_width + block_w - 1) / block_w * codec->BlockBytes();
+		tex.AllocSubresource(new_blocks, sub_res, row_pitch, row_pitch * ((dst_height + block_h - 1) / block_h));
+
+		void const * src = in_data[sub_res].data;
+		uint32_t src_row_pitch = in_data[sub_res].row_pitch;
+		if (in_format != decoded_format)
+		{
+			decoded.resize(src_width * src_height * decoded_elem_size);
+			decoded_f32.resize(src_width);
+			for (uint32_t y = 0; y < src_height; ++ y)
 			{
-				ofs << "TexCompressor ETC1 temp.dds \"" << res_names[i] << "\"" << std::endl;
+				ConvertToABGR32F(in_format, static_cast<uint8_t const *>(src) + y * src_row_pitch, src_width, &decoded_f32[0]);
+				ConvertFromABGR32F(decoded_format, &decoded_f32[0], src_width, &decoded[y * src_width * decoded_elem_size]);
 			}
-			else
+
+			src = &decoded[0];
+			src_row_pitch = src_width * decoded_elem_size;
+		}
+
+		// EncodeMem spreads the block rows over the task scheduler
+		codec->EncodeMem(src_width, src_height, &new_blocks[sub_res][0], row_pitch, tex.init_data[sub_res].slice_pitch,
+			src, src_row_pitch, src_row_pitch * src_height, TCM_Quality);
+	}
+
+	tex.data_blocks.swap(new_blocks);
+	tex.loaded_block.clear();
+}
+
+void CookCompressNormal(CookTexture& tex, ElementFormat fmt)
+{
+	BOOST_ASSERT((EF_BC5 == fmt) || (EF_BC3 == fmt));
+
+	uint32_t const in_width = tex.width;
+	uint32_t const in_height = tex.height;
+	uint32_t const out_width = (in_width + 3) & ~3;
+	uint32_t const out_height = (in_height + 3) & ~3;
+	ElementFormat const in_format = tex.format;
+
+	std::vector<ElementInitData> const in_data = tex.init_data;
+	std::vector<std::vector<uint8_t>> new_blocks(in_data.size());
+	tex.Reset(fmt, out_width, out_height, tex.num_mipmaps);
+
+	std::vector<Color> in_color;
+	for (uint32_t sub_res = 0; sub_res < in_data.size(); ++ sub_res)
+	{
+		uint32_t const mip = sub_res % tex.num_mipmaps;
+		uint32_t const src_width = std::max(in_width >> mip, 1U);
+		uint32_t const src_height = std::max(in_height >> mip, 1U);
+		uint32_t const width = std::max(out_width >> mip, 1U);
+		uint32_t const height = std::max(out_height >> mip, 1U);
+
+		in_color.resize(width * height);
+		ResizeTexture(&in_color[0], width * sizeof(Color), width * height * sizeof(Color),
+			EF_ABGR32F, width, height, 1,
+			in_data[sub_res].data, in_data[sub_res].row_pitch, in_data[sub_res].slice_pitch,
+			in_format, src_width, src_height, 1,
+			true);
+
+		uint32_t const blocks_x = (width + 3) / 4;
+		uint32_t const blocks_y = (height + 3) / 4;
+		uint32_t const row_pitch = blocks_x * 16;
+		tex.AllocSubresource(new_blocks, sub_res, row_pitch, row_pitch * blocks_y);
+		uint8_t* com_normals = &new_blocks[sub_res][0];
+
+		Context::Instance().TaskScheduler().parallel_for(0, blocks_y, 0,
+			[&in_color, com_normals, width, height, blocks_x, row_pitch, fmt](size_t row_begin, size_t row_end)
 			{
-				ofs << "copy temp.dds \"" << res_names[i] << "\"" << std::endl;
-			}
-			ofs << "del temp.dds" << std::endl;
-			ofs << "@echo on" << std::endl << std::endl;
+				TexCompressionBC4 bc4_codec;
+				for (size_t by = row_begin; by < row_end; ++ by)
+				{
+					uint32_t const y_base = static_cast<uint32_t>(by * 4);
+					for (uint32_t bx = 0; bx < blocks_x; ++ bx)
+					{
+						uint32_t const x_base = bx * 4;
+
+						uint8_t uncom_x[16];
+						uint8_t uncom_y[16];
+						for (uint32_t dy = 0; dy < 4; ++ dy)
+						{
+							uint32_t const y = std::min(y_base + dy, height - 1);
+							for (uint32_t dx = 0; dx < 4; ++ dx)
+							{
+								uint32_t const x = std::min(x_base + dx, width - 1);
+
+								float3 n;
+								n.x() = in_color[y * width + x].r() * 2 - 1;
+								n.y() = in_color[y * width + x].g() * 2 - 1;
+								n.z() = in_color[y * width + x].b() * 2 - 1;
+								n = MathLib::normalize(n);
+
+								uncom_x[dy * 4 + dx] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>((n.x() * 0.5f + 0.5f) * 255.0f + 0.5f), 0, 255));
+								uncom_y[dy * 4 + dx] = static_cast<uint8_t>(MathLib::clamp(static_cast<int>((n.y() * 0.5f + 0.5f) * 255.0f + 0.5f), 0, 255));
+							}
+						}
+
+						BC4Block x_bc4;
+						bc4_codec.EncodeBlock(&x_bc4, uncom_x, TCM_Quality);
+						BC4Block y_bc4;
+						bc4_codec.EncodeBlock(&y_bc4, uncom_y, TCM_Quality);
+
+						uint8_t* dst = com_normals + by * row_pitch + bx * 16;
+						if (EF_BC5 == fmt)
+						{
+							BC5Block com_bc5;
+							com_bc5.red = x_bc4;
+							com_bc5.green = y_bc4;
+							std::memcpy(dst, &com_bc5, sizeof(com_bc5));
+						}
+						else
+						{
+							BC3Block com_bc3;
+							com_bc3.alpha = x_bc4;
+							BC4ToBC1G(com_bc3.bc1, y_bc4);
+							std::memcpy(dst, &com_bc3, sizeof(com_bc3));
+						}
+					}
+				}
+			});
+	}
+
+	tex.data_blocks.swap(new_blocks);
+	tex.loaded_block.clear();
+}
+
+// The steps mirror what the old convert.bat ran for each resource type. Returns false for types that are not textures.
+bool BuildTexturePipeline(std::string const & res_type, OfflineRenderDeviceCaps const & caps, std::vector<CookStep>& steps)
+{
+	steps.clear();
+
+	if (("albedo" == res_type)
+		|| ("emissive" == res_type))
+	{
+		if (caps.srgb_support)
+		{
+			steps.push_back({ CST_ForceSRGB, EF_Unknown, 0 });
+		}
+		steps.push_back({ CST_GenMipmaps, EF_Unknown, 0 });
+		if (caps.bc7_support)
+		{
+			steps.push_back({ CST_Compress, EF_BC7, 0 });
+		}
+		else if (caps.bc1_support)
+		{
+			steps.push_back({ CST_Compress, EF_BC1, 0 });
+		}
+		else if (caps.etc1_support)
+		{
+			steps.push_back({ CST_Compress, EF_ETC1, 0 });
 		}
 	}
 	else if (("glossiness" == res_type)
 		|| ("metalness" == res_type))
 	{
-		for (size_t i = 0; i < res_names.size(); ++ i)
+		steps.push_back({ CST_GenMipmaps, EF_Unknown, 0 });
+		if (caps.bc7_support)
 		{
-			ofs << "@echo Processing: " << res_names[i] << std::endl;
-
-			ofs << "@echo off" << std::endl << std::endl;
-			ofs << "copy \"" << res_names[i] << "\" temp.dds" << std::endl;
-			ofs << "Mipmapper temp.dds" << std::endl;
-			if (caps.bc7_support)
-			{
-				ofs << "TexCompressor BC7 temp.dds \"" << res_names[i] << "\"" << std::endl;
-			}
-			else if (caps.bc4_support)
-			{
-				ofs << "TexCompressor BC4 temp.dds \"" << res_names[i] << "\"" << std::endl;
-			}
-			else if (caps.bc1_support)
-			{
-				ofs << "TexCompressor BC1 temp.dds \"" << res_names[i] << "\"" << std::endl;
-			}
-			else if (caps.etc1_support)
-			{
-				ofs << "TexCompressor ETC1 temp.dds \"" << res_names[i] << "\"" << std::endl;
-			}
-			else
-			{
-				ofs << "copy temp.dds \"" << res_names[i] << "\"" << std::endl;
-			}
-			ofs << "del temp.dds" << std::endl;
-			ofs << "@echo on" << std::endl << std::endl;
+			steps.push_back({ CST_Compress, EF_BC7, 0 });
+		}
+		else if (caps.bc4_support)
+		{
+			steps.push_back({ CST_Compress, EF_BC4, 0 });
+		}
+		else if (caps.bc1_support)
+		{
+			steps.push_back({ CST_Compress, EF_BC1, 0 });
+		}
+		else if (caps.etc1_support)
+		{
+			steps.push_back({ CST_Compress, EF_ETC1, 0 });
 		}
 	}
-	else if ("normal" == res_type)
+	else if (("normal" == res_type)
+		|| ("bump" == res_type))
 	{
-		for (size_t i = 0; i < res_names.size(); ++ i)
+		if ("bump" == res_type)
 		{
-			ofs << "@echo Processing: " << res_names[i] << std::endl;
+			steps.push_back({ CST_Bump2Normal, EF_Unknown, 0.4f });
+		}
+		steps.push_back({ CST_GenMipmaps, EF_Unknown, 0 });
+		if (caps.bc5_support)
+		{
+			steps.push_back({ CST_CompressNormal, EF_BC5, 0 });
+		}
+		else if (caps.bc3_support)
+		{
+			steps.push_back({ CST_CompressNormal, EF_BC3, 0 });
+		}
+	}
+	else if ("height" == res_type)
+	{
+		steps.push_back({ CST_GenMipmaps, EF_Unknown, 0 });
+		if (caps.bc4_support)
+		{
+			steps.push_back({ CST_Compress, EF_BC4, 0 });
+		}
+		else if (caps.bc1_support)
+		{
+			steps.push_back({ CST_Compress, EF_BC1, 0 });
+		}
+		else if (caps.etc1_support)
+		{
+			steps.push_back({ CST_Compress, EF_ETC1, 0 });
+		}
+	}
+	else
+	{
+		return false;
+	}
 
-			ofs << "@echo off" << std::endl << std::endl;
-			ofs << "Mipmapper \"" << res_names[i] << "\" temp.dds" << std::endl;
-			if (caps.bc5_support)
-			{
-				ofs << "NormalMapCompressor temp.dds \"" << res_names[i] << "\" BC5" << std::endl;
-			}
-			else if (caps.bc3_support)
-			{
-				ofs << "NormalMapCompressor temp.dds \"" << res_names[i] << "\" BC3" << std::endl;
-			}
-			else
-			{
-				ofs << "copy temp.dds \"" << res_names[i] << "\"" << std::endl;
-			}
-			ofs << "del temp.dds" << std::endl;
-			ofs << "@echo on" << std::endl << std::endl;
+	return true;
+}
+
+enum CookResult
+{
+	CR_Cooked,
+	CR_FromCache,
+	CR_UpToDate,
+	CR_Skipped,
+	CR_Failed
+};
+
+class AssetCooker
+{
+public:
+	AssetCooker(std::string const & res_type, OfflineRenderDeviceCaps const & caps, std::vector<CookStep> const & steps)
+		: steps_(steps), cache_("DeployCache/" + caps.platform)
+	{
+		std::ostringstream config;
+		config << DEPLOYER_VERSION << ' ' << res_type << ' ' << caps.platform << ' '
+			<< static_cast<uint32_t>(caps.major_version) << ' ' << static_cast<uint32_t>(caps.minor_version) << ' '
+			<< caps.bc1_support << caps.bc3_support << caps.bc4_support << caps.bc5_support << caps.bc7_support
+			<< caps.etc1_support << caps.r16_support << caps.r16f_support << caps.srgb_support;
+		for (auto const & step : steps_)
+		{
+			config << ' ' << step.type << ' ' << step.format << ' ' << static_cast<int>(step.param * 1000);
 		}
+		std::string const config_str = config.str();
+		config_hash_ = HashBytes(reinterpret_cast<uint8_t const *>(config_str.data()), config_str.size());
 	}
-	else if ("bump" == res_type)
+
+	// Every resource is an independent chain of load -> steps -> save, and the chains run on the task scheduler. The steps
+	//  spread the subresources and blocks of a texture over the same scheduler.
+	void Cook(std::vector<std::string> const & res_names)
 	{
+		std::vector<CookResult> results(res_names.size(), CR_Failed);
+		std::vector<std::string> errors(res_names.size());
+
+		task_group group(Context::Instance().TaskScheduler());
 		for (size_t i = 0; i < res_names.size(); ++ i)
 		{
-			ofs << "@echo Processing: " << res_names[i] << std::endl;
+			group.run([this, &res_names, &results, &errors, i]()
+				{
+					try
+					{
+						results[i] = this->CookAsset(res_names[i]);
+					}
+					catch (std::exception& e)
+					{
+						errors[i] = e.what();
+					}
+				});
+		}
+		group.wait();
 
-			ofs << "@echo off" << std::endl << std::endl;
-			ofs << "Bump2Normal \"" << res_names[i] << "\" temp.dds 0.4" << std::endl;
-			ofs << "Mipmapper temp.dds" << std::endl; 
-			if (caps.bc5_support)
-			{
-				ofs << "NormalMapCompressor temp.dds \"" << res_names[i] << "\" BC5" << std::endl;
-			}
-			else if (caps.bc3_support)
-			{
-				ofs << "NormalMapCompressor temp.dds \"" << res_names[i] << "\" BC3" << std::endl;
-			}
-			else
+		uint32_t num_failed = 0;
+		for (size_t i = 0; i < res_names.size(); ++ i)
+		{
+			cout << "Processing: " << res_names[i] << " ... ";
+			switch (results[i])
 			{
-				ofs << "copy temp.dds \"" << res_names[i] << "\"" << std::endl;
+			case CR_Cooked:
+				cout << "cooked";
+				break;
+
+			case CR_FromCache:
+				cout << "restored from cache";
+				break;
+
+			case CR_UpToDate:
+				cout << "up to date";
+				break;
+
+			case CR_Skipped:
+				cout << "already compressed, skipped";
+				break;
+
+			case CR_Failed:
+				cout << "failed";
+				if (!errors[i].empty())
+				{
+					cout << ": " << errors[i];
+				}
+				++ num_failed;
+				break;
+
+			default:
+				KFL_UNREACHABLE("Invalid cook result");
 			}
-			ofs << "del temp.dds" << std::endl;
-			ofs << "@echo on" << std::endl << std::endl;
+			cout << endl;
+		}
+
+		if (num_failed > 0)
+		{
+			cout << num_failed << " of " << res_names.size() << " resources failed." << endl;
 		}
 	}
-	else if ("height" == res_type)
+
+private:
+	CookResult CookAsset(std::string const & res_name)
 	{
-		for (size_t i = 0; i < res_names.size(); ++ i)
+		std::shared_ptr<std::vector<uint8_t>> input = MakeSharedPtr<std::vector<uint8_t>>();
+		if (!ReadFileBytes(res_name, *input))
 		{
-			ofs << "@echo Processing: " << res_names[i] << std::endl;
+			return CR_Failed;
+		}
 
-			ofs << "@echo off" << std::endl << std::endl;
-			ofs << "Mipmapper \"" << res_names[i] << "\" temp.dds" << std::endl;
-			if (caps.bc4_support)
-			{
-				ofs << "TexCompressor BC4 temp.dds \"" << res_names[i] << "\"" << std::endl;
-			}
-			else if (caps.bc1_support)
+		uint64_t const input_hash = HashBytes(input->data(), input->size());
+		uint64_t const key = HashBytes(input->data(), input->size(), config_hash_);
+
+		uint64_t cached_hash;
+		if (cache_.Lookup(key, *input, cached_hash))
+		{
+			if (cached_hash == input_hash)
 			{
-				ofs << "TexCompressor BC1 temp.dds \"" << res_names[i] << "\"" << std::endl;
+				return CR_UpToDate;
 			}
-			else if (caps.etc1_support)
+
+			std::vector<uint8_t> output;
+			if (cache_.Fetch(cached_hash, output) && WriteFileBytes(res_name, output))
 			{
-				ofs << "TexCompressor ETC1 temp.dds \"" << res_names[i] << "\"" << std::endl;
+				return CR_FromCache;
 			}
-			else
+		}
+
+		CookTexture tex;
+		{
+			ResIdentifierPtr res = MakeSharedPtr<ResIdentifier>(res_name, 0, input, ArrayRef<uint8_t>(*input));
+			LoadTexture(res, tex.type, tex.width, tex.height, tex.depth, tex.num_mipmaps, tex.array_size, tex.format,
+				tex.init_data, tex.loaded_block);
+		}
+		if (IsCompressedFormat(tex.format))
+		{
+			return CR_Skipped;
+		}
+
+		for (auto const & step : steps_)
+		{
+			switch (step.type)
 			{
-				ofs << "copy temp.dds \"" << res_names[i] << "\"" << std::endl;
+			case CST_Bump2Normal:
+				CookBump2Normal(tex, step.param);
+				break;
+
+			case CST_ForceSRGB:
+				CookForceSRGB(tex);
+				break;
+
+			case CST_GenMipmaps:
+				CookGenMipmaps(tex);
+				break;
+
+			case CST_Compress:
+				CookCompress(tex, step.format);
+				break;
+
+			case CST_CompressNormal:
+				CookCompressNormal(tex, step.format);
+				break;
+
+			default:
+				KFL_UNREACHABLE("Invalid cook step");
 			}
-			ofs << "del temp.dds" << std::endl;
-			ofs << "@echo on" << std::endl << std::endl;
 		}
+
+		SaveTexture(res_name, tex.type, tex.width, tex.height, tex.depth, tex.num_mipmaps, tex.array_size, tex.format,
+			tex.init_data);
+
+		std::vector<uint8_t> output;
+		if (!ReadFileBytes(res_name, output))
+		{
+			return CR_Failed;
+		}
+		uint64_t const output_hash = HashBytes(output.data(), output.size());
+		uint64_t const identity_key = HashBytes(output.data(), output.size(), config_hash_);
+		cache_.Store(key, input_hash, *input, identity_key, output_hash, output);
+
+		return CR_Cooked;
 	}
-	else if ("cubemap" == res_type)
+
+private:
+	std::vector<CookStep> steps_;
+	uint64_t config_hash_;
+	CookCache cache_;
+};
+
+void Deploy(std::vector<std::string> const & res_names, std::string const & res_type, OfflineRenderDeviceCaps const & caps)
+{
+	std::vector<CookStep> steps;
+	if (BuildTexturePipeline(res_type, caps, steps))
+	{
+		AssetCooker cooker(res_type, caps, steps);
+		cooker.Cook(res_names);
+		return;
+	}
+
+	std::ofstream ofs("convert.bat");
+
+	if ("cubemap" == res_type)
 	{
 		std::string y_fmt;
 		std::string c_fmt;
@@ -369,14 +883,6 @@ void Deploy(std::vector<std::string> const & res_names, std::string const & res_
 		printf("Error: Unknown resource type.");
 		return;
 	}
-
-	ofs.close();
-
-	if ((res_type != "cubemap") && (res_type != "model") && (res_type != "effect"))
-	{
-		system("convert.bat");
-		system("del convert.bat");
-	}
 }
 
 int main(int argc, char* argv[])
@@ -407,7 +913,7 @@ int main(int argc, char* argv[])
 	}
 	if (vm.count("version") > 0)
 	{
-		cout << "KlayGE PlatformDeployer, Version 1.0.0" << endl;
+		cout << "KlayGE PlatformDeployer, Version " << DEPLOYER_VERSION << endl;
 		Context::Destroy();
 		return 1;
 	}
@@ -107,6 +107,9 @@ namespace KlayGE
 		font_info const & CharInfo(int32_t index) const;
 		void GetDistanceData(uint8_t* p, uint32_t pitch, int32_t index) const;
 		void GetLZMADistanceData(uint8_t* p, uint32_t& size, int32_t index) const;
+		// Decompresses the data returned by GetLZMADistanceData into CharSize() * CharSize() bytes at p.
+		// Doesn't touch the font stream, so it can run on several threads at once.
+		void DecodeLZMADistanceData(uint8_t* p, uint8_t const * lzma_data, uint32_t size) const;
 
 		void CharSize(uint32_t size);
 		void DistBase(int16_t base);
@@ -349,11 +349,7 @@ namespace KlayGE
 		std::vector<uint8_t> in_data(size);
 		this->GetLZMADistanceData(&in_data[0], size, index);
 
-		SizeT s_out_len = static_cast<SizeT>(decoded.size());
-
-		SizeT s_src_len = static_cast<SizeT>(in_data.size() - LZMA_PROPS_SIZE);
-		LZMALoader::Instance().LzmaUncompress(static_cast<Byte*>(&decoded[0]), &s_out_len, &in_data[LZMA_PROPS_SIZE], &s_src_len,
-			&in_data[0], LZMA_PROPS_SIZE);
+		this->DecodeLZMADistanceData(&decoded[0], &in_data[0], size);
 
 		uint8_t const * char_data = &decoded[0];
 		for (uint32_t y = 0; y < char_size_; ++ y)
@@ -364,6 +360,17 @@ namespace KlayGE
 		}
 	}
 
+	void KFont::DecodeLZMADistanceData(uint8_t* p, uint8_t const * lzma_data, uint32_t size) const
+	{
+		BOOST_ASSERT(size > LZMA_PROPS_SIZE);
+
+		SizeT s_out_len = static_cast<SizeT>(char_size_ * char_size_);
+
+		SizeT s_src_len = static_cast<SizeT>(size - LZMA_PROPS_SIZE);
+		LZMALoader::Instance().LzmaUncompress(static_cast<Byte*>(p), &s_out_len, lzma_data + LZMA_PROPS_SIZE, &s_src_len,
+			lzma_data, LZMA_PROPS_SIZE);
+	}
+
 	void KFont::GetLZMADistanceData(uint8_t* p, uint32_t& size, int32_t index) const
 	{
 		size = static_cast<uint32_t>(distances_addr_[index + 1] - distances_addr_[index]);